@@ -798,7 +798,7 @@ const HAPBoolCharacteristic ringcodeOnCharacteristic = {
 };
 
 
-const HAPUUID kHAPServiceType_Ringcode =  { 0xFB, 0xF1,0x5A, 0x8E, 0xA0, 0x1E, 0x4C, 0xBF, 0x89, 0xBE, 0xF8, 0xF3, 0x3F, 0x71, 0xEA, 0x8C }; // FBF15A8E-A01E-4CBF-89BE-F8F33F71EA8C from simulator
+const HAPUUID kHAPServiceType_Ringcode =  { { 0xFB, 0xF1,0x5A, 0x8E, 0xA0, 0x1E, 0x4C, 0xBF, 0x89, 0xBE, 0xF8, 0xF3, 0x3F, 0x71, 0xEA, 0x8C } }; // FBF15A8E-A01E-4CBF-89BE-F8F33F71EA8C from simulator
 #define kHAPServiceDebugDescription_Ringcode "Ringcode"
 
 /**
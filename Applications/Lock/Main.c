@@ -20,6 +20,9 @@
 #include "HAPPlatformServiceDiscovery+Init.h"
 #include "HAPPlatformTCPStreamManager+Init.h"
 #endif
+#if IP && HAVE_WORKER_POOL
+#include "HAPPlatformWorkerPool+Init.h"
+#endif
 
 #include <signal.h>
 #include <string.h>
@@ -47,6 +50,10 @@ static struct {
     HAPPlatformTCPStreamManager tcpStreamManager;
 #endif
 
+#if IP && HAVE_WORKER_POOL
+    HAPPlatformWorkerPool workerPool;
+#endif
+
     HAPPlatformMFiHWAuth mfiHWAuth;
     HAPPlatformMFiTokenAuth mfiTokenAuth;
 } platform;
@@ -94,7 +101,8 @@ static void InitializePlatform() {
             &(const HAPPlatformTCPStreamManagerOptions) {
                     .interfaceName = NULL,       // Listen on all available network interfaces.
                     .port = kHAPNetworkPort_Any, // Listen on unused port number from the ephemeral port range.
-                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements });
+                    // One additional TCP stream to admit new connections while all IP sessions are in use.
+                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements + 1 });
 
     // Service discovery.
     static HAPPlatformServiceDiscovery serviceDiscovery;
@@ -106,6 +114,15 @@ static void InitializePlatform() {
     platform.hapPlatform.ip.serviceDiscovery = &serviceDiscovery;
 #endif
 
+#if IP && HAVE_WORKER_POOL
+    // Worker pool for Pair Setup and Pair Verify cryptography.
+    HAPPlatformWorkerPoolCreate(
+            &platform.workerPool,
+            &(const HAPPlatformWorkerPoolOptions) { .numThreads = 1,
+                                                    .maxJobs = kHAPIPSessionStorage_DefaultNumElements });
+    platform.hapPlatform.ip.workerPool = &platform.workerPool;
+#endif
+
 #if (BLE)
     // BLE peripheral manager. Depends on key-value store.
     static HAPPlatformBLEPeripheralManagerOptions blePMOptions = { 0 };
@@ -157,6 +174,11 @@ static void DeinitializePlatform() {
 
     AppDeinitialize();
 
+#if IP && HAVE_WORKER_POOL
+    // Worker pool.
+    HAPPlatformWorkerPoolRelease(&platform.workerPool);
+#endif
+
     // Run loop.
     HAPPlatformRunLoopRelease();
 }
@@ -244,7 +266,11 @@ static void InitializeIP() {
         .numReadContexts = HAPArrayCount(ipReadContexts),
         .writeContexts = ipWriteContexts,
         .numWriteContexts = HAPArrayCount(ipWriteContexts),
-        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer },
+        .admissionPolicy = kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive,
+        // Devices of the same user share one controller pairing, so sessions are not limited per controller.
+        .maxSessionsPerController = kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController,
+        .evictionIdleDuration = 5 * HAPMinute
     };
 
     platform.hapAccessoryServerOptions.ip.transport = &kHAPAccessoryServerTransport_IP;
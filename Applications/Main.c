@@ -11,6 +11,9 @@
 #include "HAPPlatform+Init.h"
 #include "HAPPlatformAccessorySetup+Init.h"
 #include "HAPPlatformBLEPeripheralManager+Init.h"
+#if (BLE) && !DARWIN
+#include "HAPPlatformFileManager.h"
+#endif
 #include "HAPPlatformKeyValueStore+Init.h"
 #include "HAPPlatformMFiHWAuth+Init.h"
 #include "HAPPlatformMFiTokenAuth+Init.h"
@@ -19,6 +22,9 @@
 #include "HAPPlatformServiceDiscovery+Init.h"
 #include "HAPPlatformTCPStreamManager+Init.h"
 #endif
+#if IP && HAVE_WORKER_POOL
+#include "HAPPlatformWorkerPool+Init.h"
+#endif
 
 #include <signal.h>
 static bool requestedFactoryReset = false;
@@ -44,6 +50,10 @@ static struct {
     HAPPlatformTCPStreamManager tcpStreamManager;
 #endif
 
+#if IP && HAVE_WORKER_POOL
+    HAPPlatformWorkerPool workerPool;
+#endif
+
     HAPPlatformMFiHWAuth mfiHWAuth;
     HAPPlatformMFiTokenAuth mfiTokenAuth;
 } platform;
@@ -91,7 +101,8 @@ static void InitializePlatform() {
             &(const HAPPlatformTCPStreamManagerOptions) {
                     .interfaceName = NULL,       // Listen on all available network interfaces.
                     .port = kHAPNetworkPort_Any, // Listen on unused port number from the ephemeral port range.
-                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements });
+                    // One additional TCP stream to admit new connections while all IP sessions are in use.
+                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements + 1 });
 
     // Service discovery.
     static HAPPlatformServiceDiscovery serviceDiscovery;
@@ -103,10 +114,34 @@ static void InitializePlatform() {
     platform.hapPlatform.ip.serviceDiscovery = &serviceDiscovery;
 #endif
 
+#if IP && HAVE_WORKER_POOL
+    // Worker pool for Pair Setup and Pair Verify cryptography.
+    HAPPlatformWorkerPoolCreate(
+            &platform.workerPool,
+            &(const HAPPlatformWorkerPoolOptions) { .numThreads = 1,
+                                                    .maxJobs = kHAPIPSessionStorage_DefaultNumElements });
+    platform.hapPlatform.ip.workerPool = &platform.workerPool;
+#endif
+
 #if (BLE)
     // BLE peripheral manager. Depends on key-value store.
     static HAPPlatformBLEPeripheralManagerOptions blePMOptions = { 0 };
+#if DARWIN
     blePMOptions.keyValueStore = &platform.keyValueStore;
+#else
+    // Each service and characteristic is published with its instance ID attribute.
+    static HAPPlatformBLEPeripheralManagerAttribute blePMAttributes[2 * kAttributeCount];
+    blePMOptions.attributes = blePMAttributes;
+    blePMOptions.numAttributes = HAPArrayCount(blePMAttributes);
+
+    // The simulated central connects through a socket in the key-value store directory, which is private.
+    HAPError err = HAPPlatformFileManagerCreateDirectory(".HomeKitStore");
+    if (err) {
+        HAPLogError(&kHAPLog_Default, "Failed to create directory for BLE peripheral manager socket.");
+        HAPFatalError();
+    }
+    blePMOptions.socketPath = ".HomeKitStore/ble.sock";
+#endif
 
     static HAPPlatformBLEPeripheralManager blePeripheralManager;
     HAPPlatformBLEPeripheralManagerCreate(&blePeripheralManager, &blePMOptions);
@@ -116,6 +151,11 @@ static void InitializePlatform() {
 #if HAVE_MFI_HW_AUTH
     // Apple Authentication Coprocessor provider.
     HAPPlatformMFiHWAuthCreate(&platform.mfiHWAuth);
+
+    // Accessory certificate cache. The accessory certificate is read once when the accessory server is started.
+    static uint8_t mfiCertificateBytes[kHAPAccessoryServerMFiCertificateCache_MaxBytes];
+    platform.hapAccessoryServerOptions.mfiCertificateCache.bytes = mfiCertificateBytes;
+    platform.hapAccessoryServerOptions.mfiCertificateCache.maxBytes = sizeof mfiCertificateBytes;
 #endif
 
 #if HAVE_MFI_HW_AUTH
@@ -154,6 +194,11 @@ static void DeinitializePlatform() {
 
     AppDeinitialize();
 
+#if IP && HAVE_WORKER_POOL
+    // Worker pool.
+    HAPPlatformWorkerPoolRelease(&platform.workerPool);
+#endif
+
     // Run loop.
     HAPPlatformRunLoopRelease();
 }
@@ -241,7 +286,11 @@ static void InitializeIP() {
         .numReadContexts = HAPArrayCount(ipReadContexts),
         .writeContexts = ipWriteContexts,
         .numWriteContexts = HAPArrayCount(ipWriteContexts),
-        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer },
+        .admissionPolicy = kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive,
+        // Devices of the same user share one controller pairing, so sessions are not limited per controller.
+        .maxSessionsPerController = kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController,
+        .evictionIdleDuration = 5 * HAPMinute
     };
 
     platform.hapAccessoryServerOptions.ip.transport = &kHAPAccessoryServerTransport_IP;
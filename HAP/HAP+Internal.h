@@ -36,6 +36,7 @@ extern "C" {
 
 #include "HAPPairing.h"
 #include "HAPPairingBLESessionCache.h"
+#include "HAPPairingCrypto.h"
 #include "HAPPairingPairSetup.h"
 #include "HAPPairingPairVerify.h"
 #include "HAPPairingPairings.h"
@@ -73,11 +74,13 @@ extern "C" {
 
 #include "HAP+KeyValueStoreDomains.h"
 #include "HAPAccessory+Info.h"
+#include "HAPAccessory+Precomputed.h"
 #include "HAPAccessoryServer+Internal.h"
 #include "HAPAccessorySetup.h"
 #include "HAPAccessorySetupInfo.h"
 #include "HAPAccessoryValidation.h"
 #include "HAPCharacteristic.h"
+#include "HAPCharacteristicValueCache.h"
 
 #include "HAPJSONUtils.h"
 #include "HAPLog+Attributes.h"
@@ -82,6 +82,16 @@ extern "C" {
  */
 #define kHAPKeyValueStoreKey_Configuration_NumUnsuccessfulAuthAttempts ((HAPPlatformKeyValueStoreKey) 0x22)
 
+/**
+ * Attribute database fingerprint.
+ *
+ * - SHA-256 over the accessories, services and characteristics at the last accessory server start.
+ *   The configuration number is incremented when the fingerprint changes.
+ *
+ * Format: uint8_t[SHA256_BYTES].
+ */
+#define kHAPKeyValueStoreKey_Configuration_DatabaseFingerprint ((HAPPlatformKeyValueStoreKey) 0x23)
+
 /**
  * BLE Global State Number.
  *
@@ -215,15 +215,23 @@ void HAPTLVWriterGetScratchBytes(
 /**
  * HomeKit Accessory server.
  */
-typedef HAP_OPAQUE(2418) HAPAccessoryServerRef;
+typedef HAP_OPAQUE(2602) HAPAccessoryServerRef;
 HAP_NONNULL_SUPPORT(HAPAccessoryServerRef)
 
 /**
  * HomeKit Session.
  */
-typedef HAP_OPAQUE(488) HAPSessionRef;
+typedef HAP_OPAQUE(552) HAPSessionRef;
 HAP_NONNULL_SUPPORT(HAPSessionRef)
 
+/**
+ * Entry of the characteristic value cache.
+ *
+ * @see HAPAccessoryServerOptions
+ */
+typedef HAP_OPAQUE(56) HAPCharacteristicValueCacheEntryRef;
+HAP_NONNULL_SUPPORT(HAPCharacteristicValueCacheEntryRef)
+
 /**
  * Formats that HomeKit characteristics can have.
  *
@@ -502,6 +510,47 @@ typedef struct {
 } HAPCharacteristicProperties;
 HAP_STATIC_ASSERT(sizeof(HAPCharacteristicProperties) == 4, HAPCharacteristicProperties);
 
+/**
+ * Event notification policy of a numeric characteristic.
+ *
+ * - The policy applies to values that are published with the HAPAccessoryServerUpdate*Value functions.
+ *   Event notifications that are raised with HAPAccessoryServerRaiseEvent or HAPAccessoryServerRaiseEventOnSession
+ *   are not filtered.
+ *
+ * - A published value raises an event notification if it differs from the value of the previous event notification
+ *   by at least the absolute deadband and by at least the relative deadband. Smaller changes are held back.
+ *
+ * - Event notifications are at least the minimum interval apart. Changes that are published earlier are deferred
+ *   until the minimum interval has elapsed.
+ *
+ * - A change that has been held back by the deadbands raises an event notification after the maximum latency.
+ *
+ * - A zero-initialized policy raises an event notification for every change.
+ */
+typedef struct {
+    /**
+     * Minimum absolute change of the value that raises an event notification. 0 disables the absolute deadband.
+     */
+    float absoluteDeadband;
+
+    /**
+     * Minimum change relative to the magnitude of the value of the previous event notification, e.g., 0.01 for 1%.
+     * 0 disables the relative deadband.
+     */
+    float relativeDeadband;
+
+    /**
+     * Minimum duration between two event notifications. 0 disables the minimum interval.
+     */
+    HAPTime minimumInterval;
+
+    /**
+     * Maximum duration that a change is held back by the deadbands. 0 holds back changes until a change exceeds the
+     * deadbands.
+     */
+    HAPTime maximumLatency;
+} HAPCharacteristicEventPolicy;
+
 /**
  * Units that numeric HomeKit characteristics can have.
  *
@@ -1267,6 +1316,11 @@ struct HAPUInt8Characteristic {
         const HAPUInt8CharacteristicValidValuesRange* _Nullable const* _Nullable validValuesRanges;
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -1528,6 +1582,11 @@ struct HAPUInt16Characteristic {
         uint16_t stepValue;    /**< Step value. */
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -1789,6 +1848,11 @@ struct HAPUInt32Characteristic {
         uint32_t stepValue;    /**< Step value. */
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -2050,6 +2114,11 @@ struct HAPUInt64Characteristic {
         uint64_t stepValue;    /**< Step value. */
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -2311,6 +2380,11 @@ struct HAPIntCharacteristic {
         int32_t stepValue;    /**< Step value. */
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -2572,6 +2646,11 @@ struct HAPFloatCharacteristic {
         float stepValue;    /**< Step value. */
     } constraints;
 
+    /**
+     * Event notification policy for published values.
+     */
+    HAPCharacteristicEventPolicy eventPolicy;
+
     /**
      * Callbacks.
      */
@@ -3450,6 +3529,136 @@ typedef struct {
     bool remote;
 } HAPAccessoryIdentifyRequest;
 
+/**
+ * Precomputed serializations of a characteristic.
+ *
+ * - Generated by Tools/AccessoryDatabaseGenerator from the same description as the characteristic.
+ */
+typedef struct {
+    /**
+     * The characteristic.
+     */
+    const HAPCharacteristic* characteristic;
+
+    /**
+     * IP serializations.
+     */
+    struct {
+        /**
+         * Characteristic type in the short form that is used in JSON, without quotation marks.
+         */
+        const char* type;
+
+        /**
+         * Static members of the characteristic object in a GET /accessories response that follow "perms" and "ev".
+         *
+         * - Each member is preceded by a comma. Empty string if the characteristic object has no such members.
+         */
+        const char* metadata;
+    } ip;
+
+    /**
+     * Bluetooth LE serializations.
+     */
+    struct {
+        /**
+         * Body of the HAP-Characteristic-Signature-Read-Response.
+         */
+        const uint8_t* signatureBytes;
+
+        /**
+         * Length of the body of the HAP-Characteristic-Signature-Read-Response.
+         */
+        size_t numSignatureBytes;
+    } ble;
+} HAPPrecomputedCharacteristic;
+
+/**
+ * Precomputed serializations of a service.
+ *
+ * - Generated by Tools/AccessoryDatabaseGenerator from the same description as the service.
+ */
+typedef struct {
+    /**
+     * The service.
+     */
+    const HAPService* service;
+
+    /**
+     * IP serializations.
+     */
+    struct {
+        /**
+         * Service type in the short form that is used in JSON, without quotation marks.
+         */
+        const char* type;
+    } ip;
+
+    /**
+     * Bluetooth LE serializations.
+     */
+    struct {
+        /**
+         * Body of the HAP-Service-Signature-Read-Response.
+         */
+        const uint8_t* signatureBytes;
+
+        /**
+         * Length of the body of the HAP-Service-Signature-Read-Response.
+         */
+        size_t numSignatureBytes;
+    } ble;
+
+    /**
+     * Precomputed characteristics, in the same order as the characteristics of the service.
+     *
+     * - NULL if the service has no characteristics.
+     */
+    const HAPPrecomputedCharacteristic* _Nullable characteristics;
+
+    /**
+     * Number of precomputed characteristics.
+     */
+    size_t numCharacteristics;
+} HAPPrecomputedService;
+
+/**
+ * Precomputed serializations of an accessory attribute database.
+ *
+ * - Generated by Tools/AccessoryDatabaseGenerator. Serializations are computed at runtime for services and
+ *   characteristics that are not part of the precomputed attribute database.
+ */
+typedef struct {
+    /**
+     * Precomputed services, in the same order as the services of the accessory.
+     */
+    const HAPPrecomputedService* services;
+
+    /**
+     * Number of precomputed services.
+     */
+    size_t numServices;
+
+    /**
+     * Bluetooth LE GATT layout.
+     */
+    struct {
+        /**
+         * Index of the GATT table element that covers each attribute handle, relative to the lowest attribute handle
+         * of the GATT table.
+         *
+         * - The layout assumes that attribute handles are assigned in ascending order without gaps.
+         *   It is only used if the attribute handles that are assigned on registration match it.
+         */
+        const uint16_t* _Nullable gattElementIndices;
+
+        /**
+         * Number of attribute handles in the GATT layout.
+         */
+        size_t numGATTHandles;
+    } ble;
+} HAPPrecomputedAttributeDatabase;
+
 /**
  * HomeKit accessory.
  */
@@ -3530,6 +3739,14 @@ struct HAPAccessory {
      */
     const HAPService* _Nullable const* _Nullable services;
 
+    /**
+     * Precomputed serializations of the services, generated by Tools/AccessoryDatabaseGenerator. Optional.
+     *
+     * - If set, static parts of GET /accessories responses, of Bluetooth LE signature read responses and
+     *   the Bluetooth LE GATT layout are taken from it instead of being computed at runtime.
+     */
+    const HAPPrecomputedAttributeDatabase* _Nullable precomputedAttributeDatabase;
+
     /**
      * Callbacks.
      */
@@ -3581,7 +3798,7 @@ typedef HAP_OPAQUE(64) HAPIPWriteContextRef;
 /**
  * IP session descriptor.
  */
-typedef HAP_OPAQUE(832) HAPIPSessionDescriptorRef;
+typedef HAP_OPAQUE(912) HAPIPSessionDescriptorRef;
 
 /**
  * IP event notification.
@@ -3672,6 +3889,37 @@ typedef struct {
  */
 #define kHAPIPSessionStorage_DefaultNumElements ((size_t) 17)
 
+/**
+ * Admission policy of the IP accessory server for connections that are accepted while all IP sessions are in use.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPIPSessionAdmissionPolicy) { /**
+                                                        * New connections are refused until an IP session is released.
+                                                        */
+                                                       kHAPIPSessionAdmissionPolicy_Refuse,
+
+                                                       /**
+                                                        * The least recently active IP session that may be evicted
+                                                        * is closed to admit the new connection.
+                                                        *
+                                                        * - IP sessions that are not secured may be evicted.
+                                                        *
+                                                        * - Secured IP sessions may be evicted if their controller
+                                                        *   has more than maxSessionsPerController IP sessions.
+                                                        *   The controller with the most IP sessions is evicted first.
+                                                        *
+                                                        * - Otherwise, secured IP sessions may be evicted if they have
+                                                        *   been idle for at least evictionIdleDuration.
+                                                        *
+                                                        * - IP sessions that are processing a request are never evicted.
+                                                        */
+                                                       kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive
+} HAP_ENUM_END(uint8_t, HAPIPSessionAdmissionPolicy);
+
+/**
+ * Value of maxSessionsPerController that does not limit the number of IP sessions per controller.
+ */
+#define kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController ((size_t) 0)
+
 /**
  * IP server storage.
  *
@@ -3740,6 +3988,34 @@ typedef struct {
          */
         size_t numBytes;
     } scratchBuffer;
+
+    /**
+     * Admission policy for connections that are accepted while all IP sessions are in use.
+     *
+     * - To admit new connections while all IP sessions are in use, the TCP stream manager must support more
+     *   concurrent TCP streams than there are IP sessions.
+     */
+    HAPIPSessionAdmissionPolicy admissionPolicy;
+
+    /**
+     * Number of IP sessions per controller that are protected from eviction.
+     *
+     * - Only used with kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive.
+     *
+     * - kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController (0) does not limit the number of IP sessions
+     *   per controller. Secured IP sessions are then only evicted after evictionIdleDuration.
+     */
+    size_t maxSessionsPerController;
+
+    /**
+     * Duration after which an idle secured IP session may be evicted, even if its controller does not exceed
+     * maxSessionsPerController. The least recently active IP session is evicted first.
+     *
+     * - Only used with kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive.
+     *
+     * - 0 evicts idle secured IP sessions only based on maxSessionsPerController.
+     */
+    HAPTime evictionIdleDuration;
 } HAPIPAccessoryServerStorage;
 HAP_NONNULL_SUPPORT(HAPIPAccessoryServerStorage)
 
@@ -3881,6 +4157,108 @@ extern const HAPBLEAccessoryServerTransport kHAPAccessoryServerTransport_BLE;
 HAP_NONNULL_SUPPORT(HAPBLEAccessoryServerTransport)
 /**@}*/
 
+/**
+ * Allowance for the request line and header fields of a HTTP request that is received over IP,
+ * excluding the request URI of GET /characteristics requests.
+ *
+ * - iOS controllers send a Host header containing the accessory name, Content-Type and Content-Length.
+ */
+#define kHAPIPAccessoryServerStorage_MaxRequestHeaderBytes ((size_t) 256)
+
+/**
+ * Storage requirements of an accessory server for a given accessory attribute database.
+ *
+ * - Sizes cover the worst case that may be requested by a controller: reading all characteristics at once including
+ *   metadata, subscribing to and writing all characteristics at once, receiving event notifications for all
+ *   characteristics at once, and a Pair Setup M4 response that includes an Apple Authentication Coprocessor proof.
+ *
+ * - Values of string characteristics are assumed to consist of control characters that are escaped as \\u00XX.
+ *   Additional authorization data of write requests is not accounted for.
+ */
+typedef struct {
+    /**
+     * HAP over IP requirements.
+     */
+    struct {
+        /** Minimum value of HAPIPAccessoryServerStorage.numReadContexts. */
+        size_t numReadContexts;
+
+        /** Minimum value of HAPIPAccessoryServerStorage.numWriteContexts. */
+        size_t numWriteContexts;
+
+        /** Minimum value of HAPIPAccessoryServerStorage.scratchBuffer.numBytes. */
+        size_t numScratchBufferBytes;
+
+        /** Minimum value of HAPIPSession.inboundBuffer.numBytes. */
+        size_t numInboundBufferBytes;
+
+        /** Minimum value of HAPIPSession.outboundBuffer.numBytes. */
+        size_t numOutboundBufferBytes;
+
+        /** Minimum value of HAPIPSession.numEventNotifications. */
+        size_t numEventNotifications;
+
+        /** Length of the largest GET /characteristics response body. */
+        size_t maxReadResponseBytes;
+
+        /** Length of the largest event notification body. */
+        size_t maxEventNotificationBytes;
+
+        /** Length of the largest PUT /characteristics request body. */
+        size_t maxWriteRequestBytes;
+
+        /** Length of the largest PUT /characteristics response body. */
+        size_t maxWriteResponseBytes;
+
+        /** Length of the largest element of a GET /accessories response that is serialized at once. */
+        size_t maxAccessoriesElementBytes;
+    } ip;
+
+    /**
+     * HAP over Bluetooth LE requirements of the primary accessory.
+     */
+    struct {
+        /** Minimum value of HAPBLEAccessoryServerStorage.numGATTTableElements. */
+        size_t numGATTTableElements;
+
+        /** Minimum value of HAPBLEAccessoryServerStorage.procedureBuffer.numBytes. */
+        size_t numProcedureBufferBytes;
+    } ble;
+
+    /** Length of the largest pairing message. */
+    size_t maxPairingMessageBytes;
+} HAPAccessoryServerStorageRequirements;
+
+/**
+ * Computes the storage requirements of an accessory server for a given accessory attribute database.
+ *
+ * - Use this to size HAPIPAccessoryServerStorage and HAPBLEAccessoryServerStorage instead of the default sizes.
+ *   The requirements do not depend on the number of IP sessions.
+ *
+ * - TLV8 characteristics do not specify a maximum length. The maximum length of their values must be provided.
+ *   Values of the Pair Setup, Pair Verify and Pairing Pairings characteristics are bounded by the pairing messages.
+ *
+ * - The accessory server does not check its storage configuration against the requirements. If debug logs are
+ *   compiled in, it logs the comparison when it is started.
+ *
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories. NULL if not a bridge.
+ * @param      maxPairings          Maximum number of allowed pairings. See HAPAccessoryServerOptions.
+ * @param      maxTLV8Bytes         Maximum length of the values of TLV8 characteristics.
+ * @param[out] requirements         Storage requirements.
+ */
+void HAPAccessoryServerGetStorageRequirements(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        HAPPlatformKeyValueStoreKey maxPairings,
+        size_t maxTLV8Bytes,
+        HAPAccessoryServerStorageRequirements* requirements);
+
+/**
+ * Maximum length of an accessory certificate of an Apple Authentication Coprocessor.
+ */
+#define kHAPAccessoryServerMFiCertificateCache_MaxBytes ((size_t) 1280)
+
 /**
  * Accessory server initialization options.
  */
@@ -3892,6 +4270,51 @@ typedef struct {
      */
     HAPPlatformKeyValueStoreKey maxPairings;
 
+    /**
+     * Characteristic value cache.
+     *
+     * - Optional. Values that are published with the HAPAccessoryServerUpdate*Value functions are stored here,
+     *   and reads of those characteristics are served without calling their handleRead callback.
+     *
+     * - One entry is used per characteristic with a published value. If the cache is full, further characteristics
+     *   fall back to their handleRead callback.
+     *
+     * - Only characteristics with format Bool, UInt8, UInt16, UInt32, UInt64, Int and Float may be cached.
+     */
+    struct {
+        /**
+         * Storage for cache entries. Must remain valid until the accessory server is released.
+         */
+        HAPCharacteristicValueCacheEntryRef* _Nullable entries;
+
+        /**
+         * Number of cache entries.
+         */
+        size_t numEntries;
+    } valueCache;
+
+    /**
+     * Accessory certificate cache of the Apple Authentication Coprocessor.
+     *
+     * - Optional. If set, the accessory certificate is read when the accessory server is started and is served from
+     *   this storage for all subsequent pairings. The Apple Authentication Coprocessor is then only accessed to create
+     *   the signature of each pairing.
+     *
+     * - Should provide kHAPAccessoryServerMFiCertificateCache_MaxBytes bytes. If the accessory certificate does not
+     *   fit, it is read from the Apple Authentication Coprocessor for every pairing.
+     */
+    struct {
+        /**
+         * Storage for the accessory certificate. Must remain valid until the accessory server is released.
+         */
+        void* _Nullable bytes;
+
+        /**
+         * Capacity of storage.
+         */
+        size_t maxBytes;
+    } mfiCertificateCache;
+
     /**
      * IP specific initialization options.
      */
@@ -4038,6 +4461,13 @@ typedef struct {
          * Service discovery.
          */
         HAPPlatformServiceDiscoveryRef _Nullable serviceDiscovery;
+
+        /**
+         * Worker pool for Pair Setup and Pair Verify cryptography.
+         *
+         * - This platform module is optional. If it is not set, pairing cryptography runs on the run loop.
+         */
+        HAPPlatformWorkerPoolRef _Nullable workerPool;
     } ip;
 
     /**
@@ -4214,8 +4644,9 @@ void HAPAccessoryServerStart(HAPAccessoryServerRef* server, const HAPAccessory*
  * @param      server               An initialized accessory server that is not running.
  * @param      bridgeAccessory      Bridge accessory to serve. Must remain valid while started.
  * @param      bridgedAccessories   Array of bridged accessories. NULL-terminated. Must remain valid while started.
- * @param      configurationChanged Whether or not the bridge configuration changed since the last start.
- *                                  This includes adding / removing accessories or updating FW of a bridged accessory.
+ * @param      configurationChanged Ignored. Kept for source compatibility.
+ *                                  Changes to the bridge configuration since the last start, such as adding / removing
+ *                                  accessories or updating FW of a bridged accessory, are detected automatically.
  */
 void HAPAccessoryServerStartBridge(
         HAPAccessoryServerRef* server,
@@ -4319,6 +4750,193 @@ void HAPAccessoryServerRaiseEventOnSession(
         const HAPAccessory* accessory,
         HAPSessionRef* session);
 
+/**
+ * Publishes the value of a Bool characteristic in a given service provided by a given accessory object.
+ *
+ * - The value is stored in the characteristic value cache, and subsequent reads of the characteristic are served from
+ *   the cache without calling its handleRead callback, until HAPAccessoryServerInvalidateValue is called.
+ *
+ * - An event notification is raised if the value differs from the previously published value. Numeric
+ *   characteristics may hold back or defer event notifications according to their event notification policy.
+ *   Values of the Programmable Switch Event characteristic always raise an event notification.
+ *
+ * - If a value is published from within the handleWrite callback of the characteristic, it takes precedence over the
+ *   written value. Otherwise, the cached value is updated with the written value after a successful write.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full. An event notification is still raised,
+ *                                  and reads keep calling the handleRead callback.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateBoolValue(
+        HAPAccessoryServerRef* server,
+        const HAPBoolCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        bool value);
+
+/**
+ * Publishes the value of a UInt8 characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt8Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt8Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint8_t value);
+
+/**
+ * Publishes the value of a UInt16 characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt16Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt16Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint16_t value);
+
+/**
+ * Publishes the value of a UInt32 characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt32Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt32Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint32_t value);
+
+/**
+ * Publishes the value of a UInt64 characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt64Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt64Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint64_t value);
+
+/**
+ * Publishes the value of a Int characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateIntValue(
+        HAPAccessoryServerRef* server,
+        const HAPIntCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        int32_t value);
+
+/**
+ * Publishes the value of a Float characteristic in a given service provided by a given accessory object.
+ *
+ * @see HAPAccessoryServerUpdateBoolValue
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value is published.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value does not fulfill the constraints of the characteristic.
+ * @return kHAPError_OutOfResources If the characteristic value cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateFloatValue(
+        HAPAccessoryServerRef* server,
+        const HAPFloatCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        float value);
+
+/**
+ * Removes the published value of a characteristic in a given service provided by a given accessory object from the
+ * characteristic value cache.
+ *
+ * - Subsequent reads of the characteristic call its handleRead callback again.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose published value is removed.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ */
+void HAPAccessoryServerInvalidateValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory);
+
 /**
  * Restores the given key-value store to factory settings.
  *
@@ -0,0 +1,54 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+HAP_RESULT_USE_CHECK
+const HAPPrecomputedService* _Nullable HAPAccessoryGetPrecomputedService(
+        const HAPAccessory* accessory,
+        const HAPService* service,
+        size_t serviceIndex) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(service);
+
+    const HAPPrecomputedAttributeDatabase* _Nullable database = accessory->precomputedAttributeDatabase;
+    if (!database) {
+        return NULL;
+    }
+    if (serviceIndex < database->numServices && database->services[serviceIndex].service == service) {
+        return &database->services[serviceIndex];
+    }
+    for (size_t i = 0; i < database->numServices; i++) {
+        if (database->services[i].service == service) {
+            return &database->services[i];
+        }
+    }
+    return NULL;
+}
+
+HAP_RESULT_USE_CHECK
+const HAPPrecomputedCharacteristic* _Nullable HAPPrecomputedServiceGetCharacteristic(
+        const HAPPrecomputedService* precomputedService,
+        const HAPCharacteristic* characteristic,
+        size_t characteristicIndex) {
+    HAPPrecondition(precomputedService);
+    HAPPrecondition(characteristic);
+
+    if (!precomputedService->numCharacteristics) {
+        return NULL;
+    }
+    const HAPPrecomputedCharacteristic* characteristics = HAPNonnull(precomputedService->characteristics);
+    if (characteristicIndex < precomputedService->numCharacteristics &&
+        characteristics[characteristicIndex].characteristic == characteristic) {
+        return &characteristics[characteristicIndex];
+    }
+    for (size_t i = 0; i < precomputedService->numCharacteristics; i++) {
+        if (characteristics[i].characteristic == characteristic) {
+            return &characteristics[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_ACCESSORY_PRECOMPUTED_H
+#define HAP_ACCESSORY_PRECOMPUTED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Index hint that is passed if the index of a service or characteristic is not known.
+ */
+#define kHAPPrecomputedAttributeDatabase_UnknownIndex ((size_t) SIZE_MAX)
+
+/**
+ * Gets the precomputed serializations of a service.
+ *
+ * - If the index of the service within the services of the accessory is known, the lookup takes constant time.
+ *
+ * @param      accessory            Accessory that provides the service.
+ * @param      service              Service.
+ * @param      serviceIndex         Index of the service within the services of the accessory.
+ *                                  kHAPPrecomputedAttributeDatabase_UnknownIndex if not known.
+ *
+ * @return Precomputed service      If the accessory has a precomputed attribute database that covers the service.
+ * @return NULL                     Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+const HAPPrecomputedService* _Nullable HAPAccessoryGetPrecomputedService(
+        const HAPAccessory* accessory,
+        const HAPService* service,
+        size_t serviceIndex);
+
+/**
+ * Gets the precomputed serializations of a characteristic.
+ *
+ * - If the index of the characteristic within the characteristics of the service is known,
+ *   the lookup takes constant time.
+ *
+ * @param      precomputedService   Precomputed service of the service that contains the characteristic.
+ * @param      characteristic       Characteristic.
+ * @param      characteristicIndex  Index of the characteristic within the characteristics of the service.
+ *                                  kHAPPrecomputedAttributeDatabase_UnknownIndex if not known.
+ *
+ * @return Precomputed characteristic If the precomputed service covers the characteristic.
+ * @return NULL                     Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+const HAPPrecomputedCharacteristic* _Nullable HAPPrecomputedServiceGetCharacteristic(
+        const HAPPrecomputedService* precomputedService,
+        const HAPCharacteristic* characteristic,
+        size_t characteristicIndex);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,336 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "AccessoryServer" };
+
+/**
+ * Number of serialized bytes that are hashed together with the running digest.
+ */
+#define kFingerprintBuilder_BlockBytes ((size_t) 128)
+
+/**
+ * Incremental hash over a serialization of the attribute database.
+ *
+ * - Only a one-shot SHA-256 is available, so the serialization is hashed in blocks. Each block is hashed together
+ *   with the digest of the previous blocks.
+ */
+typedef struct {
+    /** Digest of the previous blocks, followed by the current block. */
+    uint8_t bytes[SHA256_BYTES + kFingerprintBuilder_BlockBytes];
+
+    /** Number of bytes in the current block. */
+    size_t numBlockBytes;
+
+    /** Total number of serialized bytes. */
+    uint64_t numBytes;
+} FingerprintBuilder;
+
+static void FingerprintBuilderCompress(FingerprintBuilder* builder) {
+    HAPPrecondition(builder);
+
+    uint8_t digest[SHA256_BYTES];
+    HAP_sha256(digest, builder->bytes, SHA256_BYTES + builder->numBlockBytes);
+    HAPRawBufferCopyBytes(builder->bytes, digest, sizeof digest);
+    builder->numBlockBytes = 0;
+}
+
+static void FingerprintBuilderAppend(FingerprintBuilder* builder, const void* bytes_, size_t numBytes) {
+    HAPPrecondition(builder);
+    HAPPrecondition(bytes_);
+    const uint8_t* bytes = bytes_;
+
+    builder->numBytes += numBytes;
+    while (numBytes) {
+        if (builder->numBlockBytes == kFingerprintBuilder_BlockBytes) {
+            FingerprintBuilderCompress(builder);
+        }
+        size_t n = kFingerprintBuilder_BlockBytes - builder->numBlockBytes;
+        if (n > numBytes) {
+            n = numBytes;
+        }
+        HAPRawBufferCopyBytes(&builder->bytes[SHA256_BYTES + builder->numBlockBytes], bytes, n);
+        builder->numBlockBytes += n;
+        bytes += n;
+        numBytes -= n;
+    }
+}
+
+static void FingerprintBuilderAppendUInt64(FingerprintBuilder* builder, uint64_t value) {
+    uint8_t bytes[] = { HAPExpandLittleUInt64(value) };
+    FingerprintBuilderAppend(builder, bytes, sizeof bytes);
+}
+
+static void FingerprintBuilderAppendUUID(FingerprintBuilder* builder, const HAPUUID* uuid) {
+    HAPPrecondition(uuid);
+
+    FingerprintBuilderAppend(builder, uuid->bytes, sizeof uuid->bytes);
+}
+
+static void FingerprintBuilderAppendString(FingerprintBuilder* builder, const char* _Nullable string) {
+    if (!string) {
+        FingerprintBuilderAppendUInt64(builder, 0);
+        return;
+    }
+    size_t numBytes = HAPStringGetNumBytes(HAPNonnull(string));
+    FingerprintBuilderAppendUInt64(builder, (uint64_t) numBytes + 1);
+    FingerprintBuilderAppend(builder, HAPNonnull(string), numBytes);
+}
+
+static void FingerprintBuilderFinalize(FingerprintBuilder* builder, uint8_t fingerprint[_Nonnull SHA256_BYTES]) {
+    HAPPrecondition(fingerprint);
+
+    FingerprintBuilderAppendUInt64(builder, builder->numBytes);
+    FingerprintBuilderCompress(builder);
+    HAPRawBufferCopyBytes(fingerprint, builder->bytes, SHA256_BYTES);
+}
+
+/**
+ * Appends the properties of a characteristic as a bit mask.
+ */
+static void AppendCharacteristicProperties(FingerprintBuilder* builder, const HAPCharacteristicProperties* properties) {
+    HAPPrecondition(properties);
+
+    uint64_t mask = (uint64_t) properties->readable << 0U | (uint64_t) properties->writable << 1U |
+                    (uint64_t) properties->supportsEventNotification << 2U | (uint64_t) properties->hidden << 3U |
+                    (uint64_t) properties->readRequiresAdminPermissions << 4U |
+                    (uint64_t) properties->writeRequiresAdminPermissions << 5U |
+                    (uint64_t) properties->requiresTimedWrite << 6U |
+                    (uint64_t) properties->supportsAuthorizationData << 7U |
+                    (uint64_t) properties->ip.controlPoint << 8U |
+                    (uint64_t) properties->ip.supportsWriteResponse << 9U |
+                    (uint64_t) properties->ble.supportsBroadcastNotification << 10U |
+                    (uint64_t) properties->ble.supportsDisconnectedNotification << 11U |
+                    (uint64_t) properties->ble.readableWithoutSecurity << 12U |
+                    (uint64_t) properties->ble.writableWithoutSecurity << 13U;
+    FingerprintBuilderAppendUInt64(builder, mask);
+}
+
+/**
+ * Appends the format specific units and constraints of a characteristic.
+ */
+static void AppendCharacteristicConstraints(FingerprintBuilder* builder, const HAPCharacteristic* characteristic_) {
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Data: {
+            const HAPDataCharacteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maxLength);
+            return;
+        }
+        case kHAPCharacteristicFormat_Bool: {
+            return;
+        }
+        case kHAPCharacteristicFormat_UInt8: {
+            const HAPUInt8Characteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.minimumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maximumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.stepValue);
+            if (c->constraints.validValues) {
+                for (size_t i = 0; c->constraints.validValues[i]; i++) {
+                    FingerprintBuilderAppendUInt64(builder, 'V');
+                    FingerprintBuilderAppendUInt64(builder, *c->constraints.validValues[i]);
+                }
+            }
+            if (c->constraints.validValuesRanges) {
+                for (size_t i = 0; c->constraints.validValuesRanges[i]; i++) {
+                    FingerprintBuilderAppendUInt64(builder, 'R');
+                    FingerprintBuilderAppendUInt64(builder, c->constraints.validValuesRanges[i]->start);
+                    FingerprintBuilderAppendUInt64(builder, c->constraints.validValuesRanges[i]->end);
+                }
+            }
+            return;
+        }
+        case kHAPCharacteristicFormat_UInt16: {
+            const HAPUInt16Characteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.minimumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maximumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.stepValue);
+            return;
+        }
+        case kHAPCharacteristicFormat_UInt32: {
+            const HAPUInt32Characteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.minimumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maximumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.stepValue);
+            return;
+        }
+        case kHAPCharacteristicFormat_UInt64: {
+            const HAPUInt64Characteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.minimumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maximumValue);
+            FingerprintBuilderAppendUInt64(builder, c->constraints.stepValue);
+            return;
+        }
+        case kHAPCharacteristicFormat_Int: {
+            const HAPIntCharacteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, (uint32_t) c->constraints.minimumValue);
+            FingerprintBuilderAppendUInt64(builder, (uint32_t) c->constraints.maximumValue);
+            FingerprintBuilderAppendUInt64(builder, (uint32_t) c->constraints.stepValue);
+            return;
+        }
+        case kHAPCharacteristicFormat_Float: {
+            const HAPFloatCharacteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->units);
+            FingerprintBuilderAppendUInt64(builder, HAPFloatGetBitPattern(c->constraints.minimumValue));
+            FingerprintBuilderAppendUInt64(builder, HAPFloatGetBitPattern(c->constraints.maximumValue));
+            FingerprintBuilderAppendUInt64(builder, HAPFloatGetBitPattern(c->constraints.stepValue));
+            return;
+        }
+        case kHAPCharacteristicFormat_String: {
+            const HAPStringCharacteristic* c = characteristic_;
+            FingerprintBuilderAppendUInt64(builder, c->constraints.maxLength);
+            return;
+        }
+        case kHAPCharacteristicFormat_TLV8: {
+            return;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Appends the services and characteristics of an accessory.
+ */
+static void AppendAccessory(FingerprintBuilder* builder, const HAPAccessory* accessory, bool isBridged) {
+    HAPPrecondition(accessory);
+
+    FingerprintBuilderAppendUInt64(builder, 'A');
+    FingerprintBuilderAppendUInt64(builder, accessory->aid);
+
+    // A firmware update of the primary accessory is detected separately.
+    // Firmware updates of bridged accessories are configuration changes of the bridge.
+    if (isBridged) {
+        FingerprintBuilderAppendString(builder, accessory->firmwareVersion);
+    }
+
+    if (!accessory->services) {
+        return;
+    }
+    for (size_t i = 0; accessory->services[i]; i++) {
+        const HAPService* service = accessory->services[i];
+        FingerprintBuilderAppendUInt64(builder, 'S');
+        FingerprintBuilderAppendUInt64(builder, service->iid);
+        FingerprintBuilderAppendUUID(builder, service->serviceType);
+        FingerprintBuilderAppendUInt64(
+                builder,
+                (uint64_t) service->properties.primaryService << 0U | (uint64_t) service->properties.hidden << 1U |
+                        (uint64_t) service->properties.ble.supportsConfiguration << 2U);
+        if (service->linkedServices) {
+            for (size_t j = 0; service->linkedServices[j]; j++) {
+                FingerprintBuilderAppendUInt64(builder, 'L');
+                FingerprintBuilderAppendUInt64(builder, service->linkedServices[j]);
+            }
+        }
+
+        if (!service->characteristics) {
+            continue;
+        }
+        for (size_t j = 0; service->characteristics[j]; j++) {
+            const HAPBaseCharacteristic* characteristic = service->characteristics[j];
+            FingerprintBuilderAppendUInt64(builder, 'C');
+            FingerprintBuilderAppendUInt64(builder, characteristic->iid);
+            FingerprintBuilderAppendUUID(builder, characteristic->characteristicType);
+            FingerprintBuilderAppendUInt64(builder, characteristic->format);
+            AppendCharacteristicProperties(builder, &characteristic->properties);
+            FingerprintBuilderAppendString(builder, characteristic->manufacturerDescription);
+            AppendCharacteristicConstraints(builder, characteristic);
+        }
+    }
+}
+
+void HAPAccessoryServerGetDatabaseFingerprint(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        uint8_t fingerprint[_Nonnull SHA256_BYTES]) {
+    HAPPrecondition(primaryAccessory);
+    HAPPrecondition(fingerprint);
+
+    FingerprintBuilder builder;
+    HAPRawBufferZero(&builder, sizeof builder);
+
+    AppendAccessory(&builder, primaryAccessory, /* isBridged: */ false);
+    if (bridgedAccessories) {
+        for (size_t i = 0; bridgedAccessories[i]; i++) {
+            AppendAccessory(&builder, HAPNonnull(bridgedAccessories[i]), /* isBridged: */ true);
+        }
+    }
+
+    FingerprintBuilderFinalize(&builder, fingerprint);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateDatabaseFingerprint(
+        HAPPlatformKeyValueStoreRef keyValueStore,
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        bool didIncrementCN) {
+    HAPPrecondition(keyValueStore);
+    HAPPrecondition(primaryAccessory);
+
+    HAPError err;
+
+    uint8_t fingerprint[SHA256_BYTES];
+    HAPAccessoryServerGetDatabaseFingerprint(primaryAccessory, bridgedAccessories, fingerprint);
+
+    // Load fingerprint of the previous start.
+    uint8_t previousFingerprint[SHA256_BYTES];
+    bool found;
+    size_t numBytes;
+    err = HAPPlatformKeyValueStoreGet(
+            keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_DatabaseFingerprint,
+            previousFingerprint,
+            sizeof previousFingerprint,
+            &numBytes,
+            &found);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    if (found && numBytes == sizeof previousFingerprint &&
+        HAPRawBufferAreEqual(fingerprint, previousFingerprint, sizeof fingerprint)) {
+        return kHAPError_None;
+    }
+
+    // Increment configuration number.
+    // Without a previous fingerprint the attribute database is either new, or changes have been tracked by the
+    // firmware version and the configurationChanged flag of HAPAccessoryServerStartBridge so far.
+    if (!found) {
+        HAPLogInfo(&logObject, "Storing initial attribute database fingerprint.");
+    } else if (didIncrementCN) {
+        HAPLogInfo(&logObject, "Attribute database changed. CN has already been incremented.");
+    } else {
+        HAPLogInfo(&logObject, "Attribute database changed. Incrementing CN.");
+        err = HAPAccessoryServerIncrementCN(keyValueStore);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+    }
+
+    // Store fingerprint.
+    err = HAPPlatformKeyValueStoreSet(
+            keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_DatabaseFingerprint,
+            fingerprint,
+            sizeof fingerprint);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    return kHAPError_None;
+}
@@ -58,6 +58,30 @@ typedef struct {
     /** Maximum number of allowed pairings. */
     HAPPlatformKeyValueStoreKey maxPairings;
 
+    /** Characteristic value cache. */
+    struct {
+        /** Storage for cache entries. */
+        HAPCharacteristicValueCacheEntryRef* _Nullable entries;
+
+        /** Number of cache entries. */
+        size_t numEntries;
+
+        /** Characteristic whose handleWrite callback is being called. NULL otherwise. */
+        const HAPCharacteristic* _Nullable writeCharacteristic;
+
+        /** Accessory ID of the characteristic whose handleWrite callback is being called. */
+        uint64_t writeAID;
+
+        /** Whether a value has been published by the handleWrite callback that is being called. */
+        bool writeValueWasUpdated : 1;
+
+        /** Timer that on expiry raises deferred event notifications. */
+        HAPPlatformTimerRef flushTimer;
+
+        /** Deadline of the flush timer. */
+        HAPTime flushDeadline;
+    } valueCache;
+
     /** Accessory to serve. */
     const HAPAccessory* _Nullable primaryAccessory;
 
@@ -134,11 +158,19 @@ typedef struct {
         uint8_t M1[SRP_PROOF_BYTES];
         uint8_t M2[SRP_PROOF_BYTES];
 
+        uint8_t mfiProof[kHAPMFiHWAuth_MaxSignatureBytes]; // M4, if created asynchronously
+        uint8_t numMFiProofBytes;
+
         /** Pairing Type flags. */
         uint32_t flags;
 
         bool flagsPresent : 1;  /**< Whether Pairing Type flags were present in Pair Setup M1. */
         bool keepSetupInfo : 1; /**< Whether setup info should be kept on disconnect. */
+
+        bool publicKeyIsAvailable : 1;  /**< Whether B has been derived while processing Pair Setup M1. */
+        bool sessionKeyIsAvailable : 1; /**< Whether K has been derived while processing Pair Setup M3. */
+        bool publicKeyAIsIllegal : 1;   /**< Whether A has been found illegal while processing Pair Setup M3. */
+        bool mfiProofIsAvailable : 1;   /**< Whether the MFi proof has been created while processing Pair Setup M3. */
     } pairSetup;
 
     /**
@@ -163,6 +195,9 @@ typedef struct {
         /** The number of active sessions served by the accessory server. */
         size_t numSessions;
 
+        /** List of IP sessions that are not in use, linked through HAPIPSessionDescriptor.nextFreeSession. */
+        HAPIPSession* _Nullable freeSessions;
+
         /**
          * Characteristic write request context.
          */
@@ -194,6 +229,23 @@ typedef struct {
 
         /** Currently registered Bonjour service. */
         HAPIPServiceDiscoveryType discoverableService;
+
+        /** Cached TXT record values of the _hap service. */
+        HAPIPServiceDiscoveryTXTRecordCache txtRecordCache;
+
+        /** Identifier of the most recently started pairing cryptography job. */
+        uint32_t lastPairingCryptoJobID;
+
+        /**
+         * Pending asynchronous creation of the MFi proof for Pair Setup M4.
+         */
+        struct {
+            /** The session for which the MFi proof is created. NULL if no creation is pending. */
+            HAPSessionRef* _Nullable session;
+
+            /** Pairing cryptography job that defers the response to Pair Setup M3. */
+            uint32_t jobID;
+        } pairSetupMFiProofJob;
     } ip;
 
     /**
@@ -235,9 +287,95 @@ typedef struct {
             bool procedureAttached : 1;
         } connection;
 
+        /**
+         * GATT table index.
+         *
+         * - Built when the GATT database is registered.
+         */
+        struct {
+            /** Number of used GATT table elements. */
+            uint16_t numElements;
+
+            /** Lowest attribute handle of the GATT table elements. */
+            HAPPlatformBLEPeripheralManagerAttributeHandle firstHandle;
+
+            /**
+             * Number of attribute handles covered by each lookup bucket.
+             *
+             * - 0 if attribute handles were not assigned in ascending order. Lookups fall back to a linear search.
+             */
+            uint16_t numHandlesPerBucket;
+
+            /**
+             * Index of the GATT table element that covers each attribute handle starting at firstHandle.
+             *
+             * - Taken from the precomputed attribute database of the accessory.
+             *
+             * - NULL if not available or if the assigned attribute handles do not match it. Lookup buckets are used.
+             */
+            const uint16_t* _Nullable elementIndices;
+
+            /** Number of attribute handles covered by elementIndices. */
+            uint16_t numElementIndices;
+
+            /** Index + 1 of the first GATT table element with a pending event. 0 if no events are pending. */
+            uint16_t pendingEventsHead;
+
+            /** Index + 1 of the last GATT table element with a pending event. 0 if no events are pending. */
+            uint16_t pendingEventsTail;
+        } gattTable;
+
         /** Timestamp for Least Recently Used scheme in Pair Resume session cache. */
         uint32_t sessionCacheTimestamp;
 
+        /**
+         * In-memory copy of the BLE state that is persisted in the key-value store.
+         *
+         * - Each part is loaded from the key-value store when the accessory server is started, or on first use.
+         *   Changes are written through to the key-value store only if a value actually changes.
+         *
+         * - The key-value store must not be modified by other means while the accessory server is running.
+         */
+        struct {
+            /** GSN state. */
+            HAPBLEAccessoryServerGSN gsn;
+
+            /** GSN after which the broadcast encryption key expires. 0 if key is expired. */
+            uint16_t keyExpirationGSN;
+
+            /** Broadcast encryption key, if keyExpirationGSN is not 0. */
+            HAPBLEAccessoryServerBroadcastEncryptionKey broadcastKey;
+
+            /** Accessory advertising identifier, if hasAdvertisingID is set. */
+            HAPDeviceID advertisingID;
+
+            /** Device ID. */
+            HAPDeviceID deviceID;
+
+            /** Key of the characteristic configuration of the primary accessory, if numBroadcasts is not 0. */
+            HAPPlatformKeyValueStoreKey configurationKey;
+
+            /** Number of characteristics of the primary accessory that have broadcasts enabled. */
+            uint8_t numBroadcasts;
+
+            /**
+             * Instance IDs of the characteristics of the primary accessory that have broadcasts enabled.
+             *
+             * - Sorted in ascending order, like the entries in the key-value store. Looked up by binary search.
+             */
+            uint16_t broadcastCIDs[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+
+            /** Broadcast interval of the characteristic with the instance ID at the same index in broadcastCIDs. */
+            HAPBLECharacteristicBroadcastInterval
+                    broadcastIntervals[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+
+            bool gsnIsLoaded : 1;                  /**< Whether the GSN state has been loaded. */
+            bool broadcastParametersAreLoaded : 1; /**< Whether the broadcast parameters have been loaded. */
+            bool hasAdvertisingID : 1;             /**< Whether an advertising identifier has been set. */
+            bool deviceIDIsLoaded : 1;             /**< Whether the Device ID has been loaded. */
+            bool configurationIsLoaded : 1;        /**< Whether the characteristic configuration has been loaded. */
+        } persistentState;
+
         /**
          * Advertisement state.
          */
@@ -413,6 +551,43 @@ HAPError HAPAccessoryServerGetCN(HAPPlatformKeyValueStoreRef keyValueStore, uint
 HAP_RESULT_USE_CHECK
 HAPError HAPAccessoryServerIncrementCN(HAPPlatformKeyValueStoreRef keyValueStore);
 
+/**
+ * Computes a fingerprint of the attribute database.
+ *
+ * - The fingerprint covers the accessory IDs, service and characteristic instance IDs, types, properties,
+ *   formats, units and constraints, as well as the firmware versions of bridged accessories.
+ *   Characteristic values and accessory information that is not part of the attribute database do not affect it.
+ *
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories. NULL if not a bridge.
+ * @param[out] fingerprint          Fingerprint.
+ */
+void HAPAccessoryServerGetDatabaseFingerprint(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        uint8_t fingerprint[_Nonnull SHA256_BYTES]);
+
+/**
+ * Compares the fingerprint of the attribute database with the one stored at the previous start,
+ * and increments the configuration number if it changed.
+ *
+ * - No configuration number increment happens when no fingerprint has been stored yet.
+ *
+ * @param      keyValueStore        Key-value store.
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories. NULL if not a bridge.
+ * @param      didIncrementCN       Whether the configuration number has already been incremented for this start.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If persistent store access failed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateDatabaseFingerprint(
+        HAPPlatformKeyValueStoreRef keyValueStore,
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        bool didIncrementCN);
+
 /**
  * Resets HomeKit state after a firmware update has occurred.
  *
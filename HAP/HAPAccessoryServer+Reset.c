@@ -77,13 +77,14 @@ HAPError HAPHandleFirmwareUpdate(HAPAccessoryServerRef* server_) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
         }
+        server->ble.persistentState.gsnIsLoaded = false;
     }
 
     // BLE: Reset Broadcast Encryption Key.
     // See HomeKit Accessory Protocol Specification R14
     // Section 7.4.7.4 Broadcast Encryption Key expiration and refresh
     if (server->transports.ble) {
-        err = HAPNonnull(server->transports.ble)->broadcast.expireKey(keyValueStore);
+        err = HAPNonnull(server->transports.ble)->broadcast.expireKey(server_);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -0,0 +1,634 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+#include "util_base64.h"
+
+/**
+ * Maximum length of an Accessory Certificate of an Apple Authentication Coprocessor.
+ *
+ * See Accessory Interface Specification R29
+ * Section 69.8.2.11 Accessory Certificate Data Length
+ */
+#define kHAPAccessoryServerStorage_MaxMFiCertificateBytes ((size_t) 1280)
+
+/**
+ * Maximum length of an MFi proof of an Apple Authentication Coprocessor.
+ *
+ * See Accessory Interface Specification R29
+ * Section 69.8.2.7 Challenge Response Data Length
+ */
+#define kHAPAccessoryServerStorage_MaxMFiProofBytes ((size_t) 128)
+
+/**
+ * Maximum number of JSON bytes of a float value.
+ */
+#define kHAPAccessoryServerStorage_MaxFloatBytes (kHAPFloat_MaxDescriptionBytes - 1)
+
+/**
+ * Maximum number of JSON bytes of a HAP status code.
+ */
+#define kHAPAccessoryServerStorage_MaxStatusBytes (sizeof "-70410" - 1)
+
+/**
+ * Maximum length of a JSON response header: status line, Content-Type and Content-Length.
+ */
+#define kHAPAccessoryServerStorage_MaxJSONResponseHeaderBytes \
+    (sizeof "HTTP/1.1 207 Multi-Status\r\n" \
+            "Content-Type: application/hap+json\r\n" \
+            "Content-Length: 4294967295\r\n\r\n" - \
+     1)
+
+/**
+ * Maximum length of a pairing response header: status line, Content-Type and Content-Length.
+ */
+#define kHAPAccessoryServerStorage_MaxPairingResponseHeaderBytes \
+    (sizeof "HTTP/1.1 200 OK\r\n" \
+            "Content-Type: application/pairing+tlv8\r\n" \
+            "Content-Length: 4294967295\r\n\r\n" - \
+     1)
+
+/**
+ * Maximum length of the chunk framing of a GET /accessories response chunk, excluding the chunk length.
+ *
+ * - Chunk length terminator, chunk data terminator and last chunk.
+ */
+#define kHAPAccessoryServerStorage_NumChunkFramingBytes (sizeof "\r\n" "\r\n0\r\n\r\n" - 1)
+
+/**
+ * Maximum number of bytes of GET /accessories response elements that are not characteristic values or descriptions.
+ *
+ * - Corresponds to the scratch buffer that is used to serialize UUIDs and numbers.
+ */
+#define kHAPAccessoryServerStorage_MaxAccessoriesScalarElementBytes ((size_t) 64)
+
+/**
+ * Returns the number of bytes of a TLV item with a value of a given length, including fragmentation.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumTLVBytes(size_t numValueBytes) {
+    size_t numFragments = numValueBytes ? (numValueBytes + UINT8_MAX - 1) / UINT8_MAX : 1;
+    return numFragments * 2 + numValueBytes;
+}
+
+/**
+ * Returns the number of hexadecimal digits of a value.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumHexDigits(size_t value) {
+    size_t numDigits = 1;
+    while (value >= 0x10) {
+        value >>= 4;
+        numDigits++;
+    }
+    return numDigits;
+}
+
+/**
+ * Returns whether a characteristic transfers pairing messages.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsPairingCharacteristic(const HAPBaseCharacteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    return HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_PairSetup) ||
+           HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_PairVerify) ||
+           HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_PairingPairings);
+}
+
+/**
+ * Returns the maximum length of a pairing message.
+ *
+ * - Pair Verify, Pair Setup M1, M5, M6, Add Pairing and Remove Pairing messages are shorter than Pair Setup M3.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetMaxPairingMessageBytes(HAPPlatformKeyValueStoreKey maxPairings) {
+    size_t numStateBytes = GetNumTLVBytes(1);
+
+    // Pair Setup M2: State, Salt, Public Key.
+    size_t numM2Bytes = numStateBytes + GetNumTLVBytes(SRP_SALT_BYTES) + GetNumTLVBytes(SRP_PUBLIC_KEY_BYTES);
+
+    // Pair Setup M3: State, Public Key, Proof.
+    size_t numM3Bytes = numStateBytes + GetNumTLVBytes(SRP_PUBLIC_KEY_BYTES) + GetNumTLVBytes(SRP_PROOF_BYTES);
+
+    // Pair Setup M4: State, Proof, Encrypted Data containing the MFi proof and the Accessory Certificate.
+    size_t numM4SubBytes = GetNumTLVBytes(kHAPAccessoryServerStorage_MaxMFiProofBytes) +
+                           GetNumTLVBytes(kHAPAccessoryServerStorage_MaxMFiCertificateBytes);
+    size_t numM4Bytes = numStateBytes + GetNumTLVBytes(SRP_PROOF_BYTES) +
+                        GetNumTLVBytes(numM4SubBytes + CHACHA20_POLY1305_TAG_BYTES);
+
+    // List Pairings M2: State, and per pairing Identifier, Public Key, Permissions, separated by Separators.
+    size_t numPairingBytes = GetNumTLVBytes(sizeof(HAPPairingID)) + GetNumTLVBytes(sizeof(HAPPairingPublicKey)) +
+                             GetNumTLVBytes(1);
+    size_t numListPairingsBytes = numStateBytes + maxPairings * numPairingBytes;
+    if (maxPairings) {
+        numListPairingsBytes += (size_t)(maxPairings - 1) * GetNumTLVBytes(0);
+    }
+
+    return HAPMax(HAPMax(numM2Bytes, numM3Bytes), HAPMax(numM4Bytes, numListPairingsBytes));
+}
+
+/**
+ * Returns the maximum length of the raw value of a string, data or TLV8 characteristic. 0 for other formats.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetMaxRawValueBytes(
+        const HAPBaseCharacteristic* characteristic,
+        size_t maxTLV8Bytes,
+        size_t maxPairingMessageBytes) {
+    HAPPrecondition(characteristic);
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_String: {
+            return ((const HAPStringCharacteristic*) characteristic)->constraints.maxLength;
+        }
+        case kHAPCharacteristicFormat_Data: {
+            // Service Signature values are empty. See HAPHandleServiceSignatureRead.
+            if (HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_ServiceSignature)) {
+                return 0;
+            }
+            return ((const HAPDataCharacteristic*) characteristic)->constraints.maxLength;
+        }
+        case kHAPCharacteristicFormat_TLV8: {
+            return IsPairingCharacteristic(characteristic) ? maxPairingMessageBytes : maxTLV8Bytes;
+        }
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64:
+        case kHAPCharacteristicFormat_Int:
+        case kHAPCharacteristicFormat_Float: {
+            return 0;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Returns the maximum number of bytes that a value of a characteristic occupies in the IP scratch buffer.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetMaxIPScratchValueBytes(const HAPBaseCharacteristic* characteristic, size_t maxTLV8Bytes) {
+    HAPPrecondition(characteristic);
+
+    size_t numRawBytes = GetMaxRawValueBytes(characteristic, maxTLV8Bytes, /* maxPairingMessageBytes: */ 0);
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_String: {
+            // NULL-terminated.
+            return numRawBytes + 1;
+        }
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_TLV8: {
+            // NULL-terminated base64.
+            return util_base64_encoded_len(numRawBytes) + 1;
+        }
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64:
+        case kHAPCharacteristicFormat_Int:
+        case kHAPCharacteristicFormat_Float: {
+            return 0;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Returns the maximum number of bytes of the JSON representation of a value of a characteristic.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetMaxJSONValueBytes(const HAPBaseCharacteristic* characteristic, size_t maxTLV8Bytes) {
+    HAPPrecondition(characteristic);
+
+    size_t numRawBytes = GetMaxRawValueBytes(characteristic, maxTLV8Bytes, /* maxPairingMessageBytes: */ 0);
+    size_t numValueBytes = 0;
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool: {
+            numValueBytes = sizeof "false" - 1;
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            numValueBytes = HAPUInt64GetNumDescriptionBytes(
+                    ((const HAPUInt8Characteristic*) characteristic)->constraints.maximumValue);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            numValueBytes = HAPUInt64GetNumDescriptionBytes(
+                    ((const HAPUInt16Characteristic*) characteristic)->constraints.maximumValue);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            numValueBytes = HAPUInt64GetNumDescriptionBytes(
+                    ((const HAPUInt32Characteristic*) characteristic)->constraints.maximumValue);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            numValueBytes = HAPUInt64GetNumDescriptionBytes(
+                    ((const HAPUInt64Characteristic*) characteristic)->constraints.maximumValue);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            const HAPIntCharacteristic* intCharacteristic = (const HAPIntCharacteristic*) characteristic;
+            numValueBytes = HAPMax(
+                    HAPInt32GetNumDescriptionBytes(intCharacteristic->constraints.minimumValue),
+                    HAPInt32GetNumDescriptionBytes(intCharacteristic->constraints.maximumValue));
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            numValueBytes = kHAPAccessoryServerStorage_MaxFloatBytes;
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            // Quotation marks. Control characters are escaped as \u00XX.
+            numValueBytes = 2 + 6 * numRawBytes;
+        } break;
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_TLV8: {
+            // Quotation marks. Base64 does not need to be escaped.
+            numValueBytes = 2 + util_base64_encoded_len(numRawBytes);
+        } break;
+    }
+
+    // Failed reads and Programmable Switch Event reads are serialized as null.
+    return HAPMax(numValueBytes, sizeof "null" - 1);
+}
+
+/**
+ * Returns the number of bytes of the metadata of a characteristic in a GET /characteristics response.
+ *
+ * - Mirrors HAPIPAccessoryProtocolGetNumCharacteristicReadResponseBytes with meta=1.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumReadResponseMetadataBytes(const HAPBaseCharacteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    // ,"format":"...".
+    size_t r = 0;
+    HAPCharacteristicUnits unit = kHAPCharacteristicUnits_None;
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool: {
+            r = 16;
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            const HAPUInt8Characteristic* chr = (const HAPUInt8Characteristic*) characteristic;
+            r = 17;
+            unit = chr->units;
+            if (chr->constraints.minimumValue || chr->constraints.maximumValue != UINT8_MAX) {
+                r += 35 + HAPUInt64GetNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            const HAPUInt16Characteristic* chr = (const HAPUInt16Characteristic*) characteristic;
+            r = 18;
+            unit = chr->units;
+            if (chr->constraints.minimumValue || chr->constraints.maximumValue != UINT16_MAX) {
+                r += 35 + HAPUInt64GetNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            const HAPUInt32Characteristic* chr = (const HAPUInt32Characteristic*) characteristic;
+            r = 18;
+            unit = chr->units;
+            if (chr->constraints.minimumValue || chr->constraints.maximumValue != UINT32_MAX) {
+                r += 35 + HAPUInt64GetNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            const HAPUInt64Characteristic* chr = (const HAPUInt64Characteristic*) characteristic;
+            r = 18;
+            unit = chr->units;
+            if (chr->constraints.minimumValue || chr->constraints.maximumValue != UINT64_MAX) {
+                r += 35 + HAPUInt64GetNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPUInt64GetNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            const HAPIntCharacteristic* chr = (const HAPIntCharacteristic*) characteristic;
+            r = 15;
+            unit = chr->units;
+            if (chr->constraints.minimumValue != INT32_MIN || chr->constraints.maximumValue != INT32_MAX) {
+                r += 35 + HAPInt32GetNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPInt32GetNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPInt32GetNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            const HAPFloatCharacteristic* chr = (const HAPFloatCharacteristic*) characteristic;
+            r = 17;
+            unit = chr->units;
+            if (!(HAPFloatIsInfinite(chr->constraints.minimumValue) && chr->constraints.minimumValue < 0) ||
+                !(HAPFloatIsInfinite(chr->constraints.maximumValue) && chr->constraints.maximumValue > 0)) {
+                r += 35 + HAPJSONUtilsGetFloatNumDescriptionBytes(chr->constraints.minimumValue) +
+                     HAPJSONUtilsGetFloatNumDescriptionBytes(chr->constraints.maximumValue) +
+                     HAPJSONUtilsGetFloatNumDescriptionBytes(chr->constraints.stepValue);
+            }
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            const HAPStringCharacteristic* chr = (const HAPStringCharacteristic*) characteristic;
+            r = 18;
+            if (chr->constraints.maxLength != 64) {
+                r += 10 + HAPUInt64GetNumDescriptionBytes(chr->constraints.maxLength);
+            }
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            r = 16;
+        } break;
+        case kHAPCharacteristicFormat_Data: {
+            const HAPDataCharacteristic* chr = (const HAPDataCharacteristic*) characteristic;
+            r = 16;
+            if (chr->constraints.maxLength != 2097152) {
+                r += 14 + HAPUInt64GetNumDescriptionBytes(chr->constraints.maxLength);
+            }
+        } break;
+    }
+
+    // ,"unit":"...".
+    switch (unit) {
+        case kHAPCharacteristicUnits_None: {
+        } break;
+        case kHAPCharacteristicUnits_Celsius:
+        case kHAPCharacteristicUnits_Seconds: {
+            r += 17;
+        } break;
+        case kHAPCharacteristicUnits_ArcDegrees:
+        case kHAPCharacteristicUnits_Percentage: {
+            r += 20;
+        } break;
+        case kHAPCharacteristicUnits_Lux: {
+            r += 13;
+        } break;
+    }
+
+    return r;
+}
+
+/**
+ * Returns the maximum number of bytes of a characteristic signature read response over Bluetooth LE.
+ *
+ * - Mirrors HAPBLECharacteristicGetSignatureReadResponse.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetMaxBLECharacteristicSignatureBytes(const HAPBaseCharacteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    // Characteristic Type, Service Instance ID, Service Type, HAP Characteristic Properties Descriptor,
+    // GATT Presentation Format Descriptor.
+    size_t r = GetNumTLVBytes(sizeof(HAPUUID)) + GetNumTLVBytes(sizeof(uint16_t)) + GetNumTLVBytes(sizeof(HAPUUID)) +
+               GetNumTLVBytes(sizeof(uint16_t)) + GetNumTLVBytes(7);
+
+    // GATT User Description Descriptor.
+    if (characteristic->manufacturerDescription) {
+        r += GetNumTLVBytes(HAPStringGetNumBytes(HAPNonnull(characteristic->manufacturerDescription)));
+    }
+
+    // GATT Valid Range, HAP Step Value Descriptor.
+    r += GetNumTLVBytes(2 * sizeof(uint64_t)) + GetNumTLVBytes(sizeof(uint64_t));
+
+    // HAP Valid Values Descriptor, HAP Valid Values Range Descriptor.
+    if (characteristic->format == kHAPCharacteristicFormat_UInt8) {
+        const HAPUInt8Characteristic* chr = (const HAPUInt8Characteristic*) characteristic;
+        if (chr->constraints.validValues) {
+            size_t numValidValues = 0;
+            while (chr->constraints.validValues[numValidValues]) {
+                numValidValues++;
+            }
+            r += GetNumTLVBytes(numValidValues);
+        }
+        if (chr->constraints.validValuesRanges) {
+            size_t numValidValuesRanges = 0;
+            while (chr->constraints.validValuesRanges[numValidValuesRanges]) {
+                numValidValuesRanges++;
+            }
+            r += GetNumTLVBytes(2 * numValidValuesRanges);
+        }
+    }
+
+    return r;
+}
+
+/**
+ * Accumulated IP requirements of an accessory attribute database.
+ */
+typedef struct {
+    size_t numReadContexts;
+    size_t numWriteContexts;
+    size_t numEventNotifications;
+    size_t numReadScratchBytes;
+    size_t numWriteResponseScratchBytes;
+    size_t numEventScratchBytes;
+    size_t numReadRequestURIBytes;
+    size_t maxReadResponseBytes;
+    size_t maxEventNotificationBytes;
+    size_t maxWriteRequestBytes;
+    size_t maxWriteResponseBytes;
+    size_t maxAccessoriesElementBytes;
+} IPRequirements;
+
+static void AccumulateIPRequirements(
+        const HAPAccessory* accessory,
+        size_t maxTLV8Bytes,
+        IPRequirements* requirements) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(requirements);
+
+    if (!accessory->services) {
+        return;
+    }
+    for (size_t i = 0; accessory->services[i]; i++) {
+        const HAPService* service = accessory->services[i];
+        if (HAPUUIDAreEqual(service->serviceType, &kHAPServiceType_Pairing) || !service->characteristics) {
+            continue;
+        }
+        for (size_t j = 0; service->characteristics[j]; j++) {
+            const HAPBaseCharacteristic* characteristic = service->characteristics[j];
+            if (!HAPIPCharacteristicIsSupported(characteristic)) {
+                continue;
+            }
+            bool isReadable = characteristic->properties.readable;
+            bool isWritable = characteristic->properties.writable;
+            bool supportsEventNotification = characteristic->properties.supportsEventNotification;
+
+            size_t numIDBytes = HAPUInt64GetNumDescriptionBytes(accessory->aid) +
+                                HAPUInt64GetNumDescriptionBytes(characteristic->iid);
+            size_t numValueBytes = GetMaxJSONValueBytes(characteristic, maxTLV8Bytes);
+            size_t numScratchValueBytes = GetMaxIPScratchValueBytes(characteristic, maxTLV8Bytes);
+
+            // GET /characteristics?id=...&meta=1&perms=1&type=1&ev=1 (207 Multi-Status).
+            if (isReadable || supportsEventNotification) {
+                requirements->numReadContexts++;
+                requirements->numReadScratchBytes += numScratchValueBytes;
+                requirements->numReadRequestURIBytes += numIDBytes + sizeof ".," - 1;
+
+                size_t numProperties = HAPCharacteristicGetNumEnabledProperties(characteristic);
+                requirements->maxReadResponseBytes +=
+                        16 + numIDBytes + 10 + HAPUUIDGetNumDescriptionBytes(characteristic->characteristicType) +
+                        HAPMax(20 + numValueBytes, 10 + kHAPAccessoryServerStorage_MaxStatusBytes) + 11 +
+                        (numProperties ? numProperties * 5 - 1 : 0) + 11 +
+                        GetNumReadResponseMetadataBytes(characteristic);
+            }
+
+            // Event notifications.
+            if (supportsEventNotification) {
+                requirements->numEventNotifications++;
+                requirements->numEventScratchBytes += numScratchValueBytes;
+                requirements->maxEventNotificationBytes += 25 + numIDBytes + numValueBytes;
+            }
+
+            // PUT /characteristics.
+            if (isWritable || supportsEventNotification) {
+                requirements->numWriteContexts++;
+                requirements->maxWriteRequestBytes +=
+                        sizeof ",{\"aid\":,\"iid\":,\"value\":,\"ev\":false,\"remote\":false,\"r\":false}" - 1 +
+                        numIDBytes + numValueBytes;
+                requirements->maxWriteResponseBytes += 26 + numIDBytes + kHAPAccessoryServerStorage_MaxStatusBytes;
+                if (characteristic->properties.ip.supportsWriteResponse) {
+                    requirements->numWriteResponseScratchBytes += numScratchValueBytes;
+                    requirements->maxWriteResponseBytes += 9 + numValueBytes;
+                }
+            }
+
+            // GET /accessories.
+            if (isReadable) {
+                // Values are read in place and escaped within the element.
+                size_t numElementBytes = 2 + HAPMax(numValueBytes - 2, numScratchValueBytes);
+                requirements->maxAccessoriesElementBytes =
+                        HAPMax(requirements->maxAccessoriesElementBytes, numElementBytes);
+            }
+            if (characteristic->manufacturerDescription) {
+                const char* description = HAPNonnull(characteristic->manufacturerDescription);
+                size_t numElementBytes =
+                        2 + HAPJSONUtilsGetNumEscapedStringDataBytes(description, HAPStringGetNumBytes(description));
+                requirements->maxAccessoriesElementBytes =
+                        HAPMax(requirements->maxAccessoriesElementBytes, numElementBytes);
+            }
+        }
+    }
+}
+
+void HAPAccessoryServerGetStorageRequirements(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        HAPPlatformKeyValueStoreKey maxPairings,
+        size_t maxTLV8Bytes,
+        HAPAccessoryServerStorageRequirements* requirements) {
+    HAPPrecondition(primaryAccessory);
+    HAPPrecondition(requirements);
+
+    HAPRawBufferZero(requirements, sizeof *requirements);
+
+    size_t maxPairingMessageBytes = GetMaxPairingMessageBytes(maxPairings);
+    requirements->maxPairingMessageBytes = maxPairingMessageBytes;
+
+    // HAP over IP.
+    {
+        // Length prefix and authentication tag of an encrypted frame.
+        size_t numFrameOverheadBytes = HAPIPSecurityProtocolGetNumEncryptedBytes(1) - 1;
+
+        IPRequirements ip;
+        HAPRawBufferZero(&ip, sizeof ip);
+        ip.maxAccessoriesElementBytes = kHAPAccessoryServerStorage_MaxAccessoriesScalarElementBytes;
+        AccumulateIPRequirements(primaryAccessory, maxTLV8Bytes, &ip);
+        if (bridgedAccessories) {
+            for (size_t i = 0; bridgedAccessories[i]; i++) {
+                AccumulateIPRequirements(HAPNonnull(bridgedAccessories[i]), maxTLV8Bytes, &ip);
+            }
+        }
+
+        // Response bodies: {"characteristics":[...]}. The first element is not preceded by a comma.
+        ip.maxReadResponseBytes = 22 + (ip.maxReadResponseBytes ? ip.maxReadResponseBytes - 1 : 0);
+        ip.maxEventNotificationBytes = 22 + (ip.maxEventNotificationBytes ? ip.maxEventNotificationBytes - 1 : 0);
+        ip.maxWriteRequestBytes = 22 + (ip.maxWriteRequestBytes ? ip.maxWriteRequestBytes - 1 : 0);
+        ip.maxWriteResponseBytes = 22 + (ip.maxWriteResponseBytes ? ip.maxWriteResponseBytes - 1 : 0);
+
+        requirements->ip.numReadContexts = ip.numReadContexts;
+        requirements->ip.numWriteContexts = ip.numWriteContexts;
+        requirements->ip.numEventNotifications = ip.numEventNotifications;
+        requirements->ip.maxReadResponseBytes = ip.maxReadResponseBytes;
+        requirements->ip.maxEventNotificationBytes = ip.maxEventNotificationBytes;
+        requirements->ip.maxWriteRequestBytes = ip.maxWriteRequestBytes;
+        requirements->ip.maxWriteResponseBytes = ip.maxWriteResponseBytes;
+        requirements->ip.maxAccessoriesElementBytes = ip.maxAccessoriesElementBytes;
+
+        // Scratch buffer: values that are read at once, and pairing messages.
+        requirements->ip.numScratchBufferBytes = HAPMax(
+                HAPMax(ip.numReadScratchBytes, ip.numEventScratchBytes),
+                HAPMax(ip.numWriteResponseScratchBytes, maxPairingMessageBytes));
+
+        // Inbound buffer: the largest request, plus the encryption overhead of the frame that is being received.
+        // The buffer must not be filled completely while a request is received.
+        size_t numReadRequestBytes = sizeof "/characteristics?id=&meta=1&perms=1&type=1&ev=1" - 1 +
+                                     (ip.numReadRequestURIBytes ? ip.numReadRequestURIBytes - 1 : 0);
+        size_t maxRequestBodyBytes =
+                HAPMax(HAPMax(numReadRequestBytes, ip.maxWriteRequestBytes), maxPairingMessageBytes);
+        requirements->ip.numInboundBufferBytes =
+                kHAPIPAccessoryServerStorage_MaxRequestHeaderBytes + maxRequestBodyBytes + numFrameOverheadBytes + 1;
+
+        // Outbound buffer: the largest encrypted response.
+        size_t maxJSONResponseBytes = HAPMax(
+                HAPMax(ip.maxReadResponseBytes, ip.maxEventNotificationBytes), ip.maxWriteResponseBytes);
+        size_t numOutboundBufferBytes = HAPIPSecurityProtocolGetNumEncryptedBytes(
+                kHAPAccessoryServerStorage_MaxJSONResponseHeaderBytes + maxJSONResponseBytes);
+        numOutboundBufferBytes = HAPMax(
+                numOutboundBufferBytes,
+                HAPIPSecurityProtocolGetNumEncryptedBytes(
+                        kHAPAccessoryServerStorage_MaxPairingResponseHeaderBytes + maxPairingMessageBytes));
+
+        // GET /accessories: a chunk is serialized while less than one frame is pending. Serialization stops once at
+        // least one frame is available, so the chunk may exceed a frame by one element. The first pending frame is
+        // encrypted in place.
+        size_t maxChunkBytes = kHAPIPSecurityProtocol_MaxFrameBytes - 1 + ip.maxAccessoriesElementBytes;
+        size_t numAccessoriesBytes = kHAPIPSecurityProtocol_MaxFrameBytes - 1 + GetNumHexDigits(maxChunkBytes) +
+                                     maxChunkBytes + kHAPAccessoryServerStorage_NumChunkFramingBytes +
+                                     numFrameOverheadBytes;
+        requirements->ip.numOutboundBufferBytes = HAPMax(numOutboundBufferBytes, numAccessoriesBytes);
+    }
+
+    // HAP over Bluetooth LE: primary accessory only.
+    if (primaryAccessory->services) {
+        // Pairing messages are transferred through the Pair Setup characteristic.
+        size_t numProcedureBufferBytes = GetNumTLVBytes(maxPairingMessageBytes);
+
+        for (size_t i = 0; primaryAccessory->services[i]; i++) {
+            const HAPService* service = primaryAccessory->services[i];
+            requirements->ble.numGATTTableElements++;
+
+            // Service signature: HAP Service Properties, HAP Linked Services.
+            size_t numLinkedServices = 0;
+            if (service->linkedServices) {
+                while (service->linkedServices[numLinkedServices]) {
+                    numLinkedServices++;
+                }
+            }
+            numProcedureBufferBytes = HAPMax(
+                    numProcedureBufferBytes,
+                    GetNumTLVBytes(sizeof(uint16_t)) + GetNumTLVBytes(numLinkedServices * sizeof(uint16_t)));
+
+            if (!service->characteristics) {
+                continue;
+            }
+            for (size_t j = 0; service->characteristics[j]; j++) {
+                const HAPBaseCharacteristic* characteristic = service->characteristics[j];
+                requirements->ble.numGATTTableElements++;
+
+                // Numeric values take at most 8 bytes.
+                size_t numValueBytes = HAPMax(
+                        GetMaxRawValueBytes(characteristic, maxTLV8Bytes, maxPairingMessageBytes),
+                        sizeof(uint64_t));
+
+                // Read response: Value. Write request: Value, Return Response, TTL.
+                numProcedureBufferBytes = HAPMax(
+                        numProcedureBufferBytes, GetNumTLVBytes(numValueBytes) + 2 * GetNumTLVBytes(1));
+                numProcedureBufferBytes =
+                        HAPMax(numProcedureBufferBytes, GetMaxBLECharacteristicSignatureBytes(characteristic));
+            }
+        }
+        requirements->ble.numProcedureBufferBytes = numProcedureBufferBytes;
+    }
+}
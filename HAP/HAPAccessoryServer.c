@@ -148,6 +148,7 @@ void HAPAccessoryServerCreate(
     // Copy generic options.
     HAPPrecondition(options->maxPairings >= kHAPPairingStorage_MinElements);
     server->maxPairings = options->maxPairings;
+    HAPCharacteristicValueCacheCreate(server_, options->valueCache.entries, options->valueCache.numEntries);
 
     // Copy platform.
     HAPAssert(sizeof *platform == sizeof server->platform);
@@ -155,6 +156,8 @@ void HAPAccessoryServerCreate(
     HAPPrecondition(server->platform.keyValueStore);
     HAPPrecondition(server->platform.accessorySetup);
     HAPMFiHWAuthCreate(&server->mfi, server->platform.authentication.mfiHWAuth);
+    HAPMFiHWAuthSetCertificateCache(
+            &server->mfi, options->mfiCertificateCache.bytes, options->mfiCertificateCache.maxBytes);
 
     // Deprecation check for accessory setup.
     HAP_DIAGNOSTIC_PUSH
@@ -254,6 +257,7 @@ void HAPAccessoryServerRelease(HAPAccessoryServerRef* server_) {
         HAPPlatformTimerDeregister(server->callbackTimer);
         server->callbackTimer = 0;
     }
+    HAPCharacteristicValueCacheRelease(server_);
 
     if (server->transports.ble) {
         HAPAssert(server->platform.ble.blePeripheralManager);
@@ -455,6 +459,77 @@ void HAPAccessoryServerLoadLTSK(HAPPlatformKeyValueStoreRef keyValueStore, HAPAc
     }
 }
 
+/**
+ * Logs the storage configuration together with the storage requirements of the registered accessories.
+ *
+ * - Values of TLV8 characteristics are assumed to be empty.
+ *
+ * - The requirements are worst-case bounds that typical storage configurations do not meet. They are only logged
+ *   with debug level to not flood the log on every start.
+ *
+ * - Walks the attribute database. Only called if debug logs are compiled in, to not slow down every start.
+ *
+ * @param      server_              Accessory server.
+ */
+static void CheckStorageRequirements(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->primaryAccessory);
+
+    HAPAccessoryServerStorageRequirements requirements;
+    HAPAccessoryServerGetStorageRequirements(
+            HAPNonnull(server->primaryAccessory),
+            server->ip.bridgedAccessories,
+            server->maxPairings,
+            /* maxTLV8Bytes: */ 0,
+            &requirements);
+
+#define CHECK_STORAGE_REQUIREMENT(description, value, requiredValue) \
+    do { \
+        HAPLogDebug( \
+                &logObject, \
+                "Storage configuration: %s = %lu (required: %lu)%s", \
+                description, \
+                (unsigned long) (value), \
+                (unsigned long) (requiredValue), \
+                (value) < (requiredValue) ? " is too small." : "."); \
+    } while (0)
+
+    if (server->transports.ip) {
+        const HAPIPAccessoryServerStorage* storage = HAPNonnull(server->ip.storage);
+        CHECK_STORAGE_REQUIREMENT("numReadContexts", storage->numReadContexts, requirements.ip.numReadContexts);
+        CHECK_STORAGE_REQUIREMENT("numWriteContexts", storage->numWriteContexts, requirements.ip.numWriteContexts);
+        CHECK_STORAGE_REQUIREMENT(
+                "scratchBuffer.numBytes", storage->scratchBuffer.numBytes, requirements.ip.numScratchBufferBytes);
+        for (size_t i = 0; i < storage->numSessions; i++) {
+            const HAPIPSession* session = &storage->sessions[i];
+            CHECK_STORAGE_REQUIREMENT(
+                    "sessions[].inboundBuffer.numBytes",
+                    session->inboundBuffer.numBytes,
+                    requirements.ip.numInboundBufferBytes);
+            CHECK_STORAGE_REQUIREMENT(
+                    "sessions[].outboundBuffer.numBytes",
+                    session->outboundBuffer.numBytes,
+                    requirements.ip.numOutboundBufferBytes);
+            CHECK_STORAGE_REQUIREMENT(
+                    "sessions[].numEventNotifications",
+                    session->numEventNotifications,
+                    requirements.ip.numEventNotifications);
+        }
+    }
+    if (server->transports.ble) {
+        const HAPBLEAccessoryServerStorage* storage = HAPNonnull(server->ble.storage);
+        CHECK_STORAGE_REQUIREMENT(
+                "numGATTTableElements", storage->numGATTTableElements, requirements.ble.numGATTTableElements);
+        CHECK_STORAGE_REQUIREMENT(
+                "procedureBuffer.numBytes",
+                storage->procedureBuffer.numBytes,
+                requirements.ble.numProcedureBufferBytes);
+    }
+
+#undef CHECK_STORAGE_REQUIREMENT
+}
+
 /**
  * Prepares starting the accessory server.
  *
@@ -488,6 +563,7 @@ static void HAPAccessoryServerPrepareStart(
     }
 
     // Firmware version check.
+    bool didIncrementCN = false;
     {
         // Read firmware version.
         HAPAssert(primaryAccessory->firmwareVersion);
@@ -566,6 +642,7 @@ static void HAPAccessoryServerPrepareStart(
                     HAPAssert(err == kHAPError_Unknown);
                     HAPFatalError();
                 }
+                didIncrementCN = true;
                 saveVersion = true;
             }
         } else {
@@ -594,10 +671,21 @@ static void HAPAccessoryServerPrepareStart(
         }
     }
 
+    // Attribute database check.
+    err = HAPAccessoryServerUpdateDatabaseFingerprint(
+            server->platform.keyValueStore, primaryAccessory, bridgedAccessories, didIncrementCN);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        HAPFatalError();
+    }
+
     // Register accessory.
     HAPLogDebug(&logObject, "Registering accessories.");
     server->primaryAccessory = primaryAccessory;
     server->ip.bridgedAccessories = bridgedAccessories;
+    if (HAP_LOG_LEVEL >= 3) {
+        CheckStorageRequirements(server_);
+    }
 
     // Load LTSK.
     HAPLogDebug(&logObject, "Loading accessory identity.");
@@ -612,6 +700,11 @@ static void HAPAccessoryServerPrepareStart(
         HAPFatalError();
     }
 
+    // Read the accessory certificate ahead of the first pairing.
+    if (server->platform.authentication.mfiHWAuth) {
+        HAPMFiHWAuthPrepare(&server->mfi);
+    }
+
     if (server->transports.ble) {
         HAPNonnull(server->transports.ble)->start(server_);
     }
@@ -665,7 +758,8 @@ void HAPAccessoryServerStartBridge(
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(bridgeAccessory);
 
-    HAPError err;
+    // Configuration changes are detected by the attribute database fingerprint.
+    (void) configurationChanged;
 
     HAPLogDebug(
             &logObject,
@@ -687,16 +781,6 @@ void HAPAccessoryServerStartBridge(
         return;
     }
 
-    // Increment configuration number if necessary.
-    if (configurationChanged) {
-        HAPLogInfo(&logObject, "Configuration changed. Incrementing CN.");
-        err = HAPAccessoryServerIncrementCN(server->platform.keyValueStore);
-        if (err) {
-            HAPAssert(err == kHAPError_Unknown);
-            HAPFatalError();
-        }
-    }
-
     if (server->transports.ip) {
         const HAPAccessoryServerServerEngine* _Nullable serverEngine =
                 HAPNonnull(server->transports.ip)->serverEngine.get();
@@ -1037,6 +1121,9 @@ HAPError HAPAccessoryServerCleanupPairings(HAPAccessoryServerRef* server_) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
         }
+        if (server->transports.ble) {
+            server->ble.persistentState.broadcastParametersAreLoaded = false;
+        }
     }
 
     return kHAPError_None;
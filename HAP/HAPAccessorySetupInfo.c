@@ -244,7 +244,7 @@ static void PrepareSetupInfo(HAPAccessoryServerRef* server_, bool lockSetupInfo)
             HAPPrecondition(!server->accessorySetup.dynamicRefreshTimer);
             err = HAPPlatformTimerRegister(
                     &server->accessorySetup.dynamicRefreshTimer,
-                    HAPPlatformClockGetCurrent() + kHAPAccessorySetupInfo_DynamicRefreshInterval,
+                    HAPPlatformClockGetCurrentCoarse() + kHAPAccessorySetupInfo_DynamicRefreshInterval,
                     DynamicSetupInfoExpired,
                     server_);
             if (err) {
@@ -500,7 +500,7 @@ void HAPAccessorySetupInfoEnterNFCPairingMode(HAPAccessoryServerRef* server_) {
     }
     err = HAPPlatformTimerRegister(
             &server->accessorySetup.nfcPairingModeTimer,
-            HAPPlatformClockGetCurrent() + kHAPAccessoryServer_NFCPairingModeDuration,
+            HAPPlatformClockGetCurrentCoarse() + kHAPAccessoryServer_NFCPairingModeDuration,
             NFCPairingModeExpired,
             server_);
     if (err) {
@@ -9,38 +9,105 @@
 static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "BLEAccessoryServer" };
 
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerGetGSN(HAPPlatformKeyValueStoreRef keyValueStore, HAPBLEAccessoryServerGSN* gsn) {
-    HAPPrecondition(keyValueStore);
+HAPError HAPBLEAccessoryServerGetGSN(HAPAccessoryServerRef* server_, HAPBLEAccessoryServerGSN* gsn) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(gsn);
 
     HAPError err;
 
-    bool found;
-    size_t numBytes;
-    uint8_t gsnBytes[sizeof(uint16_t) + sizeof(uint8_t)];
-    err = HAPPlatformKeyValueStoreGet(
-            keyValueStore,
+    if (!server->ble.persistentState.gsnIsLoaded) {
+        bool found;
+        size_t numBytes;
+        uint8_t gsnBytes[sizeof(uint16_t) + sizeof(uint8_t)];
+        err = HAPPlatformKeyValueStoreGet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_BLEGSN,
+                gsnBytes,
+                sizeof gsnBytes,
+                &numBytes,
+                &found);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+        if (!found) {
+            HAPWriteLittleUInt16(&gsnBytes[0], 1U);
+            gsnBytes[2] = 0x00;
+        } else if (numBytes != sizeof gsnBytes) {
+            HAPLog(&logObject, "Invalid GSN length %lu.", (unsigned long) numBytes);
+            return kHAPError_Unknown;
+        }
+        HAPRawBufferZero(&server->ble.persistentState.gsn, sizeof server->ble.persistentState.gsn);
+        server->ble.persistentState.gsn.gsn = HAPReadLittleUInt16(&gsnBytes[0]);
+        server->ble.persistentState.gsn.didIncrement = (gsnBytes[2] & 0x01u) == 0x01;
+        server->ble.persistentState.gsnIsLoaded = true;
+    }
+
+    HAPRawBufferZero(gsn, sizeof *gsn);
+    gsn->gsn = server->ble.persistentState.gsn.gsn;
+    gsn->didIncrement = server->ble.persistentState.gsn.didIncrement;
+    return kHAPError_None;
+}
+
+/**
+ * Stores GSN state. The key-value store is only updated if the GSN state changed.
+ *
+ * @param      server               Accessory server.
+ * @param      gsn                  GSN.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SetGSN(HAPAccessoryServer* server, const HAPBLEAccessoryServerGSN* gsn) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ble.persistentState.gsnIsLoaded);
+    HAPPrecondition(gsn);
+
+    HAPError err;
+
+    if (gsn->gsn == server->ble.persistentState.gsn.gsn &&
+        gsn->didIncrement == server->ble.persistentState.gsn.didIncrement) {
+        return kHAPError_None;
+    }
+
+    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn->gsn), gsn->didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
+    err = HAPPlatformKeyValueStoreSet(
+            server->platform.keyValueStore,
             kHAPKeyValueStoreDomain_Configuration,
             kHAPKeyValueStoreKey_Configuration_BLEGSN,
             gsnBytes,
-            sizeof gsnBytes,
-            &numBytes,
-            &found);
+            sizeof gsnBytes);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    if (!found) {
-        HAPWriteLittleUInt16(&gsnBytes[0], 1U);
-        gsnBytes[2] = 0x00;
-    } else if (numBytes != sizeof gsnBytes) {
-        HAPLog(&logObject, "Invalid GSN length %lu.", (unsigned long) numBytes);
-        return kHAPError_Unknown;
+
+    server->ble.persistentState.gsn.gsn = gsn->gsn;
+    server->ble.persistentState.gsn.didIncrement = gsn->didIncrement;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLEAccessoryServerGetDeviceID(HAPAccessoryServerRef* server_, HAPDeviceID* deviceID) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(deviceID);
+
+    HAPError err;
+
+    if (!server->ble.persistentState.deviceIDIsLoaded) {
+        err = HAPDeviceIDGet(server->platform.keyValueStore, &server->ble.persistentState.deviceID);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+        server->ble.persistentState.deviceIDIsLoaded = true;
     }
 
-    HAPRawBufferZero(gsn, sizeof *gsn);
-    gsn->gsn = HAPReadLittleUInt16(&gsnBytes[0]);
-    gsn->didIncrement = (gsnBytes[2] & 0x01u) == 0x01;
+    HAPRawBufferCopyBytes(deviceID, &server->ble.persistentState.deviceID, sizeof *deviceID);
     return kHAPError_None;
 }
 
@@ -58,7 +125,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         HAP_DIAGNOSE_ERROR(maxAdvertisingBytes < 31, "maxAdvertisingBytes must be at least 31")
                 HAP_DIAGNOSE_WARNING(maxScanResponseBytes < 2, "maxScanResponseBytes should be at least 2") {
     HAPPrecondition(server_);
-    const HAPAccessoryServer* server = (const HAPAccessoryServer*) server_;
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(isActive);
     HAPPrecondition(advertisingInterval);
     HAPPrecondition(advertisingBytes);
@@ -90,8 +157,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         uint16_t keyExpirationGSN;
         HAPBLEAccessoryServerBroadcastEncryptionKey broadcastKey;
         HAPDeviceID advertisingID;
-        err = HAPBLEAccessoryServerBroadcastGetParameters(
-                server->platform.keyValueStore, &keyExpirationGSN, &broadcastKey, &advertisingID);
+        err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, &broadcastKey, &advertisingID);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -101,7 +167,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
             return kHAPError_Unknown;
         }
         HAPBLEAccessoryServerGSN gsn;
-        err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+        err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -286,7 +352,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         /* 0x06    SF */ *adv++ = (uint8_t)(HAPAccessoryServerIsPaired(server_) ? 0U << 0U : 1U << 0U);
         /* 0x07 DevID */ {
             HAPDeviceID deviceID;
-            err = HAPDeviceIDGet(server->platform.keyValueStore, &deviceID);
+            err = HAPBLEAccessoryServerGetDeviceID(server_, &deviceID);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -299,7 +365,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         adv += 2;
         /* 0x0F   GSN */ {
             HAPBLEAccessoryServerGSN gsn;
-            err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+            err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -480,7 +546,7 @@ static void AdvertisingTimerExpired(HAPPlatformTimerRef timer, void* _Nullable c
         // Section 7.4.6.3 Disconnected Events
         err = HAPPlatformTimerRegister(
                 &server->ble.adv.timer,
-                HAPPlatformClockGetCurrent() + server->ble.adv.ev_duration,
+                HAPPlatformClockGetCurrentCoarse() + server->ble.adv.ev_duration,
                 AdvertisingTimerExpired,
                 server_);
         if (err) {
@@ -505,7 +571,7 @@ void HAPBLEAccessoryServerDidStartAdvertising(HAPAccessoryServerRef* server_) {
         server->ble.adv.fast_started = true;
         err = HAPPlatformTimerRegister(
                 &server->ble.adv.fast_timer,
-                HAPPlatformClockGetCurrent() + 30 * HAPSecond,
+                HAPPlatformClockGetCurrentCoarse() + 30 * HAPSecond,
                 AdvertisingTimerExpired,
                 server_);
         if (err) {
@@ -545,19 +611,13 @@ HAPError HAPBLEAccessoryServerDidConnect(HAPAccessoryServerRef* server_) {
 
     // Reset disconnected events coalescing.
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
     gsn.didIncrement = false;
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
+    err = SetGSN(server, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -588,7 +648,7 @@ HAPError HAPBLEAccessoryServerDidDisconnect(HAPAccessoryServerRef* server_) {
     // Allow quick reconnection.
     err = HAPPlatformTimerRegister(
             &server->ble.adv.fast_timer,
-            HAPPlatformClockGetCurrent() + server->ble.adv.ev_duration,
+            HAPPlatformClockGetCurrentCoarse() + server->ble.adv.ev_duration,
             AdvertisingTimerExpired,
             server_);
     if (err) {
@@ -598,19 +658,13 @@ HAPError HAPBLEAccessoryServerDidDisconnect(HAPAccessoryServerRef* server_) {
 
     // Reset GSN update coalescing.
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
     gsn.didIncrement = false;
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
+    err = SetGSN(server, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -646,7 +700,7 @@ static HAPError HAPBLEAccessoryServerIncrementGSN(HAPAccessoryServerRef* server_
 
     // Get key expiration GSN.
     uint16_t keyExpirationGSN;
-    err = HAPBLEAccessoryServerBroadcastGetParameters(server->platform.keyValueStore, &keyExpirationGSN, NULL, NULL);
+    err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, NULL, NULL);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -654,7 +708,7 @@ static HAPError HAPBLEAccessoryServerIncrementGSN(HAPAccessoryServerRef* server_
 
     // Get GSN.
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -662,7 +716,7 @@ static HAPError HAPBLEAccessoryServerIncrementGSN(HAPAccessoryServerRef* server_
 
     // Expire broadcast encryption key if necessary.
     if (gsn.gsn == keyExpirationGSN) {
-        err = HAPBLEAccessoryServerBroadcastExpireKey(server->platform.keyValueStore);
+        err = HAPBLEAccessoryServerBroadcastExpireKey(server_);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -679,13 +733,7 @@ static HAPError HAPBLEAccessoryServerIncrementGSN(HAPAccessoryServerRef* server_
     HAPLogInfo(&logObject, "New GSN: %u.", gsn.gsn);
 
     // Save GSN state.
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
+    err = SetGSN(server, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -743,14 +791,13 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
         // Section 7.4.6.2 Broadcasted Events
         if (!server->ble.adv.connected) {
             uint16_t keyExpirationGSN;
-            err = HAPBLEAccessoryServerBroadcastGetParameters(
-                    server->platform.keyValueStore, &keyExpirationGSN, NULL, NULL);
+            err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, NULL, NULL);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
             }
             HAPBLEAccessoryServerGSN gsn;
-            err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+            err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -765,7 +812,7 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
                 HAPBLECharacteristicBroadcastInterval interval;
                 bool enabled;
                 err = HAPBLECharacteristicGetBroadcastConfiguration(
-                        characteristic, service, accessory, &enabled, &interval, server->platform.keyValueStore);
+                        server_, characteristic, service, accessory, &enabled, &interval);
                 if (err) {
                     HAPAssert(err == kHAPError_Unknown);
                     return err;
@@ -975,7 +1022,7 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
 
                         err = HAPPlatformTimerRegister(
                                 &server->ble.adv.timer,
-                                HAPPlatformClockGetCurrent() + server->ble.adv.ev_duration,
+                                HAPPlatformClockGetCurrentCoarse() + server->ble.adv.ev_duration,
                                 AdvertisingTimerExpired,
                                 server_);
                         if (err) {
@@ -1027,7 +1074,7 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
         // Section 7.4.6.3 Disconnected Events
 
         HAPBLEAccessoryServerGSN gsn;
-        err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+        err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -1056,7 +1103,7 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
                 // Section 7.4.6.3 Disconnected Events
                 err = HAPPlatformTimerRegister(
                         &server->ble.adv.timer,
-                        HAPPlatformClockGetCurrent() + server->ble.adv.ev_duration,
+                        HAPPlatformClockGetCurrentCoarse() + server->ble.adv.ev_duration,
                         AdvertisingTimerExpired,
                         server_);
                 if (err) {
@@ -1113,7 +1160,7 @@ HAPError HAPBLEAccessoryServerDidSendEventNotification(
     // See HomeKit Accessory Protocol Specification R14
     // Section 7.4.6.1 Connected Events
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
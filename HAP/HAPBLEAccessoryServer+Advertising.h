@@ -28,14 +28,30 @@ typedef struct {
 /**
  * BLE: Fetches GSN state.
  *
- * @param      keyValueStore        Key-value store
+ * - The GSN state is served from memory. It is loaded from the key-value store on first use.
+ *
+ * @param      server               Accessory server.
  * @param[out] gsn                  GSN.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
  */
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerGetGSN(HAPPlatformKeyValueStoreRef keyValueStore, HAPBLEAccessoryServerGSN* gsn);
+HAPError HAPBLEAccessoryServerGetGSN(HAPAccessoryServerRef* server, HAPBLEAccessoryServerGSN* gsn);
+
+/**
+ * BLE: Fetches the Device ID.
+ *
+ * - The Device ID is served from memory. It is loaded from the key-value store on first use.
+ *
+ * @param      server               Accessory server.
+ * @param[out] deviceID             Device ID.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLEAccessoryServerGetDeviceID(HAPAccessoryServerRef* server, HAPDeviceID* deviceID);
 
 /**
  * BLE: Get advertisement parameters.
@@ -15,54 +15,148 @@ typedef struct {
     HAPDeviceID advertisingID;
 } HAPBLEAccessoryServerBroadcastParameters;
 
-#define HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, parameters) \
-    do { \
-        bool found; \
-        size_t numBytes; \
-        uint8_t parametersBytes \
-                [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) + \
-                 sizeof(HAPDeviceID)]; \
-        err = HAPPlatformKeyValueStoreGet( \
-                (keyValueStore), \
-                kHAPKeyValueStoreDomain_Configuration, \
-                kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters, \
-                parametersBytes, \
-                sizeof parametersBytes, \
-                &numBytes, \
-                &found); \
-        if (err) { \
-            HAPAssert(err == kHAPError_Unknown); \
-            return err; \
-        } \
-        if (!found) { \
-            HAPRawBufferZero(parametersBytes, sizeof parametersBytes); \
-        } else if (numBytes != sizeof parametersBytes) { \
-            HAPLog(&logObject, "Invalid BLE broadcast state length: %lu.", (unsigned long) numBytes); \
-            return kHAPError_Unknown; \
-        } \
-        HAPRawBufferZero((parameters), sizeof *(parameters)); \
-        (parameters)->keyExpirationGSN = HAPReadLittleUInt16(&parametersBytes[0]); \
-        HAPAssert(sizeof(parameters)->key.value == 32); \
-        HAPRawBufferCopyBytes((parameters)->key.value, &parametersBytes[2], 32); \
-        (parameters)->hasAdvertisingID = (uint8_t)(parametersBytes[34] & 0x01U) == 0x01; \
-        HAPAssert(sizeof(parameters)->advertisingID.bytes == 6); \
-        HAPRawBufferCopyBytes((parameters)->advertisingID.bytes, &parametersBytes[35], 6); \
-    } while (0)
+/**
+ * Fetches the broadcast parameters. They are loaded from the key-value store on first use.
+ *
+ * @param      server               Accessory server.
+ * @param[out] parameters           Broadcast parameters.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError GetParameters(HAPAccessoryServer* server, HAPBLEAccessoryServerBroadcastParameters* parameters) {
+    HAPPrecondition(server);
+    HAPPrecondition(parameters);
+
+    HAPError err;
+
+    if (!server->ble.persistentState.broadcastParametersAreLoaded) {
+        bool found;
+        size_t numBytes;
+        uint8_t parametersBytes
+                [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+                 sizeof(HAPDeviceID)];
+        err = HAPPlatformKeyValueStoreGet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+                parametersBytes,
+                sizeof parametersBytes,
+                &numBytes,
+                &found);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+        if (!found) {
+            HAPRawBufferZero(parametersBytes, sizeof parametersBytes);
+        } else if (numBytes != sizeof parametersBytes) {
+            HAPLog(&logObject, "Invalid BLE broadcast state length: %lu.", (unsigned long) numBytes);
+            return kHAPError_Unknown;
+        }
+        server->ble.persistentState.keyExpirationGSN = HAPReadLittleUInt16(&parametersBytes[0]);
+        HAPAssert(sizeof server->ble.persistentState.broadcastKey.value == 32);
+        HAPRawBufferCopyBytes(server->ble.persistentState.broadcastKey.value, &parametersBytes[2], 32);
+        server->ble.persistentState.hasAdvertisingID = (uint8_t)(parametersBytes[34] & 0x01U) == 0x01;
+        HAPAssert(sizeof server->ble.persistentState.advertisingID.bytes == 6);
+        HAPRawBufferCopyBytes(server->ble.persistentState.advertisingID.bytes, &parametersBytes[35], 6);
+        server->ble.persistentState.broadcastParametersAreLoaded = true;
+    }
+
+    HAPRawBufferZero(parameters, sizeof *parameters);
+    parameters->keyExpirationGSN = server->ble.persistentState.keyExpirationGSN;
+    HAPRawBufferCopyBytes(&parameters->key, &server->ble.persistentState.broadcastKey, sizeof parameters->key);
+    parameters->hasAdvertisingID = server->ble.persistentState.hasAdvertisingID;
+    HAPRawBufferCopyBytes(
+            &parameters->advertisingID,
+            &server->ble.persistentState.advertisingID,
+            sizeof parameters->advertisingID);
+    return kHAPError_None;
+}
+
+/**
+ * Stores the broadcast parameters. The key-value store is only updated if the parameters changed.
+ *
+ * @param      server               Accessory server.
+ * @param      parameters           Broadcast parameters.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SaveParameters(HAPAccessoryServer* server, const HAPBLEAccessoryServerBroadcastParameters* parameters) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ble.persistentState.broadcastParametersAreLoaded);
+    HAPPrecondition(parameters);
+
+    HAPError err;
+
+    if (parameters->keyExpirationGSN == server->ble.persistentState.keyExpirationGSN &&
+        HAPRawBufferAreEqual(
+                parameters->key.value,
+                server->ble.persistentState.broadcastKey.value,
+                sizeof parameters->key.value) &&
+        parameters->hasAdvertisingID == server->ble.persistentState.hasAdvertisingID &&
+        HAPRawBufferAreEqual(
+                parameters->advertisingID.bytes,
+                server->ble.persistentState.advertisingID.bytes,
+                sizeof parameters->advertisingID.bytes)) {
+        return kHAPError_None;
+    }
+
+    uint8_t parametersBytes
+            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+             sizeof(HAPDeviceID)];
+    HAPWriteLittleUInt16(&parametersBytes[0], parameters->keyExpirationGSN);
+    HAPAssert(sizeof parameters->key.value == 32);
+    HAPRawBufferCopyBytes(&parametersBytes[2], parameters->key.value, 32);
+    parametersBytes[34] = parameters->hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
+    HAPAssert(sizeof parameters->advertisingID.bytes == 6);
+    HAPRawBufferCopyBytes(&parametersBytes[35], parameters->advertisingID.bytes, 6);
+    err = HAPPlatformKeyValueStoreSet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+            parametersBytes,
+            sizeof parametersBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    server->ble.persistentState.keyExpirationGSN = parameters->keyExpirationGSN;
+    HAPRawBufferCopyBytes(
+            &server->ble.persistentState.broadcastKey,
+            &parameters->key,
+            sizeof server->ble.persistentState.broadcastKey);
+    server->ble.persistentState.hasAdvertisingID = parameters->hasAdvertisingID;
+    HAPRawBufferCopyBytes(
+            &server->ble.persistentState.advertisingID,
+            &parameters->advertisingID,
+            sizeof server->ble.persistentState.advertisingID);
+    return kHAPError_None;
+}
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastGetParameters(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server_,
         uint16_t* keyExpirationGSN,
         HAPBLEAccessoryServerBroadcastEncryptionKey* _Nullable broadcastKey,
         HAPDeviceID* _Nullable advertisingID) {
-    HAPPrecondition(keyValueStore);
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(keyExpirationGSN);
 
     HAPError err;
 
     // Get parameters.
     HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = GetParameters(server, &parameters);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
 
     // Copy result.
     *keyExpirationGSN = parameters.keyExpirationGSN;
@@ -84,7 +178,7 @@ HAPError HAPBLEAccessoryServerBroadcastGetParameters(
             // Fallback to Device ID.
             // See HomeKit Accessory Protocol Specification R14
             // Section 7.4.2.2.2 Manufacturer Data
-            err = HAPDeviceIDGet(keyValueStore, HAPNonnull(advertisingID));
+            err = HAPBLEAccessoryServerGetDeviceID(server_, HAPNonnull(advertisingID));
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -107,11 +201,15 @@ HAPError
 
     // Get state.
     HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(server->platform.keyValueStore, &parameters);
+    err = GetParameters(server, &parameters);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
 
     // Get GSN.
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(session->server, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -188,21 +286,7 @@ HAPError
     }
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -213,16 +297,21 @@ HAPError
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server_,
         const HAPDeviceID* advertisingID) {
-    HAPPrecondition(keyValueStore);
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(advertisingID);
 
     HAPError err;
 
     // Get state.
     HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = GetParameters(server, &parameters);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
 
     // Copy advertising identifier.
     parameters.hasAdvertisingID = true;
@@ -230,21 +319,7 @@ HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
     HAPRawBufferCopyBytes(&parameters.advertisingID, advertisingID, sizeof parameters.advertisingID);
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -254,8 +329,9 @@ HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
 }
 
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPPlatformKeyValueStoreRef keyValueStore) {
-    HAPPrecondition(keyValueStore);
+HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
 
     HAPError err;
 
@@ -263,28 +339,18 @@ HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPPlatformKeyValueStoreRef key
 
     // Get state.
     HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = GetParameters(server, &parameters);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
 
     // Expire encryption key.
     parameters.keyExpirationGSN = 0;
     HAPRawBufferZero(&parameters.key, sizeof parameters.key);
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
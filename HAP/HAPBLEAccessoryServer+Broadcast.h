@@ -34,7 +34,9 @@ HAP_NONNULL_SUPPORT(HAPBLEAccessoryServerBroadcastEncryptionKey)
 /**
  * BLE: Fetches broadcast encryption key parameters.
  *
- * @param      keyValueStore        Key-value store.
+ * - The parameters are served from memory. They are loaded from the key-value store on first use.
+ *
+ * @param      server               Accessory server.
  * @param[out] keyExpirationGSN     GSN after which the broadcast encryption key expires. 0 if key is expired.
  * @param[out] broadcastKey         Broadcast encryption key, if available.
  * @param[out] advertisingID        Accessory advertising identifier.
@@ -47,7 +49,7 @@ HAP_NONNULL_SUPPORT(HAPBLEAccessoryServerBroadcastEncryptionKey)
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastGetParameters(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server,
         uint16_t* keyExpirationGSN,
         HAPBLEAccessoryServerBroadcastEncryptionKey* _Nullable broadcastKey,
         HAPDeviceID* _Nullable advertisingID);
@@ -70,7 +72,7 @@ HAPError HAPBLEAccessoryServerBroadcastGenerateKey(HAPSessionRef* session, const
 /**
  * BLE: Set accessory advertising identifier.
  *
- * @param      keyValueStore        Key-value store.
+ * @param      server               Accessory server.
  * @param      advertisingID        New accessory advertising identifier.
  *
  * @return kHAPError_None           If successful.
@@ -81,13 +83,13 @@ HAPError HAPBLEAccessoryServerBroadcastGenerateKey(HAPSessionRef* session, const
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server,
         const HAPDeviceID* advertisingID);
 
 /**
  * BLE: Invalidate broadcast encryption key.
  *
- * @param      keyValueStore        Key-value store.
+ * @param      server               Accessory server.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -96,7 +98,7 @@ HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
  *      Section 7.4.7.4 Broadcast Encryption Key expiration and refresh
  */
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPPlatformKeyValueStoreRef keyValueStore);
+HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPAccessoryServerRef* server);
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
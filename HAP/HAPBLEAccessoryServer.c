@@ -70,6 +70,9 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
     HAPRawBufferZero(storage->session, sizeof *storage->session);
     HAPRawBufferZero(storage->procedures, storage->numProcedures * sizeof *storage->procedures);
     HAPRawBufferZero(storage->procedureBuffer.bytes, storage->procedureBuffer.numBytes);
+
+    // The key-value store may have been modified while the accessory server was stopped.
+    HAPRawBufferZero(&server->ble.persistentState, sizeof server->ble.persistentState);
 }
 
 static void Start(HAPAccessoryServerRef* server_) {
@@ -109,6 +112,34 @@ static void Start(HAPAccessoryServerRef* server_) {
     HAPAssert(HAPStringGetNumBytes(primaryAccessory->name) <= 64);
     HAPPlatformBLEPeripheralManagerSetDeviceName(blePeripheralManager, primaryAccessory->name);
 
+    // Load persistent state.
+    {
+        HAPBLEAccessoryServerGSN gsn;
+        err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        uint16_t keyExpirationGSN;
+        HAPDeviceID advertisingID;
+        err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, NULL, &advertisingID);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        HAPDeviceID deviceID;
+        err = HAPBLEAccessoryServerGetDeviceID(server_, &deviceID);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        err = HAPBLECharacteristicLoadBroadcastConfiguration(server_);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+    }
+
     // Register GATT db.
     HAPBLEPeripheralManagerRegister(server_);
 }
@@ -131,14 +131,161 @@ static HAPError GetBroadcastConfiguration(
     return kHAPError_None;
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECharacteristicLoadBroadcastConfiguration(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPError err;
+
+    if (server->ble.persistentState.configurationIsLoaded) {
+        return kHAPError_None;
+    }
+
+    HAPPlatformKeyValueStoreKey key;
+    size_t numBytes;
+    uint8_t bytes[kHAPBLECharacteristicBroadcastConfiguration_MaxBytes + 1];
+    bool found;
+    err = GetBroadcastConfiguration(
+            /* aid: */ 1, &found, bytes, sizeof bytes, &numBytes, &key, server->platform.keyValueStore);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    size_t numBroadcasts = 0;
+    if (found) {
+        HAPAssert(numBytes >= 2 && numBytes < sizeof bytes && !((numBytes - 2) % 3));
+        for (size_t i = 2; i < numBytes; i += 3) {
+            uint16_t cid = HAPReadLittleUInt16(&bytes[i]);
+            uint8_t broadcastConfiguration = bytes[i + 2];
+            if (!HAPBLECharacteristicIsValidBroadcastInterval(broadcastConfiguration)) {
+                HAPLog(&logObject,
+                       "Invalid stored broadcast interval for characteristic 0x%04x: 0x%02x.",
+                       cid,
+                       broadcastConfiguration);
+                return kHAPError_Unknown;
+            }
+            if (numBroadcasts && cid <= server->ble.persistentState.broadcastCIDs[numBroadcasts - 1]) {
+                HAPLog(&logObject, "Stored broadcast configuration is not sorted at characteristic 0x%04x.", cid);
+                return kHAPError_Unknown;
+            }
+            server->ble.persistentState.broadcastCIDs[numBroadcasts] = cid;
+            server->ble.persistentState.broadcastIntervals[numBroadcasts] =
+                    (HAPBLECharacteristicBroadcastInterval) broadcastConfiguration;
+            numBroadcasts++;
+        }
+    } else {
+        key = 0;
+    }
+    server->ble.persistentState.configurationKey = key;
+    server->ble.persistentState.numBroadcasts = (uint8_t) numBroadcasts;
+    server->ble.persistentState.configurationIsLoaded = true;
+    return kHAPError_None;
+}
+
+/**
+ * Looks up the broadcast configuration of a characteristic.
+ *
+ * - Enabled broadcasts are sorted by characteristic instance ID. Lookups on every raised event are O(log n).
+ *
+ * @param      server               Accessory server.
+ * @param      cid                  Characteristic instance ID.
+ * @param[out] found                Whether broadcasts are enabled for the characteristic.
+ *
+ * @return Index of the characteristic if found. Index where it would be inserted otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static size_t FindBroadcastConfiguration(const HAPAccessoryServer* server, uint16_t cid, bool* found) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ble.persistentState.configurationIsLoaded);
+    HAPPrecondition(found);
+
+    const uint16_t* cids = server->ble.persistentState.broadcastCIDs;
+    size_t lower = 0;
+    size_t upper = server->ble.persistentState.numBroadcasts;
+    while (lower < upper) {
+        size_t i = lower + (upper - lower) / 2;
+        if (cids[i] < cid) {
+            lower = i + 1;
+        } else {
+            upper = i;
+        }
+    }
+    *found = lower < server->ble.persistentState.numBroadcasts && cids[lower] == cid;
+    return lower;
+}
+
+/**
+ * Stores the characteristic configuration of the primary accessory after broadcasts have been enabled or disabled.
+ *
+ * - The in-memory state is only updated if the key-value store has been updated successfully.
+ *
+ * @param      server               Accessory server.
+ * @param      cids                 Instance IDs of the characteristics that have broadcasts enabled, sorted.
+ * @param      broadcastIntervals   Broadcast interval of each characteristic.
+ * @param      numBroadcasts        Number of characteristics that have broadcasts enabled.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SaveBroadcastConfiguration(
+        HAPAccessoryServer* server,
+        const uint16_t* cids,
+        const HAPBLECharacteristicBroadcastInterval* broadcastIntervals,
+        size_t numBroadcasts) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ble.persistentState.configurationIsLoaded);
+    HAPPrecondition(cids);
+    HAPPrecondition(broadcastIntervals);
+    HAPPrecondition(numBroadcasts <= kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts);
+
+    HAPError err;
+
+    HAPPlatformKeyValueStoreKey key = server->ble.persistentState.configurationKey;
+    if (!numBroadcasts) {
+        err = HAPPlatformKeyValueStoreRemove(
+                server->platform.keyValueStore, kHAPKeyValueStoreDomain_CharacteristicConfiguration, key);
+    } else {
+        uint8_t bytes[kHAPBLECharacteristicBroadcastConfiguration_MaxBytes];
+        HAPWriteLittleUInt16(bytes, /* aid: */ 1);
+        size_t numBytes = 2;
+        for (size_t i = 0; i < numBroadcasts; i++) {
+            HAPWriteLittleUInt16(&bytes[numBytes], cids[i]);
+            bytes[numBytes + 2] = broadcastIntervals[i];
+            numBytes += 3;
+        }
+        err = HAPPlatformKeyValueStoreSet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_CharacteristicConfiguration,
+                key,
+                bytes,
+                numBytes);
+    }
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    HAPRawBufferCopyBytes(server->ble.persistentState.broadcastCIDs, cids, numBroadcasts * sizeof *cids);
+    HAPRawBufferCopyBytes(
+            server->ble.persistentState.broadcastIntervals,
+            broadcastIntervals,
+            numBroadcasts * sizeof *broadcastIntervals);
+    server->ble.persistentState.numBroadcasts = (uint8_t) numBroadcasts;
+    return kHAPError_None;
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicGetBroadcastConfiguration(
+        HAPAccessoryServerRef* server_,
         const HAPCharacteristic* characteristic_,
         const HAPService* service,
         const HAPAccessory* accessory,
         bool* broadcastsEnabled,
-        HAPBLECharacteristicBroadcastInterval* broadcastInterval,
-        HAPPlatformKeyValueStoreRef keyValueStore) {
+        HAPBLECharacteristicBroadcastInterval* broadcastInterval) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(characteristic_);
     const HAPBaseCharacteristic* characteristic = characteristic_;
     HAPPrecondition(characteristic->properties.ble.supportsBroadcastNotification);
@@ -146,78 +293,47 @@ HAPError HAPBLECharacteristicGetBroadcastConfiguration(
     HAPPrecondition(accessory);
     HAPPrecondition(broadcastsEnabled);
     HAPPrecondition(broadcastInterval);
-    HAPPrecondition(keyValueStore);
 
     HAPError err;
 
     HAPAssert(accessory->aid == 1);
-    uint16_t aid = (uint16_t) accessory->aid;
     HAPAssert(characteristic->iid <= UINT16_MAX);
     uint16_t cid = (uint16_t) characteristic->iid;
 
     // Get configuration.
-    HAPPlatformKeyValueStoreKey key;
-    size_t numBytes;
-    uint8_t bytes[2 + 3 * 42 + 1]; // 128 + 1, allows for 42 concurrent broadcasts on a single KVS key.
-    bool found;
-    err = GetBroadcastConfiguration(aid, &found, bytes, sizeof bytes, &numBytes, &key, keyValueStore);
+    err = HAPBLECharacteristicLoadBroadcastConfiguration(server_);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    if (!found) {
-        *broadcastsEnabled = false;
-        return kHAPError_None;
-    }
-    HAPAssert(numBytes >= 2 && !((numBytes - 2) % 3));
-    HAPAssert(HAPReadLittleUInt16(bytes) == aid);
 
     // Find characteristic.
-    for (size_t i = 2; i < numBytes; i += 3) {
-        uint16_t itemCID = HAPReadLittleUInt16(&bytes[i]);
-        if (itemCID < cid) {
-            continue;
-        }
-        if (itemCID > cid) {
-            break;
-        }
-
-        // Found. Extract configuration.
-        uint8_t broadcastConfiguration = bytes[i + 2];
-        if (!HAPBLECharacteristicIsValidBroadcastInterval(broadcastConfiguration)) {
-            HAPLogCharacteristic(
-                    &logObject,
-                    characteristic,
-                    service,
-                    accessory,
-                    "Invalid stored broadcast interval: 0x%02x.",
-                    broadcastConfiguration);
-            return kHAPError_Unknown;
-        }
-        *broadcastsEnabled = true;
-        *broadcastInterval = (HAPBLECharacteristicBroadcastInterval) broadcastConfiguration;
+    bool found;
+    size_t i = FindBroadcastConfiguration(server, cid, &found);
+    if (!found) {
+        *broadcastsEnabled = false;
         return kHAPError_None;
     }
-
-    // Not found.
-    *broadcastsEnabled = false;
+    *broadcastsEnabled = true;
+    *broadcastInterval = server->ble.persistentState.broadcastIntervals[i];
     return kHAPError_None;
 }
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicEnableBroadcastNotifications(
+        HAPAccessoryServerRef* server_,
         const HAPCharacteristic* characteristic_,
         const HAPService* service,
         const HAPAccessory* accessory,
-        HAPBLECharacteristicBroadcastInterval broadcastInterval,
-        HAPPlatformKeyValueStoreRef keyValueStore) {
+        HAPBLECharacteristicBroadcastInterval broadcastInterval) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(characteristic_);
     const HAPBaseCharacteristic* characteristic = characteristic_;
     HAPPrecondition(characteristic->properties.ble.supportsBroadcastNotification);
     HAPPrecondition(service);
     HAPPrecondition(accessory);
     HAPPrecondition(HAPBLECharacteristicIsValidBroadcastInterval(broadcastInterval));
-    HAPPrecondition(keyValueStore);
 
     HAPError err;
 
@@ -230,82 +346,52 @@ HAPError HAPBLECharacteristicEnableBroadcastNotifications(
             broadcastInterval);
 
     HAPAssert(accessory->aid == 1);
-    uint16_t aid = (uint16_t) accessory->aid;
     HAPAssert(characteristic->iid <= UINT16_MAX);
     uint16_t cid = (uint16_t) characteristic->iid;
 
     // Get configuration.
-    HAPPlatformKeyValueStoreKey key;
-    size_t numBytes;
-    uint8_t bytes[2 + 3 * 42 + 1]; // 128 + 1, allows for 42 concurrent broadcasts on a single KVS key.
-    bool found;
-    err = GetBroadcastConfiguration(aid, &found, bytes, sizeof bytes, &numBytes, &key, keyValueStore);
+    err = HAPBLECharacteristicLoadBroadcastConfiguration(server_);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    if (!found) {
-        key = 0;
-        HAPWriteLittleUInt16(bytes, aid);
-        numBytes = 2;
-    }
-    HAPAssert(numBytes >= 2 && !((numBytes - 2) % 3));
-    HAPAssert(HAPReadLittleUInt16(bytes) == aid);
+    size_t numBroadcasts = server->ble.persistentState.numBroadcasts;
+    uint16_t cids[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+    HAPBLECharacteristicBroadcastInterval broadcastIntervals[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+    HAPRawBufferCopyBytes(cids, server->ble.persistentState.broadcastCIDs, numBroadcasts * sizeof cids[0]);
+    HAPRawBufferCopyBytes(
+            broadcastIntervals,
+            server->ble.persistentState.broadcastIntervals,
+            numBroadcasts * sizeof broadcastIntervals[0]);
 
     // Find characteristic.
-    size_t i;
-    for (i = 2; i < numBytes; i += 3) {
-        uint16_t itemCID = HAPReadLittleUInt16(&bytes[i]);
-        if (itemCID < cid) {
-            continue;
-        }
-        if (itemCID > cid) {
-            break;
+    bool found;
+    size_t i = FindBroadcastConfiguration(server, cid, &found);
+    if (found) {
+        // Update configuration.
+        if (broadcastIntervals[i] == broadcastInterval) {
+            return kHAPError_None;
         }
-
-        // Found. Extract configuration.
-        uint8_t broadcastConfiguration = bytes[i + 2];
-        if (!HAPBLECharacteristicIsValidBroadcastInterval(broadcastConfiguration)) {
+        broadcastIntervals[i] = broadcastInterval;
+    } else {
+        // Add configuration.
+        if (numBroadcasts >= kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts) {
             HAPLogCharacteristic(
                     &logObject,
                     characteristic,
                     service,
                     accessory,
-                    "Invalid stored broadcast interval: 0x%02x.",
-                    broadcastConfiguration);
+                    "Not enough space to store characteristic configuration.");
             return kHAPError_Unknown;
         }
-
-        // Update configuration.
-        if ((HAPBLECharacteristicBroadcastInterval) broadcastConfiguration == broadcastInterval) {
-            return kHAPError_None;
-        }
-        bytes[i + 2] = broadcastInterval;
-        err = HAPPlatformKeyValueStoreSet(
-                keyValueStore, kHAPKeyValueStoreDomain_CharacteristicConfiguration, key, bytes, numBytes);
-        if (err) {
-            HAPAssert(err == kHAPError_Unknown);
-            return err;
-        }
-        return kHAPError_None;
-    }
-
-    // Add configuration.
-    if (numBytes >= sizeof bytes - 1 - 3) {
-        HAPLogCharacteristic(
-                &logObject,
-                characteristic,
-                service,
-                accessory,
-                "Not enough space to store characteristic configuration.");
-        return kHAPError_Unknown;
+        HAPRawBufferCopyBytes(&cids[i + 1], &cids[i], (numBroadcasts - i) * sizeof cids[0]);
+        HAPRawBufferCopyBytes(
+                &broadcastIntervals[i + 1], &broadcastIntervals[i], (numBroadcasts - i) * sizeof broadcastIntervals[0]);
+        cids[i] = cid;
+        broadcastIntervals[i] = broadcastInterval;
+        numBroadcasts++;
     }
-    HAPRawBufferCopyBytes(&bytes[i + 3], &bytes[i], numBytes - i);
-    HAPWriteLittleUInt16(&bytes[i], cid);
-    bytes[i + 2] = broadcastInterval;
-    numBytes += 3;
-    err = HAPPlatformKeyValueStoreSet(
-            keyValueStore, kHAPKeyValueStoreDomain_CharacteristicConfiguration, key, bytes, numBytes);
+    err = SaveBroadcastConfiguration(server, cids, broadcastIntervals, numBroadcasts);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -315,81 +401,58 @@ HAPError HAPBLECharacteristicEnableBroadcastNotifications(
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicDisableBroadcastNotifications(
+        HAPAccessoryServerRef* server_,
         const HAPCharacteristic* characteristic_,
         const HAPService* service,
-        const HAPAccessory* accessory,
-        HAPPlatformKeyValueStoreRef keyValueStore) {
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(characteristic_);
     const HAPBaseCharacteristic* characteristic = characteristic_;
     HAPPrecondition(characteristic->properties.ble.supportsBroadcastNotification);
     HAPPrecondition(service);
     HAPPrecondition(accessory);
-    HAPPrecondition(keyValueStore);
 
     HAPError err;
 
     HAPLogCharacteristicInfo(&logObject, characteristic, service, accessory, "Disabling broadcasts.");
 
     HAPAssert(accessory->aid == 1);
-    uint16_t aid = (uint16_t) accessory->aid;
     HAPAssert(characteristic->iid <= UINT16_MAX);
     uint16_t cid = (uint16_t) characteristic->iid;
 
     // Get configuration.
-    HAPPlatformKeyValueStoreKey key;
-    size_t numBytes;
-    uint8_t bytes[2 + 3 * 42 + 1]; // 128 + 1, allows for 42 concurrent broadcasts on a single KVS key.
-    bool found;
-    err = GetBroadcastConfiguration(aid, &found, bytes, sizeof bytes, &numBytes, &key, keyValueStore);
+    err = HAPBLECharacteristicLoadBroadcastConfiguration(server_);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
+
+    // Find characteristic.
+    bool found;
+    size_t i = FindBroadcastConfiguration(server, cid, &found);
     if (!found) {
         return kHAPError_None;
     }
-    HAPAssert(numBytes >= 2 && !((numBytes - 2) % 3));
-    HAPAssert(HAPReadLittleUInt16(bytes) == aid);
-
-    // Find characteristic.
-    size_t i;
-    for (i = 2; i < numBytes; i += 3) {
-        uint16_t itemCID = HAPReadLittleUInt16(&bytes[i]);
-        if (itemCID < cid) {
-            continue;
-        }
-        if (itemCID > cid) {
-            break;
-        }
-
-        // Found. Extract configuration.
-        uint8_t broadcastConfiguration = bytes[i + 2];
-        if (!HAPBLECharacteristicIsValidBroadcastInterval(broadcastConfiguration)) {
-            HAPLogCharacteristic(
-                    &logObject,
-                    characteristic,
-                    service,
-                    accessory,
-                    "Invalid stored broadcast interval: 0x%02x.",
-                    broadcastConfiguration);
-            return kHAPError_Unknown;
-        }
 
-        // Remove configuration.
-        numBytes -= 3;
-        HAPRawBufferCopyBytes(&bytes[i], &bytes[i + 3], numBytes - i);
-        if (numBytes == 2) {
-            err = HAPPlatformKeyValueStoreRemove(
-                    keyValueStore, kHAPKeyValueStoreDomain_CharacteristicConfiguration, key);
-        } else {
-            err = HAPPlatformKeyValueStoreSet(
-                    keyValueStore, kHAPKeyValueStoreDomain_CharacteristicConfiguration, key, bytes, numBytes);
-        }
-        if (err) {
-            HAPAssert(err == kHAPError_Unknown);
-            return err;
-        }
-        return kHAPError_None;
+    // Remove configuration.
+    size_t numBroadcasts = server->ble.persistentState.numBroadcasts;
+    uint16_t cids[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+    HAPBLECharacteristicBroadcastInterval broadcastIntervals[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+    HAPRawBufferCopyBytes(cids, server->ble.persistentState.broadcastCIDs, i * sizeof cids[0]);
+    HAPRawBufferCopyBytes(
+            broadcastIntervals, server->ble.persistentState.broadcastIntervals, i * sizeof broadcastIntervals[0]);
+    numBroadcasts--;
+    HAPRawBufferCopyBytes(
+            &cids[i], &server->ble.persistentState.broadcastCIDs[i + 1], (numBroadcasts - i) * sizeof cids[0]);
+    HAPRawBufferCopyBytes(
+            &broadcastIntervals[i],
+            &server->ble.persistentState.broadcastIntervals[i + 1],
+            (numBroadcasts - i) * sizeof broadcastIntervals[0]);
+    err = SaveBroadcastConfiguration(server, cids, broadcastIntervals, numBroadcasts);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
     }
     return kHAPError_None;
 }
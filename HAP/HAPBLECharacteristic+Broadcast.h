@@ -33,6 +33,20 @@ HAP_ENUM_BEGIN(uint8_t, HAPBLECharacteristicBroadcastInterval) { /** 20 ms (Defa
                                                                  kHAPBLECharacteristicBroadcastInterval_2560Ms = 0x03
 } HAP_ENUM_END(uint8_t, HAPBLECharacteristicBroadcastInterval);
 
+/**
+ * Maximum number of characteristics of an accessory that may have broadcasts enabled at the same time.
+ */
+#define kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts ((size_t) 42)
+
+/**
+ * Maximum length of the stored broadcast configuration of an accessory.
+ *
+ * - Accessory instance ID followed by (characteristic instance ID, broadcast interval) entries.
+ *   All entries are stored on a single key-value store key.
+ */
+#define kHAPBLECharacteristicBroadcastConfiguration_MaxBytes \
+    ((size_t)(2 + 3 * kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts))
+
 /**
  * Checks whether a value represents a valid broadcast interval.
  *
@@ -44,15 +58,29 @@ HAP_ENUM_BEGIN(uint8_t, HAPBLECharacteristicBroadcastInterval) { /** 20 ms (Defa
 HAP_RESULT_USE_CHECK
 bool HAPBLECharacteristicIsValidBroadcastInterval(uint8_t value);
 
+/**
+ * Loads the broadcast configuration of the characteristics of the primary accessory from the key-value store,
+ * if it has not been loaded yet.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECharacteristicLoadBroadcastConfiguration(HAPAccessoryServerRef* server);
+
 /**
  * Gets the broadcast configuration of a characteristic.
  *
+ * - The configuration is served from memory. It is loaded from the key-value store on first use.
+ *
+ * @param      server               Accessory server.
  * @param      characteristic       Characteristic. Characteristic must support broadcasts.
  * @param      service              The service that contains the characteristic.
  * @param      accessory            The accessory that provides the service.
  * @param[out] broadcastsEnabled    Whether broadcast notifications are enabled.
  * @param[out] broadcastInterval    Broadcast interval, if broadcast notifications are enabled.
- * @param      keyValueStore        Key-value store.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -62,21 +90,23 @@ bool HAPBLECharacteristicIsValidBroadcastInterval(uint8_t value);
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicGetBroadcastConfiguration(
+        HAPAccessoryServerRef* server,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
         const HAPAccessory* accessory,
         bool* broadcastsEnabled,
-        HAPBLECharacteristicBroadcastInterval* broadcastInterval,
-        HAPPlatformKeyValueStoreRef keyValueStore);
+        HAPBLECharacteristicBroadcastInterval* broadcastInterval);
 
 /**
  * Enables broadcasts for a characteristic.
  *
+ * - The key-value store is only updated if the configuration changes.
+ *
+ * @param      server               Accessory server.
  * @param      characteristic       Characteristic. Characteristic must support broadcasts.
  * @param      service              The service that contains the characteristic.
  * @param      accessory            The accessory that provides the service.
  * @param      broadcastInterval    Broadcast interval.
- * @param      keyValueStore        Key-value store.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -86,19 +116,21 @@ HAPError HAPBLECharacteristicGetBroadcastConfiguration(
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicEnableBroadcastNotifications(
+        HAPAccessoryServerRef* server,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
         const HAPAccessory* accessory,
-        HAPBLECharacteristicBroadcastInterval broadcastInterval,
-        HAPPlatformKeyValueStoreRef keyValueStore);
+        HAPBLECharacteristicBroadcastInterval broadcastInterval);
 
 /**
  * Disables broadcasts for a characteristic.
  *
+ * - The key-value store is only updated if the configuration changes.
+ *
+ * @param      server               Accessory server.
  * @param      characteristic       Characteristic. Characteristic must support broadcasts.
  * @param      service              The service that contains the characteristic.
  * @param      accessory            The accessory that provides the service.
- * @param      keyValueStore        Key-value store.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -108,10 +140,10 @@ HAPError HAPBLECharacteristicEnableBroadcastNotifications(
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicDisableBroadcastNotifications(
+        HAPAccessoryServerRef* server,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
-        const HAPAccessory* accessory,
-        HAPPlatformKeyValueStoreRef keyValueStore);
+        const HAPAccessory* accessory);
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
@@ -20,11 +20,11 @@ extern "C" {
 /**
  * Processes a HAP-Characteristic-Configuration-Request.
  *
+ * @param      server               Accessory server.
  * @param      characteristic       Characteristic that received the request.
  * @param      service              The service that contains the characteristic.
  * @param      accessory            The accessory that provides the service.
  * @param      requestReader        Reader to parse Characteristic Configuration from. Reader content becomes invalid.
- * @param      keyValueStore        Key-value store.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -35,20 +35,20 @@ extern "C" {
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicHandleConfigurationRequest(
+        HAPAccessoryServerRef* server,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
         const HAPAccessory* accessory,
-        HAPTLVReaderRef* requestReader,
-        HAPPlatformKeyValueStoreRef keyValueStore);
+        HAPTLVReaderRef* requestReader);
 
 /**
  * Serializes the body of a HAP-Characteristic-Configuration-Response.
  *
+ * @param      server               Accessory server.
  * @param      characteristic       Characteristic that received the request.
  * @param      service              The service that contains the characteristic.
  * @param      accessory            The accessory that provides the service.
  * @param      responseWriter       Writer to serialize Characteristic Configuration into.
- * @param      keyValueStore        Key-value store.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
@@ -59,11 +59,11 @@ HAPError HAPBLECharacteristicHandleConfigurationRequest(
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPBLECharacteristicGetConfigurationResponse(
+        HAPAccessoryServerRef* server,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
         const HAPAccessory* accessory,
-        HAPTLVWriterRef* responseWriter,
-        HAPPlatformKeyValueStoreRef keyValueStore);
+        HAPTLVWriterRef* responseWriter);
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
@@ -17,9 +17,48 @@ typedef struct {
     size_t maxBytes; /**< Capacity of value, including free memory after the value. */
 } HAPCharacteristicValueTLV;
 
+/**
+ * Copies the value of a TLV item that may consist of multiple fragments to a location in the same buffer.
+ *
+ * - Fragments are copied in the order that keeps fragments that have not been copied yet intact.
+ *
+ * @param      item                 TLV item.
+ * @param      bytes                Destination. Must not overlap TLV data that is accessed afterwards.
+ */
+static void MoveFragmentedItem(const HAPTLVFragmentedItem* item, void* bytes) {
+    HAPPrecondition(item);
+    HAPPrecondition(bytes);
+
+    if ((uintptr_t) bytes <= (uintptr_t) item->bytes) {
+        size_t o = 0;
+        for (size_t i = 0; i < item->numFragments; i++) {
+            const void* fragmentBytes;
+            size_t numFragmentBytes;
+            HAPTLVFragmentedItemGetFragment(item, i, &fragmentBytes, &numFragmentBytes);
+            HAPRawBufferCopyBytes(&((uint8_t*) bytes)[o], fragmentBytes, numFragmentBytes);
+            o += numFragmentBytes;
+        }
+        HAPAssert(o == item->numValueBytes);
+    } else {
+        size_t o = item->numValueBytes;
+        for (size_t i = item->numFragments; i; i--) {
+            const void* fragmentBytes;
+            size_t numFragmentBytes;
+            HAPTLVFragmentedItemGetFragment(item, i - 1, &fragmentBytes, &numFragmentBytes);
+            HAPAssert(numFragmentBytes <= o);
+            o -= numFragmentBytes;
+            HAPRawBufferCopyBytes(&((uint8_t*) bytes)[o], fragmentBytes, numFragmentBytes);
+        }
+        HAPAssert(!o);
+    }
+}
+
 /**
  * Parses the body of a a HAP-Characteristic-Write-Request.
  *
+ * - The body is parsed with a read-only TLV reader. Fragmented items are not merged in place but copied once
+ *   to their final location, e.g., the Char Value of Pair Setup M3 and M5 and of Pair Verify M3.
+ *
  * @param      characteristic_      Characteristic that received the request.
  * @param      requestReader        Reader to parse Characteristic value from. Reader content will become invalid.
  * @param[out] value                Char Value TLV item.
@@ -54,42 +93,80 @@ static HAPError ParseRequest(
 
     HAPError err;
 
-    HAPTLV valueTLV, authDataTLV, originTLV;
-    valueTLV.type = kHAPBLEPDUTLVType_Value;
-    authDataTLV.type = kHAPBLEPDUTLVType_AdditionalAuthorizationData;
-    originTLV.type = kHAPBLEPDUTLVType_Origin;
+    uint8_t* bytes = ((HAPTLVReader*) requestReader)->bytes;
+    size_t numBytes = ((HAPTLVReader*) requestReader)->numBytes;
+    size_t maxBytes = ((HAPTLVReader*) requestReader)->maxBytes;
 
     // See HomeKit Accessory Protocol Specification R14
     // Section 7.3.5.4 HAP Characteristic Timed Write Procedure
-    HAPTLV ttlTLV;
-    ttlTLV.type = kHAPBLEPDUTLVType_TTL;
-
     // See HomeKit Accessory Protocol Specification R14
     // Section 7.3.5.5 HAP Characteristic Write-With-Response Procedure
-    HAPTLV returnResponseTLV;
-    returnResponseTLV.type = kHAPBLEPDUTLVType_ReturnResponse;
+    HAPTLVFragmentedItem valueItem, authDataItem, originItem, ttlItem, returnResponseItem;
+    bool hasValue = false, hasAuthData = false, hasOrigin = false, hasTTL = false, hasReturnResponseItem = false;
+
+    HAPTLVFragmentReader reader;
+    HAPTLVFragmentReaderCreate(&reader, bytes, numBytes);
+    for (;;) {
+        HAPTLVFragmentedItem item;
+        bool found;
+        err = HAPTLVFragmentReaderGetNext(&reader, &found, &item);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
 
-    err = HAPTLVReaderGetAll(
-            requestReader,
-            (HAPTLV* const[]) { &valueTLV, &authDataTLV, &originTLV, &ttlTLV, &returnResponseTLV, NULL });
-    if (err) {
-        HAPAssert(err == kHAPError_InvalidData);
-        return err;
+        HAPTLVFragmentedItem* matchingItem;
+        bool* isPresent;
+        switch (item.type) {
+            case kHAPBLEPDUTLVType_Value: {
+                matchingItem = &valueItem;
+                isPresent = &hasValue;
+            } break;
+            case kHAPBLEPDUTLVType_AdditionalAuthorizationData: {
+                matchingItem = &authDataItem;
+                isPresent = &hasAuthData;
+            } break;
+            case kHAPBLEPDUTLVType_Origin: {
+                matchingItem = &originItem;
+                isPresent = &hasOrigin;
+            } break;
+            case kHAPBLEPDUTLVType_TTL: {
+                matchingItem = &ttlItem;
+                isPresent = &hasTTL;
+            } break;
+            case kHAPBLEPDUTLVType_ReturnResponse: {
+                matchingItem = &returnResponseItem;
+                isPresent = &hasReturnResponseItem;
+            } break;
+            default: {
+                HAPLog(&logObject, "[%02x] TLV item ignored.", item.type);
+                continue;
+            }
+        }
+        if (*isPresent) {
+            HAPLog(&logObject, "[%02x] Duplicate TLV.", item.type);
+            return kHAPError_InvalidData;
+        }
+        *matchingItem = item;
+        *isPresent = true;
     }
 
     // HAP-Param-Value.
-    if (!valueTLV.value.bytes) {
+    if (!hasValue) {
         HAPLog(&logObject, "HAP-Param-Value missing.");
         return kHAPError_InvalidData;
     }
 
     // HAP-Param-Origin.
-    if (originTLV.value.bytes) {
-        if (originTLV.value.numBytes != 1) {
-            HAPLog(&logObject, "HAP-Param-Origin has invalid length (%lu).", (unsigned long) originTLV.value.numBytes);
+    if (hasOrigin) {
+        if (originItem.numValueBytes != 1) {
+            HAPLog(&logObject, "HAP-Param-Origin has invalid length (%lu).", (unsigned long) originItem.numValueBytes);
             return kHAPError_InvalidData;
         }
-        uint8_t origin = ((const uint8_t*) originTLV.value.bytes)[0];
+        uint8_t origin = ((const uint8_t*) originItem.bytes)[2];
 
         switch (origin) {
             case 0: {
@@ -108,11 +185,10 @@ static HAPError ParseRequest(
     }
 
     // HAP-Param-Additional-Authorization-Data, HAP-Param-Origin.
-    *authDataBytes = NULL;
-    *numAuthDataBytes = 0;
+    bool usesAuthData = false;
     if (characteristic->properties.supportsAuthorizationData) {
-        if (authDataTLV.value.bytes) {
-            if (!originTLV.value.bytes) {
+        if (hasAuthData) {
+            if (!hasOrigin) {
                 // When additional authorization data is present it is included
                 // as an additional type to the TLV8 format along with the Value and Remote TLV types.
                 // See HomeKit Accessory Protocol Specification R14
@@ -121,34 +197,33 @@ static HAPError ParseRequest(
                 return kHAPError_InvalidData;
             }
 
-            *authDataBytes = authDataTLV.value.bytes;
-            *numAuthDataBytes = authDataTLV.value.numBytes;
+            usesAuthData = true;
         }
-    } else if (authDataTLV.value.bytes) {
+    } else if (hasAuthData) {
         HAPLog(&logObject,
                "HAP-Param-Additional-Authorization-Data present but Additional Authorization is not supported.");
     }
 
     // HAP-Param-TTL.
-    if (ttlTLV.value.bytes) {
-        if (ttlTLV.value.numBytes != 1) {
-            HAPLog(&logObject, "HAP-Param-TTL has invalid length (%lu).", (unsigned long) ttlTLV.value.numBytes);
+    if (hasTTL) {
+        if (ttlItem.numValueBytes != 1) {
+            HAPLog(&logObject, "HAP-Param-TTL has invalid length (%lu).", (unsigned long) ttlItem.numValueBytes);
             return kHAPError_InvalidData;
         }
-        *ttl = ((const uint8_t*) ttlTLV.value.bytes)[0];
+        *ttl = ((const uint8_t*) ttlItem.bytes)[2];
     } else {
         *ttl = 0;
     }
 
     // HAP-Param-Return-Response.
-    if (returnResponseTLV.value.bytes) {
-        if (returnResponseTLV.value.numBytes != 1) {
+    if (hasReturnResponseItem) {
+        if (returnResponseItem.numValueBytes != 1) {
             HAPLog(&logObject,
                    "HAP-Param-Return-Response has invalid length (%lu).",
-                   (unsigned long) returnResponseTLV.value.numBytes);
+                   (unsigned long) returnResponseItem.numValueBytes);
             return kHAPError_InvalidData;
         }
-        uint8_t returnResponse = ((const uint8_t*) returnResponseTLV.value.bytes)[0];
+        uint8_t returnResponse = ((const uint8_t*) returnResponseItem.bytes)[2];
         if (returnResponse != 1) {
             HAPLog(&logObject, "HAP-Param-Return-Response invalid: %u.", returnResponse);
             return kHAPError_InvalidData;
@@ -159,24 +234,24 @@ static HAPError ParseRequest(
     }
 
     // Optimize memory. We want as much free space as possible after the value.
-    uint8_t* bytes = ((HAPTLVReader*) requestReader)->bytes;
-    size_t maxBytes = ((HAPTLVReader*) requestReader)->maxBytes;
-
     // TLV values are always NULL terminated to simplify string handling. This property should be retained.
     // The NULL terminator is not counted in the TLV value's numBytes.
     // Case 1: [  AAD  |  VAL  | empty ]
     // Case 2: [  VAL  | empty |  AAD  ]
     // Case 3: [  VAL  |     empty     ]
     //         AAD and VAL fields contain an additional NULL byte.
+    // Fragments are gathered directly into place. Each destination starts before the source item, or after it and
+    // all TLV data that is copied afterwards, so no source data is overwritten before it has been copied.
     HAPRawBufferZero(value, sizeof *value);
-    if (*authDataBytes) {
-        size_t numValueBytes = valueTLV.value.numBytes;
-        size_t numValueBytesWithNull = numValueBytes + 1;
-        size_t numAuthDataBytesWithNull = *numAuthDataBytes + 1;
+    *authDataBytes = NULL;
+    *numAuthDataBytes = 0;
+    if (usesAuthData) {
+        size_t numValueBytes = valueItem.numValueBytes;
+        size_t numAuthDataBytesWithNull = authDataItem.numValueBytes + 1;
 
-        void* valueStart;
-        void* authDataStart;
-        if (*authDataBytes < valueTLV.value.bytes) {
+        uint8_t* valueStart;
+        uint8_t* authDataStart;
+        if ((uintptr_t) authDataItem.bytes < (uintptr_t) valueItem.bytes) {
             // Case 1.
             authDataStart = &bytes[0];
             valueStart = &bytes[numAuthDataBytesWithNull];
@@ -187,23 +262,26 @@ static HAPError ParseRequest(
         }
 
         // Move AAD.
-        HAPRawBufferCopyBytes(authDataStart, *authDataBytes, numAuthDataBytesWithNull);
+        MoveFragmentedItem(&authDataItem, authDataStart);
+        authDataStart[authDataItem.numValueBytes] = '\0';
         *authDataBytes = authDataStart;
+        *numAuthDataBytes = authDataItem.numValueBytes;
 
         // Move VAL.
-        HAPRawBufferCopyBytes(valueStart, HAPNonnullVoid(valueTLV.value.bytes), numValueBytesWithNull);
+        MoveFragmentedItem(&valueItem, valueStart);
+        valueStart[numValueBytes] = '\0';
         value->bytes = valueStart;
         value->numBytes = numValueBytes;
         value->maxBytes = maxBytes - numAuthDataBytesWithNull;
     } else {
-        size_t numValueBytes = valueTLV.value.numBytes;
-        size_t numValueBytesWithNULL = numValueBytes + 1;
+        size_t numValueBytes = valueItem.numValueBytes;
 
         // Case 3.
-        void* valueStart = &bytes[0];
+        uint8_t* valueStart = &bytes[0];
 
         // Move VAL.
-        HAPRawBufferCopyBytes(valueStart, HAPNonnullVoid(valueTLV.value.bytes), numValueBytesWithNULL);
+        MoveFragmentedItem(&valueItem, valueStart);
+        valueStart[numValueBytes] = '\0';
         value->bytes = valueStart;
         value->numBytes = numValueBytes;
         value->maxBytes = maxBytes;
@@ -261,7 +339,7 @@ HAPError HAPBLECharacteristicParseAndWriteValue(
             return kHAPError_InvalidData;
         }
 
-        HAPTime now = HAPPlatformClockGetCurrent();
+        HAPTime now = HAPPlatformClockGetCurrentCoarse();
         *hasExpired = now >= ttl * 100 * HAPMillisecond && now - ttl * 100 * HAPMillisecond > *timedWriteStartTime;
         if (*hasExpired) {
             return kHAPError_None;
@@ -650,7 +650,9 @@ HAPError HAPBLEPDUSerialize(const HAPBLEPDU* pdu, void* bytes, size_t maxBytes,
                     HAPLog(&logObject, "Not enough capacity to serialize PDU Body.");
                     return kHAPError_OutOfResources;
                 }
-                HAPRawBufferCopyBytes(b, HAPNonnullVoid(pdu->body.bytes), pdu->body.numBytes);
+                if (pdu->body.bytes != b) {
+                    HAPRawBufferCopyBytes(b, HAPNonnullVoid(pdu->body.bytes), pdu->body.numBytes);
+                }
                 b += pdu->body.numBytes;
                 remainingBytes -= pdu->body.numBytes;
             }
@@ -673,7 +675,9 @@ HAPError HAPBLEPDUSerialize(const HAPBLEPDU* pdu, void* bytes, size_t maxBytes,
                 HAPLog(&logObject, "Received empty continuation fragment.");
             } else {
                 HAPAssert(pdu->body.bytes);
-                HAPRawBufferCopyBytes(b, HAPNonnullVoid(pdu->body.bytes), pdu->body.numBytes);
+                if (pdu->body.bytes != b) {
+                    HAPRawBufferCopyBytes(b, HAPNonnullVoid(pdu->body.bytes), pdu->body.numBytes);
+                }
                 b += pdu->body.numBytes;
                 remainingBytes -= pdu->body.numBytes;
             }
@@ -266,6 +266,8 @@ HAPError HAPBLEPDUDeserializeContinuation(
  *
  * - For continuations of fragmented PDUs, @c pdu->body.totalBodyBytes is not validated.
  *
+ * - If @c pdu->body.bytes already points to where the body is serialized, only the header is written.
+ *
  * @param      pdu                  PDU to serialize.
  * @param      bytes                Start of the memory region to serialize into.
  * @param      maxBytes             Capacity of the memory region to serialize into.
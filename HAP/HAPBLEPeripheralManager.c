@@ -95,6 +95,14 @@ typedef struct {
      */
     HAPPlatformBLEPeripheralManagerAttributeHandle iidHandle;
 
+    /**
+     * Index of the first GATT table element that may contain the attribute handles of the lookup bucket with the same
+     * index as this element.
+     *
+     * - Lookup bucket k starts at attribute handle firstHandle + k * numHandlesPerBucket of the GATT table index.
+     */
+    uint16_t bucketElementIndex;
+
     /**
      * State related about the connected controller.
      */
@@ -117,6 +125,13 @@ typedef struct {
          * - This is only maintained for HomeKit characteristics that support HAP Events.
          */
         bool pendingEvent : 1;
+
+        /**
+         * Index + 1 of the next GATT table element in the pending event queue. 0 if this is the last one.
+         *
+         * - This is only valid while pendingEvent is set.
+         */
+        uint16_t nextPendingEvent;
     } connectionState;
 } HAPBLEGATTTableElement;
 HAP_STATIC_ASSERT(sizeof(HAPBLEGATTTableElementRef) >= sizeof(HAPBLEGATTTableElement), HAPBLEGATTTableElement);
@@ -142,7 +157,10 @@ static void ResetEventState(HAPAccessoryServerRef* server_) {
 
         gattAttribute->connectionState.centralSubscribed = false;
         gattAttribute->connectionState.pendingEvent = false;
+        gattAttribute->connectionState.nextPendingEvent = 0;
     }
+    server->ble.gattTable.pendingEventsHead = 0;
+    server->ble.gattTable.pendingEventsTail = 0;
 }
 
 /**
@@ -271,9 +289,68 @@ static void HandleDisconnectedCentral(
     }
 }
 
+/**
+ * Appends a GATT attribute to the queue of pending HAP events.
+ *
+ * @param      server_              Accessory server.
+ * @param      gattAttribute        GATT attribute of a characteristic that supports HAP events.
+ */
+static void EnqueuePendingEvent(HAPAccessoryServerRef* server_, HAPBLEGATTTableElement* gattAttribute) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(gattAttribute);
+    HAPPrecondition(!gattAttribute->connectionState.pendingEvent);
+    HAPBLEGATTTableElement* gattAttributes = (HAPBLEGATTTableElement*) server->ble.storage->gattTableElements;
+
+    size_t index = (size_t)(gattAttribute - gattAttributes);
+    HAPAssert(index < server->ble.gattTable.numElements);
+
+    gattAttribute->connectionState.pendingEvent = true;
+    gattAttribute->connectionState.nextPendingEvent = 0;
+    if (server->ble.gattTable.pendingEventsTail) {
+        gattAttributes[server->ble.gattTable.pendingEventsTail - 1].connectionState.nextPendingEvent =
+                (uint16_t)(index + 1);
+    } else {
+        server->ble.gattTable.pendingEventsHead = (uint16_t)(index + 1);
+    }
+    server->ble.gattTable.pendingEventsTail = (uint16_t)(index + 1);
+}
+
+/**
+ * Removes a GATT attribute from the queue of pending HAP events.
+ *
+ * @param      server_              Accessory server.
+ * @param      previousPendingEvent Index + 1 of the preceding GATT attribute in the queue. 0 if it is the first one.
+ * @param      gattAttribute        GATT attribute to remove.
+ */
+static void DequeuePendingEvent(
+        HAPAccessoryServerRef* server_,
+        uint16_t previousPendingEvent,
+        HAPBLEGATTTableElement* gattAttribute) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(gattAttribute);
+    HAPPrecondition(gattAttribute->connectionState.pendingEvent);
+    HAPBLEGATTTableElement* gattAttributes = (HAPBLEGATTTableElement*) server->ble.storage->gattTableElements;
+
+    uint16_t nextPendingEvent = gattAttribute->connectionState.nextPendingEvent;
+    if (previousPendingEvent) {
+        gattAttributes[previousPendingEvent - 1].connectionState.nextPendingEvent = nextPendingEvent;
+    } else {
+        server->ble.gattTable.pendingEventsHead = nextPendingEvent;
+    }
+    if (!nextPendingEvent) {
+        server->ble.gattTable.pendingEventsTail = previousPendingEvent;
+    }
+    gattAttribute->connectionState.pendingEvent = false;
+    gattAttribute->connectionState.nextPendingEvent = 0;
+}
+
 /**
  * Continues sending of pending HAP event notifications.
  *
+ * - Only the queue of pending events is visited, so the cost does not depend on the size of the GATT table.
+ *
  * @param      server_              Accessory server.
  */
 static void SendPendingEventNotifications(HAPAccessoryServerRef* server_) {
@@ -284,26 +361,22 @@ static void SendPendingEventNotifications(HAPAccessoryServerRef* server_) {
     HAPPrecondition(server->ble.connection.connected);
     HAPPrecondition(server->ble.storage->session);
     HAPSessionRef* session = server->ble.storage->session;
+    HAPBLEGATTTableElement* gattAttributes = (HAPBLEGATTTableElement*) server->ble.storage->gattTableElements;
 
     HAPError err;
 
-    for (size_t i = 0; i < server->ble.storage->numGATTTableElements; i++) {
-        HAPBLEGATTTableElement* gattAttribute = (HAPBLEGATTTableElement*) &server->ble.storage->gattTableElements[i];
-        const HAPBaseCharacteristic* characteristic = gattAttribute->characteristic;
-        const HAPService* service = gattAttribute->service;
-        const HAPAccessory* accessory = gattAttribute->accessory;
-        if (!accessory) {
-            break;
-        }
-        HAPAssert(service);
-        if (!characteristic) {
-            continue;
-        }
-        if (!characteristic->properties.supportsEventNotification) {
-            HAPAssert(!gattAttribute->connectionState.centralSubscribed);
-            HAPAssert(!gattAttribute->connectionState.pendingEvent);
-            continue;
-        }
+    // When an event is dequeued, pendingEvent is rewound to its predecessor so that the loop advances to the successor.
+    uint16_t previousPendingEvent = 0;
+    uint16_t nextPendingEvent;
+    for (uint16_t pendingEvent = server->ble.gattTable.pendingEventsHead; pendingEvent;
+         previousPendingEvent = pendingEvent, pendingEvent = nextPendingEvent) {
+        HAPBLEGATTTableElement* gattAttribute = &gattAttributes[pendingEvent - 1];
+        nextPendingEvent = gattAttribute->connectionState.nextPendingEvent;
+        const HAPBaseCharacteristic* characteristic = HAPNonnullVoid(gattAttribute->characteristic);
+        const HAPService* service = HAPNonnull(gattAttribute->service);
+        const HAPAccessory* accessory = HAPNonnull(gattAttribute->accessory);
+        HAPAssert(gattAttribute->connectionState.pendingEvent);
+        HAPAssert(characteristic->properties.supportsEventNotification);
         if (characteristic->iid > UINT16_MAX) {
             HAPLogCharacteristicError(
                     &logObject,
@@ -320,9 +393,6 @@ static void SendPendingEventNotifications(HAPAccessoryServerRef* server_) {
         if (!gattAttribute->connectionState.centralSubscribed) {
             continue;
         }
-        if (!gattAttribute->connectionState.pendingEvent) {
-            continue;
-        }
         if (!HAPSessionIsSecured(session)) {
             HAPLogCharacteristicInfo(
                     &logObject,
@@ -370,7 +440,8 @@ static void SendPendingEventNotifications(HAPAccessoryServerRef* server_) {
             HAPAssert(err == kHAPError_OutOfResources);
             HAPFatalError();
         }
-        gattAttribute->connectionState.pendingEvent = false;
+        DequeuePendingEvent(server_, previousPendingEvent, gattAttribute);
+        pendingEvent = previousPendingEvent;
         HAPLogCharacteristicInfo(&logObject, characteristic, service, accessory, "Sent event.");
 
         err = HAPBLEAccessoryServerDidSendEventNotification(server_, characteristic, service, accessory);
@@ -381,9 +452,80 @@ static void SendPendingEventNotifications(HAPAccessoryServerRef* server_) {
     }
 }
 
+/**
+ * Gets the lowest attribute handle of a GATT attribute structure.
+ *
+ * @param      gattAttribute        GATT attribute structure.
+ *
+ * @return Lowest attribute handle.
+ */
+HAP_RESULT_USE_CHECK
+static HAPPlatformBLEPeripheralManagerAttributeHandle
+        GetFirstAttributeHandle(const HAPBLEGATTTableElement* gattAttribute) {
+    HAPPrecondition(gattAttribute);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle = gattAttribute->iidHandle;
+    if (gattAttribute->valueHandle && gattAttribute->valueHandle < attributeHandle) {
+        attributeHandle = gattAttribute->valueHandle;
+    }
+    if (gattAttribute->cccDescriptorHandle && gattAttribute->cccDescriptorHandle < attributeHandle) {
+        attributeHandle = gattAttribute->cccDescriptorHandle;
+    }
+    return attributeHandle;
+}
+
+/**
+ * Gets the highest attribute handle of a GATT attribute structure.
+ *
+ * @param      gattAttribute        GATT attribute structure.
+ *
+ * @return Highest attribute handle.
+ */
+HAP_RESULT_USE_CHECK
+static HAPPlatformBLEPeripheralManagerAttributeHandle
+        GetLastAttributeHandle(const HAPBLEGATTTableElement* gattAttribute) {
+    HAPPrecondition(gattAttribute);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle = gattAttribute->iidHandle;
+    if (gattAttribute->valueHandle > attributeHandle) {
+        attributeHandle = gattAttribute->valueHandle;
+    }
+    if (gattAttribute->cccDescriptorHandle > attributeHandle) {
+        attributeHandle = gattAttribute->cccDescriptorHandle;
+    }
+    return attributeHandle;
+}
+
+/**
+ * Returns whether an attribute handle belongs to a GATT attribute structure.
+ *
+ * @param      gattAttribute        GATT attribute structure.
+ * @param      attributeHandle      GATT attribute handle.
+ *
+ * @return true                     If the attribute handle belongs to the GATT attribute structure.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool HasAttributeHandle(
+        const HAPBLEGATTTableElement* gattAttribute,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle) {
+    HAPPrecondition(gattAttribute);
+    HAPPrecondition(attributeHandle);
+
+    return attributeHandle == gattAttribute->valueHandle || attributeHandle == gattAttribute->cccDescriptorHandle ||
+           attributeHandle == gattAttribute->iidHandle;
+}
+
 /**
  * Gets the GATT attribute structure associated with an attribute handle.
  *
+ * - If the attribute handles match the precomputed GATT layout of the accessory, it yields the GATT attribute structure
+ *   directly.
+ *
+ * - If attribute handles were assigned in ascending order, each GATT attribute structure covers the attribute handles
+ *   following the highest attribute handle of its predecessor. The lookup bucket of the attribute handle then yields
+ *   a GATT attribute structure close to the one that covers it.
+ *
  * @param      server_              Accessory server.
  * @param      attributeHandle      GATT attribute handle.
  *
@@ -396,31 +538,39 @@ static HAPBLEGATTTableElement* _Nullable GetGATTAttribute(
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(attributeHandle);
-
-    for (size_t i = 0; i < server->ble.storage->numGATTTableElements; i++) {
-        HAPBLEGATTTableElement* gattAttribute = (HAPBLEGATTTableElement*) &server->ble.storage->gattTableElements[i];
-        if (!gattAttribute->accessory) {
-            break;
+    HAPBLEGATTTableElement* gattAttributes = (HAPBLEGATTTableElement*) server->ble.storage->gattTableElements;
+    size_t numElements = server->ble.gattTable.numElements;
+
+    if (server->ble.gattTable.elementIndices) {
+        if (attributeHandle >= server->ble.gattTable.firstHandle) {
+            size_t offset = (size_t)(attributeHandle - server->ble.gattTable.firstHandle);
+            if (offset < server->ble.gattTable.numElementIndices) {
+                size_t i = server->ble.gattTable.elementIndices[offset];
+                HAPAssert(i < numElements);
+                if (HasAttributeHandle(&gattAttributes[i], attributeHandle)) {
+                    return &gattAttributes[i];
+                }
+            }
         }
-
-        // Validate GATT attribute.
-        HAPAssert(gattAttribute->service);
-        if (!gattAttribute->characteristic) {
-            HAPAssert(!gattAttribute->valueHandle);
-            HAPAssert(!gattAttribute->cccDescriptorHandle);
-        } else {
-            const HAPBaseCharacteristic* characteristic = gattAttribute->characteristic;
-            HAPAssert(gattAttribute->valueHandle);
-            if (!characteristic->properties.supportsEventNotification) {
-                HAPAssert(!gattAttribute->cccDescriptorHandle);
+    } else if (server->ble.gattTable.numHandlesPerBucket) {
+        if (attributeHandle >= server->ble.gattTable.firstHandle) {
+            size_t bucket = (size_t)(attributeHandle - server->ble.gattTable.firstHandle) /
+                            server->ble.gattTable.numHandlesPerBucket;
+            if (bucket < numElements) {
+                size_t i = gattAttributes[bucket].bucketElementIndex;
+                while (i < numElements && GetLastAttributeHandle(&gattAttributes[i]) < attributeHandle) {
+                    i++;
+                }
+                if (i < numElements && HasAttributeHandle(&gattAttributes[i], attributeHandle)) {
+                    return &gattAttributes[i];
+                }
             }
         }
-        HAPAssert(gattAttribute->iidHandle);
-
-        // Check for match.
-        if (attributeHandle == gattAttribute->valueHandle || attributeHandle == gattAttribute->cccDescriptorHandle ||
-            attributeHandle == gattAttribute->iidHandle) {
-            return gattAttribute;
+    } else {
+        for (size_t i = 0; i < numElements; i++) {
+            if (HasAttributeHandle(&gattAttributes[i], attributeHandle)) {
+                return &gattAttributes[i];
+            }
         }
     }
     HAPLog(&logObject, "GATT attribute structure not found for handle 0x%04x", (unsigned int) attributeHandle);
@@ -1059,7 +1209,7 @@ HAP_PWT_HAPBLEProcedureType(5, 4) HAP_RESULT_USE_CHECK static HAPError AttachPro
 #if !DEBUG_DISABLE_TIMEOUTS
                 err = HAPPlatformTimerRegister(
                         &fallbackProcedure->timer,
-                        HAPPlatformClockGetCurrent() + 10 * HAPSecond,
+                        HAPPlatformClockGetCurrentCoarse() + 10 * HAPSecond,
                         FallbackProcedureTimerExpired,
                         server_);
                 if (err) {
@@ -1453,6 +1603,54 @@ static void HandleReadyToUpdateSubscribers(
     SendPendingEventNotifications(server_);
 }
 
+/**
+ * Returns whether the attribute handles of a GATT table match a precomputed GATT layout.
+ *
+ * @param      gattAttributes       GATT table elements.
+ * @param      numElements          Number of GATT table elements.
+ * @param      firstHandle          Lowest attribute handle of the GATT table elements.
+ * @param      elementIndices       Index of the GATT table element that covers each attribute handle from firstHandle.
+ * @param      numElementIndices    Number of attribute handles covered by elementIndices.
+ *
+ * @return true                     If every attribute handle maps to the GATT table element that it belongs to.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool MatchesGATTLayout(
+        const HAPBLEGATTTableElement* gattAttributes,
+        size_t numElements,
+        HAPPlatformBLEPeripheralManagerAttributeHandle firstHandle,
+        const uint16_t* elementIndices,
+        size_t numElementIndices) {
+    HAPPrecondition(gattAttributes);
+    HAPPrecondition(elementIndices);
+
+    for (size_t i = 0; i < numElementIndices; i++) {
+        if (elementIndices[i] >= numElements) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < numElements; i++) {
+        const HAPBLEGATTTableElement* gattAttribute = &gattAttributes[i];
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandles[] = { gattAttribute->valueHandle,
+                                                                              gattAttribute->cccDescriptorHandle,
+                                                                              gattAttribute->iidHandle };
+        for (size_t j = 0; j < HAPArrayCount(attributeHandles); j++) {
+            if (!attributeHandles[j]) {
+                continue;
+            }
+            if (attributeHandles[j] < firstHandle) {
+                return false;
+            }
+            size_t offset = (size_t)(attributeHandles[j] - firstHandle);
+            if (offset >= numElementIndices || elementIndices[offset] != i) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void HAPBLEPeripheralManagerRegister(HAPAccessoryServerRef* server_) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
@@ -1467,6 +1665,7 @@ void HAPBLEPeripheralManagerRegister(HAPAccessoryServerRef* server_) {
     HAPRawBufferZero(
             server->ble.storage->gattTableElements,
             server->ble.storage->numGATTTableElements * sizeof *server->ble.storage->gattTableElements);
+    HAPRawBufferZero(&server->ble.gattTable, sizeof server->ble.gattTable);
     HAPPlatformBLEPeripheralManagerRemoveAllServices(blePeripheralManager);
 
     // Set delegate.
@@ -1630,6 +1829,77 @@ void HAPBLEPeripheralManagerRegister(HAPAccessoryServerRef* server_) {
         }
     }
 
+    // Index GATT table.
+    // Attribute handles are 16 bit and every GATT attribute structure has a distinct Instance ID handle.
+    HAPAssert(o <= UINT16_MAX);
+    HAPBLEGATTTableElement* gattAttributes = (HAPBLEGATTTableElement*) server->ble.storage->gattTableElements;
+    server->ble.gattTable.numElements = (uint16_t) o;
+    bool isAscending = o != 0;
+    HAPPlatformBLEPeripheralManagerAttributeHandle lastHandle = 0;
+    for (size_t i = 0; i < o; i++) {
+        HAPBLEGATTTableElement* gattAttribute = &gattAttributes[i];
+
+        // Validate GATT attribute.
+        HAPAssert(gattAttribute->accessory);
+        HAPAssert(gattAttribute->service);
+        if (!gattAttribute->characteristic) {
+            HAPAssert(!gattAttribute->valueHandle);
+            HAPAssert(!gattAttribute->cccDescriptorHandle);
+        } else {
+            const HAPBaseCharacteristic* characteristic = gattAttribute->characteristic;
+            HAPAssert(gattAttribute->valueHandle);
+            if (!characteristic->properties.supportsEventNotification) {
+                HAPAssert(!gattAttribute->cccDescriptorHandle);
+            }
+        }
+        HAPAssert(gattAttribute->iidHandle);
+
+        if (GetFirstAttributeHandle(gattAttribute) <= lastHandle) {
+            isAscending = false;
+        }
+        lastHandle = GetLastAttributeHandle(gattAttribute);
+    }
+    const HAPPrecomputedAttributeDatabase* _Nullable precomputedAttributeDatabase =
+            accessory->precomputedAttributeDatabase;
+    if (o && precomputedAttributeDatabase && precomputedAttributeDatabase->ble.gattElementIndices &&
+        precomputedAttributeDatabase->ble.numGATTHandles <= UINT16_MAX) {
+        // Use the precomputed GATT layout if the assigned attribute handles match it.
+        HAPPlatformBLEPeripheralManagerAttributeHandle firstHandle = GetFirstAttributeHandle(&gattAttributes[0]);
+        if (MatchesGATTLayout(
+                    gattAttributes,
+                    o,
+                    firstHandle,
+                    HAPNonnull(precomputedAttributeDatabase->ble.gattElementIndices),
+                    precomputedAttributeDatabase->ble.numGATTHandles)) {
+            server->ble.gattTable.firstHandle = firstHandle;
+            server->ble.gattTable.elementIndices = precomputedAttributeDatabase->ble.gattElementIndices;
+            server->ble.gattTable.numElementIndices = (uint16_t) precomputedAttributeDatabase->ble.numGATTHandles;
+        } else {
+            HAPLog(&logObject, "Attribute handles do not match the precomputed GATT layout. Using lookup buckets.");
+        }
+    }
+    if (server->ble.gattTable.elementIndices) {
+        HAPLogDebug(&logObject, "Using precomputed GATT layout.");
+    } else if (isAscending) {
+        HAPPlatformBLEPeripheralManagerAttributeHandle firstHandle = GetFirstAttributeHandle(&gattAttributes[0]);
+        size_t numHandles = (size_t)(lastHandle - firstHandle) + 1;
+        size_t numHandlesPerBucket = (numHandles + o - 1) / o;
+        server->ble.gattTable.firstHandle = firstHandle;
+        server->ble.gattTable.numHandlesPerBucket = (uint16_t) numHandlesPerBucket;
+
+        // Bucket k starts at the first GATT attribute structure whose highest attribute handle is in or after it.
+        size_t i = 0;
+        for (size_t bucket = 0; bucket < o; bucket++) {
+            size_t bucketHandle = firstHandle + bucket * numHandlesPerBucket;
+            while (i < o && GetLastAttributeHandle(&gattAttributes[i]) < bucketHandle) {
+                i++;
+            }
+            gattAttributes[bucket].bucketElementIndex = (uint16_t) i;
+        }
+    } else if (o) {
+        HAPLog(&logObject, "Attribute handles have not been assigned in ascending order. Using linear lookup.");
+    }
+
     // Finalize GATT database.
     HAPPlatformBLEPeripheralManagerPublishServices(blePeripheralManager);
 }
@@ -1655,7 +1925,9 @@ void HAPBLEPeripheralManagerRaiseEvent(
         if (gattAttribute->characteristic == characteristic && gattAttribute->service == service &&
             gattAttribute->accessory == accessory) {
             HAPLogCharacteristicInfo(&logObject, characteristic, service, accessory, "Scheduling event.");
-            gattAttribute->connectionState.pendingEvent = true;
+            if (!gattAttribute->connectionState.pendingEvent) {
+                EnqueuePendingEvent(server_, gattAttribute);
+            }
             SendPendingEventNotifications(server_);
             return;
         }
@@ -278,7 +278,16 @@ static HAPError HAPBLEProcedureProcessTransaction(HAPBLEProcedureRef* bleProcedu
             DestroyRequestBodyAndCreateResponseBodyWriter(bleProcedure_, &writer);
 
             // Serialize HAP-Service-Signature-Read-Response.
-            err = HAPBLEServiceGetSignatureReadResponse(request.iid == iid ? service : NULL, &writer);
+            const HAPPrecomputedService* _Nullable precomputedService =
+                    request.iid == iid ? HAPAccessoryGetPrecomputedService(
+                                                 accessory, service, kHAPPrecomputedAttributeDatabase_UnknownIndex) :
+                                         NULL;
+            if (precomputedService) {
+                err = HAPTLVWriterAppendEncodedItems(
+                        &writer, precomputedService->ble.signatureBytes, precomputedService->ble.numSignatureBytes);
+            } else {
+                err = HAPBLEServiceGetSignatureReadResponse(request.iid == iid ? service : NULL, &writer);
+            }
             if (err) {
                 HAPAssert(err == kHAPError_OutOfResources);
                 SEND_ERROR_AND_RETURN(kHAPBLEPDUStatus_InvalidRequest);
@@ -326,7 +335,22 @@ static HAPError HAPBLEProcedureProcessTransaction(HAPBLEProcedureRef* bleProcedu
             DestroyRequestBodyAndCreateResponseBodyWriter(bleProcedure_, &writer);
 
             // Serialize HAP-Characteristic-Signature-Read-Response.
-            err = HAPBLECharacteristicGetSignatureReadResponse(characteristic, service, &writer);
+            const HAPPrecomputedService* _Nullable precomputedService =
+                    HAPAccessoryGetPrecomputedService(accessory, service, kHAPPrecomputedAttributeDatabase_UnknownIndex);
+            const HAPPrecomputedCharacteristic* _Nullable precomputedCharacteristic =
+                    precomputedService ? HAPPrecomputedServiceGetCharacteristic(
+                                                 HAPNonnull(precomputedService),
+                                                 characteristic,
+                                                 kHAPPrecomputedAttributeDatabase_UnknownIndex) :
+                                         NULL;
+            if (precomputedCharacteristic) {
+                err = HAPTLVWriterAppendEncodedItems(
+                        &writer,
+                        precomputedCharacteristic->ble.signatureBytes,
+                        precomputedCharacteristic->ble.numSignatureBytes);
+            } else {
+                err = HAPBLECharacteristicGetSignatureReadResponse(characteristic, service, &writer);
+            }
             if (err) {
                 HAPAssert(err == kHAPError_OutOfResources);
                 SEND_ERROR_AND_RETURN(kHAPBLEPDUStatus_InvalidRequest);
@@ -374,7 +398,7 @@ static HAPError HAPBLEProcedureProcessTransaction(HAPBLEProcedureRef* bleProcedu
 
             // Handle HAP-Characteristic-Configuration-Request.
             err = HAPBLECharacteristicHandleConfigurationRequest(
-                    characteristic, service, accessory, &request.bodyReader, server->platform.keyValueStore);
+                    bleProcedure->server, characteristic, service, accessory, &request.bodyReader);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown || err == kHAPError_InvalidData);
                 HAPLogCharacteristic(
@@ -394,7 +418,7 @@ static HAPError HAPBLEProcedureProcessTransaction(HAPBLEProcedureRef* bleProcedu
 
             // Serialize HAP-Characteristic-Configuration-Response.
             err = HAPBLECharacteristicGetConfigurationResponse(
-                    characteristic, service, accessory, &writer, server->platform.keyValueStore);
+                    bleProcedure->server, characteristic, service, accessory, &writer);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
                 SEND_ERROR_AND_RETURN(kHAPBLEPDUStatus_InvalidRequest);
@@ -719,7 +743,7 @@ static HAPError HAPBLEProcedureProcessTransaction(HAPBLEProcedureRef* bleProcedu
             // The accessory must start the TTL timer after sending the HAP-Characteristic-Timed-Write-Response.
             // See HomeKit Accessory Protocol Specification R14
             // Section 7.3.5.4 HAP Characteristic Timed Write Procedure
-            bleProcedure->_.timedWrite.timedWriteStartTime = HAPPlatformClockGetCurrent();
+            bleProcedure->_.timedWrite.timedWriteStartTime = HAPPlatformClockGetCurrentCoarse();
             SEND_RESPONSE_AND_RETURN(NULL);
         }
         case kHAPPDUOpcode_CharacteristicExecuteWrite: {
@@ -1122,7 +1146,7 @@ HAPError HAPBLEProcedureHandleGATTWrite(HAPBLEProcedureRef* bleProcedure_, void*
 #if !DEBUG_DISABLE_TIMEOUTS
         err = HAPPlatformTimerRegister(
                 &bleProcedure->procedureTimer,
-                HAPPlatformClockGetCurrent() + 10 * HAPSecond,
+                HAPPlatformClockGetCurrentCoarse() + 10 * HAPSecond,
                 ProcedureTimerExpired,
                 bleProcedure);
         if (err) {
@@ -1155,13 +1179,22 @@ HAPError HAPBLEProcedureHandleGATTWrite(HAPBLEProcedureRef* bleProcedure_, void*
                     "Secure request too short, auth tag not present.");
             return kHAPError_InvalidData;
         }
-        err = HAPSessionDecryptControlMessage(bleProcedure->server, bleProcedure->session, bytes, bytes, numBytes);
+
+        // Continuation fragments are decrypted directly into the combined request body when possible.
+        void* _Nullable plaintextBytes =
+                HAPBLETransactionGetWriteBuffer(&bleProcedure->transaction, numBytes - CHACHA20_POLY1305_TAG_BYTES);
+        if (!plaintextBytes) {
+            plaintextBytes = bytes;
+        }
+        err = HAPSessionDecryptControlMessage(
+                bleProcedure->server, bleProcedure->session, HAPNonnullVoid(plaintextBytes), bytes, numBytes);
         if (err) {
             // Decryption failed.
             HAPAssert(err == kHAPError_InvalidState || err == kHAPError_InvalidData);
             return err;
         }
 
+        bytes = HAPNonnullVoid(plaintextBytes);
         numBytes -= CHACHA20_POLY1305_TAG_BYTES;
     }
 
@@ -1279,8 +1312,11 @@ HAPError HAPBLEProcedureHandleGATTRead(
     }
 
     // Prepare next response fragment.
+    // Continuation fragments are assembled in the response body buffer and encrypted from there when possible.
     bool isFinalFragment;
-    err = HAPBLETransactionHandleRead(&bleProcedure->transaction, bytes, maxBytes, numBytes, &isFinalFragment);
+    const void* fragmentBytes;
+    err = HAPBLETransactionHandleReadInPlace(
+            &bleProcedure->transaction, bytes, maxBytes, &fragmentBytes, numBytes, &isFinalFragment);
     if (err) {
         HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
         return err;
@@ -1291,14 +1327,15 @@ HAPError HAPBLEProcedureHandleGATTRead(
             characteristic,
             service,
             accessory,
-            bytes,
+            fragmentBytes,
             *numBytes,
             "> (%s)",
             bleProcedure->startedSecured ? "encrypted" : "plaintext");
 
     // Encrypt if secured.
     if (bleProcedure->startedSecured) {
-        err = HAPSessionEncryptControlMessage(bleProcedure->server, bleProcedure->session, bytes, bytes, *numBytes);
+        err = HAPSessionEncryptControlMessage(
+                bleProcedure->server, bleProcedure->session, bytes, fragmentBytes, *numBytes);
         if (err) {
             // Encryption failed.
             HAPAssert(err == kHAPError_InvalidState);
@@ -1306,6 +1343,8 @@ HAPError HAPBLEProcedureHandleGATTRead(
         }
 
         *numBytes += CHACHA20_POLY1305_TAG_BYTES;
+    } else if (fragmentBytes != bytes) {
+        HAPRawBufferCopyBytes(bytes, fragmentBytes, *numBytes);
     }
 
     // If all fragments have been sent, complete the transaction.
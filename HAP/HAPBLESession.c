@@ -89,7 +89,7 @@ void HAPBLESessionCreate(HAPAccessoryServerRef* server, HAPSessionRef* session_)
 // See HomeKit Accessory Protocol Specification R14
 // Section 7.5 Testing Bluetooth LE Accessories
 #if !DEBUG_DISABLE_TIMEOUTS
-    bleSession->linkTimerDeadline = HAPPlatformClockGetCurrent() + 10 * HAPSecond;
+    bleSession->linkTimerDeadline = HAPPlatformClockGetCurrentCoarse() + 10 * HAPSecond;
     err = HAPPlatformTimerRegister(
             &bleSession->linkTimer, bleSession->linkTimerDeadline, LinkTimerOrPairingProcedureTimerExpired, bleSession);
     if (err) {
@@ -158,7 +158,7 @@ bool HAPBLESessionIsTerminalSoon(const HAPBLESession* bleSession) {
     }
 
     if (bleSession->linkTimer) {
-        HAPTime now = HAPPlatformClockGetCurrent();
+        HAPTime now = HAPPlatformClockGetCurrentCoarse();
         return bleSession->linkTimerDeadline < now || now - bleSession->linkTimerDeadline <= 200 * HAPMillisecond;
     }
 
@@ -198,7 +198,7 @@ void HAPBLESessionDidSendGATTResponse(HAPAccessoryServerRef* server, HAPSessionR
     }
     err = HAPPlatformTimerRegister(
             &bleSession->safeToDisconnectTimer,
-            HAPPlatformClockGetCurrent() + kHAPBLESession_SafeToDisconnectTimeout,
+            HAPPlatformClockGetCurrentCoarse() + kHAPBLESession_SafeToDisconnectTimeout,
             SafeToDisconnectTimerExpired,
             bleSession);
     if (err) {
@@ -249,7 +249,7 @@ void HAPBLESessionDidStartBLEProcedure(HAPAccessoryServerRef* server, HAPSession
             bleSession->linkTimer = 0;
             bleSession->linkTimerDeadline = 0;
         }
-        bleSession->linkTimerDeadline = HAPPlatformClockGetCurrent() + 30 * HAPSecond;
+        bleSession->linkTimerDeadline = HAPPlatformClockGetCurrentCoarse() + 30 * HAPSecond;
         err = HAPPlatformTimerRegister(
                 &bleSession->linkTimer,
                 bleSession->linkTimerDeadline,
@@ -293,7 +293,7 @@ void HAPBLESessionDidStartPairingProcedure(
 #if !DEBUG_DISABLE_TIMEOUTS
         err = HAPPlatformTimerRegister(
                 &bleSession->pairingProcedureTimer,
-                HAPPlatformClockGetCurrent() + 10 * HAPSecond,
+                HAPPlatformClockGetCurrentCoarse() + 10 * HAPSecond,
                 LinkTimerOrPairingProcedureTimerExpired,
                 bleSession);
         if (err) {
@@ -339,7 +339,7 @@ void HAPBLESessionDidCompletePairingProcedure(
             bleSession->linkTimer = 0;
             bleSession->linkTimerDeadline = 0;
         }
-        bleSession->linkTimerDeadline = HAPPlatformClockGetCurrent() + 30 * HAPSecond;
+        bleSession->linkTimerDeadline = HAPPlatformClockGetCurrentCoarse() + 30 * HAPSecond;
         err = HAPPlatformTimerRegister(
                 &bleSession->linkTimer,
                 bleSession->linkTimerDeadline,
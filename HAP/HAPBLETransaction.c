@@ -42,11 +42,67 @@ static void TryAppendBodyFragment(
     } else if (fragmentBytes) {
         HAPAssert(bleTransaction->_.request.bodyBytes);
         uint8_t* bodyBytes = bleTransaction->_.request.bodyBytes;
-        HAPRawBufferCopyBytes(&bodyBytes[bleTransaction->_.request.bodyOffset], fragmentBytes, numFragmentBytes);
+        if (fragmentBytes != &bodyBytes[bleTransaction->_.request.bodyOffset]) {
+            HAPRawBufferCopyBytes(&bodyBytes[bleTransaction->_.request.bodyOffset], fragmentBytes, numFragmentBytes);
+        }
     }
     bleTransaction->_.request.bodyOffset += numFragmentBytes;
 }
 
+/**
+ * Restores the combined body bytes that have been overlapped by the header of a fragment that was placed
+ * in the combined body.
+ *
+ * @param      bleTransaction       Transaction.
+ */
+static void RestoreOverlappedBodyBytes(HAPBLETransaction* bleTransaction) {
+    HAPPrecondition(bleTransaction);
+
+    if (!bleTransaction->_.request.hasOverlappedBodyBytes) {
+        return;
+    }
+    HAPAssert(bleTransaction->_.request.bodyBytes);
+    uint8_t* bodyBytes = bleTransaction->_.request.bodyBytes;
+    size_t numOverlappedBytes = sizeof bleTransaction->_.request.overlappedBodyBytes;
+    HAPAssert(bleTransaction->_.request.bodyOffset >= numOverlappedBytes);
+    HAPRawBufferCopyBytes(
+            &bodyBytes[bleTransaction->_.request.bodyOffset - numOverlappedBytes],
+            bleTransaction->_.request.overlappedBodyBytes,
+            numOverlappedBytes);
+    bleTransaction->_.request.hasOverlappedBodyBytes = false;
+}
+
+HAP_RESULT_USE_CHECK
+void* _Nullable HAPBLETransactionGetWriteBuffer(HAPBLETransaction* bleTransaction, size_t numBytes) {
+    HAPPrecondition(bleTransaction);
+
+    // A previously returned buffer may have been abandoned, e.g., because decryption failed.
+    RestoreOverlappedBodyBytes(bleTransaction);
+
+    // Only continuation fragments of a request that is being stored can be placed in the combined body.
+    if (bleTransaction->state != kHAPBLETransactionState_ReadingRequest || !bleTransaction->_.request.bodyBytes ||
+        bleTransaction->_.request.totalBodyBytes > bleTransaction->_.request.maxBodyBytes) {
+        return NULL;
+    }
+
+    // The fragment header overlaps the end of the previously received body.
+    // The fragment body must not extend beyond the combined body.
+    size_t numHeaderBytes = kHAPBLEPDU_NumContinuationHeaderBytes;
+    size_t bodyOffset = bleTransaction->_.request.bodyOffset;
+    if (bodyOffset < numHeaderBytes || numBytes < numHeaderBytes ||
+        numBytes - numHeaderBytes > bleTransaction->_.request.totalBodyBytes - bodyOffset) {
+        return NULL;
+    }
+
+    uint8_t* bodyBytes = bleTransaction->_.request.bodyBytes;
+    HAPRawBufferCopyBytes(
+            bleTransaction->_.request.overlappedBodyBytes,
+            &bodyBytes[bodyOffset - numHeaderBytes],
+            sizeof bleTransaction->_.request.overlappedBodyBytes);
+    bleTransaction->_.request.hasOverlappedBodyBytes = true;
+    return &bodyBytes[bodyOffset - numHeaderBytes];
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPBLETransactionHandleWrite(HAPBLETransaction* bleTransaction, const void* bytes, size_t numBytes) {
     HAPPrecondition(bleTransaction);
@@ -97,6 +153,9 @@ HAPError HAPBLETransactionHandleWrite(HAPBLETransaction* bleTransaction, const v
                     kHAPBLEPDUType_Request,
                     bleTransaction->_.request.totalBodyBytes,
                     bleTransaction->_.request.bodyOffset);
+
+            // If the fragment has been placed in the combined body, its header has been parsed and may be replaced.
+            RestoreOverlappedBodyBytes(bleTransaction);
             if (err) {
                 HAPAssert(err == kHAPError_InvalidData);
                 return err;
@@ -221,6 +280,35 @@ HAPError HAPBLETransactionHandleRead(
 
     HAPError err;
 
+    const void* fragmentBytes;
+    err = HAPBLETransactionHandleReadInPlace(
+            bleTransaction, bytes, maxBytes, &fragmentBytes, numBytes, isFinalFragment);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
+    }
+    if (fragmentBytes != bytes) {
+        HAPRawBufferCopyBytes(bytes, fragmentBytes, *numBytes);
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLETransactionHandleReadInPlace(
+        HAPBLETransaction* bleTransaction,
+        void* bytes,
+        size_t maxBytes,
+        const void* _Nonnull* _Nonnull fragmentBytes,
+        size_t* numBytes,
+        bool* isFinalFragment) {
+    HAPPrecondition(bleTransaction);
+    HAPPrecondition(bytes);
+    HAPPrecondition(fragmentBytes);
+    HAPPrecondition(numBytes);
+    HAPPrecondition(isFinalFragment);
+
+    HAPError err;
+
     switch (bleTransaction->state) {
         case kHAPBLETransactionState_WaitingForInitialRead: {
             bleTransaction->state = kHAPBLETransactionState_WritingResponse;
@@ -259,6 +347,7 @@ HAPError HAPBLETransactionHandleRead(
                 HAPAssert(err == kHAPError_OutOfResources);
                 return err;
             }
+            *fragmentBytes = bytes;
 
             // Advance buffer.
             bleTransaction->_.response.bodyOffset += numFragmentBytes;
@@ -293,10 +382,21 @@ HAPError HAPBLETransactionHandleRead(
             pdu.body.bytes = (uint8_t*) bleTransaction->_.response.bodyBytes + bleTransaction->_.response.bodyOffset;
             pdu.body.numBytes = (uint16_t) numFragmentBytes;
 
-            err = HAPBLEPDUSerialize(&pdu, bytes, maxBytes, numBytes);
-            if (err) {
-                HAPAssert(err == kHAPError_OutOfResources);
-                return err;
+            // If possible, the header is written over the end of the part of the body that has already been sent,
+            // so that the fragment is contiguous in the body buffer and its body does not need to be copied.
+            if (bleTransaction->_.response.bodyOffset >= numHeaderBytes) {
+                uint8_t* b = (uint8_t*) bleTransaction->_.response.bodyBytes + bleTransaction->_.response.bodyOffset -
+                             numHeaderBytes;
+                err = HAPBLEPDUSerialize(&pdu, b, numHeaderBytes + numFragmentBytes, numBytes);
+                HAPAssert(!err);
+                *fragmentBytes = b;
+            } else {
+                err = HAPBLEPDUSerialize(&pdu, bytes, maxBytes, numBytes);
+                if (err) {
+                    HAPAssert(err == kHAPError_OutOfResources);
+                    return err;
+                }
+                *fragmentBytes = bytes;
             }
 
             // Advance buffer.
@@ -58,6 +58,10 @@ typedef struct {
             uint8_t tid;         /**< TID. Transaction Identifier. */
             uint16_t iid;        /**< CID. Characteristic / service instance ID. */
 
+            /** Combined body bytes that are overlapped by the header of a fragment that is placed in the body. */
+            uint8_t overlappedBodyBytes[kHAPBLEPDU_NumContinuationHeaderBytes];
+            bool hasOverlappedBodyBytes; /**< Whether overlappedBodyBytes must be restored. */
+
             void* _Nullable bodyBytes; /**< Combined body. */
             size_t maxBodyBytes;       /**< Combined body capacity. */
             size_t totalBodyBytes;     /**< Combined body length. */
@@ -103,6 +107,24 @@ void HAPBLETransactionCreate(HAPBLETransaction* bleTransaction, void* _Nullable
 HAP_RESULT_USE_CHECK
 HAPError HAPBLETransactionHandleWrite(HAPBLETransaction* bleTransaction, const void* bytes, size_t numBytes);
 
+/**
+ * Returns a buffer into which the next request fragment may be placed, e.g., by decrypting it, so that its body
+ * already is at its final location in the combined body and #HAPBLETransactionHandleWrite does not need to copy it.
+ *
+ * - Only continuation fragments of requests that fit into the body buffer can be placed in the combined body.
+ *   The fragment header overlaps the end of the previously received body. The overlapped bytes are saved and
+ *   restored by the next call to #HAPBLETransactionHandleWrite.
+ *
+ * - If NULL is returned, the fragment must be passed to #HAPBLETransactionHandleWrite in a separate buffer.
+ *
+ * @param      bleTransaction       Transaction.
+ * @param      numBytes             Length of the fragment.
+ *
+ * @return Buffer of length @p numBytes to place the fragment into, if available. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+void* _Nullable HAPBLETransactionGetWriteBuffer(HAPBLETransaction* bleTransaction, size_t numBytes);
+
 /**
  * Returns whether a complete request has been received and is ready to be fetched with #HAPBLETransactionGetRequest.
  *
@@ -185,6 +207,32 @@ HAPError HAPBLETransactionHandleRead(
         size_t* numBytes,
         bool* isFinalFragment);
 
+/**
+ * Prepares the next response fragment to be sent without copying its body where possible.
+ *
+ * - Continuation fragments are assembled in the response body buffer: the fragment header is written over the end
+ *   of the part of the body that has already been sent. Other fragments are serialized into @p bytes.
+ *
+ * @param      bleTransaction       Transaction.
+ * @param      bytes                Buffer to put fragment data into if it cannot be assembled in place.
+ * @param      maxBytes             Maximum length of a fragment.
+ * @param[out] fragmentBytes        Fragment. Points either into @p bytes or into the response body buffer.
+ * @param[out] numBytes             Length of fragment.
+ * @param[out] isFinalFragment      true If all data fragments have been produced; false Otherwise.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the request cannot be processed in the current state.
+ * @return kHAPError_OutOfResources If buffer not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLETransactionHandleReadInPlace(
+        HAPBLETransaction* bleTransaction,
+        void* bytes,
+        size_t maxBytes,
+        const void* _Nonnull* _Nonnull fragmentBytes,
+        size_t* numBytes,
+        bool* isFinalFragment);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -265,6 +265,13 @@ HAPError HAPBoolCharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = cachedValue.boolValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -315,8 +322,10 @@ HAPError HAPBoolCharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -330,6 +339,12 @@ HAPError HAPBoolCharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.boolValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -379,6 +394,30 @@ void HAPBoolCharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateBoolValue(
+        HAPAccessoryServerRef* server,
+        const HAPBoolCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        bool value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_Bool);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPBoolCharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.boolValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -474,6 +513,13 @@ HAPError HAPUInt8CharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = (uint8_t) cachedValue.unsignedIntValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -524,8 +570,10 @@ HAPError HAPUInt8CharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -539,6 +587,12 @@ HAPError HAPUInt8CharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.unsignedIntValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -588,6 +642,30 @@ void HAPUInt8CharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt8Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt8Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint8_t value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_UInt8);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPUInt8CharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.unsignedIntValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -630,6 +708,13 @@ HAPError HAPUInt16CharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = (uint16_t) cachedValue.unsignedIntValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -680,8 +765,10 @@ HAPError HAPUInt16CharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -695,6 +782,12 @@ HAPError HAPUInt16CharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.unsignedIntValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -744,6 +837,30 @@ void HAPUInt16CharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt16Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt16Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint16_t value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_UInt16);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPUInt16CharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.unsignedIntValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -786,6 +903,13 @@ HAPError HAPUInt32CharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = (uint32_t) cachedValue.unsignedIntValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -836,8 +960,10 @@ HAPError HAPUInt32CharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -851,6 +977,12 @@ HAPError HAPUInt32CharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.unsignedIntValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -900,6 +1032,30 @@ void HAPUInt32CharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt32Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt32Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint32_t value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_UInt32);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPUInt32CharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.unsignedIntValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -942,6 +1098,13 @@ HAPError HAPUInt64CharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = cachedValue.unsignedIntValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -992,8 +1155,10 @@ HAPError HAPUInt64CharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -1007,6 +1172,12 @@ HAPError HAPUInt64CharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.unsignedIntValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -1056,6 +1227,30 @@ void HAPUInt64CharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateUInt64Value(
+        HAPAccessoryServerRef* server,
+        const HAPUInt64Characteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        uint64_t value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_UInt64);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPUInt64CharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.unsignedIntValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -1098,6 +1293,13 @@ HAPError HAPIntCharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = cachedValue.intValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -1148,8 +1350,10 @@ HAPError HAPIntCharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -1163,6 +1367,12 @@ HAPError HAPIntCharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.intValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -1212,6 +1422,30 @@ void HAPIntCharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateIntValue(
+        HAPAccessoryServerRef* server,
+        const HAPIntCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        int32_t value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_Int);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPIntCharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.intValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
@@ -1310,6 +1544,13 @@ HAPError HAPFloatCharacteristicHandleRead(
 
     HAPError err;
 
+    // Serve published value.
+    HAPCharacteristicValueCacheValue cachedValue;
+    if (HAPCharacteristicValueCacheGetValue(server, request->characteristic, request->accessory, &cachedValue)) {
+        *value = cachedValue.floatValue;
+        return kHAPError_None;
+    }
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling read handler.");
@@ -1366,8 +1607,10 @@ HAPError HAPFloatCharacteristicHandleWrite(
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
+    HAPCharacteristicValueCacheWillWrite(server, request->characteristic, request->accessory);
     err = request->characteristic->callbacks.handleWrite(server, request, value, context);
     if (err) {
+        HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, NULL);
         HAPAssert(
                 err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_InvalidData ||
                 err == kHAPError_OutOfResources || err == kHAPError_NotAuthorized || err == kHAPError_Busy);
@@ -1381,6 +1624,12 @@ HAPError HAPFloatCharacteristicHandleWrite(
         return err;
     }
 
+    // Update published value.
+    HAPCharacteristicValueCacheValue writtenValue;
+    HAPRawBufferZero(&writtenValue, sizeof writtenValue);
+    writtenValue.floatValue = value;
+    HAPCharacteristicValueCacheDidWrite(server, request->characteristic, request->accessory, &writtenValue);
+
     return kHAPError_None;
 }
 
@@ -1430,6 +1679,33 @@ void HAPFloatCharacteristicHandleUnsubscribe(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateFloatValue(
+        HAPAccessoryServerRef* server,
+        const HAPFloatCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        float value) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format == kHAPCharacteristicFormat_Float);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    // Validate constraints.
+    if (!HAPFloatCharacteristicIsValueFulfillingConstraints(characteristic, service, accessory, value)) {
+        return kHAPError_InvalidData;
+    }
+
+    // Round to step.
+    value = HAPFloatCharacteristicRoundValueToStep(characteristic, value);
+
+    HAPCharacteristicValueCacheValue publishedValue;
+    HAPRawBufferZero(&publishedValue, sizeof publishedValue);
+    publishedValue.floatValue = value;
+    return HAPCharacteristicValueCacheUpdateValue(server, characteristic, service, accessory, &publishedValue);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HAP_RESULT_USE_CHECK
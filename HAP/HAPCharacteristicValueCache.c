@@ -0,0 +1,579 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "CharacteristicValueCache" };
+
+/**
+ * Entry of the characteristic value cache.
+ *
+ * - Entries are stored in an open addressing hash table with linear probing, keyed by accessory ID and
+ *   characteristic. Unused entries have a NULL characteristic.
+ */
+typedef struct {
+    /** Characteristic. NULL if the entry is unused. */
+    const HAPCharacteristic* _Nullable characteristic;
+
+    /** The service that contains the characteristic. */
+    const HAPService* _Nullable service;
+
+    /** The accessory that provides the service. */
+    const HAPAccessory* _Nullable accessory;
+
+    /** Published value. */
+    HAPCharacteristicValueCacheValue value;
+
+    /** Value of the most recent event notification. */
+    HAPCharacteristicValueCacheValue notifiedValue;
+
+    /** Time of the most recent event notification. */
+    HAPTime notifiedTime;
+
+    /** Time when a deferred event notification is due. 0 if no event notification is deferred. */
+    HAPTime flushTime;
+} HAPCharacteristicValueCacheEntry;
+HAP_STATIC_ASSERT(
+        sizeof(HAPCharacteristicValueCacheEntryRef) >= sizeof(HAPCharacteristicValueCacheEntry),
+        HAPCharacteristicValueCacheEntry);
+
+/**
+ * Returns whether values of a characteristic format may be cached.
+ *
+ * @param      format               Characteristic format.
+ *
+ * @return true                     If values of the format may be cached.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsFormatSupported(HAPCharacteristicFormat format) {
+    switch (format) {
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64:
+        case kHAPCharacteristicFormat_Int:
+        case kHAPCharacteristicFormat_Float: {
+            return true;
+        }
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String:
+        case kHAPCharacteristicFormat_TLV8: {
+            return false;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Returns the preferred index of an entry in the hash table.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      aid                  Accessory ID.
+ *
+ * @return Preferred index.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetHomeIndex(const HAPAccessoryServer* server, const HAPCharacteristic* characteristic, uint64_t aid) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->valueCache.numEntries);
+    HAPPrecondition(characteristic);
+
+    // Characteristic structures are spaced apart in memory, so the address is mixed before reducing it.
+    uint64_t hash = (uint64_t)(uintptr_t) characteristic ^ (aid * 0x9E3779B97F4A7C15);
+    hash ^= hash >> 31;
+    hash *= 0xBF58476D1CE4E5B9;
+    hash ^= hash >> 29;
+    return (size_t)(hash % server->valueCache.numEntries);
+}
+
+/**
+ * Looks up the entry of a characteristic.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      aid                  Accessory ID.
+ * @param[out] index                Index of the entry if found. Otherwise, index of the unused entry that terminated
+ *                                  the search, or numEntries if the cache is full.
+ *
+ * @return Entry of the characteristic if found. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPCharacteristicValueCacheEntry* _Nullable FindEntry(
+        HAPAccessoryServer* server,
+        const HAPCharacteristic* characteristic,
+        uint64_t aid,
+        size_t* index) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(index);
+
+    HAPCharacteristicValueCacheEntry* entries = (HAPCharacteristicValueCacheEntry*) server->valueCache.entries;
+    size_t numEntries = server->valueCache.numEntries;
+    if (!numEntries) {
+        *index = 0;
+        return NULL;
+    }
+
+    size_t i = GetHomeIndex(server, characteristic, aid);
+    for (size_t n = 0; n < numEntries; n++) {
+        HAPCharacteristicValueCacheEntry* entry = &entries[i];
+        if (!entry->characteristic) {
+            *index = i;
+            return NULL;
+        }
+        if (entry->characteristic == characteristic && HAPNonnull(entry->accessory)->aid == aid) {
+            *index = i;
+            return entry;
+        }
+        i = (i + 1) % numEntries;
+    }
+    *index = numEntries;
+    return NULL;
+}
+
+void HAPCharacteristicValueCacheCreate(
+        HAPAccessoryServerRef* server_,
+        HAPCharacteristicValueCacheEntryRef* _Nullable entries,
+        size_t numEntries) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(!numEntries || entries);
+
+    HAPRawBufferZero(&server->valueCache, sizeof server->valueCache);
+    if (numEntries) {
+        HAPRawBufferZero(HAPNonnull(entries), numEntries * sizeof *entries);
+        server->valueCache.entries = entries;
+        server->valueCache.numEntries = numEntries;
+    }
+    HAPLogDebug(
+            &logObject,
+            "Storage configuration: valueCache = %lu (%lu entries)",
+            (unsigned long) (numEntries * sizeof *entries),
+            (unsigned long) numEntries);
+}
+
+void HAPCharacteristicValueCacheRelease(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    if (server->valueCache.flushTimer) {
+        HAPPlatformTimerDeregister(server->valueCache.flushTimer);
+        server->valueCache.flushTimer = 0;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPCharacteristicValueCacheGetValue(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory,
+        HAPCharacteristicValueCacheValue* value) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    HAPPrecondition(accessory);
+    HAPPrecondition(value);
+
+    size_t index;
+    HAPCharacteristicValueCacheEntry* entry = FindEntry(server, characteristic, accessory->aid, &index);
+    if (!entry) {
+        return false;
+    }
+    *value = entry->value;
+    return true;
+}
+
+/**
+ * Returns the event notification policy of a characteristic.
+ *
+ * @param      characteristic       Characteristic.
+ *
+ * @return Event notification policy of the characteristic, or NULL if the format does not support a policy.
+ */
+HAP_RESULT_USE_CHECK
+static const HAPCharacteristicEventPolicy* _Nullable GetEventPolicy(const HAPCharacteristic* characteristic) {
+    HAPPrecondition(characteristic);
+    const HAPBaseCharacteristic* baseCharacteristic = characteristic;
+
+    switch (baseCharacteristic->format) {
+        case kHAPCharacteristicFormat_UInt8: {
+            return &((const HAPUInt8Characteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_UInt16: {
+            return &((const HAPUInt16Characteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_UInt32: {
+            return &((const HAPUInt32Characteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_UInt64: {
+            return &((const HAPUInt64Characteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_Int: {
+            return &((const HAPIntCharacteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_Float: {
+            return &((const HAPFloatCharacteristic*) characteristic)->eventPolicy;
+        }
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String:
+        case kHAPCharacteristicFormat_TLV8: {
+            return NULL;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Checks whether a change exceeds the deadbands of an event policy.
+ *
+ * @param      policy               Event policy.
+ * @param      change               Absolute change since the last notified value.
+ * @param      reference            Absolute last notified value.
+ *
+ * @return true                     If the change is not within either deadband.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsOutsideDeadband(const HAPCharacteristicEventPolicy* policy, float change, float reference) {
+    HAPPrecondition(policy);
+
+    if (change < policy->absoluteDeadband || change < policy->relativeDeadband * reference) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns whether the published value of an entry differs from the value of the most recent event notification
+ * by at least the deadbands of the event notification policy.
+ *
+ * @param      entry                Entry.
+ * @param      policy               Event notification policy. NULL if the format does not support a policy.
+ *
+ * @return true                     If the change is significant.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsSignificantChange(
+        const HAPCharacteristicValueCacheEntry* entry,
+        const HAPCharacteristicEventPolicy* _Nullable policy) {
+    HAPPrecondition(entry);
+    HAPPrecondition(entry->characteristic);
+    const HAPBaseCharacteristic* baseCharacteristic = entry->characteristic;
+
+    if (HAPRawBufferAreEqual(&entry->value, &entry->notifiedValue, sizeof entry->value)) {
+        return false;
+    }
+    if (!policy || (HAPFloatIsZero(policy->absoluteDeadband) && HAPFloatIsZero(policy->relativeDeadband))) {
+        return true;
+    }
+
+    switch (baseCharacteristic->format) {
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64: {
+            uint64_t value = entry->value.unsignedIntValue;
+            uint64_t notifiedValue = entry->notifiedValue.unsignedIntValue;
+            return IsOutsideDeadband(
+                    policy,
+                    (float) (value > notifiedValue ? value - notifiedValue : notifiedValue - value),
+                    (float) notifiedValue);
+        }
+        case kHAPCharacteristicFormat_Int: {
+            int64_t difference = (int64_t) entry->value.intValue - entry->notifiedValue.intValue;
+            return IsOutsideDeadband(
+                    policy,
+                    (float) (difference < 0 ? -difference : difference),
+                    HAPFloatGetAbsoluteValue((float) entry->notifiedValue.intValue));
+        }
+        case kHAPCharacteristicFormat_Float: {
+            return IsOutsideDeadband(
+                    policy,
+                    HAPFloatGetAbsoluteValue(entry->value.floatValue - entry->notifiedValue.floatValue),
+                    HAPFloatGetAbsoluteValue(entry->notifiedValue.floatValue));
+        }
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String:
+        case kHAPCharacteristicFormat_TLV8: {
+            HAPFatalError();
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Raises an event notification with the published value of an entry.
+ *
+ * @param      server               Accessory server.
+ * @param      entry                Entry.
+ * @param      now                  Current time.
+ */
+static void RaiseEvent(HAPAccessoryServer* server, HAPCharacteristicValueCacheEntry* entry, HAPTime now) {
+    HAPPrecondition(server);
+    HAPPrecondition(entry);
+
+    entry->notifiedValue = entry->value;
+    entry->notifiedTime = now;
+    entry->flushTime = 0;
+    HAPAccessoryServerRaiseEvent(
+            (HAPAccessoryServerRef*) server,
+            HAPNonnull(entry->characteristic),
+            HAPNonnull(entry->service),
+            HAPNonnull(entry->accessory));
+}
+
+static void ScheduleFlush(HAPAccessoryServer* server, HAPTime flushTime);
+
+static void FlushTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPAccessoryServer* server = context;
+    HAPPrecondition(timer == server->valueCache.flushTimer);
+    server->valueCache.flushTimer = 0;
+
+    HAPCharacteristicValueCacheEntry* entries = (HAPCharacteristicValueCacheEntry*) server->valueCache.entries;
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
+    HAPTime nextFlushTime = 0;
+    for (size_t i = 0; i < server->valueCache.numEntries; i++) {
+        HAPCharacteristicValueCacheEntry* entry = &entries[i];
+        if (!entry->characteristic || !entry->flushTime) {
+            continue;
+        }
+        if (entry->flushTime <= now) {
+            entry->flushTime = 0;
+            if (HAPRawBufferAreEqual(&entry->value, &entry->notifiedValue, sizeof entry->value)) {
+                continue;
+            }
+
+            // Changes that have been held back by the deadbands still respect the minimum interval.
+            const HAPCharacteristicEventPolicy* policy = HAPNonnull(GetEventPolicy(HAPNonnull(entry->characteristic)));
+            if (now - entry->notifiedTime < policy->minimumInterval) {
+                entry->flushTime = entry->notifiedTime + policy->minimumInterval;
+            } else {
+                RaiseEvent(server, entry, now);
+                continue;
+            }
+        }
+        if (!nextFlushTime || entry->flushTime < nextFlushTime) {
+            nextFlushTime = entry->flushTime;
+        }
+    }
+    if (nextFlushTime) {
+        ScheduleFlush(server, nextFlushTime);
+    }
+}
+
+/**
+ * Ensures that the flush timer expires no later than a given time.
+ *
+ * @param      server               Accessory server.
+ * @param      flushTime            Time when a deferred event notification is due.
+ */
+static void ScheduleFlush(HAPAccessoryServer* server, HAPTime flushTime) {
+    HAPPrecondition(server);
+    HAPPrecondition(flushTime);
+
+    HAPError err;
+
+    if (server->valueCache.flushTimer) {
+        if (server->valueCache.flushDeadline <= flushTime) {
+            return;
+        }
+        HAPPlatformTimerDeregister(server->valueCache.flushTimer);
+        server->valueCache.flushTimer = 0;
+    }
+    err = HAPPlatformTimerRegister(&server->valueCache.flushTimer, flushTime, FlushTimerExpired, server);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&logObject, "Not enough resources to allocate characteristic value cache flush timer.");
+        HAPFatalError();
+    }
+    server->valueCache.flushDeadline = flushTime;
+}
+
+/**
+ * Raises or defers an event notification for an entry whose published value has been updated,
+ * according to the event notification policy of the characteristic.
+ *
+ * @param      server               Accessory server.
+ * @param      entry                Entry.
+ */
+static void HandleUpdatedValue(HAPAccessoryServer* server, HAPCharacteristicValueCacheEntry* entry) {
+    HAPPrecondition(server);
+    HAPPrecondition(entry);
+    HAPPrecondition(entry->characteristic);
+    const HAPBaseCharacteristic* baseCharacteristic = entry->characteristic;
+
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
+
+    // Programmable Switch Events are not state changes, so every published value is reported.
+    if (HAPUUIDAreEqual(baseCharacteristic->characteristicType, &kHAPCharacteristicType_ProgrammableSwitchEvent)) {
+        RaiseEvent(server, entry, now);
+        return;
+    }
+
+    const HAPCharacteristicEventPolicy* _Nullable policy = GetEventPolicy(HAPNonnull(entry->characteristic));
+    if (!IsSignificantChange(entry, policy)) {
+        if (HAPRawBufferAreEqual(&entry->value, &entry->notifiedValue, sizeof entry->value)) {
+            entry->flushTime = 0;
+        } else if (policy && policy->maximumLatency && !entry->flushTime) {
+            entry->flushTime = now + policy->maximumLatency;
+            ScheduleFlush(server, entry->flushTime);
+        }
+        return;
+    }
+    if (policy && now - entry->notifiedTime < policy->minimumInterval) {
+        HAPTime flushTime = entry->notifiedTime + policy->minimumInterval;
+        if (!entry->flushTime || flushTime < entry->flushTime) {
+            entry->flushTime = flushTime;
+            ScheduleFlush(server, entry->flushTime);
+        }
+        return;
+    }
+    RaiseEvent(server, entry, now);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPCharacteristicValueCacheUpdateValue(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const HAPCharacteristicValueCacheValue* value) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    const HAPBaseCharacteristic* baseCharacteristic = characteristic;
+    HAPPrecondition(IsFormatSupported(baseCharacteristic->format));
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+    HAPPrecondition(value);
+
+    if (server->valueCache.writeCharacteristic == characteristic && server->valueCache.writeAID == accessory->aid) {
+        server->valueCache.writeValueWasUpdated = true;
+    }
+
+    size_t index;
+    HAPCharacteristicValueCacheEntry* entry = FindEntry(server, characteristic, accessory->aid, &index);
+    if (entry) {
+        entry->value = *value;
+        HandleUpdatedValue(server, entry);
+        return kHAPError_None;
+    }
+    if (index < server->valueCache.numEntries) {
+        entry = &((HAPCharacteristicValueCacheEntry*) server->valueCache.entries)[index];
+        HAPRawBufferZero(entry, sizeof *entry);
+        entry->characteristic = characteristic;
+        entry->service = service;
+        entry->accessory = accessory;
+        entry->value = *value;
+        RaiseEvent(server, entry, HAPPlatformClockGetCurrentCoarse());
+        return kHAPError_None;
+    }
+
+    HAPLogCharacteristic(
+            &logObject,
+            characteristic,
+            service,
+            accessory,
+            "Characteristic value cache is full (%lu entries). Reads call the read handler.",
+            (unsigned long) server->valueCache.numEntries);
+    HAPAccessoryServerRaiseEvent(server_, characteristic, service, accessory);
+    return kHAPError_OutOfResources;
+}
+
+void HAPAccessoryServerInvalidateValue(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    size_t index;
+    HAPCharacteristicValueCacheEntry* entry = FindEntry(server, characteristic, accessory->aid, &index);
+    if (!entry) {
+        return;
+    }
+    HAPLogCharacteristicDebug(&logObject, characteristic, service, accessory, "Invalidating published value.");
+
+    // Backward shift deletion: move subsequent entries of the probe sequence into the gap,
+    // so that lookups do not need tombstones.
+    HAPCharacteristicValueCacheEntry* entries = (HAPCharacteristicValueCacheEntry*) server->valueCache.entries;
+    size_t numEntries = server->valueCache.numEntries;
+    size_t i = index;
+    size_t j = index;
+    for (;;) {
+        entries[i].characteristic = NULL;
+        for (;;) {
+            j = (j + 1) % numEntries;
+            if (!entries[j].characteristic) {
+                return;
+            }
+            size_t k = GetHomeIndex(server, HAPNonnull(entries[j].characteristic), HAPNonnull(entries[j].accessory)->aid);
+            bool isInRange = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+            if (!isInRange) {
+                break;
+            }
+        }
+        entries[i] = entries[j];
+        i = j;
+    }
+}
+
+void HAPCharacteristicValueCacheWillWrite(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    HAPPrecondition(accessory);
+
+    server->valueCache.writeCharacteristic = characteristic;
+    server->valueCache.writeAID = accessory->aid;
+    server->valueCache.writeValueWasUpdated = false;
+}
+
+void HAPCharacteristicValueCacheDidWrite(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory,
+        const HAPCharacteristicValueCacheValue* _Nullable value) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    HAPPrecondition(accessory);
+    HAPPrecondition(server->valueCache.writeCharacteristic == characteristic);
+    HAPPrecondition(server->valueCache.writeAID == accessory->aid);
+
+    bool writeValueWasUpdated = server->valueCache.writeValueWasUpdated;
+    server->valueCache.writeCharacteristic = NULL;
+    server->valueCache.writeAID = 0;
+    server->valueCache.writeValueWasUpdated = false;
+
+    if (!value || writeValueWasUpdated) {
+        return;
+    }
+
+    // Only characteristics that already have a published value are updated. The controller that wrote the value
+    // is not notified, and other controllers are notified by the write handler as in callback mode.
+    size_t index;
+    HAPCharacteristicValueCacheEntry* entry = FindEntry(server, characteristic, accessory->aid, &index);
+    if (entry) {
+        entry->value = *value;
+        entry->notifiedValue = *value;
+        entry->flushTime = 0;
+    }
+}
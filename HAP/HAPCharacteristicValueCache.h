@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_CHARACTERISTIC_VALUE_CACHE_H
+#define HAP_CHARACTERISTIC_VALUE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Cached characteristic value.
+ *
+ * - The member that is used depends on the format of the characteristic. Unused bytes are zero.
+ */
+typedef union {
+    /** Bool. */
+    bool boolValue;
+
+    /** UInt8, UInt16, UInt32, UInt64. */
+    uint64_t unsignedIntValue;
+
+    /** Int. */
+    int32_t intValue;
+
+    /** Float. */
+    float floatValue;
+} HAPCharacteristicValueCacheValue;
+
+/**
+ * Initializes the characteristic value cache of an accessory server.
+ *
+ * @param      server               Accessory server.
+ * @param      entries              Storage for cache entries.
+ * @param      numEntries           Number of cache entries.
+ */
+void HAPCharacteristicValueCacheCreate(
+        HAPAccessoryServerRef* server,
+        HAPCharacteristicValueCacheEntryRef* _Nullable entries,
+        size_t numEntries);
+
+/**
+ * Releases resources of the characteristic value cache of an accessory server.
+ *
+ * - Deferred event notifications are discarded.
+ *
+ * @param      server               Accessory server.
+ */
+void HAPCharacteristicValueCacheRelease(HAPAccessoryServerRef* server);
+
+/**
+ * Looks up the published value of a characteristic.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      accessory            The accessory that provides the characteristic.
+ * @param[out] value                Published value, if found.
+ *
+ * @return true                     If a value has been published for the characteristic.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPCharacteristicValueCacheGetValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory,
+        HAPCharacteristicValueCacheValue* value);
+
+/**
+ * Publishes a value of a characteristic that fulfills the constraints of the characteristic.
+ *
+ * - An event notification is raised if the value changed according to the event notification policy of the
+ *   characteristic, or if the characteristic is a Programmable Switch Event. Event notifications may be deferred.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      value                Value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the cache is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPCharacteristicValueCacheUpdateValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const HAPCharacteristicValueCacheValue* value);
+
+/**
+ * Informs the characteristic value cache that the handleWrite callback of a characteristic is about to be called.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      accessory            The accessory that provides the characteristic.
+ */
+void HAPCharacteristicValueCacheWillWrite(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory);
+
+/**
+ * Informs the characteristic value cache that the handleWrite callback of a characteristic has returned.
+ *
+ * - If the write succeeded, a published value of the characteristic is replaced with the written value,
+ *   unless a value has been published by the handleWrite callback.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      accessory            The accessory that provides the characteristic.
+ * @param      value                Written value, if the write succeeded. NULL otherwise.
+ */
+void HAPCharacteristicValueCacheDidWrite(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory,
+        const HAPCharacteristicValueCacheValue* _Nullable value);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
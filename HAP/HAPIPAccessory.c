@@ -131,6 +131,10 @@ HAP_ENUM_BEGIN(uint8_t, HAPIPAccessorySerializationState) {
     kHAPIPAccessorySerializationState_CharacteristicEventNotifications_Value,
     kHAPIPAccessorySerializationState_CharacteristicEventNotifications_ValueSeparator,
 
+    kHAPIPAccessorySerializationState_CharacteristicPrecomputedMetadata_Value,
+
+    kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin,
+
     kHAPIPAccessorySerializationState_CharacteristicDescription_Name,
     kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator,
     kHAPIPAccessorySerializationState_CharacteristicDescription_Value,
@@ -264,44 +268,55 @@ static const HAPCharacteristic* _Nullable GetCurrentCharacteristic(
     return service->characteristics[context->characteristicIndex];
 }
 
-HAP_RESULT_USE_CHECK
-HAPError HAPIPAccessorySerializeReadResponse(
+/**
+ * Gets the precomputed serializations of the current service in the given serialization context.
+ *
+ * @param      context              Serialization context.
+ * @param      server               Accessory server.
+ *
+ * @return Precomputed service      If the current accessory has a precomputed attribute database covering the service.
+ * @return NULL                     Otherwise.
+ */
+static const HAPPrecomputedService* _Nullable GetCurrentPrecomputedService(
         HAPIPAccessorySerializationContext* context,
-        HAPAccessoryServerRef* server_,
-        HAPIPSessionDescriptorRef* session,
-        char* bytes,
-        size_t minBytes,
-        size_t maxBytes,
-        size_t* numBytes) {
+        HAPAccessoryServerRef* server) {
     HAPPrecondition(context);
-    HAPPrecondition(context->state != kHAPIPAccessorySerializationState_ResponseIsComplete);
-    HAPPrecondition(server_);
-    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
-    HAPPrecondition(server->primaryAccessory);
-    HAPPrecondition(session);
-    HAPPrecondition(bytes);
-    HAPPrecondition(minBytes >= 1);
-    HAPPrecondition(maxBytes >= minBytes);
-    HAPPrecondition(numBytes);
-
-    HAPError err;
-
-    // See HomeKit Accessory Protocol Specification R14
-    // Section 6.3 HAP Objects
-
-    // See HomeKit Accessory Protocol Specification R14
-    // Section 6.6.4 Example Accessory Attribute Database in JSON
+    HAPPrecondition(server);
 
-    // For the JSON Data Interchange Format, see RFC 7159.
-    // http://www.rfc-editor.org/rfc/rfc7159.txt
+    const HAPAccessory* accessory = GetCurrentAcessory(context, server);
+    HAPAssert(accessory);
+    const HAPService* service = GetCurrentService(context, server);
+    HAPAssert(service);
 
-    char scratchBytes[64];
+    return HAPAccessoryGetPrecomputedService(accessory, service, context->serviceIndex);
+}
 
-#define GET_CURRENT_ACCESSORY() GetCurrentAcessory(context, server_)
+/**
+ * Gets the precomputed serializations of the current characteristic in the given serialization context.
+ *
+ * @param      context              Serialization context.
+ * @param      server               Accessory server.
+ *
+ * @return Precomputed characteristic If the current accessory has a precomputed attribute database covering
+ *                                  the characteristic.
+ * @return NULL                     Otherwise.
+ */
+static const HAPPrecomputedCharacteristic* _Nullable GetCurrentPrecomputedCharacteristic(
+        HAPIPAccessorySerializationContext* context,
+        HAPAccessoryServerRef* server) {
+    HAPPrecondition(context);
+    HAPPrecondition(server);
 
-#define GET_CURRENT_SERVICE() GetCurrentService(context, server_)
+    const HAPPrecomputedService* _Nullable precomputedService = GetCurrentPrecomputedService(context, server);
+    if (!precomputedService) {
+        return NULL;
+    }
+    const HAPCharacteristic* characteristic = GetCurrentCharacteristic(context, server);
+    HAPAssert(characteristic);
 
-#define GET_CURRENT_CHARACTERISTIC() ((const HAPBaseCharacteristic*) GetCurrentCharacteristic(context, server_))
+    return HAPPrecomputedServiceGetCharacteristic(
+            HAPNonnull(precomputedService), characteristic, context->characteristicIndex);
+}
 
 #define APPEND_STRING_OR_RETURN_ERROR(string) \
     do { \
@@ -379,105 +394,865 @@ HAPError HAPIPAccessorySerializeReadResponse(
         HAPAssert(*numBytes <= maxBytes); \
     } while (0)
 
-    *numBytes = 0;
+#define APPEND_QUOTED_STRING_OR_RETURN_ERROR(string) \
+    do { \
+        HAPAssert(*numBytes <= maxBytes); \
+        size_t numStringBytes = HAPStringGetNumBytes(string); \
+        if (maxBytes - *numBytes < 2 || maxBytes - *numBytes - 2 < numStringBytes) { \
+            HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response."); \
+            return kHAPError_OutOfResources; \
+        } \
+        bytes[*numBytes] = '"'; \
+        HAPRawBufferCopyBytes(&bytes[*numBytes + 1], string, numStringBytes); \
+        bytes[*numBytes + 1 + numStringBytes] = '"'; \
+        *numBytes += 1 + numStringBytes + 1; \
+        HAPAssert(*numBytes <= maxBytes); \
+    } while (0)
 
-    do {
-        HAPAssert(sizeof context->state == sizeof(HAPIPAccessorySerializationState));
-        switch ((HAPIPAccessorySerializationState) context->state) {
-            case kHAPIPAccessorySerializationState_ResponseObject_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("{");
-                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_Name;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_ResponseObject_End: {
-                APPEND_STRING_OR_RETURN_ERROR("}");
-                context->state = kHAPIPAccessorySerializationState_ResponseIsComplete;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoriesArray_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"accessories\"");
-                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoriesArray_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_Begin;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoriesArray_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("[");
-                context->accessoryIndex = 0;
-                context->state = kHAPIPAccessorySerializationState_AccessoryObject_Begin;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoriesArray_End: {
-                APPEND_STRING_OR_RETURN_ERROR("]");
-                context->state = kHAPIPAccessorySerializationState_ResponseObject_End;
+/**
+ * Serializes the next part of the static members of a characteristic object that follow "perms" and "ev".
+ *
+ * - The serialization starts in state kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin
+ *   and is complete once state kHAPIPAccessorySerializationState_CharacteristicObject_End is reached.
+ *
+ * @param      context              Serialization context.
+ * @param      characteristic_      Characteristic.
+ * @param[out] bytes                Buffer to fill.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[in,out] numBytes          Number of bytes in the buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the supplied buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SerializeCharacteristicMetadata(
+        HAPIPAccessorySerializationContext* context,
+        const HAPCharacteristic* characteristic_,
+        char* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(context);
+    HAPPrecondition(characteristic_);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    char scratchBytes[64];
+
+    HAPAssert(sizeof context->state == sizeof(HAPIPAccessorySerializationState));
+    switch ((HAPIPAccessorySerializationState) context->state) {
+        case kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            if (baseCharacteristic->manufacturerDescription) {
+                APPEND_STRING_OR_RETURN_ERROR(",");
+                context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_Name;
+            } else if (HAPCharacteristicGetUnit(baseCharacteristic) != kHAPCharacteristicUnits_None) {
+                APPEND_STRING_OR_RETURN_ERROR(",");
+                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Name;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryObject_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("{");
-                context->state = kHAPIPAccessorySerializationState_AccessoryID_Name;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicDescription_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"description\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicDescription_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->manufacturerDescription);
+
+            HAPAssert(*numBytes <= maxBytes);
+            if (maxBytes - *numBytes < 2) {
+                HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
+                return kHAPError_OutOfResources;
+            }
+            // Buffer 'bytes' has enough capacity to store at least an empty string including quotation marks.
+
+            const char* manufacturerDescription = HAPNonnull(baseCharacteristic->manufacturerDescription);
+            size_t numManufacturerDescriptionBytes = HAPStringGetNumBytes(manufacturerDescription);
+            if (maxBytes - *numBytes - 2 < numManufacturerDescriptionBytes) {
+                HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
+                return kHAPError_OutOfResources;
+            }
+            HAPRawBufferCopyBytes(&bytes[*numBytes + 1], manufacturerDescription, numManufacturerDescriptionBytes);
+            err = HAPJSONUtilsEscapeStringData(
+                    &bytes[*numBytes + 1], maxBytes - *numBytes - 2, &numManufacturerDescriptionBytes);
+            if (err) {
+                HAPAssert(err == kHAPError_OutOfResources);
+                HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
+                return err;
+            }
+            bytes[*numBytes] = '"';
+            bytes[*numBytes + 1 + numManufacturerDescriptionBytes] = '"';
+            *numBytes += 1 + numManufacturerDescriptionBytes + 1;
+
+            HAPAssert(*numBytes <= maxBytes);
+
+            context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_ValueSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicDescription_ValueSeparator: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            if (HAPCharacteristicGetUnit(baseCharacteristic) != kHAPCharacteristicUnits_None) {
+                APPEND_STRING_OR_RETURN_ERROR(",");
+                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Name;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryObject_End: {
-                APPEND_STRING_OR_RETURN_ERROR("}");
-                HAPAssert(context->accessoryIndex < UINT8_MAX);
-                context->accessoryIndex++;
-                if (context->accessoryIndex == 1) {
-                    if (server->ip.bridgedAccessories && server->ip.bridgedAccessories[0]) {
-                        context->state = kHAPIPAccessorySerializationState_AccessoryObject_Separator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicUnit_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"unit\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicUnit_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicUnit_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            switch (HAPCharacteristicGetUnit(baseCharacteristic)) {
+                case kHAPCharacteristicUnits_None: {
+                }
+                    HAPFatalError();
+                case kHAPCharacteristicUnits_Celsius: {
+                    APPEND_STRING_OR_RETURN_ERROR("\"celsius\"");
+                } break;
+                case kHAPCharacteristicUnits_ArcDegrees: {
+                    APPEND_STRING_OR_RETURN_ERROR("\"arcdegrees\"");
+                } break;
+                case kHAPCharacteristicUnits_Percentage: {
+                    APPEND_STRING_OR_RETURN_ERROR("\"percentage\"");
+                } break;
+                case kHAPCharacteristicUnits_Lux: {
+                    APPEND_STRING_OR_RETURN_ERROR("\"lux\"");
+                } break;
+                case kHAPCharacteristicUnits_Seconds: {
+                    APPEND_STRING_OR_RETURN_ERROR("\"seconds\"");
+                } break;
+            }
+            context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            switch (baseCharacteristic->format) {
+                case kHAPCharacteristicFormat_Bool: {
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_UInt8: {
+                    const HAPUInt8Characteristic* uint8Characteristic =
+                            (const HAPUInt8Characteristic*) baseCharacteristic;
+                    uint8_t minimumValue = uint8Characteristic->constraints.minimumValue;
+                    uint8_t maximumValue = uint8Characteristic->constraints.maximumValue;
+                    uint8_t stepValue = uint8Characteristic->constraints.stepValue;
+                    HAPAssert(minimumValue <= maximumValue);
+                    if (minimumValue || maximumValue != UINT8_MAX || stepValue > 1) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
                     } else {
-                        context->state = kHAPIPAccessorySerializationState_AccessoriesArray_End;
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator;
                     }
-                } else {
-                    HAPAssert(server->ip.bridgedAccessories);
-                    if (server->ip.bridgedAccessories[context->accessoryIndex - 1]) {
-                        context->state = kHAPIPAccessorySerializationState_AccessoryObject_Separator;
+                } break;
+                case kHAPCharacteristicFormat_UInt16: {
+                    const HAPUInt16Characteristic* uint16Characteristic =
+                            (const HAPUInt16Characteristic*) baseCharacteristic;
+                    uint16_t minimumValue = uint16Characteristic->constraints.minimumValue;
+                    uint16_t maximumValue = uint16Characteristic->constraints.maximumValue;
+                    uint16_t stepValue = uint16Characteristic->constraints.stepValue;
+                    HAPAssert(minimumValue <= maximumValue);
+                    if (minimumValue || maximumValue != UINT16_MAX || stepValue > 1) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
                     } else {
-                        context->state = kHAPIPAccessorySerializationState_AccessoriesArray_End;
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_UInt32: {
+                    const HAPUInt32Characteristic* uint32Characteristic =
+                            (const HAPUInt32Characteristic*) baseCharacteristic;
+                    uint32_t minimumValue = uint32Characteristic->constraints.minimumValue;
+                    uint32_t maximumValue = uint32Characteristic->constraints.maximumValue;
+                    uint32_t stepValue = uint32Characteristic->constraints.stepValue;
+                    HAPAssert(minimumValue <= maximumValue);
+                    if (minimumValue || maximumValue != UINT32_MAX || stepValue > 1) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_UInt64: {
+                    const HAPUInt64Characteristic* uint64Characteristic =
+                            (const HAPUInt64Characteristic*) baseCharacteristic;
+                    uint64_t minimumValue = uint64Characteristic->constraints.minimumValue;
+                    uint64_t maximumValue = uint64Characteristic->constraints.maximumValue;
+                    uint64_t stepValue = uint64Characteristic->constraints.stepValue;
+                    HAPAssert(minimumValue <= maximumValue);
+                    if (minimumValue || maximumValue != UINT64_MAX || stepValue > 1) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_Int: {
+                    const HAPIntCharacteristic* intCharacteristic =
+                            (const HAPIntCharacteristic*) baseCharacteristic;
+                    int32_t minimumValue = intCharacteristic->constraints.minimumValue;
+                    int32_t maximumValue = intCharacteristic->constraints.maximumValue;
+                    int32_t stepValue = intCharacteristic->constraints.stepValue;
+                    HAPAssert(minimumValue <= maximumValue);
+                    HAPAssert(stepValue >= 0);
+                    if (minimumValue != INT32_MIN || maximumValue != INT32_MAX || stepValue > 1) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_Float: {
+                    const HAPFloatCharacteristic* floatCharacteristic =
+                            (const HAPFloatCharacteristic*) baseCharacteristic;
+                    float minimumValue = floatCharacteristic->constraints.minimumValue;
+                    float maximumValue = floatCharacteristic->constraints.maximumValue;
+                    float stepValue = floatCharacteristic->constraints.stepValue;
+                    HAPAssert(HAPFloatIsFinite(minimumValue) || HAPFloatIsInfinite(minimumValue));
+                    HAPAssert(HAPFloatIsFinite(maximumValue) || HAPFloatIsInfinite(maximumValue));
+                    HAPAssert(minimumValue <= maximumValue);
+                    HAPAssert(stepValue >= 0);
+                    if (!(HAPFloatIsInfinite(minimumValue) && minimumValue < 0) ||
+                        !(HAPFloatIsInfinite(maximumValue) && maximumValue > 0) || !HAPFloatIsZero(stepValue)) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_String: {
+                    const HAPStringCharacteristic* stringCharacteristic =
+                            (const HAPStringCharacteristic*) baseCharacteristic;
+                    if (stringCharacteristic->constraints.maxLength !=
+                        kHAPIPAccessorySerialization_DefaultMaxStringBytes) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                    }
+                } break;
+                case kHAPCharacteristicFormat_TLV8: {
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_Data: {
+                    const HAPDataCharacteristic* dataCharacteristic =
+                            (const HAPDataCharacteristic*) baseCharacteristic;
+                    if (dataCharacteristic->constraints.maxLength !=
+                        kHAPIPAccessorySerialization_DefaultMaxDataBytes) {
+                        APPEND_STRING_OR_RETURN_ERROR(",");
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Name;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
                     }
+                } break;
+            }
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"minValue\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            switch (baseCharacteristic->format) {
+                case kHAPCharacteristicFormat_UInt8: {
+                    const HAPUInt8Characteristic* uint8Characteristic =
+                            (const HAPUInt8Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt16: {
+                    const HAPUInt16Characteristic* uint16Characteristic =
+                            (const HAPUInt16Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt32: {
+                    const HAPUInt32Characteristic* uint32Characteristic =
+                            (const HAPUInt32Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt64: {
+                    const HAPUInt64Characteristic* uint64Characteristic =
+                            (const HAPUInt64Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Int: {
+                    const HAPIntCharacteristic* intCharacteristic =
+                            (const HAPIntCharacteristic*) baseCharacteristic;
+                    APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Float: {
+                    const HAPFloatCharacteristic* floatCharacteristic =
+                            (const HAPFloatCharacteristic*) baseCharacteristic;
+                    APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.minimumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Bool:
+                case kHAPCharacteristicFormat_String:
+                case kHAPCharacteristicFormat_TLV8:
+                case kHAPCharacteristicFormat_Data: {
                 }
+                    HAPFatalError();
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryObject_Separator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_AccessoryObject_Begin;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(",");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Name;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"maxValue\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            switch (baseCharacteristic->format) {
+                case kHAPCharacteristicFormat_UInt8: {
+                    const HAPUInt8Characteristic* uint8Characteristic =
+                            (const HAPUInt8Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt16: {
+                    const HAPUInt16Characteristic* uint16Characteristic =
+                            (const HAPUInt16Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt32: {
+                    const HAPUInt32Characteristic* uint32Characteristic =
+                            (const HAPUInt32Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt64: {
+                    const HAPUInt64Characteristic* uint64Characteristic =
+                            (const HAPUInt64Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Int: {
+                    const HAPIntCharacteristic* intCharacteristic =
+                            (const HAPIntCharacteristic*) baseCharacteristic;
+                    APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Float: {
+                    const HAPFloatCharacteristic* floatCharacteristic =
+                            (const HAPFloatCharacteristic*) baseCharacteristic;
+                    APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.maximumValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_Bool:
+                case kHAPCharacteristicFormat_String:
+                case kHAPCharacteristicFormat_TLV8:
+                case kHAPCharacteristicFormat_Data: {
+                }
+                    HAPFatalError();
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryID_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"aid\"");
-                context->state = kHAPIPAccessorySerializationState_AccessoryID_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(",");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_Name;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicStepValue_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"minStep\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicStepValue_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicStepValue_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            switch (baseCharacteristic->format) {
+                case kHAPCharacteristicFormat_UInt8: {
+                    const HAPUInt8Characteristic* uint8Characteristic =
+                            (const HAPUInt8Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator;
+                } break;
+                case kHAPCharacteristicFormat_UInt16: {
+                    const HAPUInt16Characteristic* uint16Characteristic =
+                            (const HAPUInt16Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_UInt32: {
+                    const HAPUInt32Characteristic* uint32Characteristic =
+                            (const HAPUInt32Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_UInt64: {
+                    const HAPUInt64Characteristic* uint64Characteristic =
+                            (const HAPUInt64Characteristic*) baseCharacteristic;
+                    APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_Int: {
+                    const HAPIntCharacteristic* intCharacteristic =
+                            (const HAPIntCharacteristic*) baseCharacteristic;
+                    APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_Float: {
+                    const HAPFloatCharacteristic* floatCharacteristic =
+                            (const HAPFloatCharacteristic*) baseCharacteristic;
+                    APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.stepValue);
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                } break;
+                case kHAPCharacteristicFormat_Bool:
+                case kHAPCharacteristicFormat_String:
+                case kHAPCharacteristicFormat_TLV8:
+                case kHAPCharacteristicFormat_Data: {
+                }
+                    HAPFatalError();
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryID_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_AccessoryID_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            if (HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType)) {
+                if (uint8Characteristic->constraints.validValues) {
+                    APPEND_STRING_OR_RETURN_ERROR(",");
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Name;
+                } else if (uint8Characteristic->constraints.validValuesRanges) {
+                    APPEND_STRING_OR_RETURN_ERROR(",");
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name;
+                } else {
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+                }
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryID_Value: {
-                const HAPAccessory* accessory = GET_CURRENT_ACCESSORY();
-                HAPAssert(accessory);
-                APPEND_UINT64_OR_RETURN_ERROR(accessory->aid);
-                context->state = kHAPIPAccessorySerializationState_AccessoryID_ValueSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"maxLen\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxLength_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_String);
+            const HAPStringCharacteristic* stringCharacteristic =
+                    (const HAPStringCharacteristic*) baseCharacteristic;
+            APPEND_UINT64_OR_RETURN_ERROR(stringCharacteristic->constraints.maxLength);
+            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"maxDataLen\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_Data);
+            const HAPDataCharacteristic* dataCharacteristic = (const HAPDataCharacteristic*) baseCharacteristic;
+            APPEND_UINT64_OR_RETURN_ERROR(dataCharacteristic->constraints.maxLength);
+            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"valid-values\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Begin;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Begin: {
+            APPEND_STRING_OR_RETURN_ERROR("[");
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const uint8_t* const* validValues = uint8Characteristic->constraints.validValues;
+            HAPAssert(validValues);
+            context->index = 0;
+            if (validValues[context->index]) {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Value;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_AccessoryID_ValueSeparator: {
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End: {
+            APPEND_STRING_OR_RETURN_ERROR("]");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_ValueSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_ValueSeparator: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            if (uint8Characteristic->constraints.validValuesRanges) {
                 APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_ServicesArray_Name;
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_ServicesArray_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"services\"");
-                context->state = kHAPIPAccessorySerializationState_ServicesArray_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValue_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const uint8_t* const* validValues = uint8Characteristic->constraints.validValues;
+            HAPAssert(validValues);
+            HAPAssert(validValues[context->index]);
+            APPEND_UINT64_OR_RETURN_ERROR(*validValues[context->index]);
+            HAPAssert(context->index < UINT8_MAX);
+            context->index++;
+            if (validValues[context->index]) {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Separator;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_ServicesArray_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_ServicesArray_Begin;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValue_Separator: {
+            APPEND_STRING_OR_RETURN_ERROR(",");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name: {
+            APPEND_STRING_OR_RETURN_ERROR("\"valid-values-range\"");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_NameSeparator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_NameSeparator: {
+            APPEND_STRING_OR_RETURN_ERROR(":");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Begin;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Begin: {
+            APPEND_STRING_OR_RETURN_ERROR("[");
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
+                    uint8Characteristic->constraints.validValuesRanges;
+            HAPAssert(validValuesRanges);
+            context->index = 0;
+            if (validValuesRanges[context->index]) {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End;
             }
-                continue;
-            case kHAPIPAccessorySerializationState_ServicesArray_Begin: {
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End: {
+            APPEND_STRING_OR_RETURN_ERROR("]");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin: {
+            APPEND_STRING_OR_RETURN_ERROR("[");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeStart_Value;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_End: {
+            APPEND_STRING_OR_RETURN_ERROR("]");
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
+                    uint8Characteristic->constraints.validValuesRanges;
+            HAPAssert(validValuesRanges);
+            HAPAssert(context->index < UINT8_MAX);
+            context->index++;
+            if (validValuesRanges[context->index]) {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Separator;
+            } else {
+                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End;
+            }
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Separator: {
+            APPEND_STRING_OR_RETURN_ERROR(",");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeStart_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
+                    uint8Characteristic->constraints.validValuesRanges;
+            HAPAssert(validValuesRanges);
+            HAPAssert(validValuesRanges[context->index]);
+            APPEND_UINT64_OR_RETURN_ERROR(validValuesRanges[context->index]->start);
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRange_Separator;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeEnd_Value: {
+            const HAPBaseCharacteristic* baseCharacteristic = characteristic_;
+            HAPAssert(baseCharacteristic);
+            HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
+            const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
+            HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
+            const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
+                    uint8Characteristic->constraints.validValuesRanges;
+            HAPAssert(validValuesRanges);
+            HAPAssert(validValuesRanges[context->index]);
+            APPEND_UINT64_OR_RETURN_ERROR(validValuesRanges[context->index]->end);
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_End;
+        }
+            return kHAPError_None;
+        case kHAPIPAccessorySerializationState_CharacteristicValidValuesRange_Separator: {
+            APPEND_STRING_OR_RETURN_ERROR(",");
+            context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeEnd_Value;
+        }
+            return kHAPError_None;
+        default: {
+        }
+            HAPFatalError();
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessorySerializeCharacteristicMetadata(
+        const HAPCharacteristic* characteristic,
+        char* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    HAPIPAccessorySerializationContext context;
+    HAPIPAccessoryCreateSerializationContext(&context);
+    context.state = kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin;
+
+    *numBytes = 0;
+    while (context.state != kHAPIPAccessorySerializationState_CharacteristicObject_End) {
+        err = SerializeCharacteristicMetadata(&context, characteristic, bytes, maxBytes, numBytes);
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessorySerializeReadResponse(
+        HAPIPAccessorySerializationContext* context,
+        HAPAccessoryServerRef* server_,
+        HAPIPSessionDescriptorRef* session,
+        char* bytes,
+        size_t minBytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(context);
+    HAPPrecondition(context->state != kHAPIPAccessorySerializationState_ResponseIsComplete);
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->primaryAccessory);
+    HAPPrecondition(session);
+    HAPPrecondition(bytes);
+    HAPPrecondition(minBytes >= 1);
+    HAPPrecondition(maxBytes >= minBytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.3 HAP Objects
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.6.4 Example Accessory Attribute Database in JSON
+
+    // For the JSON Data Interchange Format, see RFC 7159.
+    // http://www.rfc-editor.org/rfc/rfc7159.txt
+
+    char scratchBytes[64];
+
+#define GET_CURRENT_ACCESSORY() GetCurrentAcessory(context, server_)
+
+#define GET_CURRENT_SERVICE() GetCurrentService(context, server_)
+
+#define GET_CURRENT_CHARACTERISTIC() ((const HAPBaseCharacteristic*) GetCurrentCharacteristic(context, server_))
+
+    *numBytes = 0;
+
+    do {
+        HAPAssert(sizeof context->state == sizeof(HAPIPAccessorySerializationState));
+        switch ((HAPIPAccessorySerializationState) context->state) {
+            case kHAPIPAccessorySerializationState_ResponseObject_Begin: {
+                APPEND_STRING_OR_RETURN_ERROR("{");
+                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_Name;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_ResponseObject_End: {
+                APPEND_STRING_OR_RETURN_ERROR("}");
+                context->state = kHAPIPAccessorySerializationState_ResponseIsComplete;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoriesArray_Name: {
+                APPEND_STRING_OR_RETURN_ERROR("\"accessories\"");
+                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_NameSeparator;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoriesArray_NameSeparator: {
+                APPEND_STRING_OR_RETURN_ERROR(":");
+                context->state = kHAPIPAccessorySerializationState_AccessoriesArray_Begin;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoriesArray_Begin: {
+                APPEND_STRING_OR_RETURN_ERROR("[");
+                context->accessoryIndex = 0;
+                context->state = kHAPIPAccessorySerializationState_AccessoryObject_Begin;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoriesArray_End: {
+                APPEND_STRING_OR_RETURN_ERROR("]");
+                context->state = kHAPIPAccessorySerializationState_ResponseObject_End;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryObject_Begin: {
+                APPEND_STRING_OR_RETURN_ERROR("{");
+                context->state = kHAPIPAccessorySerializationState_AccessoryID_Name;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryObject_End: {
+                APPEND_STRING_OR_RETURN_ERROR("}");
+                HAPAssert(context->accessoryIndex < UINT8_MAX);
+                context->accessoryIndex++;
+                if (context->accessoryIndex == 1) {
+                    if (server->ip.bridgedAccessories && server->ip.bridgedAccessories[0]) {
+                        context->state = kHAPIPAccessorySerializationState_AccessoryObject_Separator;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_AccessoriesArray_End;
+                    }
+                } else {
+                    HAPAssert(server->ip.bridgedAccessories);
+                    if (server->ip.bridgedAccessories[context->accessoryIndex - 1]) {
+                        context->state = kHAPIPAccessorySerializationState_AccessoryObject_Separator;
+                    } else {
+                        context->state = kHAPIPAccessorySerializationState_AccessoriesArray_End;
+                    }
+                }
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryObject_Separator: {
+                APPEND_STRING_OR_RETURN_ERROR(",");
+                context->state = kHAPIPAccessorySerializationState_AccessoryObject_Begin;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryID_Name: {
+                APPEND_STRING_OR_RETURN_ERROR("\"aid\"");
+                context->state = kHAPIPAccessorySerializationState_AccessoryID_NameSeparator;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryID_NameSeparator: {
+                APPEND_STRING_OR_RETURN_ERROR(":");
+                context->state = kHAPIPAccessorySerializationState_AccessoryID_Value;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryID_Value: {
+                const HAPAccessory* accessory = GET_CURRENT_ACCESSORY();
+                HAPAssert(accessory);
+                APPEND_UINT64_OR_RETURN_ERROR(accessory->aid);
+                context->state = kHAPIPAccessorySerializationState_AccessoryID_ValueSeparator;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_AccessoryID_ValueSeparator: {
+                APPEND_STRING_OR_RETURN_ERROR(",");
+                context->state = kHAPIPAccessorySerializationState_ServicesArray_Name;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_ServicesArray_Name: {
+                APPEND_STRING_OR_RETURN_ERROR("\"services\"");
+                context->state = kHAPIPAccessorySerializationState_ServicesArray_NameSeparator;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_ServicesArray_NameSeparator: {
+                APPEND_STRING_OR_RETURN_ERROR(":");
+                context->state = kHAPIPAccessorySerializationState_ServicesArray_Begin;
+            }
+                continue;
+            case kHAPIPAccessorySerializationState_ServicesArray_Begin: {
                 APPEND_STRING_OR_RETURN_ERROR("[");
                 const HAPAccessory* accessory = GET_CURRENT_ACCESSORY();
                 HAPAssert(accessory);
@@ -566,7 +1341,13 @@ HAPError HAPIPAccessorySerializeReadResponse(
             case kHAPIPAccessorySerializationState_ServiceType_Value: {
                 const HAPService* service = GET_CURRENT_SERVICE();
                 HAPAssert(service);
-                APPEND_UUID_OR_RETURN_ERROR(service->serviceType);
+                const HAPPrecomputedService* _Nullable precomputedService =
+                        GetCurrentPrecomputedService(context, server_);
+                if (precomputedService) {
+                    APPEND_QUOTED_STRING_OR_RETURN_ERROR(precomputedService->ip.type);
+                } else {
+                    APPEND_UUID_OR_RETURN_ERROR(service->serviceType);
+                }
                 context->state = kHAPIPAccessorySerializationState_ServiceType_ValueSeparator;
             }
                 continue;
@@ -776,7 +1557,13 @@ HAPError HAPIPAccessorySerializeReadResponse(
             case kHAPIPAccessorySerializationState_CharacteristicType_Value: {
                 const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
                 HAPAssert(baseCharacteristic);
-                APPEND_UUID_OR_RETURN_ERROR(baseCharacteristic->characteristicType);
+                const HAPPrecomputedCharacteristic* _Nullable precomputedCharacteristic =
+                        GetCurrentPrecomputedCharacteristic(context, server_);
+                if (precomputedCharacteristic) {
+                    APPEND_QUOTED_STRING_OR_RETURN_ERROR(precomputedCharacteristic->ip.type);
+                } else {
+                    APPEND_UUID_OR_RETURN_ERROR(baseCharacteristic->characteristicType);
+                }
                 context->state = kHAPIPAccessorySerializationState_CharacteristicType_ValueSeparator;
             }
                 continue;
@@ -995,14 +1782,8 @@ HAPError HAPIPAccessorySerializeReadResponse(
                 if (baseCharacteristic->properties.readable) {
                     APPEND_STRING_OR_RETURN_ERROR(",");
                     context->state = kHAPIPAccessorySerializationState_CharacteristicEventNotifications_Name;
-                } else if (baseCharacteristic->manufacturerDescription) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_Name;
-                } else if (HAPCharacteristicGetUnit(baseCharacteristic) != kHAPCharacteristicUnits_None) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Name;
                 } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin;
                 }
             }
                 continue;
@@ -1094,644 +1875,77 @@ HAPError HAPIPAccessorySerializeReadResponse(
             }
                 continue;
             case kHAPIPAccessorySerializationState_CharacteristicEventNotifications_ValueSeparator: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                if (baseCharacteristic->manufacturerDescription) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_Name;
-                } else if (HAPCharacteristicGetUnit(baseCharacteristic) != kHAPCharacteristicUnits_None) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Name;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicDescription_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"description\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator;
+                context->state = kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin;
             }
                 continue;
-            case kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_Value;
+            case kHAPIPAccessorySerializationState_CharacteristicPrecomputedMetadata_Value: {
+                const HAPPrecomputedCharacteristic* precomputedCharacteristic =
+                        GetCurrentPrecomputedCharacteristic(context, server_);
+                HAPAssert(precomputedCharacteristic);
+                APPEND_STRING_OR_RETURN_ERROR(precomputedCharacteristic->ip.metadata);
+                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
             }
                 continue;
-            case kHAPIPAccessorySerializationState_CharacteristicDescription_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->manufacturerDescription);
-
-                HAPAssert(*numBytes <= maxBytes);
-                if (maxBytes - *numBytes < 2) {
-                    HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
-                    return kHAPError_OutOfResources;
+            case kHAPIPAccessorySerializationState_CharacteristicMetadata_Begin: {
+                if (GetCurrentPrecomputedCharacteristic(context, server_)) {
+                    context->state = kHAPIPAccessorySerializationState_CharacteristicPrecomputedMetadata_Value;
+                    continue;
                 }
-                // Buffer 'bytes' has enough capacity to store at least an empty string including quotation marks.
-
-                const char* manufacturerDescription = HAPNonnull(baseCharacteristic->manufacturerDescription);
-                size_t numManufacturerDescriptionBytes = HAPStringGetNumBytes(manufacturerDescription);
-                if (maxBytes - *numBytes - 2 < numManufacturerDescriptionBytes) {
-                    HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
-                    return kHAPError_OutOfResources;
-                }
-                HAPRawBufferCopyBytes(&bytes[*numBytes + 1], manufacturerDescription, numManufacturerDescriptionBytes);
-                err = HAPJSONUtilsEscapeStringData(
-                        &bytes[*numBytes + 1], maxBytes - *numBytes - 2, &numManufacturerDescriptionBytes);
+                err = SerializeCharacteristicMetadata(context, GET_CURRENT_CHARACTERISTIC(), bytes, maxBytes, numBytes);
                 if (err) {
                     HAPAssert(err == kHAPError_OutOfResources);
-                    HAPLogError(&logObject, "Not enough resources to serialize GET /accessories response.");
                     return err;
                 }
-                bytes[*numBytes] = '"';
-                bytes[*numBytes + 1 + numManufacturerDescriptionBytes] = '"';
-                *numBytes += 1 + numManufacturerDescriptionBytes + 1;
-
-                HAPAssert(*numBytes <= maxBytes);
-
-                context->state = kHAPIPAccessorySerializationState_CharacteristicDescription_ValueSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicDescription_ValueSeparator: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                if (HAPCharacteristicGetUnit(baseCharacteristic) != kHAPCharacteristicUnits_None) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Name;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicUnit_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"unit\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicUnit_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicUnit_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                switch (HAPCharacteristicGetUnit(baseCharacteristic)) {
-                    case kHAPCharacteristicUnits_None: {
-                    }
-                        HAPFatalError();
-                    case kHAPCharacteristicUnits_Celsius: {
-                        APPEND_STRING_OR_RETURN_ERROR("\"celsius\"");
-                    } break;
-                    case kHAPCharacteristicUnits_ArcDegrees: {
-                        APPEND_STRING_OR_RETURN_ERROR("\"arcdegrees\"");
-                    } break;
-                    case kHAPCharacteristicUnits_Percentage: {
-                        APPEND_STRING_OR_RETURN_ERROR("\"percentage\"");
-                    } break;
-                    case kHAPCharacteristicUnits_Lux: {
-                        APPEND_STRING_OR_RETURN_ERROR("\"lux\"");
-                    } break;
-                    case kHAPCharacteristicUnits_Seconds: {
-                        APPEND_STRING_OR_RETURN_ERROR("\"seconds\"");
-                    } break;
-                }
-                context->state = kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                switch (baseCharacteristic->format) {
-                    case kHAPCharacteristicFormat_Bool: {
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt8: {
-                        const HAPUInt8Characteristic* uint8Characteristic =
-                                (const HAPUInt8Characteristic*) baseCharacteristic;
-                        uint8_t minimumValue = uint8Characteristic->constraints.minimumValue;
-                        uint8_t maximumValue = uint8Characteristic->constraints.maximumValue;
-                        uint8_t stepValue = uint8Characteristic->constraints.stepValue;
-                        HAPAssert(minimumValue <= maximumValue);
-                        if (minimumValue || maximumValue != UINT8_MAX || stepValue > 1) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_UInt16: {
-                        const HAPUInt16Characteristic* uint16Characteristic =
-                                (const HAPUInt16Characteristic*) baseCharacteristic;
-                        uint16_t minimumValue = uint16Characteristic->constraints.minimumValue;
-                        uint16_t maximumValue = uint16Characteristic->constraints.maximumValue;
-                        uint16_t stepValue = uint16Characteristic->constraints.stepValue;
-                        HAPAssert(minimumValue <= maximumValue);
-                        if (minimumValue || maximumValue != UINT16_MAX || stepValue > 1) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_UInt32: {
-                        const HAPUInt32Characteristic* uint32Characteristic =
-                                (const HAPUInt32Characteristic*) baseCharacteristic;
-                        uint32_t minimumValue = uint32Characteristic->constraints.minimumValue;
-                        uint32_t maximumValue = uint32Characteristic->constraints.maximumValue;
-                        uint32_t stepValue = uint32Characteristic->constraints.stepValue;
-                        HAPAssert(minimumValue <= maximumValue);
-                        if (minimumValue || maximumValue != UINT32_MAX || stepValue > 1) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_UInt64: {
-                        const HAPUInt64Characteristic* uint64Characteristic =
-                                (const HAPUInt64Characteristic*) baseCharacteristic;
-                        uint64_t minimumValue = uint64Characteristic->constraints.minimumValue;
-                        uint64_t maximumValue = uint64Characteristic->constraints.maximumValue;
-                        uint64_t stepValue = uint64Characteristic->constraints.stepValue;
-                        HAPAssert(minimumValue <= maximumValue);
-                        if (minimumValue || maximumValue != UINT64_MAX || stepValue > 1) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_Int: {
-                        const HAPIntCharacteristic* intCharacteristic =
-                                (const HAPIntCharacteristic*) baseCharacteristic;
-                        int32_t minimumValue = intCharacteristic->constraints.minimumValue;
-                        int32_t maximumValue = intCharacteristic->constraints.maximumValue;
-                        int32_t stepValue = intCharacteristic->constraints.stepValue;
-                        HAPAssert(minimumValue <= maximumValue);
-                        HAPAssert(stepValue >= 0);
-                        if (minimumValue != INT32_MIN || maximumValue != INT32_MAX || stepValue > 1) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_Float: {
-                        const HAPFloatCharacteristic* floatCharacteristic =
-                                (const HAPFloatCharacteristic*) baseCharacteristic;
-                        float minimumValue = floatCharacteristic->constraints.minimumValue;
-                        float maximumValue = floatCharacteristic->constraints.maximumValue;
-                        float stepValue = floatCharacteristic->constraints.stepValue;
-                        HAPAssert(HAPFloatIsFinite(minimumValue) || HAPFloatIsInfinite(minimumValue));
-                        HAPAssert(HAPFloatIsFinite(maximumValue) || HAPFloatIsInfinite(maximumValue));
-                        HAPAssert(minimumValue <= maximumValue);
-                        HAPAssert(stepValue >= 0);
-                        if (!(HAPFloatIsInfinite(minimumValue) && minimumValue < 0) ||
-                            !(HAPFloatIsInfinite(maximumValue) && maximumValue > 0) || !HAPFloatIsZero(stepValue)) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_String: {
-                        const HAPStringCharacteristic* stringCharacteristic =
-                                (const HAPStringCharacteristic*) baseCharacteristic;
-                        if (stringCharacteristic->constraints.maxLength !=
-                            kHAPIPAccessorySerialization_DefaultMaxStringBytes) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                    case kHAPCharacteristicFormat_TLV8: {
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_Data: {
-                        const HAPDataCharacteristic* dataCharacteristic =
-                                (const HAPDataCharacteristic*) baseCharacteristic;
-                        if (dataCharacteristic->constraints.maxLength !=
-                            kHAPIPAccessorySerialization_DefaultMaxDataBytes) {
-                            APPEND_STRING_OR_RETURN_ERROR(",");
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Name;
-                        } else {
-                            context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                        }
-                    } break;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"minValue\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                switch (baseCharacteristic->format) {
-                    case kHAPCharacteristicFormat_UInt8: {
-                        const HAPUInt8Characteristic* uint8Characteristic =
-                                (const HAPUInt8Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt16: {
-                        const HAPUInt16Characteristic* uint16Characteristic =
-                                (const HAPUInt16Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt32: {
-                        const HAPUInt32Characteristic* uint32Characteristic =
-                                (const HAPUInt32Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt64: {
-                        const HAPUInt64Characteristic* uint64Characteristic =
-                                (const HAPUInt64Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Int: {
-                        const HAPIntCharacteristic* intCharacteristic =
-                                (const HAPIntCharacteristic*) baseCharacteristic;
-                        APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Float: {
-                        const HAPFloatCharacteristic* floatCharacteristic =
-                                (const HAPFloatCharacteristic*) baseCharacteristic;
-                        APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.minimumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Bool:
-                    case kHAPCharacteristicFormat_String:
-                    case kHAPCharacteristicFormat_TLV8:
-                    case kHAPCharacteristicFormat_Data: {
-                    }
-                        HAPFatalError();
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Name;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"maxValue\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                switch (baseCharacteristic->format) {
-                    case kHAPCharacteristicFormat_UInt8: {
-                        const HAPUInt8Characteristic* uint8Characteristic =
-                                (const HAPUInt8Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt16: {
-                        const HAPUInt16Characteristic* uint16Characteristic =
-                                (const HAPUInt16Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt32: {
-                        const HAPUInt32Characteristic* uint32Characteristic =
-                                (const HAPUInt32Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt64: {
-                        const HAPUInt64Characteristic* uint64Characteristic =
-                                (const HAPUInt64Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Int: {
-                        const HAPIntCharacteristic* intCharacteristic =
-                                (const HAPIntCharacteristic*) baseCharacteristic;
-                        APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Float: {
-                        const HAPFloatCharacteristic* floatCharacteristic =
-                                (const HAPFloatCharacteristic*) baseCharacteristic;
-                        APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.maximumValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_Bool:
-                    case kHAPCharacteristicFormat_String:
-                    case kHAPCharacteristicFormat_TLV8:
-                    case kHAPCharacteristicFormat_Data: {
-                    }
-                        HAPFatalError();
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_Name;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicStepValue_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"minStep\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicStepValue_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicStepValue_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                switch (baseCharacteristic->format) {
-                    case kHAPCharacteristicFormat_UInt8: {
-                        const HAPUInt8Characteristic* uint8Characteristic =
-                                (const HAPUInt8Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint8Characteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt16: {
-                        const HAPUInt16Characteristic* uint16Characteristic =
-                                (const HAPUInt16Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint16Characteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt32: {
-                        const HAPUInt32Characteristic* uint32Characteristic =
-                                (const HAPUInt32Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint32Characteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_UInt64: {
-                        const HAPUInt64Characteristic* uint64Characteristic =
-                                (const HAPUInt64Characteristic*) baseCharacteristic;
-                        APPEND_UINT64_OR_RETURN_ERROR(uint64Characteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_Int: {
-                        const HAPIntCharacteristic* intCharacteristic =
-                                (const HAPIntCharacteristic*) baseCharacteristic;
-                        APPEND_INT32_OR_RETURN_ERROR(intCharacteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_Float: {
-                        const HAPFloatCharacteristic* floatCharacteristic =
-                                (const HAPFloatCharacteristic*) baseCharacteristic;
-                        APPEND_FLOAT_OR_RETURN_ERROR(floatCharacteristic->constraints.stepValue);
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    } break;
-                    case kHAPCharacteristicFormat_Bool:
-                    case kHAPCharacteristicFormat_String:
-                    case kHAPCharacteristicFormat_TLV8:
-                    case kHAPCharacteristicFormat_Data: {
-                    }
-                        HAPFatalError();
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                if (HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType)) {
-                    if (uint8Characteristic->constraints.validValues) {
-                        APPEND_STRING_OR_RETURN_ERROR(",");
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Name;
-                    } else if (uint8Characteristic->constraints.validValuesRanges) {
-                        APPEND_STRING_OR_RETURN_ERROR(",");
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name;
-                    } else {
-                        context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                    }
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"maxLen\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaxLength_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_String);
-                const HAPStringCharacteristic* stringCharacteristic =
-                        (const HAPStringCharacteristic*) baseCharacteristic;
-                APPEND_UINT64_OR_RETURN_ERROR(stringCharacteristic->constraints.maxLength);
-                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"maxDataLen\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_Data);
-                const HAPDataCharacteristic* dataCharacteristic = (const HAPDataCharacteristic*) baseCharacteristic;
-                APPEND_UINT64_OR_RETURN_ERROR(dataCharacteristic->constraints.maxLength);
-                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"valid-values\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Begin;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("[");
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const uint8_t* const* validValues = uint8Characteristic->constraints.validValues;
-                HAPAssert(validValues);
-                context->index = 0;
-                if (validValues[context->index]) {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Value;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End: {
-                APPEND_STRING_OR_RETURN_ERROR("]");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_ValueSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_ValueSeparator: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                if (uint8Characteristic->constraints.validValuesRanges) {
-                    APPEND_STRING_OR_RETURN_ERROR(",");
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValue_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const uint8_t* const* validValues = uint8Characteristic->constraints.validValues;
-                HAPAssert(validValues);
-                HAPAssert(validValues[context->index]);
-                APPEND_UINT64_OR_RETURN_ERROR(*validValues[context->index]);
-                HAPAssert(context->index < UINT8_MAX);
-                context->index++;
-                if (validValues[context->index]) {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Separator;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValue_Separator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValue_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name: {
-                APPEND_STRING_OR_RETURN_ERROR("\"valid-values-range\"");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_NameSeparator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_NameSeparator: {
-                APPEND_STRING_OR_RETURN_ERROR(":");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Begin;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("[");
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
-                        uint8Characteristic->constraints.validValuesRanges;
-                HAPAssert(validValuesRanges);
-                context->index = 0;
-                if (validValuesRanges[context->index]) {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End: {
-                APPEND_STRING_OR_RETURN_ERROR("]");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicObject_End;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin: {
-                APPEND_STRING_OR_RETURN_ERROR("[");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeStart_Value;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_End: {
-                APPEND_STRING_OR_RETURN_ERROR("]");
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
-                        uint8Characteristic->constraints.validValuesRanges;
-                HAPAssert(validValuesRanges);
-                HAPAssert(context->index < UINT8_MAX);
-                context->index++;
-                if (validValuesRanges[context->index]) {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Separator;
-                } else {
-                    context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End;
-                }
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Separator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeStart_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
-                        uint8Characteristic->constraints.validValuesRanges;
-                HAPAssert(validValuesRanges);
-                HAPAssert(validValuesRanges[context->index]);
-                APPEND_UINT64_OR_RETURN_ERROR(validValuesRanges[context->index]->start);
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRange_Separator;
-            }
-                continue;
-            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeEnd_Value: {
-                const HAPBaseCharacteristic* baseCharacteristic = GET_CURRENT_CHARACTERISTIC();
-                HAPAssert(baseCharacteristic);
-                HAPAssert(baseCharacteristic->format == kHAPCharacteristicFormat_UInt8);
-                const HAPUInt8Characteristic* uint8Characteristic = (const HAPUInt8Characteristic*) baseCharacteristic;
-                HAPAssert(HAPUUIDIsAppleDefined(uint8Characteristic->characteristicType));
-                const HAPUInt8CharacteristicValidValuesRange* const* validValuesRanges =
-                        uint8Characteristic->constraints.validValuesRanges;
-                HAPAssert(validValuesRanges);
-                HAPAssert(validValuesRanges[context->index]);
-                APPEND_UINT64_OR_RETURN_ERROR(validValuesRanges[context->index]->end);
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_End;
             }
                 continue;
+            case kHAPIPAccessorySerializationState_CharacteristicDescription_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicDescription_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicDescription_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicDescription_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicUnit_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicUnit_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicUnit_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicUnit_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicMinimumValue_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicMaximumValue_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicStepValue_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicStepValue_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicStepValue_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicStepValue_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxLength_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicMaxDataLength_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_Begin:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_End:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesArray_ValueSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValue_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValue_Separator:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Name:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_NameSeparator:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_Begin:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangesArray_End:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Begin:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_End:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeArray_Separator:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeStart_Value:
+            case kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeEnd_Value:
             case kHAPIPAccessorySerializationState_CharacteristicValidValuesRange_Separator: {
-                APPEND_STRING_OR_RETURN_ERROR(",");
-                context->state = kHAPIPAccessorySerializationState_CharacteristicValidValuesRangeEnd_Value;
+                err = SerializeCharacteristicMetadata(context, GET_CURRENT_CHARACTERISTIC(), bytes, maxBytes, numBytes);
+                if (err) {
+                    HAPAssert(err == kHAPError_OutOfResources);
+                    return err;
+                }
             }
                 continue;
             case kHAPIPAccessorySerializationState_ResponseIsComplete: {
@@ -1741,15 +1955,16 @@ HAPError HAPIPAccessorySerializeReadResponse(
         HAPFatalError();
     } while ((*numBytes < minBytes) && (context->state != kHAPIPAccessorySerializationState_ResponseIsComplete));
 
-#undef APPEND_FLOAT_OR_RETURN_ERROR
-#undef APPEND_INT32_OR_RETURN_ERROR
-#undef APPEND_UINT64_OR_RETURN_ERROR
-#undef APPEND_UUID_OR_RETURN_ERROR
-#undef APPEND_STRING_OR_RETURN_ERROR
-
 #undef GET_CURRENT_CHARACTERISTIC
 #undef GET_CURRENT_SERVICE
 #undef GET_CURRENT_ACCESSORY
 
     return kHAPError_None;
 }
+
+#undef APPEND_QUOTED_STRING_OR_RETURN_ERROR
+#undef APPEND_FLOAT_OR_RETURN_ERROR
+#undef APPEND_INT32_OR_RETURN_ERROR
+#undef APPEND_UINT64_OR_RETURN_ERROR
+#undef APPEND_UUID_OR_RETURN_ERROR
+#undef APPEND_STRING_OR_RETURN_ERROR
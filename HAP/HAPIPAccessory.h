@@ -88,6 +88,29 @@ HAPError HAPIPAccessorySerializeReadResponse(
         size_t maxBytes,
         size_t* numBytes);
 
+/**
+ * Serializes the static members of a characteristic object in a GET /accessories response that follow "perms" and
+ * "ev", i.e. "description", "unit", "minValue", "maxValue", "minStep", "maxLen", "maxDataLen" and "valid-values".
+ *
+ * - Each member is preceded by a comma. If the characteristic has none of these members, nothing is serialized.
+ *
+ * - The output matches HAPPrecomputedCharacteristic.ip.metadata.
+ *
+ * @param      characteristic       Characteristic.
+ * @param[out] bytes                Buffer to fill.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Number of bytes serialized.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the supplied buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessorySerializeCharacteristicMetadata(
+        const HAPCharacteristic* characteristic,
+        char* bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -1992,6 +1992,102 @@ error:
     return kHAPError_OutOfResources;
 }
 
+/**
+ * Separator between the header fields and the body of a HTTP message.
+ */
+#define kHAPIPAccessoryProtocol_HeaderTerminator "\r\n\r\n"
+
+/**
+ * Returns the number of decimal digits of a value.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumDecimalDigits(size_t value) {
+    size_t numDigits = 1;
+    while (value >= 10) {
+        value /= 10;
+        numDigits++;
+    }
+    return numDigits;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolBeginJSONMessage(
+        HAPIPByteBuffer* buffer,
+        const char* startLine,
+        HAPIPAccessoryProtocolJSONMessage* message) {
+    HAPPrecondition(buffer);
+    HAPPrecondition(startLine);
+    HAPPrecondition(message);
+
+    HAPError err;
+
+    size_t mark = buffer->position;
+    err = HAPIPByteBufferAppendStringWithFormat(
+            buffer,
+            "%s"
+            "Content-Type: application/hap+json\r\n"
+            "Content-Length: ",
+            startLine);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        buffer->position = mark;
+        return err;
+    }
+    size_t numRemainingBytes = buffer->limit - buffer->position;
+    size_t numHeaderTerminatorBytes = sizeof kHAPIPAccessoryProtocol_HeaderTerminator - 1;
+    if (numRemainingBytes < 1 + numHeaderTerminatorBytes + 1) {
+        buffer->position = mark;
+        return kHAPError_OutOfResources;
+    }
+
+    // Reserve the smallest number of digits that can represent the length of any body that fits behind them.
+    // Formatted output needs space for a NULL terminator, so the body cannot use the last byte of the buffer.
+    // A body that fits into the buffer with its exact Content-Length also fits behind this reservation.
+    size_t numDigits = 1;
+    while (GetNumDecimalDigits(numRemainingBytes - numDigits - numHeaderTerminatorBytes - 1) > numDigits) {
+        numDigits++;
+    }
+    HAPAssert(numDigits + numHeaderTerminatorBytes + 1 <= numRemainingBytes);
+
+    message->contentLengthPosition = buffer->position;
+    message->bodyPosition = buffer->position + numDigits + numHeaderTerminatorBytes;
+    buffer->position = message->bodyPosition;
+    return kHAPError_None;
+}
+
+void HAPIPAccessoryProtocolCompleteJSONMessage(
+        HAPIPByteBuffer* buffer,
+        const HAPIPAccessoryProtocolJSONMessage* message) {
+    HAPPrecondition(buffer);
+    HAPPrecondition(message);
+    HAPPrecondition(message->contentLengthPosition < message->bodyPosition);
+    HAPPrecondition(message->bodyPosition <= buffer->position);
+
+    HAPError err;
+
+    size_t numBodyBytes = buffer->position - message->bodyPosition;
+    HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
+    HAPAssert(numBodyBytes <= UINT32_MAX);
+    HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
+
+    char contentLength[sizeof "4294967295"];
+    err = HAPUInt64GetDescription(numBodyBytes, contentLength, sizeof contentLength);
+    HAPAssert(!err);
+    size_t numContentLengthBytes = HAPStringGetNumBytes(contentLength);
+
+    size_t position = message->contentLengthPosition;
+    HAPRawBufferCopyBytes(&buffer->data[position], contentLength, numContentLengthBytes);
+    position += numContentLengthBytes;
+    HAPRawBufferCopyBytes(
+            &buffer->data[position],
+            kHAPIPAccessoryProtocol_HeaderTerminator,
+            sizeof kHAPIPAccessoryProtocol_HeaderTerminator - 1);
+    position += sizeof kHAPIPAccessoryProtocol_HeaderTerminator - 1;
+    HAPAssert(position <= message->bodyPosition);
+    HAPRawBufferCopyBytes(&buffer->data[position], &buffer->data[message->bodyPosition], numBodyBytes);
+    buffer->position = position + numBodyBytes;
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
         const char* bytes,
@@ -156,6 +156,50 @@ HAPError HAPIPAccessoryProtocolGetEventNotificationBytes(
         size_t numReadContexts,
         HAPIPByteBuffer* buffer);
 
+/**
+ * HAP JSON message whose body is serialized directly into a byte buffer.
+ */
+typedef struct {
+    size_t contentLengthPosition; /**< Buffer position at which the Content-Length value starts. */
+    size_t bodyPosition;          /**< Buffer position at which the message body starts. */
+} HAPIPAccessoryProtocolJSONMessage;
+
+/**
+ * Begins a HAP JSON message whose body is appended to a byte buffer in a single pass.
+ *
+ * - Space for the Content-Length value is reserved after the header fields. The number of reserved digits is
+ *   derived from the remaining capacity of the buffer, so that every body that fits into the buffer with its exact
+ *   Content-Length also fits behind the reservation.
+ *
+ * - The message body is then appended at the current buffer position, and the message is finalized with
+ *   HAPIPAccessoryProtocolCompleteJSONMessage.
+ *
+ * @param      buffer               Buffer.
+ * @param      startLine            Start line of the message, including the trailing CRLF.
+ * @param[out] message              Message.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the buffer is not large enough. The buffer position is unchanged.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolBeginJSONMessage(
+        HAPIPByteBuffer* buffer,
+        const char* startLine,
+        HAPIPAccessoryProtocolJSONMessage* message);
+
+/**
+ * Completes a HAP JSON message that has been started with HAPIPAccessoryProtocolBeginJSONMessage.
+ *
+ * - The Content-Length value is written into the reserved space and the message body is moved to follow the
+ *   header directly. The resulting bytes are identical to a message that is serialized with a known content length.
+ *
+ * @param      buffer               Buffer.
+ * @param      message              Message.
+ */
+void HAPIPAccessoryProtocolCompleteJSONMessage(
+        HAPIPByteBuffer* buffer,
+        const HAPIPAccessoryProtocolJSONMessage* message);
+
 /**
  * Parses a PUT /prepare request.
  *
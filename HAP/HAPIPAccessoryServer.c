@@ -263,11 +263,17 @@ static void HAPIPSessionDestroy(HAPIPSession* ipSession) {
 
     HAPLogDebug(&logObject, "session:%p:releasing session", (const void*) session);
 
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+
     HAPRawBufferZero(&ipSession->descriptor, sizeof ipSession->descriptor);
     HAPRawBufferZero(ipSession->inboundBuffer.bytes, ipSession->inboundBuffer.numBytes);
     HAPRawBufferZero(ipSession->outboundBuffer.bytes, ipSession->outboundBuffer.numBytes);
     HAPRawBufferZero(
             ipSession->eventNotifications, ipSession->numEventNotifications * sizeof *ipSession->eventNotifications);
+
+    // Return session to the list of free sessions.
+    session->nextFreeSession = server->ip.freeSessions;
+    server->ip.freeSessions = ipSession;
 }
 
 static void collect_garbage(HAPAccessoryServerRef* server_) {
@@ -380,7 +386,7 @@ static void schedule_max_idle_time_timer(HAPAccessoryServerRef* server_) {
 
     HAPError err;
 
-    HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+    HAPTime clock_now_ms = HAPPlatformClockGetCurrentCoarse();
 
     int64_t timeout_ms = -1;
 
@@ -513,6 +519,7 @@ static void CloseSession(HAPIPSessionDescriptor* session) {
         HAPPlatformTCPStreamClose(HAPNonnull(server->platform.ip.tcpStreamManager), session->tcpStream);
         session->tcpStreamIsOpen = false;
     }
+    HAPRawBufferZero(&session->pendingPairingResponse, sizeof session->pendingPairingResponse);
     session->state = kHAPIPSessionState_Idle;
     if (!server->ip.garbageCollectionTimer) {
         err = HAPPlatformTimerRegister(
@@ -599,7 +606,7 @@ static void put_prepare(HAPIPSessionDescriptor* session) {
             // Assumption: Same behavior for PID.
 
             // TTL.
-            HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+            HAPTime clock_now_ms = HAPPlatformClockGetCurrentCoarse();
             if (UINT64_MAX - clock_now_ms < ttl) {
                 HAPLog(&logObject, "Clipping TTL to avoid clock overflow.");
                 session->timedWriteExpirationTime = UINT64_MAX;
@@ -642,39 +649,27 @@ static void write_characteristic_write_response(
     HAPPrecondition(!HAPSessionIsTransient(&session->securitySession._.hap));
 
     HAPError err;
-    size_t content_length, mark;
+    size_t mark;
+    HAPIPAccessoryProtocolJSONMessage message;
 
     HAPAssert(contexts);
     HAPAssert(session->outboundBuffer.data);
     HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
     HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
-    content_length = HAPIPAccessoryProtocolGetNumCharacteristicWriteResponseBytes(
-            HAPNonnull(session->server), contexts, contexts_count);
-    HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
-    if (content_length <= UINT32_MAX) {
-        mark = session->outboundBuffer.position;
-        err = HAPIPByteBufferAppendStringWithFormat(
-                &session->outboundBuffer,
-                "HTTP/1.1 207 Multi-Status\r\n"
-                "Content-Type: application/hap+json\r\n"
-                "Content-Length: %lu\r\n\r\n",
-                (unsigned long) content_length);
-        HAPAssert(!err);
-        if (content_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
-            mark = session->outboundBuffer.position;
-            err = HAPIPAccessoryProtocolGetCharacteristicWriteResponseBytes(
-                    HAPNonnull(session->server), contexts, contexts_count, &session->outboundBuffer);
-            HAPAssert(!err && (session->outboundBuffer.position - mark == content_length));
-        } else {
-            HAPLog(&logObject, "Out of resources (outbound buffer too small).");
-            session->outboundBuffer.position = mark;
-            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-        }
-    } else {
-        HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
+    mark = session->outboundBuffer.position;
+    err = HAPIPAccessoryProtocolBeginJSONMessage(&session->outboundBuffer, "HTTP/1.1 207 Multi-Status\r\n", &message);
+    if (!err) {
+        err = HAPIPAccessoryProtocolGetCharacteristicWriteResponseBytes(
+                HAPNonnull(session->server), contexts, contexts_count, &session->outboundBuffer);
+    }
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Out of resources (outbound buffer too small).");
+        session->outboundBuffer.position = mark;
         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
+        return;
     }
-    HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
+    HAPIPAccessoryProtocolCompleteJSONMessage(&session->outboundBuffer, &message);
 }
 
 static void schedule_event_notifications(HAPAccessoryServerRef* server_);
@@ -716,7 +711,7 @@ static void schedule_event_notifications(HAPAccessoryServerRef* server_) {
         }
     }
 
-    HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+    HAPTime clock_now_ms = HAPPlatformClockGetCurrentCoarse();
     int64_t timeout_ms = -1;
 
     for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
@@ -1402,7 +1397,7 @@ static void put_characteristics(HAPIPSessionDescriptor* session) {
                 &pid);
         if (!err) {
             if ((session->timedWriteExpirationTime && pid_valid &&
-                 session->timedWriteExpirationTime < HAPPlatformClockGetCurrent()) ||
+                 session->timedWriteExpirationTime < HAPPlatformClockGetCurrentCoarse()) ||
                 (session->timedWriteExpirationTime && pid_valid && session->timedWritePID != pid) ||
                 (!session->timedWriteExpirationTime && pid_valid)) {
                 // If the accessory receives an Execute Write Request after the TTL has expired it must ignore the
@@ -1820,7 +1815,8 @@ static void get_characteristics(HAPIPSessionDescriptor* session) {
     HAPError err;
 
     int r;
-    size_t contexts_count, content_length, mark;
+    size_t contexts_count, mark;
+    HAPIPAccessoryProtocolJSONMessage message;
     HAPIPReadRequestParameters parameters;
     HAPIPByteBuffer data_buffer;
 
@@ -1852,47 +1848,30 @@ static void get_characteristics(HAPIPSessionDescriptor* session) {
                         server->ip.storage->readContexts,
                         contexts_count,
                         &data_buffer);
-                content_length = HAPIPAccessoryProtocolGetNumCharacteristicReadResponseBytes(
-                        HAPNonnull(session->server), server->ip.storage->readContexts, contexts_count, &parameters);
                 HAPAssert(session->outboundBuffer.data);
                 HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
                 HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
                 mark = session->outboundBuffer.position;
-                if (r == 0) {
-                    err = HAPIPByteBufferAppendStringWithFormat(&session->outboundBuffer, "HTTP/1.1 200 OK\r\n");
-                } else {
-                    err = HAPIPByteBufferAppendStringWithFormat(
-                            &session->outboundBuffer, "HTTP/1.1 207 Multi-Status\r\n");
+                err = HAPIPAccessoryProtocolBeginJSONMessage(
+                        &session->outboundBuffer,
+                        r == 0 ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 207 Multi-Status\r\n",
+                        &message);
+                if (!err) {
+                    err = HAPIPAccessoryProtocolGetCharacteristicReadResponseBytes(
+                            HAPNonnull(session->server),
+                            server->ip.storage->readContexts,
+                            contexts_count,
+                            &parameters,
+                            &session->outboundBuffer);
                 }
-                HAPAssert(!err);
-                HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
-                if (content_length <= UINT32_MAX) {
-                    err = HAPIPByteBufferAppendStringWithFormat(
-                            &session->outboundBuffer,
-                            "Content-Type: application/hap+json\r\n"
-                            "Content-Length: %lu\r\n\r\n",
-                            (unsigned long) content_length);
-                    HAPAssert(!err);
-                    if (content_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
-                        mark = session->outboundBuffer.position;
-                        err = HAPIPAccessoryProtocolGetCharacteristicReadResponseBytes(
-                                HAPNonnull(session->server),
-                                server->ip.storage->readContexts,
-                                contexts_count,
-                                &parameters,
-                                &session->outboundBuffer);
-                        HAPAssert(!err && (session->outboundBuffer.position - mark == content_length));
-                    } else {
-                        HAPLog(&logObject, "Out of resources (outbound buffer too small).");
-                        session->outboundBuffer.position = mark;
-                        write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-                    }
+                if (!err) {
+                    HAPIPAccessoryProtocolCompleteJSONMessage(&session->outboundBuffer, &message);
                 } else {
-                    HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
+                    HAPAssert(err == kHAPError_OutOfResources);
+                    HAPLog(&logObject, "Out of resources (outbound buffer too small).");
                     session->outboundBuffer.position = mark;
                     write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
                 }
-                HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
             }
         } else if (err == kHAPError_OutOfResources) {
             write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
@@ -2093,6 +2072,101 @@ static void get_accessories(HAPIPSessionDescriptor* session) {
     handle_accessory_serialization(session);
 }
 
+/**
+ * Writes the response to a request on a pairing endpoint into the outbound buffer.
+ *
+ * @param      session              IP session descriptor.
+ * @param      read_hap_pairing_data Function that serializes the response.
+ * @param      pairing_status       Whether the accessory was paired when the request was received.
+ */
+static void write_pairing_data_response(
+        HAPIPSessionDescriptor* session,
+        HAPError (*read_hap_pairing_data)(
+                HAPAccessoryServerRef* p_acc,
+                HAPSessionRef* p_sess,
+                HAPTLVWriterRef* p_writer),
+        bool pairing_status) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+    HAPPrecondition(session->securitySession.type == kHAPIPSecuritySessionType_HAP);
+    HAPPrecondition(session->securitySession.isOpen);
+    HAPPrecondition(read_hap_pairing_data);
+
+    HAPError err;
+
+    int r;
+    uint8_t* p_tlv8_buffer;
+    size_t tlv8_length, mark;
+    HAPTLVWriterRef tlv8_writer;
+
+    char* scratchBuffer = server->ip.storage->scratchBuffer.bytes;
+    size_t maxScratchBufferBytes = server->ip.storage->scratchBuffer.numBytes;
+
+    HAPTLVWriterCreate(&tlv8_writer, scratchBuffer, maxScratchBufferBytes);
+    r = read_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_writer);
+    if (r == 0) {
+        HAPTLVWriterGetBuffer(&tlv8_writer, (void*) &p_tlv8_buffer, &tlv8_length);
+        if (HAPAccessoryServerIsPaired(HAPNonnull(session->server)) != pairing_status) {
+            HAPIPServiceDiscoveryUpdateHAPStatusFlags(
+                    HAPNonnull(session->server), HAPAccessoryServerGetStatusFlags(HAPNonnull(session->server)));
+        }
+        HAPAssert(session->outboundBuffer.data);
+        HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
+        HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
+        mark = session->outboundBuffer.position;
+        HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
+        if (tlv8_length <= UINT32_MAX) {
+            err = HAPIPByteBufferAppendStringWithFormat(
+                    &session->outboundBuffer,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/pairing+tlv8\r\n"
+                    "Content-Length: %lu\r\n\r\n",
+                    (unsigned long) tlv8_length);
+            HAPAssert(!err);
+            if (tlv8_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
+                HAPRawBufferCopyBytes(
+                        &session->outboundBuffer.data[session->outboundBuffer.position], p_tlv8_buffer, tlv8_length);
+                session->outboundBuffer.position += tlv8_length;
+                for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+                    HAPIPSession* ipSession = &server->ip.storage->sessions[i];
+                    HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+                    if (!t->server) {
+                        continue;
+                    }
+
+                    // Other sessions whose pairing has been removed during the pairing session
+                    // need to be closed as soon as possible.
+                    if (t != session && t->state == kHAPIPSessionState_Reading &&
+                        t->securitySession.type == kHAPIPSecuritySessionType_HAP && t->securitySession.isSecured &&
+                        !HAPSessionIsSecured(&t->securitySession._.hap)) {
+                        HAPLogInfo(&logObject, "Closing other session whose pairing has been removed.");
+                        CloseSession(t);
+                    }
+                }
+            } else {
+                HAPLog(&logObject, "Invalid configuration (outbound buffer too small).");
+                session->outboundBuffer.position = mark;
+                write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+            }
+            HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
+        } else {
+            HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
+            session->outboundBuffer.position = mark;
+            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
+        }
+    } else {
+        log_result(
+                kHAPLogType_Error,
+                "error:Function 'read_hap_pairing_data' failed.",
+                r,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+    }
+}
+
 static void handle_pairing_data(
         HAPIPSessionDescriptor* session,
         HAPError (*write_hap_pairing_data)(
@@ -2109,15 +2183,10 @@ static void handle_pairing_data(
     HAPPrecondition(session->securitySession.type == kHAPIPSecuritySessionType_HAP);
     HAPPrecondition(session->securitySession.isOpen);
 
-    HAPError err;
-
     int r;
     bool pairing_status;
-    uint8_t* p_tlv8_buffer;
-    size_t tlv8_length, mark;
     HAPTLVReaderOptions tlv8_reader_init;
     HAPTLVReaderRef tlv8_reader;
-    HAPTLVWriterRef tlv8_writer;
 
     char* scratchBuffer = server->ip.storage->scratchBuffer.bytes;
     size_t maxScratchBufferBytes = server->ip.storage->scratchBuffer.numBytes;
@@ -2142,68 +2211,13 @@ static void handle_pairing_data(
             HAPTLVReaderCreateWithOptions(&tlv8_reader, &tlv8_reader_init);
             r = write_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_reader);
             if (r == 0) {
-                HAPTLVWriterCreate(&tlv8_writer, scratchBuffer, maxScratchBufferBytes);
-                r = read_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_writer);
-                if (r == 0) {
-                    HAPTLVWriterGetBuffer(&tlv8_writer, (void*) &p_tlv8_buffer, &tlv8_length);
-                    if (HAPAccessoryServerIsPaired(HAPNonnull(session->server)) != pairing_status) {
-                        HAPIPServiceDiscoverySetHAPService(HAPNonnull(session->server));
-                    }
-                    HAPAssert(session->outboundBuffer.data);
-                    HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
-                    HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
-                    mark = session->outboundBuffer.position;
-                    HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
-                    if (tlv8_length <= UINT32_MAX) {
-                        err = HAPIPByteBufferAppendStringWithFormat(
-                                &session->outboundBuffer,
-                                "HTTP/1.1 200 OK\r\n"
-                                "Content-Type: application/pairing+tlv8\r\n"
-                                "Content-Length: %lu\r\n\r\n",
-                                (unsigned long) tlv8_length);
-                        HAPAssert(!err);
-                        if (tlv8_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
-                            HAPRawBufferCopyBytes(
-                                    &session->outboundBuffer.data[session->outboundBuffer.position],
-                                    p_tlv8_buffer,
-                                    tlv8_length);
-                            session->outboundBuffer.position += tlv8_length;
-                            for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
-                                HAPIPSession* ipSession = &server->ip.storage->sessions[i];
-                                HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &ipSession->descriptor;
-                                if (!t->server) {
-                                    continue;
-                                }
-
-                                // Other sessions whose pairing has been removed during the pairing session
-                                // need to be closed as soon as possible.
-                                if (t != session && t->state == kHAPIPSessionState_Reading &&
-                                    t->securitySession.type == kHAPIPSecuritySessionType_HAP &&
-                                    t->securitySession.isSecured && !HAPSessionIsSecured(&t->securitySession._.hap)) {
-                                    HAPLogInfo(&logObject, "Closing other session whose pairing has been removed.");
-                                    CloseSession(t);
-                                }
-                            }
-                        } else {
-                            HAPLog(&logObject, "Invalid configuration (outbound buffer too small).");
-                            session->outboundBuffer.position = mark;
-                            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
-                        }
-                        HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
-                    } else {
-                        HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
-                        session->outboundBuffer.position = mark;
-                        write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-                    }
+                if (HAPPairingCryptoJobIsPending(&session->securitySession._.hap)) {
+                    // Response is written once the pairing cryptography job has completed.
+                    HAPLogDebug(&logObject, "session:%p:deferring pairing response", (const void*) session);
+                    session->pendingPairingResponse.readPairingData = read_hap_pairing_data;
+                    session->pendingPairingResponse.wasPaired = pairing_status;
                 } else {
-                    log_result(
-                            kHAPLogType_Error,
-                            "error:Function 'read_hap_pairing_data' failed.",
-                            r,
-                            __func__,
-                            HAP_FILE,
-                            __LINE__);
-                    write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+                    write_pairing_data_response(session, read_hap_pairing_data, pairing_status);
                 }
             } else {
                 write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2857,12 +2871,54 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
     }
 }
 
+/**
+ * Prepares the outbound buffer of an IP session for writing the response to the current request.
+ *
+ * - The response is encrypted if the session is secured.
+ *
+ * @param      session              IP session descriptor.
+ */
+static void prepare_writing_response(HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+
+    size_t encrypted_length;
+    HAPAssert(session->outboundBuffer.data);
+    HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
+    HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
+    HAPIPByteBufferFlip(&session->outboundBuffer);
+    HAPLogBufferDebug(
+            &logObject,
+            session->outboundBuffer.data,
+            session->outboundBuffer.limit,
+            "session:%p:<",
+            (const void*) session);
+
+    if (session->securitySession.type == kHAPIPSecuritySessionType_HAP && session->securitySession.isSecured) {
+        encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
+                session->outboundBuffer.limit - session->outboundBuffer.position);
+        if (encrypted_length > session->outboundBuffer.capacity - session->outboundBuffer.position) {
+            HAPLog(&logObject, "Out of resources (outbound buffer too small).");
+            session->outboundBuffer.limit = session->outboundBuffer.capacity;
+            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
+            HAPIPByteBufferFlip(&session->outboundBuffer);
+            encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
+                    session->outboundBuffer.limit - session->outboundBuffer.position);
+            HAPAssert(encrypted_length <= session->outboundBuffer.capacity - session->outboundBuffer.position);
+        }
+        HAPIPSecurityProtocolEncryptData(
+                HAPNonnull(session->server), &session->securitySession._.hap, &session->outboundBuffer);
+        HAPAssert(encrypted_length == session->outboundBuffer.limit - session->outboundBuffer.position);
+    }
+    session->state = kHAPIPSessionState_Writing;
+}
+
 static void handle_http(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session);
     HAPPrecondition(session->server);
     HAPPrecondition(session->securitySession.isOpen);
 
-    size_t content_length, encrypted_length;
+    size_t content_length;
     HAPAssert(session->inboundBuffer.data);
     HAPAssert(session->inboundBuffer.position <= session->inboundBuffer.limit);
     HAPAssert(session->inboundBuffer.limit <= session->inboundBuffer.capacity);
@@ -2890,35 +2946,11 @@ static void handle_http(HAPIPSessionDescriptor* session) {
             HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
             HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
             HAPAssert(session->state == kHAPIPSessionState_Writing);
-        } else {
-            HAPAssert(session->outboundBuffer.data);
-            HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
-            HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
-            HAPIPByteBufferFlip(&session->outboundBuffer);
-            HAPLogBufferDebug(
-                    &logObject,
-                    session->outboundBuffer.data,
-                    session->outboundBuffer.limit,
-                    "session:%p:<",
-                    (const void*) session);
-
-            if (session->securitySession.type == kHAPIPSecuritySessionType_HAP && session->securitySession.isSecured) {
-                encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
-                        session->outboundBuffer.limit - session->outboundBuffer.position);
-                if (encrypted_length > session->outboundBuffer.capacity - session->outboundBuffer.position) {
-                    HAPLog(&logObject, "Out of resources (outbound buffer too small).");
-                    session->outboundBuffer.limit = session->outboundBuffer.capacity;
-                    write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-                    HAPIPByteBufferFlip(&session->outboundBuffer);
-                    encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
-                            session->outboundBuffer.limit - session->outboundBuffer.position);
-                    HAPAssert(encrypted_length <= session->outboundBuffer.capacity - session->outboundBuffer.position);
-                }
-                HAPIPSecurityProtocolEncryptData(
-                        HAPNonnull(session->server), &session->securitySession._.hap, &session->outboundBuffer);
-                HAPAssert(encrypted_length == session->outboundBuffer.limit - session->outboundBuffer.position);
-            }
+        } else if (session->pendingPairingResponse.readPairingData) {
+            // Response is prepared for writing once the pairing cryptography job has completed.
             session->state = kHAPIPSessionState_Writing;
+        } else {
+            prepare_writing_response(session);
         }
     }
 }
@@ -3262,7 +3294,7 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
     HAPError err;
 
     if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
-        HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+        HAPTime clock_now_ms = HAPPlatformClockGetCurrentCoarse();
         HAPAssert(clock_now_ms >= session->eventNotificationStamp);
         HAPTime dt_ms = clock_now_ms - session->eventNotificationStamp;
 
@@ -3338,32 +3370,24 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
                     &data_buffer);
             (void) r;
 
-            size_t content_length = HAPIPAccessoryProtocolGetNumEventNotificationBytes(
-                    HAPNonnull(session->server), server->ip.storage->readContexts, numReadContexts);
-
             HAPAssert(session->outboundBuffer.data);
             HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
             HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
             size_t mark = session->outboundBuffer.position;
-            err = HAPIPByteBufferAppendStringWithFormat(
-                    &session->outboundBuffer,
-                    "EVENT/1.0 200 OK\r\n"
-                    "Content-Type: application/hap+json\r\n"
-                    "Content-Length: %zu\r\n\r\n",
-                    content_length);
+            HAPIPAccessoryProtocolJSONMessage message;
+            err = HAPIPAccessoryProtocolBeginJSONMessage(&session->outboundBuffer, "EVENT/1.0 200 OK\r\n", &message);
             if (err) {
                 HAPAssert(err == kHAPError_OutOfResources);
                 HAPLog(&logObject, "Invalid configuration (outbound buffer too small).");
                 HAPFatalError();
             }
-            if (content_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
-                mark = session->outboundBuffer.position;
-                err = HAPIPAccessoryProtocolGetEventNotificationBytes(
-                        HAPNonnull(session->server),
-                        server->ip.storage->readContexts,
-                        numReadContexts,
-                        &session->outboundBuffer);
-                HAPAssert(!err && (session->outboundBuffer.position - mark == content_length));
+            err = HAPIPAccessoryProtocolGetEventNotificationBytes(
+                    HAPNonnull(session->server),
+                    server->ip.storage->readContexts,
+                    numReadContexts,
+                    &session->outboundBuffer);
+            if (!err) {
+                HAPIPAccessoryProtocolCompleteJSONMessage(&session->outboundBuffer, &message);
                 HAPIPByteBufferFlip(&session->outboundBuffer);
                 HAPLogBufferDebug(
                         &logObject,
@@ -3399,6 +3423,7 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
                             session);
                 }
             } else {
+                HAPAssert(err == kHAPError_OutOfResources);
                 HAPLog(&logObject, "Skipping event notifications (outbound buffer too small).");
                 session->outboundBuffer.position = mark;
             }
@@ -3413,7 +3438,7 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
             }
         }
         HAPAssert(session->numEventNotificationFlags == 0);
-        session->eventNotificationStamp = HAPPlatformClockGetCurrent();
+        session->eventNotificationStamp = HAPPlatformClockGetCurrentCoarse();
     }
 }
 
@@ -3434,9 +3459,13 @@ static void handle_io_progression(HAPIPSessionDescriptor* session) {
         }
     }
     if (session->tcpStreamIsOpen) {
+        // While a pairing response is deferred, the session waits for the pairing cryptography job to complete.
+        bool isResponseDeferred = session->pendingPairingResponse.readPairingData != NULL;
         HAPPlatformTCPStreamEvent interests = { .hasBytesAvailable = (session->state == kHAPIPSessionState_Reading),
-                                                .hasSpaceAvailable = (session->state == kHAPIPSessionState_Writing) };
-        if ((session->state == kHAPIPSessionState_Reading) || (session->state == kHAPIPSessionState_Writing)) {
+                                                .hasSpaceAvailable = (session->state == kHAPIPSessionState_Writing) &&
+                                                                     !isResponseDeferred };
+        if (!isResponseDeferred &&
+            ((session->state == kHAPIPSessionState_Reading) || (session->state == kHAPIPSessionState_Writing))) {
             HAPPlatformTCPStreamUpdateInterests(
                     HAPNonnull(server->platform.ip.tcpStreamManager),
                     session->tcpStream,
@@ -3609,7 +3638,7 @@ static void HandleTCPStreamEvent(
     HAPAssert(session->tcpStream == tcpStream);
     HAPAssert(session->tcpStreamIsOpen);
 
-    HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+    HAPTime clock_now_ms = HAPPlatformClockGetCurrentCoarse();
 
     if (event.hasBytesAvailable) {
         HAPAssert(!event.hasSpaceAvailable);
@@ -3628,6 +3657,157 @@ static void HandleTCPStreamEvent(
     }
 }
 
+/**
+ * Returns whether an IP session has completed Pair Verify.
+ *
+ * - The security session is only marked as secured once the first encrypted request has been received.
+ *   Sessions that have completed Pair Verify but have not sent a request yet are secured as well.
+ *
+ * @param      session              IP session.
+ *
+ * @return true                     If the IP session is secured.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsSessionSecured(const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+
+    if (session->securitySession.isSecured) {
+        return true;
+    }
+    return session->securitySession.isOpen && session->securitySession.type == kHAPIPSecuritySessionType_HAP &&
+           HAPSessionIsSecured(&session->securitySession._.hap);
+}
+
+/**
+ * Returns the number of IP sessions that are secured for the same controller as a given IP session.
+ *
+ * @param      server_              Accessory server.
+ * @param      session              Secured IP session.
+ *
+ * @return Number of IP sessions of the controller, including the given IP session.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumControllerSessions(HAPAccessoryServerRef* server_, const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session);
+    HAPPrecondition(IsSessionSecured(session));
+
+    if (session->securitySession.type != kHAPIPSecuritySessionType_HAP) {
+        return 1;
+    }
+    int pairingID = ((const HAPSession*) &session->securitySession._.hap)->hap.pairingID;
+    if (pairingID < 0) {
+        // Transient sessions do not belong to a pairing.
+        return 1;
+    }
+
+    size_t numSessions = 0;
+    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+        const HAPIPSessionDescriptor* t =
+                (const HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
+        if (t->server && t->state != kHAPIPSessionState_Idle && IsSessionSecured(t) &&
+            t->securitySession.type == kHAPIPSecuritySessionType_HAP &&
+            ((const HAPSession*) &t->securitySession._.hap)->hap.pairingID == pairingID) {
+            numSessions++;
+        }
+    }
+    HAPAssert(numSessions);
+    return numSessions;
+}
+
+/**
+ * Selects the IP session to evict to admit a new connection while all IP sessions are in use.
+ *
+ * - IP sessions that have already been closed are selected first, followed by the least recently active IP session
+ *   that is not secured. Secured IP sessions are selected if their controller has more than
+ *   maxSessionsPerController IP sessions, and otherwise if they have been idle for at least evictionIdleDuration.
+ *
+ * @param      server_              Accessory server.
+ *
+ * @return IP session to evict, if available. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPSession* _Nullable SelectSessionForEviction(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
+    HAPIPSession* _Nullable victim = NULL;
+    int victimRank = 0;
+    size_t victimNumControllerSessions = 0;
+    HAPTime victimStamp = 0;
+    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+        HAPIPSession* ipSession = &server->ip.storage->sessions[i];
+        const HAPIPSessionDescriptor* session = (const HAPIPSessionDescriptor*) &ipSession->descriptor;
+        if (!session->server) {
+            continue;
+        }
+
+        int rank;
+        size_t numControllerSessions = 0;
+        if (session->state == kHAPIPSessionState_Idle) {
+            rank = 0;
+        } else if (session->state != kHAPIPSessionState_Reading || session->inboundBuffer.position != 0) {
+            // Request in progress.
+            continue;
+        } else if (!IsSessionSecured(session)) {
+            rank = 1;
+        } else {
+            size_t maxSessionsPerController = server->ip.storage->maxSessionsPerController;
+            bool isLimited = maxSessionsPerController != kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController;
+            if (isLimited) {
+                numControllerSessions = GetNumControllerSessions(server_, session);
+            }
+            HAPAssert(now >= session->stamp);
+            if (isLimited && numControllerSessions > maxSessionsPerController) {
+                rank = 2;
+            } else if (
+                    server->ip.storage->evictionIdleDuration &&
+                    now - session->stamp >= server->ip.storage->evictionIdleDuration) {
+                // Idle sessions are ordered by their last activity only.
+                numControllerSessions = 0;
+                rank = 3;
+            } else {
+                continue;
+            }
+        }
+
+        if (!victim || rank < victimRank ||
+            (rank == victimRank && (numControllerSessions > victimNumControllerSessions ||
+                                    (numControllerSessions == victimNumControllerSessions &&
+                                     session->stamp < victimStamp)))) {
+            victim = ipSession;
+            victimRank = rank;
+            victimNumControllerSessions = numControllerSessions;
+            victimStamp = session->stamp;
+        }
+    }
+    return victim;
+}
+
+/**
+ * Closes and releases an IP session so that it can serve a new connection.
+ *
+ * @param      ipSession            IP session to evict.
+ */
+static void EvictSession(HAPIPSession* ipSession) {
+    HAPPrecondition(ipSession);
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+    HAPPrecondition(session->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+
+    HAPLogInfo(&logObject, "session:%p:evicting session to admit new connection", (const void*) session);
+
+    if (session->state != kHAPIPSessionState_Idle) {
+        CloseSession(session);
+    }
+    HAPIPSessionDestroy(ipSession);
+    HAPAssert(server->ip.numSessions > 0);
+    server->ip.numSessions--;
+}
+
 static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManager, void* _Nullable context) {
     HAPPrecondition(context);
     HAPAccessoryServerRef* server_ = context;
@@ -3638,6 +3818,10 @@ static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManag
 
     HAPPlatformTCPStreamRef tcpStream;
     err = HAPPlatformTCPStreamManagerAcceptTCPStream(HAPNonnull(server->platform.ip.tcpStreamManager), &tcpStream);
+    if (err == kHAPError_Busy) {
+        // The accept queue has been drained.
+        return;
+    }
     if (err) {
         log_result(
                 kHAPLogType_Error,
@@ -3649,16 +3833,20 @@ static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManag
         return;
     }
 
-    // Find free IP session.
-    HAPIPSession* ipSession = NULL;
-    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
-        HAPIPSessionDescriptor* descriptor = (HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
-        if (!descriptor->server) {
-            ipSession = &server->ip.storage->sessions[i];
-            break;
+    // Take free IP session.
+    if (!server->ip.freeSessions &&
+        server->ip.storage->admissionPolicy == kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive) {
+        HAPIPSession* _Nullable victim = SelectSessionForEviction(server_);
+        if (victim) {
+            EvictSession(HAPNonnull(victim));
         }
     }
-    if (!ipSession) {
+    HAPIPSession* ipSession = server->ip.freeSessions;
+    if (ipSession) {
+        HAPIPSessionDescriptor* descriptor = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+        HAPAssert(!descriptor->server);
+        server->ip.freeSessions = descriptor->nextFreeSession;
+    } else {
         HAPLog(&logObject,
                "Failed to allocate session."
                " (Number of supported accessory server sessions should be consistent with"
@@ -3673,7 +3861,7 @@ static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManag
     t->tcpStream = tcpStream;
     t->tcpStreamIsOpen = true;
     t->state = kHAPIPSessionState_Idle;
-    t->stamp = HAPPlatformClockGetCurrent();
+    t->stamp = HAPPlatformClockGetCurrentCoarse();
     t->securitySession.isOpen = false;
     t->securitySession.isSecured = false;
     t->inboundBuffer.position = 0;
@@ -4069,6 +4257,9 @@ static void Create(HAPAccessoryServerRef* server_, const HAPAccessoryServerOptio
     HAPPrecondition(storage->scratchBuffer.bytes);
     HAPPrecondition(storage->sessions);
     HAPPrecondition(storage->numSessions);
+    HAPPrecondition(
+            storage->admissionPolicy == kHAPIPSessionAdmissionPolicy_Refuse ||
+            storage->admissionPolicy == kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive);
     for (size_t i = 0; i < storage->numSessions; i++) {
         HAPIPSession* session = &storage->sessions[i];
         HAPPrecondition(session->inboundBuffer.bytes);
@@ -4101,7 +4292,8 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
     HAPRawBufferZero(storage->readContexts, storage->numReadContexts * sizeof *storage->readContexts);
     HAPRawBufferZero(storage->writeContexts, storage->numWriteContexts * sizeof *storage->writeContexts);
     HAPRawBufferZero(storage->scratchBuffer.bytes, storage->scratchBuffer.numBytes);
-    for (size_t i = 0; i < storage->numSessions; i++) {
+    server->ip.freeSessions = NULL;
+    for (size_t i = storage->numSessions; i-- > 0;) {
         HAPIPSession* ipSession = &storage->sessions[i];
         HAPRawBufferZero(&ipSession->descriptor, sizeof ipSession->descriptor);
         HAPRawBufferZero(ipSession->inboundBuffer.bytes, ipSession->inboundBuffer.numBytes);
@@ -4109,6 +4301,11 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
         HAPRawBufferZero(
                 ipSession->eventNotifications,
                 ipSession->numEventNotifications * sizeof *ipSession->eventNotifications);
+
+        // Sessions are handed out in storage order.
+        HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+        session->nextFreeSession = server->ip.freeSessions;
+        server->ip.freeSessions = ipSession;
     }
 }
 
@@ -4125,6 +4322,42 @@ static void HAPSessionInvalidateDependentIPState(HAPAccessoryServerRef* server_,
     HAPPrecondition(session);
 }
 
+/**
+ * Writes the deferred response of the IP session for which a pairing cryptography job has completed.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session for which the pairing cryptography job has completed.
+ */
+static void HandlePairingCryptoJobCompleted(HAPAccessoryServerRef* server_, HAPSessionRef* session_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+
+    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+        HAPIPSession* ipSession = &server->ip.storage->sessions[i];
+        HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+        if (!session->server || session->state == kHAPIPSessionState_Idle ||
+            session->securitySession.type != kHAPIPSecuritySessionType_HAP || !session->securitySession.isOpen ||
+            &session->securitySession._.hap != session_) {
+            continue;
+        }
+        if (!session->pendingPairingResponse.readPairingData) {
+            return;
+        }
+        HAPAssert(session->state == kHAPIPSessionState_Writing);
+
+        HAPLogDebug(&logObject, "session:%p:writing deferred pairing response", (const void*) session);
+        HAPError (*readPairingData)(HAPAccessoryServerRef*, HAPSessionRef*, HAPTLVWriterRef*) =
+                HAPNonnull(session->pendingPairingResponse.readPairingData);
+        bool wasPaired = session->pendingPairingResponse.wasPaired;
+        HAPRawBufferZero(&session->pendingPairingResponse, sizeof session->pendingPairingResponse);
+        write_pairing_data_response(session, readPairingData, wasPaired);
+        prepare_writing_response(session);
+        handle_io_progression(session);
+        return;
+    }
+}
+
 static const HAPAccessoryServerServerEngine* _Nullable _serverEngine;
 
 static void HAPAccessoryServerInstallServerEngine(void) {
@@ -4146,7 +4379,8 @@ const HAPIPAccessoryServerTransport kHAPAccessoryServerTransport_IP = {
     .prepareStart = PrepareStart,
     .willStart = WillStart,
     .prepareStop = PrepareStop,
-    .session = { .invalidateDependentIPState = HAPSessionInvalidateDependentIPState },
+    .session = { .invalidateDependentIPState = HAPSessionInvalidateDependentIPState,
+                 .handlePairingCryptoJobCompleted = HandlePairingCryptoJobCompleted },
     .serverEngine = { .install = HAPAccessoryServerInstallServerEngine,
                       .uninstall = HAPAccessoryServerUninstallServerEngine,
                       .get = HAPAccessoryServerGetServerEngine }
@@ -54,6 +54,8 @@ struct HAPIPAccessoryServerTransport {
 
     struct {
         void (*invalidateDependentIPState)(HAPAccessoryServerRef* server_, HAPSessionRef* session);
+
+        void (*handlePairingCryptoJobCompleted)(HAPAccessoryServerRef* server_, HAPSessionRef* session);
     } session;
 
     struct {
@@ -327,6 +329,29 @@ typedef struct {
      * Flag indicating whether incremental serialization of accessory attribute database is in progress.
      */
     bool accessorySerializationIsInProgress;
+
+    /**
+     * Response to a request on a pairing endpoint that is deferred until a pairing cryptography job has completed.
+     */
+    struct {
+        /**
+         * Function that serializes the response. NULL if no response is pending.
+         */
+        HAPError (*_Nullable readPairingData)(
+                HAPAccessoryServerRef* server,
+                HAPSessionRef* session,
+                HAPTLVWriterRef* responseWriter);
+
+        /**
+         * Flag indicating whether the accessory was paired when the request was received.
+         */
+        bool wasPaired;
+    } pendingPairingResponse;
+
+    /**
+     * Next IP session in the list of free IP sessions. Only used while the IP session is not in use.
+     */
+    HAPIPSession* _Nullable nextFreeSession;
 } HAPIPSessionDescriptor;
 HAP_STATIC_ASSERT(sizeof(HAPIPSessionDescriptorRef) >= sizeof(HAPIPSessionDescriptor), HAPIPSessionDescriptor);
 
@@ -53,19 +53,69 @@ static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .categor
 /** Number of TXT Record keys for _hap service. */
 #define kHAPTXTRecordKey_NumKeys (9)
 
-void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
-    HAPPrecondition(server_);
-    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
-    HAPPrecondition(
-            !server->ip.discoverableService || server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
+HAP_STATIC_ASSERT(
+        sizeof(((HAPIPServiceDiscoveryTXTRecordCache*) NULL)->setupHashBytes) ==
+                util_base64_encoded_len(sizeof(HAPAccessorySetupSetupHash)) + 1,
+        HAPIPServiceDiscoveryTXTRecordCache_SetupHashBytes);
 
-    HAPError err;
+/**
+ * Returns the TXT records of the _hap service, based on the cached values.
+ *
+ * @param      server               Accessory server.
+ * @param[out] txtRecords           TXT records.
+ *
+ * @return Number of TXT records.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetHAPTXTRecords(
+        HAPAccessoryServer* server,
+        HAPPlatformServiceDiscoveryTXTRecord txtRecords[kHAPTXTRecordKey_NumKeys]) {
+    HAPPrecondition(server);
+    HAPPrecondition(txtRecords);
+    const HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
 
     // See HomeKit Accessory Protocol Specification R14
     // Section 6.4 Discovery
 
-    HAPPlatformServiceDiscoveryTXTRecord txtRecords[kHAPTXTRecordKey_NumKeys];
     size_t numTXTRecords = 0;
+#define APPEND_TXT_RECORD(key_, bytes_) \
+    do { \
+        HAPAssert(numTXTRecords < kHAPTXTRecordKey_NumKeys); \
+        txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) { \
+            .key = (key_), .value = { .bytes = (bytes_), .numBytes = HAPStringGetNumBytes(bytes_) } \
+        }; \
+    } while (0)
+
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_ConfigurationNumber, cache->configurationNumberBytes);
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_PairingFeatureFlags, cache->pairingFeatureFlagsBytes);
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_DeviceID, cache->deviceIDString.stringValue);
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_Model, server->primaryAccessory->model);
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_ProtocolVersion, kHAPShortProtocolVersion_IP);
+
+    // Current state number. Must always be set to 1 for IP.
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_StateNumber, "1");
+
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_StatusFlags, cache->statusFlagsBytes);
+    APPEND_TXT_RECORD(kHAPTXTRecordKey_Category, cache->categoryBytes);
+
+    // Setup hash. Optional.
+    if (cache->hasSetupHash) {
+        APPEND_TXT_RECORD(kHAPTXTRecordKey_SetupHash, cache->setupHashBytes);
+    }
+
+#undef APPEND_TXT_RECORD
+    return numTXTRecords;
+}
+
+void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(!server->ip.discoverableService);
+    HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
+
+    HAPError err;
+
+    HAPRawBufferZero(cache, sizeof *cache);
 
     // Configuration number.
     uint16_t configurationNumber;
@@ -74,126 +124,139 @@ void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
         HAPAssert(err == kHAPError_Unknown);
         HAPFatalError();
     }
-    char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(configurationNumber, configurationNumberBytes, sizeof configurationNumberBytes);
+    err = HAPUInt64GetDescription(
+            configurationNumber, cache->configurationNumberBytes, sizeof cache->configurationNumberBytes);
     HAPAssert(!err);
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-        .key = kHAPTXTRecordKey_ConfigurationNumber,
-        .value = { .bytes = configurationNumberBytes, .numBytes = HAPStringGetNumBytes(configurationNumberBytes) }
-    };
 
     // Pairing Feature flags.
     uint8_t pairingFeatureFlags = HAPAccessoryServerGetPairingFeatureFlags(server_);
-    char pairingFeatureFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(pairingFeatureFlags, pairingFeatureFlagsBytes, sizeof pairingFeatureFlagsBytes);
+    err = HAPUInt64GetDescription(
+            pairingFeatureFlags, cache->pairingFeatureFlagsBytes, sizeof cache->pairingFeatureFlagsBytes);
     HAPAssert(!err);
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-        .key = kHAPTXTRecordKey_PairingFeatureFlags,
-        .value = { .bytes = pairingFeatureFlagsBytes, .numBytes = HAPStringGetNumBytes(pairingFeatureFlagsBytes) }
-    };
 
     // Device ID.
-    HAPDeviceIDString deviceIDString;
-    err = HAPDeviceIDGetAsString(server->platform.keyValueStore, &deviceIDString);
+    err = HAPDeviceIDGetAsString(server->platform.keyValueStore, &cache->deviceIDString);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         HAPFatalError();
     }
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-        .key = kHAPTXTRecordKey_DeviceID,
-        .value = { .bytes = deviceIDString.stringValue, .numBytes = HAPStringGetNumBytes(deviceIDString.stringValue) }
-    };
-
-    // Model.
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-        .key = kHAPTXTRecordKey_Model,
-        .value = { .bytes = server->primaryAccessory->model,
-                   .numBytes = HAPStringGetNumBytes(server->primaryAccessory->model) }
-    };
-
-    // Protocol version.
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-        .key = kHAPTXTRecordKey_ProtocolVersion,
-        .value = { .bytes = kHAPShortProtocolVersion_IP, .numBytes = HAPStringGetNumBytes(kHAPShortProtocolVersion_IP) }
-    };
-
-    // Current state number. Must always be set to 1 for IP.
-    const char* stateNumberBytes = "1";
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] =
-            (HAPPlatformServiceDiscoveryTXTRecord) { .key = kHAPTXTRecordKey_StateNumber,
-                                                     .value = { .bytes = stateNumberBytes,
-                                                                .numBytes = HAPStringGetNumBytes(stateNumberBytes) } };
 
     // Status flags.
-    uint8_t statusFlags = HAPAccessoryServerGetStatusFlags(server_);
-    char statusFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(statusFlags, statusFlagsBytes, sizeof statusFlagsBytes);
+    cache->statusFlags = HAPAccessoryServerGetStatusFlags(server_);
+    err = HAPUInt64GetDescription(cache->statusFlags, cache->statusFlagsBytes, sizeof cache->statusFlagsBytes);
     HAPAssert(!err);
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] =
-            (HAPPlatformServiceDiscoveryTXTRecord) { .key = kHAPTXTRecordKey_StatusFlags,
-                                                     .value = { .bytes = statusFlagsBytes,
-                                                                .numBytes = HAPStringGetNumBytes(statusFlagsBytes) } };
 
     // Category.
-    char categoryBytes[kHAPUInt16_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(server->primaryAccessory->category, categoryBytes, sizeof categoryBytes);
+    err = HAPUInt64GetDescription(
+            server->primaryAccessory->category, cache->categoryBytes, sizeof cache->categoryBytes);
     HAPAssert(!err);
-    HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] =
-            (HAPPlatformServiceDiscoveryTXTRecord) { .key = kHAPTXTRecordKey_Category,
-                                                     .value = { .bytes = categoryBytes,
-                                                                .numBytes = HAPStringGetNumBytes(categoryBytes) } };
 
     // Setup hash. Optional.
     HAPSetupID setupID;
     bool hasSetupID = false;
     HAPPlatformAccessorySetupLoadSetupID(server->platform.accessorySetup, &hasSetupID, &setupID);
-    char setupHashBytes[util_base64_encoded_len(sizeof(HAPAccessorySetupSetupHash)) + 1];
     if (hasSetupID) {
         // Get raw setup hash from setup ID.
         HAPAccessorySetupSetupHash setupHash;
-        HAPAccessorySetupGetSetupHash(&setupHash, &setupID, &deviceIDString);
+        HAPAccessorySetupGetSetupHash(&setupHash, &setupID, &cache->deviceIDString);
 
         // Base64 encode.
         size_t numSetupHashBytes;
         util_base64_encode(
-                setupHash.bytes, sizeof setupHash.bytes, setupHashBytes, sizeof setupHashBytes, &numSetupHashBytes);
-        HAPAssert(numSetupHashBytes == sizeof setupHashBytes - 1);
-        setupHashBytes[sizeof setupHashBytes - 1] = '\0';
-
-        // Append TXT record.
-        HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-        txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
-            .key = kHAPTXTRecordKey_SetupHash,
-            .value = { .bytes = setupHashBytes, .numBytes = HAPStringGetNumBytes(setupHashBytes) }
-        };
+                setupHash.bytes,
+                sizeof setupHash.bytes,
+                cache->setupHashBytes,
+                sizeof cache->setupHashBytes,
+                &numSetupHashBytes);
+        HAPAssert(numSetupHashBytes == sizeof cache->setupHashBytes - 1);
+        cache->setupHashBytes[sizeof cache->setupHashBytes - 1] = '\0';
+        cache->hasSetupHash = true;
     }
 
     // Register service.
-    HAPAssert(numTXTRecords <= HAPArrayCount(txtRecords));
-    if (!server->ip.discoverableService) {
-        server->ip.discoverableService = kHAPIPServiceDiscoveryType_HAP;
-        HAPLogInfo(&logObject, "Registering %s service.", kServiceDiscoveryProtocol_HAP);
-        HAPPlatformServiceDiscoveryRegister(
-                HAPNonnull(server->platform.ip.serviceDiscovery),
-                server->primaryAccessory->name,
-                kServiceDiscoveryProtocol_HAP,
-                HAPPlatformTCPStreamManagerGetListenerPort(HAPNonnull(server->platform.ip.tcpStreamManager)),
-                txtRecords,
-                numTXTRecords);
-    } else {
-        HAPAssert(server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
-        HAPLogInfo(&logObject, "Updating %s service.", kServiceDiscoveryProtocol_HAP);
-        HAPPlatformServiceDiscoveryUpdateTXTRecords(
-                HAPNonnull(server->platform.ip.serviceDiscovery), txtRecords, numTXTRecords);
+    HAPPlatformServiceDiscoveryTXTRecord txtRecords[kHAPTXTRecordKey_NumKeys];
+    size_t numTXTRecords = GetHAPTXTRecords(server, txtRecords);
+    server->ip.discoverableService = kHAPIPServiceDiscoveryType_HAP;
+    HAPLogInfo(&logObject, "Registering %s service.", kServiceDiscoveryProtocol_HAP);
+    HAPPlatformServiceDiscoveryRegister(
+            HAPNonnull(server->platform.ip.serviceDiscovery),
+            server->primaryAccessory->name,
+            kServiceDiscoveryProtocol_HAP,
+            HAPPlatformTCPStreamManagerGetListenerPort(HAPNonnull(server->platform.ip.tcpStreamManager)),
+            txtRecords,
+            numTXTRecords);
+}
+
+/**
+ * Pushes the cached TXT records of the _hap service to the platform.
+ *
+ * @param      server               Accessory server.
+ */
+static void UpdateHAPTXTRecords(HAPAccessoryServer* server) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
+
+    HAPPlatformServiceDiscoveryTXTRecord txtRecords[kHAPTXTRecordKey_NumKeys];
+    size_t numTXTRecords = GetHAPTXTRecords(server, txtRecords);
+    HAPLogInfo(&logObject, "Updating %s service.", kServiceDiscoveryProtocol_HAP);
+    HAPPlatformServiceDiscoveryUpdateTXTRecords(
+            HAPNonnull(server->platform.ip.serviceDiscovery), txtRecords, numTXTRecords);
+}
+
+static void HandleTXTRecordUpdateTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPAccessoryServer* server = context;
+    HAPPrecondition(timer == server->ip.txtRecordCache.updateTimer);
+    server->ip.txtRecordCache.updateTimer = 0;
+
+    UpdateHAPTXTRecords(server);
+}
+
+/**
+ * Schedules pushing the cached TXT records of the _hap service to the platform.
+ *
+ * - If an update is already scheduled, the changes are included in that update.
+ *
+ * @param      server               Accessory server.
+ */
+static void ScheduleHAPTXTRecordUpdate(HAPAccessoryServer* server) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
+    HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
+
+    HAPError err;
+
+    if (cache->updateTimer) {
+        return;
     }
+    err = HAPPlatformTimerRegister(
+            &cache->updateTimer,
+            HAPPlatformClockGetCurrentCoarse() + kHAPIPServiceDiscovery_TXTRecordUpdateDelay,
+            HandleTXTRecordUpdateTimerExpired,
+            server);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Not enough resources to schedule TXT record update. Updating immediately.");
+        cache->updateTimer = 0;
+        UpdateHAPTXTRecords(server);
+    }
+}
+
+void HAPIPServiceDiscoveryUpdateHAPStatusFlags(HAPAccessoryServerRef* server_, uint8_t statusFlags) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
+    HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
+
+    HAPError err;
+
+    if (statusFlags == cache->statusFlags) {
+        return;
+    }
+    cache->statusFlags = statusFlags;
+    err = HAPUInt64GetDescription(statusFlags, cache->statusFlagsBytes, sizeof cache->statusFlagsBytes);
+    HAPAssert(!err);
+    ScheduleHAPTXTRecordUpdate(server);
 }
 
 /**
@@ -321,6 +384,10 @@ void HAPIPServiceDiscoveryStop(HAPAccessoryServerRef* server_) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
 
+    if (server->ip.txtRecordCache.updateTimer) {
+        HAPPlatformTimerDeregister(server->ip.txtRecordCache.updateTimer);
+        server->ip.txtRecordCache.updateTimer = 0;
+    }
     if (server->ip.discoverableService) {
         HAPLogInfo(&logObject, "Stopping service discovery.");
         HAPPlatformServiceDiscoveryStop(HAPNonnull(server->platform.ip.serviceDiscovery));
@@ -37,14 +37,70 @@ HAP_ENUM_BEGIN(uint8_t, HAPIPServiceDiscoveryType) { /**
 } HAP_ENUM_END(uint8_t, HAPIPServiceDiscoveryType);
 
 /**
- * Registers or updates the Bonjour records for the _hap service.
+ * Delay after which pending TXT record updates of the _hap service are pushed to the platform.
+ *
+ * - Updates that occur within this window are coalesced into a single TXT record update.
+ */
+#define kHAPIPServiceDiscovery_TXTRecordUpdateDelay ((HAPTime)(100 * HAPMillisecond))
+
+/**
+ * Encoded TXT record values of the _hap service.
+ *
+ * - Values are encoded when the service is registered. Updates only re-encode the values that changed
+ *   and do not access the key-value store.
+ */
+typedef struct {
+    /** Status flags. */
+    uint8_t statusFlags;
+
+    /** Whether a setup hash is advertised. */
+    bool hasSetupHash;
+
+    /** Timer that on expiry pushes pending TXT record changes to the platform. 0 if no changes are pending. */
+    HAPPlatformTimerRef updateTimer;
+
+    /** Encoded configuration number. */
+    char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
+
+    /** Encoded pairing feature flags. */
+    char pairingFeatureFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+
+    /** Encoded status flags. */
+    char statusFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+
+    /** Encoded category. */
+    char categoryBytes[kHAPUInt16_MaxDescriptionBytes];
+
+    /** Device ID. */
+    HAPDeviceIDString deviceIDString;
+
+    /** Base64 encoded setup hash. */
+    char setupHashBytes[8 + 1];
+} HAPIPServiceDiscoveryTXTRecordCache;
+
+/**
+ * Registers the Bonjour records for the _hap service.
  *
  * - Only one service may be active at a time. To switch services, first stop Bonjour service discovery.
  *
+ * - TXT record values are cached. Use HAPIPServiceDiscoveryUpdateHAPStatusFlags to update the status flags while
+ *   the service is registered. The configuration number only changes when the accessory server is started.
+ *
  * @param      server               Accessory server.
  */
 void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server);
 
+/**
+ * Updates the status flags that are advertised by the _hap service.
+ *
+ * - The TXT records are pushed to the platform after kHAPIPServiceDiscovery_TXTRecordUpdateDelay.
+ *   Has no effect if the status flags did not change.
+ *
+ * @param      server               Accessory server.
+ * @param      statusFlags          Status flags.
+ */
+void HAPIPServiceDiscoveryUpdateHAPStatusFlags(HAPAccessoryServerRef* server, uint8_t statusFlags);
+
 /**
  * Registers or updates the Bonjour records for the _mfi-config service.
  *
@@ -201,13 +201,8 @@ HAPError HAPJSONUtilsSkipValue(struct util_json_reader* reader, const char* byte
 
 HAP_RESULT_USE_CHECK
 size_t HAPJSONUtilsGetFloatNumDescriptionBytes(float value) {
-    HAPError err;
-
     if (HAPFloatIsFinite(value)) {
-        char description[kHAPFloat_MaxDescriptionBytes + 1];
-        err = HAPFloatGetDescription(description, sizeof description, value);
-        HAPAssert(!err);
-        return HAPStringGetNumBytes(description);
+        return HAPFloatGetNumDescriptionBytes(value);
     } else {
         return sizeof "null" - 1;
     }
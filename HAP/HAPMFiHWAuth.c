@@ -13,6 +13,18 @@ void HAPMFiHWAuthCreate(HAPMFiHWAuth* mfiHWAuth, HAPPlatformMFiHWAuthRef platfor
 
     mfiHWAuth->platformMFiHWAuth = platformMFiHWAuth;
     mfiHWAuth->powerOffTimer = 0;
+    HAPRawBufferZero(&mfiHWAuth->signature, sizeof mfiHWAuth->signature);
+    HAPRawBufferZero(&mfiHWAuth->certificate, sizeof mfiHWAuth->certificate);
+    mfiHWAuth->isAvailable = false;
+}
+
+void HAPMFiHWAuthSetCertificateCache(HAPMFiHWAuth* mfiHWAuth, void* _Nullable bytes, size_t maxBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(!maxBytes || bytes);
+
+    mfiHWAuth->certificate.bytes = bytes;
+    mfiHWAuth->certificate.maxBytes = maxBytes;
+    mfiHWAuth->certificate.numBytes = 0;
 }
 
 void HAPMFiHWAuthRelease(HAPMFiHWAuth* mfiHWAuth) {
@@ -22,6 +34,12 @@ void HAPMFiHWAuthRelease(HAPMFiHWAuth* mfiHWAuth) {
         HAPLog(&logObject, "Deinitializing Apple Authentication Coprocessor that does not report ready for power off.");
     }
 
+    // Abort signature creation.
+    if (HAPMFiHWAuthIsBusy(mfiHWAuth)) {
+        HAPLog(&logObject, "Aborting signature creation.");
+        HAPPlatformMFiHWAuthCancel(HAPNonnull(mfiHWAuth->platformMFiHWAuth));
+    }
+
     // Deinitialize timer.
     if (mfiHWAuth->powerOffTimer) {
         HAPPlatformTimerDeregister(mfiHWAuth->powerOffTimer);
@@ -31,16 +49,28 @@ void HAPMFiHWAuthRelease(HAPMFiHWAuth* mfiHWAuth) {
     HAPRawBufferZero(mfiHWAuth, sizeof *mfiHWAuth);
 }
 
+/**
+ * Returns how long the Apple Authentication Coprocessor must remain powered before it may be shut down.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ *
+ * @return 0                        If the Apple Authentication Coprocessor can be shut down.
+ * @return Remaining duration       Otherwise.
+ */
 HAP_RESULT_USE_CHECK
-bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth) {
+static HAPTime GetPowerOffDelay(HAPMFiHWAuth* mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
 
     if (!mfiHWAuth->platformMFiHWAuth) {
-        return true;
+        return 0;
+    }
+
+    if (HAPMFiHWAuthIsBusy(mfiHWAuth)) {
+        return 1 * HAPSecond;
     }
 
     if (!HAPPlatformMFiHWAuthIsPoweredOn(HAPNonnull(mfiHWAuth->platformMFiHWAuth))) {
-        return false;
+        return 1 * HAPSecond;
     }
 
     HAPError err;
@@ -57,7 +87,7 @@ bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth) {
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             HAPLog(&logObject, "Failed to read Authentication Protocol Major Version. Reporting safe to disable.");
-            return true;
+            return 0;
         }
         protocolVersionMajor = bytes[0];
     }
@@ -78,15 +108,22 @@ bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth) {
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             HAPLog(&logObject, "Failed to read System Event Counter. Reporting safe to disable.");
-            return true;
+            return 0;
         }
         uint8_t systemEventCounter = bytes[0];
 
         HAPLogDebug(&logObject, "System Event Counter = %u.", systemEventCounter);
-        return systemEventCounter == 0;
+        return systemEventCounter * HAPSecond;
     }
 
-    return true;
+    return 0;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return GetPowerOffDelay(mfiHWAuth) == 0;
 }
 
 static void PowerOffTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
@@ -99,11 +136,12 @@ static void PowerOffTimerExpired(HAPPlatformTimerRef timer, void* _Nullable cont
     HAPError err;
 
     HAPAssert(HAPPlatformMFiHWAuthIsPoweredOn(HAPNonnull(mfiHWAuth->platformMFiHWAuth)));
-    if (!HAPMFiHWAuthIsSafeToRelease(mfiHWAuth)) {
-        // Apple Authentication Coprocessor should not be disabled. Extend power off timer.
+    HAPTime powerOffDelay = GetPowerOffDelay(mfiHWAuth);
+    if (powerOffDelay) {
+        // Apple Authentication Coprocessor should not be disabled. Extend power off timer until it may be disabled.
         err = HAPPlatformTimerRegister(
                 &mfiHWAuth->powerOffTimer,
-                HAPPlatformClockGetCurrent() + 1 * HAPSecond,
+                HAPPlatformClockGetCurrentCoarse() + powerOffDelay,
                 PowerOffTimerExpired,
                 mfiHWAuth);
         if (err) {
@@ -151,7 +189,10 @@ static HAPError HAPMFiHWAuthEnable(HAPMFiHWAuth* mfiHWAuth) {
 
     // Schedule checking for power off.
     err = HAPPlatformTimerRegister(
-            &mfiHWAuth->powerOffTimer, HAPPlatformClockGetCurrent() + 3 * HAPSecond, PowerOffTimerExpired, mfiHWAuth);
+            &mfiHWAuth->powerOffTimer,
+            HAPPlatformClockGetCurrentCoarse() + 3 * HAPSecond,
+            PowerOffTimerExpired,
+            mfiHWAuth);
     if (err) {
         HAPAssert(err == kHAPError_OutOfResources);
         HAPLog(&logObject, "Not enough resources to start power off timer. Leaving HW on!");
@@ -160,6 +201,29 @@ static HAPError HAPMFiHWAuthEnable(HAPMFiHWAuth* mfiHWAuth) {
     return kHAPError_None;
 }
 
+/**
+ * Checks whether a challenge response data length that has been reported by the Apple Authentication Coprocessor is
+ * valid.
+ *
+ * @param      protocolVersionMajor Authentication Protocol Major Version.
+ * @param      challengeResponseDataLength Challenge response data length.
+ *
+ * @return true                     If the challenge response data length is valid.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsValidChallengeResponseDataLength(uint8_t protocolVersionMajor, uint16_t challengeResponseDataLength) {
+    // See Accessory Interface Specification R30
+    // Section 64.5.7.8 Challenge Response Data Length
+    // See Accessory Interface Specification R29
+    // Section 69.8.2.7 Challenge Response Data Length
+    if (protocolVersionMajor == 3) {
+        return challengeResponseDataLength == 64;
+    }
+    HAPAssert(protocolVersionMajor == 2);
+    return challengeResponseDataLength && challengeResponseDataLength <= 0x80;
+}
+
 #define HAP_MFI_HW_AUTH_READ_OR_RETURN_FAIL_VALUE(mfiHWAuth, registerAddress, bytes, numBytes, failValue) \
     do { \
         err = HAPPlatformMFiHWAuthRead( \
@@ -197,6 +261,16 @@ bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth) {
 
     HAPError err;
 
+    // The result of the self test does not change once it has succeeded.
+    if (mfiHWAuth->isAvailable) {
+        return true;
+    }
+
+    if (HAPMFiHWAuthIsBusy(mfiHWAuth)) {
+        HAPLog(&logObject, "Apple Authentication Coprocessor is busy creating a signature.");
+        return false;
+    }
+
     // Enable Apple Authentication Coprocessor.
     err = HAPMFiHWAuthEnable(mfiHWAuth);
     if (err) {
@@ -305,25 +379,42 @@ bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth) {
         }
     }
 
+    mfiHWAuth->isAvailable = true;
     return true;
 }
 
+/**
+ * Reads the accessory certificate from the Apple Authentication Coprocessor.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param[out] certificateBytes     MFi certificate buffer.
+ * @param      maxCertificateBytes  Capacity of MFi certificate buffer.
+ * @param[out] numCertificateBytes  Effective length of MFi certificate buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ * @return kHAPError_OutOfResources If the MFi certificate buffer is too small.
+ */
 HAP_RESULT_USE_CHECK
-HAPError HAPMFiHWAuthCopyCertificate(
-        HAPAccessoryServerRef* server_,
+static HAPError ReadCertificate(
+        HAPMFiHWAuth* mfiHWAuth,
         void* certificateBytes,
         size_t maxCertificateBytes,
         size_t* numCertificateBytes) {
-    HAPPrecondition(server_);
-    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
-    HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(mfiHWAuth->platformMFiHWAuth);
     HAPPrecondition(certificateBytes);
     HAPPrecondition(numCertificateBytes);
 
     HAPError err;
 
+    if (HAPMFiHWAuthIsBusy(mfiHWAuth)) {
+        HAPLog(&logObject, "Apple Authentication Coprocessor is busy creating a signature.");
+        return kHAPError_Unknown;
+    }
+
     // Enable Apple Authentication Coprocessor.
-    err = HAPMFiHWAuthEnable(&server->mfi);
+    err = HAPMFiHWAuthEnable(mfiHWAuth);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -332,7 +423,7 @@ HAPError HAPMFiHWAuthCopyCertificate(
     // Reset Error Code.
     {
         uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
+        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(mfiHWAuth, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
     }
 
     // Read Authentication Protocol Version.
@@ -340,7 +431,7 @@ HAPError HAPMFiHWAuthCopyCertificate(
     {
         uint8_t bytes[1];
         HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion, bytes, sizeof bytes);
+                mfiHWAuth, kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion, bytes, sizeof bytes);
         protocolVersionMajor = bytes[0];
 
         if (protocolVersionMajor != 2 && protocolVersionMajor != 3) {
@@ -355,7 +446,7 @@ HAPError HAPMFiHWAuthCopyCertificate(
         uint8_t bytes[2];
 
         HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AccessoryCertificateDataLength, bytes, sizeof bytes);
+                mfiHWAuth, kHAPMFiHWAuthRegister_AccessoryCertificateDataLength, bytes, sizeof bytes);
         accessoryCertificateDataLength = HAPReadBigUInt16(&bytes[0]);
 
         // See Accessory Interface Specification R30
@@ -388,7 +479,7 @@ HAPError HAPMFiHWAuthCopyCertificate(
 
         uint16_t numBytes = HAPMin(accessoryCertificateDataLength, (uint16_t) 128);
         HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi,
+                mfiHWAuth,
                 (uint8_t)(kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1 + i),
                 &((uint8_t*) certificateBytes)[*numCertificateBytes],
                 numBytes);
@@ -400,7 +491,7 @@ HAPError HAPMFiHWAuthCopyCertificate(
     // Check for error.
     {
         uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
+        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(mfiHWAuth, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
         HAPMFiHWAuthError errorCode = (HAPMFiHWAuthError) bytes[0];
         if (errorCode) {
             HAPLog(&logObject, "Error occurred while getting accessory certificate: 0x%02x.", errorCode);
@@ -410,6 +501,96 @@ HAPError HAPMFiHWAuthCopyCertificate(
     return kHAPError_None;
 }
 
+/**
+ * Reads the accessory certificate into the certificate cache, if it has not been cached yet.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ * @return kHAPError_OutOfResources If no certificate cache is configured or if it is too small.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError FillCertificateCache(HAPMFiHWAuth* mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    HAPError err;
+
+    if (mfiHWAuth->certificate.numBytes) {
+        return kHAPError_None;
+    }
+    if (!mfiHWAuth->certificate.maxBytes) {
+        return kHAPError_OutOfResources;
+    }
+
+    size_t numBytes;
+    err = ReadCertificate(
+            mfiHWAuth, HAPNonnullVoid(mfiHWAuth->certificate.bytes), mfiHWAuth->certificate.maxBytes, &numBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+        if (err == kHAPError_OutOfResources) {
+            HAPLog(&logObject, "Accessory certificate does not fit into certificate cache. Not caching.");
+        }
+        return err;
+    }
+    HAPAssert(numBytes);
+    mfiHWAuth->certificate.numBytes = numBytes;
+    HAPLogInfo(&logObject, "Cached accessory certificate (%zu bytes).", numBytes);
+    return kHAPError_None;
+}
+
+void HAPMFiHWAuthPrepare(HAPMFiHWAuth* mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    HAPError err;
+
+    if (!mfiHWAuth->platformMFiHWAuth || !HAPMFiHWAuthIsAvailable(mfiHWAuth)) {
+        return;
+    }
+    if (!mfiHWAuth->certificate.maxBytes) {
+        return;
+    }
+    err = FillCertificateCache(mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Reading accessory certificate failed. Retrying on demand.");
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCopyCertificate(
+        HAPAccessoryServerRef* server_,
+        void* certificateBytes,
+        size_t maxCertificateBytes,
+        size_t* numCertificateBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(certificateBytes);
+    HAPPrecondition(numCertificateBytes);
+
+    HAPError err;
+
+    // Serve the certificate from the certificate cache, if possible.
+    err = FillCertificateCache(&server->mfi);
+    if (!err) {
+        if (server->mfi.certificate.numBytes > maxCertificateBytes) {
+            HAPLog(&logObject, "Not enough space to get certificate.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(
+                certificateBytes, HAPNonnullVoid(server->mfi.certificate.bytes), server->mfi.certificate.numBytes);
+        *numCertificateBytes = server->mfi.certificate.numBytes;
+        return kHAPError_None;
+    }
+    if (err == kHAPError_Unknown) {
+        return err;
+    }
+    HAPAssert(err == kHAPError_OutOfResources);
+
+    return ReadCertificate(&server->mfi, certificateBytes, maxCertificateBytes, numCertificateBytes);
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPMFiHWAuthCreateSignature(
         HAPAccessoryServerRef* server_,
@@ -427,6 +608,11 @@ HAPError HAPMFiHWAuthCreateSignature(
 
     HAPError err;
 
+    if (HAPMFiHWAuthIsBusy(&server->mfi)) {
+        HAPLog(&logObject, "Apple Authentication Coprocessor is busy creating a signature.");
+        return kHAPError_Unknown;
+    }
+
     // Enable Apple Authentication Coprocessor.
     err = HAPMFiHWAuthEnable(&server->mfi);
     if (err) {
@@ -532,13 +718,7 @@ HAPError HAPMFiHWAuthCreateSignature(
         HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
                 &server->mfi, kHAPMFiHWAuthRegister_ChallengeResponseDataLength, bytes, sizeof bytes);
         challengeResponseDataLength = HAPReadBigUInt16(&bytes[0]);
-
-        // See Accessory Interface Specification R30
-        // Section 64.5.7.8 Challenge Response Data Length
-        // See Accessory Interface Specification R29
-        // Section 69.8.2.7 Challenge Response Data Length
-        if ((protocolVersionMajor == 3 && challengeResponseDataLength != 64) ||
-            (protocolVersionMajor == 2 && challengeResponseDataLength > 0x80)) {
+        if (!IsValidChallengeResponseDataLength(protocolVersionMajor, challengeResponseDataLength)) {
             HAPLog(&logObject,
                    "Apple Authentication Coprocessor returned %u for challenge response data length.",
                    challengeResponseDataLength);
@@ -567,3 +747,316 @@ HAPError HAPMFiHWAuthCreateSignature(
     }
     return kHAPError_None;
 }
+
+/**
+ * Steps of an asynchronous signature creation.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPMFiHWAuthSignatureStep) {
+    /** Reset Error Code. */
+    kHAPMFiHWAuthSignatureStep_ResetErrorCode = 1,
+
+    /** Read Authentication Protocol Major Version. */
+    kHAPMFiHWAuthSignatureStep_ReadProtocolVersion,
+
+    /** Write challenge data length (Authentication Protocol Version 2 only). */
+    kHAPMFiHWAuthSignatureStep_WriteChallengeDataLength,
+
+    /** Write challenge data. */
+    kHAPMFiHWAuthSignatureStep_WriteChallengeData,
+
+    /** Write challenge response data length (Authentication Protocol Version 2 only). */
+    kHAPMFiHWAuthSignatureStep_WriteChallengeResponseDataLength,
+
+    /** Write authentication control. */
+    kHAPMFiHWAuthSignatureStep_WriteAuthenticationControl,
+
+    /** Read status. */
+    kHAPMFiHWAuthSignatureStep_ReadAuthenticationStatus,
+
+    /** Read challenge response data length. */
+    kHAPMFiHWAuthSignatureStep_ReadChallengeResponseDataLength,
+
+    /** Read challenge response data. */
+    kHAPMFiHWAuthSignatureStep_ReadChallengeResponseData,
+
+    /** Check for error. */
+    kHAPMFiHWAuthSignatureStep_CheckErrorCode
+} HAP_ENUM_END(uint8_t, HAPMFiHWAuthSignatureStep);
+
+HAP_RESULT_USE_CHECK
+bool HAPMFiHWAuthIsBusy(const HAPMFiHWAuth* mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return mfiHWAuth->signature.completion != NULL;
+}
+
+/**
+ * Completes the asynchronous signature creation.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      error                Result of the signature creation.
+ */
+static void CompleteSignature(HAPMFiHWAuth* mfiHWAuth, HAPError error) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(mfiHWAuth->signature.completion);
+
+    HAPMFiHWAuthCreateSignatureCompletion completion = HAPNonnull(mfiHWAuth->signature.completion);
+    void* _Nullable context = mfiHWAuth->signature.context;
+    size_t numSignatureBytes = error ? 0 : mfiHWAuth->signature.numSignatureBytes;
+    HAPRawBufferZero(&mfiHWAuth->signature, sizeof mfiHWAuth->signature);
+    completion(mfiHWAuth, error, numSignatureBytes, context);
+}
+
+static void HandleSignatureTransactionCompleted(
+        HAPPlatformMFiHWAuthRef platformMFiHWAuth,
+        HAPError error,
+        void* _Nullable context);
+
+/**
+ * Submits the transaction of the current step of the asynchronous signature creation.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If another transaction is in progress.
+ * @return kHAPError_OutOfResources If not enough resources are available to start the transaction.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ContinueSignature(HAPMFiHWAuth* mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(mfiHWAuth->platformMFiHWAuth);
+    HAPPlatformMFiHWAuthRef platformMFiHWAuth = HAPNonnull(mfiHWAuth->platformMFiHWAuth);
+
+    switch ((HAPMFiHWAuthSignatureStep) mfiHWAuth->signature.step) {
+        case kHAPMFiHWAuthSignatureStep_ResetErrorCode:
+        case kHAPMFiHWAuthSignatureStep_CheckErrorCode: {
+            return HAPPlatformMFiHWAuthReadAsync(
+                    platformMFiHWAuth,
+                    kHAPMFiHWAuthRegister_ErrorCode,
+                    mfiHWAuth->signature.registerBytes,
+                    1,
+                    HandleSignatureTransactionCompleted,
+                    mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_ReadProtocolVersion: {
+            return HAPPlatformMFiHWAuthReadAsync(
+                    platformMFiHWAuth,
+                    kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion,
+                    mfiHWAuth->signature.registerBytes,
+                    1,
+                    HandleSignatureTransactionCompleted,
+                    mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeDataLength: {
+            uint8_t bytes[1 + sizeof(uint16_t)];
+            bytes[0] = kHAPMFiHWAuthRegister_ChallengeDataLength;
+            HAPWriteBigUInt16(&bytes[1], SHA1_BYTES);
+            return HAPPlatformMFiHWAuthWriteAsync(
+                    platformMFiHWAuth, bytes, sizeof bytes, HandleSignatureTransactionCompleted, mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeData: {
+            // Additional hash computation is necessary. See HAPMFiHWAuthCreateSignature.
+            uint8_t bytes[1 + SHA256_BYTES];
+            bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
+            size_t numBytes;
+            if (mfiHWAuth->signature.protocolVersionMajor == 3) {
+                HAP_sha256(&bytes[1], mfiHWAuth->signature.challengeBytes, mfiHWAuth->signature.numChallengeBytes);
+                numBytes = 1 + SHA256_BYTES;
+            } else {
+                HAPAssert(mfiHWAuth->signature.protocolVersionMajor == 2);
+                HAP_sha1(&bytes[1], mfiHWAuth->signature.challengeBytes, mfiHWAuth->signature.numChallengeBytes);
+                numBytes = 1 + SHA1_BYTES;
+            }
+            return HAPPlatformMFiHWAuthWriteAsync(
+                    platformMFiHWAuth, bytes, numBytes, HandleSignatureTransactionCompleted, mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeResponseDataLength: {
+            uint8_t bytes[1 + sizeof(uint16_t)];
+            bytes[0] = kHAPMFiHWAuthRegister_ChallengeResponseDataLength;
+            HAPWriteBigUInt16(&bytes[1], 0x80);
+            return HAPPlatformMFiHWAuthWriteAsync(
+                    platformMFiHWAuth, bytes, sizeof bytes, HandleSignatureTransactionCompleted, mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_WriteAuthenticationControl: {
+            uint8_t bytes[2];
+            bytes[0] = kHAPMFiHWAuthRegister_AuthenticationControlAndStatus;
+            bytes[1] = 1; // PROC_CONTROL
+            return HAPPlatformMFiHWAuthWriteAsync(
+                    platformMFiHWAuth, bytes, sizeof bytes, HandleSignatureTransactionCompleted, mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_ReadAuthenticationStatus: {
+            return HAPPlatformMFiHWAuthReadAsync(
+                    platformMFiHWAuth,
+                    kHAPMFiHWAuthRegister_AuthenticationControlAndStatus,
+                    mfiHWAuth->signature.registerBytes,
+                    1,
+                    HandleSignatureTransactionCompleted,
+                    mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_ReadChallengeResponseDataLength: {
+            return HAPPlatformMFiHWAuthReadAsync(
+                    platformMFiHWAuth,
+                    kHAPMFiHWAuthRegister_ChallengeResponseDataLength,
+                    mfiHWAuth->signature.registerBytes,
+                    sizeof(uint16_t),
+                    HandleSignatureTransactionCompleted,
+                    mfiHWAuth);
+        }
+        case kHAPMFiHWAuthSignatureStep_ReadChallengeResponseData: {
+            return HAPPlatformMFiHWAuthReadAsync(
+                    platformMFiHWAuth,
+                    kHAPMFiHWAuthRegister_ChallengeResponseData,
+                    HAPNonnullVoid(mfiHWAuth->signature.signatureBytes),
+                    mfiHWAuth->signature.numSignatureBytes,
+                    HandleSignatureTransactionCompleted,
+                    mfiHWAuth);
+        }
+    }
+    HAPFatalError();
+}
+
+static void HandleSignatureTransactionCompleted(
+        HAPPlatformMFiHWAuthRef platformMFiHWAuth,
+        HAPError error,
+        void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPMFiHWAuth* mfiHWAuth = context;
+    HAPPrecondition(platformMFiHWAuth == mfiHWAuth->platformMFiHWAuth);
+    HAPPrecondition(HAPMFiHWAuthIsBusy(mfiHWAuth));
+
+    HAPError err;
+
+    if (error) {
+        HAPAssert(error == kHAPError_Unknown);
+        HAPLog(&logObject, "Communication with Apple Authentication Coprocessor failed while creating signature.");
+        CompleteSignature(mfiHWAuth, error);
+        return;
+    }
+
+    uint8_t protocolVersionMajor = mfiHWAuth->signature.protocolVersionMajor;
+    HAPMFiHWAuthSignatureStep nextStep;
+    switch ((HAPMFiHWAuthSignatureStep) mfiHWAuth->signature.step) {
+        case kHAPMFiHWAuthSignatureStep_ResetErrorCode: {
+            nextStep = kHAPMFiHWAuthSignatureStep_ReadProtocolVersion;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_ReadProtocolVersion: {
+            protocolVersionMajor = mfiHWAuth->signature.registerBytes[0];
+            if (protocolVersionMajor != 2 && protocolVersionMajor != 3) {
+                HAPLog(&logObject, "Unsupported Authentication Protocol Major Version: %u.", protocolVersionMajor);
+                CompleteSignature(mfiHWAuth, kHAPError_Unknown);
+                return;
+            }
+            mfiHWAuth->signature.protocolVersionMajor = protocolVersionMajor;
+            nextStep = protocolVersionMajor == 3 ? kHAPMFiHWAuthSignatureStep_WriteChallengeData :
+                                                   kHAPMFiHWAuthSignatureStep_WriteChallengeDataLength;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeDataLength: {
+            nextStep = kHAPMFiHWAuthSignatureStep_WriteChallengeData;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeData: {
+            nextStep = protocolVersionMajor == 3 ? kHAPMFiHWAuthSignatureStep_WriteAuthenticationControl :
+                                                   kHAPMFiHWAuthSignatureStep_WriteChallengeResponseDataLength;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_WriteChallengeResponseDataLength: {
+            nextStep = kHAPMFiHWAuthSignatureStep_WriteAuthenticationControl;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_WriteAuthenticationControl: {
+            nextStep = kHAPMFiHWAuthSignatureStep_ReadAuthenticationStatus;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_ReadAuthenticationStatus: {
+            if (mfiHWAuth->signature.registerBytes[0] != (1 << 4)) {
+                HAPLog(&logObject,
+                       "Apple Authentication Coprocessor returned %02x for authentication protocol status.",
+                       mfiHWAuth->signature.registerBytes[0]);
+                CompleteSignature(mfiHWAuth, kHAPError_Unknown);
+                return;
+            }
+            nextStep = kHAPMFiHWAuthSignatureStep_ReadChallengeResponseDataLength;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_ReadChallengeResponseDataLength: {
+            uint16_t challengeResponseDataLength = HAPReadBigUInt16(mfiHWAuth->signature.registerBytes);
+            if (!IsValidChallengeResponseDataLength(protocolVersionMajor, challengeResponseDataLength)) {
+                HAPLog(&logObject,
+                       "Apple Authentication Coprocessor returned %u for challenge response data length.",
+                       challengeResponseDataLength);
+                CompleteSignature(mfiHWAuth, kHAPError_Unknown);
+                return;
+            }
+            if (challengeResponseDataLength > mfiHWAuth->signature.maxSignatureBytes) {
+                HAPLog(&logObject, "Not enough space to get signature.");
+                CompleteSignature(mfiHWAuth, kHAPError_OutOfResources);
+                return;
+            }
+            mfiHWAuth->signature.numSignatureBytes = challengeResponseDataLength;
+            nextStep = kHAPMFiHWAuthSignatureStep_ReadChallengeResponseData;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_ReadChallengeResponseData: {
+            nextStep = kHAPMFiHWAuthSignatureStep_CheckErrorCode;
+        } break;
+        case kHAPMFiHWAuthSignatureStep_CheckErrorCode: {
+            HAPMFiHWAuthError errorCode = (HAPMFiHWAuthError) mfiHWAuth->signature.registerBytes[0];
+            if (errorCode) {
+                HAPLog(&logObject, "Error occurred while getting signature: 0x%02x.", errorCode);
+                CompleteSignature(mfiHWAuth, kHAPError_Unknown);
+                return;
+            }
+            CompleteSignature(mfiHWAuth, kHAPError_None);
+            return;
+        }
+        default: HAPFatalError();
+    }
+
+    mfiHWAuth->signature.step = nextStep;
+    err = ContinueSignature(mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Failed to continue signature creation.");
+        CompleteSignature(mfiHWAuth, kHAPError_Unknown);
+        return;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCreateSignatureAsync(
+        HAPMFiHWAuth* mfiHWAuth,
+        const void* challengeBytes,
+        size_t numChallengeBytes,
+        void* signatureBytes,
+        size_t maxSignatureBytes,
+        HAPMFiHWAuthCreateSignatureCompletion completion,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(challengeBytes);
+    HAPPrecondition(numChallengeBytes <= sizeof mfiHWAuth->signature.challengeBytes);
+    HAPPrecondition(signatureBytes);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    if (HAPMFiHWAuthIsBusy(mfiHWAuth)) {
+        HAPLog(&logObject, "Apple Authentication Coprocessor is busy creating a signature.");
+        return kHAPError_InvalidState;
+    }
+
+    // Enable Apple Authentication Coprocessor.
+    err = HAPMFiHWAuthEnable(mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    mfiHWAuth->signature.completion = completion;
+    mfiHWAuth->signature.context = context;
+    mfiHWAuth->signature.signatureBytes = signatureBytes;
+    mfiHWAuth->signature.maxSignatureBytes = maxSignatureBytes;
+    HAPRawBufferCopyBytes(mfiHWAuth->signature.challengeBytes, challengeBytes, numChallengeBytes);
+    mfiHWAuth->signature.numChallengeBytes = (uint8_t) numChallengeBytes;
+    mfiHWAuth->signature.step = kHAPMFiHWAuthSignatureStep_ResetErrorCode;
+    err = ContinueSignature(mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        HAPRawBufferZero(&mfiHWAuth->signature, sizeof mfiHWAuth->signature);
+        return err;
+    }
+    return kHAPError_None;
+}
@@ -17,10 +17,39 @@ extern "C" {
 #pragma clang assume_nonnull begin
 #endif
 
+/**
+ * Maximum length of a challenge that may be signed asynchronously.
+ */
+#define kHAPMFiHWAuth_MaxChallengeBytes ((size_t) 32)
+
+/**
+ * Maximum length of a signature that is created by an Apple Authentication Coprocessor.
+ */
+#define kHAPMFiHWAuth_MaxSignatureBytes ((size_t) 128)
+
+typedef struct HAPMFiHWAuth HAPMFiHWAuth;
+
+/**
+ * Completion callback of an asynchronous signature creation.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      error                kHAPError_None           If successful.
+ *                                  kHAPError_Unknown        If communication with the Apple Authentication
+ *                                                           Coprocessor failed.
+ *                                  kHAPError_OutOfResources If the signature buffer is too small.
+ * @param      numSignatureBytes    Effective length of signature buffer, if successful.
+ * @param      context              The context parameter given to the HAPMFiHWAuthCreateSignatureAsync function.
+ */
+typedef void (*HAPMFiHWAuthCreateSignatureCompletion)(
+        HAPMFiHWAuth* mfiHWAuth,
+        HAPError error,
+        size_t numSignatureBytes,
+        void* _Nullable context);
+
 /**
  * Apple Authentication Coprocessor manager.
  */
-typedef struct {
+struct HAPMFiHWAuth {
     /**
      * Apple Authentication Coprocessor provider.
      */
@@ -30,7 +59,61 @@ typedef struct {
      * Time to check MFi power off.
      */
     HAPPlatformTimerRef powerOffTimer;
-} HAPMFiHWAuth;
+
+    /**
+     * Asynchronous signature creation state.
+     */
+    struct {
+        /** Completion callback. NULL if no signature is being created. */
+        HAPMFiHWAuthCreateSignatureCompletion _Nullable completion;
+
+        /** The context parameter given to the HAPMFiHWAuthCreateSignatureAsync function. */
+        void* _Nullable context;
+
+        /** Signature buffer. */
+        void* _Nullable signatureBytes;
+
+        /** Capacity of signature buffer. */
+        size_t maxSignatureBytes;
+
+        /** Effective length of signature buffer. */
+        uint16_t numSignatureBytes;
+
+        /** Challenge. */
+        uint8_t challengeBytes[kHAPMFiHWAuth_MaxChallengeBytes];
+
+        /** Length of challenge. */
+        uint8_t numChallengeBytes;
+
+        /** Buffer for register values. */
+        uint8_t registerBytes[2];
+
+        /** Authentication Protocol Major Version. */
+        uint8_t protocolVersionMajor;
+
+        /** Current step. */
+        uint8_t step;
+    } signature;
+
+    /**
+     * Accessory certificate cache.
+     */
+    struct {
+        /** Storage for the accessory certificate. NULL if no certificate cache is configured. */
+        void* _Nullable bytes;
+
+        /** Capacity of storage. */
+        size_t maxBytes;
+
+        /** Length of the cached accessory certificate. 0 if the accessory certificate has not been cached yet. */
+        size_t numBytes;
+    } certificate;
+
+    /**
+     * Whether the Apple Authentication Coprocessor has passed its self test.
+     */
+    bool isAvailable : 1;
+};
 HAP_NONNULL_SUPPORT(HAPMFiHWAuth)
 
 /**
@@ -41,6 +124,28 @@ HAP_NONNULL_SUPPORT(HAPMFiHWAuth)
  */
 void HAPMFiHWAuthCreate(HAPMFiHWAuth* mfiHWAuth, HAPPlatformMFiHWAuthRef _Nullable platformMFiHWAuth);
 
+/**
+ * Configures storage in which the accessory certificate is cached once it has been read.
+ *
+ * - The accessory certificate does not change, so subsequent pairings only need the Apple Authentication Coprocessor
+ *   to create the signature.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      bytes                Storage for the accessory certificate. Must remain valid until release.
+ * @param      maxBytes             Capacity of storage.
+ */
+void HAPMFiHWAuthSetCertificateCache(HAPMFiHWAuth* mfiHWAuth, void* _Nullable bytes, size_t maxBytes);
+
+/**
+ * Checks the Apple Authentication Coprocessor and reads the accessory certificate into the certificate cache ahead
+ * of the first pairing.
+ *
+ * - Failures are logged and retried on demand.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ */
+void HAPMFiHWAuthPrepare(HAPMFiHWAuth* mfiHWAuth);
+
 /**
  * Deinitializes Apple Authentication Coprocessor manager.
  *
@@ -63,6 +168,8 @@ bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth);
 /**
  * Check if the Apple Authentication Coprocessor is available.
  *
+ * - Once the Apple Authentication Coprocessor has passed its self test, the result is cached.
+ *
  * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
  *
  * @return true                     If the Apple Authentication Coprocessor chip is available.
@@ -74,6 +181,9 @@ bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth);
 /**
  * Retrieves a copy of the MFi certificate.
  *
+ * - If a certificate cache is configured, the MFi certificate is only read from the Apple Authentication Coprocessor
+ *   once.
+ *
  * @param      server               Accessory server.
  * @param[out] certificateBytes     MFi certificate buffer.
  * @param      maxCertificateBytes  Capacity of MFi certificate buffer.
@@ -113,6 +223,50 @@ HAPError HAPMFiHWAuthCreateSignature(
         size_t maxSignatureBytes,
         size_t* numSignatureBytes);
 
+/**
+ * Starts signing the digest of a challenge with the MFi Private Key without blocking the run loop.
+ *
+ * - While the Apple Authentication Coprocessor is generating the signature it does not acknowledge transfers.
+ *   Instead of waiting for it, transfers are retried from the run loop.
+ *
+ * - The completion callback is invoked on the run loop. It is never invoked synchronously.
+ *
+ * - Only one signature may be created at a time. Synchronous operations fail while a signature is being created.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      challengeBytes       Challenge buffer. The challenge is copied.
+ * @param      numChallengeBytes    Length of challenge buffer. Maximum kHAPMFiHWAuth_MaxChallengeBytes.
+ * @param[out] signatureBytes       Signature buffer. Must remain valid until the completion callback is invoked.
+ * @param      maxSignatureBytes    Capacity of signature buffer.
+ * @param      completion           Callback to invoke when the signature has been created or the operation failed.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the Apple Authentication Coprocessor could not be enabled.
+ * @return kHAPError_InvalidState   If a signature is already being created.
+ * @return kHAPError_OutOfResources If not enough resources are available to start the operation.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCreateSignatureAsync(
+        HAPMFiHWAuth* mfiHWAuth,
+        const void* challengeBytes,
+        size_t numChallengeBytes,
+        void* signatureBytes,
+        size_t maxSignatureBytes,
+        HAPMFiHWAuthCreateSignatureCompletion completion,
+        void* _Nullable context);
+
+/**
+ * Returns whether a signature is being created asynchronously.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ *
+ * @return true                     If a signature is being created.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPMFiHWAuthIsBusy(const HAPMFiHWAuth* mfiHWAuth);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -37,7 +37,9 @@ void HAPPairingBLESessionCacheFetch(
         HAPPairingBLESessionCacheEntry* cacheEntry =
                 (HAPPairingBLESessionCacheEntry*) &server->ble.storage->sessionCacheElements[i];
 
-        if (cacheEntry->lastUsed && HAPRawBufferAreEqual(&cacheEntry->sessionID, sessionID, sizeof *sessionID)) {
+        // Session IDs are derived from the shared secret of the cached session.
+        if (cacheEntry->lastUsed &&
+            HAPRawBufferAreEqualConstantTime(&cacheEntry->sessionID, sessionID, sizeof *sessionID)) {
             HAPRawBufferCopyBytes(sharedSecret, cacheEntry->sharedSecret, sizeof cacheEntry->sharedSecret);
             *pairingID = cacheEntry->pairingID;
             HAPRawBufferZero(cacheEntry, sizeof *cacheEntry);
@@ -0,0 +1,199 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "PairingCrypto" };
+
+/**
+ * Pairing cryptography job as submitted to the worker pool.
+ */
+typedef struct {
+    HAPAccessoryServerRef* server;                /**< Accessory server. */
+    HAPSessionRef* session;                       /**< The session for which the job was started. */
+    HAPPairingCryptoJobComputeCallback compute;   /**< Compute callback. */
+    HAPPairingCryptoJobCompleteCallback complete; /**< Complete callback. */
+    uint32_t jobID;                               /**< Job ID. */
+    size_t numDataBytes;                          /**< Length of job data. */
+
+    /** Job data. */
+    union {
+        uint64_t alignment;
+        void* pointerAlignment;
+        uint8_t bytes[kHAPPairingCryptoJob_MaxDataBytes];
+    } data;
+} HAPPairingCryptoJob;
+HAP_STATIC_ASSERT(sizeof(HAPPairingCryptoJob) <= kHAPPlatformWorkerPool_MaxContextBytes, HAPPairingCryptoJob);
+
+/**
+ * Worker pool callback that performs the computation of a pairing cryptography job.
+ *
+ * @param      context              Job.
+ * @param      contextSize          Length of job.
+ */
+static void PerformJob(void* context, size_t contextSize) {
+    HAPPrecondition(context);
+    HAPPairingCryptoJob* job = context;
+    HAPPrecondition(contextSize == HAP_OFFSETOF(HAPPairingCryptoJob, data) + job->numDataBytes);
+
+    job->compute(job->data.bytes);
+}
+
+/**
+ * Allocates a pairing cryptography job ID.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return Job ID. Never 0.
+ */
+HAP_RESULT_USE_CHECK
+static uint32_t AllocateJobID(HAPAccessoryServer* server) {
+    HAPPrecondition(server);
+
+    do {
+        server->ip.lastPairingCryptoJobID++;
+    } while (!server->ip.lastPairingCryptoJobID);
+    return server->ip.lastPairingCryptoJobID;
+}
+
+/**
+ * Applies the result of a pairing cryptography job and sends the deferred response.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session for which the job was started.
+ * @param      jobID                Job ID.
+ * @param      complete             Callback that applies the result of the computation.
+ * @param      data                 Job data.
+ */
+static void FinishJob(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        uint32_t jobID,
+        HAPPairingCryptoJobCompleteCallback complete,
+        void* data) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(jobID);
+    HAPPrecondition(complete);
+    HAPPrecondition(data);
+
+    if (session->pairingCryptoJobID != jobID) {
+        HAPLogDebug(&logObject, "Discarding result of pairing cryptography job %lu.", (unsigned long) jobID);
+        return;
+    }
+    session->pairingCryptoJobID = 0;
+
+    complete(server_, session_, data);
+
+    // The complete callback may have started a follow-up job. The response is deferred until it has completed.
+    if (session->pairingCryptoJobID) {
+        return;
+    }
+
+    HAPAssert(session->transportType == kHAPTransportType_IP);
+    HAPNonnull(server->transports.ip)->session.handlePairingCryptoJobCompleted(server_, session_);
+}
+
+/**
+ * Worker pool callback that applies the result of a pairing cryptography job on the run loop.
+ *
+ * @param      context              Job.
+ * @param      contextSize          Length of job.
+ */
+static void CompleteJob(void* context, size_t contextSize) {
+    HAPPrecondition(context);
+    HAPPairingCryptoJob* job = context;
+    HAPPrecondition(contextSize == HAP_OFFSETOF(HAPPairingCryptoJob, data) + job->numDataBytes);
+
+    FinishJob(job->server, job->session, job->jobID, job->complete, job->data.bytes);
+}
+
+void HAPPairingCryptoJobRun(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        HAPPairingCryptoJobComputeCallback compute,
+        HAPPairingCryptoJobCompleteCallback complete,
+        void* data,
+        size_t numDataBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(!session->pairingCryptoJobID);
+    HAPPrecondition(compute);
+    HAPPrecondition(complete);
+    HAPPrecondition(data);
+    HAPPrecondition(numDataBytes <= kHAPPairingCryptoJob_MaxDataBytes);
+
+    HAPError err;
+
+    // Only the IP transport supports deferring the response until the job has completed.
+    if (session->transportType == kHAPTransportType_IP && server->platform.ip.workerPool) {
+        HAPPairingCryptoJob job;
+        job.server = server_;
+        job.session = session_;
+        job.compute = compute;
+        job.complete = complete;
+        job.jobID = AllocateJobID(server);
+        job.numDataBytes = numDataBytes;
+        HAPRawBufferCopyBytes(job.data.bytes, data, numDataBytes);
+
+        err = HAPPlatformWorkerPoolSubmit(
+                HAPNonnull(server->platform.ip.workerPool),
+                PerformJob,
+                CompleteJob,
+                &job,
+                HAP_OFFSETOF(HAPPairingCryptoJob, data) + numDataBytes);
+        HAPRawBufferZero(&job, sizeof job);
+        if (!err) {
+            session->pairingCryptoJobID = server->ip.lastPairingCryptoJobID;
+            return;
+        }
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Worker pool is busy. Running pairing cryptography job on the run loop.");
+    }
+
+    compute(data);
+    complete(server_, session_, data);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPairingCryptoJobIsPending(const HAPSessionRef* session_) {
+    HAPPrecondition(session_);
+    const HAPSession* session = (const HAPSession*) session_;
+
+    return session->pairingCryptoJobID != 0;
+}
+
+HAP_RESULT_USE_CHECK
+uint32_t HAPPairingCryptoJobBegin(HAPAccessoryServerRef* server_, HAPSessionRef* session_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(!session->pairingCryptoJobID);
+    HAPPrecondition(session->transportType == kHAPTransportType_IP);
+
+    session->pairingCryptoJobID = AllocateJobID(server);
+    return session->pairingCryptoJobID;
+}
+
+void HAPPairingCryptoJobEnd(
+        HAPAccessoryServerRef* server,
+        HAPSessionRef* session,
+        uint32_t jobID,
+        HAPPairingCryptoJobCompleteCallback complete,
+        void* data) {
+    HAPPrecondition(server);
+    HAPPrecondition(session);
+    HAPPrecondition(jobID);
+    HAPPrecondition(complete);
+    HAPPrecondition(data);
+
+    FinishJob(server, session, jobID, complete, data);
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PAIRING_CRYPTO_H
+#define HAP_PAIRING_CRYPTO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Pairing cryptography jobs.
+ *
+ * - The expensive cryptographic operations of Pair Setup and Pair Verify are performed while processing write
+ *   requests. If a worker pool is configured and the session uses the IP transport, they are performed on the worker
+ *   pool and the response to the request is deferred until the job has completed. Otherwise, they are performed
+ *   synchronously.
+ *
+ * - At most one job may be pending per session. Results of jobs that complete after the session has been released or
+ *   a new job has been started for the session are discarded.
+ *
+ * - Operations that are performed asynchronously on the run loop, such as creating a signature with the Apple
+ *   Authentication Coprocessor, may defer the response in the same way using HAPPairingCryptoJobBegin and
+ *   HAPPairingCryptoJobEnd. The complete callback of a job may start such a follow-up job.
+ */
+
+/**
+ * Maximum length of the data of a pairing cryptography job.
+ */
+#define kHAPPairingCryptoJob_MaxDataBytes ((size_t) 1024)
+
+/**
+ * Callback that performs the computation of a pairing cryptography job.
+ *
+ * - May be invoked on a worker thread. Must only access the job data and invoke functions of HAPCrypto.h.
+ *
+ * @param      data                 Job data.
+ */
+typedef void (*HAPPairingCryptoJobComputeCallback)(void* data);
+
+/**
+ * Callback that is invoked on the run loop to apply the result of a pairing cryptography job.
+ *
+ * - The callback must validate that the pairing procedure of the session is still in the state that it was in when
+ *   the job was started.
+ *
+ * @param      server               Accessory server.
+ * @param      session              The session for which the job was started.
+ * @param      data                 Job data, as modified by the compute callback.
+ */
+typedef void (*HAPPairingCryptoJobCompleteCallback)(HAPAccessoryServerRef* server, HAPSessionRef* session, void* data);
+
+/**
+ * Runs a pairing cryptography job for a session.
+ *
+ * - If the job is performed on a worker pool, the job data is copied and the complete callback is invoked once the
+ *   computation has finished. HAPPairingCryptoJobIsPending returns true until then.
+ *
+ * - Otherwise, the compute and complete callbacks are invoked synchronously on the provided job data.
+ *
+ * @param      server               Accessory server.
+ * @param      session              The session for which to run the job.
+ * @param      compute              Callback that performs the computation.
+ * @param      complete             Callback that applies the result of the computation.
+ * @param      data                 Job data.
+ * @param      numDataBytes         Length of job data. At most kHAPPairingCryptoJob_MaxDataBytes.
+ */
+void HAPPairingCryptoJobRun(
+        HAPAccessoryServerRef* server,
+        HAPSessionRef* session,
+        HAPPairingCryptoJobComputeCallback compute,
+        HAPPairingCryptoJobCompleteCallback complete,
+        void* data,
+        size_t numDataBytes);
+
+/**
+ * Returns whether a pairing cryptography job is pending for a session.
+ *
+ * @param      session              Session.
+ *
+ * @return true                     If a pairing cryptography job is pending.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPairingCryptoJobIsPending(const HAPSessionRef* session);
+
+/**
+ * Marks a job as pending for a session that is performed by an asynchronous operation on the run loop.
+ *
+ * - The session must use the IP transport.
+ *
+ * - HAPPairingCryptoJobEnd must be called with the returned job ID once the operation has completed.
+ *
+ * @param      server               Accessory server.
+ * @param      session              The session for which to run the job.
+ *
+ * @return Job ID.
+ */
+HAP_RESULT_USE_CHECK
+uint32_t HAPPairingCryptoJobBegin(HAPAccessoryServerRef* server, HAPSessionRef* session);
+
+/**
+ * Completes a job that has been started with HAPPairingCryptoJobBegin.
+ *
+ * - If the session has been released or a new job has been started for the session in the meantime, the result is
+ *   discarded. Otherwise, the complete callback is invoked and the deferred response is sent.
+ *
+ * @param      server               Accessory server.
+ * @param      session              The session for which the job was started.
+ * @param      jobID                Job ID that has been returned by HAPPairingCryptoJobBegin.
+ * @param      complete             Callback that applies the result of the operation.
+ * @param      data                 Result of the operation.
+ */
+void HAPPairingCryptoJobEnd(
+        HAPAccessoryServerRef* server,
+        HAPSessionRef* session,
+        uint32_t jobID,
+        HAPPairingCryptoJobCompleteCallback complete,
+        void* data);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -125,6 +125,150 @@ static HAPError HAPPairingPairSetupProcessM1(
     return kHAPError_None;
 }
 
+/**
+ * Reads the number of unsuccessful authentication attempts.
+ *
+ * @param      server_              Accessory server.
+ * @param[out] numAuthAttempts      Number of unsuccessful authentication attempts.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If persistent store access failed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError HAPPairingPairSetupGetNumAuthAttempts(HAPAccessoryServerRef* server_, uint8_t* numAuthAttempts) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(numAuthAttempts);
+
+    HAPError err;
+
+    bool found;
+    size_t numBytes;
+    uint8_t numAuthAttemptsBytes[sizeof(uint8_t)];
+    err = HAPPlatformKeyValueStoreGet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_NumUnsuccessfulAuthAttempts,
+            numAuthAttemptsBytes,
+            sizeof numAuthAttemptsBytes,
+            &numBytes,
+            &found);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    if (!found) {
+        HAPRawBufferZero(numAuthAttemptsBytes, sizeof numAuthAttemptsBytes);
+    } else if (numBytes != sizeof numAuthAttemptsBytes) {
+        HAPLog(&logObject, "Invalid authentication attempts counter.");
+        return kHAPError_Unknown;
+    }
+    *numAuthAttempts = numAuthAttemptsBytes[0];
+    return kHAPError_None;
+}
+
+/**
+ * Pair Setup M2 cryptography job.
+ */
+typedef struct {
+    uint8_t b[SRP_SECRET_KEY_BYTES]; /**< Private key b. */
+    uint8_t v[SRP_VERIFIER_BYTES];   /**< SRP verifier. */
+    uint8_t B[SRP_PUBLIC_KEY_BYTES]; /**< Derived public key B. */
+} HAPPairingPairSetupM2Job;
+
+static void HAPPairingPairSetupComputeM2Job(void* data) {
+    HAPPrecondition(data);
+    HAPPairingPairSetupM2Job* job = data;
+
+    HAP_srp_public_key(job->B, job->b, job->v);
+}
+
+static void HAPPairingPairSetupCompleteM2Job(HAPAccessoryServerRef* server_, HAPSessionRef* session_, void* data) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(data);
+    const HAPPairingPairSetupM2Job* job = data;
+
+    if (server->pairSetup.sessionThatIsCurrentlyPairing != session_ || session->state.pairSetup.state != 1 ||
+        session->state.pairSetup.error) {
+        HAPLog(&logObject, "Pair Setup M2: Discarding B after Pair Setup procedure has been reset.");
+        return;
+    }
+    HAPAssert(HAPRawBufferAreEqual(job->b, server->pairSetup.b, sizeof server->pairSetup.b));
+
+    HAPRawBufferCopyBytes(server->pairSetup.B, job->B, sizeof server->pairSetup.B);
+    server->pairSetup.publicKeyIsAvailable = true;
+}
+
+/**
+ * Derives the public key B for Pair Setup M2 while processing Pair Setup M1.
+ *
+ * - Preparation is skipped if Pair Setup M2 will report an error. In that case, and if not enough memory is available,
+ *   Pair Setup M2 derives the public key itself.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session over which the request has been received.
+ * @param      scratchBytes         Free memory.
+ * @param      numScratchBytes      Length of free memory buffer.
+ */
+static void HAPPairingPairSetupPrepareM2(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        void* scratchBytes,
+        size_t numScratchBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(session->state.pairSetup.state == 1);
+    HAPPrecondition(!session->state.pairSetup.error);
+    HAPPrecondition(scratchBytes);
+
+    HAPError err;
+
+    if (server->pairSetup.sessionThatIsCurrentlyPairing != session_ || HAPAccessoryServerIsPaired(server_)) {
+        return;
+    }
+    uint8_t numAuthAttempts;
+    err = HAPPairingPairSetupGetNumAuthAttempts(server_, &numAuthAttempts);
+    if (err || numAuthAttempts >= 100) {
+        return;
+    }
+
+    bool restorePrevious = false;
+    if (server->pairSetup.flagsPresent && session->state.pairSetup.method == kHAPPairingMethod_PairSetup) {
+        restorePrevious = !(server->pairSetup.flags & kHAPPairingFlag_Transient) &&
+                          server->pairSetup.flags & kHAPPairingFlag_Split;
+    }
+    HAPSetupInfo* _Nullable setupInfo = HAPAccessorySetupInfoGetSetupInfo(server_, restorePrevious);
+    if (!setupInfo) {
+        return;
+    }
+
+    HAPPairingPairSetupM2Job* job =
+            HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, sizeof(HAPPairingPairSetupM2Job));
+    if (!job) {
+        return;
+    }
+
+    // Generate private key b.
+    HAPPlatformRandomNumberFill(server->pairSetup.b, sizeof server->pairSetup.b);
+
+    // Derive public key B.
+    HAPRawBufferCopyBytes(job->b, server->pairSetup.b, sizeof job->b);
+    HAPRawBufferCopyBytes(job->v, setupInfo->verifier, sizeof job->v);
+    HAPPairingCryptoJobRun(
+            server_,
+            session_,
+            HAPPairingPairSetupComputeM2Job,
+            HAPPairingPairSetupCompleteM2Job,
+            job,
+            sizeof *job);
+    HAPRawBufferZero(job, sizeof *job);
+}
+
 /**
  * Processes Pair Setup M2.
  *
@@ -165,28 +309,12 @@ static HAPError HAPPairingPairSetupGetM2(
     }
 
     // Check if the accessory has received more than 100 unsuccessful authentication attempts.
-    bool found;
-    size_t numBytes;
-    uint8_t numAuthAttemptsBytes[sizeof(uint8_t)];
-    err = HAPPlatformKeyValueStoreGet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_NumUnsuccessfulAuthAttempts,
-            numAuthAttemptsBytes,
-            sizeof numAuthAttemptsBytes,
-            &numBytes,
-            &found);
+    uint8_t numAuthAttempts;
+    err = HAPPairingPairSetupGetNumAuthAttempts(server_, &numAuthAttempts);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    if (!found) {
-        HAPRawBufferZero(numAuthAttemptsBytes, sizeof numAuthAttemptsBytes);
-    } else if (numBytes != sizeof numAuthAttemptsBytes) {
-        HAPLog(&logObject, "Invalid authentication attempts counter.");
-        return kHAPError_Unknown;
-    }
-    uint8_t numAuthAttempts = numAuthAttemptsBytes[0];
     if (numAuthAttempts >= 100) {
         HAPLog(&logObject, "Pair Setup M2: Accessory has received more than 100 unsuccessful authentication attempts.");
         session->state.pairSetup.error = kHAPPairingError_MaxTries;
@@ -252,12 +380,12 @@ static HAPError HAPPairingPairSetupGetM2(
     HAPLogBufferDebug(&logObject, setupInfo->salt, sizeof setupInfo->salt, "Pair Setup M2: salt.");
     HAPLogSensitiveBufferDebug(&logObject, setupInfo->verifier, sizeof setupInfo->verifier, "Pair Setup M2: verifier.");
 
-    // Generate private key b.
-    HAPPlatformRandomNumberFill(server->pairSetup.b, sizeof server->pairSetup.b);
+    // Generate private key b and derive public key B unless this has been done while processing Pair Setup M1.
+    if (!server->pairSetup.publicKeyIsAvailable) {
+        HAPPlatformRandomNumberFill(server->pairSetup.b, sizeof server->pairSetup.b);
+        HAP_srp_public_key(server->pairSetup.B, server->pairSetup.b, setupInfo->verifier);
+    }
     HAPLogSensitiveBufferDebug(&logObject, server->pairSetup.b, sizeof server->pairSetup.b, "Pair Setup M2: b.");
-
-    // Derive public key B.
-    HAP_srp_public_key(server->pairSetup.B, server->pairSetup.b, setupInfo->verifier);
     HAPLogBufferDebug(&logObject, server->pairSetup.B, sizeof server->pairSetup.B, "Pair Setup M2: B.");
 
     // kTLVType_State.
@@ -414,6 +542,257 @@ static HAPError HAPPairingPairSetupProcessM3(
     return kHAPError_None;
 }
 
+/**
+ * Pair Setup M4 cryptography job.
+ */
+typedef struct {
+    uint8_t A[SRP_PUBLIC_KEY_BYTES];           /**< Public key A. */
+    uint8_t b[SRP_SECRET_KEY_BYTES];           /**< Private key b. */
+    uint8_t u[SRP_SCRAMBLING_PARAMETER_BYTES]; /**< Scrambling parameter u. */
+    uint8_t v[SRP_VERIFIER_BYTES];             /**< SRP verifier. */
+    uint8_t K[SRP_SESSION_KEY_BYTES];          /**< Derived SRP session key K. */
+    bool publicKeyAIsIllegal;                  /**< Whether A is illegal. */
+} HAPPairingPairSetupM4Job;
+
+static void HAPPairingPairSetupComputeM4Job(void* data) {
+    HAPPrecondition(data);
+    HAPPairingPairSetupM4Job* job = data;
+
+    uint8_t S[SRP_PREMASTER_SECRET_BYTES];
+    int e = HAP_srp_premaster_secret(S, job->A, job->b, job->u, job->v);
+    if (e) {
+        HAPAssert(e == 1);
+        job->publicKeyAIsIllegal = true;
+    } else {
+        HAP_srp_session_key(job->K, S);
+    }
+    HAPRawBufferZero(S, sizeof S);
+}
+
+/**
+ * Result of the asynchronous creation of the MFi proof for Pair Setup M4.
+ */
+typedef struct {
+    HAPError error;          /**< Result of the operation. */
+    size_t numMFiProofBytes; /**< Effective length of the MFi proof, if successful. */
+} HAPPairingPairSetupMFiProofJob;
+
+static void HAPPairingPairSetupCompleteMFiProofJob(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        void* data) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(data);
+    const HAPPairingPairSetupMFiProofJob* job = data;
+
+    if (server->pairSetup.sessionThatIsCurrentlyPairing != session_ || session->state.pairSetup.state != 3 ||
+        session->state.pairSetup.error) {
+        HAPLog(&logObject, "Pair Setup M4: Discarding MFi proof after Pair Setup procedure has been reset.");
+        return;
+    }
+
+    if (job->error) {
+        HAPLog(&logObject, "Pair Setup M4: Creating MFi proof failed. Retrying while processing Pair Setup M4.");
+        return;
+    }
+    HAPAssert(job->numMFiProofBytes <= sizeof server->pairSetup.mfiProof);
+    server->pairSetup.numMFiProofBytes = (uint8_t) job->numMFiProofBytes;
+    server->pairSetup.mfiProofIsAvailable = true;
+}
+
+static void HAPPairingPairSetupHandleMFiProofCreated(
+        HAPMFiHWAuth* mfiHWAuth,
+        HAPError error,
+        size_t numSignatureBytes,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(context);
+    HAPAccessoryServerRef* server_ = context;
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(mfiHWAuth == &server->mfi);
+    HAPPrecondition(server->ip.pairSetupMFiProofJob.session);
+
+    HAPSessionRef* session_ = HAPNonnull(server->ip.pairSetupMFiProofJob.session);
+    uint32_t jobID = server->ip.pairSetupMFiProofJob.jobID;
+    HAPRawBufferZero(&server->ip.pairSetupMFiProofJob, sizeof server->ip.pairSetupMFiProofJob);
+
+    HAPPairingPairSetupMFiProofJob job = { .error = error, .numMFiProofBytes = numSignatureBytes };
+    HAPPairingCryptoJobEnd(server_, session_, jobID, HAPPairingPairSetupCompleteMFiProofJob, &job);
+}
+
+/**
+ * Starts creating the MFi proof for Pair Setup M4 with the Apple Authentication Coprocessor once K is available.
+ *
+ * - The response to Pair Setup M3 is deferred until the MFi proof has been created, so that the run loop keeps
+ *   serving other sessions while the Apple Authentication Coprocessor is busy.
+ *
+ * - Only supported over IP. If the MFi proof cannot be created asynchronously, Pair Setup M4 creates it itself.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session over which the request has been received.
+ */
+static void HAPPairingPairSetupPrepareMFiProof(HAPAccessoryServerRef* server_, HAPSessionRef* session_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->pairSetup.sessionThatIsCurrentlyPairing == session_);
+    HAPPrecondition(server->pairSetup.sessionKeyIsAvailable);
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+
+    HAPError err;
+
+    if (session->transportType != kHAPTransportType_IP ||
+        session->state.pairSetup.method != kHAPPairingMethod_PairSetupWithAuth ||
+        !server->platform.authentication.mfiHWAuth || !HAPAccessoryServerSupportsMFiHWAuth(server_)) {
+        return;
+    }
+    if (HAPPairingCryptoJobIsPending(session_) || server->ip.pairSetupMFiProofJob.session) {
+        return;
+    }
+
+    bool restorePrevious = false;
+    if (server->pairSetup.flagsPresent) {
+        restorePrevious = !(server->pairSetup.flags & kHAPPairingFlag_Transient) &&
+                          server->pairSetup.flags & kHAPPairingFlag_Split;
+    }
+    HAPSetupInfo* _Nullable setupInfo = HAPAccessorySetupInfoGetSetupInfo(server_, restorePrevious);
+    if (!setupInfo) {
+        return;
+    }
+
+    // Only sign if the controller's SRP proof is valid. Pair Setup M4 verifies it again.
+    {
+        uint8_t M1[SRP_PROOF_BYTES];
+        static const uint8_t userName[] = "Pair-Setup";
+        HAP_srp_proof_m1(
+                M1,
+                userName,
+                sizeof userName - 1,
+                setupInfo->salt,
+                server->pairSetup.A,
+                server->pairSetup.B,
+                server->pairSetup.K);
+        bool isValid = HAPRawBufferAreEqualConstantTime(M1, server->pairSetup.M1, SRP_PROOF_BYTES);
+        HAPRawBufferZero(M1, sizeof M1);
+        if (!isValid) {
+            return;
+        }
+    }
+
+    // Generate MFi challenge.
+    uint8_t challengeBytes[kHAPMFiHWAuth_MaxChallengeBytes];
+    static const uint8_t salt[] = "MFi-Pair-Setup-Salt";
+    static const uint8_t info[] = "MFi-Pair-Setup-Info";
+    HAP_hkdf_sha512(
+            challengeBytes,
+            sizeof challengeBytes,
+            server->pairSetup.K,
+            sizeof server->pairSetup.K,
+            salt,
+            sizeof salt - 1,
+            info,
+            sizeof info - 1);
+    HAPLogSensitiveBufferDebug(&logObject, challengeBytes, sizeof challengeBytes, "Pair Setup M4: MFiChallenge.");
+
+    err = HAPMFiHWAuthCreateSignatureAsync(
+            &server->mfi,
+            challengeBytes,
+            sizeof challengeBytes,
+            server->pairSetup.mfiProof,
+            sizeof server->pairSetup.mfiProof,
+            HAPPairingPairSetupHandleMFiProofCreated,
+            server_);
+    HAPRawBufferZero(challengeBytes, sizeof challengeBytes);
+    if (err) {
+        HAPLog(&logObject, "Pair Setup M4: Creating MFi proof asynchronously failed. Creating it in Pair Setup M4.");
+        return;
+    }
+    server->ip.pairSetupMFiProofJob.session = session_;
+    server->ip.pairSetupMFiProofJob.jobID = HAPPairingCryptoJobBegin(server_, session_);
+}
+
+static void HAPPairingPairSetupCompleteM4Job(HAPAccessoryServerRef* server_, HAPSessionRef* session_, void* data) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(data);
+    const HAPPairingPairSetupM4Job* job = data;
+
+    if (server->pairSetup.sessionThatIsCurrentlyPairing != session_ || session->state.pairSetup.state != 3 ||
+        session->state.pairSetup.error) {
+        HAPLog(&logObject, "Pair Setup M4: Discarding K after Pair Setup procedure has been reset.");
+        return;
+    }
+
+    if (job->publicKeyAIsIllegal) {
+        server->pairSetup.publicKeyAIsIllegal = true;
+    } else {
+        HAPRawBufferCopyBytes(server->pairSetup.K, job->K, sizeof server->pairSetup.K);
+        server->pairSetup.sessionKeyIsAvailable = true;
+        HAPPairingPairSetupPrepareMFiProof(server_, session_);
+    }
+}
+
+/**
+ * Derives the SRP session key K for Pair Setup M4 while processing Pair Setup M3.
+ *
+ * - If not enough memory is available, Pair Setup M4 derives the SRP session key itself.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session over which the request has been received.
+ * @param      scratchBytes         Free memory.
+ * @param      numScratchBytes      Length of free memory buffer.
+ */
+static void HAPPairingPairSetupPrepareM4(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        void* scratchBytes,
+        size_t numScratchBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->pairSetup.sessionThatIsCurrentlyPairing == session_);
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(session->state.pairSetup.state == 3);
+    HAPPrecondition(!session->state.pairSetup.error);
+    HAPPrecondition(scratchBytes);
+
+    bool restorePrevious = false;
+    if (server->pairSetup.flagsPresent) {
+        restorePrevious = !(server->pairSetup.flags & kHAPPairingFlag_Transient) &&
+                          server->pairSetup.flags & kHAPPairingFlag_Split;
+    }
+    HAPSetupInfo* _Nullable setupInfo = HAPAccessorySetupInfoGetSetupInfo(server_, restorePrevious);
+    if (!setupInfo) {
+        return;
+    }
+
+    HAPPairingPairSetupM4Job* job =
+            HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, sizeof(HAPPairingPairSetupM4Job));
+    if (!job) {
+        return;
+    }
+    HAPRawBufferZero(job, sizeof *job);
+
+    // Compute SRP shared secret key.
+    HAPRawBufferCopyBytes(job->A, server->pairSetup.A, sizeof job->A);
+    HAPRawBufferCopyBytes(job->b, server->pairSetup.b, sizeof job->b);
+    HAP_srp_scrambling_parameter(job->u, server->pairSetup.A, server->pairSetup.B);
+    HAPRawBufferCopyBytes(job->v, setupInfo->verifier, sizeof job->v);
+    HAPPairingCryptoJobRun(
+            server_,
+            session_,
+            HAPPairingPairSetupComputeM4Job,
+            HAPPairingPairSetupCompleteM4Job,
+            job,
+            sizeof *job);
+    HAPRawBufferZero(job, sizeof *job);
+}
+
 /**
  * Processes Pair Setup M4.
  *
@@ -461,9 +840,6 @@ static HAPError HAPPairingPairSetupGetM4(
             return kHAPError_OutOfResources;
         }
 
-        HAP_srp_scrambling_parameter(u, server->pairSetup.A, server->pairSetup.B);
-        HAPLogSensitiveBufferDebug(&logObject, u, SRP_SCRAMBLING_PARAMETER_BYTES, "Pair Setup M4: u.");
-
         bool restorePrevious = false;
         if (server->pairSetup.flagsPresent) {
             restorePrevious = !(server->pairSetup.flags & kHAPPairingFlag_Transient) &&
@@ -472,17 +848,28 @@ static HAPError HAPPairingPairSetupGetM4(
         HAPSetupInfo* _Nullable setupInfo = HAPAccessorySetupInfoGetSetupInfo(server_, restorePrevious);
         HAPAssert(setupInfo);
 
-        int e = HAP_srp_premaster_secret(S, server->pairSetup.A, server->pairSetup.b, u, setupInfo->verifier);
-        if (e) {
-            HAPAssert(e == 1);
-            // Illegal key A.
+        // Derive K unless this has been done while processing Pair Setup M3.
+        if (server->pairSetup.publicKeyAIsIllegal) {
             HAPLog(&logObject, "Pair Setup M4: Illegal key A.");
             session->state.pairSetup.error = kHAPPairingError_Authentication;
             return kHAPError_None;
         }
-        HAPLogSensitiveBufferDebug(&logObject, S, SRP_PREMASTER_SECRET_BYTES, "Pair Setup M4: S.");
+        if (!server->pairSetup.sessionKeyIsAvailable) {
+            HAP_srp_scrambling_parameter(u, server->pairSetup.A, server->pairSetup.B);
+            HAPLogSensitiveBufferDebug(&logObject, u, SRP_SCRAMBLING_PARAMETER_BYTES, "Pair Setup M4: u.");
+
+            int e = HAP_srp_premaster_secret(S, server->pairSetup.A, server->pairSetup.b, u, setupInfo->verifier);
+            if (e) {
+                HAPAssert(e == 1);
+                // Illegal key A.
+                HAPLog(&logObject, "Pair Setup M4: Illegal key A.");
+                session->state.pairSetup.error = kHAPPairingError_Authentication;
+                return kHAPError_None;
+            }
+            HAPLogSensitiveBufferDebug(&logObject, S, SRP_PREMASTER_SECRET_BYTES, "Pair Setup M4: S.");
 
-        HAP_srp_session_key(server->pairSetup.K, S);
+            HAP_srp_session_key(server->pairSetup.K, S);
+        }
         HAPLogSensitiveBufferDebug(&logObject, server->pairSetup.K, sizeof server->pairSetup.K, "Pair Setup M4: K.");
 
         static const uint8_t userName[] = "Pair-Setup";
@@ -497,7 +884,7 @@ static HAPError HAPPairingPairSetupGetM4(
         HAPLogSensitiveBufferDebug(&logObject, M1, SRP_PROOF_BYTES, "Pair Setup M4: M1");
 
         // Verify the controller's SRP proof.
-        if (!HAPRawBufferAreEqual(M1, server->pairSetup.M1, SRP_PROOF_BYTES)) {
+        if (!HAPRawBufferAreEqualConstantTime(M1, server->pairSetup.M1, SRP_PROOF_BYTES)) {
             bool found;
             size_t numBytes;
             uint8_t numAuthAttemptsBytes[sizeof(uint8_t)];
@@ -623,7 +1010,24 @@ static HAPError HAPPairingPairSetupGetM4(
             }
 
             // kTLVType_Signature.
-            {
+            if (server->pairSetup.mfiProofIsAvailable) {
+                HAPLogSensitiveBufferDebug(
+                        &logObject,
+                        server->pairSetup.mfiProof,
+                        server->pairSetup.numMFiProofBytes,
+                        "Pair Setup M4: kTLVType_Signature.");
+
+                // kTLVType_Signature.
+                err = HAPTLVWriterAppend(
+                        &subWriter,
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_Signature,
+                                          .value = { .bytes = server->pairSetup.mfiProof,
+                                                     .numBytes = server->pairSetup.numMFiProofBytes } });
+                if (err) {
+                    HAPAssert(err == kHAPError_OutOfResources);
+                    return err;
+                }
+            } else {
                 void* bytes;
                 size_t maxBytes;
                 HAPTLVWriterGetScratchBytes(&subWriter, &bytes, &maxBytes);
@@ -1288,6 +1692,8 @@ HAPError HAPPairingPairSetupHandleWrite(
                             .stateTLV = &stateTLV, .methodTLV = &methodTLV, .flagsTLV = &flagsTLV });
             if (err) {
                 HAPAssert(err == kHAPError_InvalidData);
+            } else {
+                HAPPairingPairSetupPrepareM2(server_, session_, bytes, maxBytes);
             }
         } break;
         case 2: {
@@ -1299,6 +1705,8 @@ HAPError HAPPairingPairSetupHandleWrite(
                             .stateTLV = &stateTLV, .publicKeyTLV = &publicKeyTLV, .proofTLV = &proofTLV });
             if (err) {
                 HAPAssert(err == kHAPError_InvalidData);
+            } else {
+                HAPPairingPairSetupPrepareM4(server_, session_, bytes, maxBytes);
             }
         } break;
         case 4: {
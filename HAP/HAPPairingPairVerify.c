@@ -336,6 +336,117 @@ static HAPError HAPPairingPairVerifyProcessM1(
     return kHAPError_None;
 }
 
+/**
+ * Pair Verify M2 cryptography job.
+ */
+typedef struct {
+    uint8_t cv_SK[X25519_SCALAR_BYTES];       /**< Accessory's Curve25519 secret key. */
+    uint8_t ed_LTSK[ED25519_SECRET_KEY_BYTES]; /**< Accessory's long-term secret key. */
+    uint8_t ed_LTPK[ED25519_PUBLIC_KEY_BYTES]; /**< Accessory's long-term public key. */
+    uint8_t cv_KEY[X25519_BYTES];              /**< Derived shared secret. */
+    uint8_t signature[ED25519_BYTES];          /**< Derived signature of AccessoryInfo. */
+
+    /** AccessoryInfo: AccessoryCvPK (derived), AccessoryPairingID, iOSDeviceCvPK. */
+    uint8_t info[X25519_BYTES + sizeof(HAPDeviceIDString) + X25519_BYTES];
+    size_t numInfoBytes; /**< Length of AccessoryInfo. */
+} HAPPairingPairVerifyM2Job;
+
+static void HAPPairingPairVerifyComputeM2Job(void* data) {
+    HAPPrecondition(data);
+    HAPPairingPairVerifyM2Job* job = data;
+    HAPPrecondition(job->numInfoBytes >= X25519_BYTES + X25519_BYTES);
+    HAPPrecondition(job->numInfoBytes <= sizeof job->info);
+
+    HAP_X25519_scalarmult_base(job->info, job->cv_SK);
+    HAP_X25519_scalarmult(job->cv_KEY, job->cv_SK, &job->info[job->numInfoBytes - X25519_BYTES]);
+    HAP_ed25519_sign(job->signature, job->info, job->numInfoBytes, job->ed_LTSK, job->ed_LTPK);
+}
+
+static void HAPPairingPairVerifyCompleteM2Job(HAPAccessoryServerRef* server, HAPSessionRef* session_, void* data) {
+    HAPPrecondition(server);
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(data);
+    const HAPPairingPairVerifyM2Job* job = data;
+
+    if (session->state.pairVerify.state != 1 || session->state.pairVerify.method != kHAPPairingMethod_PairVerify ||
+        session->state.pairVerify.error || session->hap.active) {
+        HAPLog(&logObject, "Pair Verify M2: Discarding keys after Pair Verify procedure has been reset.");
+        return;
+    }
+    HAPAssert(HAPRawBufferAreEqual(job->cv_SK, session->state.pairVerify.cv_SK, sizeof job->cv_SK));
+
+    HAPRawBufferCopyBytes(session->state.pairVerify.cv_PK, job->info, sizeof session->state.pairVerify.cv_PK);
+    HAPRawBufferCopyBytes(session->state.pairVerify.cv_KEY, job->cv_KEY, sizeof session->state.pairVerify.cv_KEY);
+    HAPRawBufferCopyBytes(
+            session->state.pairVerify.signature, job->signature, sizeof session->state.pairVerify.signature);
+    session->state.pairVerify.keysAreAvailable = true;
+}
+
+/**
+ * Derives the key pair, shared secret and signature for Pair Verify M2 while processing Pair Verify M1.
+ *
+ * - If the Device ID cannot be loaded or not enough memory is available, Pair Verify M2 derives them itself.
+ *
+ * @param      server_              Accessory server.
+ * @param      session_             The session over which the request has been received.
+ * @param      scratchBytes         Free memory.
+ * @param      numScratchBytes      Length of free memory buffer.
+ */
+static void HAPPairingPairVerifyPrepareM2(
+        HAPAccessoryServerRef* server_,
+        HAPSessionRef* session_,
+        void* scratchBytes,
+        size_t numScratchBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(session->state.pairVerify.state == 1);
+    HAPPrecondition(session->state.pairVerify.method == kHAPPairingMethod_PairVerify);
+    HAPPrecondition(!session->state.pairVerify.error);
+    HAPPrecondition(scratchBytes);
+
+    HAPError err;
+
+    HAPPairingPairVerifyM2Job* job =
+            HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, sizeof(HAPPairingPairVerifyM2Job));
+    if (!job) {
+        return;
+    }
+    HAPRawBufferZero(job, sizeof *job);
+
+    HAPDeviceIDString deviceIDString;
+    err = HAPDeviceIDGetAsString(server->platform.keyValueStore, &deviceIDString);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return;
+    }
+    size_t numDeviceIDStringBytes = HAPStringGetNumBytes(deviceIDString.stringValue);
+
+    // Create new, random key pair.
+    HAPPlatformRandomNumberFill(session->state.pairVerify.cv_SK, sizeof session->state.pairVerify.cv_SK);
+
+    // Generate the shared secret and sign AccessoryInfo.
+    HAPRawBufferCopyBytes(job->cv_SK, session->state.pairVerify.cv_SK, sizeof job->cv_SK);
+    HAPRawBufferCopyBytes(job->ed_LTSK, server->identity.ed_LTSK.bytes, sizeof job->ed_LTSK);
+    HAPRawBufferCopyBytes(job->ed_LTPK, server->identity.ed_LTPK, sizeof job->ed_LTPK);
+    HAPRawBufferCopyBytes(&job->info[X25519_BYTES], deviceIDString.stringValue, numDeviceIDStringBytes);
+    HAPRawBufferCopyBytes(
+            &job->info[X25519_BYTES + numDeviceIDStringBytes],
+            session->state.pairVerify.Controller_cv_PK,
+            sizeof session->state.pairVerify.Controller_cv_PK);
+    job->numInfoBytes = X25519_BYTES + numDeviceIDStringBytes + X25519_BYTES;
+    HAPPairingCryptoJobRun(
+            server_,
+            session_,
+            HAPPairingPairVerifyComputeM2Job,
+            HAPPairingPairVerifyCompleteM2Job,
+            job,
+            sizeof *job);
+    HAPRawBufferZero(job, sizeof *job);
+}
+
 /**
  * Processes Pair Verify M2.
  *
@@ -369,9 +480,15 @@ static HAPError HAPPairingPairVerifyGetM2(
 
     HAPLogDebug(&logObject, "Pair Verify M2: Verify Start Response.");
 
-    // Create new, random key pair.
-    HAPPlatformRandomNumberFill(session->state.pairVerify.cv_SK, sizeof session->state.pairVerify.cv_SK);
-    HAP_X25519_scalarmult_base(session->state.pairVerify.cv_PK, session->state.pairVerify.cv_SK);
+    // Create new, random key pair and generate the shared secret unless this has been done while processing M1.
+    if (!session->state.pairVerify.keysAreAvailable) {
+        HAPPlatformRandomNumberFill(session->state.pairVerify.cv_SK, sizeof session->state.pairVerify.cv_SK);
+        HAP_X25519_scalarmult_base(session->state.pairVerify.cv_PK, session->state.pairVerify.cv_SK);
+        HAP_X25519_scalarmult(
+                session->state.pairVerify.cv_KEY,
+                session->state.pairVerify.cv_SK,
+                session->state.pairVerify.Controller_cv_PK);
+    }
     HAPLogSensitiveBufferDebug(
             &logObject,
             session->state.pairVerify.cv_SK,
@@ -382,12 +499,6 @@ static HAPError HAPPairingPairVerifyGetM2(
             session->state.pairVerify.cv_PK,
             sizeof session->state.pairVerify.cv_PK,
             "Pair Verify M2: cv_PK.");
-
-    // Generate the shared secret.
-    HAP_X25519_scalarmult(
-            session->state.pairVerify.cv_KEY,
-            session->state.pairVerify.cv_SK,
-            session->state.pairVerify.Controller_cv_PK);
     HAPLogSensitiveBufferDebug(
             &logObject,
             session->state.pairVerify.cv_KEY,
@@ -476,7 +587,12 @@ static HAPError HAPPairingPairVerifyGetM2(
         size_t numInfoBytes = X25519_BYTES + numDeviceIDStringBytes + X25519_BYTES;
 
         // Generate signature.
-        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, server->identity.ed_LTSK.bytes, server->identity.ed_LTPK);
+        if (session->state.pairVerify.keysAreAvailable) {
+            HAPRawBufferCopyBytes(signature, session->state.pairVerify.signature, ED25519_BYTES);
+        } else {
+            HAP_ed25519_sign(
+                    signature, infoBytes, numInfoBytes, server->identity.ed_LTSK.bytes, server->identity.ed_LTPK);
+        }
         HAPLogSensitiveBufferDebug(&logObject, infoBytes, numInfoBytes, "Pair Verify M2: AccessoryInfo");
         HAPLogSensitiveBufferDebug(&logObject, signature, ED25519_BYTES, "Pair Verify M2: kTLVType_Signature");
 
@@ -690,6 +806,49 @@ typedef struct {
     HAPTLV* encryptedDataTLV; /**< kTLVType_EncryptedData. */
 } HAPPairingPairVerifyM3TLVs;
 
+/**
+ * Pair Verify M3 cryptography job.
+ */
+typedef struct {
+    uint8_t signature[ED25519_BYTES];          /**< Signature of iOSDeviceInfo. */
+    uint8_t publicKey[ED25519_PUBLIC_KEY_BYTES]; /**< iOS device's long-term public key. */
+
+    /** iOSDeviceInfo: iOSDeviceCvPK, iOSDevicePairingID, AccessoryCvPK. */
+    uint8_t info[X25519_BYTES + sizeof(HAPPairingID) + X25519_BYTES];
+    size_t numInfoBytes;   /**< Length of iOSDeviceInfo. */
+    bool signatureIsValid; /**< Whether the signature is valid. */
+} HAPPairingPairVerifyM3Job;
+
+static void HAPPairingPairVerifyComputeM3Job(void* data) {
+    HAPPrecondition(data);
+    HAPPairingPairVerifyM3Job* job = data;
+    HAPPrecondition(job->numInfoBytes <= sizeof job->info);
+
+    int e = HAP_ed25519_verify(job->signature, job->info, job->numInfoBytes, job->publicKey);
+    if (e) {
+        HAPAssert(e == -1);
+    }
+    job->signatureIsValid = !e;
+}
+
+static void HAPPairingPairVerifyCompleteM3Job(HAPAccessoryServerRef* server, HAPSessionRef* session_, void* data) {
+    HAPPrecondition(server);
+    HAPPrecondition(session_);
+    HAPSession* session = (HAPSession*) session_;
+    HAPPrecondition(data);
+    const HAPPairingPairVerifyM3Job* job = data;
+
+    if (session->state.pairVerify.state != 3 || session->state.pairVerify.error || session->hap.active) {
+        HAPLog(&logObject, "Pair Verify M3: Discarding signature verification after Pair Verify procedure reset.");
+        return;
+    }
+
+    if (!job->signatureIsValid) {
+        HAPLog(&logObject, "Pair Verify M3: iOSDeviceInfo signature is incorrect.");
+        session->state.pairVerify.error = kHAPPairingError_Authentication;
+    }
+}
+
 /**
  * Processes Pair Verify M3.
  *
@@ -846,18 +1005,18 @@ static HAPError HAPPairingPairVerifyProcessM3(
     }
     session->state.pairVerify.pairingID = (int) key;
 
-    void* iOSDeviceCvPK = HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, X25519_BYTES);
-    void* iOSDevicePairingID =
-            HAPTLVScratchBufferAllocUnaligned(&scratchBytes, &numScratchBytes, identifierTLV.value.numBytes);
-    void* accessoryCvPK = HAPTLVScratchBufferAllocUnaligned(&scratchBytes, &numScratchBytes, X25519_BYTES);
-    if (!iOSDeviceCvPK || !iOSDevicePairingID || !accessoryCvPK) {
-        HAPLog(&logObject,
-               "Pair Verify M3: Not enough memory to allocate"
-               " iOSDeviceCvPK / iOSDevicePairingID / AccessoryCvPK.");
+    HAPPairingPairVerifyM3Job* job =
+            HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, sizeof(HAPPairingPairVerifyM3Job));
+    if (!job) {
+        HAPLog(&logObject, "Pair Verify M3: Not enough memory to allocate iOSDeviceInfo.");
         return kHAPError_OutOfResources;
     }
+    HAPRawBufferZero(job, sizeof *job);
 
     // Construct iOSDeviceInfo: iOSDeviceCvPK, iOSDevicePairingID, AccessoryCvPK.
+    uint8_t* iOSDeviceCvPK = &job->info[0];
+    uint8_t* iOSDevicePairingID = &job->info[X25519_BYTES];
+    uint8_t* accessoryCvPK = &job->info[X25519_BYTES + identifierTLV.value.numBytes];
     HAPRawBufferCopyBytes(
             iOSDeviceCvPK,
             session->state.pairVerify.Controller_cv_PK,
@@ -866,20 +1025,22 @@ static HAPError HAPPairingPairVerifyProcessM3(
     HAPRawBufferCopyBytes(accessoryCvPK, session->state.pairVerify.cv_PK, sizeof session->state.pairVerify.cv_PK);
 
     // Finalize info.
-    void* infoBytes = iOSDeviceCvPK;
-    size_t numInfoBytes = X25519_BYTES + identifierTLV.value.numBytes + X25519_BYTES;
-    HAPLogSensitiveBufferDebug(&logObject, infoBytes, numInfoBytes, "Pair Verify M3: iOSDeviceInfo.");
+    job->numInfoBytes = X25519_BYTES + identifierTLV.value.numBytes + X25519_BYTES;
+    HAPLogSensitiveBufferDebug(&logObject, job->info, job->numInfoBytes, "Pair Verify M3: iOSDeviceInfo.");
 
     // Verify signature.
     HAPLogSensitiveBufferDebug(
             &logObject, signatureTLV.value.bytes, signatureTLV.value.numBytes, "Pair Verify M3: kTLVType_Signature.");
-    e = HAP_ed25519_verify(signatureTLV.value.bytes, infoBytes, numInfoBytes, pairing.publicKey.value);
-    if (e) {
-        HAPAssert(e == -1);
-        HAPLog(&logObject, "Pair Verify M3: iOSDeviceInfo signature is incorrect.");
-        session->state.pairVerify.error = kHAPPairingError_Authentication;
-        return kHAPError_None;
-    }
+    HAPRawBufferCopyBytes(job->signature, HAPNonnullVoid(signatureTLV.value.bytes), sizeof job->signature);
+    HAPRawBufferCopyBytes(job->publicKey, pairing.publicKey.value, sizeof job->publicKey);
+    HAPPairingCryptoJobRun(
+            server_,
+            session_,
+            HAPPairingPairVerifyComputeM3Job,
+            HAPPairingPairVerifyCompleteM3Job,
+            job,
+            sizeof *job);
+    HAPRawBufferZero(job, sizeof *job);
 
     return kHAPError_None;
 }
@@ -1027,6 +1188,10 @@ HAPError HAPPairingPairVerifyHandleWrite(
                                                           .encryptedDataTLV = &encryptedDataTLV });
             if (err) {
                 HAPAssert(err == kHAPError_InvalidData || err == kHAPError_OutOfResources);
+            } else if (
+                    session->state.pairVerify.method == kHAPPairingMethod_PairVerify &&
+                    !session->state.pairVerify.error) {
+                HAPPairingPairVerifyPrepareM2(server, session_, bytes, maxBytes);
             }
         } break;
         case 2: {
@@ -137,6 +137,9 @@ typedef struct {
             uint8_t cv_KEY[X25519_BYTES];                    // Key (SK, CTRL PK)
             int pairingID;
             uint8_t Controller_cv_PK[X25519_BYTES]; // CTRL PK
+
+            uint8_t signature[ED25519_BYTES]; // Signature of AccessoryInfo.
+            bool keysAreAvailable : 1;        /**< Whether cv_PK, cv_KEY and signature were derived at M1. */
         } pairVerify;
 
         /**
@@ -153,6 +156,11 @@ typedef struct {
         } pairings;
     } state;
 
+    /**
+     * Identifier of the pending pairing cryptography job. 0 if no job is pending.
+     */
+    uint32_t pairingCryptoJobID;
+
     /**
      * Type of the underlying transport.
      */
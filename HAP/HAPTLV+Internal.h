@@ -129,6 +129,99 @@ void HAPTLVReaderGetScratchBytes(
         void* _Nonnull* _Nonnull scratchBytes,
         size_t* numScratchBytes);
 
+/**
+ * Read-only TLV reader.
+ *
+ * - Unlike HAPTLVReader, the buffer containing the TLV data is not modified. Fragments of a TLV item are not merged
+ *   but are exposed through HAPTLVFragmentedItemGetFragment. A contiguous copy of the value may be requested using
+ *   HAPTLVFragmentedItemGetBytes if needed.
+ *
+ * - Each TLV item is validated in a single pass over its fragment headers.
+ */
+typedef struct {
+    /**@cond */
+    const void* _Nullable bytes; /**< Buffer containing remaining TLV data. */
+    size_t numBytes;             /**< Length of remaining TLV data. */
+    /**@endcond */
+} HAPTLVFragmentReader;
+
+/**
+ * TLV item that may consist of multiple fragments.
+ *
+ * - Fragments of a TLV item are contiguous in the underlying buffer. All fragments but the last one contain
+ *   255 bytes of value data. Each fragment is preceded by a 2 byte TLV header.
+ */
+typedef struct {
+    /** Type. */
+    HAPTLVType type;
+
+    /** Start of the TLV header of the first fragment. */
+    const void* bytes;
+
+    /** Length of the value, excluding TLV headers. */
+    size_t numValueBytes;
+
+    /** Number of fragments. At least 1. */
+    size_t numFragments;
+} HAPTLVFragmentedItem;
+
+/**
+ * Initializes a read-only TLV reader.
+ *
+ * @param[out] reader               Reader to initialize.
+ * @param      bytes                Buffer containing raw TLV data. Must remain valid while TLV items are accessed.
+ * @param      numBytes             Length of buffer.
+ */
+void HAPTLVFragmentReaderCreate(HAPTLVFragmentReader* reader, const void* _Nullable bytes, size_t numBytes);
+
+/**
+ * Fetches the next TLV item from a read-only TLV reader's buffer.
+ *
+ * @param      reader               Reader to fetch TLV item from.
+ * @param[out] found                True if a TLV item has been fetched. False otherwise.
+ * @param[out] item                 Next TLV item. Valid when @p found is true.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If parsing failed (Incomplete item, or violation of TLV rules).
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVFragmentReaderGetNext(HAPTLVFragmentReader* reader, bool* found, HAPTLVFragmentedItem* item);
+
+/**
+ * Gets a fragment of a TLV item.
+ *
+ * @param      item                 TLV item.
+ * @param      fragmentIndex        Index of the fragment. Must be less than the number of fragments.
+ * @param[out] bytes                Value data of the fragment.
+ * @param[out] numBytes             Length of the value data of the fragment.
+ */
+void HAPTLVFragmentedItemGetFragment(
+        const HAPTLVFragmentedItem* item,
+        size_t fragmentIndex,
+        const void* _Nonnull* _Nonnull bytes,
+        size_t* numBytes);
+
+/**
+ * Gets the value of a TLV item as a contiguous buffer.
+ *
+ * - Values that consist of a single fragment are returned in place without copying.
+ *   Otherwise, fragments are copied into the provided scratch buffer.
+ *
+ * @param      item                 TLV item.
+ * @param      scratchBytes         Scratch buffer for values that consist of multiple fragments.
+ * @param      maxScratchBytes      Capacity of scratch buffer.
+ * @param[out] bytes                Value of the TLV item.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the scratch buffer is not large enough to hold the value.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVFragmentedItemGetBytes(
+        const HAPTLVFragmentedItem* item,
+        void* _Nullable scratchBytes,
+        size_t maxScratchBytes,
+        const void* _Nonnull* _Nonnull bytes);
+
 /**
  * TLV writer.
  */
@@ -140,6 +233,21 @@ typedef struct {
 } HAPTLVWriter;
 HAP_STATIC_ASSERT(sizeof(HAPTLVWriterRef) >= sizeof(HAPTLVWriter), HAPTLVWriter);
 
+/**
+ * Appends TLV items that have already been encoded, e.g. a precomputed response body.
+ *
+ * - The first TLV item must have a different type than the last TLV item that has been appended before.
+ *
+ * @param      writer               TLV writer.
+ * @param      bytes                Encoded TLV items.
+ * @param      numBytes             Length of encoded TLV items.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If writer does not have enough capacity.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVWriterAppendEncodedItems(HAPTLVWriterRef* writer, const void* bytes, size_t numBytes);
+
 /**
  * Allocates bytes of memory inside a scratch buffer.
  *
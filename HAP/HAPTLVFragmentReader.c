@@ -0,0 +1,153 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "TLVReader" };
+
+/**
+ * Number of bytes of a complete TLV fragment, including the TLV header.
+ */
+#define kHAPTLVFragmentReader_NumFragmentBytes ((size_t)(2 + UINT8_MAX))
+
+void HAPTLVFragmentReaderCreate(HAPTLVFragmentReader* reader, const void* _Nullable bytes, size_t numBytes) {
+    HAPPrecondition(reader);
+    HAPPrecondition(!numBytes || bytes);
+
+    HAPRawBufferZero(reader, sizeof *reader);
+    reader->bytes = bytes;
+    reader->numBytes = numBytes;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVFragmentReaderGetNext(HAPTLVFragmentReader* reader, bool* found, HAPTLVFragmentedItem* item) {
+    HAPPrecondition(reader);
+    HAPPrecondition(found);
+    HAPPrecondition(item);
+
+    *found = false;
+
+    const uint8_t* bytes = reader->bytes;
+    size_t maxBytes = reader->numBytes;
+    size_t o = 0;
+
+    if (!maxBytes) {
+        return kHAPError_None;
+    }
+    HAPAssert(bytes);
+
+    // Read TLV header.
+    if (maxBytes < 2) {
+        HAPLog(&logObject, "Found incomplete TLV fragment header with length %zu.", maxBytes);
+        return kHAPError_InvalidData;
+    }
+    HAPTLVType type = bytes[o];
+    size_t numFragmentBytes = bytes[o + 1];
+    o += 2;
+    if (maxBytes - o < numFragmentBytes) {
+        HAPLog(&logObject, "Found incomplete TLV fragment body with length %zu.", maxBytes - o);
+        return kHAPError_InvalidData;
+    }
+    o += numFragmentBytes;
+    size_t numValueBytes = numFragmentBytes;
+    size_t numFragments = 1;
+
+    // Read additional fragments (long TLV).
+    while (o < maxBytes && bytes[o] == type) {
+        // Read TLV header.
+        if (maxBytes - o < 2) {
+            HAPLog(&logObject, "Found incomplete TLV fragment header with length %zu.", maxBytes - o);
+            return kHAPError_InvalidData;
+        }
+
+        // Only the last TLV fragment item in series of contiguous TLV fragment items may have non-255 byte length.
+        if (numFragmentBytes != UINT8_MAX) {
+            HAPLog(&logObject, "Found additional TLV fragment after previous fragment with non-255 byte length.");
+            return kHAPError_InvalidData;
+        }
+
+        // Each TLV fragment item must have a non-0 length.
+        numFragmentBytes = bytes[o + 1];
+        if (!numFragmentBytes) {
+            HAPLog(&logObject, "Found TLV fragment item with 0 length.");
+            return kHAPError_InvalidData;
+        }
+        o += 2;
+
+        if (maxBytes - o < numFragmentBytes) {
+            HAPLog(&logObject, "Found incomplete TLV fragment body with length %zu.", maxBytes - o);
+            return kHAPError_InvalidData;
+        }
+        o += numFragmentBytes;
+        numValueBytes += numFragmentBytes;
+        numFragments++;
+    }
+
+    item->type = type;
+    item->bytes = bytes;
+    item->numValueBytes = numValueBytes;
+    item->numFragments = numFragments;
+
+    // Update reader state.
+    reader->bytes = &bytes[o];
+    reader->numBytes -= o;
+
+    *found = true;
+    return kHAPError_None;
+}
+
+void HAPTLVFragmentedItemGetFragment(
+        const HAPTLVFragmentedItem* item,
+        size_t fragmentIndex,
+        const void* _Nonnull* _Nonnull bytes,
+        size_t* numBytes) {
+    HAPPrecondition(item);
+    HAPPrecondition(fragmentIndex < item->numFragments);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    const uint8_t* fragmentBytes =
+            &((const uint8_t*) item->bytes)[fragmentIndex * kHAPTLVFragmentReader_NumFragmentBytes];
+    *bytes = &fragmentBytes[2];
+    *numBytes = fragmentBytes[1];
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVFragmentedItemGetBytes(
+        const HAPTLVFragmentedItem* item,
+        void* _Nullable scratchBytes,
+        size_t maxScratchBytes,
+        const void* _Nonnull* _Nonnull bytes) {
+    HAPPrecondition(item);
+    HAPPrecondition(!maxScratchBytes || scratchBytes);
+    HAPPrecondition(bytes);
+
+    if (item->numFragments == 1) {
+        *bytes = &((const uint8_t*) item->bytes)[2];
+        return kHAPError_None;
+    }
+
+    if (maxScratchBytes < item->numValueBytes) {
+        HAPLog(&logObject,
+               "[%02x] Not enough memory to merge %zu TLV fragments (%zu bytes).",
+               item->type,
+               item->numFragments,
+               item->numValueBytes);
+        return kHAPError_OutOfResources;
+    }
+    uint8_t* destinationBytes = HAPNonnullVoid(scratchBytes);
+    size_t o = 0;
+    for (size_t i = 0; i < item->numFragments; i++) {
+        const void* fragmentBytes;
+        size_t numFragmentBytes;
+        HAPTLVFragmentedItemGetFragment(item, i, &fragmentBytes, &numFragmentBytes);
+        HAPRawBufferCopyBytes(&destinationBytes[o], fragmentBytes, numFragmentBytes);
+        o += numFragmentBytes;
+    }
+    HAPAssert(o == item->numValueBytes);
+    *bytes = destinationBytes;
+    return kHAPError_None;
+}
@@ -74,7 +74,6 @@ HAPError HAPTLVReaderGetNext(HAPTLVReaderRef* reader_, bool* found, HAPTLV* tlv)
     o += numFragmentBytes;
     maxBytes -= numFragmentBytes;
     o += 2;
-    HAPRawBufferZero(&bytes[o - 2 * numFragments], 2 * numFragments);
 
     // Read additional chunks (long TLV).
     while (maxBytes && bytes[o] == tlv->type) {
@@ -110,9 +109,11 @@ HAPError HAPTLVReaderGetNext(HAPTLVReaderRef* reader_, bool* found, HAPTLV* tlv)
         o += numFragmentBytes;
         maxBytes -= numFragmentBytes;
         o += 2;
-        HAPRawBufferZero(&bytes[o - 2 * numFragments], 2 * numFragments);
     }
 
+    // Clear the space that was freed by merging the fragments. This also NULL-terminates the value.
+    HAPRawBufferZero(&bytes[o - 2 * numFragments], 2 * numFragments);
+
     // Update reader state.
     reader->bytes = &bytes[o];
     reader->numBytes -= o;
@@ -33,52 +33,104 @@ HAPError HAPTLVWriterAppend(HAPTLVWriterRef* writer_, const HAPTLV* tlv) {
         HAPPrecondition(tlv->type != writer->lastType);
     }
 
-    uint8_t* destinationBytes = HAPNonnullVoid(writer->bytes);
+    uint8_t* bytes = HAPNonnullVoid(writer->bytes);
+    uint8_t* destinationBytes = &bytes[writer->numBytes];
     size_t maxDestinationBytes = writer->maxBytes - writer->numBytes;
 
     const uint8_t* _Nullable valueBytes = tlv->value.bytes;
     size_t numValueBytes = tlv->value.numBytes;
 
-    // Serialize TLV, fragment by fragment.
-    do {
-        size_t numFragmentBytes = numValueBytes > UINT8_MAX ? UINT8_MAX : numValueBytes;
+    // Values longer than 255 bytes are split into fragments, each with its own TLV header.
+    // An empty value is serialized as a single fragment with a TLV header only.
+    size_t numFragments = numValueBytes ? (numValueBytes + UINT8_MAX - 1) / UINT8_MAX : 1;
+    if (maxDestinationBytes < 2) {
+        // TLV header does not fit into buffer.
+        HAPLog(&logObject, "Not enough memory to write TLV header.");
+        return kHAPError_OutOfResources;
+    }
+    if (maxDestinationBytes < numValueBytes || maxDestinationBytes - numValueBytes < 2 * numFragments) {
+        // Value does not fit into buffer.
+        HAPLog(&logObject, "Not enough memory to write TLV value.");
+        return kHAPError_OutOfResources;
+    }
 
-        // Consume space needed for header.
-        if (maxDestinationBytes < 2) {
-            // TLV header does not fit into buffer.
-            HAPLog(&logObject, "Not enough memory to write TLV header.");
-            return kHAPError_OutOfResources;
+    // Since the value may be located in the memory after serialized TLV data (scratch bytes), each fragment is moved
+    // to its final position exactly once. The fragment order is chosen so that no fragment or TLV header overwrites
+    // parts of the value that have not been moved yet:
+    // - If the value starts at most one TLV header after the destination, fragments only move towards the end.
+    //   Processing them from last to first keeps preceding parts of the value intact.
+    // - If the value starts at least 2 * (numFragments - 1) bytes after the destination, fragments only move towards
+    //   the beginning. Processing them from first to last keeps subsequent parts of the value intact.
+    // - Otherwise, the value is first moved behind the space that is needed for the TLV headers.
+    if (valueBytes) {
+        uintptr_t valueAddress = (uintptr_t) valueBytes;
+        uintptr_t destinationAddress = (uintptr_t) destinationBytes;
+        if (valueAddress > destinationAddress + 2 && valueAddress - destinationAddress < 2 * (numFragments - 1)) {
+            HAPRawBufferCopyBytes(&destinationBytes[2 * numFragments], HAPNonnull(valueBytes), numValueBytes);
+            valueBytes = &destinationBytes[2 * numFragments];
+            valueAddress = (uintptr_t) valueBytes;
         }
-        maxDestinationBytes -= 2;
-
-        if (valueBytes) {
-            // Since the memory after serialized TLV data may have been used by the client,
-            // move that data to accommodate the TLV header.
-            if (maxDestinationBytes < numValueBytes) {
-                // Value does not fit into buffer.
-                HAPLog(&logObject, "Not enough memory to write TLV value.");
-                return kHAPError_OutOfResources;
+        if (valueAddress <= destinationAddress + 2) {
+            for (size_t i = numFragments; i--;) {
+                size_t numFragmentBytes = HAPMin(numValueBytes - i * UINT8_MAX, UINT8_MAX);
+                uint8_t* fragmentBytes = &destinationBytes[i * (2 + UINT8_MAX)];
+                HAPRawBufferCopyBytes(&fragmentBytes[2], &HAPNonnull(valueBytes)[i * UINT8_MAX], numFragmentBytes);
+                fragmentBytes[0] = (uint8_t) tlv->type;
+                fragmentBytes[1] = (uint8_t) numFragmentBytes;
             }
-            // Entire remaining value is copied, including followup fragments.
-            HAPRawBufferCopyBytes(&destinationBytes[writer->numBytes + 2], HAPNonnull(valueBytes), numValueBytes);
-            valueBytes = &destinationBytes[writer->numBytes + 2];
-            maxDestinationBytes -= numFragmentBytes;
-            numValueBytes -= numFragmentBytes;
-            valueBytes += numFragmentBytes;
         } else {
-            HAPAssert(!numValueBytes);
+            for (size_t i = 0; i < numFragments; i++) {
+                size_t numFragmentBytes = HAPMin(numValueBytes - i * UINT8_MAX, UINT8_MAX);
+                uint8_t* fragmentBytes = &destinationBytes[i * (2 + UINT8_MAX)];
+                HAPRawBufferCopyBytes(&fragmentBytes[2], &HAPNonnull(valueBytes)[i * UINT8_MAX], numFragmentBytes);
+                fragmentBytes[0] = (uint8_t) tlv->type;
+                fragmentBytes[1] = (uint8_t) numFragmentBytes;
+            }
         }
-
-        // Serialize fragment.
-        destinationBytes[writer->numBytes++] = (uint8_t) tlv->type;
-        destinationBytes[writer->numBytes++] = (uint8_t) numFragmentBytes;
-        writer->numBytes += numFragmentBytes;
-    } while (numValueBytes);
+    } else {
+        HAPAssert(!numValueBytes);
+        destinationBytes[0] = (uint8_t) tlv->type;
+        destinationBytes[1] = 0;
+    }
+    writer->numBytes += numValueBytes + 2 * numFragments;
 
     writer->lastType = tlv->type;
     return kHAPError_None;
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPTLVWriterAppendEncodedItems(HAPTLVWriterRef* writer_, const void* bytes_, size_t numBytes) {
+    HAPPrecondition(writer_);
+    HAPTLVWriter* writer = (HAPTLVWriter*) writer_;
+    HAPPrecondition(bytes_);
+    const uint8_t* bytes = bytes_;
+
+    if (!numBytes) {
+        return kHAPError_None;
+    }
+
+    // Find the type of the last TLV item.
+    size_t lastItemOffset = 0;
+    for (size_t i = 0; i < numBytes; i += 2 + bytes[i + 1]) {
+        HAPPrecondition(numBytes - i >= 2);
+        HAPPrecondition(numBytes - i - 2 >= bytes[i + 1]);
+        lastItemOffset = i;
+    }
+    if (writer->numBytes) {
+        HAPPrecondition(bytes[0] != writer->lastType);
+    }
+
+    if (writer->maxBytes - writer->numBytes < numBytes) {
+        HAPLog(&logObject, "Not enough memory to write TLV items.");
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(&((uint8_t*) writer->bytes)[writer->numBytes], bytes, numBytes);
+    writer->numBytes += numBytes;
+
+    writer->lastType = bytes[lastItemOffset];
+    return kHAPError_None;
+}
+
 void HAPTLVWriterGetBuffer(const HAPTLVWriterRef* writer_, void* _Nonnull* _Nonnull bytes, size_t* numBytes) {
     HAPPrecondition(writer_);
     const HAPTLVWriter* writer = (const HAPTLVWriter*) writer_;
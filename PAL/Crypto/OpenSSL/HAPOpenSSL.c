@@ -102,7 +102,7 @@ void HAP_X25519_scalarmult(
                 HAPAssert(ret == 1);
                 ret = EVP_PKEY_derive_set_peer(ctx, peer);
                 HAPAssert(ret == 1);
-                size_t r_len;
+                size_t r_len = X25519_BYTES;
                 ret = EVP_PKEY_derive(ctx, r, &r_len);
                 HAPAssert(ret == 1 && r_len == X25519_BYTES);
             });
@@ -436,6 +436,16 @@ static void copy_and_free_if_overlapping(uint8_t** tmp, uint8_t** out, size_t n)
     }
 }
 
+// OpenSSL 3 only accepts 96-bit nonces. Shorter nonces are padded with leading zeros as OpenSSL 1.1 did implicitly.
+#define kChaCha20Poly1305_NonceBytes ((size_t) 12)
+
+static const uint8_t* pad_nonce(uint8_t padded_n[kChaCha20Poly1305_NonceBytes], const uint8_t* n, size_t n_len) {
+    HAPAssert(n_len <= kChaCha20Poly1305_NonceBytes);
+    memset(padded_n, 0, kChaCha20Poly1305_NonceBytes - n_len);
+    memcpy(&padded_n[kChaCha20Poly1305_NonceBytes - n_len], n, n_len);
+    return padded_n;
+}
+
 void HAP_chacha20_poly1305_init(
         HAP_chacha20_poly1305_ctx* ctx,
         const uint8_t* n HAP_UNUSED,
@@ -461,9 +471,10 @@ void HAP_chacha20_poly1305_update_enc(
         HAPAssert(ret == 1);
         ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_TAG, CHACHA20_POLY1305_TAG_BYTES, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, n_len, NULL);
+        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, kChaCha20Poly1305_NonceBytes, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_EncryptInit_ex(handle->ctx, NULL, NULL, k, n);
+        uint8_t padded_n[kChaCha20Poly1305_NonceBytes];
+        ret = EVP_EncryptInit_ex(handle->ctx, NULL, NULL, k, pad_nonce(padded_n, n, n_len));
         HAPAssert(ret == 1);
     }
     if (m_len > 0) {
@@ -514,9 +525,10 @@ void HAP_chacha20_poly1305_update_dec(
         handle->ctx = EVP_CIPHER_CTX_new();
         int ret = EVP_DecryptInit_ex(handle->ctx, EVP_chacha20_poly1305(), 0, 0, 0);
         HAPAssert(ret == 1);
-        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, n_len, NULL);
+        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, kChaCha20Poly1305_NonceBytes, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_DecryptInit_ex(handle->ctx, NULL, NULL, k, n);
+        uint8_t padded_n[kChaCha20Poly1305_NonceBytes];
+        ret = EVP_DecryptInit_ex(handle->ctx, NULL, NULL, k, pad_nonce(padded_n, n, n_len));
         HAPAssert(ret == 1);
     }
     if (c_len > 0) {
@@ -59,18 +59,6 @@ static int32_t BigintComp(const Bigint* x, const Bigint* y) {
     return 0;
 }
 
-// z = x + y
-static void BigintAdd(const Bigint* x, const Bigint* y, Bigint* z) {
-    uint32_t c = 0, i = 0, nx = x->len, ny = y->len;
-    while (i < nx || i < ny || c != 0) {
-        c += (i < nx ? x->w[i] : 0) + (i < ny ? y->w[i] : 0);
-        z->w[i] = c & kInt_BitMask;
-        c >>= kInt_BitsPerWord;
-        i++;
-    }
-    z->len = i;
-}
-
 // x = x * n, 2 <= n <= 10
 static void BigintMul(Bigint* x, uint32_t n) {
     uint32_t c = 0, i = 0, nx = x->len;
@@ -110,6 +98,104 @@ static uint32_t BigintDivRem(Bigint* x, const Bigint* y) {
     return q;
 }
 
+//----------------------------- Fast Path Conversion ------------------------------
+
+static const uint64_t kPow10[] = { 1,
+                                   10,
+                                   100,
+                                   1000,
+                                   10000,
+                                   100000,
+                                   1000000,
+                                   10000000,
+                                   100000000,
+                                   1000000000,
+                                   10000000000,
+                                   100000000000,
+                                   1000000000000,
+                                   10000000000000,
+                                   100000000000000,
+                                   1000000000000000,
+                                   10000000000000000,
+                                   100000000000000000,
+                                   1000000000000000000,
+                                   10000000000000000000U };
+
+// Largest negative decimal exponent handled by the fast path.
+// A normalized 64-bit mantissa divided by 10^11 still keeps more than 24 + 2 significant bits.
+#define kFloat_FastPathMaxNegativeExp10 (11)
+
+/**
+ * Converts mant * 10^exp10 to a float bit pattern using exact 64-bit integer arithmetic.
+ *
+ * - Only applicable if mant * 10^exp10 is an integer that fits into 64 bits,
+ *   or if exp10 is small enough that the quotient retains enough precision to round correctly.
+ *
+ * @param      mant                 Decimal mantissa. Must not be zero.
+ * @param      exp10                Decimal exponent.
+ * @param[out] bits                 Bit pattern of the correctly rounded absolute float value.
+ *
+ * @return true                     If the conversion was handled by the fast path.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool GetBitPatternFast(uint64_t mant, int exp10, uint32_t* bits) {
+    HAPPrecondition(mant);
+    HAPPrecondition(bits);
+
+    uint64_t value;
+    int exp2 = 0;           // Base 2 exponent.
+    bool isInexact = false; // Bits were lost below value.
+    if (exp10 >= 0) {
+        if ((size_t) exp10 >= HAPArrayCount(kPow10) || mant > UINT64_MAX / kPow10[exp10]) {
+            return false;
+        }
+        value = mant * kPow10[exp10];
+    } else {
+        if (-exp10 > kFloat_FastPathMaxNegativeExp10) {
+            return false;
+        }
+        // Normalize mantissa to 64 bits before dividing.
+        for (int shift = 32; shift > 0; shift /= 2) {
+            if (!(mant >> (64 - shift))) {
+                mant <<= shift;
+                exp2 -= shift;
+            }
+        }
+        value = mant / kPow10[-exp10];
+        isInexact = mant % kPow10[-exp10] != 0;
+    }
+    /* |value| == value * 2^exp2 (+ isInexact), value > 0 */
+
+    int msb = 63; // Position of most significant bit.
+    while (!(value >> msb)) {
+        msb--;
+    }
+    uint32_t bitsValue; // Mantissa bits (1.23).
+    if (msb <= 23) {
+        HAPAssert(!isInexact);
+        bitsValue = (uint32_t)(value << (23 - msb));
+    } else {
+        int shift = msb - 23;
+        bitsValue = (uint32_t)(value >> shift);
+        uint64_t rest = value & ((((uint64_t) 1) << shift) - 1);
+        uint64_t half = ((uint64_t) 1) << (shift - 1);
+        // Round to even.
+        if (rest > half || (rest == half && (isInexact || (bitsValue & 1)))) {
+            bitsValue++;
+        }
+        if (bitsValue >= 0x1000000) {
+            // Rounding overflow.
+            bitsValue >>= 1;
+            msb++;
+        }
+    }
+    exp2 += msb;
+    HAPAssert(exp2 >= -126 && exp2 <= 127);
+    *bits = (bitsValue & 0x7FFFFF) + ((uint32_t)(exp2 + 127) << 23);
+    return true;
+}
+
 //-----------------------------------------------------------
 
 HAP_RESULT_USE_CHECK
@@ -138,7 +224,8 @@ HAPError HAPFloatFromString(const char* string, float* value) {
     uint64_t mant = 0;
     int dp = 0;
     int digits = 0;
-    int exp10 = 0; // Base 10 exponent.
+    int exp10 = 0;            // Base 10 exponent.
+    bool isTruncated = false; // Non-zero digits were dropped from mantissa.
     for (;;) {
         if (c == '.' && !dp) {
             dp = 1;
@@ -148,6 +235,8 @@ HAPError HAPFloatFromString(const char* string, float* value) {
             if (mant < 100000000000000000ll) { // 10^17
                 mant = mant * 10 + (uint64_t)(c - '0');
                 exp10--;
+            } else if (c != '0') {
+                isTruncated = true;
             }
             digits++;
         } else {
@@ -205,6 +294,15 @@ HAPError HAPFloatFromString(const char* string, float* value) {
     }
     /* -63 <= exp10 <= 38 */
 
+    // Most values (e.g., "21.5", "0.1", "100") can be converted exactly without Bigint arithmetic.
+    if (!isTruncated) {
+        uint32_t bits;
+        if (GetBitPatternFast(mant, exp10, &bits)) {
+            *value = HAPFloatFromBitPattern(bits + sign);
+            return kHAPError_None;
+        }
+    }
+
     // Base change.
     Bigint X, S;
     BigintInit(&X, mant);
@@ -266,164 +364,413 @@ HAPError HAPFloatFromString(const char* string, float* value) {
     return kHAPError_None;
 }
 
+//----------------------------- Shortest Decimal Conversion ------------------------------
+
+// Shortest round-trip decimal conversion, following the Ryu algorithm by Ulf Adams (PLDI 2018).
+// The digits are identical to those of a Steele & White style free-format conversion:
+// - The decimal is the shortest one that lies within the rounding interval of the float.
+// - If there are multiple candidates of that length, the closest one is chosen (ties to even).
+
+#define kFloat_MantissaBits      (23)
+#define kFloat_ExponentBias      (127)
+#define kFloat_Pow5InvBitCount   (59)
+#define kFloat_Pow5BitCount      (61)
+#define kFloat_MaxDecimalDigits  (9)
+
+// floor(2^(pow5bits(i) - 1 + kFloat_Pow5InvBitCount) / 5^i) + 1
+static const uint64_t kFloatPow5InvSplit[] = {
+    0x0800000000000001, 0x0666666666666667, 0x051EB851EB851EB9, 0x04189374BC6A7EFA,
+    0x068DB8BAC710CB2A, 0x053E2D6238DA3C22, 0x0431BDE82D7B634E, 0x06B5FCA6AF2BD216,
+    0x055E63B88C230E78, 0x044B82FA09B5A52D, 0x06DF37F675EF6EAE, 0x057F5FF85E592558,
+    0x0465E6604B7A8447, 0x0709709A125DA071, 0x05A126E1A84AE6C1, 0x0480EBE7B9D58567,
+    0x0734ACA5F6226F0B, 0x05C3BD5191B525A3, 0x049C97747490EAE9, 0x0760F253EDB4AB0E,
+    0x05E72843249088D8, 0x04B8ED0283A6D3E0, 0x078E480405D7B966, 0x060B6CD004AC9452,
+    0x04D5F0A66A23A9DB, 0x07BCB43D769F762B, 0x063090312BB2C4EF, 0x04F3A68DBC8F03F3,
+    0x07EC3DAF94180651, 0x065697BFA9ACD1DA, 0x051212FFBAF0A7E2,
+};
+
+// 5^i, normalized to kFloat_Pow5BitCount bits.
+static const uint64_t kFloatPow5Split[] = {
+    0x1000000000000000, 0x1400000000000000, 0x1900000000000000, 0x1F40000000000000,
+    0x1388000000000000, 0x186A000000000000, 0x1E84800000000000, 0x1312D00000000000,
+    0x17D7840000000000, 0x1DCD650000000000, 0x12A05F2000000000, 0x174876E800000000,
+    0x1D1A94A200000000, 0x12309CE540000000, 0x16BCC41E90000000, 0x1C6BF52634000000,
+    0x11C37937E0800000, 0x16345785D8A00000, 0x1BC16D674EC80000, 0x1158E460913D0000,
+    0x15AF1D78B58C4000, 0x1B1AE4D6E2EF5000, 0x10F0CF064DD59200, 0x152D02C7E14AF680,
+    0x1A784379D99DB420, 0x108B2A2C28029094, 0x14ADF4B7320334B9, 0x19D971E4FE8401E7,
+    0x1027E72F1F128130, 0x1431E0FAE6D7217C, 0x193E5939A08CE9DB, 0x1F8DEF8808B02452,
+    0x13B8B5B5056E16B3, 0x18A6E32246C99C60, 0x1ED09BEAD87C0378, 0x13426172C74D822B,
+    0x1812F9CF7920E2B6, 0x1E17B84357691B64, 0x12CED32A16A1B11E, 0x178287F49C4A1D66,
+    0x1D6329F1C35CA4BF, 0x125DFA371A19E6F7, 0x16F578C4E0A060B5, 0x1CB2D6F618C878E3,
+    0x11EFC659CF7D4B8D, 0x166BB7F0435C9E71, 0x1C06A5EC5433C60D,
+};
+
+// Returns floor(log10(2^e)) for 0 <= e <= 1650.
+static uint32_t Log10Pow2(int32_t e) {
+    return (((uint32_t) e) * 78913) >> 18;
+}
+
+// Returns floor(log10(5^e)) for 0 <= e <= 2620.
+static uint32_t Log10Pow5(int32_t e) {
+    return (((uint32_t) e) * 732923) >> 20;
+}
+
+// Returns ceil(log2(5^e)) for 1 <= e <= 3528, and 1 for e == 0.
+static int32_t Pow5Bits(int32_t e) {
+    return (int32_t)(((((uint32_t) e) * 1217359) >> 19) + 1);
+}
+
+static bool IsMultipleOfPowerOf5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static bool IsMultipleOfPowerOf2(uint32_t value, uint32_t p) {
+    return (value & ((1U << p) - 1)) == 0;
+}
+
+// Returns (m * factor) >> shift, for shift > 32.
+static uint32_t MulShift(uint32_t m, uint64_t factor, int32_t shift) {
+    HAPAssert(shift > 32);
+    uint64_t bits0 = (uint64_t) m * (uint32_t) factor;
+    uint64_t bits1 = (uint64_t) m * (uint32_t)(factor >> 32);
+    uint64_t sum = (bits0 >> 32) + bits1;
+    uint64_t shiftedSum = sum >> (shift - 32);
+    HAPAssert(shiftedSum <= UINT32_MAX);
+    return (uint32_t) shiftedSum;
+}
+
+static uint32_t MulPow5InvDivPow2(uint32_t m, uint32_t q, int32_t j) {
+    HAPAssert(q < HAPArrayCount(kFloatPow5InvSplit));
+    return MulShift(m, kFloatPow5InvSplit[q], j);
+}
+
+static uint32_t MulPow5DivPow2(uint32_t m, uint32_t i, int32_t j) {
+    HAPAssert(i < HAPArrayCount(kFloatPow5Split));
+    return MulShift(m, kFloatPow5Split[i], j);
+}
+
+/**
+ * Converts a finite, non-zero float to its shortest round-trip decimal representation.
+ *
+ * @param      bits                 Bit pattern of the float (sign bit is ignored).
+ * @param[out] mantissa             Decimal digits, without trailing zeros. 1 <= mantissa < 10^9.
+ * @param[out] exponent             Decimal exponent. |value| == mantissa * 10^exponent.
+ */
+static void GetShortestDecimal(uint32_t bits, uint32_t* mantissa, int32_t* exponent) {
+    HAPPrecondition(mantissa);
+    HAPPrecondition(exponent);
+
+    uint32_t ieeeMantissa = bits & 0x7FFFFF;
+    uint32_t ieeeExponent = (bits >> kFloat_MantissaBits) & 0xFF;
+    HAPAssert(ieeeExponent != 0xFF);
+    HAPAssert(ieeeExponent || ieeeMantissa);
+
+    int32_t e2;
+    uint32_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - kFloat_ExponentBias - kFloat_MantissaBits - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = (int32_t) ieeeExponent - kFloat_ExponentBias - kFloat_MantissaBits - 2;
+        m2 = (1U << kFloat_MantissaBits) | ieeeMantissa;
+    }
+    bool acceptBounds = (m2 & 1) == 0;
+
+    // Interval of valid decimal representations: [mm, mp] * 2^e2 (bounds inclusive for even mantissas).
+    // The lower bound is only half as far away at powers of two.
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mmShift = ieeeMantissa != 0;
+    uint32_t mm = 4 * m2 - 1 - mmShift;
+
+    // Convert to a decimal power base.
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    uint32_t lastRemovedDigit = 0;
+    if (e2 >= 0) {
+        uint32_t q = Log10Pow2(e2);
+        e10 = (int32_t) q;
+        int32_t k = kFloat_Pow5InvBitCount + Pow5Bits((int32_t) q) - 1;
+        int32_t i = -e2 + (int32_t) q + k;
+        vr = MulPow5InvDivPow2(mv, q, i);
+        vp = MulPow5InvDivPow2(mp, q, i);
+        vm = MulPow5InvDivPow2(mm, q, i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // One removed digit is needed even if the loop below does not run.
+            int32_t l = kFloat_Pow5InvBitCount + Pow5Bits((int32_t)(q - 1)) - 1;
+            lastRemovedDigit = MulPow5InvDivPow2(mv, q - 1, -e2 + (int32_t) q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            // Only one of mp, mv, and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = IsMultipleOfPowerOf5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = IsMultipleOfPowerOf5(mm, q);
+            } else {
+                vp -= IsMultipleOfPowerOf5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = Log10Pow5(-e2);
+        e10 = (int32_t) q + e2;
+        int32_t i = -e2 - (int32_t) q;
+        int32_t k = Pow5Bits(i) - kFloat_Pow5BitCount;
+        int32_t j = (int32_t) q - k;
+        vr = MulPow5DivPow2(mv, (uint32_t) i, j);
+        vp = MulPow5DivPow2(mp, (uint32_t) i, j);
+        vm = MulPow5DivPow2(mm, (uint32_t) i, j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t) q - 1 - (Pow5Bits(i + 1) - kFloat_Pow5BitCount);
+            lastRemovedDigit = MulPow5DivPow2(mv, (uint32_t)(i + 1), j) % 10;
+        }
+        if (q <= 1) {
+            // mv = 4 * m2 always has at least two trailing 0 bits.
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                // mm = mv - 1 - mmShift has 1 trailing 0 bit iff mmShift == 1.
+                vmIsTrailingZeros = mmShift == 1;
+            } else {
+                // mp = mv + 2 always has at least one trailing 0 bit.
+                vp--;
+            }
+        } else if (q < 31) {
+            vrIsTrailingZeros = IsMultipleOfPowerOf2(mv, q - 1);
+        }
+    }
+
+    // Find the shortest decimal representation in the interval of valid representations.
+    int32_t removed = 0;
+    uint32_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        // General case (rare).
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            // Round to even if the exact number is .....50..0.
+            lastRemovedDigit = 4;
+        }
+        // Take vr + 1 if vr is outside bounds or if rounding up is needed.
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        // Common case.
+        while (vp / 10 > vm / 10) {
+            lastRemovedDigit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        // Take vr + 1 if vr is outside bounds or if rounding up is needed.
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+    int32_t exp10 = e10 + removed;
+
+    // Strip trailing zeros.
+    while (output % 10 == 0) {
+        output /= 10;
+        exp10++;
+    }
+    HAPAssert(output && output < 1000000000);
+
+    *mantissa = output;
+    *exponent = exp10;
+}
+
+static size_t GetNumDecimalDigits(uint32_t value) {
+    size_t numDigits = 1;
+    while (value >= 10) {
+        value /= 10;
+        numDigits++;
+    }
+    return numDigits;
+}
+
+//-----------------------------------------------------------
+
+/**
+ * Determines the layout of the string representation of a finite float value.
+ *
+ * - Values with a decimal exponent in the range -4 to 5 are written in fixpoint notation.
+ *   Integer digits are padded with zeros, so values below 10^6 never use scientific notation.
+ *
+ * - All other values are written in scientific notation with a signed two digit exponent.
+ *
+ * @param      bits                 Bit pattern of the float.
+ * @param[out] mantissa             Decimal digits.
+ * @param[out] numDigits            Number of decimal digits in mantissa.
+ * @param[out] exponent             Decimal exponent of the first digit.
+ *
+ * @return Number of bytes that the value's string representation needs (excluding NULL-terminator).
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetFiniteDescriptionLayout(uint32_t bits, uint32_t* mantissa, size_t* numDigits, int32_t* exponent) {
+    HAPPrecondition(mantissa);
+    HAPPrecondition(numDigits);
+    HAPPrecondition(exponent);
+
+    size_t numBytes = (int32_t) bits < 0 ? 1U : 0U;
+    if ((bits & 0x7FFFFFFF) == 0) {
+        *mantissa = 0;
+        *numDigits = 1;
+        *exponent = 0;
+        return numBytes + 1;
+    }
+
+    int32_t exp10;
+    GetShortestDecimal(bits, mantissa, &exp10);
+    *numDigits = GetNumDecimalDigits(*mantissa);
+    *exponent = exp10 + (int32_t) *numDigits - 1;
+
+    if (*exponent >= -4 && *exponent <= 5) {
+        if (*exponent < 0) {
+            // "0." + leading zeros + digits.
+            numBytes += 2 + (size_t)(-*exponent - 1) + *numDigits;
+        } else if (*numDigits > (size_t) *exponent + 1) {
+            // Integer digits + "." + fractional digits.
+            numBytes += *numDigits + 1;
+        } else {
+            // Integer digits, padded with zeros.
+            numBytes += (size_t) *exponent + 1;
+        }
+    } else {
+        // Digits + optional "." + "e+XX".
+        numBytes += *numDigits + (*numDigits > 1 ? 1 : 0) + 4;
+    }
+    HAPAssert(numBytes < kHAPFloat_MaxDescriptionBytes);
+    return numBytes;
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPFloatGetNumDescriptionBytes(float value) {
+    uint32_t bits = HAPFloatGetBitPattern(value);
+    if ((bits & 0x7F800000) == 0x7F800000) { // inf/nan
+        if (bits & 0x7FFFFF) {
+            return sizeof "nan" - 1;
+        }
+        return (int32_t) bits < 0 ? sizeof "-inf" - 1 : sizeof "inf" - 1;
+    }
+
+    uint32_t mantissa;
+    size_t numDigits;
+    int32_t exponent;
+    return GetFiniteDescriptionLayout(bits, &mantissa, &numDigits, &exponent);
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPFloatGetDescription(char* bytes, size_t maxBytes, float value) {
     uint32_t bits = HAPFloatGetBitPattern(value);
     uint32_t mant = bits & 0x7FFFFF; // Base 2 mantissa.
     int exp2 = (bits >> 23) & 0xFF;  // Base 2 exponent.
     size_t i = 0;
+    if (exp2 == 0xFF && mant) { // nan (no sign)
+        if (i + 3 >= maxBytes) {
+            return kHAPError_OutOfResources;
+        }
+        bytes[i++] = 'n';
+        bytes[i++] = 'a';
+        bytes[i++] = 'n';
+        bytes[i] = 0;
+        return kHAPError_None;
+    }
     if ((int32_t) bits < 0) {
         if (i + 1 >= maxBytes) {
             return kHAPError_OutOfResources;
         }
         bytes[i++] = '-';
     }
-    if (exp2 == 0xFF) { // inf/nan
+    if (exp2 == 0xFF) { // inf
         if (i + 3 >= maxBytes) {
             return kHAPError_OutOfResources;
         }
-        if (mant) {
-            // no sign
-            bytes[0] = 'n';
-            bytes[1] = 'a';
-            bytes[2] = 'n';
-            bytes[3] = 0;
-        } else {
-            bytes[i++] = 'i';
-            bytes[i++] = 'n';
-            bytes[i++] = 'f';
-            bytes[i] = 0;
-        }
-        return kHAPError_None;
-    } else if (exp2) { // normalized
-        mant |= 0x800000;
-    } else { // denormalized
-        exp2 = 1;
-    }
-    if (mant == 0) {
-        if (i + 1 >= maxBytes) {
-            return kHAPError_OutOfResources;
-        }
-        bytes[i++] = '0';
+        bytes[i++] = 'i';
+        bytes[i++] = 'n';
+        bytes[i++] = 'f';
         bytes[i] = 0;
         return kHAPError_None;
     }
 
-    // Base change.
-    Bigint X, D, S, T;
-    BigintInit(&X, mant * 2);
-    BigintInit(&D, 1);
-    BigintInit(&S, 0x800000 * 2); // Position of decimal point.
-    exp2 -= 127;
-    /* |value| == X/S * 2^exp2, delta == D/S * 2^exp2, X/S <= 2, 0 < X < 2^25, -127 <= exp2 <= 127 */
-    int exp10 = 0;
-    while (exp2 < 0) {
-        if (BigintComp(&X, &S) <= 0) { // X/S <= 1
-            BigintMul(&X, 5);
-            BigintMul(&D, 5);
-            exp10--;
-        } else { // X/S > 1
-            BigintMul(&S, 2);
-        }
-        exp2++;
+    uint32_t mantissa;
+    size_t numDigits;
+    int32_t exponent;
+    size_t numBytes = GetFiniteDescriptionLayout(bits, &mantissa, &numDigits, &exponent);
+    if (numBytes >= maxBytes) {
+        return kHAPError_OutOfResources;
     }
-    while (exp2 > 0) {
-        if (BigintComp(&X, &S) <= 0) { // X/S <= 1
-            BigintMul(&X, 2);
-            BigintMul(&D, 2);
-        } else { // X/S > 1
-            BigintMul(&S, 5);
-            exp10++;
-        }
-        exp2--;
+
+    // Extract digits, most significant first.
+    char digits[kFloat_MaxDecimalDigits] = { 0 };
+    HAPAssert(numDigits <= sizeof digits);
+    for (size_t j = numDigits; j > 0; j--) {
+        digits[j - 1] = (char) ('0' + mantissa % 10);
+        mantissa /= 10;
     }
-    /* |value| == X/S * 10^exp10, delta == D/S * 10^exp10, 1/5 < X/S <= 5, X,S < 2^114 */
 
-    // Write digits.
-    int32_t odd = bits & 1; // Original mantissa is odd.
-    uint32_t digit;         // Actual digit.
-    int32_t low;            // low <= 0 => digit is in range.
-    int32_t high;           // high <= 0 => (digit + 1) is in range.
-    int dpPos = 0;          // Position of decimal point.
-    int numDig = 0;         // Number of written digits.
-    for (;;) {
-        digit = BigintDivRem(&X, &S);
-        /* X/S is difference between generated digits and precise value, X/S < 1 */
-        if ((bits & 0x7FFFFF) == 0) { // Special case:
-            BigintAdd(&X, &X, &T);    // Lower delta is delta/2.
-            low = BigintComp(&T, &D); // X/S < D/S/2
-        } else {
-            low = BigintComp(&X, &D) + odd; // X/S </<= D/S
-        }
-        BigintAdd(&D, &X, &T);
-        high = BigintComp(&S, &T) + odd; // 1 - X/S </<= D/S
-        if (numDig == 0 && digit == 0 && high > 0) {
-            exp10--; // Suppress leading zero.
-        } else {
-            if (numDig == 0 && exp10 >= -4 && exp10 <= 5) {
-                // Eliminate small exponents.
-                dpPos = exp10;
-                exp10 = 0;
-                if (dpPos < 0) {
-                    // Write leading decimal point.
-                    if (i + (size_t)(2 - dpPos) >= maxBytes) {
-                        return kHAPError_OutOfResources;
-                    }
-                    bytes[i++] = '0';
-                    bytes[i++] = '.';
-                    while (dpPos < -1) {
-                        bytes[i++] = '0';
-                        dpPos++;
-                    }
-                }
-            }
-            if ((low <= 0 || high <= 0) && numDig >= dpPos) {
-                // No more digits needed.
-                break;
+    size_t d = 0;
+    if (exponent >= -4 && exponent <= 5) {
+        if (exponent < 0) {
+            // Write leading decimal point.
+            bytes[i++] = '0';
+            bytes[i++] = '.';
+            for (int32_t k = -1; k > exponent; k--) {
+                bytes[i++] = '0';
             }
-            if (i + 2 >= maxBytes) {
-                return kHAPError_OutOfResources;
+        } else {
+            // Write integer digits.
+            for (int32_t k = 0; k <= exponent; k++) {
+                bytes[i++] = d < numDigits ? digits[d++] : '0';
             }
-            bytes[i++] = (char) (digit + '0'); // Write digit.
-            if (numDig == dpPos) {
-                bytes[i++] = '.'; // Write decimal point.
+            if (d < numDigits) {
+                bytes[i++] = '.';
             }
-            numDig++;
         }
-        BigintMul(&X, 10);
-        BigintMul(&D, 10);
-    }
-    // Handle last digit.
-    if (low > 0) {          // Only digit+1 in range.
-        digit++;            // Use digit+1.
-    } else if (high <= 0) { // digit and digit+1 in range.
-        // Round to even.
-        BigintAdd(&X, &X, &T);
-        if (BigintComp(&T, &S) + (int32_t)(digit & 1) > 0) { // X/S >=/> 1/2
-            digit++;
+        while (d < numDigits) {
+            bytes[i++] = digits[d++];
         }
-    }
-    if (i + 1 >= maxBytes) {
-        return kHAPError_OutOfResources;
-    }
-    // Write last digit (no decimal point).
-    bytes[i++] = (char) (digit + '0');
-
-    // Write exponent.
-    if (exp10) {
-        if (i + 4 >= maxBytes) {
-            return kHAPError_OutOfResources;
+    } else {
+        bytes[i++] = digits[d++];
+        if (d < numDigits) {
+            bytes[i++] = '.';
+            while (d < numDigits) {
+                bytes[i++] = digits[d++];
+            }
         }
+
+        // Write exponent.
         bytes[i++] = 'e';
-        if (exp10 < 0) {
+        if (exponent < 0) {
             bytes[i++] = '-';
-            exp10 = -exp10;
+            exponent = -exponent;
         } else {
             bytes[i++] = '+';
         }
-        bytes[i++] = (char) ('0' + exp10 / 10);
-        bytes[i++] = (char) ('0' + exp10 % 10);
+        bytes[i++] = (char) ('0' + exponent / 10);
+        bytes[i++] = (char) ('0' + exponent % 10);
     }
+    HAPAssert(i == numBytes);
     bytes[i] = 0;
     return kHAPError_None;
 }
@@ -7,32 +7,26 @@
 #include "HAPPlatform.h"
 #include "HAPCrypto.h"
 
+#include <string.h>
+
 void HAPRawBufferZero(void* bytes, size_t numBytes) {
     HAPPrecondition(bytes);
 
-    uint8_t* b = bytes;
-
-    for (size_t i = 0; i < numBytes; i++) {
-        b[i] = 0;
+    if (!numBytes) {
+        return;
     }
+    memset(bytes, 0, numBytes);
 }
 
 void HAPRawBufferCopyBytes(void* destinationBytes, const void* sourceBytes, size_t numBytes) {
     HAPPrecondition(destinationBytes);
     HAPPrecondition(sourceBytes);
 
-    uint8_t* destination = destinationBytes;
-    const uint8_t* source = sourceBytes;
-
-    if (destinationBytes < sourceBytes) {
-        for (size_t i = 0; i < numBytes; i++) {
-            destination[i] = source[i];
-        }
-    } else if (destinationBytes > sourceBytes) {
-        for (size_t i = numBytes; i > 0; i--) {
-            destination[i - 1] = source[i - 1];
-        }
+    if (!numBytes || destinationBytes == sourceBytes) {
+        return;
     }
+    // Buffers may overlap.
+    memmove(destinationBytes, sourceBytes, numBytes);
 }
 
 HAP_RESULT_USE_CHECK
@@ -40,6 +34,17 @@ bool HAPRawBufferAreEqual(const void* bytes, const void* otherBytes, size_t numB
     HAPPrecondition(bytes);
     HAPPrecondition(otherBytes);
 
+    if (!numBytes) {
+        return true;
+    }
+    return memcmp(bytes, otherBytes, numBytes) == 0;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPRawBufferAreEqualConstantTime(const void* bytes, const void* otherBytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(otherBytes);
+
     if (!numBytes) {
         return true;
     }
@@ -257,7 +257,10 @@ void HAPRawBufferZero(void* bytes, size_t numBytes);
 void HAPRawBufferCopyBytes(void* destinationBytes, const void* sourceBytes, size_t numBytes);
 
 /**
- * Determines equality of two buffers in constant time.
+ * Determines equality of two buffers.
+ *
+ * - The comparison may terminate early at the first mismatch. Do not use this to compare secrets.
+ *   Use HAPRawBufferAreEqualConstantTime instead.
  *
  * @param      bytes                Buffer to compare.
  * @param      otherBytes           Buffer to compare with.
@@ -269,6 +272,22 @@ void HAPRawBufferCopyBytes(void* destinationBytes, const void* sourceBytes, size
 HAP_RESULT_USE_CHECK
 bool HAPRawBufferAreEqual(const void* bytes, const void* otherBytes, size_t numBytes);
 
+/**
+ * Determines equality of two buffers in constant time.
+ *
+ * - The execution time only depends on the number of bytes compared and not on the buffer contents.
+ *   This must be used when comparing secrets, e.g., authentication proofs.
+ *
+ * @param      bytes                Buffer to compare.
+ * @param      otherBytes           Buffer to compare with.
+ * @param      numBytes             Number of bytes to compare.
+ *
+ * @return true                     If the contents of both buffers are equal.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPRawBufferAreEqualConstantTime(const void* bytes, const void* otherBytes, size_t numBytes);
+
 /**
  * Determines if a buffer contains only zeros in constant time.
  *
@@ -1262,6 +1281,18 @@ HAPError HAPFloatFromString(const char* description, float* value);
 HAP_RESULT_USE_CHECK
 HAPError HAPFloatGetDescription(char* bytes, size_t maxBytes, float value);
 
+/**
+ * Determines the space needed by the string representation of a float value.
+ *
+ * - The result matches the length of the string created by HAPFloatGetDescription without formatting it.
+ *
+ * @param      value                The float value.
+ *
+ * @return Number of bytes that the value's string representation needs (excluding NULL-terminator).
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPFloatGetNumDescriptionBytes(float value);
+
 /**
  * Absolute value of the supplied floating point value.
  *
@@ -28,6 +28,7 @@ extern "C" {
 #include "HAPPlatformServiceDiscovery.h"
 #include "HAPPlatformTCPStreamManager.h"
 #include "HAPPlatformTimer.h"
+#include "HAPPlatformWorkerPool.h"
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull begin
@@ -0,0 +1,1378 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformBLEPeripheralManagerATT.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "BLEPeripheralManager" };
+
+/**
+ * ATT opcodes.
+ *
+ * @see Bluetooth Core Specification Version 5.0
+ *      Vol 3, Part F, Section 3.4.8 Attribute Opcode Summary
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformBLEPeripheralManagerATTOpcode) {
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ErrorResponse = 0x01,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ExchangeMTURequest = 0x02,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ExchangeMTUResponse = 0x03,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_FindInformationRequest = 0x04,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_FindInformationResponse = 0x05,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_FindByTypeValueRequest = 0x06,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_FindByTypeValueResponse = 0x07,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByTypeRequest = 0x08,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByTypeResponse = 0x09,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadRequest = 0x0A,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadResponse = 0x0B,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadBlobRequest = 0x0C,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadBlobResponse = 0x0D,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByGroupTypeRequest = 0x10,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByGroupTypeResponse = 0x11,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_WriteRequest = 0x12,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_WriteResponse = 0x13,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_PrepareWriteRequest = 0x16,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_PrepareWriteResponse = 0x17,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ExecuteWriteRequest = 0x18,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_ExecuteWriteResponse = 0x19,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_HandleValueIndication = 0x1D,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_HandleValueConfirmation = 0x1E,
+    kHAPPlatformBLEPeripheralManagerATTOpcode_WriteCommand = 0x52
+} HAP_ENUM_END(uint8_t, HAPPlatformBLEPeripheralManagerATTOpcode);
+
+/**
+ * Command flag of ATT opcodes.
+ */
+#define kHAPPlatformBLEPeripheralManagerATTOpcode_CommandFlag ((uint8_t) 0x40)
+
+/**
+ * ATT error codes.
+ *
+ * @see Bluetooth Core Specification Version 5.0
+ *      Vol 3, Part F, Section 3.4.1.1 Error Response
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformBLEPeripheralManagerATTError) {
+    kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle = 0x01,
+    kHAPPlatformBLEPeripheralManagerATTError_ReadNotPermitted = 0x02,
+    kHAPPlatformBLEPeripheralManagerATTError_WriteNotPermitted = 0x03,
+    kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU = 0x04,
+    kHAPPlatformBLEPeripheralManagerATTError_RequestNotSupported = 0x06,
+    kHAPPlatformBLEPeripheralManagerATTError_InvalidOffset = 0x07,
+    kHAPPlatformBLEPeripheralManagerATTError_PrepareQueueFull = 0x09,
+    kHAPPlatformBLEPeripheralManagerATTError_AttributeNotFound = 0x0A,
+    kHAPPlatformBLEPeripheralManagerATTError_InvalidAttributeValueLength = 0x0D,
+    kHAPPlatformBLEPeripheralManagerATTError_UnlikelyError = 0x0E,
+    kHAPPlatformBLEPeripheralManagerATTError_UnsupportedGroupType = 0x10
+} HAP_ENUM_END(uint8_t, HAPPlatformBLEPeripheralManagerATTError);
+
+/**
+ * GATT attribute types that are assigned by the Bluetooth SIG.
+ *
+ * @see Bluetooth Core Specification Version 5.0
+ *      Vol 3, Part G, Section 3.4 Summary of GATT Profile Attribute Types
+ */
+#define kHAPPlatformBLEPeripheralManagerATTType_PrimaryService        ((uint16_t) 0x2800)
+#define kHAPPlatformBLEPeripheralManagerATTType_SecondaryService      ((uint16_t) 0x2801)
+#define kHAPPlatformBLEPeripheralManagerATTType_Characteristic        ((uint16_t) 0x2803)
+#define kHAPPlatformBLEPeripheralManagerATTType_ClientCharacteristicConfiguration ((uint16_t) 0x2902)
+
+/**
+ * Bluetooth Base UUID (00000000-0000-1000-8000-00805F9B34FB) in little-endian byte order.
+ * Bytes 12 and 13 hold the 16-bit UUID.
+ */
+static const uint8_t kBluetoothBaseUUIDBytes[16] = { 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                                                     0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// GATT database.
+
+/**
+ * Finds the first unused element of a GATT database and the last attribute handle that is in use.
+ *
+ * @param      attributes           GATT database.
+ * @param      numAttributes        Capacity of the GATT database.
+ * @param[out] lastHandle           Last attribute handle that is in use. 0 if the GATT database is empty.
+ * @param[out] lastType             Type of the last used element.
+ *
+ * @return First unused element, if the GATT database is not full. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPPlatformBLEPeripheralManagerAttribute* _Nullable FindFreeAttribute(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* lastHandle,
+        HAPPlatformBLEPeripheralManagerAttributeType* lastType) {
+    HAPPrecondition(attributes);
+    HAPPrecondition(lastHandle);
+    HAPPrecondition(lastType);
+
+    bool inService = false;
+    bool inCharacteristic = false;
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = 0;
+    for (size_t i = 0; i < numAttributes; i++) {
+        HAPPlatformBLEPeripheralManagerAttribute* attribute = &attributes[i];
+
+        switch (attribute->type) {
+            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
+                *lastHandle = handle;
+                *lastType = inCharacteristic ? kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic :
+                                               inService ? kHAPPlatformBLEPeripheralManagerAttributeType_Service :
+                                                           kHAPPlatformBLEPeripheralManagerAttributeType_None;
+            }
+                return attribute;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
+                inService = true;
+                inCharacteristic = false;
+
+                HAPAssert(attribute->_.service.handle == handle + 1);
+                handle = attribute->_.service.handle;
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
+                HAPAssert(inService);
+                inCharacteristic = true;
+
+                HAPAssert(attribute->_.characteristic.handle == handle + 1);
+                handle = attribute->_.characteristic.handle;
+                HAPAssert(attribute->_.characteristic.valueHandle == handle + 1);
+                handle = attribute->_.characteristic.valueHandle;
+
+                if (attribute->_.characteristic.cccDescriptorHandle) {
+                    HAPAssert(attribute->_.characteristic.cccDescriptorHandle == handle + 1);
+                    handle = attribute->_.characteristic.cccDescriptorHandle;
+                }
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
+                HAPAssert(inCharacteristic);
+
+                HAPAssert(attribute->_.descriptor.handle == handle + 1);
+                handle = attribute->_.descriptor.handle;
+            } break;
+        }
+    }
+    return NULL;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddService(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        bool isPrimary) {
+    HAPPrecondition(attributes);
+    HAPPrecondition(type);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+    HAPPlatformBLEPeripheralManagerAttributeType lastType;
+    HAPPlatformBLEPeripheralManagerAttribute* attribute =
+            FindFreeAttribute(attributes, numAttributes, &handle, &lastType);
+    if (!attribute) {
+        HAPLog(&logObject,
+               "Not enough resources to add GATT service (have space for %zu GATT attributes).",
+               numAttributes);
+        return kHAPError_OutOfResources;
+    }
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 1;
+    if ((uint32_t) handle + numNeededHandles >= UINT16_MAX) {
+        HAPLog(&logObject, "Not enough resources to add GATT service (GATT database is full).");
+        return kHAPError_OutOfResources;
+    }
+
+    HAPRawBufferZero(attribute, sizeof *attribute);
+    attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Service;
+    attribute->_.service.type = *type;
+    attribute->_.service.isPrimary = isPrimary;
+    attribute->_.service.handle = ++handle;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddCharacteristic(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerCharacteristicProperties properties,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nullable cccDescriptorHandle) {
+    HAPPrecondition(attributes);
+    HAPPrecondition(type);
+    HAPPrecondition(valueHandle);
+    if (properties.notify || properties.indicate) {
+        HAPPrecondition(cccDescriptorHandle);
+    } else {
+        HAPPrecondition(!cccDescriptorHandle);
+    }
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+    HAPPlatformBLEPeripheralManagerAttributeType lastType;
+    HAPPlatformBLEPeripheralManagerAttribute* attribute =
+            FindFreeAttribute(attributes, numAttributes, &handle, &lastType);
+    if (!attribute) {
+        HAPLog(&logObject,
+               "Not enough resources to add GATT characteristic (have space for %zu GATT attributes).",
+               numAttributes);
+        return kHAPError_OutOfResources;
+    }
+    HAPPrecondition(lastType != kHAPPlatformBLEPeripheralManagerAttributeType_None);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 2;
+    if (properties.indicate || properties.notify) {
+        numNeededHandles++;
+    }
+    if ((uint32_t) handle + numNeededHandles >= UINT16_MAX) {
+        HAPLog(&logObject, "Not enough resources to add GATT characteristic (GATT database is full).");
+        return kHAPError_OutOfResources;
+    }
+
+    HAPRawBufferZero(attribute, sizeof *attribute);
+    attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic;
+    attribute->_.characteristic.type = *type;
+    attribute->_.characteristic.properties = properties;
+    attribute->_.characteristic.handle = ++handle;
+    attribute->_.characteristic.valueHandle = ++handle;
+    if (properties.indicate || properties.notify) {
+        attribute->_.characteristic.cccDescriptorHandle = ++handle;
+    }
+
+    *valueHandle = attribute->_.characteristic.valueHandle;
+    if (cccDescriptorHandle) {
+        *cccDescriptorHandle = attribute->_.characteristic.cccDescriptorHandle;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddDescriptor(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerDescriptorProperties properties,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* descriptorHandle) {
+    HAPPrecondition(attributes);
+    HAPPrecondition(type);
+    HAPPrecondition(descriptorHandle);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+    HAPPlatformBLEPeripheralManagerAttributeType lastType;
+    HAPPlatformBLEPeripheralManagerAttribute* attribute =
+            FindFreeAttribute(attributes, numAttributes, &handle, &lastType);
+    if (!attribute) {
+        HAPLog(&logObject,
+               "Not enough resources to add GATT descriptor (have space for %zu GATT attributes).",
+               numAttributes);
+        return kHAPError_OutOfResources;
+    }
+    HAPPrecondition(lastType == kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic);
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 1;
+    if ((uint32_t) handle + numNeededHandles >= UINT16_MAX) {
+        HAPLog(&logObject, "Not enough resources to add GATT descriptor (GATT database is full).");
+        return kHAPError_OutOfResources;
+    }
+
+    HAPRawBufferZero(attribute, sizeof *attribute);
+    attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor;
+    attribute->_.descriptor.type = *type;
+    attribute->_.descriptor.properties = properties;
+    attribute->_.descriptor.handle = ++handle;
+
+    *descriptorHandle = attribute->_.descriptor.handle;
+    return kHAPError_None;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Attribute enumeration.
+
+/**
+ * Kind of an individual ATT attribute.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformBLEPeripheralManagerATTAttributeKind) {
+    /** Service declaration. */
+    kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration = 1,
+
+    /** Characteristic declaration. */
+    kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration,
+
+    /** Characteristic value. */
+    kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicValue,
+
+    /** Client Characteristic Configuration descriptor. */
+    kHAPPlatformBLEPeripheralManagerATTAttributeKind_CCCDescriptor,
+
+    /** Other descriptor. */
+    kHAPPlatformBLEPeripheralManagerATTAttributeKind_Descriptor
+} HAP_ENUM_END(uint8_t, HAPPlatformBLEPeripheralManagerATTAttributeKind);
+
+/**
+ * Individual ATT attribute.
+ */
+typedef struct {
+    /** Attribute handle. */
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+
+    /** Kind of attribute. */
+    HAPPlatformBLEPeripheralManagerATTAttributeKind kind;
+
+    /** GATT database element that contains the attribute. */
+    const HAPPlatformBLEPeripheralManagerAttribute* element;
+
+    /** Attribute type. 16-bit UUIDs are used for types derived from the Bluetooth Base UUID. */
+    uint8_t typeBytes[16];
+    size_t numTypeBytes;
+} HAPPlatformBLEPeripheralManagerATTAttribute;
+
+/**
+ * Serializes a UUID in its shortest form.
+ *
+ * @param      uuid                 UUID.
+ * @param[out] bytes                Buffer that receives the UUID. Must have space for 16 bytes.
+ *
+ * @return Length of the serialized UUID (2 or 16).
+ */
+HAP_RESULT_USE_CHECK
+static size_t SerializeUUID(const HAPPlatformBLEPeripheralManagerUUID* uuid, uint8_t* bytes) {
+    HAPPrecondition(uuid);
+    HAPPrecondition(bytes);
+
+    if (HAPRawBufferAreEqual(uuid->bytes, kBluetoothBaseUUIDBytes, 12) && !uuid->bytes[14] && !uuid->bytes[15]) {
+        bytes[0] = uuid->bytes[12];
+        bytes[1] = uuid->bytes[13];
+        return 2;
+    }
+    HAPRawBufferCopyBytes(bytes, uuid->bytes, sizeof uuid->bytes);
+    return sizeof uuid->bytes;
+}
+
+static void SetShortType(HAPPlatformBLEPeripheralManagerATTAttribute* attribute, uint16_t type) {
+    HAPPrecondition(attribute);
+
+    HAPWriteLittleUInt16(attribute->typeBytes, type);
+    attribute->numTypeBytes = sizeof type;
+}
+
+/**
+ * Fetches the attribute with the lowest attribute handle that is greater than or equal to a given attribute handle.
+ *
+ * @param      attServer            ATT server.
+ * @param      minHandle            Minimum attribute handle.
+ * @param[out] attribute            Attribute, if found.
+ *
+ * @return true                     If an attribute has been found.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool GetAttribute(
+        const HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle minHandle,
+        HAPPlatformBLEPeripheralManagerATTAttribute* attribute) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attribute);
+
+    for (size_t i = 0; i < attServer->numAttributes; i++) {
+        const HAPPlatformBLEPeripheralManagerAttribute* element = &attServer->attributes[i];
+        HAPRawBufferZero(attribute, sizeof *attribute);
+        attribute->element = element;
+
+        switch (element->type) {
+            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
+            }
+                return false;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
+                const HAPPlatformBLEPeripheralManagerService* service = &element->_.service;
+                if (service->handle >= minHandle) {
+                    attribute->handle = service->handle;
+                    attribute->kind = kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration;
+                    SetShortType(
+                            attribute,
+                            service->isPrimary ? kHAPPlatformBLEPeripheralManagerATTType_PrimaryService :
+                                                 kHAPPlatformBLEPeripheralManagerATTType_SecondaryService);
+                    return true;
+                }
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
+                const HAPPlatformBLEPeripheralManagerCharacteristic* characteristic = &element->_.characteristic;
+                if (characteristic->handle >= minHandle) {
+                    attribute->handle = characteristic->handle;
+                    attribute->kind = kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration;
+                    SetShortType(attribute, kHAPPlatformBLEPeripheralManagerATTType_Characteristic);
+                    return true;
+                }
+                if (characteristic->valueHandle >= minHandle) {
+                    attribute->handle = characteristic->valueHandle;
+                    attribute->kind = kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicValue;
+                    attribute->numTypeBytes = SerializeUUID(&characteristic->type, attribute->typeBytes);
+                    return true;
+                }
+                if (characteristic->cccDescriptorHandle && characteristic->cccDescriptorHandle >= minHandle) {
+                    attribute->handle = characteristic->cccDescriptorHandle;
+                    attribute->kind = kHAPPlatformBLEPeripheralManagerATTAttributeKind_CCCDescriptor;
+                    SetShortType(attribute, kHAPPlatformBLEPeripheralManagerATTType_ClientCharacteristicConfiguration);
+                    return true;
+                }
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
+                const HAPPlatformBLEPeripheralManagerDescriptor* descriptor = &element->_.descriptor;
+                if (descriptor->handle >= minHandle) {
+                    attribute->handle = descriptor->handle;
+                    attribute->kind = kHAPPlatformBLEPeripheralManagerATTAttributeKind_Descriptor;
+                    attribute->numTypeBytes = SerializeUUID(&descriptor->type, attribute->typeBytes);
+                    return true;
+                }
+            } break;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the last attribute handle of the service whose service declaration is given.
+ *
+ * @param      attServer            ATT server.
+ * @param      element              GATT database element of the service.
+ *
+ * @return End group handle.
+ */
+HAP_RESULT_USE_CHECK
+static HAPPlatformBLEPeripheralManagerAttributeHandle GetServiceEndGroupHandle(
+        const HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const HAPPlatformBLEPeripheralManagerAttribute* element) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(element);
+    HAPPrecondition(element->type == kHAPPlatformBLEPeripheralManagerAttributeType_Service);
+
+    size_t i = (size_t)(element - attServer->attributes);
+    HAPPrecondition(i < attServer->numAttributes);
+    for (i++; i < attServer->numAttributes; i++) {
+        const HAPPlatformBLEPeripheralManagerAttribute* nextElement = &attServer->attributes[i];
+        if (nextElement->type == kHAPPlatformBLEPeripheralManagerAttributeType_Service) {
+            return (HAPPlatformBLEPeripheralManagerAttributeHandle)(nextElement->_.service.handle - 1);
+        }
+        if (nextElement->type == kHAPPlatformBLEPeripheralManagerAttributeType_None) {
+            break;
+        }
+    }
+    return UINT16_MAX;
+}
+
+/**
+ * Serializes the value of a service or characteristic declaration.
+ *
+ * @param      attribute            Declaration attribute.
+ * @param[out] bytes                Buffer that receives the value. Must have space for 19 bytes.
+ *
+ * @return Length of the value.
+ *
+ * @see Bluetooth Core Specification Version 5.0
+ *      Vol 3, Part G, Section 3.1 Service Definition
+ *      Vol 3, Part G, Section 3.3.1 Characteristic Declaration
+ */
+HAP_RESULT_USE_CHECK
+static size_t SerializeDeclaration(const HAPPlatformBLEPeripheralManagerATTAttribute* attribute, uint8_t* bytes) {
+    HAPPrecondition(attribute);
+    HAPPrecondition(bytes);
+
+    switch (attribute->kind) {
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration: {
+            return SerializeUUID(&attribute->element->_.service.type, bytes);
+        }
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration: {
+            const HAPPlatformBLEPeripheralManagerCharacteristic* characteristic =
+                    &attribute->element->_.characteristic;
+            bytes[0] = (uint8_t)(
+                    (characteristic->properties.read ? 0x02U : 0U) |
+                    (characteristic->properties.writeWithoutResponse ? 0x04U : 0U) |
+                    (characteristic->properties.write ? 0x08U : 0U) |
+                    (characteristic->properties.notify ? 0x10U : 0U) |
+                    (characteristic->properties.indicate ? 0x20U : 0U));
+            HAPWriteLittleUInt16(&bytes[1], characteristic->valueHandle);
+            return 3 + SerializeUUID(&characteristic->type, &bytes[3]);
+        }
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicValue:
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CCCDescriptor:
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_Descriptor: {
+        }
+            HAPFatalError();
+    }
+    HAPFatalError();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// ATT server.
+
+void HAPPlatformBLEPeripheralManagerATTServerCreate(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const HAPPlatformBLEPeripheralManagerATTServerOptions* options) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(options);
+    HAPPrecondition(options->blePeripheralManager);
+    HAPPrecondition(options->attributes);
+    HAPPrecondition(options->delegate);
+    HAPPrecondition(options->sendPDU);
+    HAPPrecondition(!options->mtu || options->mtu >= kHAPPlatformBLEPeripheralManagerATT_DefaultMTU);
+    HAPPrecondition(options->mtu <= kHAPPlatformBLEPeripheralManagerATT_MaxMTU);
+
+    HAPRawBufferZero(attServer, sizeof *attServer);
+    attServer->blePeripheralManager = options->blePeripheralManager;
+    attServer->attributes = options->attributes;
+    attServer->numAttributes = options->numAttributes;
+    attServer->delegate = options->delegate;
+    attServer->sendPDU = options->sendPDU;
+    attServer->context = options->context;
+    attServer->serverMTU = options->mtu ? options->mtu : kHAPPlatformBLEPeripheralManagerATT_MaxMTU;
+}
+
+void HAPPlatformBLEPeripheralManagerATTServerConnect(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(!attServer->isConnected);
+
+    HAPLogInfo(&logObject, "Central connected (connection handle 0x%04x).", connectionHandle);
+    attServer->connectionHandle = connectionHandle;
+    attServer->mtu = kHAPPlatformBLEPeripheralManagerATT_DefaultMTU;
+    attServer->readValue.handle = 0;
+    attServer->preparedWrite.handle = 0;
+    attServer->preparedWrite.numBytes = 0;
+    attServer->isConnected = true;
+    attServer->isIndicationPending = false;
+
+    if (attServer->delegate->handleConnectedCentral) {
+        attServer->delegate->handleConnectedCentral(
+                attServer->blePeripheralManager, connectionHandle, attServer->delegate->context);
+    }
+}
+
+void HAPPlatformBLEPeripheralManagerATTServerDisconnect(HAPPlatformBLEPeripheralManagerATTServer* attServer) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attServer->isConnected);
+
+    HAPLogInfo(&logObject, "Central disconnected (connection handle 0x%04x).", attServer->connectionHandle);
+    attServer->isConnected = false;
+    attServer->isIndicationPending = false;
+
+    if (attServer->delegate->handleDisconnectedCentral) {
+        attServer->delegate->handleDisconnectedCentral(
+                attServer->blePeripheralManager, attServer->connectionHandle, attServer->delegate->context);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerATTServerIsConnected(const HAPPlatformBLEPeripheralManagerATTServer* attServer) {
+    HAPPrecondition(attServer);
+
+    return attServer->isConnected;
+}
+
+HAP_RESULT_USE_CHECK
+HAPPlatformBLEPeripheralManagerConnectionHandle
+        HAPPlatformBLEPeripheralManagerATTServerGetConnectionHandle(
+                const HAPPlatformBLEPeripheralManagerATTServer* attServer) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attServer->isConnected);
+
+    return attServer->connectionHandle;
+}
+
+HAP_RESULT_USE_CHECK
+uint16_t HAPPlatformBLEPeripheralManagerATTServerGetMTU(const HAPPlatformBLEPeripheralManagerATTServer* attServer) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attServer->isConnected);
+
+    return attServer->mtu;
+}
+
+/**
+ * Sends an ATT PDU that has been prepared in the PDU buffer.
+ *
+ * @param      attServer            ATT server.
+ * @param      numBytes             Length of ATT PDU.
+ */
+static void SendPDU(HAPPlatformBLEPeripheralManagerATTServer* attServer, size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(numBytes && numBytes <= attServer->mtu);
+
+    attServer->sendPDU(attServer, attServer->pduBytes, numBytes, attServer->context);
+}
+
+/**
+ * Sends an Error Response.
+ *
+ * @param      attServer            ATT server.
+ * @param      requestOpcode        Opcode of the request that caused the error.
+ * @param      handle               Attribute handle that caused the error.
+ * @param      error                Error code.
+ */
+static void SendErrorResponse(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        uint8_t requestOpcode,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        HAPPlatformBLEPeripheralManagerATTError error) {
+    HAPPrecondition(attServer);
+
+    HAPLogDebug(
+            &logObject,
+            "ATT Error Response (request opcode 0x%02x, handle 0x%04x, error 0x%02x).",
+            requestOpcode,
+            handle,
+            error);
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ErrorResponse;
+    pdu[1] = requestOpcode;
+    HAPWriteLittleUInt16(&pdu[2], handle);
+    pdu[4] = error;
+    SendPDU(attServer, 5);
+}
+
+/**
+ * Fetches the value of an attribute into the read value cache.
+ *
+ * @param      attServer            ATT server.
+ * @param      handle               Attribute handle.
+ * @param[out] error                ATT error code, if unsuccessful.
+ *
+ * @return true                     If successful.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool FetchValue(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        HAPPlatformBLEPeripheralManagerATTError* error) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(error);
+
+    attServer->readValue.handle = 0;
+    attServer->readValue.numBytes = 0;
+
+    HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+    if (!handle || !GetAttribute(attServer, handle, &attribute) || attribute.handle != handle) {
+        *error = kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle;
+        return false;
+    }
+
+    switch (attribute.kind) {
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration:
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration: {
+            attServer->readValue.numBytes = (uint16_t) SerializeDeclaration(&attribute, attServer->readValue.bytes);
+            attServer->readValue.handle = handle;
+        }
+            return true;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicValue: {
+            if (!attribute.element->_.characteristic.properties.read) {
+                *error = kHAPPlatformBLEPeripheralManagerATTError_ReadNotPermitted;
+                return false;
+            }
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CCCDescriptor: {
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_Descriptor: {
+            if (!attribute.element->_.descriptor.properties.read) {
+                *error = kHAPPlatformBLEPeripheralManagerATTError_ReadNotPermitted;
+                return false;
+            }
+        } break;
+    }
+
+    if (!attServer->delegate->handleReadRequest) {
+        *error = kHAPPlatformBLEPeripheralManagerATTError_ReadNotPermitted;
+        return false;
+    }
+    size_t numBytes;
+    HAPError err = attServer->delegate->handleReadRequest(
+            attServer->blePeripheralManager,
+            attServer->connectionHandle,
+            handle,
+            attServer->readValue.bytes,
+            sizeof attServer->readValue.bytes,
+            &numBytes,
+            attServer->delegate->context);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Read of attribute handle 0x%04x rejected.", handle);
+        *error = err == kHAPError_InvalidState ? kHAPPlatformBLEPeripheralManagerATTError_ReadNotPermitted :
+                                                 kHAPPlatformBLEPeripheralManagerATTError_UnlikelyError;
+        return false;
+    }
+    HAPAssert(numBytes <= sizeof attServer->readValue.bytes);
+    attServer->readValue.numBytes = (uint16_t) numBytes;
+    attServer->readValue.handle = handle;
+    return true;
+}
+
+/**
+ * Checks whether an attribute may be written and returns the corresponding ATT error otherwise.
+ *
+ * @param      attServer            ATT server.
+ * @param      handle               Attribute handle.
+ * @param[out] error                ATT error code, if the attribute may not be written.
+ *
+ * @return true                     If the attribute may be written.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsWritable(
+        const HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        HAPPlatformBLEPeripheralManagerATTError* error) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(error);
+
+    HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+    if (!handle || !GetAttribute(attServer, handle, &attribute) || attribute.handle != handle) {
+        *error = kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle;
+        return false;
+    }
+
+    bool isWritable = false;
+    switch (attribute.kind) {
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration:
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration: {
+            isWritable = false;
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicValue: {
+            isWritable = attribute.element->_.characteristic.properties.write ||
+                         attribute.element->_.characteristic.properties.writeWithoutResponse;
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_CCCDescriptor: {
+            isWritable = true;
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTAttributeKind_Descriptor: {
+            isWritable = attribute.element->_.descriptor.properties.write;
+        } break;
+    }
+    if (!isWritable || !attServer->delegate->handleWriteRequest) {
+        *error = kHAPPlatformBLEPeripheralManagerATTError_WriteNotPermitted;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes the value of an attribute.
+ *
+ * @param      attServer            ATT server.
+ * @param      handle               Attribute handle. Must be writable.
+ * @param      bytes                Value.
+ * @param      numBytes             Length of value.
+ * @param[out] error                ATT error code, if unsuccessful.
+ *
+ * @return true                     If successful.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool WriteValue(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformBLEPeripheralManagerATTError* error) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attServer->delegate->handleWriteRequest);
+    HAPPrecondition(bytes);
+    HAPPrecondition(error);
+
+    if (attServer->readValue.handle == handle) {
+        attServer->readValue.handle = 0;
+    }
+    if (numBytes > kHAPPlatformBLEPeripheralManager_MaxAttributeBytes) {
+        *error = kHAPPlatformBLEPeripheralManagerATTError_InvalidAttributeValueLength;
+        return false;
+    }
+    HAPError err = attServer->delegate->handleWriteRequest(
+            attServer->blePeripheralManager,
+            attServer->connectionHandle,
+            handle,
+            bytes,
+            numBytes,
+            attServer->delegate->context);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_InvalidData || err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Write to attribute handle 0x%04x rejected.", handle);
+        *error = err == kHAPError_InvalidState ? kHAPPlatformBLEPeripheralManagerATTError_WriteNotPermitted :
+                                                 kHAPPlatformBLEPeripheralManagerATTError_UnlikelyError;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parses a 16-bit or 128-bit UUID from a request.
+ *
+ * @param      bytes                UUID.
+ * @param      numBytes             Length of UUID.
+ * @param[out] type                 16-bit UUID, if the UUID is based on the Bluetooth Base UUID.
+ *
+ * @return true                     If the UUID is a 16-bit UUID.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ParseShortUUID(const uint8_t* bytes, size_t numBytes, uint16_t* type) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(type);
+
+    if (numBytes == sizeof(uint16_t)) {
+        *type = HAPReadLittleUInt16(bytes);
+        return true;
+    }
+    if (numBytes == sizeof(HAPPlatformBLEPeripheralManagerUUID)) {
+        HAPPlatformBLEPeripheralManagerUUID uuid;
+        HAPRawBufferCopyBytes(uuid.bytes, bytes, sizeof uuid.bytes);
+        uint8_t shortBytes[16];
+        if (SerializeUUID(&uuid, shortBytes) == sizeof(uint16_t)) {
+            *type = HAPReadLittleUInt16(shortBytes);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void HandleExchangeMTURequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 3) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    uint16_t clientMTU = HAPReadLittleUInt16(&bytes[1]);
+    uint16_t mtu = HAPMin(clientMTU, attServer->serverMTU);
+    if (mtu < kHAPPlatformBLEPeripheralManagerATT_DefaultMTU) {
+        mtu = kHAPPlatformBLEPeripheralManagerATT_DefaultMTU;
+    }
+
+    // The response is sent with the old ATT_MTU.
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ExchangeMTUResponse;
+    HAPWriteLittleUInt16(&pdu[1], attServer->serverMTU);
+    SendPDU(attServer, 3);
+
+    HAPLogInfo(&logObject, "ATT_MTU: %u (client Rx MTU %u, server Rx MTU %u).", mtu, clientMTU, attServer->serverMTU);
+    attServer->mtu = mtu;
+}
+
+static void HandleFindInformationRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 5) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle startHandle = HAPReadLittleUInt16(&bytes[1]);
+    HAPPlatformBLEPeripheralManagerAttributeHandle endHandle = HAPReadLittleUInt16(&bytes[3]);
+    if (!startHandle || startHandle > endHandle) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle);
+        return;
+    }
+
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_FindInformationResponse;
+    size_t o = 2;
+    size_t numTypeBytes = 0;
+    HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+    uint32_t handle = startHandle;
+    while (handle <= endHandle && GetAttribute(attServer, (HAPPlatformBLEPeripheralManagerAttributeHandle) handle,
+                                               &attribute)) {
+        if (attribute.handle > endHandle) {
+            break;
+        }
+        if (!numTypeBytes) {
+            numTypeBytes = attribute.numTypeBytes;
+        } else if (attribute.numTypeBytes != numTypeBytes) {
+            break;
+        }
+        if (o + 2 + numTypeBytes > attServer->mtu) {
+            break;
+        }
+        HAPWriteLittleUInt16(&pdu[o], attribute.handle);
+        HAPRawBufferCopyBytes(&pdu[o + 2], attribute.typeBytes, numTypeBytes);
+        o += 2 + numTypeBytes;
+        handle = (uint32_t) attribute.handle + 1;
+    }
+    if (!numTypeBytes) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_AttributeNotFound);
+        return;
+    }
+    pdu[1] = numTypeBytes == sizeof(uint16_t) ? 0x01 : 0x02;
+    SendPDU(attServer, o);
+}
+
+static void HandleFindByTypeValueRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes < 7) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle startHandle = HAPReadLittleUInt16(&bytes[1]);
+    HAPPlatformBLEPeripheralManagerAttributeHandle endHandle = HAPReadLittleUInt16(&bytes[3]);
+    uint16_t type = HAPReadLittleUInt16(&bytes[5]);
+    const uint8_t* valueBytes = &bytes[7];
+    size_t numValueBytes = numBytes - 7;
+    if (!startHandle || startHandle > endHandle) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle);
+        return;
+    }
+
+    // Only primary service discovery by service UUID is supported.
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_FindByTypeValueResponse;
+    size_t o = 1;
+    if (type == kHAPPlatformBLEPeripheralManagerATTType_PrimaryService) {
+        HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+        uint32_t handle = startHandle;
+        while (handle <= endHandle && GetAttribute(attServer, (HAPPlatformBLEPeripheralManagerAttributeHandle) handle,
+                                                   &attribute)) {
+            if (attribute.handle > endHandle || o + 4 > attServer->mtu) {
+                break;
+            }
+            handle = (uint32_t) attribute.handle + 1;
+            if (attribute.kind != kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration ||
+                !attribute.element->_.service.isPrimary) {
+                continue;
+            }
+            uint8_t uuidBytes[16];
+            size_t numUUIDBytes = SerializeUUID(&attribute.element->_.service.type, uuidBytes);
+            if (numUUIDBytes != numValueBytes || !HAPRawBufferAreEqual(uuidBytes, valueBytes, numValueBytes)) {
+                continue;
+            }
+            HAPWriteLittleUInt16(&pdu[o], attribute.handle);
+            HAPWriteLittleUInt16(&pdu[o + 2], GetServiceEndGroupHandle(attServer, attribute.element));
+            o += 4;
+        }
+    }
+    if (o == 1) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_AttributeNotFound);
+        return;
+    }
+    SendPDU(attServer, o);
+}
+
+static void HandleReadByTypeRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 7 && numBytes != 21) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle startHandle = HAPReadLittleUInt16(&bytes[1]);
+    HAPPlatformBLEPeripheralManagerAttributeHandle endHandle = HAPReadLittleUInt16(&bytes[3]);
+    if (!startHandle || startHandle > endHandle) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle);
+        return;
+    }
+
+    // Only characteristic discovery is supported.
+    uint16_t type;
+    if (!ParseShortUUID(&bytes[5], numBytes - 5, &type) ||
+        type != kHAPPlatformBLEPeripheralManagerATTType_Characteristic) {
+        SendErrorResponse(
+                attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_RequestNotSupported);
+        return;
+    }
+
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByTypeResponse;
+    size_t o = 2;
+    size_t numEntryBytes = 0;
+    HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+    uint32_t handle = startHandle;
+    while (handle <= endHandle && GetAttribute(attServer, (HAPPlatformBLEPeripheralManagerAttributeHandle) handle,
+                                               &attribute)) {
+        if (attribute.handle > endHandle) {
+            break;
+        }
+        handle = (uint32_t) attribute.handle + 1;
+        if (attribute.kind != kHAPPlatformBLEPeripheralManagerATTAttributeKind_CharacteristicDeclaration) {
+            continue;
+        }
+        uint8_t valueBytes[19];
+        size_t numValueBytes = SerializeDeclaration(&attribute, valueBytes);
+        if (!numEntryBytes) {
+            numEntryBytes = 2 + numValueBytes;
+        } else if (2 + numValueBytes != numEntryBytes) {
+            break;
+        }
+        if (o + numEntryBytes > attServer->mtu) {
+            break;
+        }
+        HAPWriteLittleUInt16(&pdu[o], attribute.handle);
+        HAPRawBufferCopyBytes(&pdu[o + 2], valueBytes, numValueBytes);
+        o += numEntryBytes;
+    }
+    if (!numEntryBytes) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_AttributeNotFound);
+        return;
+    }
+    pdu[1] = (uint8_t) numEntryBytes;
+    SendPDU(attServer, o);
+}
+
+static void HandleReadRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 3) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = HAPReadLittleUInt16(&bytes[1]);
+
+    HAPPlatformBLEPeripheralManagerATTError error;
+    if (!FetchValue(attServer, handle, &error)) {
+        SendErrorResponse(attServer, opcode, handle, error);
+        return;
+    }
+
+    size_t numValueBytes = HAPMin(attServer->readValue.numBytes, (size_t)(attServer->mtu - 1));
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ReadResponse;
+    HAPRawBufferCopyBytes(&pdu[1], attServer->readValue.bytes, numValueBytes);
+    SendPDU(attServer, 1 + numValueBytes);
+}
+
+static void HandleReadBlobRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 5) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = HAPReadLittleUInt16(&bytes[1]);
+    uint16_t offset = HAPReadLittleUInt16(&bytes[3]);
+
+    // Read Blob Requests continue the most recent read of the attribute.
+    // The value is only fetched again if the central starts a new read.
+    if (!offset || attServer->readValue.handle != handle) {
+        HAPPlatformBLEPeripheralManagerATTError error;
+        if (!FetchValue(attServer, handle, &error)) {
+            SendErrorResponse(attServer, opcode, handle, error);
+            return;
+        }
+    }
+    if (offset > attServer->readValue.numBytes) {
+        SendErrorResponse(attServer, opcode, handle, kHAPPlatformBLEPeripheralManagerATTError_InvalidOffset);
+        return;
+    }
+
+    size_t numValueBytes = HAPMin((size_t)(attServer->readValue.numBytes - offset), (size_t)(attServer->mtu - 1));
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ReadBlobResponse;
+    HAPRawBufferCopyBytes(&pdu[1], &attServer->readValue.bytes[offset], numValueBytes);
+    SendPDU(attServer, 1 + numValueBytes);
+}
+
+static void HandleReadByGroupTypeRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 7 && numBytes != 21) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle startHandle = HAPReadLittleUInt16(&bytes[1]);
+    HAPPlatformBLEPeripheralManagerAttributeHandle endHandle = HAPReadLittleUInt16(&bytes[3]);
+    if (!startHandle || startHandle > endHandle) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_InvalidHandle);
+        return;
+    }
+    uint16_t type;
+    if (!ParseShortUUID(&bytes[5], numBytes - 5, &type) ||
+        (type != kHAPPlatformBLEPeripheralManagerATTType_PrimaryService &&
+         type != kHAPPlatformBLEPeripheralManagerATTType_SecondaryService)) {
+        SendErrorResponse(
+                attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_UnsupportedGroupType);
+        return;
+    }
+    bool isPrimary = type == kHAPPlatformBLEPeripheralManagerATTType_PrimaryService;
+
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByGroupTypeResponse;
+    size_t o = 2;
+    size_t numEntryBytes = 0;
+    HAPPlatformBLEPeripheralManagerATTAttribute attribute;
+    uint32_t handle = startHandle;
+    while (handle <= endHandle && GetAttribute(attServer, (HAPPlatformBLEPeripheralManagerAttributeHandle) handle,
+                                               &attribute)) {
+        if (attribute.handle > endHandle) {
+            break;
+        }
+        handle = (uint32_t) attribute.handle + 1;
+        if (attribute.kind != kHAPPlatformBLEPeripheralManagerATTAttributeKind_ServiceDeclaration ||
+            attribute.element->_.service.isPrimary != isPrimary) {
+            continue;
+        }
+        uint8_t valueBytes[16];
+        size_t numValueBytes = SerializeDeclaration(&attribute, valueBytes);
+        if (!numEntryBytes) {
+            numEntryBytes = 4 + numValueBytes;
+        } else if (4 + numValueBytes != numEntryBytes) {
+            break;
+        }
+        if (o + numEntryBytes > attServer->mtu) {
+            break;
+        }
+        HAPWriteLittleUInt16(&pdu[o], attribute.handle);
+        HAPWriteLittleUInt16(&pdu[o + 2], GetServiceEndGroupHandle(attServer, attribute.element));
+        HAPRawBufferCopyBytes(&pdu[o + 4], valueBytes, numValueBytes);
+        o += numEntryBytes;
+    }
+    if (!numEntryBytes) {
+        SendErrorResponse(attServer, opcode, startHandle, kHAPPlatformBLEPeripheralManagerATTError_AttributeNotFound);
+        return;
+    }
+    pdu[1] = (uint8_t) numEntryBytes;
+    SendPDU(attServer, o);
+}
+
+static void HandleWriteRequest(HAPPlatformBLEPeripheralManagerATTServer* attServer, uint8_t* bytes, size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    bool isCommand = opcode == kHAPPlatformBLEPeripheralManagerATTOpcode_WriteCommand;
+    if (numBytes < 3) {
+        if (!isCommand) {
+            SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        }
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = HAPReadLittleUInt16(&bytes[1]);
+
+    HAPPlatformBLEPeripheralManagerATTError error;
+    if (!IsWritable(attServer, handle, &error) || !WriteValue(attServer, handle, &bytes[3], numBytes - 3, &error)) {
+        if (!isCommand) {
+            SendErrorResponse(attServer, opcode, handle, error);
+        }
+        return;
+    }
+    if (!isCommand && attServer->isConnected) {
+        attServer->pduBytes[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_WriteResponse;
+        SendPDU(attServer, 1);
+    }
+}
+
+static void HandlePrepareWriteRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes < 5) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = HAPReadLittleUInt16(&bytes[1]);
+    uint16_t offset = HAPReadLittleUInt16(&bytes[3]);
+    const uint8_t* valueBytes = &bytes[5];
+    size_t numValueBytes = numBytes - 5;
+
+    HAPPlatformBLEPeripheralManagerATTError error;
+    if (!IsWritable(attServer, handle, &error)) {
+        SendErrorResponse(attServer, opcode, handle, error);
+        return;
+    }
+
+    // The queue holds the contiguous fragments of a single attribute value.
+    if (attServer->preparedWrite.handle && attServer->preparedWrite.handle != handle) {
+        SendErrorResponse(attServer, opcode, handle, kHAPPlatformBLEPeripheralManagerATTError_PrepareQueueFull);
+        return;
+    }
+    if (!attServer->preparedWrite.handle) {
+        attServer->preparedWrite.handle = handle;
+        attServer->preparedWrite.numBytes = 0;
+    }
+    if (offset != attServer->preparedWrite.numBytes) {
+        SendErrorResponse(attServer, opcode, handle, kHAPPlatformBLEPeripheralManagerATTError_InvalidOffset);
+        return;
+    }
+    if (numValueBytes > sizeof attServer->preparedWrite.bytes - attServer->preparedWrite.numBytes) {
+        SendErrorResponse(attServer, opcode, handle, kHAPPlatformBLEPeripheralManagerATTError_PrepareQueueFull);
+        return;
+    }
+    HAPRawBufferCopyBytes(
+            &attServer->preparedWrite.bytes[attServer->preparedWrite.numBytes], valueBytes, numValueBytes);
+    attServer->preparedWrite.numBytes += (uint16_t) numValueBytes;
+
+    // The response echoes the request.
+    uint8_t* pdu = attServer->pduBytes;
+    HAPRawBufferCopyBytes(pdu, bytes, numBytes);
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_PrepareWriteResponse;
+    SendPDU(attServer, numBytes);
+}
+
+static void HandleExecuteWriteRequest(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+
+    uint8_t opcode = bytes[0];
+    if (numBytes != 2 || bytes[1] > 0x01) {
+        SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        return;
+    }
+    bool shouldWrite = bytes[1] == 0x01;
+
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle = attServer->preparedWrite.handle;
+    attServer->preparedWrite.handle = 0;
+    if (shouldWrite && handle) {
+        HAPPlatformBLEPeripheralManagerATTError error;
+        if (!WriteValue(attServer,
+                        handle,
+                        attServer->preparedWrite.bytes,
+                        attServer->preparedWrite.numBytes,
+                        &error)) {
+            SendErrorResponse(attServer, opcode, handle, error);
+            return;
+        }
+    }
+    if (attServer->isConnected) {
+        attServer->pduBytes[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_ExecuteWriteResponse;
+        SendPDU(attServer, 1);
+    }
+}
+
+static void HandleValueConfirmation(HAPPlatformBLEPeripheralManagerATTServer* attServer, size_t numBytes) {
+    HAPPrecondition(attServer);
+
+    if (numBytes != 1 || !attServer->isIndicationPending) {
+        HAPLog(&logObject, "Ignoring unexpected Handle Value Confirmation.");
+        return;
+    }
+    attServer->isIndicationPending = false;
+
+    if (attServer->delegate->handleReadyToUpdateSubscribers) {
+        attServer->delegate->handleReadyToUpdateSubscribers(
+                attServer->blePeripheralManager, attServer->connectionHandle, attServer->delegate->context);
+    }
+}
+
+void HAPPlatformBLEPeripheralManagerATTServerHandlePDU(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        void* bytes_,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(attServer->isConnected);
+    HAPPrecondition(bytes_);
+    uint8_t* bytes = bytes_;
+
+    if (!numBytes) {
+        HAPLog(&logObject, "Ignoring empty ATT PDU.");
+        return;
+    }
+    uint8_t opcode = bytes[0];
+    if (numBytes > attServer->mtu) {
+        HAPLog(&logObject, "ATT PDU exceeds ATT_MTU (%zu / %u bytes).", numBytes, attServer->mtu);
+        if (!(opcode & kHAPPlatformBLEPeripheralManagerATTOpcode_CommandFlag)) {
+            SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_InvalidPDU);
+        }
+        return;
+    }
+
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "< ATT PDU");
+    switch (opcode) {
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ExchangeMTURequest: {
+            HandleExchangeMTURequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_FindInformationRequest: {
+            HandleFindInformationRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_FindByTypeValueRequest: {
+            HandleFindByTypeValueRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByTypeRequest: {
+            HandleReadByTypeRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ReadRequest: {
+            HandleReadRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ReadBlobRequest: {
+            HandleReadBlobRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ReadByGroupTypeRequest: {
+            HandleReadByGroupTypeRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_WriteRequest:
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_WriteCommand: {
+            HandleWriteRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_PrepareWriteRequest: {
+            HandlePrepareWriteRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_ExecuteWriteRequest: {
+            HandleExecuteWriteRequest(attServer, bytes, numBytes);
+        } break;
+        case kHAPPlatformBLEPeripheralManagerATTOpcode_HandleValueConfirmation: {
+            HandleValueConfirmation(attServer, numBytes);
+        } break;
+        default: {
+            if (opcode & kHAPPlatformBLEPeripheralManagerATTOpcode_CommandFlag) {
+                HAPLog(&logObject, "Ignoring unsupported ATT command 0x%02x.", opcode);
+            } else {
+                SendErrorResponse(attServer, opcode, 0, kHAPPlatformBLEPeripheralManagerATTError_RequestNotSupported);
+            }
+        } break;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTServerSendHandleValueIndication(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle,
+        const void* _Nullable bytes,
+        size_t numBytes) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(valueHandle);
+    HAPPrecondition(!numBytes || bytes);
+
+    if (!attServer->isConnected || attServer->isIndicationPending) {
+        return kHAPError_InvalidState;
+    }
+
+    size_t numValueBytes = HAPMin(numBytes, (size_t)(attServer->mtu - 3));
+    uint8_t* pdu = attServer->pduBytes;
+    pdu[0] = kHAPPlatformBLEPeripheralManagerATTOpcode_HandleValueIndication;
+    HAPWriteLittleUInt16(&pdu[1], valueHandle);
+    if (numValueBytes) {
+        HAPRawBufferCopyBytes(&pdu[3], HAPNonnullVoid(bytes), numValueBytes);
+    }
+    attServer->isIndicationPending = true;
+    SendPDU(attServer, 3 + numValueBytes);
+    return kHAPError_None;
+}
@@ -0,0 +1,351 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_ATT_H
+#define HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_ATT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * GATT database and Attribute Protocol (ATT) server for BLE peripheral managers that are not backed by a host stack,
+ * e.g., because ATT PDUs are exchanged with a simulated central over a local socket instead of a radio.
+ *
+ * - The ATT server implements the server side of the procedures that HAP controllers use: MTU exchange,
+ *   primary service / characteristic / descriptor discovery, reads (including long reads), writes (including long
+ *   writes through the prepare write queue) and Handle Value Indications.
+ *
+ * - Service and characteristic declarations are served by the ATT server. All other attribute values are
+ *   read from and written to the BLE peripheral manager delegate.
+ *
+ * - Received ATT PDUs are passed to HAPPlatformBLEPeripheralManagerATTServerHandlePDU. Responses and indications are
+ *   sent through a callback. Framing of ATT PDUs is up to the transport that is used to exchange them.
+ *
+ * @see Bluetooth Core Specification Version 5.0
+ *      Vol 3, Part F Attribute Protocol (ATT)
+ */
+
+/**
+ * Default ATT_MTU.
+ */
+#define kHAPPlatformBLEPeripheralManagerATT_DefaultMTU ((uint16_t) 23)
+
+/**
+ * Maximum supported ATT_MTU.
+ *
+ * - Fits a Prepare Write Request with the maximum attribute value length.
+ */
+#define kHAPPlatformBLEPeripheralManagerATT_MaxMTU ((uint16_t)(5 + kHAPPlatformBLEPeripheralManager_MaxAttributeBytes))
+
+/**
+ * GATT service.
+ */
+typedef struct {
+    HAPPlatformBLEPeripheralManagerUUID type;
+    bool isPrimary;
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+} HAPPlatformBLEPeripheralManagerService;
+
+/**
+ * GATT characteristic.
+ */
+typedef struct {
+    HAPPlatformBLEPeripheralManagerUUID type;
+    HAPPlatformBLEPeripheralManagerCharacteristicProperties properties;
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;
+    HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandle;
+} HAPPlatformBLEPeripheralManagerCharacteristic;
+
+/**
+ * GATT descriptor.
+ */
+typedef struct {
+    HAPPlatformBLEPeripheralManagerUUID type;
+    HAPPlatformBLEPeripheralManagerDescriptorProperties properties;
+    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+} HAPPlatformBLEPeripheralManagerDescriptor;
+
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformBLEPeripheralManagerAttributeType) {
+    kHAPPlatformBLEPeripheralManagerAttributeType_None,
+    kHAPPlatformBLEPeripheralManagerAttributeType_Service,
+    kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic,
+    kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor
+} HAP_ENUM_END(uint8_t, HAPPlatformBLEPeripheralManagerAttributeType);
+
+/**
+ * GATT database element.
+ *
+ * - Elements are stored in ascending attribute handle order. Unused elements have type
+ *   kHAPPlatformBLEPeripheralManagerAttributeType_None and follow all used elements.
+ */
+typedef struct {
+    HAPPlatformBLEPeripheralManagerAttributeType type;
+    union {
+        HAPPlatformBLEPeripheralManagerDescriptor descriptor;
+        HAPPlatformBLEPeripheralManagerCharacteristic characteristic;
+        HAPPlatformBLEPeripheralManagerService service;
+    } _;
+} HAPPlatformBLEPeripheralManagerAttribute;
+
+/**
+ * Appends a service to a GATT database.
+ *
+ * @param      attributes           GATT database.
+ * @param      numAttributes        Capacity of the GATT database.
+ * @param      type                 Service type.
+ * @param      isPrimary            Whether the service is a primary service.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the GATT database is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddService(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        bool isPrimary);
+
+/**
+ * Appends a characteristic to the most recently added service of a GATT database.
+ *
+ * @param      attributes           GATT database.
+ * @param      numAttributes        Capacity of the GATT database.
+ * @param      type                 Characteristic type.
+ * @param      properties           Characteristic properties.
+ * @param[out] valueHandle          Attribute handle of the characteristic value.
+ * @param[out] cccDescriptorHandle  Attribute handle of the Client Characteristic Configuration descriptor.
+ *                                  Must be provided if and only if notify or indicate properties are set.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the GATT database is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddCharacteristic(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerCharacteristicProperties properties,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nullable cccDescriptorHandle);
+
+/**
+ * Appends a descriptor to the most recently added characteristic of a GATT database.
+ *
+ * @param      attributes           GATT database.
+ * @param      numAttributes        Capacity of the GATT database.
+ * @param      type                 Descriptor type.
+ * @param      properties           Descriptor properties.
+ * @param[out] descriptorHandle     Attribute handle of the descriptor.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the GATT database is full.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTAddDescriptor(
+        HAPPlatformBLEPeripheralManagerAttribute* attributes,
+        size_t numAttributes,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerDescriptorProperties properties,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* descriptorHandle);
+
+typedef struct HAPPlatformBLEPeripheralManagerATTServer HAPPlatformBLEPeripheralManagerATTServer;
+
+/**
+ * Callback that is invoked to send an ATT PDU to the connected central.
+ *
+ * @param      attServer            ATT server.
+ * @param      bytes                ATT PDU.
+ * @param      numBytes             Length of ATT PDU.
+ * @param      context              The context parameter given to HAPPlatformBLEPeripheralManagerATTServerCreate.
+ */
+typedef void (*HAPPlatformBLEPeripheralManagerATTSendPDUCallback)(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context);
+
+/**
+ * ATT server initialization options.
+ */
+typedef struct {
+    /** BLE peripheral manager that is passed to delegate callbacks. */
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager;
+
+    /** GATT database. */
+    const HAPPlatformBLEPeripheralManagerAttribute* attributes;
+
+    /** Capacity of the GATT database. */
+    size_t numAttributes;
+
+    /** BLE peripheral manager delegate. Must remain valid while the ATT server is used. */
+    const HAPPlatformBLEPeripheralManagerDelegate* delegate;
+
+    /**
+     * ATT_MTU that the server is able to receive.
+     * If 0, kHAPPlatformBLEPeripheralManagerATT_MaxMTU is used.
+     */
+    uint16_t mtu;
+
+    /** Callback that is invoked to send an ATT PDU. */
+    HAPPlatformBLEPeripheralManagerATTSendPDUCallback sendPDU;
+
+    /** Context that is passed to the sendPDU callback. */
+    void* _Nullable context;
+} HAPPlatformBLEPeripheralManagerATTServerOptions;
+
+/**
+ * ATT server.
+ */
+struct HAPPlatformBLEPeripheralManagerATTServer {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager;
+    const HAPPlatformBLEPeripheralManagerAttribute* attributes;
+    size_t numAttributes;
+    const HAPPlatformBLEPeripheralManagerDelegate* delegate;
+    HAPPlatformBLEPeripheralManagerATTSendPDUCallback sendPDU;
+    void* _Nullable context;
+    uint16_t serverMTU;
+
+    HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
+    uint16_t mtu;
+
+    /** Value of the most recently read attribute. Read Blob Requests are served from it. */
+    struct {
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+        uint16_t numBytes;
+        uint8_t bytes[kHAPPlatformBLEPeripheralManager_MaxAttributeBytes];
+    } readValue;
+
+    /** Prepare write queue. Only contiguous writes to a single attribute are supported. */
+    struct {
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle;
+        uint16_t numBytes;
+        uint8_t bytes[kHAPPlatformBLEPeripheralManager_MaxAttributeBytes];
+    } preparedWrite;
+
+    uint8_t pduBytes[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+
+    bool isConnected : 1;
+    bool isIndicationPending : 1;
+    /**@endcond */
+};
+
+/**
+ * Initializes an ATT server.
+ *
+ * @param[out] attServer            ATT server.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformBLEPeripheralManagerATTServerCreate(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const HAPPlatformBLEPeripheralManagerATTServerOptions* options);
+
+/**
+ * Handles a new connection from a central.
+ *
+ * - The handleConnectedCentral delegate callback is invoked.
+ *
+ * @param      attServer            ATT server. Must not be connected.
+ * @param      connectionHandle     Connection handle of the central.
+ */
+void HAPPlatformBLEPeripheralManagerATTServerConnect(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle);
+
+/**
+ * Handles the disconnection of the connected central.
+ *
+ * - The handleDisconnectedCentral delegate callback is invoked.
+ *
+ * @param      attServer            ATT server. Must be connected.
+ */
+void HAPPlatformBLEPeripheralManagerATTServerDisconnect(HAPPlatformBLEPeripheralManagerATTServer* attServer);
+
+/**
+ * Returns whether a central is connected.
+ *
+ * @param      attServer            ATT server.
+ *
+ * @return true                     If a central is connected.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerATTServerIsConnected(const HAPPlatformBLEPeripheralManagerATTServer* attServer);
+
+/**
+ * Returns the connection handle of the connected central.
+ *
+ * @param      attServer            ATT server. Must be connected.
+ *
+ * @return Connection handle.
+ */
+HAP_RESULT_USE_CHECK
+HAPPlatformBLEPeripheralManagerConnectionHandle HAPPlatformBLEPeripheralManagerATTServerGetConnectionHandle(
+        const HAPPlatformBLEPeripheralManagerATTServer* attServer);
+
+/**
+ * Returns the ATT_MTU of the connection.
+ *
+ * @param      attServer            ATT server. Must be connected.
+ *
+ * @return ATT_MTU.
+ */
+HAP_RESULT_USE_CHECK
+uint16_t HAPPlatformBLEPeripheralManagerATTServerGetMTU(const HAPPlatformBLEPeripheralManagerATTServer* attServer);
+
+/**
+ * Processes an ATT PDU that has been received from the connected central.
+ *
+ * - A response is sent for every request, including error responses for malformed or unsupported requests.
+ *
+ * @param      attServer            ATT server. Must be connected.
+ * @param      bytes                ATT PDU. The buffer may be modified.
+ * @param      numBytes             Length of ATT PDU.
+ */
+void HAPPlatformBLEPeripheralManagerATTServerHandlePDU(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        void* bytes,
+        size_t numBytes);
+
+/**
+ * Sends a Handle Value Indication to the connected central.
+ *
+ * - Only one indication may be outstanding at a time. Once the central confirms it,
+ *   the handleReadyToUpdateSubscribers delegate callback is invoked.
+ *
+ * @param      attServer            ATT server.
+ * @param      valueHandle          Attribute handle of the characteristic value.
+ * @param      bytes                Value. Truncated to ATT_MTU - 3 bytes.
+ * @param      numBytes             Length of value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no central is connected or an indication has not been confirmed yet.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerATTServerSendHandleValueIndication(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle,
+        const void* _Nullable bytes,
+        size_t numBytes);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
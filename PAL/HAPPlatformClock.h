@@ -29,6 +29,19 @@ extern "C" {
  */
 HAPTime HAPPlatformClockGetCurrent(void);
 
+/**
+ * Gets the current system time with the precision of a run loop iteration.
+ *
+ * - The platform may return a time that has been sampled when the run loop woke up for the current iteration,
+ *   saving a clock read. Use HAPPlatformClockGetCurrent when time that passes during the current iteration matters.
+ * - The returned time is never earlier than a time previously returned by HAPPlatformClockGetCurrent.
+ *   Both functions may therefore be used to compute time differences with each other.
+ * - Must only be called on the run loop thread.
+ *
+ * @return Clock in milliseconds.
+ */
+HAPTime HAPPlatformClockGetCurrentCoarse(void);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -0,0 +1,161 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformGPIOInput.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "GPIOInput" };
+
+/** Offset of the timestamp within a line event. */
+#define kEvent_TimestampOffset ((size_t) 0)
+
+/** Offset of the event ID within a line event. */
+#define kEvent_IDOffset ((size_t) 8)
+
+void HAPPlatformGPIOInputCreate(HAPPlatformGPIOInput* input, const HAPPlatformGPIOInputOptions* options) {
+    HAPPrecondition(input);
+    HAPPrecondition(options);
+    HAPPrecondition(options->callback);
+    HAPPrecondition(options->debounceDuration <= UINT64_MAX / 1000000);
+
+    HAPRawBufferZero(input, sizeof *input);
+    input->callback = options->callback;
+    input->context = options->context;
+    input->debounceNanoseconds = options->debounceDuration * 1000000;
+    input->value = options->initialValue;
+}
+
+/**
+ * Reports the pending edge with the timestamp at which the debounce duration elapses.
+ *
+ * @param      input                GPIO input.
+ */
+static void ReportPendingEdge(HAPPlatformGPIOInput* input) {
+    HAPPrecondition(input);
+    HAPPrecondition(input->hasPendingEdge);
+
+    input->value = !input->value;
+    input->hasPendingEdge = false;
+    input->lastEdgeTimestamp += input->debounceNanoseconds;
+    HAPLogDebug(&logObject, "Reporting pending %s edge.", input->value ? "rising" : "falling");
+    input->callback(input, input->value, input->lastEdgeTimestamp, input->context);
+}
+
+/**
+ * Processes a complete line event.
+ *
+ * @param      input                GPIO input.
+ * @param      bytes                Line event.
+ */
+static void HandleEvent(HAPPlatformGPIOInput* input, const uint8_t bytes[kHAPPlatformGPIOInputEvent_NumBytes]) {
+    HAPPrecondition(input);
+    HAPPrecondition(bytes);
+
+    uint64_t timestamp;
+    HAPRawBufferCopyBytes(&timestamp, &bytes[kEvent_TimestampOffset], sizeof timestamp);
+    uint32_t eventID;
+    HAPRawBufferCopyBytes(&eventID, &bytes[kEvent_IDOffset], sizeof eventID);
+
+    bool value;
+    switch (eventID) {
+        case kHAPPlatformGPIOInputEvent_RisingEdge: {
+            value = true;
+        } break;
+        case kHAPPlatformGPIOInputEvent_FallingEdge: {
+            value = false;
+        } break;
+        default: {
+            HAPLog(&logObject, "Ignoring line event with unknown ID 0x%08lX.", (unsigned long) eventID);
+            return;
+        }
+    }
+
+    input->lastEventTimestamp = timestamp;
+    if (input->hasPendingEdge && timestamp - input->lastEdgeTimestamp >= input->debounceNanoseconds) {
+        ReportPendingEdge(input);
+    }
+
+    if (value == input->value) {
+        if (input->hasPendingEdge) {
+            HAPLogDebug(&logObject, "Discarding pending edge. Line returned to its value.");
+            input->hasPendingEdge = false;
+        } else {
+            HAPLogDebug(&logObject, "Ignoring %s edge that does not change the value.", value ? "rising" : "falling");
+        }
+        return;
+    }
+    if (input->hasReportedEdge && timestamp - input->lastEdgeTimestamp < input->debounceNanoseconds) {
+        HAPLogDebug(
+                &logObject,
+                "Deferring %s edge %llu ns after previous edge.",
+                value ? "rising" : "falling",
+                (unsigned long long) (timestamp - input->lastEdgeTimestamp));
+        input->hasPendingEdge = true;
+        return;
+    }
+
+    input->value = value;
+    input->hasReportedEdge = true;
+    input->lastEdgeTimestamp = timestamp;
+    input->callback(input, value, timestamp, input->context);
+}
+
+void HAPPlatformGPIOInputHandleBytes(HAPPlatformGPIOInput* input, const void* bytes_, size_t numBytes) {
+    HAPPrecondition(input);
+    HAPPrecondition(bytes_);
+    const uint8_t* bytes = bytes_;
+
+    while (numBytes) {
+        // Fast path: complete events that are not preceded by a partial event are processed in place.
+        if (!input->numEventBytes && numBytes >= kHAPPlatformGPIOInputEvent_NumBytes) {
+            HandleEvent(input, bytes);
+            bytes += kHAPPlatformGPIOInputEvent_NumBytes;
+            numBytes -= kHAPPlatformGPIOInputEvent_NumBytes;
+            continue;
+        }
+
+        size_t n = kHAPPlatformGPIOInputEvent_NumBytes - input->numEventBytes;
+        if (n > numBytes) {
+            n = numBytes;
+        }
+        HAPRawBufferCopyBytes(&input->eventBytes[input->numEventBytes], bytes, n);
+        input->numEventBytes += n;
+        bytes += n;
+        numBytes -= n;
+        if (input->numEventBytes == kHAPPlatformGPIOInputEvent_NumBytes) {
+            input->numEventBytes = 0;
+            HandleEvent(input, input->eventBytes);
+        }
+    }
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOInputGetPendingEdgeDelay(const HAPPlatformGPIOInput* input, HAPTime* delay) {
+    HAPPrecondition(input);
+    HAPPrecondition(delay);
+
+    if (!input->hasPendingEdge) {
+        return false;
+    }
+    HAPAssert(input->lastEventTimestamp - input->lastEdgeTimestamp < input->debounceNanoseconds);
+    uint64_t delayNanoseconds = input->lastEdgeTimestamp + input->debounceNanoseconds - input->lastEventTimestamp;
+    *delay = (delayNanoseconds + 1000000 - 1) / 1000000;
+    return true;
+}
+
+void HAPPlatformGPIOInputHandleDebounceTimeout(HAPPlatformGPIOInput* input) {
+    HAPPrecondition(input);
+
+    if (input->hasPendingEdge) {
+        ReportPendingEdge(input);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOInputGetValue(const HAPPlatformGPIOInput* input) {
+    HAPPrecondition(input);
+
+    return input->value;
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_GPIO_INPUT_H
+#define HAP_PLATFORM_GPIO_INPUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Edge decoder and debouncer for a GPIO input line.
+ *
+ * The decoder consumes the stream of line events that is read from a line event file descriptor of the Linux GPIO
+ * character device (struct gpioevent_data, ABI v1). It does not perform any I/O by itself, so that the same stream
+ * may be produced by the kernel or by a fake backend such as a pipe.
+ *
+ * - Events may be passed in arbitrary fragments. Partial events are buffered until they are complete.
+ *
+ * - An edge is reported if it changes the value of the line and if at least the debounce duration has elapsed since
+ *   the previous reported edge, based on the timestamps of the events. Edges that do not change the value are ignored.
+ *
+ * - If the line settles at a different value within the debounce duration, the edge is pending. It is reported
+ *   with the timestamp at which the debounce duration elapses, either when the next line event arrives or when
+ *   HAPPlatformGPIOInputHandleDebounceTimeout is called. The owner arms a timer with the delay that is returned by
+ *   HAPPlatformGPIOInputGetPendingEdgeDelay, so that short presses are not lost while the line stays quiet.
+ *
+ * **Example**
+
+   @code{.c}
+
+   static void HandleEdge(HAPPlatformGPIOInput* input, bool value, uint64_t timestamp, void* _Nullable context)
+   {
+       // Value changed.
+   }
+
+   static HAPPlatformGPIOInput input;
+   HAPPlatformGPIOInputCreate(&input,
+       &(const HAPPlatformGPIOInputOptions) {
+           .initialValue = true,
+           .debounceDuration = 20 * HAPMillisecond,
+           .callback = HandleEdge
+       });
+
+   // For each chunk of bytes that is read from the line event file descriptor.
+   HAPPlatformGPIOInputHandleBytes(&input, bytes, numBytes);
+
+   // Once no further line events have been read for the pending edge delay.
+   HAPTime delay;
+   if (HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay)) {
+       // Arm a timer that calls HAPPlatformGPIOInputHandleDebounceTimeout(&input) after delay.
+   }
+
+   @endcode
+ */
+
+/**
+ * Length of a line event.
+ *
+ * - Layout: 64-bit timestamp in nanoseconds, 32-bit event ID, padding. All fields use native byte order.
+ */
+#define kHAPPlatformGPIOInputEvent_NumBytes ((size_t) 16)
+
+/**
+ * Line event IDs.
+ */
+/**@{*/
+/** Rising edge. */
+#define kHAPPlatformGPIOInputEvent_RisingEdge ((uint32_t) 0x01)
+
+/** Falling edge. */
+#define kHAPPlatformGPIOInputEvent_FallingEdge ((uint32_t) 0x02)
+/**@}*/
+
+typedef struct HAPPlatformGPIOInput HAPPlatformGPIOInput;
+
+/**
+ * Callback that is invoked when the value of a GPIO input line changes.
+ *
+ * @param      input                GPIO input.
+ * @param      value                New value of the line.
+ * @param      timestamp            Timestamp of the edge in nanoseconds, as provided by the event source.
+ * @param      context              The context parameter given to the HAPPlatformGPIOInputCreate function.
+ */
+typedef void (*HAPPlatformGPIOInputCallback)(
+        HAPPlatformGPIOInput* input,
+        bool value,
+        uint64_t timestamp,
+        void* _Nullable context);
+
+/**
+ * GPIO input initialization options.
+ */
+typedef struct {
+    /**
+     * Value of the line before the first event.
+     */
+    bool initialValue;
+
+    /**
+     * Minimum duration between two reported edges. 0 disables debouncing.
+     */
+    HAPTime debounceDuration;
+
+    /**
+     * Callback to invoke when the value of the line changes.
+     */
+    HAPPlatformGPIOInputCallback callback;
+
+    /**
+     * Context that is passed to the callback.
+     */
+    void* _Nullable context;
+} HAPPlatformGPIOInputOptions;
+
+/**
+ * GPIO input.
+ */
+struct HAPPlatformGPIOInput {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformGPIOInputCallback callback;
+    void* _Nullable context;
+    uint64_t debounceNanoseconds;
+
+    bool value;
+    bool hasReportedEdge;
+    bool hasPendingEdge;
+    uint64_t lastEdgeTimestamp;
+    uint64_t lastEventTimestamp;
+
+    uint8_t eventBytes[kHAPPlatformGPIOInputEvent_NumBytes];
+    size_t numEventBytes;
+    /**@endcond */
+};
+
+/**
+ * Initializes a GPIO input.
+ *
+ * @param[out] input                Pointer to an allocated but uninitialized HAPPlatformGPIOInput structure.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformGPIOInputCreate(HAPPlatformGPIOInput* input, const HAPPlatformGPIOInputOptions* options);
+
+/**
+ * Processes bytes that have been read from a line event file descriptor.
+ *
+ * - The callback is invoked synchronously for each reported edge.
+ *
+ * - Events with unknown IDs are ignored.
+ *
+ * @param      input                GPIO input.
+ * @param      bytes                Bytes.
+ * @param      numBytes             Number of bytes.
+ */
+void HAPPlatformGPIOInputHandleBytes(HAPPlatformGPIOInput* input, const void* bytes, size_t numBytes);
+
+/**
+ * Returns whether an edge is pending because it followed the previous reported edge within the debounce duration.
+ *
+ * @param      input                GPIO input.
+ * @param[out] delay                Time after the most recent line event at which the pending edge is reported.
+ *
+ * @return true                     If an edge is pending.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOInputGetPendingEdgeDelay(const HAPPlatformGPIOInput* input, HAPTime* delay);
+
+/**
+ * Reports a pending edge after the debounce duration has elapsed without further line events.
+ *
+ * - The callback is invoked synchronously if an edge is pending. Otherwise, this function has no effect.
+ *
+ * @param      input                GPIO input.
+ */
+void HAPPlatformGPIOInputHandleDebounceTimeout(HAPPlatformGPIOInput* input);
+
+/**
+ * Returns the debounced value of a GPIO input line.
+ *
+ * @param      input                GPIO input.
+ *
+ * @return Value of the line.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOInputGetValue(const HAPPlatformGPIOInput* input);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1269 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformMDNSResponder.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "MDNSResponder" };
+
+/** Length of a DNS message header. */
+#define kDNSHeader_NumBytes ((size_t) 12)
+
+/** Length of the fixed part of a resource record that follows its name. */
+#define kDNSRecordHeader_NumBytes ((size_t) 10)
+
+/** Maximum length of a DNS name in wire format. */
+#define kDNSName_MaxBytes ((size_t) 255)
+
+/** DNS header flags. */
+/**@{*/
+#define kDNSFlags_Response      ((uint16_t) 0x8000)
+#define kDNSFlags_Opcode        ((uint16_t) 0x7800)
+#define kDNSFlags_Authoritative ((uint16_t) 0x0400)
+/**@}*/
+
+/** DNS resource record types. */
+/**@{*/
+#define kDNSType_A    ((uint16_t) 1)
+#define kDNSType_PTR  ((uint16_t) 12)
+#define kDNSType_TXT  ((uint16_t) 16)
+#define kDNSType_AAAA ((uint16_t) 28)
+#define kDNSType_SRV  ((uint16_t) 33)
+#define kDNSType_ANY  ((uint16_t) 255)
+/**@}*/
+
+/** DNS classes. */
+/**@{*/
+#define kDNSClass_IN  ((uint16_t) 1)
+#define kDNSClass_ANY ((uint16_t) 255)
+/**@}*/
+
+/** Cache-flush bit of records, or unicast-response bit of questions. */
+#define kDNSClass_CacheFlush ((uint16_t) 0x8000)
+
+/** TTL of records that refer to the host name (RFC 6762, Section 10). */
+#define kTTL_HostRecords ((uint32_t) 120)
+
+/** TTL of other records (RFC 6762, Section 10). */
+#define kTTL_OtherRecords ((uint32_t) 4500)
+
+/** Number of probes that are sent before a name is claimed (RFC 6762, Section 8.1). */
+#define kNumProbes ((uint8_t) 3)
+
+/** Interval between probes. */
+#define kProbeInterval ((HAPTime)(250 * HAPMillisecond))
+
+/** Number of announcements after probing or a record update (RFC 6762, Section 8.3). */
+#define kNumAnnouncements ((uint8_t) 2)
+
+/** Interval between announcements. */
+#define kAnnouncementInterval ((HAPTime)(1 * HAPSecond))
+
+/** Minimum interval between multicast responses (RFC 6762, Section 6). */
+#define kMinMulticastInterval ((HAPTime)(1 * HAPSecond))
+
+/** Number of name conflicts after which probing is delayed (RFC 6762, Section 8.1). */
+#define kMaxConflictsBeforeDelay ((unsigned int) 15)
+
+/** Probing delay after too many name conflicts. */
+#define kConflictDelay ((HAPTime)(5 * HAPSecond))
+
+/**
+ * Packet writer.
+ */
+typedef struct {
+    uint8_t* bytes;
+    size_t maxBytes;
+    size_t numBytes;
+} PacketWriter;
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendBytes(PacketWriter* writer, const void* bytes, size_t numBytes) {
+    HAPPrecondition(writer);
+    HAPPrecondition(bytes);
+
+    if (numBytes > writer->maxBytes - writer->numBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(&writer->bytes[writer->numBytes], bytes, numBytes);
+    writer->numBytes += numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendUInt8(PacketWriter* writer, uint8_t value) {
+    return AppendBytes(writer, &value, sizeof value);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendUInt16(PacketWriter* writer, uint16_t value) {
+    uint8_t bytes[] = { HAPExpandBigUInt16(value) };
+    return AppendBytes(writer, bytes, sizeof bytes);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendUInt32(PacketWriter* writer, uint32_t value) {
+    uint8_t bytes[] = { HAPExpandBigUInt32(value) };
+    return AppendBytes(writer, bytes, sizeof bytes);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendLabel(PacketWriter* writer, const void* bytes, size_t numBytes) {
+    HAPPrecondition(numBytes && numBytes <= kHAPPlatformMDNSResponder_MaxLabelBytes);
+
+    HAPError err;
+
+    err = AppendUInt8(writer, (uint8_t) numBytes);
+    if (err) {
+        return err;
+    }
+    return AppendBytes(writer, bytes, numBytes);
+}
+
+/**
+ * Appends the labels of a dot-separated name, e.g. "_hap._tcp". The name is not terminated.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError AppendLabels(PacketWriter* writer, const char* name) {
+    HAPPrecondition(name);
+
+    HAPError err;
+
+    const char* label = name;
+    for (const char* c = name;; c++) {
+        if (*c == '.' || !*c) {
+            err = AppendLabel(writer, label, (size_t)(c - label));
+            if (err) {
+                return err;
+            }
+            if (!*c) {
+                return kHAPError_None;
+            }
+            label = c + 1;
+        }
+    }
+}
+
+/**
+ * Appends a compression pointer that terminates a name.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError AppendPointer(PacketWriter* writer, size_t offset) {
+    HAPPrecondition(offset < 0x3FFF);
+    return AppendUInt16(writer, (uint16_t)(0xC000U | offset));
+}
+
+/**
+ * Appends the type, class and TTL of a record whose name has already been appended.
+ *
+ * @param      writer               Packet writer.
+ * @param      type                 Record type.
+ * @param      class_               Record class.
+ * @param      ttl                  TTL.
+ * @param[out] ttlOffset            Offset of the TTL in the packet.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError AppendRecordHeader(
+        PacketWriter* writer,
+        uint16_t type,
+        uint16_t class_,
+        uint32_t ttl,
+        size_t* _Nullable ttlOffset) {
+    HAPError err;
+
+    err = AppendUInt16(writer, type);
+    if (err) {
+        return err;
+    }
+    err = AppendUInt16(writer, class_);
+    if (err) {
+        return err;
+    }
+    if (ttlOffset) {
+        *ttlOffset = writer->numBytes;
+    }
+    return AppendUInt32(writer, ttl);
+}
+
+/**
+ * Patches the RDLENGTH field of a record after its data has been appended.
+ *
+ * @param      writer               Packet writer.
+ * @param      rdLengthOffset       Offset of the RDLENGTH field.
+ */
+static void PatchRecordDataLength(PacketWriter* writer, size_t rdLengthOffset) {
+    HAPPrecondition(writer);
+    HAPPrecondition(rdLengthOffset + sizeof(uint16_t) <= writer->numBytes);
+
+    size_t numDataBytes = writer->numBytes - rdLengthOffset - sizeof(uint16_t);
+    HAPAssert(numDataBytes <= UINT16_MAX);
+    HAPWriteBigUInt16(&writer->bytes[rdLengthOffset], numDataBytes);
+}
+
+/**
+ * Derives a DNS label from a name and a suffix. The name is truncated so that the label fits.
+ *
+ * @param      name                 Name.
+ * @param      suffix               Suffix.
+ * @param[out] label                NULL-terminated label.
+ */
+static void GetLabel(
+        const char* name,
+        const char* suffix,
+        char label[_Nonnull kHAPPlatformMDNSResponder_MaxLabelBytes + 1]) {
+    HAPPrecondition(name);
+    HAPPrecondition(suffix);
+    HAPPrecondition(label);
+
+    size_t numSuffixBytes = HAPStringGetNumBytes(suffix);
+    HAPAssert(numSuffixBytes < kHAPPlatformMDNSResponder_MaxLabelBytes);
+    size_t numNameBytes = HAPStringGetNumBytes(name);
+    if (numNameBytes > kHAPPlatformMDNSResponder_MaxLabelBytes - numSuffixBytes) {
+        numNameBytes = kHAPPlatformMDNSResponder_MaxLabelBytes - numSuffixBytes;
+
+        // Do not split UTF-8 sequences.
+        while (numNameBytes && ((uint8_t) name[numNameBytes] & 0xC0U) == 0x80U) {
+            numNameBytes--;
+        }
+    }
+    HAPRawBufferCopyBytes(&label[0], name, numNameBytes);
+    HAPRawBufferCopyBytes(&label[numNameBytes], suffix, numSuffixBytes);
+    label[numNameBytes + numSuffixBytes] = '\0';
+}
+
+/**
+ * Returns the label of the service instance, taking name conflicts into account.
+ */
+static void GetInstanceLabel(
+        const HAPPlatformMDNSResponder* responder,
+        char label[_Nonnull kHAPPlatformMDNSResponder_MaxLabelBytes + 1]) {
+    HAPPrecondition(responder);
+
+    HAPError err;
+
+    char suffix[16] = "";
+    if (responder->numConflicts) {
+        err = HAPStringWithFormat(suffix, sizeof suffix, " (%u)", responder->numConflicts + 1);
+        HAPAssert(!err);
+    }
+    GetLabel(responder->name, suffix, label);
+}
+
+/**
+ * Returns the label of the host, taking name conflicts into account.
+ */
+static void GetHostLabel(
+        const HAPPlatformMDNSResponder* responder,
+        char label[_Nonnull kHAPPlatformMDNSResponder_MaxLabelBytes + 1]) {
+    HAPPrecondition(responder);
+
+    HAPError err;
+
+    char suffix[16] = "";
+    if (responder->numConflicts) {
+        err = HAPStringWithFormat(suffix, sizeof suffix, "-%u", responder->numConflicts + 1);
+        HAPAssert(!err);
+    }
+    GetLabel(responder->hostName, suffix, label);
+}
+
+/**
+ * Serializes TXT records into TXT record data.
+ *
+ * @param      txtRecords           Array of TXT records.
+ * @param      numTXTRecords        Number of TXT records.
+ * @param[out] bytes                Buffer for TXT record data.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of TXT record data.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SerializeTXTRecords(
+        const HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(txtRecords);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    PacketWriter writer = { .bytes = bytes, .maxBytes = maxBytes, .numBytes = 0 };
+    for (size_t i = 0; i < numTXTRecords; i++) {
+        HAPPrecondition(txtRecords[i].key);
+        HAPPrecondition(!txtRecords[i].value.numBytes || txtRecords[i].value.bytes);
+        HAPPrecondition(txtRecords[i].value.numBytes <= UINT8_MAX);
+        if (txtRecords[i].value.bytes) {
+            HAPLogBufferDebug(
+                    &logObject,
+                    txtRecords[i].value.bytes,
+                    txtRecords[i].value.numBytes,
+                    "txtRecord[%lu]: \"%s\"",
+                    (unsigned long) i,
+                    txtRecords[i].key);
+        } else {
+            HAPLogDebug(&logObject, "txtRecord[%lu]: \"%s\"", (unsigned long) i, txtRecords[i].key);
+        }
+
+        size_t numKeyBytes = HAPStringGetNumBytes(txtRecords[i].key);
+        size_t numEntryBytes = numKeyBytes;
+        if (txtRecords[i].value.bytes) {
+            numEntryBytes += 1 + txtRecords[i].value.numBytes;
+        }
+        if (!numKeyBytes || numEntryBytes > UINT8_MAX) {
+            HAPLogError(&logObject, "TXT record \"%s\" is invalid.", txtRecords[i].key);
+            return kHAPError_OutOfResources;
+        }
+        err = AppendUInt8(&writer, (uint8_t) numEntryBytes);
+        if (!err) {
+            err = AppendBytes(&writer, txtRecords[i].key, numKeyBytes);
+        }
+        if (!err && txtRecords[i].value.bytes) {
+            err = AppendUInt8(&writer, '=');
+            if (!err) {
+                err = AppendBytes(&writer, HAPNonnullVoid(txtRecords[i].value.bytes), txtRecords[i].value.numBytes);
+            }
+        }
+        if (err) {
+            return err;
+        }
+    }
+    if (!writer.numBytes) {
+        // An empty TXT record contains a single empty string (RFC 6763, Section 6.1).
+        err = AppendUInt8(&writer, 0);
+        if (err) {
+            return err;
+        }
+    }
+    *numBytes = writer.numBytes;
+    return kHAPError_None;
+}
+
+/**
+ * Serializes the packet that answers queries and announces the service.
+ *
+ * - The records are ordered so that compression pointers only refer to earlier records and the TXT record is last.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      txtBytes             TXT record data.
+ * @param      numTXTBytes          Length of TXT record data.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the packet does not fit.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SerializeResponse(HAPPlatformMDNSResponder* responder, const void* txtBytes, size_t numTXTBytes) {
+    HAPPrecondition(responder);
+    HAPPrecondition(txtBytes);
+
+    HAPError err;
+
+    char instanceLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    GetInstanceLabel(responder, instanceLabel);
+    char hostLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    GetHostLabel(responder, hostLabel);
+
+    PacketWriter writer = { .bytes = responder->packetBytes,
+                            .maxBytes = sizeof responder->packetBytes,
+                            .numBytes = 0 };
+    responder->numTTLOffsets = 0;
+    size_t rdLengthOffset = 0;
+
+    // Header.
+    err = AppendUInt16(&writer, /* id: */ 0);
+    if (!err) {
+        err = AppendUInt16(&writer, kDNSFlags_Response | kDNSFlags_Authoritative);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* qdcount: */ 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* ancount: */ (uint16_t)(4 + responder->numAddresses));
+    }
+    if (!err) {
+        err = AppendUInt32(&writer, /* nscount, arcount: */ 0);
+    }
+
+    // PTR <protocol>.local -> <instance>.<protocol>.local
+    if (!err) {
+        responder->serviceNameOffset = writer.numBytes;
+        err = AppendLabels(&writer, responder->protocol);
+    }
+    if (!err) {
+        responder->localNameOffset = writer.numBytes;
+        err = AppendLabels(&writer, "local");
+    }
+    if (!err) {
+        err = AppendUInt8(&writer, 0);
+    }
+    if (!err) {
+        err = AppendRecordHeader(
+                &writer,
+                kDNSType_PTR,
+                kDNSClass_IN,
+                kTTL_OtherRecords,
+                &responder->ttlOffsets[responder->numTTLOffsets++]);
+    }
+    if (!err) {
+        rdLengthOffset = writer.numBytes;
+        err = AppendUInt16(&writer, 0);
+    }
+    if (!err) {
+        responder->instanceNameOffset = writer.numBytes;
+        err = AppendLabel(&writer, instanceLabel, HAPStringGetNumBytes(instanceLabel));
+    }
+    if (!err) {
+        err = AppendPointer(&writer, responder->serviceNameOffset);
+    }
+    if (!err) {
+        PatchRecordDataLength(&writer, rdLengthOffset);
+    }
+
+    // PTR _services._dns-sd._udp.local -> <protocol>.local (RFC 6763, Section 9).
+    if (!err) {
+        responder->metaServiceNameOffset = writer.numBytes;
+        err = AppendLabels(&writer, "_services._dns-sd._udp");
+    }
+    if (!err) {
+        err = AppendPointer(&writer, responder->localNameOffset);
+    }
+    if (!err) {
+        err = AppendRecordHeader(
+                &writer,
+                kDNSType_PTR,
+                kDNSClass_IN,
+                kTTL_OtherRecords,
+                &responder->ttlOffsets[responder->numTTLOffsets++]);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, sizeof(uint16_t));
+    }
+    if (!err) {
+        err = AppendPointer(&writer, responder->serviceNameOffset);
+    }
+
+    // SRV <instance>.<protocol>.local -> <host>.local:<port>
+    if (!err) {
+        err = AppendPointer(&writer, responder->instanceNameOffset);
+    }
+    if (!err) {
+        err = AppendRecordHeader(
+                &writer,
+                kDNSType_SRV,
+                kDNSClass_IN | kDNSClass_CacheFlush,
+                kTTL_HostRecords,
+                &responder->ttlOffsets[responder->numTTLOffsets++]);
+    }
+    if (!err) {
+        rdLengthOffset = writer.numBytes;
+        err = AppendUInt16(&writer, 0);
+    }
+    if (!err) {
+        err = AppendUInt32(&writer, /* priority, weight: */ 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, responder->port);
+    }
+    if (!err) {
+        responder->hostNameOffset = writer.numBytes;
+        err = AppendLabel(&writer, hostLabel, HAPStringGetNumBytes(hostLabel));
+    }
+    if (!err) {
+        err = AppendPointer(&writer, responder->localNameOffset);
+    }
+    if (!err) {
+        PatchRecordDataLength(&writer, rdLengthOffset);
+    }
+
+    // A / AAAA <host>.local
+    for (size_t i = 0; !err && i < responder->numAddresses; i++) {
+        const HAPPlatformMDNSResponderAddress* address = &responder->addresses[i];
+        bool isIPv4 = address->version == kHAPIPAddressVersion_IPv4;
+        err = AppendPointer(&writer, responder->hostNameOffset);
+        if (!err) {
+            err = AppendRecordHeader(
+                    &writer,
+                    isIPv4 ? kDNSType_A : kDNSType_AAAA,
+                    kDNSClass_IN | kDNSClass_CacheFlush,
+                    kTTL_HostRecords,
+                    &responder->ttlOffsets[responder->numTTLOffsets++]);
+        }
+        if (!err) {
+            err = AppendUInt16(&writer, isIPv4 ? 4 : 16);
+        }
+        if (!err) {
+            err = AppendBytes(&writer, address->bytes, isIPv4 ? 4 : 16);
+        }
+    }
+
+    // TXT <instance>.<protocol>.local
+    if (!err) {
+        err = AppendPointer(&writer, responder->instanceNameOffset);
+    }
+    if (!err) {
+        err = AppendRecordHeader(
+                &writer,
+                kDNSType_TXT,
+                kDNSClass_IN | kDNSClass_CacheFlush,
+                kTTL_OtherRecords,
+                &responder->ttlOffsets[responder->numTTLOffsets++]);
+    }
+    if (!err) {
+        responder->txtRecordOffset = writer.numBytes;
+        err = AppendUInt16(&writer, 0);
+    }
+    if (!err) {
+        err = AppendBytes(&writer, txtBytes, numTXTBytes);
+    }
+    if (!err) {
+        PatchRecordDataLength(&writer, responder->txtRecordOffset);
+    }
+
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    HAPAssert(responder->numTTLOffsets <= HAPArrayCount(responder->ttlOffsets));
+    responder->numPacketBytes = writer.numBytes;
+    return kHAPError_None;
+}
+
+/**
+ * Serializes a probe for the service instance and host names into the scratch buffer (RFC 6762, Section 8.1).
+ *
+ * @param      responder            Multicast DNS responder.
+ *
+ * @return Length of the probe.
+ */
+HAP_RESULT_USE_CHECK
+static size_t SerializeProbe(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    HAPError err;
+
+    char instanceLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    GetInstanceLabel(responder, instanceLabel);
+    char hostLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    GetHostLabel(responder, hostLabel);
+
+    const uint8_t* txtBytes = &responder->packetBytes[responder->txtRecordOffset];
+    size_t numTXTBytes = responder->numPacketBytes - responder->txtRecordOffset;
+
+    PacketWriter writer = { .bytes = responder->scratchBytes,
+                            .maxBytes = sizeof responder->scratchBytes,
+                            .numBytes = 0 };
+
+    // Header.
+    err = AppendUInt16(&writer, /* id: */ 0);
+    if (!err) {
+        err = AppendUInt16(&writer, /* flags: */ 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* qdcount: */ 2);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* ancount: */ 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* nscount: */ (uint16_t)(2 + responder->numAddresses));
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, /* arcount: */ 0);
+    }
+
+    // Questions for all records of the service instance and host names.
+    size_t instanceNameOffset = writer.numBytes;
+    size_t localNameOffset = 0;
+    if (!err) {
+        err = AppendLabel(&writer, instanceLabel, HAPStringGetNumBytes(instanceLabel));
+    }
+    if (!err) {
+        err = AppendLabels(&writer, responder->protocol);
+    }
+    if (!err) {
+        localNameOffset = writer.numBytes;
+        err = AppendLabels(&writer, "local");
+    }
+    if (!err) {
+        err = AppendUInt8(&writer, 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, kDNSType_ANY);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, kDNSClass_IN | kDNSClass_CacheFlush);
+    }
+    size_t hostNameOffset = writer.numBytes;
+    if (!err) {
+        err = AppendLabel(&writer, hostLabel, HAPStringGetNumBytes(hostLabel));
+    }
+    if (!err) {
+        err = AppendPointer(&writer, localNameOffset);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, kDNSType_ANY);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, kDNSClass_IN | kDNSClass_CacheFlush);
+    }
+
+    // Proposed records in the authority section.
+    if (!err) {
+        err = AppendPointer(&writer, instanceNameOffset);
+    }
+    if (!err) {
+        err = AppendRecordHeader(&writer, kDNSType_SRV, kDNSClass_IN, kTTL_HostRecords, /* ttlOffset: */ NULL);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, 6 + sizeof(uint16_t));
+    }
+    if (!err) {
+        err = AppendUInt32(&writer, /* priority, weight: */ 0);
+    }
+    if (!err) {
+        err = AppendUInt16(&writer, responder->port);
+    }
+    if (!err) {
+        err = AppendPointer(&writer, hostNameOffset);
+    }
+    for (size_t i = 0; !err && i < responder->numAddresses; i++) {
+        const HAPPlatformMDNSResponderAddress* address = &responder->addresses[i];
+        bool isIPv4 = address->version == kHAPIPAddressVersion_IPv4;
+        err = AppendPointer(&writer, hostNameOffset);
+        if (!err) {
+            err = AppendRecordHeader(
+                    &writer,
+                    isIPv4 ? kDNSType_A : kDNSType_AAAA,
+                    kDNSClass_IN,
+                    kTTL_HostRecords,
+                    /* ttlOffset: */ NULL);
+        }
+        if (!err) {
+            err = AppendUInt16(&writer, isIPv4 ? 4 : 16);
+        }
+        if (!err) {
+            err = AppendBytes(&writer, address->bytes, isIPv4 ? 4 : 16);
+        }
+    }
+    if (!err) {
+        err = AppendPointer(&writer, instanceNameOffset);
+    }
+    if (!err) {
+        err = AppendRecordHeader(&writer, kDNSType_TXT, kDNSClass_IN, kTTL_OtherRecords, /* ttlOffset: */ NULL);
+    }
+    if (!err) {
+        // Includes RDLENGTH.
+        err = AppendBytes(&writer, txtBytes, numTXTBytes);
+    }
+
+    // The probe is smaller than the response, as it contains fewer records.
+    HAPAssert(!err);
+    return writer.numBytes;
+}
+
+/**
+ * Reads a name and expands compression pointers.
+ *
+ * @param      bytes                Packet.
+ * @param      numBytes             Length of packet.
+ * @param[in,out] offset            Offset of the name. Updated to the offset following the name.
+ * @param[out] nameBytes            Name in uncompressed wire format.
+ * @param[out] numNameBytes         Length of name.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the name is malformed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadName(
+        const uint8_t* bytes,
+        size_t numBytes,
+        size_t* offset,
+        uint8_t nameBytes[_Nonnull kDNSName_MaxBytes],
+        size_t* numNameBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(offset);
+    HAPPrecondition(nameBytes);
+    HAPPrecondition(numNameBytes);
+
+    size_t position = *offset;
+    bool isCompressed = false;
+    size_t numPointers = 0;
+    *numNameBytes = 0;
+    for (;;) {
+        if (position >= numBytes) {
+            return kHAPError_InvalidData;
+        }
+        uint8_t numLabelBytes = bytes[position];
+        if ((numLabelBytes & 0xC0U) == 0xC0U) {
+            if (position + 1 >= numBytes || ++numPointers > kDNSName_MaxBytes / 2) {
+                return kHAPError_InvalidData;
+            }
+            if (!isCompressed) {
+                *offset = position + 2;
+                isCompressed = true;
+            }
+            position = (size_t)(HAPReadBigUInt16(&bytes[position]) & 0x3FFFU);
+            continue;
+        }
+        if (numLabelBytes & 0xC0U) {
+            return kHAPError_InvalidData;
+        }
+        if (numBytes - position < 1 + (size_t) numLabelBytes ||
+            kDNSName_MaxBytes - *numNameBytes < 1 + (size_t) numLabelBytes) {
+            return kHAPError_InvalidData;
+        }
+        HAPRawBufferCopyBytes(&nameBytes[*numNameBytes], &bytes[position], 1 + (size_t) numLabelBytes);
+        *numNameBytes += 1 + (size_t) numLabelBytes;
+        position += 1 + (size_t) numLabelBytes;
+        if (!numLabelBytes) {
+            if (!isCompressed) {
+                *offset = position;
+            }
+            return kHAPError_None;
+        }
+    }
+}
+
+/**
+ * Compares two names in uncompressed wire format. DNS names are case insensitive for ASCII characters.
+ */
+HAP_RESULT_USE_CHECK
+static bool NamesAreEqual(
+        const uint8_t* nameBytes,
+        size_t numNameBytes,
+        const uint8_t* otherNameBytes,
+        size_t numOtherNameBytes) {
+    HAPPrecondition(nameBytes);
+    HAPPrecondition(otherNameBytes);
+
+    if (numNameBytes != numOtherNameBytes) {
+        return false;
+    }
+    for (size_t i = 0; i < numNameBytes; i++) {
+        uint8_t c = nameBytes[i];
+        uint8_t d = otherNameBytes[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = (uint8_t)(c - 'A' + 'a');
+        }
+        if (d >= 'A' && d <= 'Z') {
+            d = (uint8_t)(d - 'A' + 'a');
+        }
+        if (c != d) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Name of the responder in uncompressed wire format.
+ */
+typedef struct {
+    uint8_t bytes[kDNSName_MaxBytes];
+    size_t numBytes;
+} Name;
+
+/**
+ * Reads a name from the response packet of the responder.
+ */
+static void GetName(const HAPPlatformMDNSResponder* responder, size_t offset, Name* name) {
+    HAPPrecondition(responder);
+    HAPPrecondition(name);
+
+    HAPError err;
+
+    err = ReadName(responder->packetBytes, responder->numPacketBytes, &offset, name->bytes, &name->numBytes);
+    HAPAssert(!err);
+}
+
+static void HandleTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context);
+
+/**
+ * Schedules the probe / announcement timer.
+ */
+static void ScheduleTimer(HAPPlatformMDNSResponder* responder, HAPTime delay) {
+    HAPPrecondition(responder);
+    HAPPrecondition(!responder->timer);
+
+    HAPError err;
+
+    err = HAPPlatformTimerRegister(
+            &responder->timer, HAPPlatformClockGetCurrentCoarse() + delay, HandleTimerExpired, responder);
+    if (err) {
+        HAPLogError(&logObject, "Not enough resources to schedule Multicast DNS timer!");
+        HAPFatalError();
+    }
+    HAPAssert(responder->timer);
+}
+
+/**
+ * Cancels pending probes, announcements and responses.
+ */
+static void CancelTimers(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    if (responder->timer) {
+        HAPPlatformTimerDeregister(responder->timer);
+        responder->timer = 0;
+    }
+    if (responder->responseTimer) {
+        HAPPlatformTimerDeregister(responder->responseTimer);
+        responder->responseTimer = 0;
+    }
+    responder->isResponsePending = false;
+}
+
+/**
+ * Multicasts the response packet.
+ */
+static void SendResponse(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    responder->lastMulticastTime = HAPPlatformClockGetCurrentCoarse();
+    responder->sendPacket(responder, responder->packetBytes, responder->numPacketBytes, responder->context);
+}
+
+/**
+ * Starts probing for the service instance and host names.
+ */
+static void StartProbing(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    CancelTimers(responder);
+    responder->state = kHAPPlatformMDNSResponderState_Probing;
+    responder->numProbesSent = 0;
+
+    // Probes are delayed by a random time to avoid collisions with other hosts that start at the same time.
+    HAPTime delay;
+    if (responder->numConflicts > kMaxConflictsBeforeDelay) {
+        delay = kConflictDelay;
+    } else {
+        uint8_t randomValue;
+        HAPPlatformRandomNumberFill(&randomValue, sizeof randomValue);
+        delay = (HAPTime)((randomValue * kProbeInterval) / UINT8_MAX);
+    }
+    ScheduleTimer(responder, delay);
+}
+
+/**
+ * Sends an announcement and schedules the next one.
+ */
+static void Announce(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+    HAPPrecondition(responder->state == kHAPPlatformMDNSResponderState_Announcing);
+    HAPPrecondition(responder->numAnnouncementsPending);
+
+    SendResponse(responder);
+    responder->numAnnouncementsPending--;
+    if (responder->numAnnouncementsPending) {
+        ScheduleTimer(responder, kAnnouncementInterval);
+    } else {
+        responder->state = kHAPPlatformMDNSResponderState_Announced;
+    }
+}
+
+static void HandleTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformMDNSResponder* responder = context;
+    HAPPrecondition(timer == responder->timer);
+    responder->timer = 0;
+
+    switch (responder->state) {
+        case kHAPPlatformMDNSResponderState_Probing: {
+            if (responder->numProbesSent < kNumProbes) {
+                size_t numProbeBytes = SerializeProbe(responder);
+                responder->numProbesSent++;
+                responder->sendPacket(responder, responder->scratchBytes, numProbeBytes, responder->context);
+                ScheduleTimer(responder, kProbeInterval);
+                return;
+            }
+
+            responder->state = kHAPPlatformMDNSResponderState_Announcing;
+            responder->numAnnouncementsPending = kNumAnnouncements;
+            Announce(responder);
+
+            char instanceLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+            GetInstanceLabel(responder, instanceLabel);
+            HAPLogInfo(
+                    &logObject,
+                    "\"%s\" discoverable after %llu ms.",
+                    instanceLabel,
+                    (unsigned long long) (HAPPlatformClockGetCurrentCoarse() - responder->registrationTime));
+            return;
+        }
+        case kHAPPlatformMDNSResponderState_Announcing: {
+            Announce(responder);
+            return;
+        }
+        case kHAPPlatformMDNSResponderState_Idle:
+        case kHAPPlatformMDNSResponderState_Announced: {
+            HAPFatalError();
+        }
+    }
+    HAPFatalError();
+}
+
+static void HandleResponseTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformMDNSResponder* responder = context;
+    HAPPrecondition(timer == responder->responseTimer);
+    responder->responseTimer = 0;
+    HAPPrecondition(responder->isResponsePending);
+    responder->isResponsePending = false;
+
+    SendResponse(responder);
+}
+
+/**
+ * Answers a query, respecting the minimum interval between multicast responses.
+ */
+static void Respond(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    HAPError err;
+
+    if (responder->isResponsePending) {
+        return;
+    }
+
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
+    if (now >= responder->lastMulticastTime + kMinMulticastInterval) {
+        SendResponse(responder);
+        return;
+    }
+
+    err = HAPPlatformTimerRegister(
+            &responder->responseTimer,
+            responder->lastMulticastTime + kMinMulticastInterval,
+            HandleResponseTimerExpired,
+            responder);
+    if (err) {
+        HAPLogError(&logObject, "Not enough resources to schedule Multicast DNS response timer!");
+        HAPFatalError();
+    }
+    responder->isResponsePending = true;
+}
+
+/**
+ * Picks new names after another host claimed the service instance or host name and restarts probing.
+ */
+static void HandleConflict(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    HAPError err;
+
+    char instanceLabel[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    GetInstanceLabel(responder, instanceLabel);
+    HAPLog(&logObject, "Name conflict for \"%s\". Picking a new name.", instanceLabel);
+
+    // Keep the TXT record data.
+    size_t numTXTBytes = responder->numPacketBytes - responder->txtRecordOffset - sizeof(uint16_t);
+    HAPRawBufferCopyBytes(
+            responder->scratchBytes, &responder->packetBytes[responder->txtRecordOffset + sizeof(uint16_t)], numTXTBytes);
+
+    responder->numConflicts++;
+    err = SerializeResponse(responder, responder->scratchBytes, numTXTBytes);
+    if (err) {
+        HAPLogError(&logObject, "Multicast DNS response does not fit into %zu bytes.", sizeof responder->packetBytes);
+        HAPFatalError();
+    }
+    StartProbing(responder);
+}
+
+/**
+ * Determines whether a record of another host conflicts with the records of the responder.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      bytes                Packet.
+ * @param      numBytes             Length of packet.
+ * @param      name                 Record name.
+ * @param      type                 Record type.
+ * @param      rdataOffset          Offset of record data.
+ * @param      numRDataBytes        Length of record data.
+ * @param      instanceName         Service instance name of the responder.
+ * @param      hostName             Host name of the responder.
+ *
+ * @return true                     If the record conflicts.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsConflictingRecord(
+        const HAPPlatformMDNSResponder* responder,
+        const uint8_t* bytes,
+        size_t numBytes,
+        const Name* name,
+        uint16_t type,
+        size_t rdataOffset,
+        size_t numRDataBytes,
+        const Name* instanceName,
+        const Name* hostName) {
+    HAPPrecondition(responder);
+    HAPPrecondition(bytes);
+    HAPPrecondition(name);
+    HAPPrecondition(instanceName);
+    HAPPrecondition(hostName);
+
+    HAPError err;
+
+    if (type == kDNSType_SRV && NamesAreEqual(name->bytes, name->numBytes, instanceName->bytes, instanceName->numBytes)) {
+        if (numRDataBytes < 6 + 1) {
+            return false;
+        }
+        if (HAPReadBigUInt16(&bytes[rdataOffset + 4]) != responder->port) {
+            return true;
+        }
+        Name target;
+        size_t offset = rdataOffset + 6;
+        err = ReadName(bytes, numBytes, &offset, target.bytes, &target.numBytes);
+        if (err) {
+            return false;
+        }
+        return !NamesAreEqual(target.bytes, target.numBytes, hostName->bytes, hostName->numBytes);
+    }
+    if ((type == kDNSType_A || type == kDNSType_AAAA) &&
+        NamesAreEqual(name->bytes, name->numBytes, hostName->bytes, hostName->numBytes)) {
+        HAPIPAddressVersion version = type == kDNSType_A ? kHAPIPAddressVersion_IPv4 : kHAPIPAddressVersion_IPv6;
+        if (numRDataBytes != (type == kDNSType_A ? 4 : 16)) {
+            return false;
+        }
+        for (size_t i = 0; i < responder->numAddresses; i++) {
+            if (responder->addresses[i].version == version &&
+                HAPRawBufferAreEqual(responder->addresses[i].bytes, &bytes[rdataOffset], numRDataBytes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void HAPPlatformMDNSResponderCreate(HAPPlatformMDNSResponder* responder, const HAPPlatformMDNSResponderOptions* options) {
+    HAPPrecondition(responder);
+    HAPPrecondition(options);
+    HAPPrecondition(options->hostName);
+    HAPPrecondition(!options->numAddresses || options->addresses);
+    HAPPrecondition(options->numAddresses <= kHAPPlatformMDNSResponder_MaxAddresses);
+    HAPPrecondition(options->sendPacket);
+
+    HAPLogDebug(&logObject, "Storage configuration: responder = %lu", (unsigned long) sizeof *responder);
+
+    HAPRawBufferZero(responder, sizeof *responder);
+    responder->sendPacket = options->sendPacket;
+    responder->context = options->context;
+    GetLabel(options->hostName, "", responder->hostName);
+    HAPPrecondition(responder->hostName[0]);
+    for (size_t i = 0; i < options->numAddresses; i++) {
+        HAPPrecondition(
+                HAPNonnull(options->addresses)[i].version == kHAPIPAddressVersion_IPv4 ||
+                HAPNonnull(options->addresses)[i].version == kHAPIPAddressVersion_IPv6);
+        responder->addresses[i] = HAPNonnull(options->addresses)[i];
+    }
+    responder->numAddresses = options->numAddresses;
+    responder->state = kHAPPlatformMDNSResponderState_Idle;
+}
+
+void HAPPlatformMDNSResponderRegister(
+        HAPPlatformMDNSResponder* responder,
+        const char* name,
+        const char* protocol,
+        HAPNetworkPort port,
+        const HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords) {
+    HAPPrecondition(responder);
+    HAPPrecondition(responder->state == kHAPPlatformMDNSResponderState_Idle);
+    HAPPrecondition(name);
+    HAPPrecondition(protocol);
+    HAPPrecondition(HAPStringGetNumBytes(protocol) < sizeof responder->protocol);
+    HAPPrecondition(txtRecords);
+
+    HAPError err;
+
+    HAPLogDebug(&logObject, "name: \"%s\"", name);
+    HAPLogDebug(&logObject, "protocol: \"%s\"", protocol);
+    HAPLogDebug(&logObject, "port: %u", port);
+
+    GetLabel(name, "", responder->name);
+    HAPPrecondition(responder->name[0]);
+    HAPRawBufferZero(responder->protocol, sizeof responder->protocol);
+    HAPRawBufferCopyBytes(responder->protocol, protocol, HAPStringGetNumBytes(protocol));
+    responder->port = port;
+    responder->numConflicts = 0;
+    responder->registrationTime = HAPPlatformClockGetCurrentCoarse();
+
+    size_t numTXTBytes;
+    err = SerializeTXTRecords(
+            txtRecords, numTXTRecords, responder->scratchBytes, sizeof responder->scratchBytes, &numTXTBytes);
+    if (!err) {
+        err = SerializeResponse(responder, responder->scratchBytes, numTXTBytes);
+    }
+    if (err) {
+        HAPLogError(&logObject, "Multicast DNS response does not fit into %zu bytes.", sizeof responder->packetBytes);
+        HAPFatalError();
+    }
+    StartProbing(responder);
+}
+
+void HAPPlatformMDNSResponderUpdateTXTRecords(
+        HAPPlatformMDNSResponder* responder,
+        const HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords) {
+    HAPPrecondition(responder);
+    HAPPrecondition(responder->state != kHAPPlatformMDNSResponderState_Idle);
+    HAPPrecondition(txtRecords);
+
+    HAPError err;
+
+    // The TXT record is the last record of the response. Only its data is rewritten.
+    size_t offset = responder->txtRecordOffset + sizeof(uint16_t);
+    size_t numTXTBytes;
+    err = SerializeTXTRecords(
+            txtRecords,
+            numTXTRecords,
+            &responder->packetBytes[offset],
+            sizeof responder->packetBytes - offset,
+            &numTXTBytes);
+    if (err) {
+        HAPLogError(&logObject, "Multicast DNS response does not fit into %zu bytes.", sizeof responder->packetBytes);
+        HAPFatalError();
+    }
+    HAPWriteBigUInt16(&responder->packetBytes[responder->txtRecordOffset], numTXTBytes);
+    responder->numPacketBytes = offset + numTXTBytes;
+
+    // Updated records are announced again (RFC 6762, Section 8.4). Names that are still being probed are announced
+    // once probing completes.
+    if (responder->state != kHAPPlatformMDNSResponderState_Probing) {
+        CancelTimers(responder);
+        responder->state = kHAPPlatformMDNSResponderState_Announcing;
+        responder->numAnnouncementsPending = kNumAnnouncements;
+        Announce(responder);
+    }
+}
+
+void HAPPlatformMDNSResponderStop(HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+    HAPPrecondition(responder->state != kHAPPlatformMDNSResponderState_Idle);
+
+    CancelTimers(responder);
+
+    // Records that may be cached by other hosts are withdrawn with a TTL of 0 (RFC 6762, Section 10.1).
+    if (responder->state != kHAPPlatformMDNSResponderState_Probing) {
+        HAPRawBufferCopyBytes(responder->scratchBytes, responder->packetBytes, responder->numPacketBytes);
+        for (size_t i = 0; i < responder->numTTLOffsets; i++) {
+            HAPWriteBigUInt32(&responder->scratchBytes[responder->ttlOffsets[i]], 0);
+        }
+        responder->sendPacket(responder, responder->scratchBytes, responder->numPacketBytes, responder->context);
+    }
+
+    responder->state = kHAPPlatformMDNSResponderState_Idle;
+}
+
+void HAPPlatformMDNSResponderHandlePacket(HAPPlatformMDNSResponder* responder, const void* bytes_, size_t numBytes) {
+    HAPPrecondition(responder);
+    HAPPrecondition(bytes_);
+    const uint8_t* bytes = bytes_;
+
+    HAPError err;
+
+    if (responder->state == kHAPPlatformMDNSResponderState_Idle || numBytes < kDNSHeader_NumBytes) {
+        return;
+    }
+    uint16_t flags = HAPReadBigUInt16(&bytes[2]);
+    size_t numQuestions = HAPReadBigUInt16(&bytes[4]);
+    size_t numRecords = (size_t) HAPReadBigUInt16(&bytes[6]) + (size_t) HAPReadBigUInt16(&bytes[8]) +
+                        (size_t) HAPReadBigUInt16(&bytes[10]);
+    if (flags & kDNSFlags_Opcode) {
+        return;
+    }
+
+    Name instanceName;
+    GetName(responder, responder->instanceNameOffset, &instanceName);
+    Name hostName;
+    GetName(responder, responder->hostNameOffset, &hostName);
+
+    size_t offset = kDNSHeader_NumBytes;
+    Name name;
+    if (!(flags & kDNSFlags_Response)) {
+        // Names are only answered after they have been claimed by probing.
+        if (responder->state == kHAPPlatformMDNSResponderState_Probing) {
+            return;
+        }
+
+        Name serviceName;
+        GetName(responder, responder->serviceNameOffset, &serviceName);
+        Name metaServiceName;
+        GetName(responder, responder->metaServiceNameOffset, &metaServiceName);
+
+        bool isAnswered = false;
+        for (size_t i = 0; i < numQuestions && !isAnswered; i++) {
+            err = ReadName(bytes, numBytes, &offset, name.bytes, &name.numBytes);
+            if (err || numBytes - offset < 2 * sizeof(uint16_t)) {
+                return;
+            }
+            uint16_t type = HAPReadBigUInt16(&bytes[offset]);
+            uint16_t class_ = (uint16_t)(HAPReadBigUInt16(&bytes[offset + 2]) & ~kDNSClass_CacheFlush);
+            offset += 2 * sizeof(uint16_t);
+            if (class_ != kDNSClass_IN && class_ != kDNSClass_ANY) {
+                continue;
+            }
+
+            if (type == kDNSType_PTR || type == kDNSType_ANY) {
+                isAnswered = isAnswered ||
+                             NamesAreEqual(name.bytes, name.numBytes, serviceName.bytes, serviceName.numBytes) ||
+                             NamesAreEqual(name.bytes, name.numBytes, metaServiceName.bytes, metaServiceName.numBytes);
+            }
+            if (type == kDNSType_SRV || type == kDNSType_TXT || type == kDNSType_ANY) {
+                isAnswered = isAnswered ||
+                             NamesAreEqual(name.bytes, name.numBytes, instanceName.bytes, instanceName.numBytes);
+            }
+            if (type == kDNSType_A || type == kDNSType_AAAA || type == kDNSType_ANY) {
+                isAnswered = isAnswered || NamesAreEqual(name.bytes, name.numBytes, hostName.bytes, hostName.numBytes);
+            }
+        }
+        if (isAnswered) {
+            Respond(responder);
+        }
+        return;
+    }
+
+    // Responses of other hosts may claim the names of the responder (RFC 6762, Section 9).
+    for (size_t i = 0; i < numQuestions; i++) {
+        err = ReadName(bytes, numBytes, &offset, name.bytes, &name.numBytes);
+        if (err || numBytes - offset < 2 * sizeof(uint16_t)) {
+            return;
+        }
+        offset += 2 * sizeof(uint16_t);
+    }
+    for (size_t i = 0; i < numRecords; i++) {
+        err = ReadName(bytes, numBytes, &offset, name.bytes, &name.numBytes);
+        if (err || numBytes - offset < kDNSRecordHeader_NumBytes) {
+            return;
+        }
+        uint16_t type = HAPReadBigUInt16(&bytes[offset]);
+        uint32_t ttl = HAPReadBigUInt32(&bytes[offset + 4]);
+        size_t numRDataBytes = HAPReadBigUInt16(&bytes[offset + 8]);
+        offset += kDNSRecordHeader_NumBytes;
+        if (numBytes - offset < numRDataBytes) {
+            return;
+        }
+        if (ttl &&
+            IsConflictingRecord(
+                    responder, bytes, numBytes, &name, type, offset, numRDataBytes, &instanceName, &hostName)) {
+            HandleConflict(responder);
+            return;
+        }
+        offset += numRDataBytes;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPPlatformMDNSResponderState HAPPlatformMDNSResponderGetState(const HAPPlatformMDNSResponder* responder) {
+    HAPPrecondition(responder);
+
+    return responder->state;
+}
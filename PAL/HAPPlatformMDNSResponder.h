@@ -0,0 +1,274 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_MDNS_RESPONDER_H
+#define HAP_PLATFORM_MDNS_RESPONDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Multicast DNS responder for a single DNS-SD service (RFC 6762, RFC 6763).
+ *
+ * The responder implements the wire format and the probe / announce / respond state machine. It does not perform
+ * any I/O by itself: packets are sent through a callback, and received packets are passed to
+ * HAPPlatformMDNSResponderHandlePacket. Timing is based on the platform timer and clock, so that the responder may be
+ * integrated into the run loop of any platform that lacks a system mDNS service.
+ *
+ * - The response to queries is serialized once when the service is registered. The TXT record is the last record of
+ *   that packet, so that TXT record updates only rewrite the tail of the packet.
+ *
+ * - Simultaneous probe tie-breaking, known-answer suppression and legacy unicast queries are not supported.
+ *
+ * **Example**
+
+   @code{.c}
+
+   static void SendPacket(
+           HAPPlatformMDNSResponder* responder,
+           const void* bytes,
+           size_t numBytes,
+           void* _Nullable context)
+   {
+       // Send bytes to 224.0.0.251:5353.
+   }
+
+   static HAPPlatformMDNSResponder responder;
+   HAPPlatformMDNSResponderCreate(&responder,
+       &(const HAPPlatformMDNSResponderOptions) {
+           .hostName = "raspberrypi",
+           .addresses = addresses,
+           .numAddresses = numAddresses,
+           .sendPacket = SendPacket
+       });
+   HAPPlatformMDNSResponderRegister(&responder, "Acme Light Bulb", "_hap._tcp", port, txtRecords, numTXTRecords);
+
+   // For each packet received from port 5353.
+   HAPPlatformMDNSResponderHandlePacket(&responder, bytes, numBytes);
+
+   @endcode
+ */
+
+/**
+ * UDP port used by Multicast DNS.
+ */
+#define kHAPPlatformMDNSResponder_Port ((HAPNetworkPort) 5353)
+
+/**
+ * Maximum length of a Multicast DNS packet that is sent by the responder.
+ */
+#define kHAPPlatformMDNSResponder_MaxPacketBytes ((size_t) 1024)
+
+/**
+ * Maximum number of IP addresses that are published for the host.
+ */
+#define kHAPPlatformMDNSResponder_MaxAddresses ((size_t) 4)
+
+/**
+ * Maximum length of a DNS label, excluding the length byte.
+ */
+#define kHAPPlatformMDNSResponder_MaxLabelBytes ((size_t) 63)
+
+/**
+ * IP address of the host.
+ */
+typedef struct {
+    /** IP address version. */
+    HAPIPAddressVersion version;
+
+    /** Network byte order. IPv4 addresses only use the first 4 bytes. */
+    uint8_t bytes[16];
+} HAPPlatformMDNSResponderAddress;
+
+typedef struct HAPPlatformMDNSResponder HAPPlatformMDNSResponder;
+
+/**
+ * Callback that is invoked to send a packet to the Multicast DNS group.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      bytes                Packet.
+ * @param      numBytes             Length of packet.
+ * @param      context              The context parameter given to the HAPPlatformMDNSResponderCreate function.
+ */
+typedef void (*HAPPlatformMDNSResponderSendPacketCallback)(
+        HAPPlatformMDNSResponder* responder,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context);
+
+/**
+ * Multicast DNS responder initialization options.
+ */
+typedef struct {
+    /**
+     * Host name without domain. Names longer than a DNS label are truncated.
+     */
+    const char* hostName;
+
+    /**
+     * IP addresses of the host.
+     */
+    const HAPPlatformMDNSResponderAddress* _Nullable addresses;
+
+    /**
+     * Number of IP addresses of the host. At most kHAPPlatformMDNSResponder_MaxAddresses.
+     */
+    size_t numAddresses;
+
+    /**
+     * Callback to send packets.
+     */
+    HAPPlatformMDNSResponderSendPacketCallback sendPacket;
+
+    /**
+     * Context that is passed to the callback.
+     */
+    void* _Nullable context;
+} HAPPlatformMDNSResponderOptions;
+
+/**
+ * State of a Multicast DNS responder.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformMDNSResponderState) {
+    /** No service is registered. */
+    kHAPPlatformMDNSResponderState_Idle,
+
+    /** Probing for the uniqueness of the service and host names. */
+    kHAPPlatformMDNSResponderState_Probing,
+
+    /** Announcing the service. Queries are answered. */
+    kHAPPlatformMDNSResponderState_Announcing,
+
+    /** The service is announced. Queries are answered. */
+    kHAPPlatformMDNSResponderState_Announced
+} HAP_ENUM_END(uint8_t, HAPPlatformMDNSResponderState);
+
+/**
+ * Multicast DNS responder.
+ */
+struct HAPPlatformMDNSResponder {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformMDNSResponderSendPacketCallback sendPacket;
+    void* _Nullable context;
+
+    char hostName[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    HAPPlatformMDNSResponderAddress addresses[kHAPPlatformMDNSResponder_MaxAddresses];
+    size_t numAddresses;
+
+    char name[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    char protocol[2 * (kHAPPlatformMDNSResponder_MaxLabelBytes + 1)];
+    HAPNetworkPort port;
+    unsigned int numConflicts;
+
+    HAPPlatformMDNSResponderState state;
+    uint8_t numProbesSent;
+    uint8_t numAnnouncementsPending;
+    bool isResponsePending;
+    HAPPlatformTimerRef timer;
+    HAPPlatformTimerRef responseTimer;
+    HAPTime registrationTime;
+    HAPTime lastMulticastTime;
+
+    uint8_t packetBytes[kHAPPlatformMDNSResponder_MaxPacketBytes];
+    size_t numPacketBytes;
+    size_t serviceNameOffset;
+    size_t metaServiceNameOffset;
+    size_t instanceNameOffset;
+    size_t hostNameOffset;
+    size_t localNameOffset;
+    size_t txtRecordOffset;
+    size_t ttlOffsets[4 + kHAPPlatformMDNSResponder_MaxAddresses];
+    size_t numTTLOffsets;
+
+    uint8_t scratchBytes[kHAPPlatformMDNSResponder_MaxPacketBytes];
+    /**@endcond */
+};
+
+/**
+ * Initializes a Multicast DNS responder.
+ *
+ * @param[out] responder            Pointer to an allocated but uninitialized HAPPlatformMDNSResponder structure.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformMDNSResponderCreate(HAPPlatformMDNSResponder* responder, const HAPPlatformMDNSResponderOptions* options);
+
+/**
+ * Registers a service. Probing starts immediately, and the service is announced once probing completes.
+ *
+ * - If another host claims the service or host name, a new name is picked and probing restarts.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      name                 Service name.
+ * @param      protocol             Protocol name, e.g. "_hap._tcp".
+ * @param      port                 Port number.
+ * @param      txtRecords           Array of TXT records.
+ * @param      numTXTRecords        Number of TXT records.
+ */
+void HAPPlatformMDNSResponderRegister(
+        HAPPlatformMDNSResponder* responder,
+        const char* name,
+        const char* protocol,
+        HAPNetworkPort port,
+        const HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords);
+
+/**
+ * Updates the TXT records of a registered service and announces them.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      txtRecords           Array of TXT records.
+ * @param      numTXTRecords        Number of TXT records.
+ */
+void HAPPlatformMDNSResponderUpdateTXTRecords(
+        HAPPlatformMDNSResponder* responder,
+        const HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords);
+
+/**
+ * Sends goodbye packets for a registered service and stops responding to queries.
+ *
+ * @param      responder            Multicast DNS responder.
+ */
+void HAPPlatformMDNSResponderStop(HAPPlatformMDNSResponder* responder);
+
+/**
+ * Processes a packet that has been received from UDP port kHAPPlatformMDNSResponder_Port.
+ *
+ * - Malformed packets are ignored.
+ *
+ * @param      responder            Multicast DNS responder.
+ * @param      bytes                Packet.
+ * @param      numBytes             Length of packet.
+ */
+void HAPPlatformMDNSResponderHandlePacket(HAPPlatformMDNSResponder* responder, const void* bytes, size_t numBytes);
+
+/**
+ * Returns the state of a Multicast DNS responder.
+ *
+ * @param      responder            Multicast DNS responder.
+ *
+ * @return State of the responder.
+ */
+HAP_RESULT_USE_CHECK
+HAPPlatformMDNSResponderState HAPPlatformMDNSResponderGetState(const HAPPlatformMDNSResponder* responder);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -84,6 +84,89 @@ HAPError HAPPlatformMFiHWAuthRead(
         void* bytes,
         size_t numBytes);
 
+/**
+ * Completion callback of an asynchronous Apple Authentication Coprocessor transaction.
+ *
+ * - A new transaction may be submitted from within the callback.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      error                kHAPError_None           If successful.
+ *                                  kHAPError_Unknown        If communication with the Apple Authentication
+ *                                                           Coprocessor failed.
+ * @param      context              The context parameter given to the function that submitted the transaction.
+ */
+typedef void (*HAPPlatformMFiHWAuthCompletionCallback)(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        HAPError error,
+        void* _Nullable context);
+
+/**
+ * Writes data to the Apple Authentication Coprocessor without blocking the run loop.
+ *
+ * - While the Apple Authentication Coprocessor is busy, it does not acknowledge transfers. The transfer is retried
+ *   from the run loop until it is acknowledged or the transaction times out.
+ *
+ * - The completion callback is invoked on the run loop. It is never invoked synchronously.
+ *
+ * - At most one asynchronous transaction may be in progress. Synchronous transactions must not be started while an
+ *   asynchronous transaction is in progress.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      bytes                Buffer to write. The buffer is copied.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum 128.
+ * @param      completion           Callback to invoke when the transaction completes.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If an asynchronous transaction is already in progress.
+ * @return kHAPError_OutOfResources If not enough resources are available to start the transaction.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthWriteAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        const void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context);
+
+/**
+ * Reads a register from the Apple Authentication Coprocessor without blocking the run loop.
+ *
+ * - While the Apple Authentication Coprocessor is busy, it does not acknowledge transfers. The transfer is retried
+ *   from the run loop until it is acknowledged or the transaction times out.
+ *
+ * - The completion callback is invoked on the run loop. It is never invoked synchronously.
+ *
+ * - At most one asynchronous transaction may be in progress. Synchronous transactions must not be started while an
+ *   asynchronous transaction is in progress.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      registerAddress      Address of the Apple Authentication Coprocessor register to read.
+ * @param[out] bytes                Result buffer. Must remain valid until the completion callback is invoked.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum 128.
+ * @param      completion           Callback to invoke when the transaction completes.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If an asynchronous transaction is already in progress.
+ * @return kHAPError_OutOfResources If not enough resources are available to start the transaction.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthReadAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context);
+
+/**
+ * Cancels the asynchronous transaction that is in progress, if any. The completion callback is not invoked.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ */
+void HAPPlatformMFiHWAuthCancel(HAPPlatformMFiHWAuthRef mfiHWAuth);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
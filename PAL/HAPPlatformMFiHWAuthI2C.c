@@ -0,0 +1,330 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformMFiHWAuthI2C.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "MFiHWAuth" };
+
+/**
+ * Transaction state.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformMFiHWAuthI2CState) {
+    /** No transaction is in progress. */
+    kHAPPlatformMFiHWAuthI2CState_Idle,
+
+    /** Register address and data are written. */
+    kHAPPlatformMFiHWAuthI2CState_Write,
+
+    /** Register address of a read transaction is written. */
+    kHAPPlatformMFiHWAuthI2CState_SelectRegister,
+
+    /** Register data is read. */
+    kHAPPlatformMFiHWAuthI2CState_Read
+} HAP_ENUM_END(uint8_t, HAPPlatformMFiHWAuthI2CState);
+
+void HAPPlatformMFiHWAuthI2CCreate(HAPPlatformMFiHWAuthI2C* i2c, const HAPPlatformMFiHWAuthI2COptions* options) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(options);
+    HAPPrecondition(options->device.write);
+    HAPPrecondition(options->device.read);
+
+    HAPRawBufferZero(i2c, sizeof *i2c);
+    i2c->device = options->device;
+    i2c->initialRetryDelay =
+            options->initialRetryDelay ? options->initialRetryDelay : kHAPPlatformMFiHWAuthI2C_DefaultInitialRetryDelay;
+    i2c->maxRetryDelay =
+            options->maxRetryDelay ? options->maxRetryDelay : kHAPPlatformMFiHWAuthI2C_DefaultMaxRetryDelay;
+    i2c->timeout = options->timeout ? options->timeout : kHAPPlatformMFiHWAuthI2C_DefaultTimeout;
+    HAPPrecondition(i2c->initialRetryDelay <= i2c->maxRetryDelay);
+}
+
+void HAPPlatformMFiHWAuthI2CRelease(HAPPlatformMFiHWAuthI2C* i2c) {
+    HAPPrecondition(i2c);
+
+    HAPPlatformMFiHWAuthI2CCancel(i2c);
+    HAPRawBufferZero(i2c, sizeof *i2c);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformMFiHWAuthI2CIsBusy(const HAPPlatformMFiHWAuthI2C* i2c) {
+    HAPPrecondition(i2c);
+
+    return i2c->transaction.state != kHAPPlatformMFiHWAuthI2CState_Idle;
+}
+
+/**
+ * Completes the transaction that is in progress.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      error                Result of the transaction.
+ */
+static void CompleteTransaction(HAPPlatformMFiHWAuthI2C* i2c, HAPError error) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(i2c->transaction.completion);
+    HAPPrecondition(!i2c->transaction.timer);
+
+    HAPPlatformMFiHWAuthI2CCompletionCallback completion = HAPNonnull(i2c->transaction.completion);
+    void* _Nullable context = i2c->transaction.context;
+    HAPRawBufferZero(&i2c->transaction, sizeof i2c->transaction);
+    completion(i2c, error, context);
+}
+
+static void TimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthI2C* i2c = context;
+    HAPPrecondition(timer == i2c->transaction.timer);
+    i2c->transaction.timer = 0;
+
+    HAPError err;
+
+    for (;;) {
+        switch ((HAPPlatformMFiHWAuthI2CState) i2c->transaction.state) {
+            case kHAPPlatformMFiHWAuthI2CState_Write:
+            case kHAPPlatformMFiHWAuthI2CState_SelectRegister: {
+                err = i2c->device.write(i2c->device.context, i2c->transaction.bytes, i2c->transaction.numBytes);
+            } break;
+            case kHAPPlatformMFiHWAuthI2CState_Read: {
+                err = i2c->device.read(
+                        i2c->device.context, HAPNonnullVoid(i2c->transaction.readBytes), i2c->transaction.numReadBytes);
+            } break;
+            case kHAPPlatformMFiHWAuthI2CState_Idle:
+            default: HAPFatalError();
+        }
+        if (err) {
+            break;
+        }
+
+        // Transfer has been acknowledged.
+        i2c->transaction.retryDelay = 0;
+        if (i2c->transaction.state != kHAPPlatformMFiHWAuthI2CState_SelectRegister) {
+            CompleteTransaction(i2c, kHAPError_None);
+            return;
+        }
+        i2c->transaction.state = kHAPPlatformMFiHWAuthI2CState_Read;
+    }
+    if (err != kHAPError_Busy) {
+        HAPAssert(err == kHAPError_Unknown);
+        HAPLog(&logObject, "I2C transfer failed.");
+        CompleteTransaction(i2c, kHAPError_Unknown);
+        return;
+    }
+
+    // Transfer has not been acknowledged. Retry with exponential backoff.
+    HAPTime now = HAPPlatformClockGetCurrent();
+    if (now >= i2c->transaction.deadline) {
+        HAPLog(&logObject, "I2C %s timed out.", i2c->transaction.readBytes ? "read" : "write");
+        CompleteTransaction(i2c, kHAPError_Unknown);
+        return;
+    }
+    if (!i2c->transaction.retryDelay) {
+        i2c->transaction.retryDelay = i2c->initialRetryDelay;
+    } else {
+        i2c->transaction.retryDelay = HAPMin(2 * i2c->transaction.retryDelay, i2c->maxRetryDelay);
+    }
+    i2c->numRetries++;
+    err = HAPPlatformTimerRegister(
+            &i2c->transaction.timer,
+            HAPMin(now + i2c->transaction.retryDelay, i2c->transaction.deadline),
+            TimerExpired,
+            i2c);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Not enough resources to schedule I2C retry.");
+        CompleteTransaction(i2c, kHAPError_Unknown);
+        return;
+    }
+}
+
+/**
+ * Starts the transaction that has been prepared.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      completion           Callback to invoke when the transaction completes.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If no timer could be allocated.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError StartTransaction(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        HAPPlatformMFiHWAuthI2CCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(i2c->transaction.state != kHAPPlatformMFiHWAuthI2CState_Idle);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    HAPTime now = HAPPlatformClockGetCurrent();
+    i2c->transaction.completion = completion;
+    i2c->transaction.context = context;
+    i2c->transaction.deadline = now + i2c->timeout;
+    err = HAPPlatformTimerRegister(&i2c->transaction.timer, now, TimerExpired, i2c);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Not enough resources to schedule I2C transaction.");
+        HAPRawBufferZero(&i2c->transaction, sizeof i2c->transaction);
+        return err;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CWriteAsync(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        const void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthI2CCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= kHAPPlatformMFiHWAuthI2C_MaxBytes);
+    HAPPrecondition(completion);
+
+    if (HAPPlatformMFiHWAuthI2CIsBusy(i2c)) {
+        HAPLog(&logObject, "I2C transaction already in progress.");
+        return kHAPError_InvalidState;
+    }
+
+    i2c->transaction.state = kHAPPlatformMFiHWAuthI2CState_Write;
+    HAPRawBufferCopyBytes(i2c->transaction.bytes, bytes, numBytes);
+    i2c->transaction.numBytes = numBytes;
+    return StartTransaction(i2c, completion, context);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CReadAsync(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthI2CCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= kHAPPlatformMFiHWAuthI2C_MaxBytes);
+    HAPPrecondition(completion);
+
+    if (HAPPlatformMFiHWAuthI2CIsBusy(i2c)) {
+        HAPLog(&logObject, "I2C transaction already in progress.");
+        return kHAPError_InvalidState;
+    }
+
+    i2c->transaction.state = kHAPPlatformMFiHWAuthI2CState_SelectRegister;
+    i2c->transaction.bytes[0] = registerAddress;
+    i2c->transaction.numBytes = 1;
+    i2c->transaction.readBytes = bytes;
+    i2c->transaction.numReadBytes = numBytes;
+    return StartTransaction(i2c, completion, context);
+}
+
+/**
+ * Performs a transfer of a synchronous transaction. Transfers that are not acknowledged are retried.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      writeBytes           Bytes to write. NULL for a read transfer.
+ * @param      readBytes            Buffer to fill. NULL for a write transfer.
+ * @param      numBytes             Number of bytes to transfer.
+ * @param[in,out] retryBudget       Remaining delay in microseconds that may be spent waiting for retries.
+ *
+ * @return kHAPError_None           If the transfer has been acknowledged.
+ * @return kHAPError_Unknown        If the transfer failed or the retry budget has been exhausted.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PerformTransfer(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        const void* _Nullable writeBytes,
+        void* _Nullable readBytes,
+        size_t numBytes,
+        uint32_t* retryBudget) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(i2c->device.sleep);
+    HAPPrecondition(!writeBytes != !readBytes);
+    HAPPrecondition(retryBudget);
+
+    HAPError err;
+
+    uint32_t retryDelay = kHAPPlatformMFiHWAuthI2C_SynchronousInitialRetryDelayMicroseconds;
+    for (;;) {
+        if (writeBytes) {
+            err = i2c->device.write(i2c->device.context, HAPNonnullVoid(writeBytes), numBytes);
+        } else {
+            err = i2c->device.read(i2c->device.context, HAPNonnullVoid(readBytes), numBytes);
+        }
+        if (err != kHAPError_Busy) {
+            if (err) {
+                HAPAssert(err == kHAPError_Unknown);
+                HAPLog(&logObject, "I2C transfer failed.");
+            }
+            return err;
+        }
+
+        // Transfer has not been acknowledged. Retry with exponential backoff within the retry budget.
+        if (!*retryBudget) {
+            HAPLog(&logObject, "I2C %s timed out.", readBytes ? "read" : "write");
+            return kHAPError_Unknown;
+        }
+        uint32_t delay = HAPMin(retryDelay, *retryBudget);
+        i2c->numRetries++;
+        HAPNonnull(i2c->device.sleep)(i2c->device.context, delay);
+        *retryBudget -= delay;
+        retryDelay = HAPMin(2 * retryDelay, kHAPPlatformMFiHWAuthI2C_SynchronousMaxRetryDelayMicroseconds);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CWrite(HAPPlatformMFiHWAuthI2C* i2c, const void* bytes, size_t numBytes) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(!HAPPlatformMFiHWAuthI2CIsBusy(i2c));
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= kHAPPlatformMFiHWAuthI2C_MaxBytes);
+
+    uint32_t retryBudget = kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds;
+    return PerformTransfer(i2c, bytes, /* readBytes: */ NULL, numBytes, &retryBudget);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CRead(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(i2c);
+    HAPPrecondition(!HAPPlatformMFiHWAuthI2CIsBusy(i2c));
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= kHAPPlatformMFiHWAuthI2C_MaxBytes);
+
+    HAPError err;
+
+    uint32_t retryBudget = kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds;
+    err = PerformTransfer(i2c, &registerAddress, /* readBytes: */ NULL, sizeof registerAddress, &retryBudget);
+    if (err) {
+        return err;
+    }
+    return PerformTransfer(i2c, /* writeBytes: */ NULL, bytes, numBytes, &retryBudget);
+}
+
+void HAPPlatformMFiHWAuthI2CCancel(HAPPlatformMFiHWAuthI2C* i2c) {
+    HAPPrecondition(i2c);
+
+    if (!HAPPlatformMFiHWAuthI2CIsBusy(i2c)) {
+        return;
+    }
+
+    HAPLogInfo(&logObject, "Cancelling I2C transaction.");
+    if (i2c->transaction.timer) {
+        HAPPlatformTimerDeregister(i2c->transaction.timer);
+    }
+    HAPRawBufferZero(&i2c->transaction, sizeof i2c->transaction);
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthI2CGetNumRetries(const HAPPlatformMFiHWAuthI2C* i2c) {
+    HAPPrecondition(i2c);
+
+    return i2c->numRetries;
+}
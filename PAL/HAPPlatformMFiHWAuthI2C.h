@@ -0,0 +1,372 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_MFI_HW_AUTH_I2C_H
+#define HAP_PLATFORM_MFI_HW_AUTH_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Asynchronous I2C transactions with an Apple Authentication Coprocessor.
+ *
+ * The Apple Authentication Coprocessor does not acknowledge its address while it is busy, for example while it is
+ * generating a signature. Instead of polling the bus in a blocking loop, transfers that are not acknowledged are
+ * retried from a timer on the run loop, with exponential backoff, until they succeed or the transaction times out.
+ *
+ * The transaction engine does not perform any I/O by itself. Transfers are delegated to an I2C device, so that the
+ * same engine may drive an i2c-dev file descriptor or a simulated Apple Authentication Coprocessor.
+ *
+ * - A write transaction consists of a single transfer of the register address followed by the register data.
+ *
+ * - A read transaction consists of a transfer of the register address followed by a read transfer.
+ *
+ * - Completion callbacks are always invoked from a timer on the run loop, never synchronously.
+ *
+ * - At most one transaction may be in progress at a time.
+ *
+ * - Synchronous transactions block the caller between retries and are bounded by a fixed retry budget.
+ *   They require the I2C device to provide a sleep function.
+ *
+ * **Example**
+
+   @code{.c}
+
+   static HAPError DeviceWrite(void* _Nullable context, const void* bytes, size_t numBytes)
+   {
+       // Transfer bytes. Return kHAPError_Busy if the transfer has not been acknowledged.
+   }
+
+   static HAPError DeviceRead(void* _Nullable context, void* bytes, size_t numBytes)
+   {
+       // Transfer bytes. Return kHAPError_Busy if the transfer has not been acknowledged.
+   }
+
+   static void HandleCompletion(HAPPlatformMFiHWAuthI2C* i2c, HAPError error, void* _Nullable context)
+   {
+       // Transaction completed.
+   }
+
+   static HAPPlatformMFiHWAuthI2C i2c;
+   HAPPlatformMFiHWAuthI2CCreate(&i2c,
+       &(const HAPPlatformMFiHWAuthI2COptions) {
+           .device = {
+               .write = DeviceWrite,
+               .read = DeviceRead
+           }
+       });
+
+   static uint8_t bytes[1];
+   HAPError err = HAPPlatformMFiHWAuthI2CReadAsync(&i2c, registerAddress, bytes, sizeof bytes, HandleCompletion, NULL);
+
+   @endcode
+ */
+
+/**
+ * Maximum number of bytes of a single transfer, including the register address.
+ */
+#define kHAPPlatformMFiHWAuthI2C_MaxBytes ((size_t) 128)
+
+/**
+ * Default delay before a transfer that has not been acknowledged is retried for the first time.
+ */
+#define kHAPPlatformMFiHWAuthI2C_DefaultInitialRetryDelay ((HAPTime)(1 * HAPMillisecond))
+
+/**
+ * Default maximum delay between two retries of a transfer.
+ */
+#define kHAPPlatformMFiHWAuthI2C_DefaultMaxRetryDelay ((HAPTime)(32 * HAPMillisecond))
+
+/**
+ * Default maximum duration of a transaction.
+ */
+#define kHAPPlatformMFiHWAuthI2C_DefaultTimeout ((HAPTime)(2 * HAPSecond))
+
+/**
+ * Delay in microseconds before a transfer of a synchronous transaction that has not been acknowledged is retried
+ * for the first time.
+ */
+#define kHAPPlatformMFiHWAuthI2C_SynchronousInitialRetryDelayMicroseconds ((uint32_t) 500)
+
+/**
+ * Maximum delay in microseconds between two retries of a transfer of a synchronous transaction.
+ */
+#define kHAPPlatformMFiHWAuthI2C_SynchronousMaxRetryDelayMicroseconds ((uint32_t) 16000)
+
+/**
+ * Maximum total delay in microseconds between the retries of a synchronous transaction.
+ *
+ * - Synchronous transactions block the caller. This matches the budget of 1000 retries at 500 us that was used
+ *   before retries backed off exponentially.
+ */
+#define kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds ((uint32_t)(1000 * 500))
+
+/**
+ * I2C device through which the Apple Authentication Coprocessor is accessed.
+ */
+typedef struct {
+    /**
+     * Performs a single write transfer.
+     *
+     * @param      context              Device context.
+     * @param      bytes                Bytes to write.
+     * @param      numBytes             Number of bytes to write.
+     *
+     * @return kHAPError_None           If the transfer has been acknowledged.
+     * @return kHAPError_Busy           If the transfer has not been acknowledged and should be retried.
+     * @return kHAPError_Unknown        If the transfer failed permanently.
+     */
+    HAPError (*write)(void* _Nullable context, const void* bytes, size_t numBytes);
+
+    /**
+     * Performs a single read transfer.
+     *
+     * @param      context              Device context.
+     * @param[out] bytes                Buffer to fill.
+     * @param      numBytes             Number of bytes to read.
+     *
+     * @return kHAPError_None           If the transfer has been acknowledged.
+     * @return kHAPError_Busy           If the transfer has not been acknowledged and should be retried.
+     * @return kHAPError_Unknown        If the transfer failed permanently.
+     */
+    HAPError (*read)(void* _Nullable context, void* bytes, size_t numBytes);
+
+    /**
+     * Blocks the caller between two retries of a synchronous transaction.
+     *
+     * - Optional. Required for HAPPlatformMFiHWAuthI2CWrite and HAPPlatformMFiHWAuthI2CRead.
+     *
+     * @param      context              Device context.
+     * @param      microseconds         Duration to block.
+     */
+    void (*_Nullable sleep)(void* _Nullable context, uint32_t microseconds);
+
+    /**
+     * Device context.
+     */
+    void* _Nullable context;
+} HAPPlatformMFiHWAuthI2CDevice;
+
+/**
+ * I2C transaction engine initialization options.
+ */
+typedef struct {
+    /**
+     * I2C device.
+     */
+    HAPPlatformMFiHWAuthI2CDevice device;
+
+    /**
+     * Delay before a transfer that has not been acknowledged is retried for the first time.
+     * The delay is doubled after each further retry, up to the maximum retry delay.
+     *
+     * - If 0, kHAPPlatformMFiHWAuthI2C_DefaultInitialRetryDelay is used.
+     */
+    HAPTime initialRetryDelay;
+
+    /**
+     * Maximum delay between two retries of a transfer.
+     *
+     * - If 0, kHAPPlatformMFiHWAuthI2C_DefaultMaxRetryDelay is used.
+     */
+    HAPTime maxRetryDelay;
+
+    /**
+     * Maximum duration of a transaction, measured from its submission.
+     *
+     * - If 0, kHAPPlatformMFiHWAuthI2C_DefaultTimeout is used.
+     */
+    HAPTime timeout;
+} HAPPlatformMFiHWAuthI2COptions;
+
+typedef struct HAPPlatformMFiHWAuthI2C HAPPlatformMFiHWAuthI2C;
+
+/**
+ * Completion callback of an I2C transaction.
+ *
+ * - A new transaction may be submitted from within the callback.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      error                kHAPError_None           If the transaction succeeded.
+ *                                  kHAPError_Unknown        If the transaction failed or timed out.
+ * @param      context              The context parameter given to the function that submitted the transaction.
+ */
+typedef void (*HAPPlatformMFiHWAuthI2CCompletionCallback)(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        HAPError error,
+        void* _Nullable context);
+
+/**
+ * I2C transaction engine.
+ */
+struct HAPPlatformMFiHWAuthI2C {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformMFiHWAuthI2CDevice device;
+    HAPTime initialRetryDelay;
+    HAPTime maxRetryDelay;
+    HAPTime timeout;
+
+    struct {
+        HAPPlatformMFiHWAuthI2CCompletionCallback _Nullable completion;
+        void* _Nullable context;
+        HAPPlatformTimerRef timer;
+        HAPTime deadline;
+        HAPTime retryDelay;
+        void* _Nullable readBytes;
+        size_t numReadBytes;
+        size_t numBytes;
+        uint8_t bytes[kHAPPlatformMFiHWAuthI2C_MaxBytes];
+        uint8_t state;
+    } transaction;
+
+    size_t numRetries;
+    /**@endcond */
+};
+
+/**
+ * Initializes an I2C transaction engine.
+ *
+ * @param[out] i2c                  Pointer to an allocated but uninitialized HAPPlatformMFiHWAuthI2C structure.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformMFiHWAuthI2CCreate(HAPPlatformMFiHWAuthI2C* i2c, const HAPPlatformMFiHWAuthI2COptions* options);
+
+/**
+ * Deinitializes an I2C transaction engine. A pending transaction is cancelled.
+ *
+ * @param      i2c                  I2C transaction engine.
+ */
+void HAPPlatformMFiHWAuthI2CRelease(HAPPlatformMFiHWAuthI2C* i2c);
+
+/**
+ * Returns whether a transaction is in progress.
+ *
+ * @param      i2c                  I2C transaction engine.
+ *
+ * @return true                     If a transaction is in progress.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformMFiHWAuthI2CIsBusy(const HAPPlatformMFiHWAuthI2C* i2c);
+
+/**
+ * Submits a write transaction. The bytes are copied.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      bytes                Register address followed by the data to write.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum kHAPPlatformMFiHWAuthI2C_MaxBytes.
+ * @param      completion           Callback to invoke when the transaction completes.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If a transaction is already in progress.
+ * @return kHAPError_OutOfResources If no timer could be allocated.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CWriteAsync(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        const void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthI2CCompletionCallback completion,
+        void* _Nullable context);
+
+/**
+ * Submits a read transaction.
+ *
+ * @param      i2c                  I2C transaction engine.
+ * @param      registerAddress      Address of the register to read.
+ * @param[out] bytes                Result buffer. Must remain valid until the completion callback is invoked.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum kHAPPlatformMFiHWAuthI2C_MaxBytes.
+ * @param      completion           Callback to invoke when the transaction completes.
+ * @param      context              Context that is passed to the callback.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If a transaction is already in progress.
+ * @return kHAPError_OutOfResources If no timer could be allocated.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CReadAsync(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthI2CCompletionCallback completion,
+        void* _Nullable context);
+
+/**
+ * Performs a synchronous write transaction.
+ *
+ * - Transfers that are not acknowledged are retried with exponential backoff. The caller is blocked for at most
+ *   kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds in total.
+ *
+ * @param      i2c                  I2C transaction engine. No asynchronous transaction may be in progress.
+ * @param      bytes                Register address followed by the data to write.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum kHAPPlatformMFiHWAuthI2C_MaxBytes.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the transaction failed or timed out.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CWrite(HAPPlatformMFiHWAuthI2C* i2c, const void* bytes, size_t numBytes);
+
+/**
+ * Performs a synchronous read transaction.
+ *
+ * - Transfers that are not acknowledged are retried with exponential backoff. The caller is blocked for at most
+ *   kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds in total, including the selection of the register.
+ *
+ * @param      i2c                  I2C transaction engine. No asynchronous transaction may be in progress.
+ * @param      registerAddress      Address of the register to read.
+ * @param[out] bytes                Result buffer.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum kHAPPlatformMFiHWAuthI2C_MaxBytes.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the transaction failed or timed out.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthI2CRead(
+        HAPPlatformMFiHWAuthI2C* i2c,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes);
+
+/**
+ * Cancels the transaction that is in progress, if any. The completion callback is not invoked.
+ *
+ * - If a transfer of the transaction has already been acknowledged, the register address of the device may have
+ *   changed. Subsequent read transactions select their register again, so no further action is necessary.
+ *
+ * @param      i2c                  I2C transaction engine.
+ */
+void HAPPlatformMFiHWAuthI2CCancel(HAPPlatformMFiHWAuthI2C* i2c);
+
+/**
+ * Returns the number of transfers that have been retried because they were not acknowledged.
+ *
+ * @param      i2c                  I2C transaction engine.
+ *
+ * @return Number of retried transfers.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthI2CGetNumRetries(const HAPPlatformMFiHWAuthI2C* i2c);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformRandomNumberDRBG.h"
+
+/**
+ * Length of a ChaCha20 block.
+ */
+#define kChaCha20_BlockBytes ((size_t) 64)
+
+HAP_STATIC_ASSERT(
+        kHAPPlatformRandomNumberDRBG_BufferBytes % kChaCha20_BlockBytes == 0,
+        kHAPPlatformRandomNumberDRBG_BufferBytes_MultipleOfBlock);
+
+#define ROTL32(x, n) ((uint32_t)(((x) << (n)) | ((x) >> (32 - (n)))))
+
+#define QUARTERROUND(a, b, c, d) \
+    do { \
+        (a) += (b); \
+        (d) = ROTL32((d) ^ (a), 16); \
+        (c) += (d); \
+        (b) = ROTL32((b) ^ (c), 12); \
+        (a) += (b); \
+        (d) = ROTL32((d) ^ (a), 8); \
+        (c) += (d); \
+        (b) = ROTL32((b) ^ (c), 7); \
+    } while (0)
+
+/**
+ * Computes a ChaCha20 block with an all-zero nonce.
+ *
+ * @param[out] block                Keystream block.
+ * @param      key                  Key.
+ * @param      counter              Block counter.
+ *
+ * @see ChaCha20 and Poly1305 for IETF Protocols
+ *      https://tools.ietf.org/html/rfc8439#section-2.3
+ */
+static void ChaCha20Block(
+        uint8_t block[_Nonnull kChaCha20_BlockBytes],
+        const uint8_t key[_Nonnull kHAPPlatformRandomNumberDRBG_SeedBytes],
+        uint32_t counter) {
+    uint32_t input[16];
+    input[0] = 0x61707865;
+    input[1] = 0x3320646e;
+    input[2] = 0x79622d32;
+    input[3] = 0x6b206574;
+    for (size_t i = 0; i < 8; i++) {
+        input[4 + i] = HAPReadLittleUInt32(&key[4 * i]);
+    }
+    input[12] = counter;
+    input[13] = 0;
+    input[14] = 0;
+    input[15] = 0;
+
+    uint32_t x[16];
+    HAPRawBufferCopyBytes(x, input, sizeof x);
+    for (size_t i = 0; i < 10; i++) {
+        QUARTERROUND(x[0], x[4], x[8], x[12]);
+        QUARTERROUND(x[1], x[5], x[9], x[13]);
+        QUARTERROUND(x[2], x[6], x[10], x[14]);
+        QUARTERROUND(x[3], x[7], x[11], x[15]);
+        QUARTERROUND(x[0], x[5], x[10], x[15]);
+        QUARTERROUND(x[1], x[6], x[11], x[12]);
+        QUARTERROUND(x[2], x[7], x[8], x[13]);
+        QUARTERROUND(x[3], x[4], x[9], x[14]);
+    }
+    for (size_t i = 0; i < 16; i++) {
+        HAPWriteLittleUInt32(&block[4 * i], x[i] + input[i]);
+    }
+
+    HAPRawBufferZero(input, sizeof input);
+    HAPRawBufferZero(x, sizeof x);
+}
+
+/**
+ * Expands the key into a new buffer of keystream and replaces the key with the first bytes of the buffer.
+ *
+ * @param      drbg                 DRBG.
+ */
+static void Refill(HAPPlatformRandomNumberDRBG* drbg) {
+    HAPPrecondition(drbg);
+
+    for (size_t i = 0; i < kHAPPlatformRandomNumberDRBG_BufferBytes / kChaCha20_BlockBytes; i++) {
+        ChaCha20Block(&drbg->bytes[i * kChaCha20_BlockBytes], drbg->key, (uint32_t) i);
+    }
+    HAPRawBufferCopyBytes(drbg->key, drbg->bytes, sizeof drbg->key);
+    HAPRawBufferZero(drbg->bytes, sizeof drbg->key);
+    drbg->numBytes = sizeof drbg->bytes - sizeof drbg->key;
+}
+
+void HAPPlatformRandomNumberDRBGCreate(HAPPlatformRandomNumberDRBG* drbg) {
+    HAPPrecondition(drbg);
+
+    HAPRawBufferZero(drbg, sizeof *drbg);
+}
+
+bool HAPPlatformRandomNumberDRBGNeedsReseed(const HAPPlatformRandomNumberDRBG* drbg) {
+    HAPPrecondition(drbg);
+
+    return !drbg->isSeeded || drbg->numBytesSinceReseed >= kHAPPlatformRandomNumberDRBG_ReseedIntervalBytes;
+}
+
+void HAPPlatformRandomNumberDRBGReseed(
+        HAPPlatformRandomNumberDRBG* drbg,
+        const uint8_t seed[_Nonnull kHAPPlatformRandomNumberDRBG_SeedBytes]) {
+    HAPPrecondition(drbg);
+    HAPPrecondition(seed);
+
+    for (size_t i = 0; i < sizeof drbg->key; i++) {
+        drbg->key[i] ^= seed[i];
+    }
+    HAPRawBufferZero(drbg->bytes, sizeof drbg->bytes);
+    drbg->numBytes = 0;
+    drbg->numBytesSinceReseed = 0;
+    drbg->isSeeded = true;
+}
+
+void HAPPlatformRandomNumberDRBGInvalidate(HAPPlatformRandomNumberDRBG* drbg) {
+    HAPPrecondition(drbg);
+
+    HAPRawBufferZero(drbg, sizeof *drbg);
+}
+
+void HAPPlatformRandomNumberDRBGFill(HAPPlatformRandomNumberDRBG* drbg, void* bytes, size_t numBytes) {
+    HAPPrecondition(drbg);
+    HAPPrecondition(!HAPPlatformRandomNumberDRBGNeedsReseed(drbg));
+    HAPPrecondition(bytes);
+
+    uint8_t* b = bytes;
+    size_t o = 0;
+    while (o < numBytes) {
+        if (!drbg->numBytes) {
+            Refill(drbg);
+        }
+        size_t c = numBytes - o;
+        if (c > drbg->numBytes) {
+            c = drbg->numBytes;
+        }
+
+        // Serve the buffer front to back and wipe the served bytes.
+        uint8_t* keystream = &drbg->bytes[sizeof drbg->bytes - drbg->numBytes];
+        HAPRawBufferCopyBytes(&b[o], keystream, c);
+        HAPRawBufferZero(keystream, c);
+        drbg->numBytes -= c;
+        o += c;
+    }
+    drbg->numBytesSinceReseed += numBytes;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_RANDOM_NUMBER_DRBG_H
+#define HAP_PLATFORM_RANDOM_NUMBER_DRBG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * ChaCha20 based deterministic random bit generator (DRBG) for random number generators whose entropy source is
+ * expensive to query, e.g., because every query is a system call.
+ *
+ * - The DRBG is seeded from the platform entropy source and then expands its key into a buffer of ChaCha20 keystream.
+ *   Requests are served from that buffer. The first bytes of each new buffer replace the key, and served bytes are
+ *   wiped immediately, so a later compromise of the state does not reveal earlier output ("fast key erasure").
+ *
+ * - After kHAPPlatformRandomNumberDRBG_ReseedIntervalBytes bytes of output the DRBG must be reseeded.
+ *   Reseeding mixes the new seed into the existing key.
+ *
+ * - The DRBG is not thread-safe and does not detect process forks. The platform random number generator must
+ *   serialize access and call HAPPlatformRandomNumberDRBGInvalidate in the child process after a fork, so that
+ *   parent and child do not produce the same output.
+ *
+ * @see Fast-key-erasure random-number generators
+ *      https://blog.cr.yp.to/20170723-random.html
+ *
+ * @see ChaCha20 and Poly1305 for IETF Protocols
+ *      https://tools.ietf.org/html/rfc8439
+ */
+
+/**
+ * Length of a seed.
+ */
+#define kHAPPlatformRandomNumberDRBG_SeedBytes ((size_t) 32)
+
+/**
+ * Number of bytes of keystream that are generated at once.
+ */
+#define kHAPPlatformRandomNumberDRBG_BufferBytes ((size_t) 512)
+
+/**
+ * Number of bytes that may be generated before the DRBG must be reseeded.
+ */
+#define kHAPPlatformRandomNumberDRBG_ReseedIntervalBytes ((size_t) 1024 * 1024)
+
+/**
+ * ChaCha20 DRBG.
+ */
+typedef struct {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    uint8_t key[kHAPPlatformRandomNumberDRBG_SeedBytes];
+    uint8_t bytes[kHAPPlatformRandomNumberDRBG_BufferBytes];
+    size_t numBytes;
+    size_t numBytesSinceReseed;
+    bool isSeeded;
+    /**@endcond */
+} HAPPlatformRandomNumberDRBG;
+
+/**
+ * Initializes a DRBG. The DRBG must be seeded before it is used.
+ *
+ * @param[out] drbg                 DRBG.
+ */
+void HAPPlatformRandomNumberDRBGCreate(HAPPlatformRandomNumberDRBG* drbg);
+
+/**
+ * Returns whether a DRBG must be (re-)seeded before more output is generated.
+ *
+ * @param      drbg                 DRBG.
+ *
+ * @return true                     If the DRBG must be seeded.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformRandomNumberDRBGNeedsReseed(const HAPPlatformRandomNumberDRBG* drbg);
+
+/**
+ * Mixes a seed from the platform entropy source into a DRBG.
+ *
+ * - Buffered keystream is discarded.
+ *
+ * @param      drbg                 DRBG.
+ * @param      seed                 Seed.
+ */
+void HAPPlatformRandomNumberDRBGReseed(
+        HAPPlatformRandomNumberDRBG* drbg,
+        const uint8_t seed[_Nonnull kHAPPlatformRandomNumberDRBG_SeedBytes]);
+
+/**
+ * Wipes the state of a DRBG. The DRBG must be seeded again before it is used.
+ *
+ * @param      drbg                 DRBG.
+ */
+void HAPPlatformRandomNumberDRBGInvalidate(HAPPlatformRandomNumberDRBG* drbg);
+
+/**
+ * Fills a buffer with output of a DRBG.
+ *
+ * - The DRBG must be seeded and HAPPlatformRandomNumberDRBGNeedsReseed must return false.
+ *
+ * @param      drbg                 DRBG.
+ * @param[out] bytes                Buffer to fill with random bytes.
+ * @param      numBytes             Length of buffer.
+ */
+void HAPPlatformRandomNumberDRBGFill(HAPPlatformRandomNumberDRBG* drbg, void* bytes, size_t numBytes);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
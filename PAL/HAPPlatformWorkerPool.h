@@ -0,0 +1,90 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_WORKER_POOL_H
+#define HAP_PLATFORM_WORKER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Worker pool to run CPU-intensive computations off the run loop.
+ *
+ * - A job consists of a work callback that is invoked on a worker thread, and a completion callback that is invoked
+ *   on the run loop once the work callback has returned.
+ *
+ * - The work callback must not call into the accessory server or into other platform modules. It may only access the
+ *   job context and invoke thread-safe functions such as those of HAPCrypto.h.
+ */
+
+/**
+ * Maximum length of a job context.
+ */
+#define kHAPPlatformWorkerPool_MaxContextBytes ((size_t) 1280)
+
+/**
+ * Worker pool.
+ */
+typedef struct HAPPlatformWorkerPool HAPPlatformWorkerPool;
+typedef struct HAPPlatformWorkerPool* HAPPlatformWorkerPoolRef;
+HAP_NONNULL_SUPPORT(HAPPlatformWorkerPool)
+
+/**
+ * Callback that is invoked on a worker thread to perform the work of a job.
+ *
+ * @param      context              Job context. Owned by the worker pool until the completion callback returns.
+ * @param      contextSize          Length of job context.
+ */
+typedef void (*HAPPlatformWorkerPoolWorkCallback)(void* context, size_t contextSize);
+
+/**
+ * Callback that is invoked on the run loop after the work of a job has been performed.
+ *
+ * @param      context              Job context, as modified by the work callback.
+ * @param      contextSize          Length of job context.
+ */
+typedef void (*HAPPlatformWorkerPoolCompletionCallback)(void* context, size_t contextSize);
+
+/**
+ * Submits a job to a worker pool.
+ *
+ * - The job context is copied into storage of the worker pool and is suitably aligned for any type.
+ *
+ * - The completion callback is never invoked synchronously.
+ *
+ * @param      workerPool           Worker pool.
+ * @param      work                 Callback to invoke on a worker thread.
+ * @param      completion           Callback to invoke on the run loop after the work has been performed.
+ * @param      context              Job context.
+ * @param      contextSize          Length of job context. At most kHAPPlatformWorkerPool_MaxContextBytes.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If all job slots of the worker pool are in use.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformWorkerPoolSubmit(
+        HAPPlatformWorkerPoolRef workerPool,
+        HAPPlatformWorkerPoolWorkCallback work,
+        HAPPlatformWorkerPoolCompletionCallback completion,
+        const void* context,
+        size_t contextSize);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
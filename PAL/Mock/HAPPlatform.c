@@ -41,7 +41,7 @@ const char* HAPPlatformGetBuild(void) {
 /**
  * Number of attributes to allow BLE peripheral manager to use.
  */
-#define kHAPPlatform_NumBLEPeripheralManagerAttributes ((size_t) 100)
+#define kHAPPlatform_NumBLEPeripheralManagerAttributes ((size_t) 500)
 
 static HAPPlatformKeyValueStore keyValueStore;
 static HAPPlatformAccessorySetup accessorySetup;
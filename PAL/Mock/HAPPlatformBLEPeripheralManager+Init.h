@@ -12,47 +12,12 @@ extern "C" {
 #endif
 
 #include "HAPPlatform.h"
+#include "HAPPlatformBLEPeripheralManagerATT.h"
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull begin
 #endif
 
-typedef struct {
-    HAPPlatformBLEPeripheralManagerUUID type;
-    bool isPrimary;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
-} HAPPlatformBLEPeripheralManagerService;
-
-typedef struct {
-    HAPPlatformBLEPeripheralManagerUUID type;
-    HAPPlatformBLEPeripheralManagerCharacteristicProperties properties;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
-    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;
-    HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandle;
-} HAPPlatformBLEPeripheralManagerCharacteristic;
-
-typedef struct {
-    HAPPlatformBLEPeripheralManagerUUID type;
-    HAPPlatformBLEPeripheralManagerDescriptorProperties properties;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle;
-} HAPPlatformBLEPeripheralManagerDescriptor;
-
-HAP_ENUM_BEGIN(uint8_t, HAPPlatformBLEPeripheralManagerAttributeType) {
-    kHAPPlatformBLEPeripheralManagerAttributeType_None,
-    kHAPPlatformBLEPeripheralManagerAttributeType_Service,
-    kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic,
-    kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor
-} HAP_ENUM_END(uint8_t, HAPPlatformBLEPeripheralManagerAttributeType);
-
-typedef struct {
-    HAPPlatformBLEPeripheralManagerAttributeType type;
-    union {
-        HAPPlatformBLEPeripheralManagerDescriptor descriptor;
-        HAPPlatformBLEPeripheralManagerCharacteristic characteristic;
-        HAPPlatformBLEPeripheralManagerService service;
-    } _;
-} HAPPlatformBLEPeripheralManagerAttribute;
-
 /**
  * BLE peripheral manager initialization options.
  */
@@ -80,9 +45,24 @@ struct HAPPlatformBLEPeripheralManager {
     uint8_t numScanResponseBytes;
     HAPBLEAdvertisingInterval advertisingInterval;
 
+    size_t numHandleValueIndications;
+
+    /** ATT server for the simulated central. */
+    HAPPlatformBLEPeripheralManagerATTServer attServer;
+
+    /** ATT PDUs that have not yet been read by the simulated central. */
+    struct {
+        uint8_t bytes[4][kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+        size_t numBytes[4];
+        size_t startIndex;
+        size_t count;
+    } centralQueue;
+
+    /** Timer that disconnects the simulated central after HAPPlatformBLEPeripheralManagerCancelCentralConnection. */
+    HAPPlatformTimerRef disconnectTimer;
+
     bool isDeviceAddressSet : 1;
     bool didPublishAttributes : 1;
-    bool isConnected : 1;
     /**@endcond */
 };
 
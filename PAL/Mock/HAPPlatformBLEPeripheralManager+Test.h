@@ -66,6 +66,87 @@ HAPError HAPPlatformBLEPeripheralManagerGetAdvertisingData(
         size_t maxScanResponseBytes,
         size_t* numScanResponseBytes);
 
+/**
+ * Returns the number of Handle Value Indications that have been sent.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ *
+ * @return Number of Handle Value Indications that have been sent.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager);
+
+/**
+ * Connects a simulated central that exchanges ATT PDUs with the BLE peripheral manager.
+ *
+ * - The central starts with the default ATT_MTU of 23 bytes.
+ *
+ * - Once connected, Handle Value Indications are delivered to the central and must be confirmed by it.
+ *
+ * @param      blePeripheralManager BLE peripheral manager. Services must have been published.
+ * @param      connectionHandle     Connection handle of the central.
+ */
+void HAPPlatformBLEPeripheralManagerConnectCentral(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle);
+
+/**
+ * Disconnects the simulated central.
+ *
+ * @param      blePeripheralManager BLE peripheral manager. A central must be connected.
+ */
+void HAPPlatformBLEPeripheralManagerCentralDisconnect(HAPPlatformBLEPeripheralManagerRef blePeripheralManager);
+
+/**
+ * Returns whether a simulated central is connected.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ *
+ * @return true                     If a simulated central is connected.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerIsCentralConnected(HAPPlatformBLEPeripheralManagerRef blePeripheralManager);
+
+/**
+ * Sends an ATT PDU from the simulated central to the BLE peripheral manager.
+ *
+ * - The PDU is processed synchronously. Responses are queued for HAPPlatformBLEPeripheralManagerCentralRead.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      bytes                ATT PDU.
+ * @param      numBytes             Length of ATT PDU.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no simulated central is connected.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralWrite(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const void* bytes,
+        size_t numBytes);
+
+/**
+ * Receives the next ATT PDU that the BLE peripheral manager sent to the simulated central.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param[out] bytes                Buffer that receives the ATT PDU.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of ATT PDU.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no simulated central is connected.
+ * @return kHAPError_Busy           If no ATT PDU is available.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralRead(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
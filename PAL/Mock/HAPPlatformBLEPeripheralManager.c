@@ -9,6 +9,29 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "BLEPeripheralManager" };
 
+static void EnqueueCentralPDU(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+    HAPPrecondition(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPPrecondition(attServer == &blePeripheralManager->attServer);
+
+    size_t maxPDUs = HAPArrayCount(blePeripheralManager->centralQueue.bytes);
+    if (blePeripheralManager->centralQueue.count == maxPDUs) {
+        HAPLogError(&logObject, "Simulated central does not read ATT PDUs (%zu PDUs pending).", maxPDUs);
+        HAPFatalError();
+    }
+    size_t i = (blePeripheralManager->centralQueue.startIndex + blePeripheralManager->centralQueue.count) % maxPDUs;
+    HAPAssert(numBytes <= sizeof blePeripheralManager->centralQueue.bytes[i]);
+    HAPRawBufferCopyBytes(blePeripheralManager->centralQueue.bytes[i], bytes, numBytes);
+    blePeripheralManager->centralQueue.numBytes[i] = numBytes;
+    blePeripheralManager->centralQueue.count++;
+}
+
 void HAPPlatformBLEPeripheralManagerCreate(
         HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
         const HAPPlatformBLEPeripheralManagerOptions* _Nonnull options) {
@@ -22,6 +45,16 @@ void HAPPlatformBLEPeripheralManagerCreate(
     HAPRawBufferZero(blePeripheralManager, sizeof *blePeripheralManager);
     blePeripheralManager->attributes = options->attributes;
     blePeripheralManager->numAttributes = options->numAttributes;
+
+    HAPPlatformBLEPeripheralManagerATTServerCreate(
+            &blePeripheralManager->attServer,
+            &(const HAPPlatformBLEPeripheralManagerATTServerOptions) {
+                    .blePeripheralManager = blePeripheralManager,
+                    .attributes = options->attributes,
+                    .numAttributes = options->numAttributes,
+                    .delegate = &blePeripheralManager->delegate,
+                    .sendPDU = EnqueueCentralPDU,
+                    .context = blePeripheralManager });
 }
 
 void HAPPlatformBLEPeripheralManagerSetDelegate(
@@ -40,7 +73,7 @@ void HAPPlatformBLEPeripheralManagerSetDeviceAddress(
         HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
         const HAPPlatformBLEPeripheralManagerDeviceAddress* _Nonnull deviceAddress) {
     HAPPrecondition(blePeripheralManager);
-    HAPPrecondition(!blePeripheralManager->isConnected);
+    HAPPrecondition(!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
     HAPPrecondition(deviceAddress);
 
     blePeripheralManager->deviceAddress = *deviceAddress;
@@ -63,7 +96,7 @@ void HAPPlatformBLEPeripheralManagerSetDeviceName(
 void HAPPlatformBLEPeripheralManagerRemoveAllServices(
         HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
     HAPPrecondition(blePeripheralManager);
-    HAPPrecondition(!blePeripheralManager->isConnected);
+    HAPPrecondition(!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
 
     HAPAssert(blePeripheralManager->numAttributes <= SIZE_MAX / sizeof blePeripheralManager->attributes[0]);
     HAPRawBufferZero(
@@ -81,60 +114,8 @@ HAPError HAPPlatformBLEPeripheralManagerAddService(
     HAPPrecondition(!blePeripheralManager->didPublishAttributes);
     HAPPrecondition(type);
 
-    bool inService = false;
-    bool inCharacteristic = false;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle = 0;
-    for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
-        HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
-
-        switch (attribute->type) {
-            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
-                HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 1;
-                if (handle >= (HAPPlatformBLEPeripheralManagerAttributeHandle)(-1 - numNeededHandles)) {
-                    HAPLog(&logObject, "Not enough resources to add GATT service (GATT database is full).");
-                    return kHAPError_OutOfResources;
-                }
-
-                HAPRawBufferZero(attribute, sizeof *attribute);
-                attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Service;
-                attribute->_.service.type = *type;
-                attribute->_.service.isPrimary = isPrimary;
-                attribute->_.service.handle = ++handle;
-            }
-                return kHAPError_None;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
-                inService = true;
-                inCharacteristic = false;
-
-                HAPAssert(attribute->_.service.handle == handle + 1);
-                handle = attribute->_.service.handle;
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
-                HAPAssert(inService);
-                inCharacteristic = true;
-
-                HAPAssert(attribute->_.characteristic.handle == handle + 1);
-                handle = attribute->_.characteristic.handle;
-                HAPAssert(attribute->_.characteristic.valueHandle == handle + 1);
-                handle = attribute->_.characteristic.valueHandle;
-
-                if (attribute->_.characteristic.cccDescriptorHandle) {
-                    HAPAssert(attribute->_.characteristic.cccDescriptorHandle == handle + 1);
-                    handle = attribute->_.characteristic.cccDescriptorHandle;
-                }
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
-                HAPAssert(inCharacteristic);
-
-                HAPAssert(attribute->_.descriptor.handle == handle + 1);
-                handle = attribute->_.descriptor.handle;
-            } break;
-        }
-    }
-    HAPLog(&logObject,
-           "Not enough resources to add GATT service (have space for %zu GATT attributes).",
-           blePeripheralManager->numAttributes);
-    return kHAPError_OutOfResources;
+    return HAPPlatformBLEPeripheralManagerATTAddService(
+            blePeripheralManager->attributes, blePeripheralManager->numAttributes, type, isPrimary);
 }
 
 HAP_RESULT_USE_CHECK
@@ -150,80 +131,14 @@ HAPError HAPPlatformBLEPeripheralManagerAddCharacteristic(
     HAPPrecondition(!blePeripheralManager->didPublishAttributes);
     HAPPrecondition(type);
     HAPPrecondition(valueHandle);
-    if (properties.notify || properties.indicate) {
-        HAPPrecondition(cccDescriptorHandle);
-    } else {
-        HAPPrecondition(!cccDescriptorHandle);
-    }
 
-    bool inService = false;
-    bool inCharacteristic = false;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle = 0;
-    for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
-        HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
-
-        switch (attribute->type) {
-            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
-                HAPPrecondition(inService);
-
-                HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 2;
-                if (properties.indicate || properties.notify) {
-                    numNeededHandles++;
-                }
-                if (handle >= (HAPPlatformBLEPeripheralManagerAttributeHandle)(-1 - numNeededHandles)) {
-                    HAPLog(&logObject, "Not enough resources to add GATT characteristic (GATT database is full).");
-                    return kHAPError_OutOfResources;
-                }
-
-                HAPRawBufferZero(attribute, sizeof *attribute);
-                attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic;
-                attribute->_.characteristic.type = *type;
-                attribute->_.characteristic.properties = properties;
-                attribute->_.characteristic.handle = ++handle;
-                attribute->_.characteristic.valueHandle = ++handle;
-                if (properties.indicate || properties.notify) {
-                    attribute->_.characteristic.cccDescriptorHandle = ++handle;
-                }
-
-                *valueHandle = attribute->_.characteristic.valueHandle;
-                if (cccDescriptorHandle) {
-                    *cccDescriptorHandle = attribute->_.characteristic.cccDescriptorHandle;
-                }
-            }
-                return kHAPError_None;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
-                inService = true;
-                inCharacteristic = false;
-
-                HAPAssert(attribute->_.service.handle == handle + 1);
-                handle = attribute->_.service.handle;
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
-                HAPAssert(inService);
-                inCharacteristic = true;
-
-                HAPAssert(attribute->_.characteristic.handle == handle + 1);
-                handle = attribute->_.characteristic.handle;
-                HAPAssert(attribute->_.characteristic.valueHandle == handle + 1);
-                handle = attribute->_.characteristic.valueHandle;
-
-                if (attribute->_.characteristic.cccDescriptorHandle) {
-                    HAPAssert(attribute->_.characteristic.cccDescriptorHandle == handle + 1);
-                    handle = attribute->_.characteristic.cccDescriptorHandle;
-                }
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
-                HAPAssert(inCharacteristic);
-
-                HAPAssert(attribute->_.descriptor.handle == handle + 1);
-                handle = attribute->_.descriptor.handle;
-            } break;
-        }
-    }
-    HAPLog(&logObject,
-           "Not enough resources to add GATT characteristic (have space for %zu GATT attributes).",
-           blePeripheralManager->numAttributes);
-    return kHAPError_OutOfResources;
+    return HAPPlatformBLEPeripheralManagerATTAddCharacteristic(
+            blePeripheralManager->attributes,
+            blePeripheralManager->numAttributes,
+            type,
+            properties,
+            valueHandle,
+            cccDescriptorHandle);
 }
 
 HAP_RESULT_USE_CHECK
@@ -239,64 +154,12 @@ HAPError HAPPlatformBLEPeripheralManagerAddDescriptor(
     HAPPrecondition(type);
     HAPPrecondition(descriptorHandle);
 
-    bool inService = false;
-    bool inCharacteristic = false;
-    HAPPlatformBLEPeripheralManagerAttributeHandle handle = 0;
-    for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
-        HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
-
-        switch (attribute->type) {
-            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
-                HAPPrecondition(inCharacteristic);
-
-                HAPPlatformBLEPeripheralManagerAttributeHandle numNeededHandles = 1;
-                if (handle >= (HAPPlatformBLEPeripheralManagerAttributeHandle)(-1 - numNeededHandles)) {
-                    HAPLog(&logObject, "Not enough resources to add GATT descriptor (GATT database is full).");
-                    return kHAPError_OutOfResources;
-                }
-
-                HAPRawBufferZero(attribute, sizeof *attribute);
-                attribute->type = kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor;
-                attribute->_.descriptor.type = *type;
-                attribute->_.descriptor.properties = properties;
-                attribute->_.descriptor.handle = ++handle;
-
-                *descriptorHandle = attribute->_.descriptor.handle;
-            }
-                return kHAPError_None;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
-                inService = true;
-                inCharacteristic = false;
-
-                HAPAssert(attribute->_.service.handle == handle + 1);
-                handle = attribute->_.service.handle;
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
-                HAPAssert(inService);
-                inCharacteristic = true;
-
-                HAPAssert(attribute->_.characteristic.handle == handle + 1);
-                handle = attribute->_.characteristic.handle;
-                HAPAssert(attribute->_.characteristic.valueHandle == handle + 1);
-                handle = attribute->_.characteristic.valueHandle;
-
-                if (attribute->_.characteristic.cccDescriptorHandle) {
-                    HAPAssert(attribute->_.characteristic.cccDescriptorHandle == handle + 1);
-                    handle = attribute->_.characteristic.cccDescriptorHandle;
-                }
-            } break;
-            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
-                HAPAssert(inCharacteristic);
-
-                HAPAssert(attribute->_.descriptor.handle == handle + 1);
-                handle = attribute->_.descriptor.handle;
-            } break;
-        }
-    }
-    HAPLog(&logObject,
-           "Not enough resources to add GATT descriptor (have space for %zu GATT attributes).",
-           blePeripheralManager->numAttributes);
-    return kHAPError_OutOfResources;
+    return HAPPlatformBLEPeripheralManagerATTAddDescriptor(
+            blePeripheralManager->attributes,
+            blePeripheralManager->numAttributes,
+            type,
+            properties,
+            descriptorHandle);
 }
 
 void HAPPlatformBLEPeripheralManagerPublishServices(HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
@@ -409,14 +272,45 @@ HAPError HAPPlatformBLEPeripheralManagerGetAdvertisingData(
     return kHAPError_None;
 }
 
+static void DisconnectTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPPrecondition(timer == blePeripheralManager->disconnectTimer);
+    blePeripheralManager->disconnectTimer = 0;
+
+    if (HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        HAPPlatformBLEPeripheralManagerCentralDisconnect(blePeripheralManager);
+    }
+}
+
 void HAPPlatformBLEPeripheralManagerCancelCentralConnection(
         HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
         HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
     HAPPrecondition(blePeripheralManager);
 
-    (void) connectionHandle;
-    HAPLogError(&logObject, "[NYI] %s.", __func__);
-    HAPFatalError();
+    if (!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        (void) connectionHandle;
+        HAPLogError(&logObject, "[NYI] %s.", __func__);
+        HAPFatalError();
+    }
+    HAPPrecondition(
+            connectionHandle ==
+            HAPPlatformBLEPeripheralManagerATTServerGetConnectionHandle(&blePeripheralManager->attServer));
+
+    // Disconnect asynchronously so that the delegate is not re-entered.
+    if (blePeripheralManager->disconnectTimer) {
+        return;
+    }
+    HAPError err = HAPPlatformTimerRegister(
+            &blePeripheralManager->disconnectTimer,
+            /* deadline: */ 0,
+            DisconnectTimerExpired,
+            blePeripheralManager);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&logObject, "Not enough resources to schedule disconnect.");
+        HAPFatalError();
+    }
 }
 
 HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
@@ -428,8 +322,104 @@ HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
     HAPPrecondition(blePeripheralManager);
     HAPPrecondition(valueHandle);
     HAPPrecondition(!numBytes || bytes);
+    HAPPrecondition(blePeripheralManager->didPublishAttributes);
+
+    HAPLogDebug(&logObject, "%s(0x%04x, 0x%04x).", __func__, connectionHandle, valueHandle);
+    if (HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        HAPError err = HAPPlatformBLEPeripheralManagerATTServerSendHandleValueIndication(
+                &blePeripheralManager->attServer, valueHandle, bytes, numBytes);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidState);
+            return err;
+        }
+    }
+    blePeripheralManager->numHandleValueIndications++;
+    return kHAPError_None;
+}
 
-    (void) connectionHandle;
-    HAPLogError(&logObject, "[NYI] %s.", __func__);
-    HAPFatalError();
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    return blePeripheralManager->numHandleValueIndications;
+}
+
+void HAPPlatformBLEPeripheralManagerConnectCentral(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->didPublishAttributes);
+    HAPPrecondition(!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
+
+    HAPRawBufferZero(&blePeripheralManager->centralQueue, sizeof blePeripheralManager->centralQueue);
+    HAPPlatformBLEPeripheralManagerATTServerConnect(&blePeripheralManager->attServer, connectionHandle);
+}
+
+void HAPPlatformBLEPeripheralManagerCentralDisconnect(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
+
+    if (blePeripheralManager->disconnectTimer) {
+        HAPPlatformTimerDeregister(blePeripheralManager->disconnectTimer);
+        blePeripheralManager->disconnectTimer = 0;
+    }
+    HAPPlatformBLEPeripheralManagerATTServerDisconnect(&blePeripheralManager->attServer);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerIsCentralConnected(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    return HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralWrite(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        const void* _Nonnull bytes,
+        size_t numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes <= kHAPPlatformBLEPeripheralManagerATT_MaxMTU);
+
+    if (!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        return kHAPError_InvalidState;
+    }
+
+    uint8_t pduBytes[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+    HAPRawBufferCopyBytes(pduBytes, bytes, numBytes);
+    HAPPlatformBLEPeripheralManagerATTServerHandlePDU(&blePeripheralManager->attServer, pduBytes, numBytes);
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralRead(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        void* _Nonnull bytes,
+        size_t maxBytes,
+        size_t* _Nonnull numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    if (!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        return kHAPError_InvalidState;
+    }
+    if (!blePeripheralManager->centralQueue.count) {
+        return kHAPError_Busy;
+    }
+
+    size_t i = blePeripheralManager->centralQueue.startIndex;
+    if (maxBytes < blePeripheralManager->centralQueue.numBytes[i]) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(
+            bytes, blePeripheralManager->centralQueue.bytes[i], blePeripheralManager->centralQueue.numBytes[i]);
+    *numBytes = blePeripheralManager->centralQueue.numBytes[i];
+    blePeripheralManager->centralQueue.startIndex = (i + 1) % HAPArrayCount(blePeripheralManager->centralQueue.bytes);
+    blePeripheralManager->centralQueue.count--;
+    return kHAPError_None;
 }
@@ -24,6 +24,17 @@ extern "C" {
  */
 void HAPPlatformClockAdvance(HAPTime delta);
 
+/**
+ * Returns the number of times the clock has been read with HAPPlatformClockGetCurrent.
+ *
+ * - On platforms that read a hardware or system clock, each read may be a system call.
+ *   Reads through HAPPlatformClockGetCurrentCoarse are not counted.
+ *
+ * @return Number of clock reads.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformClockGetNumReads(void);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
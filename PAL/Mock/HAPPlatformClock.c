@@ -12,7 +12,12 @@ static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem,
 
 static HAPTime now;
 
+/** Number of times the clock has been read with HAPPlatformClockGetCurrent. */
+static size_t numReads;
+
 HAPTime HAPPlatformClockGetCurrent(void) {
+    numReads++;
+
     // Check for overflow.
     if (now & (1ull << 63)) {
         HAPLog(&logObject, "Time overflowed (capped at 2^63 - 1).");
@@ -21,6 +26,15 @@ HAPTime HAPPlatformClockGetCurrent(void) {
     return now;
 }
 
+HAPTime HAPPlatformClockGetCurrentCoarse(void) {
+    // The simulated clock only changes in HAPPlatformClockAdvance, so the coarse clock is always up to date.
+    return now;
+}
+
+size_t HAPPlatformClockGetNumReads(void) {
+    return numReads;
+}
+
 void HAPPlatformClockAdvance(HAPTime delta) {
     now += delta;
     HAPLogInfo(
@@ -80,6 +80,8 @@ struct HAPPlatformKeyValueStore {
     /**@cond */
     HAPPlatformKeyValueStoreItem* bytes;
     size_t maxBytes;
+    size_t numReads;
+    size_t numWrites;
     /**@endcond */
 };
 
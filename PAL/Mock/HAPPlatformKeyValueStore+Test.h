@@ -0,0 +1,52 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_KEY_VALUE_STORE_TEST_H
+#define HAP_PLATFORM_KEY_VALUE_STORE_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Returns the number of read operations that have been performed on the key-value store.
+ *
+ * - Get and Enumerate operations are counted as reads.
+ *
+ * @param      keyValueStore        Key-value store.
+ *
+ * @return Number of read operations.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformKeyValueStoreGetNumReads(HAPPlatformKeyValueStoreRef keyValueStore);
+
+/**
+ * Returns the number of write operations that have been performed on the key-value store.
+ *
+ * - Set, Remove and PurgeDomain operations are counted as writes.
+ *
+ * @param      keyValueStore        Key-value store.
+ *
+ * @return Number of write operations.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformKeyValueStoreGetNumWrites(HAPPlatformKeyValueStoreRef keyValueStore);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
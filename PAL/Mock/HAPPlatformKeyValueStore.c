@@ -5,6 +5,7 @@
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
 #include "HAPPlatformKeyValueStore+Init.h"
+#include "HAPPlatformKeyValueStore+Test.h"
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "KeyValueStore" };
 
@@ -17,6 +18,8 @@ void HAPPlatformKeyValueStoreCreate(
 
     keyValueStore->bytes = options->items;
     keyValueStore->maxBytes = options->numItems;
+    keyValueStore->numReads = 0;
+    keyValueStore->numWrites = 0;
     HAPRawBufferZero(keyValueStore->bytes, sizeof keyValueStore->bytes[0] * keyValueStore->maxBytes);
 }
 
@@ -34,6 +37,7 @@ HAPError HAPPlatformKeyValueStoreGet(
     HAPPrecondition((bytes == NULL) == (numBytes == NULL));
     HAPPrecondition(found);
 
+    keyValueStore->numReads++;
     *found = false;
     for (size_t i = 0; i < keyValueStore->maxBytes; i++) {
         if (!keyValueStore->bytes[i].active) {
@@ -70,6 +74,7 @@ HAPError HAPPlatformKeyValueStoreSet(
     HAPPrecondition(bytes);
 
     HAPLogBufferDebug(&logObject, bytes, numBytes, "Write %02X.%02X", domain, key);
+    keyValueStore->numWrites++;
 
     size_t index = 0;
     bool found = false;
@@ -123,6 +128,7 @@ HAPError HAPPlatformKeyValueStoreRemove(
         HAPPlatformKeyValueStoreKey key) {
     HAPPrecondition(keyValueStore);
 
+    keyValueStore->numWrites++;
     for (size_t i = 0; i < keyValueStore->maxBytes; i++) {
         if (!keyValueStore->bytes[i].active) {
             continue;
@@ -147,6 +153,7 @@ HAPError HAPPlatformKeyValueStoreEnumerate(
 
     HAPError err;
 
+    keyValueStore->numReads++;
     bool cont = true;
     for (size_t i = 0; cont && i < keyValueStore->maxBytes; i++) {
         if (!keyValueStore->bytes[i].active) {
@@ -172,6 +179,7 @@ HAPError HAPPlatformKeyValueStorePurgeDomain(
         HAPPlatformKeyValueStoreDomain domain) {
     HAPPrecondition(keyValueStore);
 
+    keyValueStore->numWrites++;
     for (size_t i = 0; i < keyValueStore->maxBytes; i++) {
         if (!keyValueStore->bytes[i].active) {
             continue;
@@ -183,3 +191,17 @@ HAPError HAPPlatformKeyValueStorePurgeDomain(
     }
     return kHAPError_None;
 }
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformKeyValueStoreGetNumReads(HAPPlatformKeyValueStoreRef keyValueStore) {
+    HAPPrecondition(keyValueStore);
+
+    return keyValueStore->numReads;
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformKeyValueStoreGetNumWrites(HAPPlatformKeyValueStoreRef keyValueStore) {
+    HAPPrecondition(keyValueStore);
+
+    return keyValueStore->numWrites;
+}
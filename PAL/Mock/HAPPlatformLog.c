@@ -44,7 +44,7 @@ void HAPPlatformLogCapture(
     }
 
     // Time.
-    HAPTime now = HAPPlatformClockGetCurrent();
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
     (void) fprintf(
             stderr, "%8llu.%03llu", (unsigned long long) (now / HAPSecond), (unsigned long long) (now % HAPSecond));
     (void) fprintf(stderr, "\t");
@@ -12,11 +12,23 @@ extern "C" {
 #endif
 
 #include "HAPPlatform.h"
+#include "HAPPlatformMFiHWAuthI2C.h"
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull begin
 #endif
 
+/**@file
+ * Simulated Apple Authentication Coprocessor.
+ *
+ * The simulated Apple Authentication Coprocessor reports Authentication Protocol Version 3.0 and supports the
+ * registers that are used for self-tests and for creating signatures. Signatures are not valid ECDSA signatures.
+ *
+ * Synchronous and asynchronous transactions are performed through an I2C transaction engine
+ * (see HAPPlatformMFiHWAuthI2C.h) on a simulated I2C bus, so that the behaviour while the Apple Authentication
+ * Coprocessor does not acknowledge transfers may be tested. See HAPPlatformMFiHWAuth+Test.h.
+ */
+
 /**
  * Apple Authentication Coprocessor provider.
  */
@@ -24,6 +36,20 @@ struct HAPPlatformMFiHWAuth {
     // Opaque type. Do not access the instance fields directly.
     /**@cond */
     bool poweredOn;
+
+    HAPPlatformMFiHWAuthI2C i2c;
+    HAPPlatformMFiHWAuthCompletionCallback _Nullable completion;
+    void* _Nullable context;
+
+    uint8_t registerAddress;
+    uint8_t challengeBytes[32];
+    uint8_t authenticationStatus;
+    HAPTime nakDuration;
+    HAPTime busyUntil;
+    size_t numNAKs;
+    uint64_t numStallMicroseconds;
+    uint32_t numPendingStallMicroseconds;
+    size_t numRegisterAccesses;
     /**@endcond */
 };
 
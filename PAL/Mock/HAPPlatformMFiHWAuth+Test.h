@@ -0,0 +1,86 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_MFI_HW_AUTH_TEST_H
+#define HAP_PLATFORM_MFI_HW_AUTH_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Sets the duration for which the simulated Apple Authentication Coprocessor does not acknowledge transfers after
+ * each register write, modelling the time that it takes to process the write.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      nakDuration          Duration after a register write during which transfers are not acknowledged.
+ */
+void HAPPlatformMFiHWAuthSetNAKDuration(HAPPlatformMFiHWAuthRef mfiHWAuth, HAPTime nakDuration);
+
+/**
+ * Returns the number of transfers that the simulated Apple Authentication Coprocessor did not acknowledge.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ *
+ * @return Number of transfers that were not acknowledged.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthGetNumNAKs(HAPPlatformMFiHWAuthRef mfiHWAuth);
+
+/**
+ * Returns the total duration for which synchronous transactions would have blocked the run loop while waiting for the
+ * simulated Apple Authentication Coprocessor to acknowledge transfers.
+ *
+ * - Synchronous transactions do not advance the clock. The delays between their retries are accumulated instead,
+ *   and the simulated Apple Authentication Coprocessor makes progress during these delays.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ *
+ * @return Accumulated stall duration.
+ */
+HAP_RESULT_USE_CHECK
+HAPTime HAPPlatformMFiHWAuthGetStallDuration(HAPPlatformMFiHWAuthRef mfiHWAuth);
+
+/**
+ * Returns the number of register reads and writes that the simulated Apple Authentication Coprocessor has processed.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ *
+ * @return Number of register accesses.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthGetNumRegisterAccesses(HAPPlatformMFiHWAuthRef mfiHWAuth);
+
+/**
+ * Length of the accessory certificate of the simulated Apple Authentication Coprocessor.
+ */
+#define kHAPPlatformMFiHWAuth_NumCertificateBytes ((size_t) 608)
+
+/**
+ * Returns the value of a byte of the accessory certificate of the simulated Apple Authentication Coprocessor.
+ *
+ * @param      index                Byte index. Must be less than kHAPPlatformMFiHWAuth_NumCertificateBytes.
+ *
+ * @return Certificate byte.
+ */
+HAP_RESULT_USE_CHECK
+uint8_t HAPPlatformMFiHWAuthGetCertificateByte(size_t index);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
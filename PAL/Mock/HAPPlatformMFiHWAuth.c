@@ -6,17 +6,71 @@
 
 #include "HAP+Internal.h"
 #include "HAPPlatformMFiHWAuth+Init.h"
+#include "HAPPlatformMFiHWAuth+Test.h"
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "MFiHWAuth" };
 
+/**
+ * Length of a simulated challenge response.
+ */
+#define kHAPPlatformMFiHWAuth_NumChallengeResponseBytes ((size_t) SHA512_BYTES)
+
+static HAPError DeviceWrite(void* _Nullable context, const void* bytes, size_t numBytes);
+static HAPError DeviceRead(void* _Nullable context, void* bytes, size_t numBytes);
+static void DeviceSleep(void* _Nullable context, uint32_t microseconds);
+
 void HAPPlatformMFiHWAuthCreate(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
 
     HAPRawBufferZero(mfiHWAuth, sizeof *mfiHWAuth);
+    HAPPlatformMFiHWAuthI2CCreate(
+            &mfiHWAuth->i2c,
+            &(const HAPPlatformMFiHWAuthI2COptions) {
+                    .device = {
+                            .write = DeviceWrite, .read = DeviceRead, .sleep = DeviceSleep, .context = mfiHWAuth } });
 }
 
 void HAPPlatformMFiHWAuthRelease(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
+
+    HAPPlatformMFiHWAuthI2CRelease(&mfiHWAuth->i2c);
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
+}
+
+void HAPPlatformMFiHWAuthSetNAKDuration(HAPPlatformMFiHWAuthRef mfiHWAuth, HAPTime nakDuration) {
+    HAPPrecondition(mfiHWAuth);
+
+    mfiHWAuth->nakDuration = nakDuration;
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthGetNumNAKs(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return mfiHWAuth->numNAKs;
+}
+
+HAP_RESULT_USE_CHECK
+HAPTime HAPPlatformMFiHWAuthGetStallDuration(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return (HAPTime)(mfiHWAuth->numStallMicroseconds / 1000);
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformMFiHWAuthGetNumRegisterAccesses(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return mfiHWAuth->numRegisterAccesses;
+}
+
+HAP_RESULT_USE_CHECK
+uint8_t HAPPlatformMFiHWAuthGetCertificateByte(size_t index) {
+    HAPPrecondition(index < kHAPPlatformMFiHWAuth_NumCertificateBytes);
+
+    // Fake certificate.
+    return (uint8_t)(index * 7 + 3);
 }
 
 HAP_RESULT_USE_CHECK
@@ -40,30 +94,67 @@ void HAPPlatformMFiHWAuthPowerOff(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     mfiHWAuth->poweredOn = false;
 }
 
+/**
+ * Writes a register of the simulated Apple Authentication Coprocessor.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      bytes                Register address followed by the data to write.
+ * @param      numBytes             Length of buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the register is not supported.
+ */
 HAP_RESULT_USE_CHECK
-HAPError HAPPlatformMFiHWAuthWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
+static HAPError WriteRegister(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
     HAPPrecondition(mfiHWAuth);
     HAPPrecondition(bytes);
-    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(numBytes >= 2 && numBytes <= 128);
 
     const uint8_t* b = bytes;
     HAPLogBufferDebug(&logObject, &b[1], numBytes - 1, "MFi > %02x", b[0]);
+    mfiHWAuth->numRegisterAccesses++;
     switch (b[0]) {
+        case kHAPMFiHWAuthRegister_AuthenticationControlAndStatus: {
+            HAPPrecondition(numBytes == 2);
+            if (b[1] != 1) {
+                HAPLog(&logObject, "Unsupported authentication control: 0x%02x.", b[1]);
+                return kHAPError_Unknown;
+            }
+            // Challenge response successfully generated.
+            mfiHWAuth->authenticationStatus = 1 << 4;
+        } break;
+        case kHAPMFiHWAuthRegister_ChallengeData: {
+            HAPPrecondition(numBytes == 1 + sizeof mfiHWAuth->challengeBytes);
+            HAPRawBufferCopyBytes(mfiHWAuth->challengeBytes, &b[1], sizeof mfiHWAuth->challengeBytes);
+            mfiHWAuth->authenticationStatus = 0;
+        } break;
         case kHAPMFiHWAuthRegister_SelfTestStatus: {
             if (b[1] & 1) {
                 HAPLogInfo(&logObject, "Run X.509 certificate and private key tests.");
             }
-            return kHAPError_None;
-        }
+        } break;
         default: {
             HAPLog(&logObject, "Unknown register.");
             return kHAPError_Unknown;
         }
     }
+    mfiHWAuth->busyUntil = HAPPlatformClockGetCurrent() + mfiHWAuth->nakDuration;
+    return kHAPError_None;
 }
 
+/**
+ * Reads a register of the simulated Apple Authentication Coprocessor.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      registerAddress      Address of the register to read.
+ * @param[out] bytes                Result buffer.
+ * @param      numBytes             Length of buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the register is not supported.
+ */
 HAP_RESULT_USE_CHECK
-HAPError HAPPlatformMFiHWAuthRead(
+static HAPError ReadRegister(
         HAPPlatformMFiHWAuthRef mfiHWAuth,
         uint8_t registerAddress,
         void* bytes,
@@ -74,7 +165,32 @@ HAPError HAPPlatformMFiHWAuthRead(
 
     uint8_t* b = bytes;
     size_t o = 0;
+    mfiHWAuth->numRegisterAccesses++;
     switch (registerAddress) {
+        case kHAPMFiHWAuthRegister_AuthenticationControlAndStatus: {
+            HAPPrecondition(numBytes == 1);
+            b[o++] = mfiHWAuth->authenticationStatus;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_ChallengeResponseDataLength: {
+            HAPPrecondition(numBytes == 2);
+            HAPWriteBigUInt16(&b[o], kHAPPlatformMFiHWAuth_NumChallengeResponseBytes);
+            o += 2;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_ChallengeResponseData: {
+            HAPPrecondition(numBytes == kHAPPlatformMFiHWAuth_NumChallengeResponseBytes);
+            // Fake signature.
+            HAP_sha512(b, mfiHWAuth->challengeBytes, sizeof mfiHWAuth->challengeBytes);
+            o += SHA512_BYTES;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
         case kHAPMFiHWAuthRegister_DeviceVersion: {
             HAPPrecondition(numBytes == 1);
             b[o++] = kHAPMFiHWAuthDeviceVersion_3_0;
@@ -103,6 +219,28 @@ HAPError HAPPlatformMFiHWAuthRead(
             HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
             return kHAPError_None;
         }
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataLength: {
+            HAPPrecondition(numBytes == 2);
+            HAPWriteBigUInt16(&b[o], kHAPPlatformMFiHWAuth_NumCertificateBytes);
+            o += 2;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart2:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart3:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart4:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart5: {
+            size_t offset = (size_t)(registerAddress - kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1) * 128;
+            HAPPrecondition(offset + numBytes <= kHAPPlatformMFiHWAuth_NumCertificateBytes);
+            for (; o < numBytes; o++) {
+                b[o] = HAPPlatformMFiHWAuthGetCertificateByte(offset + o);
+            }
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
         case kHAPMFiHWAuthRegister_ErrorCode: {
             HAPPrecondition(numBytes == 1);
             b[o++] = kHAPMFiHWAuthError_NoError;
@@ -124,3 +262,174 @@ HAPError HAPPlatformMFiHWAuthRead(
         }
     }
 }
+
+/**
+ * Returns whether the simulated Apple Authentication Coprocessor is still processing a register write.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ *
+ * @return true                     If transfers are not acknowledged.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsBusy(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    return HAPPlatformClockGetCurrent() < mfiHWAuth->busyUntil;
+}
+
+/**
+ * Models the time that passes while a synchronous transaction blocks between two retries.
+ *
+ * - The clock is not advanced. The simulated Apple Authentication Coprocessor makes progress instead.
+ */
+static void DeviceSleep(void* _Nullable context, uint32_t microseconds) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+
+    mfiHWAuth->numStallMicroseconds += microseconds;
+    mfiHWAuth->numPendingStallMicroseconds += microseconds;
+    HAPTime elapsed = (HAPTime)(mfiHWAuth->numPendingStallMicroseconds / 1000);
+    mfiHWAuth->numPendingStallMicroseconds %= 1000;
+    mfiHWAuth->busyUntil = mfiHWAuth->busyUntil > elapsed ? mfiHWAuth->busyUntil - elapsed : 0;
+}
+
+static HAPError DeviceWrite(void* _Nullable context, const void* bytes, size_t numBytes) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    if (IsBusy(mfiHWAuth)) {
+        mfiHWAuth->numNAKs++;
+        return kHAPError_Busy;
+    }
+
+    if (numBytes == 1) {
+        mfiHWAuth->registerAddress = ((const uint8_t*) bytes)[0];
+        return kHAPError_None;
+    }
+    err = WriteRegister(mfiHWAuth, bytes, numBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    return kHAPError_None;
+}
+
+static HAPError DeviceRead(void* _Nullable context, void* bytes, size_t numBytes) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    if (IsBusy(mfiHWAuth)) {
+        mfiHWAuth->numNAKs++;
+        return kHAPError_Busy;
+    }
+
+    err = ReadRegister(mfiHWAuth, mfiHWAuth->registerAddress, bytes, numBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(!HAPPlatformMFiHWAuthI2CIsBusy(&mfiHWAuth->i2c));
+
+    return HAPPlatformMFiHWAuthI2CWrite(&mfiHWAuth->i2c, bytes, numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthRead(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(!HAPPlatformMFiHWAuthI2CIsBusy(&mfiHWAuth->i2c));
+
+    return HAPPlatformMFiHWAuthI2CRead(&mfiHWAuth->i2c, registerAddress, bytes, numBytes);
+}
+
+static void HandleTransactionCompleted(HAPPlatformMFiHWAuthI2C* i2c, HAPError error, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(i2c == &mfiHWAuth->i2c);
+    HAPPrecondition(mfiHWAuth->completion);
+
+    HAPPlatformMFiHWAuthCompletionCallback completion = HAPNonnull(mfiHWAuth->completion);
+    void* _Nullable completionContext = mfiHWAuth->context;
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
+    completion(mfiHWAuth, error, completionContext);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthWriteAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        const void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    err = HAPPlatformMFiHWAuthI2CWriteAsync(&mfiHWAuth->i2c, bytes, numBytes, HandleTransactionCompleted, mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
+    }
+    mfiHWAuth->completion = completion;
+    mfiHWAuth->context = context;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthReadAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    err = HAPPlatformMFiHWAuthI2CReadAsync(
+            &mfiHWAuth->i2c, registerAddress, bytes, numBytes, HandleTransactionCompleted, mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
+    }
+    mfiHWAuth->completion = completion;
+    mfiHWAuth->context = context;
+    return kHAPError_None;
+}
+
+void HAPPlatformMFiHWAuthCancel(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
+
+    HAPPlatformMFiHWAuthI2CCancel(&mfiHWAuth->i2c);
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
+}
@@ -88,6 +88,7 @@ HAPError HAPPlatformTCPStreamManagerConnectToListener(
 
         // Open connection.
         HAPLogInfo(&logObject, "Opened connection: %p.", (const void*) stream);
+        stream->tcpStreamManager = tcpStreamManager;
         stream->isActive = true;
         stream->rx.maxBytes = tcpStreamManager->numBufferBytes;
         stream->rx.bytes = calloc(1, stream->rx.maxBytes);
@@ -278,7 +279,7 @@ HAPError HAPPlatformTCPStreamRead(
             tcpStream->rx.numBytes - *numBytes);
     tcpStream->rx.numBytes -= *numBytes;
 
-    if (!*numBytes && !tcpStream->rx.isClosed) {
+    if (!*numBytes && !tcpStream->rx.isClientClosed) {
         return kHAPError_Busy;
     }
     return kHAPError_None;
@@ -9,7 +9,7 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "Timer" };
 
-#define kTimerStorage_MaxTimers ((size_t) 32)
+#define kTimerStorage_MaxTimers ((size_t) 256)
 
 typedef struct {
     /**
@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_WORKER_POOL_INIT_H
+#define HAP_PLATFORM_WORKER_POOL_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Deterministic worker pool mock.
+ *
+ * - Submitted jobs are queued. They are only performed when HAPPlatformWorkerPoolRunPendingJobs is called.
+ */
+
+/**
+ * Maximum number of pending jobs.
+ */
+#define kHAPPlatformWorkerPool_MaxJobs ((size_t) 4)
+
+/**
+ * Worker pool.
+ */
+struct HAPPlatformWorkerPool {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    struct {
+        HAPPlatformWorkerPoolWorkCallback work;
+        HAPPlatformWorkerPoolCompletionCallback completion;
+        size_t contextSize;
+        union {
+            uint64_t alignment;
+            void* _Nullable pointerAlignment;
+            uint8_t bytes[kHAPPlatformWorkerPool_MaxContextBytes];
+        } context;
+    } jobs[kHAPPlatformWorkerPool_MaxJobs];
+    size_t numJobs;
+    /**@endcond */
+};
+
+/**
+ * Initializes a worker pool.
+ *
+ * @param[out] workerPool           Pointer to an allocated but uninitialized HAPPlatformWorkerPool structure.
+ */
+void HAPPlatformWorkerPoolCreate(HAPPlatformWorkerPoolRef workerPool);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_WORKER_POOL_TEST_H
+#define HAP_PLATFORM_WORKER_POOL_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Returns the number of jobs that have been submitted but not yet performed.
+ *
+ * @param      workerPool           Worker pool.
+ *
+ * @return Number of pending jobs.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformWorkerPoolGetNumPendingJobs(HAPPlatformWorkerPoolRef workerPool);
+
+/**
+ * Performs all pending jobs in submission order and invokes their completion callbacks.
+ *
+ * - Jobs that are submitted by completion callbacks are performed as well.
+ *
+ * @param      workerPool           Worker pool.
+ */
+void HAPPlatformWorkerPoolRunPendingJobs(HAPPlatformWorkerPoolRef workerPool);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
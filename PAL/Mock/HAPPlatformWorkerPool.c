@@ -0,0 +1,75 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatformWorkerPool+Init.h"
+#include "HAPPlatformWorkerPool+Test.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "WorkerPool" };
+
+void HAPPlatformWorkerPoolCreate(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    HAPRawBufferZero(workerPool, sizeof *workerPool);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformWorkerPoolSubmit(
+        HAPPlatformWorkerPoolRef workerPool,
+        HAPPlatformWorkerPoolWorkCallback work,
+        HAPPlatformWorkerPoolCompletionCallback completion,
+        const void* context,
+        size_t contextSize) {
+    HAPPrecondition(workerPool);
+    HAPPrecondition(work);
+    HAPPrecondition(completion);
+    HAPPrecondition(context);
+    HAPPrecondition(contextSize <= kHAPPlatformWorkerPool_MaxContextBytes);
+
+    if (workerPool->numJobs == HAPArrayCount(workerPool->jobs)) {
+        HAPLog(&logObject, "No free job slot available.");
+        return kHAPError_OutOfResources;
+    }
+
+    HAPLogDebug(&logObject, "Submitting job (%zu bytes).", contextSize);
+    workerPool->jobs[workerPool->numJobs].work = work;
+    workerPool->jobs[workerPool->numJobs].completion = completion;
+    workerPool->jobs[workerPool->numJobs].contextSize = contextSize;
+    HAPRawBufferCopyBytes(workerPool->jobs[workerPool->numJobs].context.bytes, context, contextSize);
+    workerPool->numJobs++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPPlatformWorkerPoolGetNumPendingJobs(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    return workerPool->numJobs;
+}
+
+void HAPPlatformWorkerPoolRunPendingJobs(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    while (workerPool->numJobs) {
+        // Dequeue the oldest job so that its completion callback may submit new jobs.
+        HAPPlatformWorkerPoolWorkCallback work = workerPool->jobs[0].work;
+        HAPPlatformWorkerPoolCompletionCallback completion = workerPool->jobs[0].completion;
+        size_t contextSize = workerPool->jobs[0].contextSize;
+        static union {
+            uint64_t alignment;
+            void* _Nullable pointerAlignment;
+            uint8_t bytes[kHAPPlatformWorkerPool_MaxContextBytes];
+        } context;
+        HAPRawBufferCopyBytes(context.bytes, workerPool->jobs[0].context.bytes, contextSize);
+        workerPool->numJobs--;
+        HAPRawBufferCopyBytes(
+                &workerPool->jobs[0], &workerPool->jobs[1], workerPool->numJobs * sizeof workerPool->jobs[0]);
+        HAPRawBufferZero(&workerPool->jobs[workerPool->numJobs], sizeof workerPool->jobs[0]);
+
+        work(context.bytes, contextSize);
+        completion(context.bytes, contextSize);
+        HAPRawBufferZero(context.bytes, contextSize);
+    }
+}
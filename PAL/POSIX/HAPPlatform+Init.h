@@ -26,6 +26,14 @@ extern "C" {
 #ifndef HAVE_MFI_HW_AUTH
 #define HAVE_MFI_HW_AUTH 0
 #endif
+
+#ifndef HAVE_WORKER_POOL
+#define HAVE_WORKER_POOL 0
+#endif
+
+#ifndef HAVE_RANDOM_NUMBER_DRBG
+#define HAVE_RANDOM_NUMBER_DRBG 0
+#endif
 /**@}*/
 
 #include <stdlib.h>
@@ -4,4 +4,119 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
-#include "../Mock/HAPPlatformBLEPeripheralManager+Init.h"
+#ifndef HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_INIT_H
+#define HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+#include "HAPPlatformBLEPeripheralManagerATT.h"
+#include "HAPPlatformFileHandle.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * BLE peripheral manager that serves the GATT database over a local socket instead of a Bluetooth controller.
+ *
+ * - A simulated central connects to a Unix domain socket of type SOCK_SEQPACKET.
+ *   Every packet carries one ATT PDU, in both directions.
+ *
+ * - Only one central may be connected at a time. Further connections are accepted once the central disconnects.
+ *
+ * - Advertising data is not transmitted. The listening socket is available while services are published.
+ *
+ * **Example**
+
+   @code{.c}
+
+   static HAPPlatformBLEPeripheralManagerAttribute attributes[kAttributeCount * 2];
+   static HAPPlatformBLEPeripheralManager blePeripheralManager;
+   HAPPlatformBLEPeripheralManagerCreate(&blePeripheralManager,
+       &(const HAPPlatformBLEPeripheralManagerOptions) {
+           .attributes = attributes,
+           .numAttributes = HAPArrayCount(attributes),
+           .socketPath = ".HomeKitStore/ble.sock"
+       });
+
+   @endcode
+ */
+
+/**
+ * BLE peripheral manager initialization options.
+ */
+typedef struct {
+    /** GATT database storage. */
+    HAPPlatformBLEPeripheralManagerAttribute* attributes;
+
+    /** Capacity of the GATT database storage. */
+    size_t numAttributes;
+
+    /**
+     * Path of the socket on which the simulated central connects.
+     *
+     * - The socket is only accessible by its owner. It should be placed in a directory that is private to the
+     *   accessory, so that other users cannot replace it.
+     */
+    const char* socketPath;
+} HAPPlatformBLEPeripheralManagerOptions;
+
+/**
+ * BLE peripheral manager.
+ */
+struct HAPPlatformBLEPeripheralManager {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformBLEPeripheralManagerAttribute* attributes;
+    size_t numAttributes;
+
+    HAPPlatformBLEPeripheralManagerDelegate delegate;
+    HAPPlatformBLEPeripheralManagerDeviceAddress deviceAddress;
+    char deviceName[64 + 1];
+    char socketPath[108];
+
+    HAPBLEAdvertisingInterval advertisingInterval;
+
+    HAPPlatformBLEPeripheralManagerATTServer attServer;
+
+    struct {
+        int fileDescriptor;
+        HAPPlatformFileHandleRef fileHandle;
+    } listener;
+
+    struct {
+        int fileDescriptor;
+        HAPPlatformFileHandleRef fileHandle;
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
+        uint8_t bytes[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+    } central;
+
+    HAPPlatformTimerRef disconnectTimer;
+
+    bool isDeviceAddressSet : 1;
+    bool didPublishAttributes : 1;
+    /**@endcond */
+};
+
+/**
+ * Initializes the BLE peripheral manager.
+ *
+ * @param[out] blePeripheralManager Pointer to an allocated but uninitialized HAPPlatformBLEPeripheralManager structure.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformBLEPeripheralManagerCreate(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerOptions* options);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
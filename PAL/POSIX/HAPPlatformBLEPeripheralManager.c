@@ -4,4 +4,602 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
-#include "../Mock/HAPPlatformBLEPeripheralManager.c"
+// accept4 is a GNU extension.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformLog+Init.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "BLEPeripheralManager" };
+
+static void SendCentralPDU(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context);
+
+static void HandleListenerFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context);
+
+static void HandleCentralFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context);
+
+void HAPPlatformBLEPeripheralManagerCreate(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerOptions* options) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(options);
+    HAPPrecondition(options->attributes);
+    HAPPrecondition(options->numAttributes <= SIZE_MAX / sizeof options->attributes[0]);
+    HAPPrecondition(options->socketPath);
+
+    HAPRawBufferZero(options->attributes, options->numAttributes * sizeof options->attributes[0]);
+
+    HAPRawBufferZero(blePeripheralManager, sizeof *blePeripheralManager);
+    blePeripheralManager->attributes = options->attributes;
+    blePeripheralManager->numAttributes = options->numAttributes;
+
+    const char* socketPath = options->socketPath;
+    size_t numSocketPathBytes = HAPStringGetNumBytes(socketPath);
+    if (!numSocketPathBytes || numSocketPathBytes >= sizeof blePeripheralManager->socketPath ||
+        numSocketPathBytes >= sizeof((struct sockaddr_un*) NULL)->sun_path) {
+        HAPLogError(&logObject, "Invalid socket path.");
+        HAPFatalError();
+    }
+    HAPRawBufferCopyBytes(blePeripheralManager->socketPath, socketPath, numSocketPathBytes);
+
+    blePeripheralManager->listener.fileDescriptor = -1;
+    blePeripheralManager->central.fileDescriptor = -1;
+
+    HAPPlatformBLEPeripheralManagerATTServerCreate(
+            &blePeripheralManager->attServer,
+            &(const HAPPlatformBLEPeripheralManagerATTServerOptions) {
+                    .blePeripheralManager = blePeripheralManager,
+                    .attributes = options->attributes,
+                    .numAttributes = options->numAttributes,
+                    .delegate = &blePeripheralManager->delegate,
+                    .sendPDU = SendCentralPDU,
+                    .context = blePeripheralManager });
+}
+
+void HAPPlatformBLEPeripheralManagerSetDelegate(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerDelegate* _Nullable delegate) {
+    HAPPrecondition(blePeripheralManager);
+
+    if (delegate) {
+        blePeripheralManager->delegate = *delegate;
+    } else {
+        HAPRawBufferZero(&blePeripheralManager->delegate, sizeof blePeripheralManager->delegate);
+    }
+}
+
+void HAPPlatformBLEPeripheralManagerSetDeviceAddress(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerDeviceAddress* deviceAddress) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
+    HAPPrecondition(deviceAddress);
+
+    blePeripheralManager->deviceAddress = *deviceAddress;
+    blePeripheralManager->isDeviceAddressSet = true;
+}
+
+void HAPPlatformBLEPeripheralManagerSetDeviceName(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const char* deviceName) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(deviceName);
+
+    size_t numDeviceNameBytes = HAPStringGetNumBytes(deviceName);
+    HAPPrecondition(numDeviceNameBytes < sizeof blePeripheralManager->deviceName);
+
+    HAPRawBufferZero(blePeripheralManager->deviceName, sizeof blePeripheralManager->deviceName);
+    HAPRawBufferCopyBytes(blePeripheralManager->deviceName, deviceName, numDeviceNameBytes);
+}
+
+/**
+ * Closes a socket.
+ *
+ * @param      fileDescriptor       Socket file descriptor.
+ */
+static void CloseSocket(int fileDescriptor) {
+    HAPPrecondition(fileDescriptor != -1);
+
+    HAPLogDebug(&logObject, "close(%d);", fileDescriptor);
+    int e = close(fileDescriptor);
+    if (e != 0) {
+        int _errno = errno;
+        HAPAssert(e == -1);
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Debug, "System call 'close' on socket failed.", _errno, __func__, HAP_FILE, __LINE__);
+    }
+}
+
+/**
+ * Updates whether new centrals are accepted.
+ *
+ * - Centrals are accepted while advertising and while no other central is connected.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ */
+static void UpdateListenerInterests(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    if (!blePeripheralManager->listener.fileHandle) {
+        return;
+    }
+    bool isAccepting = blePeripheralManager->advertisingInterval &&
+                       !HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer);
+    HAPPlatformFileHandleUpdateInterests(
+            blePeripheralManager->listener.fileHandle,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = isAccepting, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleListenerFileHandleCallback,
+            blePeripheralManager);
+}
+
+static void OpenListener(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->listener.fileDescriptor == -1);
+
+    HAPError err;
+    int e;
+
+    struct sockaddr_un sun;
+    HAPRawBufferZero(&sun, sizeof sun);
+    sun.sun_family = AF_UNIX;
+    HAPRawBufferCopyBytes(
+            sun.sun_path, blePeripheralManager->socketPath, HAPStringGetNumBytes(blePeripheralManager->socketPath));
+
+    HAPLogDebug(&logObject, "socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);");
+    int fileDescriptor = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fileDescriptor == -1) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'socket' for BLE peripheral manager listener failed.",
+                errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    // Remove stale socket of a previous run. Other files are never removed.
+    struct stat st;
+    e = lstat(blePeripheralManager->socketPath, &st);
+    if (e == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            HAPLogError(&logObject, "%s exists and is not a socket.", blePeripheralManager->socketPath);
+            HAPFatalError();
+        }
+        HAPLogDebug(&logObject, "unlink(\"%s\");", blePeripheralManager->socketPath);
+        e = unlink(blePeripheralManager->socketPath);
+    }
+    if (e != 0 && errno != ENOENT) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'unlink' for BLE peripheral manager socket path failed.",
+                errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    // Only the owner may connect. The socket is created with these permissions, so there is no window in which
+    // other users can connect.
+    HAPLogDebug(&logObject, "bind(%d, \"%s\");", fileDescriptor, blePeripheralManager->socketPath);
+    mode_t mask = umask(S_IXUSR | S_IRWXG | S_IRWXO);
+    e = bind(fileDescriptor, (struct sockaddr*) &sun, sizeof sun);
+    int _errno = errno;
+    (void) umask(mask);
+    if (e != 0) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'bind' on BLE peripheral manager listener failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    HAPLogDebug(&logObject, "listen(%d, 1);", fileDescriptor);
+    e = listen(fileDescriptor, 1);
+    if (e != 0) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'listen' on BLE peripheral manager listener failed.",
+                errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    HAPPlatformFileHandleRef fileHandle;
+    err = HAPPlatformFileHandleRegister(
+            &fileHandle,
+            fileDescriptor,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = false, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleListenerFileHandleCallback,
+            blePeripheralManager);
+    if (err) {
+        HAPLogError(&logObject, "Failed to register BLE peripheral manager listener file handle.");
+        HAPFatalError();
+    }
+    HAPAssert(fileHandle);
+
+    blePeripheralManager->listener.fileDescriptor = fileDescriptor;
+    blePeripheralManager->listener.fileHandle = fileHandle;
+    HAPLogInfo(&logObject, "Listening for simulated centrals on %s.", blePeripheralManager->socketPath);
+
+    UpdateListenerInterests(blePeripheralManager);
+}
+
+static void CloseListener(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    if (blePeripheralManager->listener.fileDescriptor == -1) {
+        return;
+    }
+    HAPPlatformFileHandleDeregister(blePeripheralManager->listener.fileHandle);
+    blePeripheralManager->listener.fileHandle = 0;
+    CloseSocket(blePeripheralManager->listener.fileDescriptor);
+    blePeripheralManager->listener.fileDescriptor = -1;
+
+    HAPLogDebug(&logObject, "unlink(\"%s\");", blePeripheralManager->socketPath);
+    (void) unlink(blePeripheralManager->socketPath);
+}
+
+/**
+ * Disconnects the connected central.
+ *
+ * @param      blePeripheralManager BLE peripheral manager. A central must be connected.
+ */
+static void DisconnectCentral(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
+    HAPPrecondition(blePeripheralManager->central.fileDescriptor != -1);
+
+    if (blePeripheralManager->disconnectTimer) {
+        HAPPlatformTimerDeregister(blePeripheralManager->disconnectTimer);
+        blePeripheralManager->disconnectTimer = 0;
+    }
+
+    HAPPlatformFileHandleDeregister(blePeripheralManager->central.fileHandle);
+    blePeripheralManager->central.fileHandle = 0;
+    CloseSocket(blePeripheralManager->central.fileDescriptor);
+    blePeripheralManager->central.fileDescriptor = -1;
+
+    HAPPlatformBLEPeripheralManagerATTServerDisconnect(&blePeripheralManager->attServer);
+    UpdateListenerInterests(blePeripheralManager);
+}
+
+static void DisconnectTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPPrecondition(timer == blePeripheralManager->disconnectTimer);
+    blePeripheralManager->disconnectTimer = 0;
+
+    if (HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        DisconnectCentral(blePeripheralManager);
+    }
+}
+
+/**
+ * Schedules the disconnection of the connected central.
+ *
+ * - Disconnection is deferred so that the delegate is not re-entered.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ */
+static void ScheduleDisconnect(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    if (blePeripheralManager->disconnectTimer) {
+        return;
+    }
+    HAPError err = HAPPlatformTimerRegister(
+            &blePeripheralManager->disconnectTimer,
+            /* deadline: */ 0,
+            DisconnectTimerExpired,
+            blePeripheralManager);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&logObject, "Not enough resources to schedule disconnect.");
+        HAPFatalError();
+    }
+}
+
+static void SendCentralPDU(
+        HAPPlatformBLEPeripheralManagerATTServer* attServer,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context) {
+    HAPPrecondition(attServer);
+    HAPPrecondition(bytes);
+    HAPPrecondition(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPPrecondition(attServer == &blePeripheralManager->attServer);
+    HAPPrecondition(blePeripheralManager->central.fileDescriptor != -1);
+
+    if (blePeripheralManager->disconnectTimer) {
+        return;
+    }
+
+    // ATT PDUs are small compared to the socket buffer. The send only blocks if the central stops reading.
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "> ATT PDU");
+    ssize_t n;
+    do {
+        n = send(blePeripheralManager->central.fileDescriptor, bytes, numBytes, MSG_NOSIGNAL);
+    } while (n == -1 && errno == EINTR);
+    if (n == -1 || (size_t) n != numBytes) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'send' on simulated central socket failed.",
+                errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        ScheduleDisconnect(blePeripheralManager);
+    }
+}
+
+static void HandleListenerFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context) {
+    HAPAssert(fileHandle);
+    HAPAssert(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPAssert(fileHandle == blePeripheralManager->listener.fileHandle);
+
+    if (!fileHandleEvents.isReadyForReading ||
+        HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer)) {
+        return;
+    }
+
+    HAPLogDebug(&logObject, "accept4(%d, NULL, NULL, SOCK_CLOEXEC);", blePeripheralManager->listener.fileDescriptor);
+    int fileDescriptor = accept4(blePeripheralManager->listener.fileDescriptor, NULL, NULL, SOCK_CLOEXEC);
+    if (fileDescriptor == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+            HAPPlatformLogPOSIXError(
+                    kHAPLogType_Error,
+                    "System call 'accept4' on BLE peripheral manager listener failed.",
+                    errno,
+                    __func__,
+                    HAP_FILE,
+                    __LINE__);
+        }
+        return;
+    }
+
+    HAPPlatformFileHandleRef centralFileHandle;
+    HAPError err = HAPPlatformFileHandleRegister(
+            &centralFileHandle,
+            fileDescriptor,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = true, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleCentralFileHandleCallback,
+            blePeripheralManager);
+    if (err) {
+        HAPLogError(&logObject, "Failed to register simulated central file handle.");
+        CloseSocket(fileDescriptor);
+        return;
+    }
+
+    blePeripheralManager->central.fileDescriptor = fileDescriptor;
+    blePeripheralManager->central.fileHandle = centralFileHandle;
+    blePeripheralManager->central.connectionHandle++;
+    HAPPlatformBLEPeripheralManagerATTServerConnect(
+            &blePeripheralManager->attServer, blePeripheralManager->central.connectionHandle);
+    UpdateListenerInterests(blePeripheralManager);
+}
+
+static void HandleCentralFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context) {
+    HAPAssert(fileHandle);
+    HAPAssert(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPAssert(fileHandle == blePeripheralManager->central.fileHandle);
+
+    if (!fileHandleEvents.isReadyForReading) {
+        return;
+    }
+
+    ssize_t n;
+    do {
+        n = recv(blePeripheralManager->central.fileDescriptor,
+                 blePeripheralManager->central.bytes,
+                 sizeof blePeripheralManager->central.bytes,
+                 MSG_DONTWAIT | MSG_TRUNC);
+    } while (n == -1 && errno == EINTR);
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (n <= 0) {
+        if (n == -1) {
+            HAPPlatformLogPOSIXError(
+                    kHAPLogType_Error,
+                    "System call 'recv' on simulated central socket failed.",
+                    errno,
+                    __func__,
+                    HAP_FILE,
+                    __LINE__);
+        }
+        DisconnectCentral(blePeripheralManager);
+        return;
+    }
+    if ((size_t) n > sizeof blePeripheralManager->central.bytes) {
+        HAPLog(&logObject, "Simulated central sent oversized ATT PDU (%zd bytes).", n);
+        ScheduleDisconnect(blePeripheralManager);
+        return;
+    }
+    if (blePeripheralManager->disconnectTimer) {
+        return;
+    }
+
+    HAPPlatformBLEPeripheralManagerATTServerHandlePDU(
+            &blePeripheralManager->attServer, blePeripheralManager->central.bytes, (size_t) n);
+}
+
+void HAPPlatformBLEPeripheralManagerRemoveAllServices(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer));
+
+    CloseListener(blePeripheralManager);
+
+    HAPAssert(blePeripheralManager->numAttributes <= SIZE_MAX / sizeof blePeripheralManager->attributes[0]);
+    HAPRawBufferZero(
+            blePeripheralManager->attributes,
+            blePeripheralManager->numAttributes * sizeof blePeripheralManager->attributes[0]);
+    blePeripheralManager->didPublishAttributes = false;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerAddService(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        bool isPrimary) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(!blePeripheralManager->didPublishAttributes);
+    HAPPrecondition(type);
+
+    return HAPPlatformBLEPeripheralManagerATTAddService(
+            blePeripheralManager->attributes, blePeripheralManager->numAttributes, type, isPrimary);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerAddCharacteristic(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerCharacteristicProperties properties,
+        const void* _Nullable constBytes HAP_UNUSED,
+        size_t constNumBytes HAP_UNUSED,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nullable cccDescriptorHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(!blePeripheralManager->didPublishAttributes);
+    HAPPrecondition(type);
+    HAPPrecondition(valueHandle);
+
+    return HAPPlatformBLEPeripheralManagerATTAddCharacteristic(
+            blePeripheralManager->attributes,
+            blePeripheralManager->numAttributes,
+            type,
+            properties,
+            valueHandle,
+            cccDescriptorHandle);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerAddDescriptor(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerUUID* type,
+        HAPPlatformBLEPeripheralManagerDescriptorProperties properties,
+        const void* _Nullable constBytes HAP_UNUSED,
+        size_t constNumBytes HAP_UNUSED,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* descriptorHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(!blePeripheralManager->didPublishAttributes);
+    HAPPrecondition(type);
+    HAPPrecondition(descriptorHandle);
+
+    return HAPPlatformBLEPeripheralManagerATTAddDescriptor(
+            blePeripheralManager->attributes,
+            blePeripheralManager->numAttributes,
+            type,
+            properties,
+            descriptorHandle);
+}
+
+void HAPPlatformBLEPeripheralManagerPublishServices(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isDeviceAddressSet);
+    HAPPrecondition(!blePeripheralManager->didPublishAttributes);
+
+    blePeripheralManager->didPublishAttributes = true;
+    OpenListener(blePeripheralManager);
+}
+
+void HAPPlatformBLEPeripheralManagerStartAdvertising(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPBLEAdvertisingInterval advertisingInterval,
+        const void* advertisingBytes,
+        size_t numAdvertisingBytes,
+        const void* _Nullable scanResponseBytes,
+        size_t numScanResponseBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isDeviceAddressSet);
+    HAPPrecondition(blePeripheralManager->didPublishAttributes);
+    HAPPrecondition(advertisingInterval);
+    HAPPrecondition(advertisingBytes);
+    HAPPrecondition(numAdvertisingBytes);
+    HAPPrecondition(!numScanResponseBytes || scanResponseBytes);
+
+    HAPLogBufferDebug(&logObject, advertisingBytes, numAdvertisingBytes, "Advertising data");
+    if (scanResponseBytes) {
+        HAPLogBufferDebug(&logObject, HAPNonnullVoid(scanResponseBytes), numScanResponseBytes, "Scan response data");
+    }
+    blePeripheralManager->advertisingInterval = advertisingInterval;
+    UpdateListenerInterests(blePeripheralManager);
+}
+
+void HAPPlatformBLEPeripheralManagerStopAdvertising(HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isDeviceAddressSet);
+    HAPPrecondition(blePeripheralManager->didPublishAttributes);
+
+    blePeripheralManager->advertisingInterval = 0;
+    UpdateListenerInterests(blePeripheralManager);
+}
+
+void HAPPlatformBLEPeripheralManagerCancelCentralConnection(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
+    HAPPrecondition(blePeripheralManager);
+
+    if (!HAPPlatformBLEPeripheralManagerATTServerIsConnected(&blePeripheralManager->attServer) ||
+        connectionHandle != blePeripheralManager->central.connectionHandle) {
+        HAPLog(&logObject, "Ignoring request to disconnect unknown connection 0x%04x.", connectionHandle);
+        return;
+    }
+    ScheduleDisconnect(blePeripheralManager);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle,
+        const void* _Nullable bytes,
+        size_t numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(valueHandle);
+    HAPPrecondition(!numBytes || bytes);
+    HAPPrecondition(blePeripheralManager->didPublishAttributes);
+
+    if (connectionHandle != blePeripheralManager->central.connectionHandle) {
+        return kHAPError_InvalidState;
+    }
+    return HAPPlatformBLEPeripheralManagerATTServerSendHandleValueIndication(
+            &blePeripheralManager->attServer, valueHandle, bytes, numBytes);
+}
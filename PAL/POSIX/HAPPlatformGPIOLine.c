@@ -0,0 +1,262 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <linux/gpio.h>
+
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformGPIOLine.h"
+#include "HAPPlatformLog+Init.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "GPIOLine" };
+
+HAP_STATIC_ASSERT(sizeof(struct gpioevent_data) == kHAPPlatformGPIOInputEvent_NumBytes, gpioevent_data);
+HAP_STATIC_ASSERT(GPIOEVENT_EVENT_RISING_EDGE == kHAPPlatformGPIOInputEvent_RisingEdge, GPIOEVENT_EVENT_RISING_EDGE);
+HAP_STATIC_ASSERT(GPIOEVENT_EVENT_FALLING_EDGE == kHAPPlatformGPIOInputEvent_FallingEdge, GPIOEVENT_EVENT_FALLING_EDGE);
+
+/**
+ * Maximum number of line events that are read at once.
+ */
+#define kMaxEventsPerRead ((size_t) 16)
+
+static void HandleEdge(HAPPlatformGPIOInput* input, bool value, uint64_t timestamp, void* _Nullable context) {
+    HAPPrecondition(input);
+    HAPPrecondition(context);
+    HAPPlatformGPIOLine* line = context;
+    HAPAssert(input == &line->input);
+
+    line->callback(line, value, timestamp, line->context);
+}
+
+static void HandleDebounceTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformGPIOLine* line = context;
+    HAPAssert(timer == line->debounceTimer);
+    line->debounceTimer = 0;
+
+    HAPPlatformGPIOInputHandleDebounceTimeout(&line->input);
+}
+
+/**
+ * Arms the debounce timer if an edge is pending, so that it is reported even if no further line events arrive.
+ *
+ * @param      line                 GPIO line.
+ */
+static void UpdateDebounceTimer(HAPPlatformGPIOLine* line) {
+    HAPPrecondition(line);
+
+    HAPError err;
+
+    if (line->debounceTimer) {
+        HAPPlatformTimerDeregister(line->debounceTimer);
+        line->debounceTimer = 0;
+    }
+
+    HAPTime delay;
+    if (!HAPPlatformGPIOInputGetPendingEdgeDelay(&line->input, &delay)) {
+        return;
+    }
+    err = HAPPlatformTimerRegister(
+            &line->debounceTimer, HAPPlatformClockGetCurrent() + delay, HandleDebounceTimerExpired, line);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&logObject, "Not enough resources to start GPIO debounce timer.");
+        HAPFatalError();
+    }
+}
+
+static void HandleFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context) {
+    HAPAssert(fileHandle);
+    HAPAssert(fileHandleEvents.isReadyForReading);
+    HAPAssert(context);
+
+    HAPPlatformGPIOLine* line = context;
+
+    HAPAssert(line->fileHandle == fileHandle);
+
+    for (;;) {
+        uint8_t bytes[kMaxEventsPerRead * kHAPPlatformGPIOInputEvent_NumBytes];
+        ssize_t n = read(line->fileDescriptor, bytes, sizeof bytes);
+        if (n < 0) {
+            int _errno = errno;
+            if (_errno == EINTR) {
+                continue;
+            }
+            if (_errno != EAGAIN && _errno != EWOULDBLOCK) {
+                HAPPlatformLogPOSIXError(
+                        kHAPLogType_Error,
+                        "System call 'read' on GPIO line event file descriptor failed.",
+                        _errno,
+                        __func__,
+                        HAP_FILE,
+                        __LINE__);
+            }
+            return;
+        }
+        if (n == 0) {
+            HAPLog(&logObject, "GPIO line event file descriptor has been closed.");
+            HAPPlatformFileHandleDeregister(line->fileHandle);
+            line->fileHandle = 0;
+            return;
+        }
+
+        // The line may be released by the callback.
+        int fileDescriptor = line->fileDescriptor;
+        HAPPlatformGPIOInputHandleBytes(&line->input, bytes, (size_t) n);
+        if (line->fileDescriptor != fileDescriptor) {
+            return;
+        }
+        UpdateDebounceTimer(line);
+    }
+}
+
+void HAPPlatformGPIOLineCreateWithFileDescriptor(
+        HAPPlatformGPIOLine* line,
+        int fileDescriptor,
+        bool initialValue,
+        const HAPPlatformGPIOLineOptions* options) {
+    HAPPrecondition(line);
+    HAPPrecondition(fileDescriptor >= 0);
+    HAPPrecondition(options);
+    HAPPrecondition(options->callback);
+
+    HAPError err;
+
+    HAPRawBufferZero(line, sizeof *line);
+    line->callback = options->callback;
+    line->context = options->context;
+    line->fileDescriptor = fileDescriptor;
+    HAPPlatformGPIOInputCreate(
+            &line->input,
+            &(const HAPPlatformGPIOInputOptions) { .initialValue = initialValue,
+                                                   .debounceDuration = options->debounceDuration,
+                                                   .callback = HandleEdge,
+                                                   .context = line });
+
+    int e = fcntl(fileDescriptor, F_SETFL, O_NONBLOCK);
+    if (e == -1) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'fcntl' to set GPIO line event file descriptor to 'O_NONBLOCK' failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    err = HAPPlatformFileHandleRegister(
+            &line->fileHandle,
+            fileDescriptor,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = true, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleFileHandleCallback,
+            line);
+    if (err) {
+        HAPLogError(&logObject, "%s: HAPPlatformFileHandleRegister failed: %u.", __func__, err);
+        HAPFatalError();
+    }
+    HAPAssert(line->fileHandle);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformGPIOLineCreate(HAPPlatformGPIOLine* line, const HAPPlatformGPIOLineOptions* options) {
+    HAPPrecondition(line);
+    HAPPrecondition(options);
+    HAPPrecondition(options->chipPath);
+
+    int chipFileDescriptor = open(HAPNonnull(options->chipPath), O_RDONLY | O_CLOEXEC);
+    if (chipFileDescriptor == -1) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error, "System call 'open' on GPIO chip failed.", _errno, __func__, HAP_FILE, __LINE__);
+        return kHAPError_Unknown;
+    }
+
+    struct gpioevent_request request;
+    HAPRawBufferZero(&request, sizeof request);
+    request.lineoffset = options->lineOffset;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+    if (options->consumerLabel) {
+        size_t numBytes = HAPStringGetNumBytes(HAPNonnull(options->consumerLabel));
+        if (numBytes >= sizeof request.consumer_label) {
+            numBytes = sizeof request.consumer_label - 1;
+        }
+        HAPRawBufferCopyBytes(request.consumer_label, HAPNonnull(options->consumerLabel), numBytes);
+    }
+    int e = ioctl(chipFileDescriptor, GPIO_GET_LINEEVENT_IOCTL, &request);
+    int _errno = errno;
+    (void) close(chipFileDescriptor);
+    if (e == -1) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'ioctl' to request GPIO line events failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        return kHAPError_Unknown;
+    }
+
+    // The initial value is read after the line events have been requested, so that no edge is missed.
+    struct gpiohandle_data data;
+    HAPRawBufferZero(&data, sizeof data);
+    e = ioctl(request.fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data);
+    if (e == -1) {
+        _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'ioctl' to read GPIO line value failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        (void) close(request.fd);
+        return kHAPError_Unknown;
+    }
+
+    HAPLogInfo(
+            &logObject,
+            "Requested line events for %s line %lu (value %u).",
+            options->chipPath,
+            (unsigned long) options->lineOffset,
+            data.values[0]);
+    HAPPlatformGPIOLineCreateWithFileDescriptor(line, request.fd, data.values[0] != 0, options);
+    return kHAPError_None;
+}
+
+void HAPPlatformGPIOLineRelease(HAPPlatformGPIOLine* line) {
+    HAPPrecondition(line);
+    HAPPrecondition(line->fileDescriptor != -1);
+
+    if (line->fileHandle) {
+        HAPPlatformFileHandleDeregister(line->fileHandle);
+        line->fileHandle = 0;
+    }
+    if (line->debounceTimer) {
+        HAPPlatformTimerDeregister(line->debounceTimer);
+        line->debounceTimer = 0;
+    }
+
+    (void) close(line->fileDescriptor);
+    line->fileDescriptor = -1;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOLineGetValue(const HAPPlatformGPIOLine* line) {
+    HAPPrecondition(line);
+
+    return HAPPlatformGPIOInputGetValue(&line->input);
+}
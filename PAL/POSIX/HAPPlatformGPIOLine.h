@@ -0,0 +1,176 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_GPIO_LINE_H
+#define HAP_PLATFORM_GPIO_LINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+#include "HAPPlatformFileHandle.h"
+#include "HAPPlatformGPIOInput.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * GPIO input line on the run loop, based on the Linux GPIO character device.
+ *
+ * - Both edges of the line are requested from the kernel as line events. The line event file descriptor is
+ *   registered with the run loop, so that edges with kernel timestamps are delivered on the run loop without
+ *   additional threads.
+ *
+ * - Edges that are deferred by debouncing are reported by a run loop timer once the debounce duration has elapsed,
+ *   so that the value does not stick if the line settles within the debounce duration.
+ *
+ * - Instead of a GPIO chip, any file descriptor that produces line events may be used, e.g., the read end of a pipe
+ *   that is fed by a fake backend. See HAPPlatformGPIOInput.h for the format of line events.
+ *
+ * **Example**
+
+   @code{.c}
+
+   static void HandleEdge(HAPPlatformGPIOLine* line, bool value, uint64_t timestamp, void* _Nullable context)
+   {
+       // Value changed. Invoked on the run loop.
+   }
+
+   static HAPPlatformGPIOLine line;
+   HAPError err = HAPPlatformGPIOLineCreate(&line,
+       &(const HAPPlatformGPIOLineOptions) {
+           .chipPath = "/dev/gpiochip0",
+           .lineOffset = 20,
+           .consumerLabel = "doorbell",
+           .debounceDuration = 20 * HAPMillisecond,
+           .callback = HandleEdge
+       });
+
+   @endcode
+ */
+
+typedef struct HAPPlatformGPIOLine HAPPlatformGPIOLine;
+
+/**
+ * Callback that is invoked on the run loop when the value of a GPIO line changes.
+ *
+ * @param      line                 GPIO line.
+ * @param      value                New value of the line.
+ * @param      timestamp            Timestamp of the edge in nanoseconds, as provided by the kernel.
+ * @param      context              The context parameter given to the HAPPlatformGPIOLineCreate function.
+ */
+typedef void (*HAPPlatformGPIOLineCallback)(
+        HAPPlatformGPIOLine* line,
+        bool value,
+        uint64_t timestamp,
+        void* _Nullable context);
+
+/**
+ * GPIO line initialization options.
+ */
+typedef struct {
+    /**
+     * Path to the GPIO chip, e.g. "/dev/gpiochip0". Ignored by HAPPlatformGPIOLineCreateWithFileDescriptor.
+     */
+    const char* _Nullable chipPath;
+
+    /**
+     * Offset of the line on the GPIO chip. Ignored by HAPPlatformGPIOLineCreateWithFileDescriptor.
+     */
+    uint32_t lineOffset;
+
+    /**
+     * Consumer label that is shown for the line by the kernel. Optional.
+     */
+    const char* _Nullable consumerLabel;
+
+    /**
+     * Minimum duration between two reported edges. 0 disables debouncing.
+     */
+    HAPTime debounceDuration;
+
+    /**
+     * Callback to invoke when the value of the line changes.
+     */
+    HAPPlatformGPIOLineCallback callback;
+
+    /**
+     * Context that is passed to the callback.
+     */
+    void* _Nullable context;
+} HAPPlatformGPIOLineOptions;
+
+/**
+ * GPIO line.
+ */
+struct HAPPlatformGPIOLine {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformGPIOInput input;
+    HAPPlatformGPIOLineCallback callback;
+    void* _Nullable context;
+    int fileDescriptor;
+    HAPPlatformFileHandleRef fileHandle;
+    HAPPlatformTimerRef debounceTimer;
+    /**@endcond */
+};
+
+/**
+ * Requests line events for a line of a GPIO chip and starts delivering edges on the run loop.
+ *
+ * @param[out] line                 Pointer to an allocated but uninitialized HAPPlatformGPIOLine structure.
+ * @param      options              Initialization options.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If the GPIO chip could not be opened or the line events could not be requested.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformGPIOLineCreate(HAPPlatformGPIOLine* line, const HAPPlatformGPIOLineOptions* options);
+
+/**
+ * Starts delivering edges from a file descriptor that produces line events on the run loop.
+ *
+ * - The file descriptor is set to non-blocking mode, and is closed by HAPPlatformGPIOLineRelease.
+ *
+ * @param[out] line                 Pointer to an allocated but uninitialized HAPPlatformGPIOLine structure.
+ * @param      fileDescriptor       File descriptor that produces line events.
+ * @param      initialValue         Value of the line before the first event.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformGPIOLineCreateWithFileDescriptor(
+        HAPPlatformGPIOLine* line,
+        int fileDescriptor,
+        bool initialValue,
+        const HAPPlatformGPIOLineOptions* options);
+
+/**
+ * Stops delivering edges and releases resources associated with an initialized GPIO line.
+ *
+ * @param      line                 GPIO line.
+ */
+void HAPPlatformGPIOLineRelease(HAPPlatformGPIOLine* line);
+
+/**
+ * Returns the debounced value of a GPIO line.
+ *
+ * @param      line                 GPIO line.
+ *
+ * @return Value of the line.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformGPIOLineGetValue(const HAPPlatformGPIOLine* line);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,7 @@ extern "C" {
 #endif
 
 #include "HAPPlatform.h"
+#include "HAPPlatformMFiHWAuthI2C.h"
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull begin
@@ -25,6 +26,10 @@ extern "C" {
  * and that the i2c-dev module makes it accessible through the path "/dev/i2c-1".
  * If a different path or I2C address is used, the implementation needs to be adjusted.
  *
+ * While the Apple Authentication Coprocessor is busy, it does not acknowledge transfers. Synchronous transactions
+ * block until the transfer is acknowledged, retrying with exponential backoff. Asynchronous transactions are retried
+ * from the run loop instead. See HAPPlatformMFiHWAuthI2C.h.
+ *
  * **Example**
 
    @code{.c}
@@ -49,6 +54,9 @@ struct HAPPlatformMFiHWAuth {
     /**@cond */
     int i2cFile;
     bool enabled;
+    HAPPlatformMFiHWAuthI2C i2c;
+    HAPPlatformMFiHWAuthCompletionCallback _Nullable completion;
+    void* _Nullable context;
     /**@endcond */
 };
 
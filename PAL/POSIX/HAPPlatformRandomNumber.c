@@ -9,7 +9,13 @@
 #include <syscall.h>
 #include <unistd.h>
 
-#include "HAPPlatform.h"
+#include "HAPPlatform+Init.h"
+
+#if HAVE_RANDOM_NUMBER_DRBG
+#include <pthread.h>
+
+#include "HAPPlatformRandomNumberDRBG.h"
+#endif
 
 /**
  * Linux Random Number generator.
@@ -20,11 +26,20 @@
  * For more information see:
  *  - LWN - The long road to getrandom() in glibc: https://lwn.net/Articles/711013/
  *  - Getrandom Manpage: http://man7.org/linux/man-pages/man2/getrandom.2.html
+ *
+ * If HAVE_RANDOM_NUMBER_DRBG is set, getrandom(2) only seeds a ChaCha20 DRBG that runs in user space,
+ * and requests are served without a system call. The DRBG is reseeded periodically and after a fork.
  */
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "RandomNumber" };
 
-void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
+/**
+ * Fills a buffer with random data from getrandom(2).
+ *
+ * @param[out] bytes                Buffer to fill with random data.
+ * @param      numBytes             Length of buffer.
+ */
+static void FillWithGetrandom(void* bytes, size_t numBytes) {
     HAPPrecondition(bytes);
 
     // Read random data.
@@ -69,3 +84,71 @@ void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
     HAPLogError(&logObject, "getrandom produced only zeros.");
     HAPFatalError();
 }
+
+#if HAVE_RANDOM_NUMBER_DRBG
+
+/** Serializes access to the DRBG. HAPPlatformRandomNumberFill may be called from worker threads. */
+static pthread_mutex_t drbgMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Ensures that fork handlers are registered once. */
+static pthread_once_t drbgOnce = PTHREAD_ONCE_INIT;
+
+/** DRBG. */
+static HAPPlatformRandomNumberDRBG drbg;
+
+static void PrepareFork(void) {
+    int e = pthread_mutex_lock(&drbgMutex);
+    HAPAssert(!e);
+}
+
+static void HandleForkInParent(void) {
+    int e = pthread_mutex_unlock(&drbgMutex);
+    HAPAssert(!e);
+}
+
+static void HandleForkInChild(void) {
+    // The child must not produce the same output as the parent.
+    HAPPlatformRandomNumberDRBGInvalidate(&drbg);
+
+    int e = pthread_mutex_unlock(&drbgMutex);
+    HAPAssert(!e);
+}
+
+static void InitializeDRBG(void) {
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+
+    int e = pthread_atfork(PrepareFork, HandleForkInParent, HandleForkInChild);
+    if (e) {
+        HAPLogError(&logObject, "pthread_atfork failed: %d.", e);
+        HAPFatalError();
+    }
+}
+
+void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+
+    int e = pthread_once(&drbgOnce, InitializeDRBG);
+    HAPAssert(!e);
+
+    e = pthread_mutex_lock(&drbgMutex);
+    HAPAssert(!e);
+    {
+        if (HAPPlatformRandomNumberDRBGNeedsReseed(&drbg)) {
+            uint8_t seed[kHAPPlatformRandomNumberDRBG_SeedBytes];
+            FillWithGetrandom(seed, sizeof seed);
+            HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+            HAPRawBufferZero(seed, sizeof seed);
+        }
+        HAPPlatformRandomNumberDRBGFill(&drbg, bytes, numBytes);
+    }
+    e = pthread_mutex_unlock(&drbgMutex);
+    HAPAssert(!e);
+}
+
+#else
+
+void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
+    FillWithGetrandom(bytes, numBytes);
+}
+
+#endif
@@ -15,6 +15,7 @@
 #include <sys/select.h>
 
 #include "HAPPlatform+Init.h"
+#include "HAPPlatformClock+Init.h"
 #include "HAPPlatformFileHandle.h"
 #include "HAPPlatformLog+Init.h"
 #include "HAPPlatformRunLoop+Init.h"
@@ -349,7 +350,7 @@ void HAPPlatformTimerDeregister(HAPPlatformTimerRef timer_) {
 
 static void ProcessExpiredTimers(void) {
     // Get current time.
-    HAPTime now = HAPPlatformClockGetCurrent();
+    HAPTime now = HAPPlatformClockGetCurrentCoarse();
 
     // Enumerate timers.
     while (runLoop.timers) {
@@ -614,6 +615,9 @@ void HAPPlatformRunLoopRun(void) {
             fileHandle = fileHandle->nextFileHandle;
         }
 
+        // Time passes while waiting. The coarse clock must be sampled again when the run loop wakes up.
+        HAPPlatformClockEndRunLoopIteration();
+
         struct timeval timeoutValue;
         struct timeval* timeout = NULL;
 
@@ -648,10 +652,13 @@ void HAPPlatformRunLoopRun(void) {
             HAPFatalError();
         }
 
+        HAPPlatformClockBeginRunLoopIteration();
+
         ProcessExpiredTimers();
 
         ProcessSelectedFileHandles(&readFileDescriptors, &writeFileDescriptors, &errorFileDescriptors);
     } while (runLoop.state == kHAPPlatformRunLoopState_Running);
+    HAPPlatformClockEndRunLoopIteration();
 
     HAPLogInfo(&logObject, "Exiting run loop.");
     HAPAssert(runLoop.state == kHAPPlatformRunLoopState_Stopping);
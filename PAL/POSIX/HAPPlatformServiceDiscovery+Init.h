@@ -11,11 +11,20 @@
 extern "C" {
 #endif
 
+#ifndef HAVE_EMBEDDED_MDNS
+#define HAVE_EMBEDDED_MDNS 0
+#endif
+
+#if !HAVE_EMBEDDED_MDNS
 #include <dns_sd.h>
+#endif
 #include <net/if.h>
 
 #include "HAPPlatform.h"
 #include "HAPPlatformFileHandle.h"
+#if HAVE_EMBEDDED_MDNS
+#include "HAPPlatformMDNSResponder.h"
+#endif
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull begin
@@ -24,6 +33,13 @@ extern "C" {
 /**@file
  * Bonjour service discovery for POSIX based on Apple's mDNSResponder.
  *
+ * If HAVE_EMBEDDED_MDNS is set, services are published by a built-in Multicast DNS responder that runs on the run
+ * loop instead (see HAPPlatformMDNSResponder.h). No mDNS daemon is required in that case.
+ * - The responder uses IPv4 multicast. If no interface name is set, the Multicast DNS group is joined on all
+ *   interfaces, but packets are sent on the default multicast interface.
+ * - For testing, the loopback interface may be selected after enabling multicast on it,
+ *   e.g. with "ip link set lo multicast on".
+ *
  * **Example**
 
    @code{.c}
@@ -65,9 +81,14 @@ struct HAPPlatformServiceDiscovery {
     /**@cond */
     char interfaceName[IFNAMSIZ];
 
+#if HAVE_EMBEDDED_MDNS
+    HAPPlatformMDNSResponder responder;
+    int fileDescriptor;
+#else
     DNSServiceRef dnsService;
     TXTRecordRef txtRecord;
     char txtRecordBuffer[kHAPPlatformServiceDiscovery_MaxTXTRecordBufferBytes];
+#endif
     HAPPlatformFileHandleRef fileHandle;
     /**@endcond */
 };
@@ -23,6 +23,9 @@ extern "C" {
 /**@file
  * TCP stream manager implementation for POSIX.
  *
+ * - Pending connections are accepted in bursts: all connections that are queued on the listener socket are accepted
+ *   in a single run loop iteration as long as TCP streams are available.
+ *
  * The following limitations apply if this code is not modified:
  * - Non-null values for the option interfaceName are ignored on platforms without support for the socket option
  *   SO_BINDTODEVICE which binds the socket to a particular network interface.
@@ -90,7 +93,7 @@ typedef struct {
 
 // Opaque type. Do not use directly.
 /**@cond */
-typedef struct {
+typedef struct HAPPlatformTCPStream {
     HAPPlatformTCPStreamManagerRef tcpStreamManager;
 
     int fileDescriptor;
@@ -98,6 +101,7 @@ typedef struct {
     HAPPlatformTCPStreamEvent interests;
     HAPPlatformTCPStreamEventCallback _Nullable callback;
     void* _Nullable context;
+    struct HAPPlatformTCPStream* _Nullable nextFreeTCPStream;
 } HAPPlatformTCPStream;
 /**@endcond */
 
@@ -117,6 +121,7 @@ struct HAPPlatformTCPStreamManager {
 
     HAPPlatformTCPStreamListener tcpStreamListener;
     HAPPlatformTCPStream* _Nullable tcpStreams;
+    HAPPlatformTCPStream* _Nullable freeTCPStreams;
     /**@endcond */
 };
 
@@ -4,6 +4,11 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
+// accept4 is a GNU extension.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <errno.h>
 #include <fcntl.h>
 #include <net/if.h>
@@ -51,6 +56,7 @@ static void InitializeTCPStream(HAPPlatformTCPStream* tcpStream) {
     tcpStream->interests.hasSpaceAvailable = false;
     tcpStream->callback = NULL;
     tcpStream->context = NULL;
+    tcpStream->nextFreeTCPStream = NULL;
 }
 
 HAP_RESULT_USE_CHECK
@@ -156,8 +162,12 @@ void HAPPlatformTCPStreamManagerCreate(
         HAPLogError(&logObject, "Allocating new TCP stream failed: out of memory.");
         HAPFatalError();
     }
-    for (size_t i = 0; i < tcpStreamManager->maxTCPStreams; i++) {
-        InitializeTCPStream(&tcpStreamManager->tcpStreams[i]);
+    tcpStreamManager->freeTCPStreams = NULL;
+    for (size_t i = tcpStreamManager->maxTCPStreams; i-- > 0;) {
+        HAPPlatformTCPStream* tcpStream = &tcpStreamManager->tcpStreams[i];
+        InitializeTCPStream(tcpStream);
+        tcpStream->nextFreeTCPStream = tcpStreamManager->freeTCPStreams;
+        tcpStreamManager->freeTCPStreams = tcpStream;
     }
 
     // Initialize signal handling.
@@ -235,6 +245,13 @@ void HAPPlatformTCPStreamManagerOpenListener(
         HAPFatalError();
     }
 
+    // The accept queue is drained until accept fails with EAGAIN, which must not block.
+    err = SetNonblocking(fileDescriptor);
+    if (err) {
+        HAPLogError(&logObject, "Failed to configure TCP stream listener socket as non-blocking.");
+        HAPFatalError();
+    }
+
     int v = 1;
     HAPLogBufferDebug(&logObject, &v, sizeof v, "setsockopt(%d, SOL_SOCKET, SO_REUSEADDR, <buffer>);", fileDescriptor);
     e = setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &v, sizeof v);
@@ -435,20 +452,24 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     HAPAssert(tcpStreamManager->numTCPStreams < tcpStreamManager->maxTCPStreams);
 
     // Find free TCP stream.
-    size_t i = 0;
-    while ((i < tcpStreamManager->maxTCPStreams) && (tcpStreamManager->tcpStreams[i].fileDescriptor != -1)) {
-        i++;
-    }
-    HAPAssert(i < tcpStreamManager->maxTCPStreams);
-
-    HAPPlatformTCPStream* tcpStream = &tcpStreamManager->tcpStreams[i];
+    HAPPlatformTCPStream* tcpStream = tcpStreamManager->freeTCPStreams;
+    HAPAssert(tcpStream);
 
     HAPAssert(!tcpStream->tcpStreamManager);
     HAPAssert(tcpStream->fileDescriptor == -1);
     HAPAssert(!tcpStream->fileHandle);
 
+#if defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+    HAPLogDebug(
+            &logObject,
+            "accept4(%d, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);",
+            tcpStreamManager->tcpStreamListener.fileDescriptor);
+    int fileDescriptor =
+            accept4(tcpStreamManager->tcpStreamListener.fileDescriptor, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
     HAPLogDebug(&logObject, "accept(%d, NULL, NULL);", tcpStreamManager->tcpStreamListener.fileDescriptor);
     int fileDescriptor = accept(tcpStreamManager->tcpStreamListener.fileDescriptor, NULL, NULL);
+#endif
     if (fileDescriptor == -1) {
         if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED && errno != EPROTO) {
             HAPPlatformLogPOSIXError(
@@ -468,11 +489,14 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     }
 
     // Configure socket.
-    int e = SetNonblocking(fileDescriptor);
+    int e;
+#if !defined(SOCK_NONBLOCK) || !defined(SOCK_CLOEXEC)
+    e = SetNonblocking(fileDescriptor);
     if (e != 0) {
         HAPLogError(&logObject, "Failed to configure TCP stream socket as non-blocking.");
         HAPFatalError();
     }
+#endif
     e = SetNodelay(fileDescriptor);
     if (e != 0) {
         HAPLogError(&logObject, "Failed to disable Nagle's algorithm for TCP stream socket.");
@@ -493,6 +517,9 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     }
     HAPAssert(fileHandle);
 
+    tcpStreamManager->freeTCPStreams = tcpStream->nextFreeTCPStream;
+    tcpStream->nextFreeTCPStream = NULL;
+
     tcpStream->tcpStreamManager = tcpStreamManager;
     tcpStream->fileDescriptor = fileDescriptor;
     tcpStream->fileHandle = fileHandle;
@@ -590,6 +617,8 @@ void HAPPlatformTCPStreamClose(HAPPlatformTCPStreamManagerRef tcpStreamManager,
     }
 
     InitializeTCPStream(tcpStream);
+    tcpStream->nextFreeTCPStream = tcpStreamManager->freeTCPStreams;
+    tcpStreamManager->freeTCPStreams = tcpStream;
 
     HAPAssert(tcpStreamManager->numTCPStreams <= tcpStreamManager->maxTCPStreams);
 
@@ -756,7 +785,17 @@ static void HandleTCPStreamListenerFileHandleCallback(
 
     HAPAssert(fileHandleEvents.isReadyForReading);
 
-    listener->callback(listener->tcpStreamManager, listener->context);
+    // Drain the accept queue so that a burst of connections does not need one run loop iteration per connection.
+    // Stop as soon as the delegate did not accept a TCP stream, e.g., because the accept queue is empty.
+    HAPPlatformTCPStreamManagerRef tcpStreamManager = listener->tcpStreamManager;
+    for (;;) {
+        size_t numTCPStreams = tcpStreamManager->numTCPStreams;
+        listener->callback(tcpStreamManager, listener->context);
+        if (listener->tcpStreamManager != tcpStreamManager || tcpStreamManager->numTCPStreams <= numTCPStreams ||
+            tcpStreamManager->numTCPStreams == tcpStreamManager->maxTCPStreams) {
+            break;
+        }
+    }
 }
 
 static void HandleTCPStreamFileHandleCallback(
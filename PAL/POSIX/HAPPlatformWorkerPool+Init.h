@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_WORKER_POOL_INIT_H
+#define HAP_PLATFORM_WORKER_POOL_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Worker pool implementation for POSIX.
+ *
+ * - Jobs are performed by a fixed number of threads. Completion callbacks are posted back to the run loop with
+ *   HAPPlatformRunLoopScheduleCallback.
+ *
+ * - The worker pool must be released after the run loop has stopped and before the run loop is released.
+ *
+ * **Example**
+
+   @code{.c}
+   // Allocate worker pool object.
+   static HAPPlatformWorkerPool workerPool;
+
+   // Initialize worker pool object.
+   HAPPlatformWorkerPoolCreate(&workerPool,
+       &(const HAPPlatformWorkerPoolOptions) {
+           // One thread is sufficient to keep the run loop responsive during pairing.
+           .numThreads = 1,
+
+           // One job per concurrent Pair Setup or Pair Verify procedure.
+           .maxJobs = kHAPIPSessionStorage_DefaultNumElements
+   });
+
+   // Provide the worker pool to the accessory server.
+   platform.hapPlatform.ip.workerPool = &workerPool;
+
+   @endcode
+ */
+
+/**
+ * Worker pool initialization options.
+ */
+typedef struct {
+    /**
+     * Number of worker threads.
+     */
+    size_t numThreads;
+
+    /**
+     * Maximum number of jobs that may be pending at the same time.
+     */
+    size_t maxJobs;
+} HAPPlatformWorkerPoolOptions;
+
+// Opaque type. Do not use directly.
+/**@cond */
+typedef struct HAPPlatformWorkerPoolJob {
+    HAPPlatformWorkerPoolRef workerPool;
+    HAPPlatformWorkerPoolWorkCallback work;
+    HAPPlatformWorkerPoolCompletionCallback completion;
+    size_t contextSize;
+    union {
+        uint64_t alignment;
+        void* _Nullable pointerAlignment;
+        uint8_t bytes[kHAPPlatformWorkerPool_MaxContextBytes];
+    } context;
+    struct HAPPlatformWorkerPoolJob* _Nullable nextJob;
+} HAPPlatformWorkerPoolJob;
+/**@endcond */
+
+/**
+ * Worker pool.
+ */
+struct HAPPlatformWorkerPool {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    bool isStopping;
+
+    pthread_t* _Nullable threads;
+    size_t numThreads;
+
+    HAPPlatformWorkerPoolJob* _Nullable jobs;
+    size_t maxJobs;
+    HAPPlatformWorkerPoolJob* _Nullable freeJobs;
+    HAPPlatformWorkerPoolJob* _Nullable pendingJobs;
+    HAPPlatformWorkerPoolJob* _Nullable lastPendingJob;
+    /**@endcond */
+};
+
+/**
+ * Initializes a worker pool and starts its worker threads.
+ *
+ * @param[out] workerPool           Pointer to an allocated but uninitialized HAPPlatformWorkerPool structure.
+ * @param      options              Initialization options.
+ */
+void HAPPlatformWorkerPoolCreate(HAPPlatformWorkerPoolRef workerPool, const HAPPlatformWorkerPoolOptions* options);
+
+/**
+ * Stops the worker threads and releases resources associated with an initialized worker pool.
+ *
+ * - Jobs that have not yet completed are discarded.
+ *
+ * @param      workerPool           Worker pool.
+ */
+void HAPPlatformWorkerPoolRelease(HAPPlatformWorkerPoolRef workerPool);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
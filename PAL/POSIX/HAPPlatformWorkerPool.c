@@ -0,0 +1,213 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <stdlib.h>
+
+#include "HAPPlatformWorkerPool+Init.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "WorkerPool" };
+
+static void LockWorkerPool(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    int e = pthread_mutex_lock(&workerPool->mutex);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_mutex_lock` failed (%d).", e);
+        HAPFatalError();
+    }
+}
+
+static void UnlockWorkerPool(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    int e = pthread_mutex_unlock(&workerPool->mutex);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_mutex_unlock` failed (%d).", e);
+        HAPFatalError();
+    }
+}
+
+/**
+ * Invokes the completion callback of a job on the run loop and returns the job slot to the worker pool.
+ *
+ * @param      context              Pointer to the job.
+ * @param      contextSize          Size of the pointer.
+ */
+static void HandleJobCompleted(void* _Nullable context, size_t contextSize) {
+    HAPPrecondition(context);
+    HAPPrecondition(contextSize == sizeof(HAPPlatformWorkerPoolJob*));
+    HAPPlatformWorkerPoolJob* job = *(HAPPlatformWorkerPoolJob* const*) context;
+    HAPPlatformWorkerPoolRef workerPool = job->workerPool;
+
+    job->completion(job->context.bytes, job->contextSize);
+    HAPRawBufferZero(job->context.bytes, job->contextSize);
+
+    LockWorkerPool(workerPool);
+    job->nextJob = workerPool->freeJobs;
+    workerPool->freeJobs = job;
+    UnlockWorkerPool(workerPool);
+}
+
+static void* _Nullable WorkerMain(void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformWorkerPoolRef workerPool = context;
+
+    HAPError err;
+
+    for (;;) {
+        LockWorkerPool(workerPool);
+        while (!workerPool->pendingJobs && !workerPool->isStopping) {
+            int e = pthread_cond_wait(&workerPool->condition, &workerPool->mutex);
+            if (e) {
+                HAPLogError(&logObject, "`pthread_cond_wait` failed (%d).", e);
+                HAPFatalError();
+            }
+        }
+        if (workerPool->isStopping) {
+            UnlockWorkerPool(workerPool);
+            break;
+        }
+        HAPPlatformWorkerPoolJob* job = HAPNonnull(workerPool->pendingJobs);
+        workerPool->pendingJobs = job->nextJob;
+        if (!workerPool->pendingJobs) {
+            workerPool->lastPendingJob = NULL;
+        }
+        job->nextJob = NULL;
+        UnlockWorkerPool(workerPool);
+
+        job->work(job->context.bytes, job->contextSize);
+
+        err = HAPPlatformRunLoopScheduleCallback(HandleJobCompleted, &job, sizeof job);
+        if (err) {
+            HAPLogError(&logObject, "Failed to post job completion to the run loop.");
+            HAPFatalError();
+        }
+    }
+
+    return NULL;
+}
+
+void HAPPlatformWorkerPoolCreate(HAPPlatformWorkerPoolRef workerPool, const HAPPlatformWorkerPoolOptions* options) {
+    HAPPrecondition(workerPool);
+    HAPPrecondition(options);
+    HAPPrecondition(options->numThreads);
+    HAPPrecondition(options->maxJobs);
+
+    HAPRawBufferZero(workerPool, sizeof *workerPool);
+
+    HAPLogDebug(&logObject, "Storage configuration: workerPool = %lu", (unsigned long) sizeof *workerPool);
+    HAPLogDebug(
+            &logObject,
+            "Storage configuration: jobs = %lu",
+            (unsigned long) (options->maxJobs * sizeof(HAPPlatformWorkerPoolJob)));
+
+    int e = pthread_mutex_init(&workerPool->mutex, /* attr: */ NULL);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_mutex_init` failed (%d).", e);
+        HAPFatalError();
+    }
+    e = pthread_cond_init(&workerPool->condition, /* attr: */ NULL);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_cond_init` failed (%d).", e);
+        HAPFatalError();
+    }
+
+    workerPool->jobs = calloc(options->maxJobs, sizeof(HAPPlatformWorkerPoolJob));
+    workerPool->threads = calloc(options->numThreads, sizeof(pthread_t));
+    if (!workerPool->jobs || !workerPool->threads) {
+        HAPLogError(&logObject, "Allocating worker pool failed: out of memory.");
+        HAPFatalError();
+    }
+    workerPool->maxJobs = options->maxJobs;
+    for (size_t i = workerPool->maxJobs; i-- > 0;) {
+        HAPPlatformWorkerPoolJob* job = &HAPNonnull(workerPool->jobs)[i];
+        job->workerPool = workerPool;
+        job->nextJob = workerPool->freeJobs;
+        workerPool->freeJobs = job;
+    }
+
+    for (size_t i = 0; i < options->numThreads; i++) {
+        e = pthread_create(&HAPNonnull(workerPool->threads)[i], /* attr: */ NULL, WorkerMain, workerPool);
+        if (e) {
+            HAPLogError(&logObject, "`pthread_create` failed to create worker thread (%d).", e);
+            HAPFatalError();
+        }
+        workerPool->numThreads++;
+    }
+}
+
+void HAPPlatformWorkerPoolRelease(HAPPlatformWorkerPoolRef workerPool) {
+    HAPPrecondition(workerPool);
+
+    LockWorkerPool(workerPool);
+    workerPool->isStopping = true;
+    int e = pthread_cond_broadcast(&workerPool->condition);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_cond_broadcast` failed (%d).", e);
+        HAPFatalError();
+    }
+    UnlockWorkerPool(workerPool);
+
+    for (size_t i = 0; i < workerPool->numThreads; i++) {
+        e = pthread_join(HAPNonnull(workerPool->threads)[i], /* value_ptr: */ NULL);
+        if (e) {
+            HAPLogError(&logObject, "`pthread_join` failed to join worker thread (%d).", e);
+            HAPFatalError();
+        }
+    }
+
+    (void) pthread_cond_destroy(&workerPool->condition);
+    (void) pthread_mutex_destroy(&workerPool->mutex);
+    if (workerPool->jobs) {
+        HAPRawBufferZero(HAPNonnull(workerPool->jobs), workerPool->maxJobs * sizeof(HAPPlatformWorkerPoolJob));
+        free(workerPool->jobs);
+    }
+    free(workerPool->threads);
+    HAPRawBufferZero(workerPool, sizeof *workerPool);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformWorkerPoolSubmit(
+        HAPPlatformWorkerPoolRef workerPool,
+        HAPPlatformWorkerPoolWorkCallback work,
+        HAPPlatformWorkerPoolCompletionCallback completion,
+        const void* context,
+        size_t contextSize) {
+    HAPPrecondition(workerPool);
+    HAPPrecondition(work);
+    HAPPrecondition(completion);
+    HAPPrecondition(context);
+    HAPPrecondition(contextSize <= kHAPPlatformWorkerPool_MaxContextBytes);
+
+    LockWorkerPool(workerPool);
+    HAPPlatformWorkerPoolJob* _Nullable job = workerPool->freeJobs;
+    if (!job) {
+        UnlockWorkerPool(workerPool);
+        HAPLog(&logObject, "No free job slot available.");
+        return kHAPError_OutOfResources;
+    }
+    workerPool->freeJobs = job->nextJob;
+
+    job->work = work;
+    job->completion = completion;
+    job->contextSize = contextSize;
+    HAPRawBufferCopyBytes(job->context.bytes, context, contextSize);
+    job->nextJob = NULL;
+    if (workerPool->lastPendingJob) {
+        HAPNonnull(workerPool->lastPendingJob)->nextJob = job;
+    } else {
+        workerPool->pendingJobs = job;
+    }
+    workerPool->lastPendingJob = job;
+
+    int e = pthread_cond_signal(&workerPool->condition);
+    if (e) {
+        HAPLogError(&logObject, "`pthread_cond_signal` failed (%d).", e);
+        HAPFatalError();
+    }
+    UnlockWorkerPool(workerPool);
+    return kHAPError_None;
+}
@@ -0,0 +1,275 @@
+/*
+ * GRM_Audio.c / Raspi
+ *
+ * All clips are decoded into RAM once by GRM_AudioStart(). A single long-lived playback thread takes requests
+ * from a small queue and keeps the audio device open, so a ring only scales the cached samples and hands them to libao.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <math.h>
+
+#include <ao/ao.h>
+#include <sndfile.h>
+
+#include "HAP.h"
+#include "GRM_Audio.h"
+
+#define BUFFER_SIZE 8192
+#define MAX_CLIPS 8
+#define MAX_CLIP_SECONDS 60
+
+static struct {
+	short *samples; // interleaved, 16 bit, full volume
+	size_t numSamples;
+	int channels;
+	int rate;
+} clips[MAX_CLIPS];
+static int numClips;
+
+#define AUDIO_QUEUE_SIZE 4
+
+typedef struct {
+	int clip;
+	int32_t gain; // Q15 fixed point, 0 ... 32768
+	struct timespec triggerTime;
+} audioRequest_t;
+
+static struct {
+	audioRequest_t requests[AUDIO_QUEUE_SIZE];
+	int head;
+	int count;
+	bool playing;
+	bool stop;
+	long lastLatencyUs;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond; // signalled when a request is queued or the thread is stopped
+	pthread_cond_t idle; // signalled when a request has been played
+} audioQueue = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER, .idle = PTHREAD_COND_INITIALIZER};
+
+static pthread_t audioThread;
+static bool audioThreadStarted;
+static char audioDriver[32];
+
+static bool loadClip(int clip, const char * file) {
+	SF_INFO sfinfo;
+	memset(&sfinfo, 0, sizeof sfinfo);
+
+	SNDFILE *sndfile = sf_open(file, SFM_READ, &sfinfo);
+	if (sndfile == NULL) {
+		HAPLogInfo(&kHAPLog_Default, "%s: Error opening %s.", __func__, file);
+		return false;
+	}
+	if (sfinfo.channels <= 0 || sfinfo.samplerate <= 0 || sfinfo.frames <= 0
+			|| sfinfo.frames > (sf_count_t) sfinfo.samplerate * MAX_CLIP_SECONDS) {
+		HAPLogInfo(&kHAPLog_Default, "%s: Unsupported clip %s.", __func__, file);
+		sf_close(sndfile);
+		return false;
+	}
+
+	// libsndfile converts any sample format to 16 bit on reading
+	size_t numSamples = (size_t) sfinfo.frames * (size_t) sfinfo.channels;
+	short *samples = malloc(numSamples * sizeof(short));
+	if (samples == NULL) {
+		HAPLogInfo(&kHAPLog_Default, "%s: Out of memory for %s.", __func__, file);
+		sf_close(sndfile);
+		return false;
+	}
+	sf_count_t read = sf_read_short(sndfile, samples, (sf_count_t) numSamples);
+	sf_close(sndfile);
+
+	clips[clip].samples = samples;
+	clips[clip].numSamples = read > 0 ? (size_t) read : 0;
+	clips[clip].channels = sfinfo.channels;
+	clips[clip].rate = sfinfo.samplerate;
+
+	HAPLogInfo(&kHAPLog_Default, "%s: %s: %zu samples, %d channels, %d Hz", __func__, file,
+			clips[clip].numSamples, clips[clip].channels, clips[clip].rate);
+	return true;
+}
+
+static void unloadClips(void) {
+	for (int i = 0; i < numClips; i++) {
+		free(clips[i].samples);
+		memset(&clips[i], 0, sizeof clips[i]);
+	}
+	numClips = 0;
+}
+
+// gain is Q15 fixed point and at most 1.0, so the result never clips. Plain loop, so that it is auto-vectorized (NEON).
+static void scaleSamples(short * restrict out, const short * restrict in, size_t numSamples, int32_t gain) {
+	for (size_t i = 0; i < numSamples; i++) {
+		out[i] = (short) ((in[i] * gain + (1 << 14)) >> 15);
+	}
+}
+
+static int32_t gainFromVolume(float volume) {
+	if (volume <= 0)
+		return 0;
+	if (volume >= 1)
+		return 1 << 15;
+	return (int32_t) lroundf(volume * (1 << 15));
+}
+
+static long elapsedUs(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000 + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+static void* audioThreadFunction(void *ptr HAP_UNUSED) {
+	static short buffer[BUFFER_SIZE];
+	ao_device *device = NULL;
+	ao_sample_format format;
+	memset(&format, 0, sizeof format);
+
+	int driver = ao_driver_id(audioDriver);
+	if (driver < 0) {
+		HAPLogInfo(&kHAPLog_Default, "%s: Unknown audio driver %s.", __func__, audioDriver);
+	}
+
+	for (;;) {
+		pthread_mutex_lock(&audioQueue.mutex);
+		while (!audioQueue.count && !audioQueue.stop) {
+			pthread_cond_wait(&audioQueue.cond, &audioQueue.mutex);
+		}
+		if (audioQueue.stop) {
+			pthread_mutex_unlock(&audioQueue.mutex);
+			break;
+		}
+		audioRequest_t request = audioQueue.requests[audioQueue.head];
+		audioQueue.head = (audioQueue.head + 1) % AUDIO_QUEUE_SIZE;
+		audioQueue.count--;
+		audioQueue.playing = true;
+		pthread_mutex_unlock(&audioQueue.mutex);
+
+		const short *samples = clips[request.clip].samples;
+		size_t numSamples = clips[request.clip].numSamples;
+		long latencyUs = -1;
+
+		// the device stays open between clips, it is only reopened if the sample format changes
+		if (device != NULL && (format.channels != clips[request.clip].channels || format.rate != clips[request.clip].rate)) {
+			ao_close(device);
+			device = NULL;
+		}
+		if (device == NULL && samples != NULL && driver >= 0) {
+			format.bits = 16;
+			format.channels = clips[request.clip].channels;
+			format.rate = clips[request.clip].rate;
+			format.byte_format = AO_FMT_NATIVE;
+			format.matrix = 0;
+			device = ao_open_live(driver, &format, NULL); // use default audio, setup alsa for dmix and mono!
+			if (device == NULL) {
+				HAPLogInfo(&kHAPLog_Default, "%s: Error opening device.", __func__);
+			}
+		}
+
+		if (device != NULL) {
+			size_t n;
+			for (size_t offset = 0; offset < numSamples; offset += n) {
+				n = numSamples - offset < BUFFER_SIZE ? numSamples - offset : BUFFER_SIZE;
+				scaleSamples(buffer, &samples[offset], n, request.gain);
+				if (ao_play(device, (char *) buffer, (uint_32) (n * sizeof(short))) == 0) {
+					HAPLogInfo(&kHAPLog_Default, "%s: ao_play: failed.", __func__);
+					ao_close(device);
+					device = NULL;
+					break;
+				}
+				if (offset == 0) {
+					latencyUs = elapsedUs(&request.triggerTime);
+					HAPLogInfo(&kHAPLog_Default, "%s: latency from trigger to first buffer = %ld us", __func__,
+							latencyUs);
+				}
+			}
+		}
+
+		pthread_mutex_lock(&audioQueue.mutex);
+		audioQueue.playing = false;
+		audioQueue.lastLatencyUs = latencyUs;
+		pthread_cond_broadcast(&audioQueue.idle);
+		pthread_mutex_unlock(&audioQueue.mutex);
+	}
+
+	if (device != NULL)
+		ao_close(device);
+	return NULL;
+}
+
+bool GRM_AudioStart(const char * driver, const char * const * files, int count) {
+	HAPPrecondition(!audioThreadStarted);
+	HAPPrecondition(count >= 0 && count <= MAX_CLIPS);
+
+	ao_initialize();
+
+	snprintf(audioDriver, sizeof audioDriver, "%s", driver);
+	numClips = count;
+	for (int i = 0; i < numClips; i++) {
+		loadClip(i, files[i]);
+	}
+
+	audioQueue.head = 0;
+	audioQueue.count = 0;
+	audioQueue.stop = false;
+	audioQueue.lastLatencyUs = -1;
+	int result = pthread_create(&audioThread, NULL, audioThreadFunction, NULL);
+	if (result) {
+		HAPLogInfo(&kHAPLog_Default, "%s: Error - pthread_create(audioThreadFunction) return code: %d", __func__, result);
+		return false;
+	}
+	audioThreadStarted = true;
+	return true;
+}
+
+void GRM_AudioStop(void) {
+	if (audioThreadStarted) {
+		pthread_mutex_lock(&audioQueue.mutex);
+		audioQueue.stop = true;
+		pthread_cond_signal(&audioQueue.cond);
+		pthread_mutex_unlock(&audioQueue.mutex);
+		pthread_join(audioThread, NULL);
+		audioThreadStarted = false;
+	}
+
+	unloadClips();
+	ao_shutdown();
+}
+
+bool GRM_AudioPlay(int clip, float volume, bool skipIfBusy, const struct timespec * triggerTime) {
+	HAPPrecondition(clip >= 0 && clip < numClips);
+	HAPPrecondition(triggerTime);
+
+	pthread_mutex_lock(&audioQueue.mutex);
+
+	bool busy = audioQueue.playing || audioQueue.count > 0;
+	if (!audioThreadStarted || (skipIfBusy && busy) || audioQueue.count == AUDIO_QUEUE_SIZE) {
+		pthread_mutex_unlock(&audioQueue.mutex);
+		return false;
+	}
+
+	audioRequest_t *request = &audioQueue.requests[(audioQueue.head + audioQueue.count) % AUDIO_QUEUE_SIZE];
+	request->clip = clip;
+	request->gain = gainFromVolume(volume);
+	request->triggerTime = *triggerTime;
+	audioQueue.count++;
+	pthread_cond_signal(&audioQueue.cond);
+
+	pthread_mutex_unlock(&audioQueue.mutex);
+	return true;
+}
+
+void GRM_AudioWaitIdle(void) {
+	pthread_mutex_lock(&audioQueue.mutex);
+	while (audioThreadStarted && (audioQueue.playing || audioQueue.count > 0)) {
+		pthread_cond_wait(&audioQueue.idle, &audioQueue.mutex);
+	}
+	pthread_mutex_unlock(&audioQueue.mutex);
+}
+
+long GRM_AudioGetLastLatencyUs(void) {
+	pthread_mutex_lock(&audioQueue.mutex);
+	long latencyUs = audioQueue.lastLatencyUs;
+	pthread_mutex_unlock(&audioQueue.mutex);
+	return latencyUs;
+}
@@ -0,0 +1,45 @@
+/*
+ * GRM_Audio.h / Raspi
+ *
+ * Cached audio clips, played from a persistent thread through libao.
+ */
+
+#ifndef RASPI_GRM_AUDIO_H_
+#define RASPI_GRM_AUDIO_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+/*
+ * Decodes all clips into RAM and starts the playback thread.
+ * driver is the name of the libao driver, e.g. "alsa", or "null" to play without audio hardware.
+ * Clips that cannot be decoded are skipped when played.
+ * Returns false if the playback thread cannot be started.
+ */
+bool GRM_AudioStart(const char * driver, const char * const * files, int count);
+
+/*
+ * Stops the playback thread and frees the decoded clips.
+ */
+void GRM_AudioStop(void);
+
+/*
+ * Queues a clip for playback at a volume of 0 ... 1.
+ * triggerTime is the CLOCK_MONOTONIC time of the event that caused the playback, for latency measurements.
+ * If skipIfBusy is set, the clip is not queued while audio is still playing.
+ * Returns false if the clip was not queued.
+ */
+bool GRM_AudioPlay(int clip, float volume, bool skipIfBusy, const struct timespec * triggerTime);
+
+/*
+ * Waits until all queued clips have been played.
+ */
+void GRM_AudioWaitIdle(void);
+
+/*
+ * Returns the latency from trigger to the first buffer played by libao of the most recently played clip in us,
+ * or -1 if no clip has been played yet.
+ */
+long GRM_AudioGetLastLatencyUs(void);
+
+#endif /* RASPI_GRM_AUDIO_H_ */
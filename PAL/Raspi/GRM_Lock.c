@@ -7,10 +7,12 @@
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <sys/time.h> // gettimeofday
+#include <time.h> // clock_gettime
 #include <unistd.h>
 #include <stdio.h>
 #include <termios.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <string.h> // strcmp
 
@@ -19,13 +21,11 @@
 
 // for GPIO:
 #include <wiringPi.h>
+#include "HAPPlatformGPIOLine.h"
 
 // for audio playback:
-#include <math.h>
-#define BUFFER_SIZE 8192
-#include <ao/ao.h>
-#include <sndfile.h>
 #include <signal.h>
+#include "GRM_Audio.h"
 static uint8_t vol;
 
 
@@ -39,13 +39,16 @@ static uint8_t vol;
 	
 	/usr/bin/gpio -g mode 20 tri
 	/usr/bin/gpio export 21 out
+
+	GPIO 20 is requested through the GPIO character device, so it must not be exported via sysfs.
 */
 
 static const int opener = 21; // == 29 in wPi numbering
 static const int trigger = 20;
-static const char * unlocked = "/var/www/dooropener/unlocked.wav";
-static const char * doorbell = "/var/www/dooropener/doorbell.wav";
-static const char * locked = "/var/www/dooropener/locked.wav";
+static const char * gpioChip = "/dev/gpiochip0";
+static HAPTime debounceMs = 0; // optional software debounce, on top of the RC circuit
+static HAPPlatformGPIOLine triggerLine;
+static bool triggerLineCreated;
 
 bool block = false;
 static pthread_mutex_t blockMutex = PTHREAD_MUTEX_INITIALIZER;
@@ -129,143 +132,60 @@ void pulse(void) {
 	pthread_create(&pulseThread, &attr, pulseFunction, (void*) "pulse thread started.");
 }
 
-static void clean(ao_device *device, SNDFILE *file) {
-	ao_close(device);
-	sf_close(file);
-	ao_shutdown();
-}
-
-int playAudio(char * filename, float volume) {
-	ao_device *device;
-	ao_sample_format format;
-	SF_INFO sfinfo;
-
-	int default_driver;
-
-	short *buffer;
-
-	SNDFILE *file = sf_open(filename, SFM_READ, &sfinfo);
-
-	//   printf("Samples: %lld\n", sfinfo.frames);
-	//   printf("Sample rate: %d\n", sfinfo.samplerate);
-	//   printf("Channels: %d\n", sfinfo.channels);
-
-	ao_initialize();
-
-	default_driver = ao_driver_id("alsa");
-	//= ao_default_driver_id();
-
-	switch (sfinfo.format & SF_FORMAT_SUBMASK) {
-	case SF_FORMAT_PCM_16:
-		format.bits = 16;
-		break;
-	case SF_FORMAT_PCM_24:
-		format.bits = 24;
-		break;
-	case SF_FORMAT_PCM_32:
-		format.bits = 32;
-		break;
-	case SF_FORMAT_PCM_S8:
-		format.bits = 8;
-		break;
-	case SF_FORMAT_PCM_U8:
-		format.bits = 8;
-		break;
-	default:
-		format.bits = 16;
-		break;
-	}
-
-	format.channels = sfinfo.channels;
-	format.rate = sfinfo.samplerate;
-	format.byte_format = AO_FMT_NATIVE;
-	format.matrix = 0;
-
-	//struct ao_option option = {.key="id", .value="1", .next=NULL}; // optionally choose audio driver
-
-	device = ao_open_live(default_driver, &format, NULL/*&option*/); // use default audio, setup alsa for dmix and mono!
-
-	if (device == NULL) {
-		HAPLogInfo(&kHAPLog_Default, "%s: Error opening device.", __func__);	
-		return 1;
-	}
-
-	buffer = calloc(BUFFER_SIZE, sizeof(short));
-	long int read = 1;
-	while (read != 0) {
-		read = sf_read_short(file, buffer, BUFFER_SIZE);
-
-		// adjust volume
-		for (long int i = 0; i < BUFFER_SIZE; i++) {
-			long int sample = lroundf(buffer[i] * volume);
-			if (sample > SHRT_MAX)
-				sample = SHRT_MAX; // clip at max. volume
-			if (sample < SHRT_MIN)
-				sample = SHRT_MIN;
-			buffer[i] = sample;
-		}
-		// end of volume adjustment
+/*
+ * AUDIO:
+ * Clips are cached and played by GRM_Audio.c. The libao driver can be selected with "audioDriver" in the
+ * configuration file; "null" allows measuring the latency from trigger to first buffer without audio hardware.
+ */
 
-		if (ao_play(device, (char *) buffer, (uint_32) (read * sizeof(short)))
-				== 0) {
-			HAPLogInfo(&kHAPLog_Default, "%s: ao_play: failed.", __func__);	
-			clean(device, file);
-			break;
-		}
-	}
+typedef enum {CLIP_DOORBELL, CLIP_UNLOCKED, CLIP_LOCKED, CLIP_COUNT} clip_t;
 
-	clean(device, file);
+static const char * clipFiles[CLIP_COUNT] = {
+	[CLIP_DOORBELL] = "/var/www/dooropener/doorbell.wav",
+	[CLIP_UNLOCKED] = "/var/www/dooropener/unlocked.wav",
+	[CLIP_LOCKED] = "/var/www/dooropener/locked.wav"
+};
 
-	return 0;
-}
+static char audioDriver[32] = "alsa";
 
-void * playAudioThread(void *ptr) {
-	static bool playing;
+/*
+ * Queues a clip for playback. A doorbell is ignored while audio is still playing, so that rings do not pile up.
+ * Feedback clips are queued behind it. Called on the run loop.
+ */
+static void playClip(clip_t clip) {
 	const float lowVolume = 1. / 2.; //1./8.;
 	const float maxVolume = 1.0;
 	static float volume = 1. / 2.; // start very soft
-	static struct timeval timeStart, timeEnd;
+	static struct timespec timeStart;
+
+	struct timespec triggerTime;
+	clock_gettime(CLOCK_MONOTONIC, &triggerTime);
 
 	pthread_mutex_lock(&blockMutex);
 	float relativeVolume = ((float) vol)/100.0;
 	pthread_mutex_unlock(&blockMutex);
 
-
-	gettimeofday(&timeEnd, NULL);
-	long ms = ((timeEnd.tv_sec - timeStart.tv_sec) * 1000
-			+ (timeEnd.tv_usec - timeStart.tv_usec) / 1000);
-	if (ms > 10000)
+	long dt = (triggerTime.tv_sec - timeStart.tv_sec) * 1000 + (triggerTime.tv_nsec - timeStart.tv_nsec) / 1000000;
+	if (dt > 10000)
 		volume = lowVolume; // if there is a pause of 10s, reset volume to low
+	timeStart = triggerTime;
 
-	gettimeofday(&timeStart, NULL);
-
-	if (!playing) { // with a mutex, other calls would be kind of queued, this way, they return immediately
-		playing = true;
-		
-		if (strcmp((char*) ptr, unlocked) == 0
-				|| strcmp((char*) ptr, locked) == 0){
-			volume = maxVolume; // alway play the "Unlocked" sound at this volume
-		}
-		
-		HAPLogInfo(&kHAPLog_Default, "%s: volume = %u", __func__, (unsigned) (volume * relativeVolume * 100));	
-
-		playAudio((char*) ptr, volume * relativeVolume); // weighted with global volume
-		if (strcmp((char*) ptr, unlocked) == 0
-				|| strcmp((char*) ptr, locked) == 0){
-			volume = lowVolume; // after "Unlocked" start over at this volume
-		}
-		
-		playing = false;
-
-		if (volume < maxVolume)
-			volume *= 2.0; // double the volume at every step
-		else
-			volume = maxVolume; // but limit to maximum
-	} else {
-		HAPLogInfo(&kHAPLog_Default, "%s: IGNORING - audio still playing", __func__);	
-	} 
+	bool feedback = clip == CLIP_UNLOCKED || clip == CLIP_LOCKED;
+	float clipVolume = feedback ? maxVolume : volume; // alway play the "Unlocked" sound at this volume
 
-	return NULL;
+	// weighted with global volume
+	if (!GRM_AudioPlay(clip, clipVolume * relativeVolume, clip == CLIP_DOORBELL, &triggerTime)) {
+		HAPLogInfo(&kHAPLog_Default, "%s: IGNORING - audio still playing", __func__);
+		return;
+	}
+	HAPLogInfo(&kHAPLog_Default, "%s: volume = %u", __func__, (unsigned) (clipVolume * relativeVolume * 100));
+
+	if (feedback)
+		volume = lowVolume; // after "Unlocked" start over at this volume
+	else if (volume < maxVolume)
+		volume *= 2.0; // double the volume at every step
+	else
+		volume = maxVolume; // but limit to maximum
 }
 
 
@@ -290,6 +210,7 @@ void sendPushNotification(const char * push_message) {
 	HAPLogInfo(&kHAPLog_Default, "%s: DEPRECATED - Push: %s", __func__, push_message);
 }
 
+// called on the run loop
 void ringBell2(long pressTimeMs) {
 
 	(void) pressTimeMs; // unused, suppress warning
@@ -297,8 +218,7 @@ void ringBell2(long pressTimeMs) {
 
 	HAPLogInfo(&kHAPLog_Default, "%s: DING-DONG", __func__);
 	
-	HAPError err = HAPPlatformRunLoopScheduleCallback(ringBell, NULL, 0); // required for IRQ/threads, but not for timers
-	HAPLogInfo(&kHAPLog_Default, "%s: RING triggered with error = %u", __func__, err);
+	ringBell(NULL, 0);
 
 	static struct timeval timeStart, timeEnd;
 	gettimeofday(&timeEnd, NULL);
@@ -312,14 +232,7 @@ void ringBell2(long pressTimeMs) {
 	// but log them all
 	logEvent(EVENT_BELL);
 
-	pthread_t audioThread;
-	int result = pthread_create(&audioThread, NULL, playAudioThread,
-			(void*) doorbell);
-	if (result) {
-		HAPLogInfo(&kHAPLog_Default, "%s: Error - pthread_create(playAudioThread) return code: %d", __func__, result);
-	} else{
-		pthread_detach(audioThread);
-	}
+	playClip(CLIP_DOORBELL);
 }
 
 /*
@@ -338,14 +251,7 @@ void puzzleSolved(void){
 	pthread_mutex_unlock(&blockMutex);
 	if (b) {
 		HAPLogInfo(&kHAPLog_Default, "%s: LOCKED!", __func__);
-		pthread_t audioThread;
-		int result = pthread_create(&audioThread, NULL, playAudioThread,
-				(void*) locked);
-		if (result) {
-			HAPLogInfo(&kHAPLog_Default, "%s: Error - pthread_create(playAudioThread, locked) return code: %d", __func__, result);
-		} else{
-			pthread_detach(audioThread);
-		}
+		playClip(CLIP_LOCKED);
 
 		sendPushNotification(
 				"Das Klingelzeichen war korrekt, aber die Haustür ist verriegelt.");
@@ -353,14 +259,7 @@ void puzzleSolved(void){
 
 	} else {
 		HAPLogInfo(&kHAPLog_Default, "%s: UNLOCKED!", __func__);
-		pthread_t audioThread;
-		int result = pthread_create(&audioThread, NULL, playAudioThread,
-				(void*) unlocked);
-		if (result) {
-			HAPLogInfo(&kHAPLog_Default, "%s: Error - pthread_create(playAudioThread, unlocked) return code: %d", __func__, result);
-		} else{
-			pthread_detach(audioThread);
-		}
+		playClip(CLIP_UNLOCKED);
 
 		sendPushNotification(
 				"Die Haustür wurde per Klingelzeichen entriegelt.");
@@ -370,23 +269,19 @@ void puzzleSolved(void){
 
 
 
-void decodePattern(bool press) { // call for press (true) and release (false) of bell button
-	static struct timeval timeStart, timeEnd;
-
+void decodePattern(bool press, uint64_t timestamp) { // call for press (true) and release (false) of bell button, with the kernel timestamp of the edge in ns
+	static uint64_t timeStart;
 
-	gettimeofday(&timeEnd, NULL);
-	long pressTimeMs = ((timeEnd.tv_sec - timeStart.tv_sec) * 1000
-			+ (timeEnd.tv_usec - timeStart.tv_usec) / 1000);
-	timeStart = timeEnd;
+	long pressTimeMs = (long) ((int64_t) (timestamp - timeStart) / 1000000);
+	timeStart = timestamp;
 
 	HAPLogInfo(&kHAPLog_Default, "%s: %s time was = %ld ms = ", __func__, (!press ? "press" : "release"),
 			pressTimeMs); // !press, because we lag behind
 			
 	// NOTE: first value of pressTimeMs (after startup or long idle time) can be anything (even overflow to negative), but it is ignored in the state machine
 
-	/* NEED TO DEBOUNCE! And need to distinguish falling and rising IRQs properly.
-	 * Reading the input at the beginning of the ISR may be too slow, i.e. the level is no longer the one that triggered the IRQ.
-	 * Possible workaround: use two inputs in parallel, one for rising, another one for falling edge detection. */
+	/* The direction of the edge is reported by the kernel together with the event, so the input is no longer read after the fact.
+	 * Additional debouncing can be configured with "debounceMs". */
 
 
 	bool isAny = (pressTimeMs <= anyMax) && (pressTimeMs >= anyMin); // upper limit anyMax ensures that no state is kept forever: when anyMax is exceeded when expecting ANY duration, the next press/release event leads to the RING state
@@ -466,12 +361,12 @@ void decodePattern(bool press) { // call for press (true) and release (false) of
 }
 
 
-void risingISR(void) {
-	HAPLogInfo(&kHAPLog_Default, "%s: rising IRQ / button released", __func__);	
+void risingEdge(void) {
+	HAPLogInfo(&kHAPLog_Default, "%s: rising edge / button released", __func__);	
 }
 
-void fallingISR(void) {
-	HAPLogInfo(&kHAPLog_Default, "%s: falling IRQ / button pressed", __func__);	
+void fallingEdge(void) {
+	HAPLogInfo(&kHAPLog_Default, "%s: falling edge / button pressed", __func__);	
 }
 
 /*
@@ -481,30 +376,19 @@ void fallingISR(void) {
  * https://www.raspberrypi.org/forums/viewtopic.php?f=28&t=134394
  * suggests, that the inputs are not Schmidt-Trigger type, so my simple debouncing circuit is probably not good enough (and has too much capacity).
  *
- * Nevertheless, with 1uF and 6k6 it *used* to work, but after integrating it into main board, it no longer does, unless I am additionally ignoring certain edges in software (see below).
+ * Nevertheless, with 1uF and 6k6 it *used* to work, but after integrating it into main board, it no longer does, unless I am additionally ignoring certain edges in software.
+ * Edges that do not change the level (falling-falling and rising-rising) are ignored by HAPPlatformGPIOLine. Edges within "debounceMs" of the previous edge are deferred until "debounceMs" has elapsed, and dropped if the level returns in the meantime.
  * Turned off internal pullup (in gpio config via startup script) because it raises the input pin level. External pullup should be enough.
  */
 
-void dispatchISR(void) {
-	static bool last;
-	static bool init = true;
-
-	bool current;
-	current = digitalRead(trigger);
-
-	if ((current != last) || init) { // only accept consecutive edges of different direction
-		if (current)
-			risingISR();
-		else
-			fallingISR();
-			
-		decodePattern(!current);
-	}
-	else { // ignore falling-falling and rising-rising
+// called on the run loop for each edge of the trigger input
+static void handleTriggerEdge(HAPPlatformGPIOLine* line HAP_UNUSED, bool current, uint64_t timestamp, void* context HAP_UNUSED) {
+	if (current)
+		risingEdge();
+	else
+		fallingEdge();
 
-	}
-	last = current;
-	init = false;
+	decodePattern(!current, timestamp);
 }
 
 
@@ -584,6 +468,10 @@ static int getKeyPress(void) {
 
 volatile bool stopThreads = false;
 
+static void ringBellFromKeyboard(void* _Nullable context HAP_UNUSED, size_t contextSize HAP_UNUSED) {
+	ringBell2(0);
+}
+
 static pthread_t mainThread;
 static void* mainFunction(void *ptr) {
 
@@ -595,7 +483,8 @@ static void* mainFunction(void *ptr) {
 
 		int c = getKeyPress(); // blocking!
 		if (c =='r'){ // ring
-		 	ringBell2(0);
+			HAPError err = HAPPlatformRunLoopScheduleCallback(ringBellFromKeyboard, NULL, 0);
+			HAPLogInfo(&kHAPLog_Default, "%s: RING triggered with error = %u", __func__, err);
 		} else if (c == 'c') { // code
 			puzzleSolved();
 		}
@@ -642,6 +531,19 @@ void GRM_ReadConfiguration(char * ptrValue){
 	veryLongMax = json_object_get_int(timeMinMax);
 	HAPLogInfo(&kHAPLog_Default, "veryLong = %ld ... %ld", veryLongMin, veryLongMax);
 
+	struct json_object *debounce;
+	if (json_object_object_get_ex(jobj, "debounceMs", &debounce)) { // optional
+		int value = json_object_get_int(debounce);
+		debounceMs = value > 0 ? (HAPTime) value : 0;
+	}
+	HAPLogInfo(&kHAPLog_Default, "debounceMs = %lu", (unsigned long) debounceMs);
+
+	struct json_object *driver;
+	if (json_object_object_get_ex(jobj, "audioDriver", &driver)) { // optional, e.g. "null" for testing without audio hardware
+		snprintf(audioDriver, sizeof audioDriver, "%s", json_object_get_string(driver));
+	}
+	HAPLogInfo(&kHAPLog_Default, "audioDriver = %s", audioDriver);
+
 	struct json_object *codeArray, *codeEntry;
 	json_object_object_get_ex(jobj, "code", &codeArray);
 	codeLength = json_object_array_length(codeArray);
@@ -664,10 +566,25 @@ void GRM_Inititalize(HAPAccessoryServerOptions* hapAccessoryServerOptions HAP_UN
         HAPAccessoryServerCallbacks* hapAccessoryServerCallbacks HAP_UNUSED){
 
 	wiringPiSetupSys(); // gpio export 21 out
-	wiringPiISR(trigger, INT_EDGE_BOTH, dispatchISR); // actually, this is a pthread!
+
+	// edges of the trigger input are delivered on the run loop, with kernel timestamps
+	HAPError err = HAPPlatformGPIOLineCreate(&triggerLine, &(const HAPPlatformGPIOLineOptions) {
+		.chipPath = gpioChip,
+		.lineOffset = (uint32_t) trigger,
+		.consumerLabel = "doorbell",
+		.debounceDuration = debounceMs * HAPMillisecond,
+		.callback = handleTriggerEdge
+	});
+	if (err) {
+		HAPLogError(&kHAPLog_Default, "%s: Cannot request events for GPIO %d on %s.", __func__, trigger, gpioChip);
+	} else {
+		triggerLineCreated = true;
+	}
 
 	GRM_Lock(); // make sure it is locked initially
 
+	GRM_AudioStart(audioDriver, clipFiles, CLIP_COUNT); // decode all clips once and start the playback thread
+
 #if CONSOLE_CONTROL
 	int result = pthread_create(&mainThread, NULL, mainFunction, (void*) "Main thread started.");
 	(void ) result;
@@ -683,4 +600,10 @@ void GRM_Deinititalize(void){
 	pthread_join(mainThread, NULL);
 #endif
 
+	GRM_AudioStop();
+
+	if (triggerLineCreated) {
+		HAPPlatformGPIOLineRelease(&triggerLine);
+		triggerLineCreated = false;
+	}
 }
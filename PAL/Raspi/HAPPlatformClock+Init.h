@@ -0,0 +1,43 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_CLOCK_INIT_H
+#define HAP_PLATFORM_CLOCK_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Samples the clock when the run loop wakes up.
+ *
+ * - Until HAPPlatformClockEndRunLoopIteration is called, HAPPlatformClockGetCurrentCoarse returns the time that was
+ *   last returned by HAPPlatformClockGetCurrent instead of reading the clock again.
+ */
+void HAPPlatformClockBeginRunLoopIteration(void);
+
+/**
+ * Marks the end of a run loop iteration, e.g., before the run loop waits for events.
+ *
+ * - HAPPlatformClockGetCurrentCoarse reads the clock until the next call to HAPPlatformClockBeginRunLoopIteration.
+ */
+void HAPPlatformClockEndRunLoopIteration(void);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,14 +9,20 @@
 #include <time.h>
 
 #include "HAPPlatform.h"
+#include "HAPPlatformClock+Init.h"
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "Clock" };
 
+/** Time that was last returned by HAPPlatformClockGetCurrent. */
+static HAPTime previousNow;
+
+/** Whether a run loop iteration is in progress and HAPPlatformClockGetCurrentCoarse may return previousNow. */
+static bool isRunLoopIterationActive;
+
 HAPTime HAPPlatformClockGetCurrent(void) {
     int e;
 
     static bool isInitialized;
-    static HAPTime previousNow;
 
     // Get current time.
     HAPTime now;
@@ -81,3 +87,19 @@ HAPTime HAPPlatformClockGetCurrent(void) {
     previousNow = now;
     return now;
 }
+
+HAPTime HAPPlatformClockGetCurrentCoarse(void) {
+    if (!isRunLoopIterationActive) {
+        return HAPPlatformClockGetCurrent();
+    }
+    return previousNow;
+}
+
+void HAPPlatformClockBeginRunLoopIteration(void) {
+    (void) HAPPlatformClockGetCurrent();
+    isRunLoopIterationActive = true;
+}
+
+void HAPPlatformClockEndRunLoopIteration(void) {
+    isRunLoopIterationActive = false;
+}
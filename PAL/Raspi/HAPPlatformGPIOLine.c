@@ -0,0 +1 @@
+../POSIX/HAPPlatformGPIOLine.c
\ No newline at end of file
@@ -0,0 +1 @@
+../POSIX/HAPPlatformGPIOLine.h
\ No newline at end of file
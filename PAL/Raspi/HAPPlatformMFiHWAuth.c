@@ -40,6 +40,61 @@ static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem,
 // Raspberry-Pi I2C Port
 #define kHAPPlatformMFiHWAuth_I2CPort "/dev/i2c-1"
 
+/**
+ * Maps the result of an I2C transfer to an I2C device result.
+ *
+ * @param      n                    Return value of read / write.
+ * @param      numBytes             Number of bytes that were to be transferred.
+ *
+ * @return kHAPError_None           If the transfer has been acknowledged.
+ * @return kHAPError_Busy           If the transfer has not been acknowledged and should be retried.
+ * @return kHAPError_Unknown        If the transfer failed permanently.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError GetTransferResult(ssize_t n, size_t numBytes) {
+    if (n == (ssize_t) numBytes) {
+        return kHAPError_None;
+    }
+    if (n == -1) {
+        int _errno = errno;
+        if (_errno == EBADF) {
+            HAPLogError(&logObject, "I2C transfer failed: %d.", _errno);
+            return kHAPError_Unknown;
+        }
+    }
+
+    // The Apple Authentication Coprocessor does not acknowledge transfers while it is busy.
+    return kHAPError_Busy;
+}
+
+static HAPError DeviceWrite(void* _Nullable context, const void* bytes, size_t numBytes) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(bytes);
+
+    ssize_t n;
+    do {
+        n = write(mfiHWAuth->i2cFile, bytes, numBytes);
+    } while (n == -1 && errno == EINTR);
+    return GetTransferResult(n, numBytes);
+}
+
+static HAPError DeviceRead(void* _Nullable context, void* bytes, size_t numBytes) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(bytes);
+
+    ssize_t n;
+    do {
+        n = read(mfiHWAuth->i2cFile, bytes, numBytes);
+    } while (n == -1 && errno == EINTR);
+    return GetTransferResult(n, numBytes);
+}
+
+static void DeviceSleep(void* _Nullable context HAP_UNUSED, uint32_t microseconds) {
+    (void) usleep((useconds_t) microseconds);
+}
+
 void HAPPlatformMFiHWAuthCreate(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
 
@@ -68,6 +123,14 @@ void HAPPlatformMFiHWAuthCreate(HAPPlatformMFiHWAuthRef mfiHWAuth) {
         HAPLogError(&logObject, "i2c address set failed on %s: %d.", kHAPPlatformMFiHWAuth_I2CPort, _errno);
         HAPFatalError();
     }
+
+    HAPPlatformMFiHWAuthI2CCreate(
+            &mfiHWAuth->i2c,
+            &(const HAPPlatformMFiHWAuthI2COptions) {
+                    .device = {
+                            .write = DeviceWrite, .read = DeviceRead, .sleep = DeviceSleep, .context = mfiHWAuth } });
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
 }
 
 void HAPPlatformMFiHWAuthRelease(HAPPlatformMFiHWAuthRef mfiHWAuth) {
@@ -76,6 +139,10 @@ void HAPPlatformMFiHWAuthRelease(HAPPlatformMFiHWAuthRef mfiHWAuth) {
 
     HAPLogDebug(&logObject, "%s", __func__);
 
+    HAPPlatformMFiHWAuthI2CRelease(&mfiHWAuth->i2c);
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
+
     (void) close(mfiHWAuth->i2cFile);
     mfiHWAuth->i2cFile = 0;
 }
@@ -108,18 +175,21 @@ HAPError HAPPlatformMFiHWAuthWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void
     HAPPrecondition(bytes);
     HAPPrecondition(numBytes);
 
+    HAPError err;
+
+    if (HAPPlatformMFiHWAuthI2CIsBusy(&mfiHWAuth->i2c)) {
+        HAPLog(&logObject, "Asynchronous I2C transaction in progress.");
+        return kHAPError_Unknown;
+    }
+
     HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi >");
-    int repeat = 1000;
-    while (--repeat >= 0) {
-        ssize_t n = write(mfiHWAuth->i2cFile, bytes, numBytes);
-        if (n == (ssize_t) numBytes) {
-            HAPLogDebug(&logObject, "MFi write complete.");
-            return kHAPError_None;
-        }
-        (void) usleep(500);
+    err = HAPPlatformMFiHWAuthI2CWrite(&mfiHWAuth->i2c, bytes, numBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
     }
-    HAPLog(&logObject, "I2C write timed out.");
-    return kHAPError_Unknown;
+    HAPLogDebug(&logObject, "MFi write complete.");
+    return kHAPError_None;
 }
 
 HAP_RESULT_USE_CHECK
@@ -132,29 +202,92 @@ HAPError HAPPlatformMFiHWAuthRead(
     HAPPrecondition(bytes);
     HAPPrecondition(numBytes >= 1 && numBytes <= 128);
 
+    HAPError err;
+
+    if (HAPPlatformMFiHWAuthI2CIsBusy(&mfiHWAuth->i2c)) {
+        HAPLog(&logObject, "Asynchronous I2C transaction in progress.");
+        return kHAPError_Unknown;
+    }
+
     HAPLogDebug(&logObject, "MFi read 0x%02x.", registerAddress);
+    err = HAPPlatformMFiHWAuthI2CRead(&mfiHWAuth->i2c, registerAddress, bytes, numBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+    return kHAPError_None;
+}
 
-    int repeat = 1000;
+static void HandleTransactionCompleted(HAPPlatformMFiHWAuthI2C* i2c, HAPError error, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformMFiHWAuthRef mfiHWAuth = context;
+    HAPPrecondition(i2c == &mfiHWAuth->i2c);
+    HAPPrecondition(mfiHWAuth->completion);
 
-    // Send register ID to read.
-    while (--repeat >= 0) {
-        ssize_t n = write(mfiHWAuth->i2cFile, &registerAddress, 1);
-        if (n == 1) {
-            break;
-        }
-        (void) usleep(500);
+    HAPPlatformMFiHWAuthCompletionCallback completion = HAPNonnull(mfiHWAuth->completion);
+    void* _Nullable completionContext = mfiHWAuth->context;
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
+    completion(mfiHWAuth, error, completionContext);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthWriteAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        const void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi > (async)");
+    err = HAPPlatformMFiHWAuthI2CWriteAsync(&mfiHWAuth->i2c, bytes, numBytes, HandleTransactionCompleted, mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
     }
+    mfiHWAuth->completion = completion;
+    mfiHWAuth->context = context;
+    return kHAPError_None;
+}
 
-    // Send read request.
-    while (--repeat >= 0) {
-        ssize_t n = read(mfiHWAuth->i2cFile, bytes, numBytes);
-        if (n == (ssize_t) numBytes) {
-            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
-            return kHAPError_None;
-        }
-        (void) usleep(500);
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthReadAsync(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes,
+        HAPPlatformMFiHWAuthCompletionCallback completion,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+    HAPPrecondition(completion);
+
+    HAPError err;
+
+    HAPLogDebug(&logObject, "MFi read 0x%02x (async).", registerAddress);
+    err = HAPPlatformMFiHWAuthI2CReadAsync(
+            &mfiHWAuth->i2c, registerAddress, bytes, numBytes, HandleTransactionCompleted, mfiHWAuth);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
     }
+    mfiHWAuth->completion = completion;
+    mfiHWAuth->context = context;
+    return kHAPError_None;
+}
+
+void HAPPlatformMFiHWAuthCancel(HAPPlatformMFiHWAuthRef mfiHWAuth) {
+    HAPPrecondition(mfiHWAuth);
 
-    HAPLog(&logObject, "I2C read timed out.");
-    return kHAPError_Unknown;
+    HAPPlatformMFiHWAuthI2CCancel(&mfiHWAuth->i2c);
+    mfiHWAuth->completion = NULL;
+    mfiHWAuth->context = NULL;
 }
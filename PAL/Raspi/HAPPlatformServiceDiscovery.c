@@ -10,8 +10,469 @@
 #include "HAPPlatform+Init.h"
 #include "HAPPlatformServiceDiscovery+Init.h"
 
+#if HAVE_EMBEDDED_MDNS
+#include <errno.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "HAPPlatformLog+Init.h"
+#endif
+
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "ServiceDiscovery" };
 
+void HAPPlatformServiceDiscoveryCreate(
+        HAPPlatformServiceDiscoveryRef serviceDiscovery,
+        const HAPPlatformServiceDiscoveryOptions* options) {
+    HAPPrecondition(serviceDiscovery);
+    HAPPrecondition(options);
+
+    HAPLogDebug(&logObject, "Storage configuration: serviceDiscovery = %lu", (unsigned long) sizeof *serviceDiscovery);
+
+    HAPRawBufferZero(serviceDiscovery, sizeof *serviceDiscovery);
+
+    if (options->interfaceName) {
+        size_t numInterfaceNameBytes = HAPStringGetNumBytes(HAPNonnull(options->interfaceName));
+        if ((numInterfaceNameBytes == 0) || (numInterfaceNameBytes >= sizeof serviceDiscovery->interfaceName)) {
+            HAPLogError(&logObject, "Invalid local network interface name.");
+            HAPFatalError();
+        }
+        HAPRawBufferCopyBytes(
+                serviceDiscovery->interfaceName, HAPNonnull(options->interfaceName), numInterfaceNameBytes);
+    }
+
+#if HAVE_EMBEDDED_MDNS
+    serviceDiscovery->fileDescriptor = -1;
+#else
+    serviceDiscovery->dnsService = NULL;
+#endif
+}
+
+#if HAVE_EMBEDDED_MDNS
+
+/**
+ * IPv4 Multicast DNS group address 224.0.0.251 (RFC 6762, Section 3).
+ */
+#define kMDNSGroupAddress ((in_addr_t) 0xE00000FB)
+
+/**
+ * Maximum length of a received Multicast DNS packet (RFC 6762, Section 17).
+ */
+#define kMaxReceivedPacketBytes ((size_t) 9000)
+
+static void SendPacket(
+        HAPPlatformMDNSResponder* responder,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context) {
+    HAPPrecondition(responder);
+    HAPPrecondition(bytes);
+    HAPPrecondition(context);
+    HAPPlatformServiceDiscoveryRef serviceDiscovery = context;
+    HAPPrecondition(responder == &serviceDiscovery->responder);
+
+    struct sockaddr_in sin;
+    HAPRawBufferZero(&sin, sizeof sin);
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(kHAPPlatformMDNSResponder_Port);
+    sin.sin_addr.s_addr = htonl(kMDNSGroupAddress);
+
+    ssize_t n = sendto(serviceDiscovery->fileDescriptor, bytes, numBytes, 0, (struct sockaddr*) &sin, sizeof sin);
+    if (n < 0) {
+        // Packets are lost if the network is temporarily unavailable. Multicast DNS recovers from that.
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'sendto' on Multicast DNS socket failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+    }
+}
+
+static void HandleFileHandleCallback(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context) {
+    HAPAssert(fileHandle);
+    HAPAssert(fileHandleEvents.isReadyForReading);
+    HAPAssert(context);
+
+    HAPPlatformServiceDiscoveryRef serviceDiscovery = context;
+
+    HAPAssert(serviceDiscovery->fileHandle == fileHandle);
+
+    for (;;) {
+        uint8_t bytes[kMaxReceivedPacketBytes];
+        struct sockaddr_in sin;
+        socklen_t sin_len = sizeof sin;
+        ssize_t n = recvfrom(
+                serviceDiscovery->fileDescriptor,
+                bytes,
+                sizeof bytes,
+                MSG_TRUNC,
+                (struct sockaddr*) &sin,
+                &sin_len);
+        if (n < 0) {
+            int _errno = errno;
+            if (_errno == EINTR) {
+                continue;
+            }
+            if (_errno != EAGAIN && _errno != EWOULDBLOCK) {
+                HAPPlatformLogPOSIXError(
+                        kHAPLogType_Error,
+                        "System call 'recvfrom' on Multicast DNS socket failed.",
+                        _errno,
+                        __func__,
+                        HAP_FILE,
+                        __LINE__);
+            }
+            return;
+        }
+        if ((size_t) n > sizeof bytes) {
+            HAPLog(&logObject, "Ignoring truncated Multicast DNS packet (%zd bytes).", n);
+            continue;
+        }
+        if (sin.sin_family != AF_INET || ntohs(sin.sin_port) != kHAPPlatformMDNSResponder_Port) {
+            HAPLogDebug(&logObject, "Ignoring legacy unicast DNS query from port %u.", ntohs(sin.sin_port));
+            continue;
+        }
+        HAPPlatformMDNSResponderHandlePacket(&serviceDiscovery->responder, bytes, (size_t) n);
+    }
+}
+
+/**
+ * Collects the IP addresses that are published for the host.
+ *
+ * - Loopback interfaces are only considered if they are explicitly selected.
+ *
+ * @param      serviceDiscovery     Service discovery.
+ * @param[out] addresses            IP addresses.
+ * @param[out] numAddresses         Number of IP addresses.
+ */
+static void GetAddresses(
+        HAPPlatformServiceDiscoveryRef serviceDiscovery,
+        HAPPlatformMDNSResponderAddress addresses[_Nonnull kHAPPlatformMDNSResponder_MaxAddresses],
+        size_t* numAddresses) {
+    HAPPrecondition(serviceDiscovery);
+    HAPPrecondition(addresses);
+    HAPPrecondition(numAddresses);
+
+    *numAddresses = 0;
+
+    struct ifaddrs* ifaddrs;
+    if (getifaddrs(&ifaddrs) != 0) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error, "System call 'getifaddrs' failed.", _errno, __func__, HAP_FILE, __LINE__);
+        return;
+    }
+    for (struct ifaddrs* ifa = ifaddrs; ifa && *numAddresses < kHAPPlatformMDNSResponder_MaxAddresses;
+         ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr || !(ifa->ifa_flags & IFF_UP)) {
+            continue;
+        }
+        if (serviceDiscovery->interfaceName[0]) {
+            if (!HAPStringAreEqual(ifa->ifa_name, serviceDiscovery->interfaceName)) {
+                continue;
+            }
+        } else if (ifa->ifa_flags & IFF_LOOPBACK) {
+            continue;
+        }
+
+        HAPPlatformMDNSResponderAddress* address = &addresses[*numAddresses];
+        HAPRawBufferZero(address, sizeof *address);
+        if (ifa->ifa_addr->sa_family == AF_INET) {
+            const struct sockaddr_in* sin = (const struct sockaddr_in*) ifa->ifa_addr;
+            address->version = kHAPIPAddressVersion_IPv4;
+            HAPRawBufferCopyBytes(address->bytes, &sin->sin_addr, sizeof sin->sin_addr);
+        } else if (ifa->ifa_addr->sa_family == AF_INET6) {
+            const struct sockaddr_in6* sin6 = (const struct sockaddr_in6*) ifa->ifa_addr;
+            address->version = kHAPIPAddressVersion_IPv6;
+            HAPRawBufferCopyBytes(address->bytes, &sin6->sin6_addr, sizeof sin6->sin6_addr);
+        } else {
+            continue;
+        }
+        HAPLogBufferDebug(
+                &logObject,
+                address->bytes,
+                address->version == kHAPIPAddressVersion_IPv4 ? 4 : 16,
+                "address[%lu]: %s",
+                (unsigned long) *numAddresses,
+                ifa->ifa_name);
+        (*numAddresses)++;
+    }
+    freeifaddrs(ifaddrs);
+}
+
+/**
+ * Joins the Multicast DNS group on a network interface.
+ *
+ * @param      fileDescriptor       Multicast DNS socket.
+ * @param      interfaceIndex       Interface index.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If joining failed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError JoinGroup(int fileDescriptor, unsigned int interfaceIndex) {
+    struct ip_mreqn mreq;
+    HAPRawBufferZero(&mreq, sizeof mreq);
+    mreq.imr_multiaddr.s_addr = htonl(kMDNSGroupAddress);
+    mreq.imr_address.s_addr = htonl(INADDR_ANY);
+    mreq.imr_ifindex = (int) interfaceIndex;
+    int e = setsockopt(fileDescriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof mreq);
+    if (e != 0 && errno != EADDRINUSE) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'setsockopt' with option 'IP_ADD_MEMBERSHIP' on Multicast DNS socket failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        return kHAPError_Unknown;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Opens the Multicast DNS socket and joins the Multicast DNS group.
+ *
+ * @param      serviceDiscovery     Service discovery.
+ * @param      interfaceIndex       Index of the interface on which to register services. 0 for all interfaces.
+ *
+ * @return File descriptor of the socket.
+ */
+HAP_RESULT_USE_CHECK
+static int OpenSocket(HAPPlatformServiceDiscoveryRef serviceDiscovery, uint32_t interfaceIndex) {
+    HAPPrecondition(serviceDiscovery);
+
+    HAPError err;
+    int e;
+
+    int fileDescriptor = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fileDescriptor == -1) {
+        HAPLogError(&logObject, "Failed to open Multicast DNS socket.");
+        HAPFatalError();
+    }
+
+    // Other Multicast DNS implementations on the same host may have bound the port as well.
+    int v = 1;
+    e = setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &v, sizeof v);
+#if defined(SO_REUSEPORT)
+    if (e == 0) {
+        e = setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEPORT, &v, sizeof v);
+    }
+#endif
+    if (e != 0) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'setsockopt' with option 'SO_REUSEADDR' on Multicast DNS socket failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    // Responses must be received by other Multicast DNS implementations on the same host.
+    uint8_t loop = 1;
+    uint8_t ttl = 255;
+    e = setsockopt(fileDescriptor, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof loop);
+    if (e == 0) {
+        e = setsockopt(fileDescriptor, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof ttl);
+    }
+    if (e == 0 && interfaceIndex) {
+        struct ip_mreqn mreq;
+        HAPRawBufferZero(&mreq, sizeof mreq);
+        mreq.imr_ifindex = (int) interfaceIndex;
+        e = setsockopt(fileDescriptor, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof mreq);
+    }
+    if (e != 0) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'setsockopt' with multicast options on Multicast DNS socket failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    struct sockaddr_in sin;
+    HAPRawBufferZero(&sin, sizeof sin);
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(kHAPPlatformMDNSResponder_Port);
+    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+    e = bind(fileDescriptor, (struct sockaddr*) &sin, sizeof sin);
+    if (e != 0) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'bind' on Multicast DNS socket failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    if (interfaceIndex) {
+        err = JoinGroup(fileDescriptor, interfaceIndex);
+        if (err) {
+            HAPFatalError();
+        }
+    } else {
+        // Join the group on all interfaces that support multicast.
+        struct ifaddrs* ifaddrs;
+        if (getifaddrs(&ifaddrs) != 0) {
+            int _errno = errno;
+            HAPPlatformLogPOSIXError(
+                    kHAPLogType_Error, "System call 'getifaddrs' failed.", _errno, __func__, HAP_FILE, __LINE__);
+            HAPFatalError();
+        }
+        bool isJoined = false;
+        for (struct ifaddrs* ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET || !(ifa->ifa_flags & IFF_UP) ||
+                !(ifa->ifa_flags & IFF_MULTICAST)) {
+                continue;
+            }
+            err = JoinGroup(fileDescriptor, if_nametoindex(ifa->ifa_name));
+            isJoined = isJoined || !err;
+        }
+        freeifaddrs(ifaddrs);
+        if (!isJoined) {
+            HAPLogError(&logObject, "No network interface supports multicast.");
+            HAPFatalError();
+        }
+    }
+
+    e = fcntl(fileDescriptor, F_SETFL, O_NONBLOCK);
+    if (e != 0) {
+        int _errno = errno;
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'fcntl' to set Multicast DNS socket options to 'O_NONBLOCK' failed.",
+                _errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        HAPFatalError();
+    }
+
+    return fileDescriptor;
+}
+
+void HAPPlatformServiceDiscoveryRegister(
+        HAPPlatformServiceDiscoveryRef serviceDiscovery,
+        const char* name,
+        const char* protocol,
+        HAPNetworkPort port,
+        HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords) {
+    HAPPrecondition(serviceDiscovery);
+    HAPPrecondition(serviceDiscovery->fileDescriptor == -1);
+    HAPPrecondition(name);
+    HAPPrecondition(protocol);
+    HAPPrecondition(txtRecords);
+
+    HAPError err;
+
+    uint32_t interfaceIndex;
+    if (serviceDiscovery->interfaceName[0]) {
+        unsigned int i = if_nametoindex(serviceDiscovery->interfaceName);
+        if ((i == 0) || (i > UINT32_MAX)) {
+            HAPLogError(&logObject, "Mapping the local network interface name to its corresponding index failed.");
+            HAPFatalError();
+        }
+        interfaceIndex = (uint32_t) i;
+    } else {
+        interfaceIndex = 0;
+    }
+
+    HAPLogDebug(&logObject, "interfaceIndex: %lu", (unsigned long) interfaceIndex);
+
+    // The service is published for the first label of the host name.
+    char hostName[kHAPPlatformMDNSResponder_MaxLabelBytes + 1];
+    if (gethostname(hostName, sizeof hostName) != 0) {
+        hostName[0] = '\0';
+    }
+    hostName[sizeof hostName - 1] = '\0';
+    for (char* c = hostName; *c; c++) {
+        if (*c == '.') {
+            *c = '\0';
+            break;
+        }
+    }
+    if (!hostName[0]) {
+        err = HAPStringWithFormat(hostName, sizeof hostName, "%s", "HomeKit");
+        HAPAssert(!err);
+    }
+
+    HAPPlatformMDNSResponderAddress addresses[kHAPPlatformMDNSResponder_MaxAddresses];
+    size_t numAddresses;
+    GetAddresses(serviceDiscovery, addresses, &numAddresses);
+    if (!numAddresses) {
+        HAPLog(&logObject, "No IP address found to publish for host \"%s\".", hostName);
+    }
+
+    serviceDiscovery->fileDescriptor = OpenSocket(serviceDiscovery, interfaceIndex);
+
+    HAPPlatformMDNSResponderCreate(
+            &serviceDiscovery->responder,
+            &(const HAPPlatformMDNSResponderOptions) { .hostName = hostName,
+                                                       .addresses = addresses,
+                                                       .numAddresses = numAddresses,
+                                                       .sendPacket = SendPacket,
+                                                       .context = serviceDiscovery });
+
+    err = HAPPlatformFileHandleRegister(
+            &serviceDiscovery->fileHandle,
+            serviceDiscovery->fileDescriptor,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = true, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleFileHandleCallback,
+            serviceDiscovery);
+    if (err) {
+        HAPLogError(&logObject, "%s: HAPPlatformFileHandleRegister failed: %u.", __func__, err);
+        HAPFatalError();
+    }
+    HAPAssert(serviceDiscovery->fileHandle);
+
+    HAPPlatformMDNSResponderRegister(&serviceDiscovery->responder, name, protocol, port, txtRecords, numTXTRecords);
+}
+
+void HAPPlatformServiceDiscoveryUpdateTXTRecords(
+        HAPPlatformServiceDiscoveryRef serviceDiscovery,
+        HAPPlatformServiceDiscoveryTXTRecord* txtRecords,
+        size_t numTXTRecords) {
+    HAPPrecondition(serviceDiscovery);
+    HAPPrecondition(serviceDiscovery->fileDescriptor != -1);
+    HAPPrecondition(txtRecords);
+
+    HAPPlatformMDNSResponderUpdateTXTRecords(&serviceDiscovery->responder, txtRecords, numTXTRecords);
+}
+
+void HAPPlatformServiceDiscoveryStop(HAPPlatformServiceDiscoveryRef serviceDiscovery) {
+    HAPPrecondition(serviceDiscovery);
+    HAPPrecondition(serviceDiscovery->fileDescriptor != -1);
+
+    HAPPlatformMDNSResponderStop(&serviceDiscovery->responder);
+
+    HAPPlatformFileHandleDeregister(serviceDiscovery->fileHandle);
+    serviceDiscovery->fileHandle = 0;
+
+    (void) close(serviceDiscovery->fileDescriptor);
+    serviceDiscovery->fileDescriptor = -1;
+}
+
+#else
+
 // TODO Add support for re-registering service discovery in case of error while app is running.
 
 static void HandleFileHandleCallback(
@@ -47,29 +508,6 @@ static void HandleServiceRegisterReply(
     }
 }
 
-void HAPPlatformServiceDiscoveryCreate(
-        HAPPlatformServiceDiscoveryRef serviceDiscovery,
-        const HAPPlatformServiceDiscoveryOptions* options) {
-    HAPPrecondition(serviceDiscovery);
-    HAPPrecondition(options);
-
-    HAPLogDebug(&logObject, "Storage configuration: serviceDiscovery = %lu", (unsigned long) sizeof *serviceDiscovery);
-
-    HAPRawBufferZero(serviceDiscovery, sizeof *serviceDiscovery);
-
-    if (options->interfaceName) {
-        size_t numInterfaceNameBytes = HAPStringGetNumBytes(HAPNonnull(options->interfaceName));
-        if ((numInterfaceNameBytes == 0) || (numInterfaceNameBytes >= sizeof serviceDiscovery->interfaceName)) {
-            HAPLogError(&logObject, "Invalid local network interface name.");
-            HAPFatalError();
-        }
-        HAPRawBufferCopyBytes(
-                serviceDiscovery->interfaceName, HAPNonnull(options->interfaceName), numInterfaceNameBytes);
-    }
-
-    serviceDiscovery->dnsService = NULL;
-}
-
 void HAPPlatformServiceDiscoveryRegister(
         HAPPlatformServiceDiscoveryRef serviceDiscovery,
         const char* name,
@@ -228,3 +666,5 @@ void HAPPlatformServiceDiscoveryStop(HAPPlatformServiceDiscoveryRef serviceDisco
 
     TXTRecordDeallocate(&serviceDiscovery->txtRecord);
 }
+
+#endif
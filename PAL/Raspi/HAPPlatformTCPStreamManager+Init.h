@@ -0,0 +1 @@
+../POSIX/HAPPlatformTCPStreamManager+Init.h
\ No newline at end of file
@@ -0,0 +1 @@
+../POSIX/HAPPlatformTCPStreamManager.c
\ No newline at end of file
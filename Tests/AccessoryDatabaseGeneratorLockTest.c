@@ -0,0 +1,164 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#include "Harness/HAPBLECentral.c"
+#include "Harness/HAPIPController.c"
+#include "Harness/AccessoryDatabaseGeneratorTest.c"
+
+#include "../Applications/Lock/DB.c"
+
+HAP_RESULT_USE_CHECK
+HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleLockMechanismLockCurrentStateRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = kHAPCharacteristicValue_LockCurrentState_Secured;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleLockMechanismLockTargetStateRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = kHAPCharacteristicValue_LockTargetState_Secured;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleLockMechanismLockTargetStateWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicWriteRequest* request HAP_UNUSED,
+        uint8_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleLockManagementLockControlPointWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPTLV8CharacteristicWriteRequest* request HAP_UNUSED,
+        HAPTLVReaderRef* requestReader HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleLockManagementVersionRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicReadRequest* request HAP_UNUSED,
+        char* value,
+        size_t maxBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(maxBytes >= sizeof "1.0");
+    HAPRawBufferCopyBytes(value, "1.0", sizeof "1.0");
+    return kHAPError_None;
+}
+
+HAPError HandleLockManagementAutoSecurityTimeoutRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt32CharacteristicReadRequest* request HAP_UNUSED,
+        uint32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 30;
+    return kHAPError_None;
+}
+
+HAPError HandleLockManagementAutoSecurityTimeoutWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt32CharacteristicWriteRequest* request HAP_UNUSED,
+        uint32_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleProgrammableSwitchEventRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = kHAPCharacteristicValue_ProgrammableSwitchEvent_SinglePress;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleVolumeRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 50;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleVolumeWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicWriteRequest* request HAP_UNUSED,
+        uint8_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleRingcodeOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HandleRingcodeOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+// Services are listed in the same order as in Applications/Lock/App.c.
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Locks,
+                                        .name = "Acme Lock",
+                                        .manufacturer = "Acme",
+                                        .model = "Lock1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lockMechanismService,
+                                                                                  &lockManagementService,
+                                                                                  &doorbellService,
+                                                                                  &ringcodeService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+int main() {
+    AccessoryDatabaseGeneratorTestRun(
+            "Tools/AccessoryDatabaseGenerator/Examples/Lock.hapdb", &accessory, kAttributeCount);
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Plays the cached clips of the Raspi lock through the libao null driver and reports the latency from trigger to
+// the first buffer played. Only built for the Raspi PAL, which links libao and libsndfile.
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sndfile.h>
+
+#include "HAP.h"
+
+#include "../PAL/Raspi/GRM_Audio.c"
+
+/** Number of times that each clip is played. */
+#define kNumRounds ((size_t) 16)
+
+/** Upper bound for the latency from trigger to first buffer with the null driver. */
+#define kMaxLatencyUs ((long) 50000)
+
+/**
+ * Writes a 16 bit WAV file with a 100 ms sine tone.
+ */
+static void WriteClip(const char* path, int channels, int rate) {
+    HAPPrecondition(path);
+
+    SF_INFO info;
+    HAPRawBufferZero(&info, sizeof info);
+    info.samplerate = rate;
+    info.channels = channels;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+    SNDFILE* file = sf_open(path, SFM_WRITE, &info);
+    HAPAssert(file);
+
+    static short samples[2 * 48000 / 10];
+    size_t numFrames = (size_t) rate / 10;
+    HAPAssert(numFrames * (size_t) channels <= HAPArrayCount(samples));
+    for (size_t i = 0; i < numFrames; i++) {
+        short sample = (short) (8192 * sin(2 * M_PI * 440 * (double) i / rate));
+        for (int j = 0; j < channels; j++) {
+            samples[i * (size_t) channels + (size_t) j] = sample;
+        }
+    }
+    sf_count_t numSamples = (sf_count_t)(numFrames * (size_t) channels);
+    HAPAssert(sf_write_short(file, samples, numSamples) == numSamples);
+    sf_close(file);
+}
+
+int main() {
+    char directory[] = "/tmp/GRMAudioLatencyTest.XXXXXX";
+    HAPAssert(mkdtemp(directory));
+
+    // Different sample formats so that switching clips reopens the device.
+    static char paths[3][sizeof directory + 16];
+    const char* files[HAPArrayCount(paths)];
+    const int channels[HAPArrayCount(paths)] = { 1, 1, 2 };
+    const int rates[HAPArrayCount(paths)] = { 44100, 44100, 48000 };
+    for (size_t i = 0; i < HAPArrayCount(paths); i++) {
+        int n = snprintf(paths[i], sizeof paths[i], "%s/%zu.wav", directory, i);
+        HAPAssert(n > 0 && (size_t) n < sizeof paths[i]);
+        WriteClip(paths[i], channels[i], rates[i]);
+        files[i] = paths[i];
+    }
+
+    bool started = GRM_AudioStart("null", files, (int) HAPArrayCount(files));
+    HAPAssert(started);
+    HAPAssert(GRM_AudioGetLastLatencyUs() == -1);
+
+    long minLatencyUs = LONG_MAX;
+    long maxLatencyUs = 0;
+    long totalLatencyUs = 0;
+    size_t numPlayed = 0;
+    for (size_t round = 0; round < kNumRounds; round++) {
+        for (int clip = 0; clip < (int) HAPArrayCount(files); clip++) {
+            struct timespec triggerTime;
+            clock_gettime(CLOCK_MONOTONIC, &triggerTime);
+            bool queued = GRM_AudioPlay(clip, 0.5f, /* skipIfBusy: */ true, &triggerTime);
+            HAPAssert(queued);
+            GRM_AudioWaitIdle();
+
+            long latencyUs = GRM_AudioGetLastLatencyUs();
+            HAPAssert(latencyUs >= 0);
+            HAPAssert(latencyUs <= kMaxLatencyUs);
+            if (latencyUs < minLatencyUs) {
+                minLatencyUs = latencyUs;
+            }
+            if (latencyUs > maxLatencyUs) {
+                maxLatencyUs = latencyUs;
+            }
+            totalLatencyUs += latencyUs;
+            numPlayed++;
+        }
+    }
+
+    // Up to the queue size, requests are queued even while a clip is still playing.
+    struct timespec triggerTime;
+    clock_gettime(CLOCK_MONOTONIC, &triggerTime);
+    size_t numQueued = 0;
+    for (size_t i = 0; i < 2 * AUDIO_QUEUE_SIZE; i++) {
+        if (GRM_AudioPlay(0, 0.5f, /* skipIfBusy: */ false, &triggerTime)) {
+            numQueued++;
+        }
+    }
+    HAPAssert(numQueued >= AUDIO_QUEUE_SIZE);
+    GRM_AudioWaitIdle();
+
+    GRM_AudioStop();
+    for (size_t i = 0; i < HAPArrayCount(paths); i++) {
+        HAPAssert(unlink(paths[i]) == 0);
+    }
+    HAPAssert(rmdir(directory) == 0);
+
+    HAPLog(&kHAPLog_Default,
+           "Latency from trigger to first buffer over %zu clips: min %ld us, avg %ld us, max %ld us.",
+           numPlayed,
+           minLatencyUs,
+           totalLatencyUs / (long) numPlayed,
+           maxLatencyUs);
+    return 0;
+}
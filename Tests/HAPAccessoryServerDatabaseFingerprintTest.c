@@ -0,0 +1,221 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 0;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+static const HAPAccessory bridgeAccessory = { .aid = 1,
+                                              .category = kHAPAccessoryCategory_Bridges,
+                                              .name = "Acme Test",
+                                              .manufacturer = "Acme",
+                                              .model = "Test1,1",
+                                              .serialNumber = "099DB48E9E28",
+                                              .firmwareVersion = "1",
+                                              .hardwareVersion = "1",
+                                              .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                        &hapProtocolInformationService,
+                                                                                        &pairingService,
+                                                                                        NULL },
+                                              .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPIntCharacteristic brightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = HandleBrightnessWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = "Light Bulb",
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &brightnessCharacteristic, NULL }
+};
+
+static HAPAccessory bridgedAccessory = { .aid = 2,
+                                         .category = kHAPAccessoryCategory_BridgedAccessory,
+                                         .name = "Acme Light Bulb",
+                                         .manufacturer = "Acme",
+                                         .model = "LightBulb1,1",
+                                         .serialNumber = "0000001",
+                                         .firmwareVersion = "1",
+                                         .hardwareVersion = "1",
+                                         .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                   &lightBulbService,
+                                                                                   NULL },
+                                         .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+
+/**
+ * Starts the bridge, stops it again, and returns the configuration number.
+ */
+static uint16_t StartBridge(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        bool configurationChanged) {
+    HAPAccessoryServerStartBridge(&accessoryServer, primaryAccessory, bridgedAccessories, configurationChanged);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+
+    uint16_t configurationNumber;
+    HAPError err = HAPAccessoryServerGetCN(platform.keyValueStore, &configurationNumber);
+    HAPAssert(!err);
+    return configurationNumber;
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[2];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][2 * kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[2 * kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[2 * kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    const HAPAccessory* const bridgedAccessories[] = { &bridgedAccessory, NULL };
+    const HAPAccessory* const noBridgedAccessories[] = { NULL };
+
+    // The first start stores the fingerprint without incrementing the configuration number.
+    uint16_t configurationNumber = StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false);
+
+    // Restarting with an unchanged attribute database keeps the configuration number,
+    // even if the bridge reports a configuration change.
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ true) ==
+              configurationNumber);
+
+    // Changing a characteristic constraint increments the configuration number once.
+    brightnessCharacteristic.constraints.maximumValue = 50;
+    configurationNumber++;
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+
+    // Changing a characteristic property increments the configuration number.
+    brightnessCharacteristic.properties.ip.supportsWriteResponse = true;
+    configurationNumber++;
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+
+    // Updating the firmware of a bridged accessory increments the configuration number.
+    bridgedAccessory.firmwareVersion = "2";
+    configurationNumber++;
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ true) ==
+              configurationNumber);
+
+    // Removing a bridged accessory increments the configuration number.
+    configurationNumber++;
+    HAPAssert(StartBridge(&bridgeAccessory, noBridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+
+    // Adding it back increments the configuration number.
+    configurationNumber++;
+    HAPAssert(StartBridge(&bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+
+    // A firmware update of the bridge that also changes the attribute database increments the configuration number
+    // only once.
+    HAPAccessory updatedBridgeAccessory = bridgeAccessory;
+    updatedBridgeAccessory.firmwareVersion = "2";
+    brightnessCharacteristic.constraints.maximumValue = 100;
+    configurationNumber++;
+    HAPAssert(StartBridge(&updatedBridgeAccessory, bridgedAccessories, /* configurationChanged: */ true) ==
+              configurationNumber);
+    HAPAssert(StartBridge(&updatedBridgeAccessory, bridgedAccessories, /* configurationChanged: */ false) ==
+              configurationNumber);
+
+    return 0;
+}
@@ -0,0 +1,587 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Test.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#include "Harness/HAPBLECentral.c"
+#include "Harness/HAPIPController.c"
+#include "Harness/TemplateDB.c"
+
+/** Connection handle of the simulated central. */
+#define kConnectionHandle ((HAPPlatformBLEPeripheralManagerConnectionHandle) 0x0042)
+
+/** Maximum length of a response that is received over IP. */
+#define kMaxResponseBytes ((size_t) 32 * 1024)
+
+/** Maximum number of run loop iterations to wait for a complete response. */
+#define kMaxResponseIterations ((size_t) 64)
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory templateAccessory = { .aid = 1,
+                                                .category = kHAPAccessoryCategory_Bridges,
+                                                .name = "Acme Test",
+                                                .manufacturer = "Acme",
+                                                .model = "Test1,1",
+                                                .serialNumber = "099DB48E9E28",
+                                                .firmwareVersion = "1",
+                                                .hardwareVersion = "1",
+                                                .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                          &hapProtocolInformationService,
+                                                                                          &pairingService,
+                                                                                          NULL },
+                                                .callbacks = { .identify = IdentifyAccessory } };
+
+static bool lightBulbOn;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = lightBulbOn;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    lightBulbOn = value;
+    return kHAPError_None;
+}
+
+/**
+ * Returns a name of maximum length that consists of control characters, i.e., the worst case for JSON escaping.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError HandleNameRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicReadRequest* request,
+        char* value,
+        size_t maxValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    size_t numValueBytes = ((const HAPStringCharacteristic*) request->characteristic)->constraints.maxLength;
+    HAPAssert(numValueBytes < maxValueBytes);
+    for (size_t i = 0; i < numValueBytes; i++) {
+        value[i] = 0x01;
+    }
+    value[numValueBytes] = '\0';
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic onCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = true,
+                             .supportsDisconnectedNotification = true,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+static const HAPStringCharacteristic nameCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x32,
+    .characteristicType = &kHAPCharacteristicType_Name,
+    .debugDescription = kHAPCharacteristicDebugDescription_Name,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 1000 },
+    .callbacks = { .handleRead = HandleNameRead }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = "Light Bulb",
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &onCharacteristic, &nameCharacteristic, NULL }
+};
+
+static const HAPAccessory lightBulbAccessory = { .aid = 1,
+                                                 .category = kHAPAccessoryCategory_Lighting,
+                                                 .name = "Acme Light Bulb",
+                                                 .manufacturer = "Acme",
+                                                 .model = "LightBulb1,1",
+                                                 .serialNumber = "099DB48E9E28",
+                                                 .firmwareVersion = "1",
+                                                 .hardwareVersion = "1",
+                                                 .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                           &hapProtocolInformationService,
+                                                                                           &pairingService,
+                                                                                           &lightBulbService,
+                                                                                           NULL },
+                                                 .callbacks = { .identify = IdentifyAccessory } };
+
+static const HAPAccessory bridgedLightBulbAccessory = { .aid = 2,
+                                                        .category = kHAPAccessoryCategory_BridgedAccessory,
+                                                        .name = "Acme Bridged Light Bulb",
+                                                        .manufacturer = "Acme",
+                                                        .model = "LightBulb1,1",
+                                                        .serialNumber = "099DB48E9E29",
+                                                        .firmwareVersion = "1",
+                                                        .hardwareVersion = "1",
+                                                        .services =
+                                                                (const HAPService* const[]) {
+                                                                        &accessoryInformationService,
+                                                                        &lightBulbService,
+                                                                        NULL },
+                                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/** Controller pairing that is used for Pair Verify. */
+static const char kControllerPairingID[] = "8E5B3C2A-4F1D-4E6B-9A7C-0D2E1F3A4B5C";
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t controllerLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Returns whether a buffer contains a given byte sequence.
+ */
+HAP_RESULT_USE_CHECK
+static bool ContainsBytes(const uint8_t* bytes, size_t numBytes, const void* searchBytes, size_t numSearchBytes) {
+    for (size_t i = 0; i + numSearchBytes <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], searchBytes, numSearchBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the length of the header of a HTTP response including the empty line. 0 if the header is incomplete.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumHeaderBytes(const uint8_t* bytes, size_t numBytes) {
+    for (size_t i = 0; i + 4 <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], "\r\n\r\n", 4)) {
+            return i + 4;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns the Content-Length of a HTTP response. False if the response uses chunked transfer encoding.
+ */
+HAP_RESULT_USE_CHECK
+static bool GetContentLength(const uint8_t* bytes, size_t numHeaderBytes, size_t* numContentBytes) {
+    static const char field[] = "\r\nContent-Length: ";
+    for (size_t i = 0; i + sizeof field - 1 <= numHeaderBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], field, sizeof field - 1)) {
+            *numContentBytes = 0;
+            for (size_t j = i + sizeof field - 1; bytes[j] >= '0' && bytes[j] <= '9'; j++) {
+                *numContentBytes = *numContentBytes * 10 + (size_t)(bytes[j] - '0');
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Receives a complete HTTP response over IP.
+ *
+ * @return Length of the response.
+ */
+HAP_RESULT_USE_CHECK
+static size_t ReceiveResponse(HAPIPController* controller, uint8_t* bytes, size_t maxBytes, size_t* numHeaderBytes) {
+    static const char lastChunk[] = "\r\n0\r\n\r\n";
+
+    size_t numBytes = 0;
+    for (size_t i = 0; i < kMaxResponseIterations; i++) {
+        HAPPlatformClockAdvance(0);
+        size_t numReceivedBytes;
+        if (HAPIPControllerReceive(controller, &bytes[numBytes], maxBytes - numBytes, &numReceivedBytes)) {
+            numBytes += numReceivedBytes;
+        }
+        *numHeaderBytes = GetNumHeaderBytes(bytes, numBytes);
+        if (!*numHeaderBytes) {
+            continue;
+        }
+        size_t numContentBytes;
+        if (GetContentLength(bytes, *numHeaderBytes, &numContentBytes)) {
+            HAPAssert(numBytes <= *numHeaderBytes + numContentBytes);
+            if (numBytes == *numHeaderBytes + numContentBytes) {
+                return numBytes;
+            }
+        } else if (
+                numBytes >= *numHeaderBytes + sizeof lastChunk - 1 &&
+                HAPRawBufferAreEqual(&bytes[numBytes - (sizeof lastChunk - 1)], lastChunk, sizeof lastChunk - 1)) {
+            return numBytes;
+        }
+    }
+    HAPLogError(&kHAPLog_Default, "Incomplete response.");
+    HAPFatalError();
+}
+
+int main() {
+    HAPAccessoryServerStorageRequirements templateRequirements;
+    HAPAccessoryServerGetStorageRequirements(
+            &templateAccessory,
+            /* bridgedAccessories: */ NULL,
+            kHAPPairingStorage_MinElements,
+            /* maxTLV8Bytes: */ 0,
+            &templateRequirements);
+
+    // Accessory Information: Identify is write-only, 7 readable strings.
+    // HAP Protocol Information: Version (Service Signature is not supported over IP).
+    // Pairing service is not accessible over IP.
+    HAPAssert(templateRequirements.ip.numReadContexts == 7 + 1);
+    HAPAssert(templateRequirements.ip.numWriteContexts == 1);
+    HAPAssert(templateRequirements.ip.numEventNotifications == 0);
+
+    // Every service and every characteristic is an element of the GATT table.
+    HAPAssert(templateRequirements.ble.numGATTTableElements == kAttributeCount);
+
+    // Pair Setup M4 with MFi certificate and proof is the largest pairing message.
+    HAPAssert(templateRequirements.maxPairingMessageBytes >= 1519);
+    HAPAssert(templateRequirements.ip.numScratchBufferBytes >= templateRequirements.maxPairingMessageBytes);
+    HAPAssert(templateRequirements.ip.numInboundBufferBytes >= templateRequirements.maxPairingMessageBytes);
+    HAPAssert(templateRequirements.ip.numOutboundBufferBytes >= templateRequirements.maxPairingMessageBytes);
+    HAPAssert(templateRequirements.ble.numProcedureBufferBytes >= templateRequirements.maxPairingMessageBytes);
+
+    // Service Signature values are empty and do not depend on the maximum length of the characteristic.
+    HAPAssert(templateRequirements.ble.numProcedureBufferBytes < 2 * templateRequirements.maxPairingMessageBytes);
+
+    // The default storage configuration covers the template database.
+    HAPAssert(templateRequirements.ip.numScratchBufferBytes <= kHAPIPSession_DefaultScratchBufferSize);
+
+    // List Pairings response grows with the number of pairings.
+    {
+        HAPAccessoryServerStorageRequirements requirements;
+        HAPAccessoryServerGetStorageRequirements(
+                &templateAccessory,
+                /* bridgedAccessories: */ NULL,
+                /* maxPairings: */ 64,
+                /* maxTLV8Bytes: */ 0,
+                &requirements);
+        HAPAssert(requirements.maxPairingMessageBytes > templateRequirements.maxPairingMessageBytes);
+        HAPAssert(requirements.maxPairingMessageBytes >= 3 + 64 * (2 + 36 + 2 + 32 + 2 + 1) + 63 * 2);
+        HAPAssert(requirements.ip.numScratchBufferBytes >= requirements.maxPairingMessageBytes);
+        HAPAssert(requirements.ble.numProcedureBufferBytes >= requirements.maxPairingMessageBytes);
+    }
+
+    // Additional service.
+    HAPAccessoryServerStorageRequirements lightBulbRequirements;
+    HAPAccessoryServerGetStorageRequirements(
+            &lightBulbAccessory,
+            /* bridgedAccessories: */ NULL,
+            kHAPPairingStorage_MinElements,
+            /* maxTLV8Bytes: */ 0,
+            &lightBulbRequirements);
+    {
+        HAPAssert(lightBulbRequirements.ip.numReadContexts == templateRequirements.ip.numReadContexts + 2);
+        HAPAssert(lightBulbRequirements.ip.numWriteContexts == templateRequirements.ip.numWriteContexts + 1);
+        HAPAssert(lightBulbRequirements.ip.numEventNotifications == 1);
+        HAPAssert(lightBulbRequirements.ble.numGATTTableElements == kAttributeCount + 1 + 2);
+
+        // Worst case escaping: every byte of the string is escaped as \u00XX.
+        HAPAssert(lightBulbRequirements.ip.maxReadResponseBytes >= 6 * nameCharacteristic.constraints.maxLength);
+        HAPAssert(lightBulbRequirements.ip.maxAccessoriesElementBytes >= 6 * nameCharacteristic.constraints.maxLength);
+        HAPAssert(lightBulbRequirements.ip.maxEventNotificationBytes > 0);
+        HAPAssert(
+                lightBulbRequirements.ip.maxEventNotificationBytes <
+                lightBulbRequirements.ip.maxReadResponseBytes);
+        HAPAssert(lightBulbRequirements.ip.maxWriteRequestBytes > templateRequirements.ip.maxWriteRequestBytes);
+        HAPAssert(lightBulbRequirements.ip.maxWriteResponseBytes > templateRequirements.ip.maxWriteResponseBytes);
+
+        // Values are read into the scratch buffer, including a NULL terminator.
+        HAPAssert(
+                lightBulbRequirements.ip.numScratchBufferBytes >=
+                (size_t) nameCharacteristic.constraints.maxLength + 1);
+
+        // Responses are encrypted in the outbound buffer.
+        HAPAssert(
+                lightBulbRequirements.ip.numOutboundBufferBytes >=
+                HAPIPSecurityProtocolGetNumEncryptedBytes(lightBulbRequirements.ip.maxReadResponseBytes));
+        HAPAssert(
+                lightBulbRequirements.ip.numOutboundBufferBytes >=
+                kHAPIPSecurityProtocol_MaxFrameBytes + lightBulbRequirements.ip.maxAccessoriesElementBytes);
+        HAPAssert(
+                lightBulbRequirements.ip.numInboundBufferBytes >
+                kHAPIPAccessoryServerStorage_MaxRequestHeaderBytes + lightBulbRequirements.ip.maxWriteRequestBytes);
+    }
+
+    // Bridged accessories are only accessible over IP.
+    {
+        HAPAccessoryServerStorageRequirements requirements;
+        HAPAccessoryServerGetStorageRequirements(
+                &lightBulbAccessory,
+                (const HAPAccessory* const[]) { &bridgedLightBulbAccessory, NULL },
+                kHAPPairingStorage_MinElements,
+                /* maxTLV8Bytes: */ 0,
+                &requirements);
+        HAPAssert(requirements.ip.numReadContexts == lightBulbRequirements.ip.numReadContexts + 7 + 2);
+        HAPAssert(requirements.ip.numWriteContexts == lightBulbRequirements.ip.numWriteContexts + 1 + 1);
+        HAPAssert(requirements.ip.numEventNotifications == lightBulbRequirements.ip.numEventNotifications + 1);
+        HAPAssert(requirements.ip.numScratchBufferBytes > lightBulbRequirements.ip.numScratchBufferBytes);
+        HAPAssert(requirements.ip.maxReadResponseBytes > lightBulbRequirements.ip.maxReadResponseBytes);
+        HAPAssert(requirements.ble.numGATTTableElements == lightBulbRequirements.ble.numGATTTableElements);
+        HAPAssert(requirements.ble.numProcedureBufferBytes == lightBulbRequirements.ble.numProcedureBufferBytes);
+    }
+
+    // The largest responses of the light bulb accessory fit into storage that is sized to the requirements.
+    {
+        HAPError err;
+        HAPPlatformCreate();
+
+        static HAPIPSession ipSessions[1];
+        static uint8_t ipInboundBuffer[16 * 1024];
+        static uint8_t ipOutboundBuffer[16 * 1024];
+        static HAPIPEventNotificationRef ipEventNotifications[8];
+        static HAPIPReadContextRef ipReadContexts[16];
+        static HAPIPWriteContextRef ipWriteContexts[16];
+        static uint8_t ipScratchBuffer[4096];
+        HAPAssert(lightBulbRequirements.ip.numInboundBufferBytes <= sizeof ipInboundBuffer);
+        HAPAssert(lightBulbRequirements.ip.numOutboundBufferBytes <= sizeof ipOutboundBuffer);
+        HAPAssert(lightBulbRequirements.ip.numEventNotifications <= HAPArrayCount(ipEventNotifications));
+        HAPAssert(lightBulbRequirements.ip.numReadContexts <= HAPArrayCount(ipReadContexts));
+        HAPAssert(lightBulbRequirements.ip.numWriteContexts <= HAPArrayCount(ipWriteContexts));
+        HAPAssert(lightBulbRequirements.ip.numScratchBufferBytes <= sizeof ipScratchBuffer);
+        ipSessions[0].inboundBuffer.bytes = ipInboundBuffer;
+        ipSessions[0].inboundBuffer.numBytes = lightBulbRequirements.ip.numInboundBufferBytes;
+        ipSessions[0].outboundBuffer.bytes = ipOutboundBuffer;
+        ipSessions[0].outboundBuffer.numBytes = lightBulbRequirements.ip.numOutboundBufferBytes;
+        ipSessions[0].eventNotifications = ipEventNotifications;
+        ipSessions[0].numEventNotifications = lightBulbRequirements.ip.numEventNotifications;
+        static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+        ipAccessoryServerStorage = (HAPIPAccessoryServerStorage) {
+            .sessions = ipSessions,
+            .numSessions = HAPArrayCount(ipSessions),
+            .readContexts = ipReadContexts,
+            .numReadContexts = lightBulbRequirements.ip.numReadContexts,
+            .writeContexts = ipWriteContexts,
+            .numWriteContexts = lightBulbRequirements.ip.numWriteContexts,
+            .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = lightBulbRequirements.ip.numScratchBufferBytes }
+        };
+
+        static HAPBLEGATTTableElementRef gattTableElements[32];
+        static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+        static HAPSessionRef session;
+        static uint8_t procedureBytes[4096];
+        static HAPBLEProcedureRef procedures[1];
+        HAPAssert(lightBulbRequirements.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+        HAPAssert(lightBulbRequirements.ble.numProcedureBufferBytes <= sizeof procedureBytes);
+        static HAPBLEAccessoryServerStorage bleAccessoryServerStorage;
+        bleAccessoryServerStorage = (HAPBLEAccessoryServerStorage) {
+            .gattTableElements = gattTableElements,
+            .numGATTTableElements = lightBulbRequirements.ble.numGATTTableElements,
+            .sessionCacheElements = sessionCacheElements,
+            .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+            .session = &session,
+            .procedures = procedures,
+            .numProcedures = HAPArrayCount(procedures),
+            .procedureBuffer = { .bytes = procedureBytes,
+                                 .numBytes = lightBulbRequirements.ble.numProcedureBufferBytes },
+        };
+
+        static HAPAccessoryServerRef accessoryServer;
+        HAPAccessoryServerCreate(
+                &accessoryServer,
+                &(const HAPAccessoryServerOptions) {
+                        .maxPairings = kHAPPairingStorage_MinElements,
+                        .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                                .accessoryServerStorage = &ipAccessoryServerStorage },
+                        .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                                 .accessoryServerStorage = &bleAccessoryServerStorage,
+                                 .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                                 .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+                &platform,
+                &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+                /* context: */ NULL);
+
+        // The accessory identity is created on the first start. Pair a controller afterwards.
+        HAPAccessoryServerStart(&accessoryServer, &lightBulbAccessory);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+        HAPAccessoryServerStop(&accessoryServer);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+        {
+            HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+            HAP_ed25519_public_key(controllerLTPK, controllerLTSK);
+            HAPControllerPairingIdentifier pairingIdentifier;
+            HAPRawBufferZero(&pairingIdentifier, sizeof pairingIdentifier);
+            HAPRawBufferCopyBytes(pairingIdentifier.bytes, kControllerPairingID, sizeof kControllerPairingID - 1);
+            pairingIdentifier.numBytes = sizeof kControllerPairingID - 1;
+            HAPControllerPublicKey publicKey;
+            HAPRawBufferCopyBytes(publicKey.bytes, controllerLTPK, sizeof publicKey.bytes);
+            err = HAPLegacyImportControllerPairing(
+                    platform.keyValueStore,
+                    /* pairingIndex: */ 0,
+                    &pairingIdentifier,
+                    &publicKey,
+                    /* isAdmin: */ true);
+            HAPAssert(!err);
+        }
+        HAPAccessoryServerStart(&accessoryServer, &lightBulbAccessory);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+        const uint8_t* accessoryLTPK = ((HAPAccessoryServer*) &accessoryServer)->identity.ed_LTPK;
+
+        // Escaped JSON representation of the name value.
+        static char escapedName[8192];
+        size_t numEscapedNameBytes = 0;
+        HAPAssert(2 + 6 * (size_t) nameCharacteristic.constraints.maxLength <= sizeof escapedName);
+        escapedName[numEscapedNameBytes++] = '"';
+        for (size_t i = 0; i < nameCharacteristic.constraints.maxLength; i++) {
+            HAPRawBufferCopyBytes(&escapedName[numEscapedNameBytes], "\\u0001", 6);
+            numEscapedNameBytes += 6;
+        }
+        escapedName[numEscapedNameBytes++] = '"';
+
+        static HAPIPController controller;
+        HAPIPControllerConnect(&controller, HAPNonnull(platform.ip.tcpStreamManager), /* workerPool: */ NULL);
+        HAPPlatformClockAdvance(0);
+        err = HAPIPControllerPairVerify(
+                &controller,
+                kControllerPairingID,
+                sizeof kControllerPairingID - 1,
+                controllerLTSK,
+                controllerLTPK,
+                accessoryLTPK);
+        HAPAssert(!err);
+
+        static uint8_t response[kMaxResponseBytes];
+        size_t numResponseBytes;
+        size_t numHeaderBytes;
+        static const char okStatusLine[] = "HTTP/1.1 200 OK\r\n";
+
+        // GET /accessories: chunks exceed a frame by at most one element.
+        {
+            HAPIPControllerSendRequest(&controller, "GET", "/accessories", NULL, NULL, 0);
+            numResponseBytes = ReceiveResponse(&controller, response, sizeof response, &numHeaderBytes);
+            HAPAssert(HAPRawBufferAreEqual(response, okStatusLine, sizeof okStatusLine - 1));
+
+            static uint8_t body[kMaxResponseBytes];
+            size_t numBodyBytes = 0;
+            size_t maxChunkBytes =
+                    kHAPIPSecurityProtocol_MaxFrameBytes - 1 + lightBulbRequirements.ip.maxAccessoriesElementBytes;
+            for (size_t position = numHeaderBytes;;) {
+                size_t numChunkBytes = 0;
+                for (; response[position] != '\r'; position++) {
+                    char c = (char) response[position];
+                    numChunkBytes = numChunkBytes * 16 + (size_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+                }
+                position += 2;
+                if (!numChunkBytes) {
+                    break;
+                }
+                HAPAssert(numChunkBytes <= maxChunkBytes);
+                HAPAssert(position + numChunkBytes + 2 <= numResponseBytes);
+                HAPRawBufferCopyBytes(&body[numBodyBytes], &response[position], numChunkBytes);
+                numBodyBytes += numChunkBytes;
+                position += numChunkBytes + 2;
+            }
+            HAPAssert(numEscapedNameBytes <= lightBulbRequirements.ip.maxAccessoriesElementBytes);
+            HAPAssert(ContainsBytes(body, numBodyBytes, escapedName, numEscapedNameBytes));
+        }
+
+        // GET /characteristics with all readable characteristics and all metadata.
+        {
+            HAPIPControllerSendRequest(
+                    &controller,
+                    "GET",
+                    "/characteristics?id=1.3,1.4,1.5,1.6,1.7,1.8,1.9,1.18,1.49,1.50&meta=1&perms=1&type=1&ev=1",
+                    NULL,
+                    NULL,
+                    0);
+            numResponseBytes = ReceiveResponse(&controller, response, sizeof response, &numHeaderBytes);
+            HAPAssert(HAPRawBufferAreEqual(response, okStatusLine, sizeof okStatusLine - 1));
+            HAPAssert(numResponseBytes - numHeaderBytes <= lightBulbRequirements.ip.maxReadResponseBytes);
+            HAPAssert(ContainsBytes(
+                    &response[numHeaderBytes], numResponseBytes - numHeaderBytes, escapedName, numEscapedNameBytes));
+        }
+        HAPIPControllerClose(&controller);
+        HAPPlatformClockAdvance(0);
+
+        // BLE: the name value is read through the procedure buffer.
+        {
+            static HAPBLECentral central;
+            HAPBLECentralCreate(&central, HAPNonnull(platform.ble.blePeripheralManager), kConnectionHandle);
+            HAPBLECentralExchangeMTU(&central, 185);
+            HAPBLECentralDiscover(&central);
+            err = HAPBLECentralPairVerify(
+                    &central,
+                    kControllerPairingID,
+                    sizeof kControllerPairingID - 1,
+                    controllerLTSK,
+                    controllerLTPK,
+                    accessoryLTPK);
+            HAPAssert(!err);
+
+            const HAPBLECentralCharacteristic* nameHandle = NULL;
+            for (size_t i = 0; i < central.numCharacteristics; i++) {
+                if (central.characteristics[i].iid == nameCharacteristic.iid) {
+                    nameHandle = &central.characteristics[i];
+                }
+            }
+            HAPAssert(nameHandle);
+            uint8_t bytes[kHAPBLECentral_MaxBodyBytes];
+            size_t numBytes;
+            err = HAPBLECentralReadCharacteristic(&central, HAPNonnull(nameHandle), bytes, sizeof bytes, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes == nameCharacteristic.constraints.maxLength);
+            for (size_t i = 0; i < numBytes; i++) {
+                HAPAssert(bytes[i] == 0x01);
+            }
+            HAPBLECentralDisconnect(&central);
+        }
+
+        HAPAccessoryServerStop(&accessoryServer);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    }
+
+    return 0;
+}
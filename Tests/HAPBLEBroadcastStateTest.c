@@ -0,0 +1,395 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformKeyValueStore+Test.h"
+
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static bool lightBulbOn;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = lightBulbOn;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic onCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = true,
+                             .supportsDisconnectedNotification = true,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &onCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/**
+ * Asserts that the broadcast configuration of the On characteristic matches the expected configuration.
+ */
+static void AssertBroadcastConfiguration(
+        HAPAccessoryServerRef* server,
+        bool expectedEnabled,
+        HAPBLECharacteristicBroadcastInterval expectedInterval) {
+    bool enabled;
+    HAPBLECharacteristicBroadcastInterval interval;
+    HAPError err = HAPBLECharacteristicGetBroadcastConfiguration(
+            server, &onCharacteristic, &lightBulbService, &accessory, &enabled, &interval);
+    HAPAssert(!err);
+    HAPAssert(enabled == expectedEnabled);
+    if (enabled) {
+        HAPAssert(interval == expectedInterval);
+    }
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    HAPAccessoryServerStorageRequirements requirements;
+    HAPAccessoryServerGetStorageRequirements(
+            &accessory, /* bridgedAccessories: */ NULL, kHAPPairingStorage_MinElements, 0, &requirements);
+    static HAPBLEGATTTableElementRef gattTableElements[32];
+    HAPAssert(requirements.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2048];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server once so that the firmware update handling does not expire the provisioned key.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+
+    // Provision an admin pairing. Broadcast parameters are purged while the accessory is not paired.
+    {
+        uint8_t pairingBytes[sizeof(HAPPairingID) + sizeof(uint8_t) + sizeof(HAPPairingPublicKey) + sizeof(uint8_t)];
+        HAPRawBufferZero(pairingBytes, sizeof pairingBytes);
+        HAPRawBufferCopyBytes(&pairingBytes[0], "Controller", sizeof "Controller" - 1);
+        pairingBytes[36] = sizeof "Controller" - 1;
+        HAPPlatformRandomNumberFill(&pairingBytes[37], sizeof(HAPPairingPublicKey));
+        pairingBytes[69] = 0x01;
+        err = HAPPlatformKeyValueStoreSet(
+                platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Pairings,
+                0,
+                pairingBytes,
+                sizeof pairingBytes);
+        HAPAssert(!err);
+    }
+
+    // Provision a broadcast encryption key that does not expire during the test.
+    {
+        uint8_t parametersBytes
+                [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+                 sizeof(HAPDeviceID)];
+        HAPRawBufferZero(parametersBytes, sizeof parametersBytes);
+        HAPWriteLittleUInt16(&parametersBytes[0], 0x7FFF);
+        HAPPlatformRandomNumberFill(&parametersBytes[2], sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey));
+        err = HAPPlatformKeyValueStoreSet(
+                platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+                parametersBytes,
+                sizeof parametersBytes);
+        HAPAssert(!err);
+    }
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Enabling broadcasts is written through to the key-value store.
+    {
+        size_t numWrites = HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore);
+        err = HAPBLECharacteristicEnableBroadcastNotifications(
+                &accessoryServer,
+                &onCharacteristic,
+                &lightBulbService,
+                &accessory,
+                kHAPBLECharacteristicBroadcastInterval_20Ms);
+        HAPAssert(!err);
+        HAPAssert(HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore) == numWrites + 1);
+    }
+
+    // Configuring the same interval again does not write to the key-value store.
+    {
+        size_t numWrites = HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore);
+        err = HAPBLECharacteristicEnableBroadcastNotifications(
+                &accessoryServer,
+                &onCharacteristic,
+                &lightBulbService,
+                &accessory,
+                kHAPBLECharacteristicBroadcastInterval_20Ms);
+        HAPAssert(!err);
+        HAPAssert(HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore) == numWrites);
+    }
+
+    // Raise broadcasted events. Each event increments the GSN, which is written through to the key-value store.
+    for (size_t i = 0; i < 10; i++) {
+        HAPBLEAccessoryServerGSN gsn;
+        err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &gsn);
+        HAPAssert(!err);
+
+        lightBulbOn = !lightBulbOn;
+        HAPAccessoryServerRaiseEvent(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+        HAPPlatformClockAdvance(0);
+
+        HAPBLEAccessoryServerGSN updatedGSN;
+        err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &updatedGSN);
+        HAPAssert(!err);
+        HAPAssert(updatedGSN.gsn != gsn.gsn);
+
+        uint8_t gsnBytes[3];
+        bool found;
+        size_t numBytes;
+        err = HAPPlatformKeyValueStoreGet(
+                platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_BLEGSN,
+                gsnBytes,
+                sizeof gsnBytes,
+                &numBytes,
+                &found);
+        HAPAssert(!err);
+        HAPAssert(found);
+        HAPAssert(numBytes == sizeof gsnBytes);
+        HAPAssert(HAPReadLittleUInt16(gsnBytes) == updatedGSN.gsn);
+    }
+
+    // The state that is consulted for each broadcasted event is served from memory.
+    {
+        size_t numReads = HAPPlatformKeyValueStoreGetNumReads(platform.keyValueStore);
+        size_t numWrites = HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore);
+        for (size_t i = 0; i < 10; i++) {
+            uint16_t keyExpirationGSN;
+            err = HAPBLEAccessoryServerBroadcastGetParameters(&accessoryServer, &keyExpirationGSN, NULL, NULL);
+            HAPAssert(!err);
+            HAPAssert(keyExpirationGSN == 0x7FFF);
+
+            HAPBLEAccessoryServerGSN gsn;
+            err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &gsn);
+            HAPAssert(!err);
+
+            HAPDeviceID deviceID;
+            err = HAPBLEAccessoryServerGetDeviceID(&accessoryServer, &deviceID);
+            HAPAssert(!err);
+
+            AssertBroadcastConfiguration(&accessoryServer, true, kHAPBLECharacteristicBroadcastInterval_20Ms);
+        }
+        HAPAssert(HAPPlatformKeyValueStoreGetNumReads(platform.keyValueStore) == numReads);
+        HAPAssert(HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore) == numWrites);
+    }
+
+    // Stop accessory server.
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+
+    // Persistent state is reloaded from the key-value store when the accessory server is restarted.
+    {
+        HAPBLEAccessoryServerGSN gsn;
+        err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &gsn);
+        HAPAssert(!err);
+
+        HAPAccessoryServerStart(&accessoryServer, &accessory);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+        AssertBroadcastConfiguration(&accessoryServer, true, kHAPBLECharacteristicBroadcastInterval_20Ms);
+
+        HAPBLEAccessoryServerGSN reloadedGSN;
+        err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &reloadedGSN);
+        HAPAssert(!err);
+        HAPAssert(reloadedGSN.gsn == gsn.gsn);
+    }
+
+    // Disabling the last broadcast removes the configuration from the key-value store.
+    {
+        err = HAPBLECharacteristicDisableBroadcastNotifications(
+                &accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+        HAPAssert(!err);
+        AssertBroadcastConfiguration(&accessoryServer, false, kHAPBLECharacteristicBroadcastInterval_20Ms);
+
+        size_t numWrites = HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore);
+        err = HAPBLECharacteristicDisableBroadcastNotifications(
+                &accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+        HAPAssert(!err);
+        HAPAssert(HAPPlatformKeyValueStoreGetNumWrites(platform.keyValueStore) == numWrites);
+    }
+
+    // Broadcasts of multiple characteristics are kept sorted by instance ID, in memory and in the key-value store.
+    {
+        static HAPBoolCharacteristic characteristics[kHAPBLECharacteristicBroadcastConfiguration_MaxBroadcasts];
+        for (size_t i = 0; i < HAPArrayCount(characteristics); i++) {
+            characteristics[i] = onCharacteristic;
+            characteristics[i].iid = 0x100 + 2 * i;
+        }
+
+        // Enable in an order that inserts at the front, in the middle and at the end.
+        for (size_t i = 0; i < HAPArrayCount(characteristics); i++) {
+            size_t j = (i * 17) % HAPArrayCount(characteristics);
+            err = HAPBLECharacteristicEnableBroadcastNotifications(
+                    &accessoryServer,
+                    &characteristics[j],
+                    &lightBulbService,
+                    &accessory,
+                    j % 2 ? kHAPBLECharacteristicBroadcastInterval_1280Ms :
+                            kHAPBLECharacteristicBroadcastInterval_20Ms);
+            HAPAssert(!err);
+        }
+        static HAPBoolCharacteristic extraCharacteristic;
+        extraCharacteristic = onCharacteristic;
+        extraCharacteristic.iid = 0x101;
+        err = HAPBLECharacteristicEnableBroadcastNotifications(
+                &accessoryServer,
+                &extraCharacteristic,
+                &lightBulbService,
+                &accessory,
+                kHAPBLECharacteristicBroadcastInterval_20Ms);
+        HAPAssert(err == kHAPError_Unknown);
+
+        // Disable every third characteristic.
+        for (size_t i = 0; i < HAPArrayCount(characteristics); i += 3) {
+            err = HAPBLECharacteristicDisableBroadcastNotifications(
+                    &accessoryServer, &characteristics[i], &lightBulbService, &accessory);
+            HAPAssert(!err);
+        }
+
+        for (size_t restart = 0; restart < 2; restart++) {
+            uint8_t bytes[kHAPBLECharacteristicBroadcastConfiguration_MaxBytes];
+            bool found;
+            size_t numBytes;
+            err = HAPPlatformKeyValueStoreGet(
+                    platform.keyValueStore,
+                    kHAPKeyValueStoreDomain_CharacteristicConfiguration,
+                    0,
+                    bytes,
+                    sizeof bytes,
+                    &numBytes,
+                    &found);
+            HAPAssert(!err);
+            HAPAssert(found);
+            HAPAssert(HAPReadLittleUInt16(bytes) == accessory.aid);
+
+            size_t o = 2;
+            for (size_t i = 0; i < HAPArrayCount(characteristics); i++) {
+                HAPBLECharacteristicBroadcastInterval expectedInterval =
+                        i % 2 ? kHAPBLECharacteristicBroadcastInterval_1280Ms :
+                                kHAPBLECharacteristicBroadcastInterval_20Ms;
+                bool enabled;
+                HAPBLECharacteristicBroadcastInterval interval;
+                err = HAPBLECharacteristicGetBroadcastConfiguration(
+                        &accessoryServer, &characteristics[i], &lightBulbService, &accessory, &enabled, &interval);
+                HAPAssert(!err);
+                HAPAssert(enabled == (i % 3 != 0));
+                if (enabled) {
+                    HAPAssert(interval == expectedInterval);
+                    HAPAssert(o + 3 <= numBytes);
+                    HAPAssert(HAPReadLittleUInt16(&bytes[o]) == characteristics[i].iid);
+                    HAPAssert(bytes[o + 2] == expectedInterval);
+                    o += 3;
+                }
+            }
+            HAPAssert(o == numBytes);
+
+            // Reload from the key-value store.
+            HAPAccessoryServerStop(&accessoryServer);
+            HAPPlatformClockAdvance(0);
+            HAPAccessoryServerStart(&accessoryServer, &accessory);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+        }
+    }
+
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+/** Length of the Char Value. Spans three TLV fragments. */
+#define kNumValueBytes ((size_t) 600)
+
+/** Length of the additional authorization data. Spans two TLV fragments. */
+#define kNumAuthDataBytes ((size_t) 300)
+
+static uint8_t writtenValue[kNumValueBytes];
+static size_t numWrittenValueBytes;
+static uint8_t writtenAuthData[kNumAuthDataBytes];
+static size_t numWrittenAuthDataBytes;
+static bool writtenRemote;
+static size_t numWrites;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleDataWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicWriteRequest* request,
+        const void* valueBytes,
+        size_t numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(numValueBytes <= sizeof writtenValue);
+    HAPRawBufferCopyBytes(writtenValue, valueBytes, numValueBytes);
+    numWrittenValueBytes = numValueBytes;
+
+    HAPAssert(request->authorizationData.numBytes <= sizeof writtenAuthData);
+    if (request->authorizationData.bytes) {
+        HAPRawBufferCopyBytes(
+                writtenAuthData, HAPNonnullVoid(request->authorizationData.bytes), request->authorizationData.numBytes);
+    }
+    numWrittenAuthDataBytes = request->authorizationData.numBytes;
+    writtenRemote = request->remote;
+    numWrites++;
+    return kHAPError_None;
+}
+
+static const HAPUUID kDataCharacteristicType = { { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                   0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00 } };
+
+static const HAPDataCharacteristic dataCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = 0x32,
+    .characteristicType = &kDataCharacteristicType,
+    .debugDescription = "data",
+    .manufacturerDescription = NULL,
+    .properties = { .readable = false,
+                    .writable = true,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = true,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = kNumValueBytes },
+    .callbacks = { .handleRead = NULL, .handleWrite = HandleDataWrite }
+};
+
+static const HAPService service = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &dataCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &service, NULL } };
+
+static uint8_t valueBytes[kNumValueBytes];
+static uint8_t authDataBytes[kNumAuthDataBytes];
+
+/**
+ * Layout of the HAP-Characteristic-Write-Request body.
+ */
+typedef enum {
+    /** Char Value, Return-Response, and an unknown item. */
+    kLayout_Value,
+
+    /** Additional authorization data before the Char Value. */
+    kLayout_AuthDataFirst,
+
+    /** Additional authorization data after the Char Value. */
+    kLayout_AuthDataLast
+} Layout;
+
+/**
+ * Serializes a HAP-Characteristic-Write-Request body and parses it in a buffer with the given amount of free space.
+ */
+static HAPError ParseAndWrite(Layout layout, size_t numFreeBytes, bool* hasReturnResponse) {
+    static uint8_t bytes[2048];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+
+    HAPError err;
+    const HAPTLV valueTLV = { .type = kHAPBLEPDUTLVType_Value,
+                              .value = { .bytes = valueBytes, .numBytes = sizeof valueBytes } };
+    const HAPTLV authDataTLV = { .type = kHAPBLEPDUTLVType_AdditionalAuthorizationData,
+                                 .value = { .bytes = authDataBytes, .numBytes = sizeof authDataBytes } };
+    const HAPTLV originTLV = { .type = kHAPBLEPDUTLVType_Origin,
+                               .value = { .bytes = (const uint8_t[]) { 1 }, .numBytes = 1 } };
+    switch (layout) {
+        case kLayout_Value: {
+            err = HAPTLVWriterAppend(
+                    &writer,
+                    &(const HAPTLV) { .type = 0xFE, .value = { .bytes = authDataBytes, .numBytes = 4 } });
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(&writer, &valueTLV);
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(
+                    &writer,
+                    &(const HAPTLV) { .type = kHAPBLEPDUTLVType_ReturnResponse,
+                                      .value = { .bytes = (const uint8_t[]) { 1 }, .numBytes = 1 } });
+            HAPAssert(!err);
+        } break;
+        case kLayout_AuthDataFirst: {
+            err = HAPTLVWriterAppend(&writer, &authDataTLV);
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(&writer, &originTLV);
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(&writer, &valueTLV);
+            HAPAssert(!err);
+        } break;
+        case kLayout_AuthDataLast: {
+            err = HAPTLVWriterAppend(&writer, &valueTLV);
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(&writer, &originTLV);
+            HAPAssert(!err);
+            err = HAPTLVWriterAppend(&writer, &authDataTLV);
+            HAPAssert(!err);
+        } break;
+    }
+    void* body;
+    size_t numBodyBytes;
+    HAPTLVWriterGetBuffer(&writer, &body, &numBodyBytes);
+    HAPAssert(numBodyBytes + numFreeBytes <= sizeof bytes);
+
+    // Free space after the body is filled with garbage.
+    for (size_t i = 0; i < numFreeBytes; i++) {
+        bytes[numBodyBytes + i] = 0xA5;
+    }
+
+    static HAPAccessoryServerRef server;
+    static HAPSessionRef session;
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreateWithOptions(
+            &reader,
+            &(const HAPTLVReaderOptions) {
+                    .bytes = body, .numBytes = numBodyBytes, .maxBytes = numBodyBytes + numFreeBytes });
+    bool hasExpired;
+    numWrites = 0;
+    err = HAPBLECharacteristicParseAndWriteValue(
+            &server,
+            &session,
+            &dataCharacteristic,
+            &service,
+            &accessory,
+            &reader,
+            /* timedWriteStartTime: */ NULL,
+            &hasExpired,
+            hasReturnResponse);
+    HAPAssert(!hasExpired);
+    return err;
+}
+
+int main() {
+    for (size_t i = 0; i < sizeof valueBytes; i++) {
+        valueBytes[i] = (uint8_t) i;
+    }
+    for (size_t i = 0; i < sizeof authDataBytes; i++) {
+        authDataBytes[i] = (uint8_t)(0xFF - i);
+    }
+
+    HAPError err;
+    bool hasReturnResponse;
+
+    // Every layout is parsed without free space, with space for just the NULL terminator, and with more free space.
+    static const size_t numFreeBytes[] = { 0, 1, 64 };
+    for (size_t i = 0; i < HAPArrayCount(numFreeBytes); i++) {
+        HAPLogInfo(&kHAPLog_Default, "Testing with %zu free bytes.", numFreeBytes[i]);
+
+        err = ParseAndWrite(kLayout_Value, numFreeBytes[i], &hasReturnResponse);
+        HAPAssert(!err);
+        HAPAssert(numWrites == 1);
+        HAPAssert(hasReturnResponse);
+        HAPAssert(!writtenRemote);
+        HAPAssert(numWrittenValueBytes == sizeof valueBytes);
+        HAPAssert(HAPRawBufferAreEqual(writtenValue, valueBytes, sizeof valueBytes));
+        HAPAssert(!numWrittenAuthDataBytes);
+
+        Layout authDataLayouts[] = { kLayout_AuthDataFirst, kLayout_AuthDataLast };
+        for (size_t j = 0; j < HAPArrayCount(authDataLayouts); j++) {
+            err = ParseAndWrite(authDataLayouts[j], numFreeBytes[i], &hasReturnResponse);
+            HAPAssert(!err);
+            HAPAssert(numWrites == 1);
+            HAPAssert(!hasReturnResponse);
+            HAPAssert(writtenRemote);
+            HAPAssert(numWrittenValueBytes == sizeof valueBytes);
+            HAPAssert(HAPRawBufferAreEqual(writtenValue, valueBytes, sizeof valueBytes));
+            HAPAssert(numWrittenAuthDataBytes == sizeof authDataBytes);
+            HAPAssert(HAPRawBufferAreEqual(writtenAuthData, authDataBytes, sizeof authDataBytes));
+        }
+    }
+
+    // Malformed bodies are rejected before the write handler is called.
+    {
+        static HAPAccessoryServerRef server;
+        static HAPSessionRef session;
+        static const struct {
+            uint8_t bytes[8];
+            size_t numBytes;
+        } bodies[] = {
+            // Missing Char Value.
+            { { kHAPBLEPDUTLVType_ReturnResponse, 1, 1 }, 3 },
+            // Duplicate Char Value.
+            { { kHAPBLEPDUTLVType_Value, 1, 0, kHAPBLEPDUTLVType_Value, 1, 0 }, 6 },
+            // Incomplete Char Value.
+            { { kHAPBLEPDUTLVType_Value, 4, 0, 0 }, 4 },
+            // Invalid Return-Response.
+            { { kHAPBLEPDUTLVType_Value, 1, 0, kHAPBLEPDUTLVType_ReturnResponse, 1, 2 }, 6 },
+        };
+        for (size_t i = 0; i < HAPArrayCount(bodies); i++) {
+            uint8_t bytes[16];
+            HAPRawBufferCopyBytes(bytes, bodies[i].bytes, bodies[i].numBytes);
+            HAPTLVReaderRef reader;
+            HAPTLVReaderCreateWithOptions(
+                    &reader,
+                    &(const HAPTLVReaderOptions) {
+                            .bytes = bytes, .numBytes = bodies[i].numBytes, .maxBytes = sizeof bytes });
+            bool hasExpired;
+            numWrites = 0;
+            err = HAPBLECharacteristicParseAndWriteValue(
+                    &server,
+                    &session,
+                    &dataCharacteristic,
+                    &service,
+                    &accessory,
+                    &reader,
+                    /* timedWriteStartTime: */ NULL,
+                    &hasExpired,
+                    &hasReturnResponse);
+            HAPAssert(err == kHAPError_InvalidData);
+            HAPAssert(!numWrites);
+        }
+    }
+
+    return 0;
+}
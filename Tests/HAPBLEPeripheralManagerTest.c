@@ -0,0 +1,297 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Test.h"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+/** Number of light bulb services that are added to the template database. */
+#define kNumLightBulbs ((size_t) 64)
+
+/** Connection handle of the simulated central. */
+#define kConnectionHandle ((HAPPlatformBLEPeripheralManagerConnectionHandle) 0x0042)
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+static HAPBoolCharacteristic lightBulbOnCharacteristics[kNumLightBulbs];
+static const HAPCharacteristic* lightBulbCharacteristics[kNumLightBulbs][2];
+static HAPService lightBulbServices[kNumLightBulbs];
+static const HAPService* services[3 + kNumLightBulbs + 1];
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = services,
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/**
+ * Adds light bulb services to the template database so that the GATT table is larger than usual.
+ */
+static void PrepareDatabase(void) {
+    services[0] = &accessoryInformationService;
+    services[1] = &hapProtocolInformationService;
+    services[2] = &pairingService;
+    for (size_t i = 0; i < kNumLightBulbs; i++) {
+        uint64_t iid = 0x100 + i * 0x10;
+        lightBulbOnCharacteristics[i] = (HAPBoolCharacteristic) {
+            .format = kHAPCharacteristicFormat_Bool,
+            .iid = iid + 1,
+            .characteristicType = &kHAPCharacteristicType_On,
+            .debugDescription = kHAPCharacteristicDebugDescription_On,
+            .properties = { .readable = true, .writable = true, .supportsEventNotification = true },
+            .callbacks = { .handleRead = HandleLightBulbOnRead, .handleWrite = HandleLightBulbOnWrite }
+        };
+        lightBulbCharacteristics[i][0] = &lightBulbOnCharacteristics[i];
+        lightBulbCharacteristics[i][1] = NULL;
+        lightBulbServices[i] = (HAPService) { .iid = iid,
+                                              .serviceType = &kHAPServiceType_LightBulb,
+                                              .debugDescription = kHAPServiceDebugDescription_LightBulb,
+                                              .characteristics = lightBulbCharacteristics[i] };
+        services[3 + i] = &lightBulbServices[i];
+    }
+    services[3 + kNumLightBulbs] = NULL;
+}
+
+/**
+ * Reads the 16-bit value of a GATT attribute through the simulated central.
+ */
+HAP_RESULT_USE_CHECK
+static uint16_t ReadUInt16Attribute(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle) {
+    HAPError err;
+
+    uint8_t bytes[16];
+    size_t numBytes;
+    err = blePeripheralManager->delegate.handleReadRequest(
+            blePeripheralManager,
+            kConnectionHandle,
+            attributeHandle,
+            bytes,
+            sizeof bytes,
+            &numBytes,
+            blePeripheralManager->delegate.context);
+    HAPAssert(!err);
+    HAPAssert(numBytes == sizeof(uint16_t));
+    return HAPReadLittleUInt16(bytes);
+}
+
+/**
+ * Enables or disables BLE indications for a characteristic through the simulated central.
+ */
+static void WriteCCCDescriptor(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandle,
+        bool enable) {
+    HAPError err;
+
+    uint8_t bytes[2];
+    HAPWriteLittleUInt16(bytes, enable ? 0x0002u : 0x0000u);
+    err = blePeripheralManager->delegate.handleWriteRequest(
+            blePeripheralManager,
+            kConnectionHandle,
+            cccDescriptorHandle,
+            bytes,
+            sizeof bytes,
+            blePeripheralManager->delegate.context);
+    HAPAssert(!err);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+    PrepareDatabase();
+
+    // Prepare accessory server storage.
+    static HAPBLEGATTTableElementRef gattTableElements[kAttributeCount + 2 * kNumLightBulbs];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2048];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Import an admin pairing so that the simulated session can be marked as secured.
+    // Pairings are purged when the accessory identity is created on start, so this must happen afterwards.
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore,
+            /* pairingIndex: */ 0,
+            &(const HAPControllerPairingIdentifier) { .numBytes = 1, .bytes = { 'A' } },
+            &(const HAPControllerPublicKey) { .bytes = { 0 } },
+            /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Connect central.
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager);
+    HAPAssert(blePeripheralManager->delegate.handleConnectedCentral);
+    blePeripheralManager->delegate.handleConnectedCentral(
+            blePeripheralManager, kConnectionHandle, blePeripheralManager->delegate.context);
+
+    // Every Instance ID attribute resolves to the service or characteristic it was registered for.
+    // Services register a read-only Service Instance ID characteristic. Characteristics register a descriptor.
+    HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandles[kNumLightBulbs];
+    size_t numCCCDescriptorHandles = 0;
+    HAPPlatformBLEPeripheralManagerAttributeHandle lastIIDHandle = 0;
+    {
+        size_t serviceIndex = 0;
+        size_t characteristicIndex = 0;
+        bool isService = false;
+        for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
+            const HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
+            switch (attribute->type) {
+                case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
+                } break;
+                case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
+                    isService = true;
+                } break;
+                case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
+                    const HAPPlatformBLEPeripheralManagerCharacteristic* characteristic = &attribute->_.characteristic;
+                    if (isService) {
+                        HAPAssert(!characteristic->properties.write);
+                        const HAPService* service = HAPNonnull(accessory.services[serviceIndex]);
+                        lastIIDHandle = characteristic->valueHandle;
+                        HAPAssert(ReadUInt16Attribute(blePeripheralManager, lastIIDHandle) == service->iid);
+                        isService = false;
+                        characteristicIndex = 0;
+                        serviceIndex++;
+                        continue;
+                    }
+                    HAPAssert(characteristic->properties.write);
+                    if (characteristic->cccDescriptorHandle) {
+                        HAPAssert(ReadUInt16Attribute(blePeripheralManager, characteristic->cccDescriptorHandle) == 0);
+                        HAPAssert(numCCCDescriptorHandles < HAPArrayCount(cccDescriptorHandles));
+                        cccDescriptorHandles[numCCCDescriptorHandles++] = characteristic->cccDescriptorHandle;
+                    }
+                } break;
+                case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
+                    const HAPService* service = HAPNonnull(accessory.services[serviceIndex - 1]);
+                    const HAPBaseCharacteristic* characteristic =
+                            HAPNonnull(service->characteristics)[characteristicIndex++];
+                    HAPAssert(characteristic);
+                    lastIIDHandle = attribute->_.descriptor.handle;
+                    HAPAssert(ReadUInt16Attribute(blePeripheralManager, lastIIDHandle) == characteristic->iid);
+                } break;
+            }
+        }
+        HAPAssert(!accessory.services[serviceIndex]);
+        HAPAssert(numCCCDescriptorHandles == kNumLightBulbs);
+    }
+
+    // Mark session as secured.
+    ((HAPSession*) &session)->hap.active = true;
+    ((HAPSession*) &session)->hap.pairingID = 0;
+    HAPAssert(HAPSessionIsSecured(&session));
+
+    // Events that are raised before the central subscribes stay pending.
+    for (size_t i = 0; i < kNumLightBulbs; i++) {
+        HAPBLEPeripheralManagerRaiseEvent(
+                &accessoryServer, &lightBulbOnCharacteristics[i], &lightBulbServices[i], &accessory);
+    }
+    HAPAssert(HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(blePeripheralManager) == 0);
+
+    // Subscribing delivers the pending event of that characteristic only.
+    WriteCCCDescriptor(blePeripheralManager, cccDescriptorHandles[kNumLightBulbs - 1], true);
+    HAPAssert(HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(blePeripheralManager) == 1);
+    WriteCCCDescriptor(blePeripheralManager, cccDescriptorHandles[0], true);
+    HAPAssert(HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(blePeripheralManager) == 2);
+    HAPAssert(ReadUInt16Attribute(blePeripheralManager, cccDescriptorHandles[0]) == 0x0002);
+
+    // Subscribing to the remaining characteristics delivers the remaining pending events.
+    for (size_t i = 1; i < kNumLightBulbs - 1; i++) {
+        WriteCCCDescriptor(blePeripheralManager, cccDescriptorHandles[i], true);
+    }
+    HAPAssert(HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(blePeripheralManager) == kNumLightBulbs);
+
+    // Raising an event on a subscribed characteristic sends it immediately.
+    HAPBLEPeripheralManagerRaiseEvent(
+            &accessoryServer, &lightBulbOnCharacteristics[3], &lightBulbServices[3], &accessory);
+    HAPAssert(HAPPlatformBLEPeripheralManagerGetNumHandleValueIndications(blePeripheralManager) == kNumLightBulbs + 1);
+
+#if HAP_BENCHMARKS_ENABLED
+    {
+        uint64_t numIterations = 1000000;
+        volatile uint16_t benchmarkSink;
+        HAP_BENCHMARK("GATT read of last Instance ID attribute", numIterations, {
+            benchmarkSink = ReadUInt16Attribute(blePeripheralManager, lastIIDHandle);
+        });
+        (void) benchmarkSink;
+        HAP_BENCHMARK("Raise and send event", numIterations, {
+            HAPBLEPeripheralManagerRaiseEvent(
+                    &accessoryServer,
+                    &lightBulbOnCharacteristics[kNumLightBulbs - 1],
+                    &lightBulbServices[kNumLightBulbs - 1],
+                    &accessory);
+        });
+    }
+#endif
+
+    return 0;
+}
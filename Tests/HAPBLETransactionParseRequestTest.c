@@ -127,10 +127,124 @@ static int Test(int argc, const char* argv[]) {
     return 0;
 }
 
+/**
+ * Places continuation fragments in the combined body and reads response fragments from the response body.
+ */
+static void TestFragmentsInPlace(void) {
+    HAPError err;
+
+    static uint8_t bodyBytes[64];
+    HAPBLETransaction transaction;
+    HAPBLETransactionCreate(&transaction, bodyBytes, sizeof bodyBytes);
+    HAPAssert(!HAPBLETransactionGetWriteBuffer(&transaction, 8));
+
+    // First fragment with 6 of 20 body bytes. It cannot be placed in the combined body.
+    uint8_t fragmentBytes[32];
+    size_t o = 0;
+    fragmentBytes[o++] = 0x00; // First Fragment, Request, 1 Byte Control Field.
+    fragmentBytes[o++] = kHAPPDUOpcode_CharacteristicWrite;
+    fragmentBytes[o++] = 0x42; // TID.
+    HAPWriteLittleUInt16(&fragmentBytes[o], 0x0001);
+    o += 2;
+    HAPWriteLittleUInt16(&fragmentBytes[o], 20);
+    o += 2;
+    for (uint8_t i = 0; i < 6; i++) {
+        fragmentBytes[o++] = i;
+    }
+    err = HAPBLETransactionHandleWrite(&transaction, fragmentBytes, o);
+    HAPAssert(!err);
+
+    // Continuation fragment with 8 body bytes. Its header overlaps the previous body.
+    uint8_t* b = HAPBLETransactionGetWriteBuffer(&transaction, 2 + 8);
+    HAPAssert(b == &bodyBytes[6 - 2]);
+    b[0] = 0x80; // Continuation, Request, 1 Byte Control Field.
+    b[1] = 0x42; // TID.
+    for (uint8_t i = 0; i < 8; i++) {
+        b[2 + i] = 6 + i;
+    }
+    err = HAPBLETransactionHandleWrite(&transaction, b, 2 + 8);
+    HAPAssert(!err);
+
+    // Fragments that exceed the remaining body are not placed in the combined body.
+    HAPAssert(!HAPBLETransactionGetWriteBuffer(&transaction, 2 + 7));
+    o = 0;
+    fragmentBytes[o++] = 0x80; // Continuation, Request, 1 Byte Control Field.
+    fragmentBytes[o++] = 0x42; // TID.
+    for (uint8_t i = 0; i < 6; i++) {
+        fragmentBytes[o++] = 14 + i;
+    }
+    err = HAPBLETransactionHandleWrite(&transaction, fragmentBytes, o);
+    HAPAssert(!err);
+
+    // Get request.
+    HAPAssert(HAPBLETransactionIsRequestAvailable(&transaction));
+    HAPBLETransactionRequest request;
+    err = HAPBLETransactionGetRequest(&transaction, &request);
+    HAPAssert(!err);
+    HAPAssert(((HAPTLVReader*) &request.bodyReader)->numBytes == 20);
+    for (size_t i = 0; i < 20; i++) {
+        HAPAssert(bodyBytes[i] == i);
+    }
+
+    // Set response with 40 body bytes.
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bodyBytes, sizeof bodyBytes);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = 0x01,
+                              .value = { .bytes = (const uint8_t[38]) { 0 }, .numBytes = 38 } });
+    HAPAssert(!err);
+    void* responseBytes;
+    size_t numResponseBytes;
+    HAPTLVWriterGetBuffer(&writer, &responseBytes, &numResponseBytes);
+    HAPAssert(numResponseBytes == 40);
+    for (size_t i = 0; i < numResponseBytes; i++) {
+        bodyBytes[i] = (uint8_t) i;
+    }
+    HAPBLETransactionSetResponse(&transaction, kHAPBLEPDUStatus_Success, &writer);
+
+    // The first fragment is serialized into the output buffer.
+    uint8_t bytes[16];
+    const void* fragment;
+    size_t numBytes;
+    bool isFinalFragment;
+    err = HAPBLETransactionHandleReadInPlace(
+            &transaction, bytes, sizeof bytes, &fragment, &numBytes, &isFinalFragment);
+    HAPAssert(!err);
+    HAPAssert(fragment == bytes);
+    HAPAssert(numBytes == sizeof bytes);
+    HAPAssert(!isFinalFragment);
+    HAPAssert(bytes[0] == 0x02); // First Fragment, Response, 1 Byte Control Field.
+    HAPAssert(bytes[1] == 0x42); // TID.
+    HAPAssert(bytes[2] == kHAPBLEPDUStatus_Success);
+    HAPAssert(HAPReadLittleUInt16(&bytes[3]) == 40);
+    for (size_t i = 0; i < 11; i++) {
+        HAPAssert(bytes[5 + i] == i);
+    }
+
+    // Continuation fragments are assembled in the response body.
+    for (size_t offset = 11; offset < 40;) {
+        err = HAPBLETransactionHandleReadInPlace(
+                &transaction, bytes, sizeof bytes, &fragment, &numBytes, &isFinalFragment);
+        HAPAssert(!err);
+        HAPAssert(fragment == &bodyBytes[offset - 2]);
+        const uint8_t* f = fragment;
+        HAPAssert(f[0] == 0x82); // Continuation, Response, 1 Byte Control Field.
+        HAPAssert(f[1] == 0x42); // TID.
+        for (size_t i = 2; i < numBytes; i++) {
+            HAPAssert(f[i] == offset + i - 2);
+        }
+        offset += numBytes - 2;
+        HAPAssert(isFinalFragment == (offset == 40));
+    }
+}
+
 int main(int argc HAP_UNUSED, char* argv[] HAP_UNUSED) {
     for (size_t i = 0; i < HAPArrayCount(TestArgs); ++i) {
         HAPAssert(Test(TestArgs[i][6] ? 7 : 6, TestArgs[i]) == 0);
     }
 
+    TestFragmentsInPlace();
+
     return 0;
 }
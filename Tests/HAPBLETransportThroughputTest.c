@@ -0,0 +1,424 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Test.h"
+
+#include "Harness/HAPBLECentral.c"
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+/** Connection handle of the simulated central. */
+#define kConnectionHandle ((HAPPlatformBLEPeripheralManagerConnectionHandle) 0x0042)
+
+/** Length of the value that is transferred through the data characteristic. */
+#define kDataValueBytes ((size_t) 1024)
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static bool lightBulbOn;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = lightBulbOn;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    lightBulbOn = value;
+    return kHAPError_None;
+}
+
+static uint8_t dataValue[kDataValueBytes];
+static size_t numDataValueBytes;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleDataRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicReadRequest* request HAP_UNUSED,
+        void* valueBytes,
+        size_t maxValueBytes,
+        size_t* numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(numDataValueBytes <= maxValueBytes);
+    HAPRawBufferCopyBytes(valueBytes, dataValue, numDataValueBytes);
+    *numValueBytes = numDataValueBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleDataWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicWriteRequest* request HAP_UNUSED,
+        const void* valueBytes,
+        size_t numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(numValueBytes <= sizeof dataValue);
+    HAPRawBufferCopyBytes(dataValue, valueBytes, numValueBytes);
+    numDataValueBytes = numValueBytes;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic onCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+/** Vendor-specific characteristic type of the data characteristic. */
+static const HAPUUID kDataCharacteristicType = {
+    { 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x01, 0xF0, 0x00, 0xA0 }
+};
+
+static const HAPDataCharacteristic dataCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = 0x32,
+    .characteristicType = &kDataCharacteristicType,
+    .debugDescription = "data",
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = false,
+                    .writeRequiresAdminPermissions = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = kDataValueBytes },
+    .callbacks = { .handleRead = HandleDataRead, .handleWrite = HandleDataWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &onCharacteristic, &dataCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/** Controller pairing that is used for Pair Verify. */
+static const char kControllerPairingID[] = "3AF8E4D1-0E3B-4B6A-9C1F-2D6B0F7A5C11";
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t controllerLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Connects the simulated central and establishes a secured session.
+ */
+static void ConnectCentral(
+        HAPBLECentral* central,
+        HAPAccessoryServerRef* server,
+        uint16_t mtu,
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager) {
+    HAPError err;
+
+    HAPBLECentralCreate(central, blePeripheralManager, kConnectionHandle);
+    HAPBLECentralExchangeMTU(central, mtu);
+    HAPAssert(central->mtu == mtu);
+    HAPBLECentralDiscover(central);
+    err = HAPBLECentralPairVerify(
+            central,
+            kControllerPairingID,
+            sizeof kControllerPairingID - 1,
+            controllerLTSK,
+            controllerLTPK,
+            ((HAPAccessoryServer*) server)->identity.ed_LTPK);
+    HAPAssert(!err);
+}
+
+/**
+ * Writes a value to the data characteristic, reads it back and returns the number of ATT PDUs that were exchanged.
+ */
+HAP_RESULT_USE_CHECK
+static size_t TransferDataValue(HAPBLECentral* central, const HAPBLECentralCharacteristic* characteristic) {
+    HAPError err;
+
+    uint8_t bytes[kDataValueBytes];
+    HAPPlatformRandomNumberFill(bytes, sizeof bytes);
+
+    size_t numPDUs = central->statistics.numPDUsSent + central->statistics.numPDUsReceived;
+    err = HAPBLECentralWriteCharacteristic(central, characteristic, bytes, sizeof bytes);
+    HAPAssert(!err);
+    HAPAssert(numDataValueBytes == sizeof bytes);
+    HAPAssert(HAPRawBufferAreEqual(dataValue, bytes, sizeof bytes));
+
+    uint8_t readBytes[kDataValueBytes];
+    size_t numReadBytes;
+    err = HAPBLECentralReadCharacteristic(central, characteristic, readBytes, sizeof readBytes, &numReadBytes);
+    HAPAssert(!err);
+    HAPAssert(numReadBytes == sizeof bytes);
+    HAPAssert(HAPRawBufferAreEqual(readBytes, bytes, sizeof bytes));
+    return central->statistics.numPDUsSent + central->statistics.numPDUsReceived - numPDUs;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    HAPAccessoryServerStorageRequirements requirements;
+    HAPAccessoryServerGetStorageRequirements(
+            &accessory, /* bridgedAccessories: */ NULL, kHAPPairingStorage_MinElements, 0, &requirements);
+    static HAPBLEGATTTableElementRef gattTableElements[32];
+    HAPAssert(requirements.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[4096];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server once so that the accessory identity is created.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+
+    // Provision an admin pairing.
+    {
+        HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+        HAP_ed25519_public_key(controllerLTPK, controllerLTSK);
+        HAPControllerPairingIdentifier pairingIdentifier;
+        HAPRawBufferZero(&pairingIdentifier, sizeof pairingIdentifier);
+        HAPRawBufferCopyBytes(pairingIdentifier.bytes, kControllerPairingID, sizeof kControllerPairingID - 1);
+        pairingIdentifier.numBytes = sizeof kControllerPairingID - 1;
+        HAPControllerPublicKey publicKey;
+        HAPRawBufferCopyBytes(publicKey.bytes, controllerLTPK, sizeof publicKey.bytes);
+        err = HAPLegacyImportControllerPairing(
+                platform.keyValueStore, /* pairingIndex: */ 0, &pairingIdentifier, &publicKey, /* isAdmin: */ true);
+        HAPAssert(!err);
+    }
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager);
+
+    // Transfer values at different ATT_MTUs. Larger ATT_MTUs need fewer ATT PDUs for the same value.
+    static const uint16_t mtus[] = { 23, 185, 512 };
+    size_t numPDUsPerMTU[HAPArrayCount(mtus)];
+    static HAPBLECentral central;
+    for (size_t i = 0; i < HAPArrayCount(mtus); i++) {
+        ConnectCentral(&central, &accessoryServer, mtus[i], blePeripheralManager);
+        HAPAssert(HAPSessionIsSecured(&session));
+
+        const HAPBLECentralCharacteristic* onHandle =
+                HAPBLECentralFindCharacteristic(&central, &kHAPCharacteristicType_On);
+        HAPAssert(onHandle);
+        HAPAssert(onHandle->iid == onCharacteristic.iid);
+        HAPAssert(onHandle->cccDescriptorHandle);
+        const HAPBLECentralCharacteristic* dataHandle =
+                HAPBLECentralFindCharacteristic(&central, &kDataCharacteristicType);
+        HAPAssert(dataHandle);
+        HAPAssert(dataHandle->iid == dataCharacteristic.iid);
+
+        // Bool values fit into a single fragment in each direction.
+        for (size_t j = 0; j < 2; j++) {
+            bool value = j % 2 == 0;
+            size_t numFragmentsSent = central.statistics.numFragmentsSent;
+            size_t numFragmentsReceived = central.statistics.numFragmentsReceived;
+            size_t numClockReads = HAPPlatformClockGetNumReads();
+            err = HAPBLECentralWriteCharacteristic(&central, onHandle, &(const uint8_t) { value }, sizeof(uint8_t));
+            HAPAssert(!err);
+            HAPAssert(lightBulbOn == value);
+
+            uint8_t bytes[1];
+            size_t numBytes;
+            err = HAPBLECentralReadCharacteristic(&central, onHandle, bytes, sizeof bytes, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes == 1 && bytes[0] == value);
+            HAPAssert(central.statistics.numFragmentsSent == numFragmentsSent + 2);
+            HAPAssert(central.statistics.numFragmentsReceived == numFragmentsReceived + 2);
+
+            // Procedures only use the coarse clock, which the run loop samples when it wakes up.
+            HAPAssert(HAPPlatformClockGetNumReads() == numClockReads);
+        }
+
+        // Long values are fragmented.
+        numPDUsPerMTU[i] = TransferDataValue(&central, dataHandle);
+        HAPLog(
+                &kHAPLog_Default,
+                "ATT_MTU %u: %zu ATT PDUs to write and read %zu bytes.",
+                mtus[i],
+                numPDUsPerMTU[i],
+                kDataValueBytes);
+        if (i) {
+            HAPAssert(numPDUsPerMTU[i] < numPDUsPerMTU[i - 1]);
+        }
+
+        // Fragments that fit into an ATT Write Request avoid Prepare Write Requests.
+        // The default ATT_MTU is too small to carry an encrypted request header in a single ATT Write Request.
+        if (central.mtu - 3 >= CHACHA20_POLY1305_TAG_BYTES + 7) {
+            central.maxFragmentBytes = (size_t)(central.mtu - 3);
+            size_t numFragmentsSent = central.statistics.numFragmentsSent;
+            size_t numPDUs = TransferDataValue(&central, dataHandle);
+            HAPAssert(central.statistics.numFragmentsSent - numFragmentsSent >= kDataValueBytes / central.mtu);
+            HAPAssert(numPDUs < numPDUsPerMTU[i]);
+            HAPLog(
+                    &kHAPLog_Default,
+                    "ATT_MTU %u: %zu ATT PDUs with fragments of %zu bytes.",
+                    mtus[i],
+                    numPDUs,
+                    central.maxFragmentBytes);
+            central.maxFragmentBytes = 0;
+        }
+
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+
+    // Subscribed characteristics are indicated.
+    {
+        ConnectCentral(&central, &accessoryServer, 185, blePeripheralManager);
+        const HAPBLECentralCharacteristic* onHandle =
+                HAPBLECentralFindCharacteristic(&central, &kHAPCharacteristicType_On);
+        HAPAssert(onHandle);
+        HAPBLECentralEnableEvents(&central, onHandle);
+        HAPBLECentralProcessIndications(&central);
+        size_t numIndications = central.statistics.numIndications;
+
+        for (size_t i = 0; i < 4; i++) {
+            lightBulbOn = !lightBulbOn;
+            HAPAccessoryServerRaiseEvent(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+            HAPPlatformClockAdvance(0);
+            HAPBLECentralProcessIndications(&central);
+            HAPAssert(central.statistics.numIndications == numIndications + i + 1);
+
+            uint8_t bytes[1];
+            size_t numBytes;
+            err = HAPBLECentralReadCharacteristic(&central, onHandle, bytes, sizeof bytes, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes == 1 && bytes[0] == lightBulbOn);
+        }
+
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    for (size_t i = 0; i < HAPArrayCount(mtus); i++) {
+        static const char* const readNames[] = { "BLE read of bool value (ATT_MTU 23)",
+                                                 "BLE read of bool value (ATT_MTU 185)",
+                                                 "BLE read of bool value (ATT_MTU 512)" };
+        static const char* const transferNames[] = { "BLE write and read of 1 KB value (ATT_MTU 23)",
+                                                     "BLE write and read of 1 KB value (ATT_MTU 185)",
+                                                     "BLE write and read of 1 KB value (ATT_MTU 512)" };
+        HAPAssert(HAPArrayCount(readNames) == HAPArrayCount(mtus));
+        HAPAssert(HAPArrayCount(transferNames) == HAPArrayCount(mtus));
+
+        ConnectCentral(&central, &accessoryServer, mtus[i], blePeripheralManager);
+        const HAPBLECentralCharacteristic* onHandle =
+                HAPBLECentralFindCharacteristic(&central, &kHAPCharacteristicType_On);
+        const HAPBLECentralCharacteristic* dataHandle =
+                HAPBLECentralFindCharacteristic(&central, &kDataCharacteristicType);
+        HAPAssert(onHandle && dataHandle);
+
+        uint64_t numIterations = 10000;
+        HAP_BENCHMARK(readNames[i], numIterations, {
+            uint8_t bytes[1];
+            size_t numBytes;
+            err = HAPBLECentralReadCharacteristic(&central, HAPNonnull(onHandle), bytes, sizeof bytes, &numBytes);
+            HAPAssert(!err);
+        });
+        HAP_BENCHMARK(transferNames[i], numIterations / 10, {
+            size_t numPDUs = TransferDataValue(&central, HAPNonnull(dataHandle));
+            HAPAssert(numPDUs == numPDUsPerMTU[i]);
+        });
+
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+#endif
+
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -42,11 +42,28 @@ HAP_DIAGNOSTIC_IGNORED_CLANG("-Wfloat-equal")
         err = HAPFloatGetDescription(string, sizeof string, value); \
         HAPAssert(!err); \
         HAPLogInfo(&kHAPLog_Default, "Testing %s", string); \
+        HAPAssert(HAPFloatGetNumDescriptionBytes(value) == HAPStringGetNumBytes(string)); \
         err = HAPFloatFromString(string, &newValue); \
         HAPAssert(!err); \
         HAPAssert(value == newValue); \
     } while (0)
 
+#define TEST_DESCRIPTION(value, expectedDescription) \
+    do { \
+        HAPError err; \
+\
+        char string[kHAPFloat_MaxDescriptionBytes + 1]; \
+        err = HAPFloatGetDescription(string, sizeof string, value); \
+        HAPAssert(!err); \
+        HAPLogInfo(&kHAPLog_Default, "Testing %s", string); \
+        HAPAssert(HAPStringAreEqual(string, expectedDescription)); \
+        HAPAssert(HAPFloatGetNumDescriptionBytes(value) == sizeof expectedDescription - 1); \
+        err = HAPFloatGetDescription(string, sizeof expectedDescription, value); \
+        HAPAssert(!err); \
+        err = HAPFloatGetDescription(string, sizeof expectedDescription - 1, value); \
+        HAPAssert(err == kHAPError_OutOfResources); \
+    } while (0)
+
 #define TEST_GET_FRACTION(input, expectedValue) \
     do { \
         char string[kHAPFloat_MaxDescriptionBytes + 1]; \
@@ -140,6 +157,14 @@ int main() {
     TEST_FROM_STRING("-12.3E+20", -12.3E20F);
     TEST_FROM_STRING("-12.3E-20", -12.3E-20F);
     TEST_FROM_STRING("7.038531e-26", 0x0.AE43FDP-83F);
+    TEST_FROM_STRING("21.5", 21.5F);
+    TEST_FROM_STRING("0.1", 0.1F);
+    TEST_FROM_STRING("-273.15", -273.15F);
+    TEST_FROM_STRING("16777217", 16777216.0F);
+    TEST_FROM_STRING("16777219", 16777220.0F);
+    TEST_FROM_STRING("18446744073709551615", 18446744073709551615.0F);
+    TEST_FROM_STRING("0.00000000001", 0.00000000001F);
+    TEST_FROM_STRING("0.000000000001", 0.000000000001F);
 
     // Rounding
     TEST_FROM_STRING("16384.0029296875", 0x800002P-9F);
@@ -215,6 +240,32 @@ int main() {
     TEST_GET_DESCRIPTION(0x1.000000P127F);
     TEST_GET_DESCRIPTION(0x0.FFFFFFP128F);
 
+    // Expected descriptions.
+    TEST_DESCRIPTION(0.0F, "0");
+    TEST_DESCRIPTION(-0.0F, "-0");
+    TEST_DESCRIPTION(1.0F, "1");
+    TEST_DESCRIPTION(-1.5F, "-1.5");
+    TEST_DESCRIPTION(10.0F, "10");
+    TEST_DESCRIPTION(21.5F, "21.5");
+    TEST_DESCRIPTION(0.1F, "0.1");
+    TEST_DESCRIPTION(0.3F, "0.3");
+    TEST_DESCRIPTION(100000.0F, "100000");
+    TEST_DESCRIPTION(123456.0F, "123456");
+    TEST_DESCRIPTION(999999.0F, "999999");
+    TEST_DESCRIPTION(1000000.0F, "1e+06");
+    TEST_DESCRIPTION(1234567.0F, "1.234567e+06");
+    TEST_DESCRIPTION(0.0001F, "0.0001");
+    TEST_DESCRIPTION(-0.00012345679F, "-0.00012345679");
+    TEST_DESCRIPTION(0.00001F, "1e-05");
+    TEST_DESCRIPTION(16777216.0F, "1.6777216e+07");
+    TEST_DESCRIPTION(0x1.0P-149F, "1e-45");
+    TEST_DESCRIPTION(0x1.000000P-126F, "1.1754944e-38");
+    TEST_DESCRIPTION(0x1.FFFFFEP127F, "3.4028235e+38");
+    TEST_DESCRIPTION(INF, "inf");
+    TEST_DESCRIPTION(-INF, "-inf");
+    TEST_DESCRIPTION(NAN, "nan");
+    TEST_DESCRIPTION(-NAN, "nan");
+
 #if defined(HAP_LONG_TESTS) && HAP_LONG_TESTS != 0
     // Full to string / from string test (runs for hours)
     uint32_t bitPattern;
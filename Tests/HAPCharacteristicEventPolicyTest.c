@@ -0,0 +1,374 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleTemperatureRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleUInt8Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+/**
+ * Temperature sensor that reports changes of at least 0.5 degrees, at most once per second,
+ * and smaller changes after 10 seconds.
+ */
+static const HAPFloatCharacteristic temperatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_CurrentTemperature,
+    .debugDescription = kHAPCharacteristicDebugDescription_CurrentTemperature,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .units = kHAPCharacteristicUnits_Celsius,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 0.1f },
+    .eventPolicy = { .absoluteDeadband = 0.5f,
+                     .minimumInterval = 1 * HAPSecond,
+                     .maximumLatency = 10 * HAPSecond },
+    .callbacks = { .handleRead = HandleTemperatureRead }
+};
+
+/**
+ * Temperature sensor without event notification policy.
+ */
+static const HAPFloatCharacteristic rawTemperatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = 0x32,
+    .characteristicType = &kHAPCharacteristicType_CurrentTemperature,
+    .debugDescription = kHAPCharacteristicDebugDescription_CurrentTemperature,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .units = kHAPCharacteristicUnits_Celsius,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 0.1f },
+    .callbacks = { .handleRead = HandleTemperatureRead }
+};
+
+/**
+ * Level that reports changes of at least 10%.
+ */
+static const HAPUInt8Characteristic levelCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x33,
+    .characteristicType = &kHAPCharacteristicType_BatteryLevel,
+    .debugDescription = kHAPCharacteristicDebugDescription_BatteryLevel,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .eventPolicy = { .relativeDeadband = 0.1f },
+    .callbacks = { .handleRead = HandleUInt8Read }
+};
+
+/**
+ * Programmable switch, whose events are never filtered.
+ */
+static const HAPUInt8Characteristic switchEventCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x34,
+    .characteristicType = &kHAPCharacteristicType_ProgrammableSwitchEvent,
+    .debugDescription = kHAPCharacteristicDebugDescription_ProgrammableSwitchEvent,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .constraints = { .minimumValue = 0, .maximumValue = 2, .stepValue = 1 },
+    .eventPolicy = { .absoluteDeadband = 10, .minimumInterval = 1 * HAPSecond },
+    .callbacks = { .handleRead = HandleUInt8Read }
+};
+
+static const HAPService sensorService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_TemperatureSensor,
+    .debugDescription = kHAPServiceDebugDescription_TemperatureSensor,
+    .name = "Sensor",
+    .characteristics = (const HAPCharacteristic* const[]) { &temperatureCharacteristic,
+                                                            &rawTemperatureCharacteristic,
+                                                            &levelCharacteristic,
+                                                            &switchEventCharacteristic,
+                                                            NULL }
+};
+
+static HAPAccessoryServerRef accessoryServer;
+
+/**
+ * Number of event notifications that reached the IP server engine, per characteristic.
+ */
+static struct {
+    size_t temperature;
+    size_t rawTemperature;
+    size_t level;
+    size_t switchEvent;
+} numEvents;
+
+static HAPAccessoryServerServerEngine countingServerEngine;
+
+HAP_RESULT_USE_CHECK
+static HAPError CountingRaiseEvent(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory_) {
+    if (characteristic == &temperatureCharacteristic) {
+        numEvents.temperature++;
+    } else if (characteristic == &rawTemperatureCharacteristic) {
+        numEvents.rawTemperature++;
+    } else if (characteristic == &levelCharacteristic) {
+        numEvents.level++;
+    } else if (characteristic == &switchEventCharacteristic) {
+        numEvents.switchEvent++;
+    }
+    return HAPIPAccessoryServerServerEngine.raise_event(server, characteristic, service, accessory_);
+}
+
+static const HAPAccessoryServerServerEngine* _Nullable GetCountingServerEngine(void) {
+    return kHAPAccessoryServerTransport_IP.serverEngine.get() ? &countingServerEngine : NULL;
+}
+
+static void UpdateTemperature(const HAPAccessory* sensorAccessory, float value) {
+    HAPError err = HAPAccessoryServerUpdateFloatValue(
+            &accessoryServer, &temperatureCharacteristic, &sensorService, sensorAccessory, value);
+    HAPAssert(!err);
+}
+
+static void UpdateLevel(uint8_t value) {
+    HAPError err =
+            HAPAccessoryServerUpdateUInt8Value(&accessoryServer, &levelCharacteristic, &sensorService, &accessory, value);
+    HAPAssert(!err);
+}
+
+/**
+ * Number of cache entries.
+ */
+#define kNumCacheEntries ((size_t) 256)
+
+/**
+ * Number of bridged sensors in the benchmark.
+ */
+#define kNumBridgedSensors ((size_t) 100)
+
+int main() {
+    HAPError err;
+
+    HAPPlatformCreate();
+
+    static HAPPlatformTCPStream tcpStreams[kHAPIPSessionStorage_DefaultNumElements];
+    static HAPPlatformTCPStreamManager tcpStreamManager;
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreams,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreams) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Count event notifications that reach the IP server engine.
+    countingServerEngine = HAPIPAccessoryServerServerEngine;
+    countingServerEngine.raise_event = CountingRaiseEvent;
+    static HAPIPAccessoryServerTransport countingTransport;
+    countingTransport = kHAPAccessoryServerTransport_IP;
+    countingTransport.serverEngine.get = GetCountingServerEngine;
+
+    // Initialize accessory server.
+    static HAPCharacteristicValueCacheEntryRef valueCacheEntries[kNumCacheEntries];
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .valueCache = { .entries = valueCacheEntries, .numEntries = HAPArrayCount(valueCacheEntries) },
+                    .ip = { .transport = &countingTransport, .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // The first published value raises an event notification.
+    UpdateTemperature(&accessory, 20.0f);
+    HAPAssert(numEvents.temperature == 1);
+
+    // Changes within the absolute deadband are held back, but served to reads.
+    UpdateTemperature(&accessory, 20.2f);
+    HAPAssert(numEvents.temperature == 1);
+    HAPCharacteristicValueCacheValue value;
+    HAPAssert(HAPCharacteristicValueCacheGetValue(&accessoryServer, &temperatureCharacteristic, &accessory, &value));
+    HAPAssert(HAPFloatGetAbsoluteValue(value.floatValue - 20.2f) < 0.001f);
+
+    // Changes beyond the deadband within the minimum interval are deferred until the interval has elapsed.
+    UpdateTemperature(&accessory, 20.6f);
+    HAPAssert(numEvents.temperature == 1);
+    HAPPlatformClockAdvance(1 * HAPSecond - 1);
+    HAPAssert(numEvents.temperature == 1);
+    HAPPlatformClockAdvance(1);
+    HAPAssert(numEvents.temperature == 2);
+
+    // Changes beyond the deadband after the minimum interval raise an event notification immediately.
+    HAPPlatformClockAdvance(5 * HAPSecond);
+    UpdateTemperature(&accessory, 21.2f);
+    HAPAssert(numEvents.temperature == 3);
+
+    // Changes within the deadband are flushed after the maximum latency.
+    UpdateTemperature(&accessory, 21.3f);
+    HAPPlatformClockAdvance(5 * HAPSecond);
+    UpdateTemperature(&accessory, 21.4f);
+    HAPPlatformClockAdvance(5 * HAPSecond - 1);
+    HAPAssert(numEvents.temperature == 3);
+    HAPPlatformClockAdvance(1);
+    HAPAssert(numEvents.temperature == 4);
+    HAPAssert(HAPCharacteristicValueCacheGetValue(&accessoryServer, &temperatureCharacteristic, &accessory, &value));
+    HAPAssert(HAPFloatGetAbsoluteValue(value.floatValue - 21.4f) < 0.001f);
+
+    // Changes that return to the notified value cancel the flush.
+    UpdateTemperature(&accessory, 21.6f);
+    UpdateTemperature(&accessory, 21.4f);
+    HAPPlatformClockAdvance(20 * HAPSecond);
+    HAPAssert(numEvents.temperature == 4);
+
+    // The relative deadband is based on the value of the most recent event notification.
+    UpdateLevel(50);
+    HAPAssert(numEvents.level == 1);
+    UpdateLevel(54);
+    UpdateLevel(46);
+    HAPAssert(numEvents.level == 1);
+    UpdateLevel(55);
+    HAPAssert(numEvents.level == 2);
+    UpdateLevel(60);
+    HAPAssert(numEvents.level == 2);
+    UpdateLevel(61);
+    HAPAssert(numEvents.level == 3);
+
+    // Programmable Switch Events are never filtered.
+    for (size_t i = 0; i < 3; i++) {
+        err = HAPAccessoryServerUpdateUInt8Value(
+                &accessoryServer, &switchEventCharacteristic, &sensorService, &accessory, 0);
+        HAPAssert(!err);
+    }
+    HAPAssert(numEvents.switchEvent == 3);
+
+    // Explicitly raised event notifications are not filtered.
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &temperatureCharacteristic, &sensorService, &accessory);
+    HAPAssert(numEvents.temperature == 5);
+
+#if HAP_BENCHMARKS_ENABLED
+    // Synthetic bridge of noisy temperature sensors: each sensor reports every 100 ms, with noise of up to
+    // +/- 0.2 degrees around a value that drifts by 1 degree per minute.
+    {
+        static HAPAccessory bridgedAccessories[kNumBridgedSensors];
+        for (size_t i = 0; i < HAPArrayCount(bridgedAccessories); i++) {
+            bridgedAccessories[i] = accessory;
+            bridgedAccessories[i].aid = 2 + i;
+        }
+
+        const size_t numRounds = 6000;
+        uint32_t noiseState = 1;
+        size_t numTemperatureEvents = numEvents.temperature;
+        size_t numRawTemperatureEvents = numEvents.rawTemperature;
+        uint64_t filteredNanoseconds = 0;
+        uint64_t rawNanoseconds = 0;
+        for (size_t round = 0; round < numRounds; round++) {
+            float drift = (float) round / 600.0f;
+            for (size_t i = 0; i < HAPArrayCount(bridgedAccessories); i++) {
+                noiseState = noiseState * 1103515245 + 12345;
+                float noise = (float) ((noiseState >> 16) % 41) / 100.0f - 0.2f;
+                float reading = 20.0f + drift + noise;
+                reading = (float) (int32_t)(reading * 10.0f + 0.5f) / 10.0f;
+
+                uint64_t startNanoseconds = HAPBenchmarkGetNanoseconds();
+                UpdateTemperature(&bridgedAccessories[i], reading);
+                filteredNanoseconds += HAPBenchmarkGetNanoseconds() - startNanoseconds;
+
+                startNanoseconds = HAPBenchmarkGetNanoseconds();
+                err = HAPAccessoryServerUpdateFloatValue(
+                        &accessoryServer,
+                        &rawTemperatureCharacteristic,
+                        &sensorService,
+                        &bridgedAccessories[i],
+                        reading);
+                HAPAssert(!err);
+                rawNanoseconds += HAPBenchmarkGetNanoseconds() - startNanoseconds;
+            }
+            HAPPlatformClockAdvance(100 * HAPMillisecond);
+        }
+        numTemperatureEvents = numEvents.temperature - numTemperatureEvents;
+        numRawTemperatureEvents = numEvents.rawTemperature - numRawTemperatureEvents;
+
+        const uint64_t numIterations = numRounds * HAPArrayCount(bridgedAccessories);
+        HAPBenchmarkLogResult("Noisy sensors without event policy", numIterations, rawNanoseconds);
+        HAPBenchmarkLogResult("Noisy sensors with event policy", numIterations, filteredNanoseconds);
+        HAPLog(&kHAPLog_Default,
+               "Event notifications for %llu readings: %lu without event policy, %lu with event policy.",
+               (unsigned long long) numIterations,
+               (unsigned long) numRawTemperatureEvents,
+               (unsigned long) numTemperatureEvents);
+        HAPAssert(numTemperatureEvents < numRawTemperatureEvents / 10);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,407 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/**
+ * State of the simulated light bulb.
+ */
+static struct {
+    bool on;
+    int32_t brightness;
+    float temperature;
+
+    /** Number of read handler calls. */
+    size_t numReads;
+
+    /** Whether the write handler of the On characteristic publishes the inverse of the written value. */
+    bool publishInverseOnWrite;
+
+    /** Whether the write handler of the On characteristic fails. */
+    bool failWrite;
+} state;
+
+static HAPAccessoryServerRef accessoryServer;
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    state.numReads++;
+    *value = state.on;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server,
+        const HAPBoolCharacteristicWriteRequest* request,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    if (state.failWrite) {
+        return kHAPError_Busy;
+    }
+    state.on = value;
+    if (state.publishInverseOnWrite) {
+        HAPError err = HAPAccessoryServerUpdateBoolValue(
+                server, request->characteristic, request->service, request->accessory, !value);
+        HAPAssert(!err);
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    state.numReads++;
+    *value = state.brightness;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleTemperatureRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value,
+        void* _Nullable context HAP_UNUSED) {
+    state.numReads++;
+    *value = state.temperature;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic onCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .properties = { .readable = true, .writable = true, .supportsEventNotification = true },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+static const HAPIntCharacteristic brightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = 0x32,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead }
+};
+
+static const HAPFloatCharacteristic temperatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = 0x33,
+    .characteristicType = &kHAPCharacteristicType_CurrentTemperature,
+    .debugDescription = kHAPCharacteristicDebugDescription_CurrentTemperature,
+    .properties = { .readable = true, .supportsEventNotification = true },
+    .units = kHAPCharacteristicUnits_Celsius,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 0.5f },
+    .callbacks = { .handleRead = HandleTemperatureRead }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = "Light Bulb",
+    .characteristics = (const HAPCharacteristic* const[]) { &onCharacteristic,
+                                                            &brightnessCharacteristic,
+                                                            &temperatureCharacteristic,
+                                                            NULL }
+};
+
+static HAPSessionRef session;
+
+HAP_RESULT_USE_CHECK
+static bool ReadOn(const HAPAccessory* readAccessory) {
+    bool value;
+    HAPError err = HAPBoolCharacteristicHandleRead(
+            &accessoryServer,
+            &(const HAPBoolCharacteristicReadRequest) { .transportType = kHAPTransportType_IP,
+                                                        .session = &session,
+                                                        .characteristic = &onCharacteristic,
+                                                        .service = &lightBulbService,
+                                                        .accessory = readAccessory },
+            &value,
+            /* context: */ NULL);
+    HAPAssert(!err);
+    return value;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError WriteOn(bool value) {
+    return HAPBoolCharacteristicHandleWrite(
+            &accessoryServer,
+            &(const HAPBoolCharacteristicWriteRequest) { .transportType = kHAPTransportType_IP,
+                                                         .session = &session,
+                                                         .characteristic = &onCharacteristic,
+                                                         .service = &lightBulbService,
+                                                         .accessory = &accessory },
+            value,
+            /* context: */ NULL);
+}
+
+HAP_RESULT_USE_CHECK
+static int32_t ReadBrightness(void) {
+    int32_t value;
+    HAPError err = HAPIntCharacteristicHandleRead(
+            &accessoryServer,
+            &(const HAPIntCharacteristicReadRequest) { .transportType = kHAPTransportType_IP,
+                                                       .session = &session,
+                                                       .characteristic = &brightnessCharacteristic,
+                                                       .service = &lightBulbService,
+                                                       .accessory = &accessory },
+            &value,
+            /* context: */ NULL);
+    HAPAssert(!err);
+    return value;
+}
+
+HAP_RESULT_USE_CHECK
+static float ReadTemperature(void) {
+    float value;
+    HAPError err = HAPFloatCharacteristicHandleRead(
+            &accessoryServer,
+            &(const HAPFloatCharacteristicReadRequest) { .transportType = kHAPTransportType_IP,
+                                                         .session = &session,
+                                                         .characteristic = &temperatureCharacteristic,
+                                                         .service = &lightBulbService,
+                                                         .accessory = &accessory },
+            &value,
+            /* context: */ NULL);
+    HAPAssert(!err);
+    return value;
+}
+
+/**
+ * Number of cache entries.
+ */
+#define kNumCacheEntries ((size_t) 8)
+
+int main() {
+    HAPError err;
+
+    HAPPlatformCreate();
+
+    static HAPPlatformTCPStream tcpStreams[kHAPIPSessionStorage_DefaultNumElements];
+    static HAPPlatformTCPStreamManager tcpStreamManager;
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreams,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreams) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    static HAPCharacteristicValueCacheEntryRef valueCacheEntries[kNumCacheEntries];
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .valueCache = { .entries = valueCacheEntries, .numEntries = HAPArrayCount(valueCacheEntries) },
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Without a published value, reads call the read handler.
+    state.on = true;
+    HAPAssert(ReadOn(&accessory));
+    HAPAssert(state.numReads == 1);
+
+    // Published values are served without calling the read handler.
+    state.numReads = 0;
+    err = HAPAccessoryServerUpdateBoolValue(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory, false);
+    HAPAssert(!err);
+    err = HAPAccessoryServerUpdateIntValue(
+            &accessoryServer, &brightnessCharacteristic, &lightBulbService, &accessory, 42);
+    HAPAssert(!err);
+    HAPAssert(!ReadOn(&accessory));
+    HAPAssert(ReadBrightness() == 42);
+    HAPAssert(state.numReads == 0);
+
+    // Values that violate the constraints are rejected, and the published value is kept.
+    err = HAPAccessoryServerUpdateIntValue(
+            &accessoryServer, &brightnessCharacteristic, &lightBulbService, &accessory, 101);
+    HAPAssert(err == kHAPError_InvalidData);
+    HAPAssert(ReadBrightness() == 42);
+
+    // Float values are rounded to the step value.
+    err = HAPAccessoryServerUpdateFloatValue(
+            &accessoryServer, &temperatureCharacteristic, &lightBulbService, &accessory, 21.47f);
+    HAPAssert(!err);
+    HAPAssert(HAPFloatGetAbsoluteValue(ReadTemperature() - 21.5f) < 0.001f);
+    HAPAssert(state.numReads == 0);
+
+    // Successful writes update the published value.
+    err = WriteOn(true);
+    HAPAssert(!err);
+    HAPAssert(state.on);
+    HAPAssert(ReadOn(&accessory));
+
+    // Failed writes keep the published value.
+    state.failWrite = true;
+    err = WriteOn(false);
+    HAPAssert(err == kHAPError_Busy);
+    HAPAssert(ReadOn(&accessory));
+    state.failWrite = false;
+
+    // Values that are published by the write handler take precedence over the written value.
+    state.publishInverseOnWrite = true;
+    err = WriteOn(true);
+    HAPAssert(!err);
+    HAPAssert(!ReadOn(&accessory));
+    state.publishInverseOnWrite = false;
+    HAPAssert(state.numReads == 0);
+
+    // Invalidated values fall back to the read handler.
+    HAPAccessoryServerInvalidateValue(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+    state.on = true;
+    HAPAssert(ReadOn(&accessory));
+    HAPAssert(state.numReads == 1);
+    HAPAssert(ReadBrightness() == 42);
+    HAPAssert(state.numReads == 1);
+
+    // Writes to characteristics without a published value do not publish the written value.
+    err = WriteOn(false);
+    HAPAssert(!err);
+    state.on = true;
+    HAPAssert(ReadOn(&accessory));
+    HAPAssert(state.numReads == 2);
+    HAPAccessoryServerInvalidateValue(&accessoryServer, &brightnessCharacteristic, &lightBulbService, &accessory);
+    HAPAccessoryServerInvalidateValue(&accessoryServer, &temperatureCharacteristic, &lightBulbService, &accessory);
+
+    // Fill the cache with the same characteristic of multiple bridged accessories, and invalidate them in an order
+    // that moves entries across probe sequences.
+    {
+        static HAPAccessory bridgedAccessories[kNumCacheEntries + 1];
+        for (size_t i = 0; i < HAPArrayCount(bridgedAccessories); i++) {
+            bridgedAccessories[i] = accessory;
+            bridgedAccessories[i].aid = 2 + i;
+        }
+        for (size_t round = 0; round < 4; round++) {
+            for (size_t i = 0; i < kNumCacheEntries; i++) {
+                err = HAPAccessoryServerUpdateBoolValue(
+                        &accessoryServer, &onCharacteristic, &lightBulbService, &bridgedAccessories[i], i % 2 == 0);
+                HAPAssert(!err);
+            }
+            err = HAPAccessoryServerUpdateBoolValue(
+                    &accessoryServer,
+                    &onCharacteristic,
+                    &lightBulbService,
+                    &bridgedAccessories[kNumCacheEntries],
+                    true);
+            HAPAssert(err == kHAPError_OutOfResources);
+
+            bool isInvalidated[kNumCacheEntries];
+            HAPRawBufferZero(isInvalidated, sizeof isInvalidated);
+            for (size_t n = 0; n < kNumCacheEntries; n++) {
+                size_t i = (n * 3 + round) % kNumCacheEntries;
+                HAPAccessoryServerInvalidateValue(
+                        &accessoryServer, &onCharacteristic, &lightBulbService, &bridgedAccessories[i]);
+                isInvalidated[i] = true;
+
+                state.numReads = 0;
+                state.on = true;
+                for (size_t j = 0; j < kNumCacheEntries; j++) {
+                    HAPAssert(ReadOn(&bridgedAccessories[j]) == (isInvalidated[j] || j % 2 == 0));
+                }
+                HAPAssert(state.numReads == n + 1);
+            }
+        }
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    {
+        const size_t numIterations = 1000000;
+        state.on = true;
+
+        uint64_t startNanoseconds = HAPBenchmarkGetNanoseconds();
+        for (size_t i = 0; i < numIterations; i++) {
+            HAPAssert(ReadOn(&accessory));
+        }
+        HAPBenchmarkLogResult("Read handler", numIterations, HAPBenchmarkGetNanoseconds() - startNanoseconds);
+
+        err = HAPAccessoryServerUpdateBoolValue(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory, true);
+        HAPAssert(!err);
+        startNanoseconds = HAPBenchmarkGetNanoseconds();
+        for (size_t i = 0; i < numIterations; i++) {
+            HAPAssert(ReadOn(&accessory));
+        }
+        HAPBenchmarkLogResult("Published value", numIterations, HAPBenchmarkGetNanoseconds() - startNanoseconds);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPStringCharacteristic testCharacteristic = { .iid = 3,
+                                                            .format = kHAPCharacteristicFormat_String,
+                                                            .characteristicType = &kHAPCharacteristicType_Name,
+                                                            .properties = { .readable = true,
+                                                                            .writable = true,
+                                                                            .supportsEventNotification = true,
+                                                                            .ip = { .supportsWriteResponse = true } },
+                                                            .constraints = { .maxLength = 2048 } };
+
+static const HAPService testService = { .iid = 2,
+                                        .serviceType = &kHAPServiceType_AccessoryInformation,
+                                        .characteristics =
+                                                (const HAPCharacteristic* const[]) { &testCharacteristic, NULL } };
+
+static const HAPAccessory testAccessory = { .aid = 1, .services = (const HAPService* const[]) { &testService, NULL } };
+
+static HAPAccessoryServerRef* testAccessoryServer =
+        (HAPAccessoryServerRef*) &(HAPAccessoryServer) { .primaryAccessory = &testAccessory };
+
+/** Maximum length of a serialized message. */
+#define kMaxMessageBytes ((size_t) 4096)
+
+/** Bytes that precede a message in the buffer. */
+static const char kPrefix[] = "HTTP/1.1 204 No Content\r\n\r\n";
+
+/**
+ * Message types that are serialized with a Content-Length header.
+ */
+HAP_ENUM_BEGIN(uint8_t, MessageType) {
+    kMessageType_ReadResponse,
+    kMessageType_WriteResponse,
+    kMessageType_EventNotification
+} HAP_ENUM_END(uint8_t, MessageType);
+
+static HAPIPReadContextRef readContexts[2];
+static HAPIPWriteContextRef writeContexts[2];
+static HAPIPReadRequestParameters parameters;
+
+/** Values of the test characteristic. */
+static char value[2048 + 1];
+static char emptyValue[] = "";
+
+static void PrepareContexts(size_t numValueBytes) {
+    HAPPrecondition(numValueBytes < sizeof value);
+
+    for (size_t i = 0; i < numValueBytes; i++) {
+        value[i] = (char) ('a' + i % 26);
+    }
+    value[numValueBytes] = '\0';
+    for (size_t i = 0; i < HAPArrayCount(readContexts); i++) {
+        HAPIPReadContext* readContext = (HAPIPReadContext*) &readContexts[i];
+        HAPRawBufferZero(readContext, sizeof *readContext);
+        readContext->aid = testAccessory.aid;
+        readContext->iid = testCharacteristic.iid;
+        readContext->value.stringValue.bytes = i == 0 ? value : emptyValue;
+        readContext->value.stringValue.numBytes = i == 0 ? numValueBytes : 0;
+    }
+    for (size_t i = 0; i < HAPArrayCount(writeContexts); i++) {
+        HAPIPWriteContext* writeContext = (HAPIPWriteContext*) &writeContexts[i];
+        HAPRawBufferZero(writeContext, sizeof *writeContext);
+        writeContext->aid = testAccessory.aid;
+        writeContext->iid = testCharacteristic.iid;
+        writeContext->type = kHAPIPWriteValueType_String;
+        writeContext->value.stringValue.bytes = i == 0 ? value : emptyValue;
+        writeContext->value.stringValue.numBytes = i == 0 ? numValueBytes : 0;
+        writeContext->response = true;
+    }
+}
+
+static const char* GetStartLine(MessageType type) {
+    switch (type) {
+        case kMessageType_ReadResponse: {
+            return "HTTP/1.1 200 OK\r\n";
+        }
+        case kMessageType_WriteResponse: {
+            return "HTTP/1.1 207 Multi-Status\r\n";
+        }
+        case kMessageType_EventNotification: {
+            return "EVENT/1.0 200 OK\r\n";
+        }
+    }
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static size_t GetNumBodyBytes(MessageType type) {
+    switch (type) {
+        case kMessageType_ReadResponse: {
+            return HAPIPAccessoryProtocolGetNumCharacteristicReadResponseBytes(
+                    testAccessoryServer, readContexts, HAPArrayCount(readContexts), &parameters);
+        }
+        case kMessageType_WriteResponse: {
+            return HAPIPAccessoryProtocolGetNumCharacteristicWriteResponseBytes(
+                    testAccessoryServer, writeContexts, HAPArrayCount(writeContexts));
+        }
+        case kMessageType_EventNotification: {
+            return HAPIPAccessoryProtocolGetNumEventNotificationBytes(
+                    testAccessoryServer, readContexts, HAPArrayCount(readContexts));
+        }
+    }
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendBody(MessageType type, HAPIPByteBuffer* buffer) {
+    switch (type) {
+        case kMessageType_ReadResponse: {
+            return HAPIPAccessoryProtocolGetCharacteristicReadResponseBytes(
+                    testAccessoryServer, readContexts, HAPArrayCount(readContexts), &parameters, buffer);
+        }
+        case kMessageType_WriteResponse: {
+            return HAPIPAccessoryProtocolGetCharacteristicWriteResponseBytes(
+                    testAccessoryServer, writeContexts, HAPArrayCount(writeContexts), buffer);
+        }
+        case kMessageType_EventNotification: {
+            return HAPIPAccessoryProtocolGetEventNotificationBytes(
+                    testAccessoryServer, readContexts, HAPArrayCount(readContexts), buffer);
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Serializes a message in two passes: the length of the body is computed first and formatted into the header.
+ *
+ * - Formatted output needs space for a NULL terminator behind it. Bodies that exactly fit the buffer are rejected.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SerializeWithKnownContentLength(MessageType type, HAPIPByteBuffer* buffer) {
+    HAPError err;
+
+    size_t mark = buffer->position;
+    size_t numBodyBytes = GetNumBodyBytes(type);
+    err = HAPIPByteBufferAppendStringWithFormat(
+            buffer,
+            "%s"
+            "Content-Type: application/hap+json\r\n"
+            "Content-Length: %lu\r\n\r\n",
+            GetStartLine(type),
+            (unsigned long) numBodyBytes);
+    if (err || numBodyBytes > buffer->limit - buffer->position) {
+        buffer->position = mark;
+        return kHAPError_OutOfResources;
+    }
+    size_t bodyStart = buffer->position;
+    err = AppendBody(type, buffer);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        buffer->position = mark;
+        return err;
+    }
+    HAPAssert(buffer->position - bodyStart == numBodyBytes);
+    return kHAPError_None;
+}
+
+/**
+ * Serializes a message in a single pass.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SerializeJSONMessage(MessageType type, HAPIPByteBuffer* buffer) {
+    HAPError err;
+
+    size_t mark = buffer->position;
+    HAPIPAccessoryProtocolJSONMessage message;
+    err = HAPIPAccessoryProtocolBeginJSONMessage(buffer, GetStartLine(type), &message);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPAssert(buffer->position == mark);
+        return err;
+    }
+    err = AppendBody(type, buffer);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        buffer->position = mark;
+        return err;
+    }
+    HAPIPAccessoryProtocolCompleteJSONMessage(buffer, &message);
+    return kHAPError_None;
+}
+
+/**
+ * Serializes a message into a buffer with a given limit and returns whether it fit.
+ * If it fit, the bytes are compared with the expected message.
+ */
+HAP_RESULT_USE_CHECK
+static bool SerializeAndCompare(MessageType type, size_t limit, const char* expectedBytes, size_t numExpectedBytes) {
+    HAPError err;
+
+    static char bytes[kMaxMessageBytes];
+    HAPAssert(limit <= sizeof bytes);
+    HAPRawBufferCopyBytes(bytes, kPrefix, sizeof kPrefix - 1);
+    HAPIPByteBuffer buffer = {
+        .data = bytes, .capacity = sizeof bytes, .limit = limit, .position = sizeof kPrefix - 1
+    };
+
+    err = SerializeJSONMessage(type, &buffer);
+    HAPAssert(HAPRawBufferAreEqual(bytes, kPrefix, sizeof kPrefix - 1));
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPAssert(buffer.position == sizeof kPrefix - 1);
+        return false;
+    }
+    HAPAssert(buffer.position == sizeof kPrefix - 1 + numExpectedBytes);
+    HAPAssert(HAPRawBufferAreEqual(&bytes[sizeof kPrefix - 1], expectedBytes, numExpectedBytes));
+    return true;
+}
+
+int main() {
+    HAPError err;
+
+    static const MessageType messageTypes[] = { kMessageType_ReadResponse,
+                                                kMessageType_WriteResponse,
+                                                kMessageType_EventNotification };
+
+    // Body lengths cross the boundaries from 2 to 3 and from 3 to 4 Content-Length digits.
+    for (size_t numValueBytes = 0; numValueBytes <= 1100; numValueBytes++) {
+        PrepareContexts(numValueBytes);
+
+        for (size_t i = 0; i < HAPArrayCount(messageTypes); i++) {
+            MessageType type = messageTypes[i];
+
+            // Output of the former two-pass serialization.
+            static char expectedBytes[kMaxMessageBytes];
+            HAPIPByteBuffer expectedBuffer = {
+                .data = expectedBytes, .capacity = sizeof expectedBytes, .limit = sizeof expectedBytes
+            };
+            err = SerializeWithKnownContentLength(type, &expectedBuffer);
+            HAPAssert(!err);
+            size_t numExpectedBytes = expectedBuffer.position;
+
+            // Smallest buffer in which the two-pass serialization succeeds.
+            size_t minLimit = numExpectedBytes;
+            for (;; minLimit++) {
+                static char bytes[kMaxMessageBytes];
+                HAPIPByteBuffer buffer = { .data = bytes, .capacity = sizeof bytes, .limit = minLimit };
+                err = SerializeWithKnownContentLength(type, &buffer);
+                if (!err) {
+                    break;
+                }
+                HAPAssert(err == kHAPError_OutOfResources);
+                HAPAssert(minLimit - numExpectedBytes < 2);
+            }
+            size_t exactLimit = sizeof kPrefix - 1 + minLimit;
+
+            // Single-pass serialization produces identical bytes if enough space is available.
+            HAPAssert(SerializeAndCompare(type, kMaxMessageBytes, expectedBytes, numExpectedBytes));
+
+            // The single-pass serialization succeeds in the smallest buffer that fit the two-pass serialization.
+            HAPAssert(SerializeAndCompare(type, exactLimit, expectedBytes, numExpectedBytes));
+            HAPAssert(!SerializeAndCompare(type, exactLimit - 1, expectedBytes, numExpectedBytes));
+
+            // Larger buffers fit as well, including those in which the reserved Content-Length digits change.
+            for (size_t numSlackBytes = 1; numSlackBytes <= 12; numSlackBytes++) {
+                HAPAssert(SerializeAndCompare(type, exactLimit + numSlackBytes, expectedBytes, numExpectedBytes));
+            }
+        }
+    }
+
+    // Buffers that cannot hold the header are rejected without modification.
+    {
+        PrepareContexts(0);
+        for (size_t limit = sizeof kPrefix - 1; limit < sizeof kPrefix - 1 + 64; limit++) {
+            static char bytes[kMaxMessageBytes];
+            HAPRawBufferCopyBytes(bytes, kPrefix, sizeof kPrefix - 1);
+            HAPIPByteBuffer buffer = {
+                .data = bytes, .capacity = sizeof bytes, .limit = limit, .position = sizeof kPrefix - 1
+            };
+            HAPIPAccessoryProtocolJSONMessage message;
+            err = HAPIPAccessoryProtocolBeginJSONMessage(&buffer, "HTTP/1.1 200 OK\r\n", &message);
+            if (err) {
+                HAPAssert(err == kHAPError_OutOfResources);
+                HAPAssert(buffer.position == sizeof kPrefix - 1);
+            }
+        }
+    }
+
+    return 0;
+}
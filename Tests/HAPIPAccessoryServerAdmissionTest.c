@@ -0,0 +1,334 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/TemplateDB.c"
+
+/** Number of IP sessions. */
+#define kNumSessions ((size_t) 4)
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+static HAPPlatformTCPStreamManager tcpStreamManager;
+static HAPIPSession ipSessions[kNumSessions];
+
+/**
+ * Paired controller.
+ */
+typedef struct {
+    const char* pairingID;
+    uint8_t ltsk[ED25519_SECRET_KEY_BYTES];
+    uint8_t ltpk[ED25519_PUBLIC_KEY_BYTES];
+} Controller;
+
+static Controller controllers[] = {
+    { .pairingID = "Controller-A" },
+    { .pairingID = "Controller-B" },
+    { .pairingID = "Controller-C" },
+    { .pairingID = "Controller-D" },
+};
+
+/**
+ * Connects a connection of a controller. Time advances by one second first so that connections differ in their
+ * last activity.
+ */
+static void Connect(HAPIPController* connection) {
+    HAPPlatformClockAdvance(HAPSecond);
+    HAPIPControllerConnect(connection, &tcpStreamManager, /* workerPool: */ NULL);
+    HAPPlatformClockAdvance(0);
+}
+
+/**
+ * Performs Pair Verify on a connection. Time advances by one second first so that connections differ in their
+ * last activity.
+ */
+static void PairVerify(HAPIPController* connection, const Controller* controller) {
+    HAPError err;
+
+    HAPPlatformClockAdvance(HAPSecond);
+    err = HAPIPControllerPairVerify(
+            connection,
+            controller->pairingID,
+            HAPStringGetNumBytes(controller->pairingID),
+            controller->ltsk,
+            controller->ltpk,
+            ((HAPAccessoryServer*) &accessoryServer)->identity.ed_LTPK);
+    HAPAssert(!err);
+}
+
+/**
+ * Returns the IP session that serves a connection, or NULL if the connection is not served.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPSessionDescriptor* _Nullable GetSession(const HAPIPController* connection) {
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSessions[i].descriptor;
+        if (session->server && session->tcpStreamIsOpen && session->tcpStream == connection->tcpStream) {
+            return session;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Checks that the accessory server responds to a request on a connection.
+ */
+static void CheckServiceable(HAPIPController* connection) {
+    HAPAssert(GetSession(connection));
+
+    if (connection->session.isActive) {
+        HAPIPControllerSendRequest(connection, "GET", "/characteristics?id=1.4", NULL, NULL, 0);
+    } else {
+        HAPIPControllerSendRequest(connection, "GET", "/accessories", NULL, NULL, 0);
+    }
+    HAPPlatformClockAdvance(0);
+
+    uint8_t response[kHAPIPController_MaxMessageBytes];
+    size_t numBytes;
+    HAPAssert(HAPIPControllerReceive(connection, response, sizeof response, &numBytes));
+    HAPAssert(numBytes > 0);
+}
+
+/**
+ * Checks that the accessory server has closed a connection, and closes the controller side.
+ */
+static void CheckClosed(HAPIPController* connection) {
+    HAPAssert(!GetSession(connection));
+    HAPAssert(HAPIPControllerIsClosedByAccessory(connection));
+    HAPIPControllerClose(connection);
+}
+
+int main() {
+    HAPError err;
+
+    HAPPlatformCreate();
+
+    // One more TCP stream than IP sessions so that connections can be accepted while all IP sessions are in use.
+    static HAPPlatformTCPStream tcpStreams[kNumSessions + 1];
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreams,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreams) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    // Prepare accessory server storage.
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultInboundBufferSize];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultOutboundBufferSize];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer },
+        .admissionPolicy = kHAPIPSessionAdmissionPolicy_Refuse,
+        .maxSessionsPerController = 1
+    };
+
+    // Initialize accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) &accessoryServer;
+
+    // The accessory identity is created on the first start. Pair the controllers afterwards.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    HAPAssert(HAPArrayCount(controllers) <= kHAPPairingStorage_MinElements);
+    for (size_t i = 0; i < HAPArrayCount(controllers); i++) {
+        Controller* controller = &controllers[i];
+        HAPPlatformRandomNumberFill(controller->ltsk, sizeof controller->ltsk);
+        HAP_ed25519_public_key(controller->ltpk, controller->ltsk);
+        HAPControllerPairingIdentifier pairingIdentifier;
+        HAPRawBufferZero(&pairingIdentifier, sizeof pairingIdentifier);
+        pairingIdentifier.numBytes = HAPStringGetNumBytes(controller->pairingID);
+        HAPAssert(pairingIdentifier.numBytes <= sizeof pairingIdentifier.bytes);
+        HAPRawBufferCopyBytes(pairingIdentifier.bytes, controller->pairingID, pairingIdentifier.numBytes);
+        HAPControllerPublicKey publicKey;
+        HAPRawBufferCopyBytes(publicKey.bytes, controller->ltpk, sizeof publicKey.bytes);
+        err = HAPLegacyImportControllerPairing(
+                platform.keyValueStore, (HAPPlatformKeyValueStoreKey) i, &pairingIdentifier, &publicKey, true);
+        HAPAssert(!err);
+    }
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    Controller* controllerA = &controllers[0];
+    Controller* controllerB = &controllers[1];
+    Controller* controllerC = &controllers[2];
+    Controller* controllerD = &controllers[3];
+
+    // Stale controllers connect and never send a request.
+    static HAPIPController staleConnections[kNumSessions];
+    for (size_t i = 0; i < HAPArrayCount(staleConnections); i++) {
+        Connect(&staleConnections[i]);
+        HAPAssert(GetSession(&staleConnections[i]));
+    }
+    HAPAssert(server->ip.numSessions == kNumSessions);
+
+    // Without eviction, the stale controllers starve a new controller.
+    {
+        static HAPIPController connection;
+        Connect(&connection);
+        CheckClosed(&connection);
+        HAPAssert(server->ip.numSessions == kNumSessions);
+    }
+
+    // A stale controller that becomes active is no longer the least recently active one.
+    CheckServiceable(&staleConnections[1]);
+
+    // With eviction, the least recently active sessions that are not secured make room for new controllers.
+    ipAccessoryServerStorage.admissionPolicy = kHAPIPSessionAdmissionPolicy_EvictLeastRecentlyActive;
+    static HAPIPController connectionsA[3];
+    {
+        Connect(&connectionsA[0]);
+        CheckClosed(&staleConnections[0]);
+        CheckServiceable(&connectionsA[0]);
+        HAPAssert(server->ip.numSessions == kNumSessions);
+
+        Connect(&connectionsA[1]);
+        CheckClosed(&staleConnections[2]);
+        Connect(&connectionsA[2]);
+        CheckClosed(&staleConnections[3]);
+        HAPAssert(server->ip.numSessions == kNumSessions);
+    }
+
+    // Secured sessions are only evicted if their controller exceeds its share of sessions.
+    // Controller B has one session that is the least recently active one. Controller A has three sessions.
+    HAPIPController* connectionB = &staleConnections[1];
+    PairVerify(connectionB, controllerB);
+    for (size_t i = 0; i < HAPArrayCount(connectionsA); i++) {
+        PairVerify(&connectionsA[i], controllerA);
+    }
+    static HAPIPController connectionB2;
+    {
+        static HAPIPController connection;
+        Connect(&connection);
+        CheckClosed(&connectionsA[0]);
+        HAPAssert(GetSession(connectionB));
+        HAPAssert(GetSession(&connection));
+
+        // The new session is not secured and is evicted before the remaining sessions of controller A.
+        Connect(&connectionB2);
+        CheckClosed(&connection);
+        PairVerify(&connectionB2, controllerB);
+    }
+
+    // Both controllers have two sessions. The least recently active one of them is evicted.
+    static HAPIPController connectionC;
+    {
+        Connect(&connectionC);
+        CheckClosed(connectionB);
+        PairVerify(&connectionC, controllerC);
+    }
+
+    // Only controller A exceeds its share.
+    static HAPIPController connectionD;
+    {
+        Connect(&connectionD);
+        CheckClosed(&connectionsA[1]);
+        HAPAssert(GetSession(&connectionsA[2]));
+        PairVerify(&connectionD, controllerD);
+    }
+
+    // All controllers are within their share. New connections are refused.
+    {
+        static HAPIPController connection;
+        Connect(&connection);
+        CheckClosed(&connection);
+        HAPAssert(server->ip.numSessions == kNumSessions);
+    }
+
+    // Without a limit per controller, secured sessions are protected unless an idle duration is configured.
+    ipAccessoryServerStorage.maxSessionsPerController = kHAPIPAccessoryServerStorage_UnlimitedSessionsPerController;
+    {
+        static HAPIPController connection;
+        Connect(&connection);
+        CheckClosed(&connection);
+        HAPAssert(server->ip.numSessions == kNumSessions);
+    }
+
+    // Secured sessions that have been idle for the idle duration are evicted, least recently active first,
+    // even though no controller exceeds its share.
+    ipAccessoryServerStorage.maxSessionsPerController = 1;
+    ipAccessoryServerStorage.evictionIdleDuration = 30 * HAPSecond;
+    {
+        // Not idle for long enough yet.
+        static HAPIPController connection;
+        Connect(&connection);
+        CheckClosed(&connection);
+
+        // Sessions that become active are protected again.
+        HAPPlatformClockAdvance(25 * HAPSecond);
+        CheckServiceable(&connectionsA[2]);
+        CheckServiceable(&connectionB2);
+
+        Connect(&connection);
+        CheckClosed(&connectionC);
+        HAPAssert(GetSession(&connectionsA[2]));
+        HAPAssert(GetSession(&connectionB2));
+        HAPAssert(GetSession(&connectionD));
+        HAPAssert(GetSession(&connection));
+    }
+
+    return 0;
+}
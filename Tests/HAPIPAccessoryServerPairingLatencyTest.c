@@ -0,0 +1,547 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+#include "HAPPlatformWorkerPool+Init.h"
+#include "HAPPlatformWorkerPool+Test.h"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/HAPIPController.c"
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic onCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x31,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = 0x30,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = "Light Bulb",
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &onCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+static HAPPlatformTCPStreamManager tcpStreamManager;
+static HAPPlatformWorkerPool workerPool;
+
+/**
+ * Controller pairing that is used for the verified session.
+ */
+static const char kControllerPairingID[] = "C0FFEE00-0000-4000-8000-000000000001";
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t controllerLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Pair Setup M1: kTLVType_State = 1, kTLVType_Method = Pair Setup.
+ */
+static const uint8_t pairSetupM1[] = { 0x06, 0x01, 0x01, 0x00, 0x01, 0x00 };
+
+/**
+ * Length of Pair Verify M1: kTLVType_State = 1, kTLVType_PublicKey.
+ */
+#define kPairVerifyM1_NumBytes ((size_t)(3 + 2 + X25519_BYTES))
+
+/**
+ * Serializes Pair Verify M1 with a new ephemeral key pair.
+ */
+static void GetPairVerifyM1(
+        uint8_t pairVerifyM1[_Nonnull kPairVerifyM1_NumBytes],
+        uint8_t controllerSecretKey[_Nonnull X25519_SCALAR_BYTES]) {
+    size_t numBytes = 0;
+    pairVerifyM1[numBytes++] = kHAPPairingTLVType_State;
+    pairVerifyM1[numBytes++] = 1;
+    pairVerifyM1[numBytes++] = 1;
+    pairVerifyM1[numBytes++] = kHAPPairingTLVType_PublicKey;
+    pairVerifyM1[numBytes++] = X25519_BYTES;
+    HAPPlatformRandomNumberFill(controllerSecretKey, X25519_SCALAR_BYTES);
+    HAP_X25519_scalarmult_base(&pairVerifyM1[numBytes], controllerSecretKey);
+    numBytes += X25519_BYTES;
+    HAPAssert(numBytes == kPairVerifyM1_NumBytes);
+}
+
+/**
+ * Sends a HTTP request with pairing data.
+ */
+static void SendPairingRequest(
+        HAPPlatformTCPStreamRef tcpStream,
+        const char* endpoint,
+        const uint8_t* tlvBytes,
+        size_t numTLVBytes) {
+    HAPError err;
+
+    char request[512];
+    HAPAssert(numTLVBytes <= sizeof request / 2);
+    err = HAPStringWithFormat(
+            request,
+            sizeof request,
+            "POST %s HTTP/1.1\r\nHost: test\r\nContent-Type: application/pairing+tlv8\r\n"
+            "Content-Length: %zu\r\n\r\n",
+            endpoint,
+            numTLVBytes);
+    HAPAssert(!err);
+    size_t numRequestBytes = HAPStringGetNumBytes(request);
+    HAPAssert(numTLVBytes <= sizeof request - numRequestBytes);
+    HAPRawBufferCopyBytes(&request[numRequestBytes], tlvBytes, numTLVBytes);
+    numRequestBytes += numTLVBytes;
+
+    size_t numBytes;
+    err = HAPPlatformTCPStreamClientWrite(&tcpStreamManager, tcpStream, request, numRequestBytes, &numBytes);
+    HAPAssert(!err);
+    HAPAssert(numBytes == numRequestBytes);
+}
+
+/**
+ * Sends a GET /accessories request.
+ */
+static void SendAccessoriesRequest(HAPPlatformTCPStreamRef tcpStream) {
+    HAPError err;
+
+    static const char request[] = "GET /accessories HTTP/1.1\r\nHost: test\r\n\r\n";
+    size_t numBytes;
+    err = HAPPlatformTCPStreamClientWrite(&tcpStreamManager, tcpStream, request, sizeof request - 1, &numBytes);
+    HAPAssert(!err);
+    HAPAssert(numBytes == sizeof request - 1);
+}
+
+/**
+ * Checks that a message received by a verified controller is a characteristic event notification.
+ */
+static void CheckEventNotification(const uint8_t* bytes, size_t numBytes) {
+    static const char statusLine[] = "EVENT/1.0 200 OK\r\n";
+    HAPAssert(numBytes >= sizeof statusLine - 1);
+    HAPAssert(HAPRawBufferAreEqual(bytes, statusLine, sizeof statusLine - 1));
+}
+
+/**
+ * Returns whether a response is available on a TCP stream, and reads it.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReadResponse(HAPPlatformTCPStreamRef tcpStream, uint8_t* bytes, size_t maxBytes, size_t* numBytes) {
+    HAPError err;
+
+    err = HAPPlatformTCPStreamClientRead(&tcpStreamManager, tcpStream, bytes, maxBytes, numBytes);
+    if (err == kHAPError_Busy) {
+        return false;
+    }
+    HAPAssert(!err);
+    HAPAssert(*numBytes > 0);
+    return true;
+}
+
+/**
+ * Checks that a response is a Pair Setup response in a given state, and returns the TLV body.
+ */
+HAP_RESULT_USE_CHECK
+static const uint8_t* GetPairingResponseBody(const uint8_t* bytes, size_t numBytes, uint8_t state) {
+    static const char statusLine[] = "HTTP/1.1 200 OK\r\n";
+    HAPAssert(numBytes >= sizeof statusLine - 1);
+    HAPAssert(HAPRawBufferAreEqual(bytes, statusLine, sizeof statusLine - 1));
+    for (size_t i = 0; i + 4 <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], "\r\n\r\n", 4)) {
+            const uint8_t* body = &bytes[i + 4];
+            HAPAssert(numBytes - (i + 4) >= 3);
+            HAPAssert(body[0] == kHAPPairingTLVType_State);
+            HAPAssert(body[1] == 1);
+            HAPAssert(body[2] == state);
+            return body;
+        }
+    }
+    HAPFatalError();
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    static HAPPlatformTCPStream tcpStreams[kHAPIPSessionStorage_DefaultNumElements];
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreams,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreams) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    HAPPlatformWorkerPoolCreate(&workerPool);
+    platform.ip.workerPool = &workerPool;
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][2 * kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[2 * kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[2 * kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) &accessoryServer;
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    HAPError err;
+
+    HAPPlatformTCPStreamRef pairingTCPStream;
+    err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+    HAPAssert(!err);
+    HAPPlatformTCPStreamRef otherTCPStream;
+    err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &otherTCPStream);
+    HAPAssert(!err);
+    HAPPlatformClockAdvance(0);
+
+    static uint8_t response[2048];
+    size_t numResponseBytes;
+
+    // While the public key for Pair Setup M2 is derived on the worker pool, other controllers are served.
+    {
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+        SendAccessoriesRequest(otherTCPStream);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 1);
+        HAPAssert(ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+        HAPAssert(!ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+
+        HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+        HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+        HAPAssert(server->pairSetup.publicKeyIsAvailable);
+    }
+
+    // Pair Setup M3 with an illegal public key A is rejected once the worker pool has computed the premaster secret.
+    {
+        uint8_t pairSetupM3[3 + 3 + 2 + SRP_PROOF_BYTES];
+        size_t numBytes = 0;
+        pairSetupM3[numBytes++] = kHAPPairingTLVType_State;
+        pairSetupM3[numBytes++] = 1;
+        pairSetupM3[numBytes++] = 3;
+        pairSetupM3[numBytes++] = kHAPPairingTLVType_PublicKey;
+        pairSetupM3[numBytes++] = 1;
+        pairSetupM3[numBytes++] = 0;
+        pairSetupM3[numBytes++] = kHAPPairingTLVType_Proof;
+        pairSetupM3[numBytes++] = SRP_PROOF_BYTES;
+        HAPRawBufferZero(&pairSetupM3[numBytes], SRP_PROOF_BYTES);
+        numBytes += SRP_PROOF_BYTES;
+        HAPAssert(numBytes == sizeof pairSetupM3);
+
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM3, sizeof pairSetupM3);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 1);
+        HAPAssert(!ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+
+        HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 4);
+        HAPAssert(body[3] == kHAPPairingTLVType_Error);
+        HAPAssert(body[4] == 1);
+        HAPAssert(body[5] == kHAPPairingError_Authentication);
+        HAPAssert(!server->pairSetup.sessionThatIsCurrentlyPairing);
+    }
+
+    // Pair Verify M2 is derived on the worker pool as well.
+    {
+        uint8_t pairVerifyM1[kPairVerifyM1_NumBytes];
+        uint8_t controllerSecretKey[X25519_SCALAR_BYTES];
+        GetPairVerifyM1(pairVerifyM1, controllerSecretKey);
+
+        SendPairingRequest(otherTCPStream, "/pair-verify", pairVerifyM1, sizeof pairVerifyM1);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 1);
+        HAPAssert(!ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+
+        HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+        HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+        HAPAssert(body[4] == X25519_BYTES);
+
+        // The accessory's public key matches the shared secret.
+        uint8_t sharedSecret[X25519_BYTES];
+        HAP_X25519_scalarmult(sharedSecret, controllerSecretKey, &body[5]);
+        bool found = false;
+        for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+            const HAPIPSessionDescriptor* session = (const HAPIPSessionDescriptor*) &ipSessions[i].descriptor;
+            const HAPSession* hapSession = (const HAPSession*) &session->securitySession._.hap;
+            if (session->server && session->tcpStreamIsOpen && session->tcpStream == otherTCPStream) {
+                HAPAssert(HAPRawBufferAreEqual(hapSession->state.pairVerify.cv_KEY, sharedSecret, X25519_BYTES));
+                found = true;
+            }
+        }
+        HAPAssert(found);
+    }
+
+    // A session whose connection is closed while a job is pending is released once the job has completed.
+    {
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 1);
+        HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(server->pairSetup.sessionThatIsCurrentlyPairing);
+        HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(!server->pairSetup.sessionThatIsCurrentlyPairing);
+        err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+        HAPAssert(!err);
+        HAPPlatformClockAdvance(0);
+    }
+
+    // Without a worker pool, responses are sent synchronously.
+    server->platform.ip.workerPool = NULL;
+    {
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 0);
+        HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+        HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    // Latency of a GET /accessories request that arrives together with Pair Setup M1 from another controller.
+    for (int useWorkerPool = 0; useWorkerPool <= 1; useWorkerPool++) {
+        server->platform.ip.workerPool = useWorkerPool ? &workerPool : NULL;
+        uint64_t numIterations = 20;
+        uint64_t numNanoseconds = 0;
+        for (uint64_t i = 0; i < numIterations; i++) {
+            HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+            HAPPlatformClockAdvance(0);
+            err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+            HAPAssert(!err);
+            HAPPlatformClockAdvance(0);
+
+            uint64_t start = HAPBenchmarkGetNanoseconds();
+            SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+            SendAccessoriesRequest(otherTCPStream);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+            numNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+
+            HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+        }
+        HAPBenchmarkLogResult(
+                useWorkerPool ? "GET /accessories during Pair Setup M1 (worker pool)" :
+                                "GET /accessories during Pair Setup M1 (run loop)",
+                numIterations,
+                numNanoseconds);
+    }
+#endif
+
+    // Pair Setup is only accepted while the accessory is not paired, i.e., while no controller can subscribe to events.
+    // Event notifications compete with Pair Verify of other controllers instead. Pair an admin controller.
+    HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+    HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, otherTCPStream);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    {
+        HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+        HAP_ed25519_public_key(controllerLTPK, controllerLTSK);
+        HAPControllerPairingIdentifier pairingIdentifier;
+        HAPRawBufferZero(&pairingIdentifier, sizeof pairingIdentifier);
+        HAPRawBufferCopyBytes(pairingIdentifier.bytes, kControllerPairingID, sizeof kControllerPairingID - 1);
+        pairingIdentifier.numBytes = sizeof kControllerPairingID - 1;
+        HAPControllerPublicKey publicKey;
+        HAPRawBufferCopyBytes(publicKey.bytes, controllerLTPK, sizeof publicKey.bytes);
+        err = HAPLegacyImportControllerPairing(
+                platform.keyValueStore, /* pairingIndex: */ 0, &pairingIdentifier, &publicKey, /* isAdmin: */ true);
+        HAPAssert(!err);
+    }
+    server->platform.ip.workerPool = &workerPool;
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // The paired controller subscribes to events over a verified session.
+    static HAPIPController verifiedController;
+    HAPIPControllerConnect(&verifiedController, &tcpStreamManager, &workerPool);
+    HAPPlatformClockAdvance(0);
+    err = HAPIPControllerPairVerify(
+            &verifiedController,
+            kControllerPairingID,
+            sizeof kControllerPairingID - 1,
+            controllerLTSK,
+            controllerLTPK,
+            server->identity.ed_LTPK);
+    HAPAssert(!err);
+    {
+        static const char body[] = "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":true}]}";
+        HAPIPControllerSendRequest(
+                &verifiedController, "PUT", "/characteristics", "application/hap+json", body, sizeof body - 1);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPIPControllerReceive(&verifiedController, response, sizeof response, &numResponseBytes));
+        static const char statusLine[] = "HTTP/1.1 204 No Content\r\n";
+        HAPAssert(numResponseBytes >= sizeof statusLine - 1);
+        HAPAssert(HAPRawBufferAreEqual(response, statusLine, sizeof statusLine - 1));
+    }
+
+    // While Pair Verify M2 for another controller is derived on the worker pool, event notifications are delivered.
+    static HAPIPController otherController;
+    HAPIPControllerConnect(&otherController, &tcpStreamManager, &workerPool);
+    HAPPlatformClockAdvance(0);
+    {
+        uint8_t pairVerifyM1[kPairVerifyM1_NumBytes];
+        uint8_t controllerSecretKey[X25519_SCALAR_BYTES];
+        GetPairVerifyM1(pairVerifyM1, controllerSecretKey);
+
+        HAPPlatformClockAdvance(HAPSecond);
+        HAPIPControllerSendRequest(
+                &otherController,
+                "POST",
+                "/pair-verify",
+                "application/pairing+tlv8",
+                pairVerifyM1,
+                sizeof pairVerifyM1);
+        HAPAccessoryServerRaiseEvent(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPPlatformWorkerPoolGetNumPendingJobs(&workerPool) == 1);
+        HAPAssert(HAPIPControllerReceive(&verifiedController, response, sizeof response, &numResponseBytes));
+        CheckEventNotification(response, numResponseBytes);
+        HAPAssert(!HAPIPControllerReceive(&otherController, response, sizeof response, &numResponseBytes));
+
+        HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(HAPIPControllerReceive(&otherController, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+        HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    // Latency of an event notification that is raised together with Pair Verify M1 from another controller.
+    for (int useWorkerPool = 0; useWorkerPool <= 1; useWorkerPool++) {
+        server->platform.ip.workerPool = useWorkerPool ? &workerPool : NULL;
+        uint64_t numIterations = 20;
+        uint64_t numNanoseconds = 0;
+        for (uint64_t i = 0; i < numIterations; i++) {
+            HAPIPControllerClose(&otherController);
+            HAPPlatformClockAdvance(0);
+            HAPIPControllerConnect(&otherController, &tcpStreamManager, &workerPool);
+            HAPPlatformClockAdvance(HAPSecond);
+            uint8_t pairVerifyM1[kPairVerifyM1_NumBytes];
+            uint8_t controllerSecretKey[X25519_SCALAR_BYTES];
+            GetPairVerifyM1(pairVerifyM1, controllerSecretKey);
+
+            uint64_t start = HAPBenchmarkGetNanoseconds();
+            HAPIPControllerSendRequest(
+                    &otherController,
+                    "POST",
+                    "/pair-verify",
+                    "application/pairing+tlv8",
+                    pairVerifyM1,
+                    sizeof pairVerifyM1);
+            HAPAccessoryServerRaiseEvent(&accessoryServer, &onCharacteristic, &lightBulbService, &accessory);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(HAPIPControllerReceive(&verifiedController, response, sizeof response, &numResponseBytes));
+            numNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+            CheckEventNotification(response, numResponseBytes);
+
+            HAPPlatformWorkerPoolRunPendingJobs(&workerPool);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(HAPIPControllerReceive(&otherController, response, sizeof response, &numResponseBytes));
+        }
+        HAPBenchmarkLogResult(
+                useWorkerPool ? "Event notification during Pair Verify M1 (worker pool)" :
+                                "Event notification during Pair Verify M1 (run loop)",
+                numIterations,
+                numNanoseconds);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,441 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <pthread.h>
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+
+// Pairing jobs run on the threads of the POSIX worker pool instead of the deterministic Mock worker pool.
+#include "../PAL/POSIX/HAPPlatformWorkerPool.c"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+/** Number of worker threads. */
+#define kNumThreads ((size_t) 2)
+
+/** Number of controllers that perform Pair Verify at the same time. */
+#define kNumConcurrentControllers ((size_t) 4)
+
+/** Maximum length of the context of a run loop callback. */
+#define kMaxCallbackContextBytes ((size_t) 16)
+
+/**
+ * Run loop callbacks that have been scheduled by the worker threads.
+ *
+ * - The Mock PAL has no run loop. Scheduled callbacks are invoked on the main thread by RunScheduledCallbacks.
+ */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    struct {
+        HAPPlatformRunLoopCallback callback;
+        union {
+            uint64_t alignment;
+            void* _Nullable pointerAlignment;
+            uint8_t bytes[kMaxCallbackContextBytes];
+        } context;
+        size_t contextSize;
+    } callbacks[kHAPIPSessionStorage_DefaultNumElements];
+    size_t numCallbacks;
+} runLoop = { .mutex = PTHREAD_MUTEX_INITIALIZER, .condition = PTHREAD_COND_INITIALIZER };
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformRunLoopScheduleCallback(
+        HAPPlatformRunLoopCallback callback,
+        void* _Nullable context,
+        size_t contextSize) {
+    HAPPrecondition(callback);
+    HAPPrecondition(!contextSize || context);
+    HAPPrecondition(contextSize <= kMaxCallbackContextBytes);
+
+    int e = pthread_mutex_lock(&runLoop.mutex);
+    HAPAssert(!e);
+    if (runLoop.numCallbacks == HAPArrayCount(runLoop.callbacks)) {
+        e = pthread_mutex_unlock(&runLoop.mutex);
+        HAPAssert(!e);
+        return kHAPError_OutOfResources;
+    }
+    runLoop.callbacks[runLoop.numCallbacks].callback = callback;
+    if (contextSize) {
+        HAPRawBufferCopyBytes(
+                runLoop.callbacks[runLoop.numCallbacks].context.bytes, HAPNonnullVoid(context), contextSize);
+    }
+    runLoop.callbacks[runLoop.numCallbacks].contextSize = contextSize;
+    runLoop.numCallbacks++;
+    e = pthread_cond_signal(&runLoop.condition);
+    HAPAssert(!e);
+    e = pthread_mutex_unlock(&runLoop.mutex);
+    HAPAssert(!e);
+    return kHAPError_None;
+}
+
+/**
+ * Waits until at least one run loop callback has been scheduled, invokes all scheduled callbacks on the calling thread,
+ * and lets the accessory server process the results.
+ */
+static void RunScheduledCallbacks(void) {
+    static __typeof__(runLoop.callbacks) callbacks;
+    size_t numCallbacks;
+
+    int e = pthread_mutex_lock(&runLoop.mutex);
+    HAPAssert(!e);
+    while (!runLoop.numCallbacks) {
+        e = pthread_cond_wait(&runLoop.condition, &runLoop.mutex);
+        HAPAssert(!e);
+    }
+    numCallbacks = runLoop.numCallbacks;
+    HAPRawBufferCopyBytes(callbacks, runLoop.callbacks, numCallbacks * sizeof callbacks[0]);
+    runLoop.numCallbacks = 0;
+    e = pthread_mutex_unlock(&runLoop.mutex);
+    HAPAssert(!e);
+
+    for (size_t i = 0; i < numCallbacks; i++) {
+        callbacks[i].callback(callbacks[i].contextSize ? callbacks[i].context.bytes : NULL, callbacks[i].contextSize);
+    }
+    HAPPlatformClockAdvance(0);
+}
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+static HAPPlatformTCPStreamManager tcpStreamManager;
+static HAPPlatformWorkerPool workerPool;
+
+/**
+ * Pair Setup M1: kTLVType_State = 1, kTLVType_Method = Pair Setup.
+ */
+static const uint8_t pairSetupM1[] = { 0x06, 0x01, 0x01, 0x00, 0x01, 0x00 };
+
+/**
+ * Sends a HTTP request with pairing data.
+ */
+static void SendPairingRequest(
+        HAPPlatformTCPStreamRef tcpStream,
+        const char* endpoint,
+        const uint8_t* tlvBytes,
+        size_t numTLVBytes) {
+    HAPError err;
+
+    char request[512];
+    HAPAssert(numTLVBytes <= sizeof request / 2);
+    err = HAPStringWithFormat(
+            request,
+            sizeof request,
+            "POST %s HTTP/1.1\r\nHost: test\r\nContent-Type: application/pairing+tlv8\r\n"
+            "Content-Length: %zu\r\n\r\n",
+            endpoint,
+            numTLVBytes);
+    HAPAssert(!err);
+    size_t numRequestBytes = HAPStringGetNumBytes(request);
+    HAPAssert(numTLVBytes <= sizeof request - numRequestBytes);
+    HAPRawBufferCopyBytes(&request[numRequestBytes], tlvBytes, numTLVBytes);
+    numRequestBytes += numTLVBytes;
+
+    size_t numBytes;
+    err = HAPPlatformTCPStreamClientWrite(&tcpStreamManager, tcpStream, request, numRequestBytes, &numBytes);
+    HAPAssert(!err);
+    HAPAssert(numBytes == numRequestBytes);
+}
+
+/**
+ * Sends a GET /accessories request.
+ */
+static void SendAccessoriesRequest(HAPPlatformTCPStreamRef tcpStream) {
+    HAPError err;
+
+    static const char request[] = "GET /accessories HTTP/1.1\r\nHost: test\r\n\r\n";
+    size_t numBytes;
+    err = HAPPlatformTCPStreamClientWrite(&tcpStreamManager, tcpStream, request, sizeof request - 1, &numBytes);
+    HAPAssert(!err);
+    HAPAssert(numBytes == sizeof request - 1);
+}
+
+/**
+ * Returns whether a response is available on a TCP stream, and reads it.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReadResponse(HAPPlatformTCPStreamRef tcpStream, uint8_t* bytes, size_t maxBytes, size_t* numBytes) {
+    HAPError err;
+
+    err = HAPPlatformTCPStreamClientRead(&tcpStreamManager, tcpStream, bytes, maxBytes, numBytes);
+    if (err == kHAPError_Busy) {
+        return false;
+    }
+    HAPAssert(!err);
+    HAPAssert(*numBytes > 0);
+    return true;
+}
+
+/**
+ * Checks that a response is a pairing response in a given state, and returns the TLV body.
+ */
+HAP_RESULT_USE_CHECK
+static const uint8_t* GetPairingResponseBody(const uint8_t* bytes, size_t numBytes, uint8_t state) {
+    static const char statusLine[] = "HTTP/1.1 200 OK\r\n";
+    HAPAssert(numBytes >= sizeof statusLine - 1);
+    HAPAssert(HAPRawBufferAreEqual(bytes, statusLine, sizeof statusLine - 1));
+    for (size_t i = 0; i + 4 <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], "\r\n\r\n", 4)) {
+            const uint8_t* body = &bytes[i + 4];
+            HAPAssert(numBytes - (i + 4) >= 3);
+            HAPAssert(body[0] == kHAPPairingTLVType_State);
+            HAPAssert(body[1] == 1);
+            HAPAssert(body[2] == state);
+            return body;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Returns the HAP session that serves a TCP stream.
+ */
+HAP_RESULT_USE_CHECK
+static const HAPSession*
+        GetSession(const HAPIPSession* ipSessions, size_t numIPSessions, HAPPlatformTCPStreamRef tcpStream) {
+    for (size_t i = 0; i < numIPSessions; i++) {
+        const HAPIPSessionDescriptor* session = (const HAPIPSessionDescriptor*) &ipSessions[i].descriptor;
+        if (session->server && session->tcpStreamIsOpen && session->tcpStream == tcpStream) {
+            return (const HAPSession*) &session->securitySession._.hap;
+        }
+    }
+    HAPFatalError();
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    static HAPPlatformTCPStream tcpStreams[kHAPIPSessionStorage_DefaultNumElements];
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreams,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreams) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    HAPPlatformWorkerPoolCreate(
+            &workerPool,
+            &(const HAPPlatformWorkerPoolOptions) { .numThreads = kNumThreads,
+                                                    .maxJobs = kHAPIPSessionStorage_DefaultNumElements });
+    platform.ip.workerPool = &workerPool;
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) &accessoryServer;
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    HAPError err;
+
+    HAPPlatformTCPStreamRef pairingTCPStream;
+    err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+    HAPAssert(!err);
+    HAPPlatformTCPStreamRef otherTCPStream;
+    err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &otherTCPStream);
+    HAPAssert(!err);
+    HAPPlatformClockAdvance(0);
+
+    static uint8_t response[2048];
+    size_t numResponseBytes;
+
+    // While the public key for Pair Setup M2 is derived on a worker thread, other controllers are served.
+    // The Pair Setup response is only sent after the completion has been posted back to the run loop.
+    {
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+        SendAccessoriesRequest(otherTCPStream);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+        HAPAssert(!ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+
+        RunScheduledCallbacks();
+        HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+        const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+        HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+        HAPAssert(server->pairSetup.publicKeyIsAvailable);
+    }
+
+    // Pair Verify of several controllers is processed by all worker threads. Each controller gets its own result.
+    {
+        HAPPlatformTCPStreamRef tcpStreams[kNumConcurrentControllers];
+        uint8_t controllerSecretKeys[kNumConcurrentControllers][X25519_SCALAR_BYTES];
+        for (size_t i = 0; i < kNumConcurrentControllers; i++) {
+            err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &tcpStreams[i]);
+            HAPAssert(!err);
+        }
+        HAPPlatformClockAdvance(0);
+        for (size_t i = 0; i < kNumConcurrentControllers; i++) {
+            uint8_t pairVerifyM1[3 + 2 + X25519_BYTES];
+            size_t numBytes = 0;
+            pairVerifyM1[numBytes++] = kHAPPairingTLVType_State;
+            pairVerifyM1[numBytes++] = 1;
+            pairVerifyM1[numBytes++] = 1;
+            pairVerifyM1[numBytes++] = kHAPPairingTLVType_PublicKey;
+            pairVerifyM1[numBytes++] = X25519_BYTES;
+            HAPPlatformRandomNumberFill(controllerSecretKeys[i], sizeof controllerSecretKeys[i]);
+            HAP_X25519_scalarmult_base(&pairVerifyM1[numBytes], controllerSecretKeys[i]);
+            numBytes += X25519_BYTES;
+            HAPAssert(numBytes == sizeof pairVerifyM1);
+            SendPairingRequest(tcpStreams[i], "/pair-verify", pairVerifyM1, sizeof pairVerifyM1);
+        }
+        HAPPlatformClockAdvance(0);
+
+        bool isResponseReceived[kNumConcurrentControllers];
+        HAPRawBufferZero(isResponseReceived, sizeof isResponseReceived);
+        for (size_t numResponses = 0; numResponses < kNumConcurrentControllers;) {
+            RunScheduledCallbacks();
+            for (size_t i = 0; i < kNumConcurrentControllers; i++) {
+                if (isResponseReceived[i] ||
+                    !ReadResponse(tcpStreams[i], response, sizeof response, &numResponseBytes)) {
+                    continue;
+                }
+                const uint8_t* body = GetPairingResponseBody(response, numResponseBytes, 2);
+                HAPAssert(body[3] == kHAPPairingTLVType_PublicKey);
+                HAPAssert(body[4] == X25519_BYTES);
+
+                // The accessory's public key matches the shared secret of this session.
+                uint8_t sharedSecret[X25519_BYTES];
+                HAP_X25519_scalarmult(sharedSecret, controllerSecretKeys[i], &body[5]);
+                const HAPSession* session = GetSession(ipSessions, HAPArrayCount(ipSessions), tcpStreams[i]);
+                HAPAssert(HAPRawBufferAreEqual(session->state.pairVerify.cv_KEY, sharedSecret, X25519_BYTES));
+
+                isResponseReceived[i] = true;
+                numResponses++;
+            }
+        }
+
+        for (size_t i = 0; i < kNumConcurrentControllers; i++) {
+            HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, tcpStreams[i]);
+        }
+        HAPPlatformClockAdvance(0);
+    }
+
+    // A session whose connection is closed while a job is running is released once the job has completed.
+    {
+        HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+        HAPPlatformClockAdvance(0);
+        err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+        HAPAssert(!err);
+        HAPPlatformClockAdvance(0);
+
+        SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+        HAPPlatformClockAdvance(0);
+        HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(server->pairSetup.sessionThatIsCurrentlyPairing);
+        RunScheduledCallbacks();
+        HAPPlatformClockAdvance(0);
+        HAPAssert(!server->pairSetup.sessionThatIsCurrentlyPairing);
+        err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+        HAPAssert(!err);
+        HAPPlatformClockAdvance(0);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    // Latency of a GET /accessories request that arrives together with Pair Setup M1 from another controller,
+    // and turnaround of Pair Setup M1 through the worker threads.
+    {
+        uint64_t numIterations = 20;
+        uint64_t numAccessoriesNanoseconds = 0;
+        uint64_t numPairSetupNanoseconds = 0;
+        for (uint64_t i = 0; i < numIterations; i++) {
+            HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+            HAPPlatformClockAdvance(0);
+            err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &pairingTCPStream);
+            HAPAssert(!err);
+            HAPPlatformClockAdvance(0);
+
+            uint64_t start = HAPBenchmarkGetNanoseconds();
+            SendPairingRequest(pairingTCPStream, "/pair-setup", pairSetupM1, sizeof pairSetupM1);
+            SendAccessoriesRequest(otherTCPStream);
+            HAPPlatformClockAdvance(0);
+            HAPAssert(ReadResponse(otherTCPStream, response, sizeof response, &numResponseBytes));
+            numAccessoriesNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+
+            RunScheduledCallbacks();
+            HAPAssert(ReadResponse(pairingTCPStream, response, sizeof response, &numResponseBytes));
+            numPairSetupNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+        }
+        HAPBenchmarkLogResult(
+                "GET /accessories during Pair Setup M1 (worker threads)", numIterations, numAccessoriesNanoseconds);
+        HAPBenchmarkLogResult("Pair Setup M1 (worker threads)", numIterations, numPairSetupNanoseconds);
+    }
+#endif
+
+    HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, pairingTCPStream);
+    HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, otherTCPStream);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    HAPPlatformWorkerPoolRelease(&workerPool);
+
+    return 0;
+}
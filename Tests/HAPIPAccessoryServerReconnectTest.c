@@ -0,0 +1,174 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+
+#include "Harness/HAPBenchmark.c"
+#include "Harness/TemplateDB.c"
+
+/** Number of controllers that reconnect at the same time. */
+#define kNumControllers ((size_t) 64)
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPPlatformTCPStreamManager tcpStreamManager;
+static HAPPlatformTCPStreamRef tcpStreams[kNumControllers];
+
+/**
+ * Connects all controllers at once. Each connection must be served by its own IP session afterwards.
+ */
+static void ConnectControllers(HAPAccessoryServerRef* server_) {
+    HAPError err;
+
+    for (size_t i = 0; i < kNumControllers; i++) {
+        err = HAPPlatformTCPStreamManagerConnectToListener(&tcpStreamManager, &tcpStreams[i]);
+        HAPAssert(!err);
+    }
+    HAPAssert(((HAPAccessoryServer*) server_)->ip.numSessions == kNumControllers);
+}
+
+/**
+ * Disconnects all controllers and waits until their IP sessions have been released.
+ */
+static void DisconnectControllers(HAPAccessoryServerRef* server_) {
+    for (size_t i = 0; i < kNumControllers; i++) {
+        HAPPlatformTCPStreamManagerClientClose(&tcpStreamManager, tcpStreams[i]);
+    }
+    HAPPlatformClockAdvance(0);
+    HAPAssert(((HAPAccessoryServer*) server_)->ip.numSessions == 0);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Use a TCP stream manager that supports all controllers at once.
+    static HAPPlatformTCPStream tcpStreamStorage[kNumControllers];
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .tcpStreams = tcpStreamStorage,
+                                                          .numTCPStreams = HAPArrayCount(tcpStreamStorage) });
+    platform.ip.tcpStreamManager = &tcpStreamManager;
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kNumControllers];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAssert(HAPPlatformTCPStreamManagerIsListenerOpen(&tcpStreamManager));
+
+    // All controllers reconnect at once, repeatedly.
+    for (size_t i = 0; i < 3; i++) {
+        ConnectControllers(&accessoryServer);
+
+        // Every session is serviceable: an unauthenticated request is rejected with a response.
+        static const char request[] = "GET /accessories HTTP/1.1\r\nHost: test\r\n\r\n";
+        size_t numClockReads = HAPPlatformClockGetNumReads();
+        for (size_t j = 0; j < kNumControllers; j++) {
+            size_t numBytes;
+            err = HAPPlatformTCPStreamClientWrite(
+                    &tcpStreamManager, tcpStreams[j], request, sizeof request - 1, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes == sizeof request - 1);
+        }
+        HAPPlatformClockAdvance(0);
+        for (size_t j = 0; j < kNumControllers; j++) {
+            char response[256];
+            size_t numBytes;
+            err = HAPPlatformTCPStreamClientRead(
+                    &tcpStreamManager, tcpStreams[j], response, sizeof response, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes > 0);
+        }
+
+        // Requests only use the coarse clock, which the run loop samples once when it wakes up.
+        numClockReads = HAPPlatformClockGetNumReads() - numClockReads;
+        HAPLog(&kHAPLog_Default, "%zu clock reads to process %zu requests.", numClockReads, kNumControllers);
+        HAPAssert(numClockReads <= 1);
+
+        DisconnectControllers(&accessoryServer);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    {
+        uint64_t numIterations = 10000;
+        uint64_t numNanoseconds = 0;
+        for (uint64_t i = 0; i < numIterations; i++) {
+            uint64_t start = HAPBenchmarkGetNanoseconds();
+            ConnectControllers(&accessoryServer);
+            numNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+            DisconnectControllers(&accessoryServer);
+        }
+        HAPBenchmarkLogResult("Reconnect storm of 64 controllers", numIterations, numNanoseconds);
+    }
+#endif
+
+    return 0;
+}
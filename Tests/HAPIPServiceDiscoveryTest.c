@@ -0,0 +1,172 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformServiceDiscovery+Test.h"
+
+#include "Harness/TemplateDB.c"
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Bridges,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+typedef struct {
+    const char* key;
+    char value[64];
+    bool found;
+} FindTXTRecordContext;
+
+static void FindTXTRecordCallback(
+        void* _Nullable context,
+        HAPPlatformServiceDiscoveryRef serviceDiscovery HAP_UNUSED,
+        const char* key,
+        const void* valueBytes,
+        size_t numValueBytes,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    FindTXTRecordContext* arguments = context;
+    HAPPrecondition(shouldContinue);
+
+    if (HAPStringAreEqual(key, arguments->key)) {
+        HAPAssert(numValueBytes < sizeof arguments->value);
+        HAPRawBufferCopyBytes(arguments->value, valueBytes, numValueBytes);
+        arguments->value[numValueBytes] = '\0';
+        arguments->found = true;
+        *shouldContinue = false;
+    }
+}
+
+/**
+ * Checks that the advertised TXT record with a given key has a given value.
+ */
+static void CheckTXTRecord(const char* key, const char* value) {
+    FindTXTRecordContext context = { .key = key };
+    HAPPlatformServiceDiscoveryEnumerateTXTRecords(platform.ip.serviceDiscovery, FindTXTRecordCallback, &context);
+    HAPAssert(context.found);
+    HAPAssert(HAPStringAreEqual(context.value, value));
+}
+
+int main() {
+    HAPError err;
+
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[2];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][1024];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kAttributeCount];
+    static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // Start accessory server. The _hap service is registered with all TXT records.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAssert(HAPPlatformServiceDiscoveryIsAdvertising(platform.ip.serviceDiscovery));
+    uint16_t configurationNumber;
+    err = HAPAccessoryServerGetCN(platform.keyValueStore, &configurationNumber);
+    HAPAssert(!err);
+    char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
+    err = HAPUInt64GetDescription(configurationNumber, configurationNumberBytes, sizeof configurationNumberBytes);
+    HAPAssert(!err);
+    CheckTXTRecord("c#", configurationNumberBytes);
+    CheckTXTRecord("md", "Test1,1");
+    CheckTXTRecord("s#", "1");
+    CheckTXTRecord("sf", "1");
+    CheckTXTRecord("ci", "2");
+
+    // The configuration number is cached. Changes in the key-value store are only picked up on registration.
+    err = HAPAccessoryServerIncrementCN(platform.keyValueStore);
+    HAPAssert(!err);
+
+    // A burst of updates is coalesced into one TXT record update.
+    HAPIPServiceDiscoveryUpdateHAPStatusFlags(&accessoryServer, 0);
+    HAPIPServiceDiscoveryUpdateHAPStatusFlags(&accessoryServer, 1);
+    HAPIPServiceDiscoveryUpdateHAPStatusFlags(&accessoryServer, 0);
+    HAPPlatformClockAdvance(kHAPIPServiceDiscovery_TXTRecordUpdateDelay - 1);
+    CheckTXTRecord("c#", configurationNumberBytes);
+    CheckTXTRecord("sf", "1");
+    HAPPlatformClockAdvance(1);
+    CheckTXTRecord("c#", configurationNumberBytes);
+    CheckTXTRecord("sf", "0");
+    CheckTXTRecord("md", "Test1,1");
+    CheckTXTRecord("s#", "1");
+    CheckTXTRecord("ci", "2");
+
+    // Pending updates are discarded when service discovery stops.
+    HAPIPServiceDiscoveryUpdateHAPStatusFlags(&accessoryServer, 1);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(kHAPIPServiceDiscovery_TXTRecordUpdateDelay);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    HAPAssert(!HAPPlatformServiceDiscoveryIsAdvertising(platform.ip.serviceDiscovery));
+
+    // Registering the service again reloads the configuration number.
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPPlatformServiceDiscoveryIsAdvertising(platform.ip.serviceDiscovery));
+    err = HAPUInt64GetDescription(configurationNumber + 1, configurationNumberBytes, sizeof configurationNumberBytes);
+    HAPAssert(!err);
+    CheckTXTRecord("c#", configurationNumberBytes);
+    CheckTXTRecord("sf", "1");
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformClock+Test.h"
+#include "HAPPlatformMFiHWAuth+Init.h"
+#include "HAPPlatformMFiHWAuth+Test.h"
+
+/**
+ * Duration after each register write during which the simulated Apple Authentication Coprocessor is busy.
+ */
+#define kTestNAKDuration ((HAPTime)(200 * HAPMillisecond))
+
+/**
+ * Interval of the timer that models other work on the run loop.
+ */
+#define kTestHeartbeatInterval ((HAPTime)(10 * HAPMillisecond))
+
+static HAPPlatformTimerRef heartbeatTimer;
+static size_t numHeartbeats;
+
+static void HeartbeatTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(timer == heartbeatTimer);
+    heartbeatTimer = 0;
+
+    numHeartbeats++;
+    HAPError err = HAPPlatformTimerRegister(
+            &heartbeatTimer, HAPPlatformClockGetCurrent() + kTestHeartbeatInterval, HeartbeatTimerExpired, NULL);
+    HAPAssert(!err);
+}
+
+typedef struct {
+    bool isComplete;
+    HAPError error;
+    size_t numSignatureBytes;
+    HAPTime completionTime;
+} SignatureResult;
+
+static void HandleSignatureCreated(
+        HAPMFiHWAuth* mfiHWAuth,
+        HAPError error,
+        size_t numSignatureBytes,
+        void* _Nullable context) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(context);
+    SignatureResult* result = context;
+    HAPAssert(!result->isComplete);
+
+    result->isComplete = true;
+    result->error = error;
+    result->numSignatureBytes = numSignatureBytes;
+    result->completionTime = HAPPlatformClockGetCurrent();
+
+    // Completion is reported only after the operation has finished.
+    HAPAssert(!HAPMFiHWAuthIsBusy(mfiHWAuth));
+}
+
+/**
+ * Advances the clock in small steps until the signature has been created.
+ */
+static void RunUntilComplete(const SignatureResult* result, HAPTime maxDuration) {
+    HAPTime startTime = HAPPlatformClockGetCurrent();
+    while (!result->isComplete) {
+        HAPAssert(HAPPlatformClockGetCurrent() - startTime < maxDuration);
+        HAPPlatformClockAdvance(1 * HAPMillisecond);
+    }
+}
+
+int main() {
+    HAPError err;
+
+    HAPPlatformCreate();
+
+    static HAPPlatformMFiHWAuth platformMFiHWAuth;
+    HAPPlatformMFiHWAuthCreate(&platformMFiHWAuth);
+    HAPPlatformMFiHWAuthSetNAKDuration(&platformMFiHWAuth, kTestNAKDuration);
+
+    static uint8_t certificateBytes[kHAPAccessoryServerMFiCertificateCache_MaxBytes];
+    static HAPMFiHWAuth mfiHWAuth;
+    HAPMFiHWAuthCreate(&mfiHWAuth, &platformMFiHWAuth);
+    HAPMFiHWAuthSetCertificateCache(&mfiHWAuth, certificateBytes, sizeof certificateBytes);
+
+    // Self test and accessory certificate are read once.
+    HAPMFiHWAuthPrepare(&mfiHWAuth);
+    HAPAssert(!HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth));
+    HAPAssert(mfiHWAuth.certificate.numBytes == kHAPPlatformMFiHWAuth_NumCertificateBytes);
+    for (size_t i = 0; i < mfiHWAuth.certificate.numBytes; i++) {
+        HAPAssert(certificateBytes[i] == HAPPlatformMFiHWAuthGetCertificateByte(i));
+    }
+    {
+        size_t numRegisterAccesses = HAPPlatformMFiHWAuthGetNumRegisterAccesses(&platformMFiHWAuth);
+        HAPMFiHWAuthPrepare(&mfiHWAuth);
+        HAPAssert(HAPMFiHWAuthIsAvailable(&mfiHWAuth));
+        HAPAssert(HAPPlatformMFiHWAuthGetNumRegisterAccesses(&platformMFiHWAuth) == numRegisterAccesses);
+    }
+
+    err = HAPPlatformTimerRegister(
+            &heartbeatTimer, HAPPlatformClockGetCurrent() + kTestHeartbeatInterval, HeartbeatTimerExpired, NULL);
+    HAPAssert(!err);
+
+    // Create a signature asynchronously.
+    {
+        uint8_t challengeBytes[kHAPMFiHWAuth_MaxChallengeBytes];
+        HAPPlatformRandomNumberFill(challengeBytes, sizeof challengeBytes);
+        uint8_t signatureBytes[kHAPMFiHWAuth_MaxSignatureBytes];
+
+        SignatureResult result;
+        HAPRawBufferZero(&result, sizeof result);
+        HAPTime startTime = HAPPlatformClockGetCurrent();
+        numHeartbeats = 0;
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &mfiHWAuth,
+                challengeBytes,
+                sizeof challengeBytes,
+                signatureBytes,
+                sizeof signatureBytes,
+                HandleSignatureCreated,
+                &result);
+        HAPAssert(!err);
+        HAPAssert(!result.isComplete);
+        HAPAssert(HAPMFiHWAuthIsBusy(&mfiHWAuth));
+
+        // Only one signature may be created at a time. Cached information remains available while busy.
+        {
+            SignatureResult otherResult;
+            HAPRawBufferZero(&otherResult, sizeof otherResult);
+            err = HAPMFiHWAuthCreateSignatureAsync(
+                    &mfiHWAuth,
+                    challengeBytes,
+                    sizeof challengeBytes,
+                    signatureBytes,
+                    sizeof signatureBytes,
+                    HandleSignatureCreated,
+                    &otherResult);
+            HAPAssert(err == kHAPError_InvalidState);
+            HAPAssert(HAPMFiHWAuthIsAvailable(&mfiHWAuth));
+            HAPAssert(!HAPMFiHWAuthIsSafeToRelease(&mfiHWAuth));
+        }
+
+        RunUntilComplete(&result, 5 * HAPSecond);
+        HAPAssert(!result.error);
+        HAPAssert(!HAPMFiHWAuthIsBusy(&mfiHWAuth));
+
+        // The challenge data and the authentication control writes each keep the coprocessor busy.
+        // Retries back off exponentially, so completion is delayed by at most one maximum retry delay per write.
+        HAPTime duration = result.completionTime - startTime;
+        HAPTime maxDelay = kHAPPlatformMFiHWAuthI2C_DefaultMaxRetryDelay;
+        HAPAssert(duration >= 2 * kTestNAKDuration);
+        HAPAssert(duration <= 2 * (kTestNAKDuration + maxDelay) + 10 * HAPMillisecond);
+
+        // The run loop kept serving other timers while the signature was being created.
+        HAPAssert(numHeartbeats >= duration / kTestHeartbeatInterval - 1);
+        HAPAssert(!HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth));
+
+        // Polling with a fixed 1 ms interval would take ~200 retries per busy period.
+        size_t numNAKs = HAPPlatformMFiHWAuthGetNumNAKs(&platformMFiHWAuth);
+        HAPLogInfo(
+                &kHAPLog_Default,
+                "Signature created after %llu ms with %zu NAKs.",
+                (unsigned long long) (duration / HAPMillisecond),
+                numNAKs);
+        HAPAssert(numNAKs >= 2);
+        HAPAssert(numNAKs <= 2 * 16);
+
+        // Simulated signature is the SHA-512 hash of the SHA-256 digest of the challenge.
+        uint8_t digestBytes[SHA256_BYTES];
+        HAP_sha256(digestBytes, challengeBytes, sizeof challengeBytes);
+        uint8_t expectedSignatureBytes[SHA512_BYTES];
+        HAP_sha512(expectedSignatureBytes, digestBytes, sizeof digestBytes);
+        HAPAssert(result.numSignatureBytes == sizeof expectedSignatureBytes);
+        HAPAssert(HAPRawBufferAreEqual(signatureBytes, expectedSignatureBytes, sizeof expectedSignatureBytes));
+    }
+
+    // Signature buffer too small.
+    {
+        uint8_t challengeBytes[kHAPMFiHWAuth_MaxChallengeBytes];
+        HAPPlatformRandomNumberFill(challengeBytes, sizeof challengeBytes);
+        uint8_t signatureBytes[SHA512_BYTES - 1];
+
+        SignatureResult result;
+        HAPRawBufferZero(&result, sizeof result);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &mfiHWAuth,
+                challengeBytes,
+                sizeof challengeBytes,
+                signatureBytes,
+                sizeof signatureBytes,
+                HandleSignatureCreated,
+                &result);
+        HAPAssert(!err);
+        RunUntilComplete(&result, 5 * HAPSecond);
+        HAPAssert(result.error == kHAPError_OutOfResources);
+    }
+
+    // Synchronous transactions block while the coprocessor is busy, backing off exponentially.
+    {
+        HAPPlatformClockAdvance(kTestNAKDuration);
+        uint8_t bytes[1 + SHA256_BYTES];
+        HAPRawBufferZero(bytes, sizeof bytes);
+        bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
+        err = HAPPlatformMFiHWAuthWrite(&platformMFiHWAuth, bytes, sizeof bytes);
+        HAPAssert(!err);
+        err = HAPPlatformMFiHWAuthRead(
+                &platformMFiHWAuth, kHAPMFiHWAuthRegister_AuthenticationControlAndStatus, bytes, 1);
+        HAPAssert(!err);
+        HAPTime stallDuration = HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth);
+        HAPAssert(stallDuration >= kTestNAKDuration);
+        HAPAssert(
+                stallDuration <=
+                kTestNAKDuration + kHAPPlatformMFiHWAuthI2C_SynchronousMaxRetryDelayMicroseconds / 1000);
+    }
+
+    // Transactions time out if the coprocessor stays busy.
+    {
+        HAPPlatformMFiHWAuthSetNAKDuration(&platformMFiHWAuth, 60 * HAPSecond);
+
+        uint8_t challengeBytes[kHAPMFiHWAuth_MaxChallengeBytes];
+        HAPPlatformRandomNumberFill(challengeBytes, sizeof challengeBytes);
+        uint8_t signatureBytes[kHAPMFiHWAuth_MaxSignatureBytes];
+
+        SignatureResult result;
+        HAPRawBufferZero(&result, sizeof result);
+        HAPTime startTime = HAPPlatformClockGetCurrent();
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &mfiHWAuth,
+                challengeBytes,
+                sizeof challengeBytes,
+                signatureBytes,
+                sizeof signatureBytes,
+                HandleSignatureCreated,
+                &result);
+        HAPAssert(!err);
+        RunUntilComplete(&result, 10 * HAPSecond);
+        HAPAssert(result.error == kHAPError_Unknown);
+        HAPAssert(result.completionTime - startTime >= kHAPPlatformMFiHWAuthI2C_DefaultTimeout);
+        HAPAssert(
+                result.completionTime - startTime <= kHAPPlatformMFiHWAuthI2C_DefaultTimeout + 10 * HAPMillisecond);
+    }
+
+    // Synchronous transactions give up after the synchronous retry budget if the coprocessor stays busy.
+    // The budget does not exceed the former fixed polling loop of 1000 retries at 500 us.
+    {
+        HAPAssert(kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds <= 1000 * 500);
+        HAPTime maxStallDuration = kHAPPlatformMFiHWAuthI2C_SynchronousRetryBudgetMicroseconds / 1000;
+
+        uint8_t bytes[1 + SHA256_BYTES];
+        HAPRawBufferZero(bytes, sizeof bytes);
+        bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
+        HAPTime stallDuration = HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth);
+        err = HAPPlatformMFiHWAuthWrite(&platformMFiHWAuth, bytes, sizeof bytes);
+        HAPAssert(err == kHAPError_Unknown);
+        HAPAssert(HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth) - stallDuration == maxStallDuration);
+
+        // Selecting the register and reading it share the budget.
+        stallDuration = HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth);
+        err = HAPPlatformMFiHWAuthRead(
+                &platformMFiHWAuth, kHAPMFiHWAuthRegister_AuthenticationControlAndStatus, bytes, 1);
+        HAPAssert(err == kHAPError_Unknown);
+        HAPAssert(HAPPlatformMFiHWAuthGetStallDuration(&platformMFiHWAuth) - stallDuration == maxStallDuration);
+
+        // The clock has not been advanced. The coprocessor is still busy.
+        HAPAssert(HAPPlatformMFiHWAuthGetNumNAKs(&platformMFiHWAuth) > 0);
+    }
+
+    HAPPlatformTimerDeregister(heartbeatTimer);
+    HAPMFiHWAuthRelease(&mfiHWAuth);
+    HAPPlatformMFiHWAuthRelease(&platformMFiHWAuth);
+
+    return 0;
+}
@@ -0,0 +1,402 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// accept4 is a GNU extension.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "HAP.h"
+
+// A simulated central talks to the POSIX BLE peripheral manager through its SOCK_SEQPACKET socket.
+#include "../PAL/POSIX/HAPPlatformBLEPeripheralManager.c"
+
+#define kATTOpcode_ErrorResponse           ((uint8_t) 0x01)
+#define kATTOpcode_ExchangeMTURequest      ((uint8_t) 0x02)
+#define kATTOpcode_ExchangeMTUResponse     ((uint8_t) 0x03)
+#define kATTOpcode_ReadByTypeRequest       ((uint8_t) 0x08)
+#define kATTOpcode_ReadByTypeResponse      ((uint8_t) 0x09)
+#define kATTOpcode_ReadRequest             ((uint8_t) 0x0A)
+#define kATTOpcode_ReadResponse            ((uint8_t) 0x0B)
+#define kATTOpcode_ReadByGroupTypeRequest  ((uint8_t) 0x10)
+#define kATTOpcode_ReadByGroupTypeResponse ((uint8_t) 0x11)
+
+#define kATTError_AttributeNotFound ((uint8_t) 0x0A)
+
+#define kGATTType_PrimaryService           ((uint16_t) 0x2800)
+#define kGATTType_CharacteristicDeclaration ((uint16_t) 0x2803)
+
+/** ATT_MTU that the simulated central supports. */
+#define kCentralMTU ((uint16_t) 185)
+
+/**
+ * Registered file handles.
+ *
+ * - The Mock PAL has no run loop. RunLoopIteration polls the registered file descriptors and invokes the callbacks.
+ */
+static struct {
+    bool isRegistered;
+    int fileDescriptor;
+    HAPPlatformFileHandleEvent interests;
+    HAPPlatformFileHandleCallback callback;
+    void* _Nullable context;
+} fileHandles[4];
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformFileHandleRegister(
+        HAPPlatformFileHandleRef* fileHandle,
+        int fileDescriptor,
+        HAPPlatformFileHandleEvent interests,
+        HAPPlatformFileHandleCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(fileHandle);
+    HAPPrecondition(fileDescriptor >= 0);
+    HAPPrecondition(callback);
+
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        if (!fileHandles[i].isRegistered) {
+            fileHandles[i].isRegistered = true;
+            fileHandles[i].fileDescriptor = fileDescriptor;
+            fileHandles[i].interests = interests;
+            fileHandles[i].callback = callback;
+            fileHandles[i].context = context;
+            *fileHandle = (HAPPlatformFileHandleRef) i + 1;
+            return kHAPError_None;
+        }
+    }
+    return kHAPError_OutOfResources;
+}
+
+void HAPPlatformFileHandleUpdateInterests(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent interests,
+        HAPPlatformFileHandleCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(fileHandle && fileHandle <= HAPArrayCount(fileHandles));
+    HAPPrecondition(fileHandles[fileHandle - 1].isRegistered);
+    HAPPrecondition(callback);
+
+    fileHandles[fileHandle - 1].interests = interests;
+    fileHandles[fileHandle - 1].callback = callback;
+    fileHandles[fileHandle - 1].context = context;
+}
+
+void HAPPlatformFileHandleDeregister(HAPPlatformFileHandleRef fileHandle) {
+    HAPPrecondition(fileHandle && fileHandle <= HAPArrayCount(fileHandles));
+    HAPPrecondition(fileHandles[fileHandle - 1].isRegistered);
+
+    HAPRawBufferZero(&fileHandles[fileHandle - 1], sizeof fileHandles[fileHandle - 1]);
+}
+
+void HAPPlatformLogPOSIXError(
+        HAPLogType type,
+        const char* message,
+        int errorNumber,
+        const char* function,
+        const char* file,
+        int line) {
+    HAPLogWithType(&kHAPLog_Default, type, "%s:%d - %s @ %s: %d.", file, line, message, function, errorNumber);
+}
+
+/**
+ * Waits until a registered file descriptor is ready and invokes the callbacks of all ready file handles.
+ */
+static void RunLoopIteration(void) {
+    struct pollfd fds[HAPArrayCount(fileHandles)];
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        fds[i].fd = -1;
+        fds[i].events = 0;
+        fds[i].revents = 0;
+        if (fileHandles[i].isRegistered) {
+            fds[i].fd = fileHandles[i].fileDescriptor;
+            fds[i].events = (short) ((fileHandles[i].interests.isReadyForReading ? POLLIN : 0) |
+                                     (fileHandles[i].interests.isReadyForWriting ? POLLOUT : 0));
+        }
+    }
+    int n = poll(fds, HAPArrayCount(fds), /* timeout: */ 1000);
+    HAPAssert(n > 0);
+
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        // Callbacks may deregister file handles.
+        if (!fds[i].revents || !fileHandles[i].isRegistered || fileHandles[i].fileDescriptor != fds[i].fd) {
+            continue;
+        }
+        fileHandles[i].callback(
+                (HAPPlatformFileHandleRef) i + 1,
+                (HAPPlatformFileHandleEvent) { .isReadyForReading = (fds[i].revents & (POLLIN | POLLHUP)) != 0,
+                                               .isReadyForWriting = (fds[i].revents & POLLOUT) != 0,
+                                               .hasErrorConditionPending = false },
+                fileHandles[i].context);
+    }
+}
+
+static const HAPPlatformBLEPeripheralManagerUUID serviceTypes[] = {
+    { { 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00 } },
+    { { 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00 } },
+};
+
+static const HAPPlatformBLEPeripheralManagerUUID characteristicTypes[] = {
+    { { 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00 } },
+    { { 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00 } },
+};
+
+static const char* const characteristicValues[] = { "Acme Test", "Lock" };
+
+/**
+ * State of the accessory side.
+ */
+static struct {
+    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandles[HAPArrayCount(characteristicTypes)];
+    HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
+    bool isConnected;
+    size_t numReads;
+} accessory;
+
+static void HandleConnectedCentral(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+        void* _Nullable context) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(context == &accessory);
+    HAPAssert(!accessory.isConnected);
+
+    accessory.isConnected = true;
+    accessory.connectionHandle = connectionHandle;
+}
+
+static void HandleDisconnectedCentral(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+        void* _Nullable context) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(context == &accessory);
+    HAPAssert(accessory.isConnected);
+    HAPAssert(connectionHandle == accessory.connectionHandle);
+
+    accessory.isConnected = false;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleReadRequest(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes,
+        void* _Nullable context) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(context == &accessory);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+    HAPAssert(connectionHandle == accessory.connectionHandle);
+
+    for (size_t i = 0; i < HAPArrayCount(accessory.valueHandles); i++) {
+        if (attributeHandle == accessory.valueHandles[i]) {
+            size_t numValueBytes = HAPStringGetNumBytes(characteristicValues[i]);
+            HAPAssert(numValueBytes <= maxBytes);
+            HAPRawBufferCopyBytes(bytes, characteristicValues[i], numValueBytes);
+            *numBytes = numValueBytes;
+            accessory.numReads++;
+            return kHAPError_None;
+        }
+    }
+    return kHAPError_InvalidState;
+}
+
+/**
+ * Socket of the simulated central.
+ */
+static int centralFileDescriptor = -1;
+
+/**
+ * Sends an ATT PDU to the accessory, lets the accessory handle it, and receives the response.
+ *
+ * @return Length of the response.
+ */
+static size_t Exchange(uint8_t* pdu, size_t numPDUBytes, size_t maxPDUBytes) {
+    ssize_t n = send(centralFileDescriptor, pdu, numPDUBytes, 0);
+    HAPAssert(n == (ssize_t) numPDUBytes);
+
+    RunLoopIteration();
+
+    // Each response is a single packet.
+    n = recv(centralFileDescriptor, pdu, maxPDUBytes, MSG_DONTWAIT | MSG_TRUNC);
+    HAPAssert(n > 0 && (size_t) n <= maxPDUBytes);
+    return (size_t) n;
+}
+
+int main() {
+    HAPError err;
+
+    char directory[] = "/tmp/HAPPlatformBLEPeripheralManagerSocketTest.XXXXXX";
+    HAPAssert(mkdtemp(directory));
+    char socketPath[sizeof directory + 16];
+    int n = snprintf(socketPath, sizeof socketPath, "%s/ble.sock", directory);
+    HAPAssert(n > 0 && (size_t) n < sizeof socketPath);
+
+    // Stale socket of a previous run.
+    {
+        int fileDescriptor = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        HAPAssert(fileDescriptor != -1);
+        struct sockaddr_un sun;
+        HAPRawBufferZero(&sun, sizeof sun);
+        sun.sun_family = AF_UNIX;
+        HAPRawBufferCopyBytes(sun.sun_path, socketPath, HAPStringGetNumBytes(socketPath));
+        int e = bind(fileDescriptor, (struct sockaddr*) &sun, sizeof sun);
+        HAPAssert(!e);
+        (void) close(fileDescriptor);
+    }
+
+    static HAPPlatformBLEPeripheralManagerAttribute attributes[16];
+    static HAPPlatformBLEPeripheralManager blePeripheralManager;
+    HAPPlatformBLEPeripheralManagerCreate(
+            &blePeripheralManager,
+            &(const HAPPlatformBLEPeripheralManagerOptions) {
+                    .attributes = attributes, .numAttributes = HAPArrayCount(attributes), .socketPath = socketPath });
+    HAPPlatformBLEPeripheralManagerSetDelegate(
+            &blePeripheralManager,
+            &(const HAPPlatformBLEPeripheralManagerDelegate) { .context = &accessory,
+                                                               .handleConnectedCentral = HandleConnectedCentral,
+                                                               .handleDisconnectedCentral = HandleDisconnectedCentral,
+                                                               .handleReadRequest = HandleReadRequest });
+    HAPPlatformBLEPeripheralManagerSetDeviceAddress(
+            &blePeripheralManager,
+            &(const HAPPlatformBLEPeripheralManagerDeviceAddress) { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } });
+    for (size_t i = 0; i < HAPArrayCount(serviceTypes); i++) {
+        err = HAPPlatformBLEPeripheralManagerAddService(&blePeripheralManager, &serviceTypes[i], /* isPrimary: */ true);
+        HAPAssert(!err);
+        err = HAPPlatformBLEPeripheralManagerAddCharacteristic(
+                &blePeripheralManager,
+                &characteristicTypes[i],
+                (HAPPlatformBLEPeripheralManagerCharacteristicProperties) { .read = true },
+                NULL,
+                0,
+                &accessory.valueHandles[i],
+                NULL);
+        HAPAssert(!err);
+    }
+    HAPPlatformBLEPeripheralManagerPublishServices(&blePeripheralManager);
+
+    // The stale socket has been replaced by a socket that only the owner may connect to.
+    {
+        struct stat st;
+        int e = lstat(socketPath, &st);
+        HAPAssert(!e);
+        HAPAssert(S_ISSOCK(st.st_mode));
+        HAPAssert((st.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) == (S_IRUSR | S_IWUSR));
+    }
+
+    // Centrals are accepted while advertising.
+    static const uint8_t advertisingBytes[] = { 0x02, 0x01, 0x06 };
+    HAPPlatformBLEPeripheralManagerStartAdvertising(
+            &blePeripheralManager,
+            HAPBLEAdvertisingIntervalCreateFromMilliseconds(20),
+            advertisingBytes,
+            sizeof advertisingBytes,
+            NULL,
+            0);
+
+    centralFileDescriptor = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    HAPAssert(centralFileDescriptor != -1);
+    {
+        struct sockaddr_un sun;
+        HAPRawBufferZero(&sun, sizeof sun);
+        sun.sun_family = AF_UNIX;
+        HAPRawBufferCopyBytes(sun.sun_path, socketPath, HAPStringGetNumBytes(socketPath));
+        int e = connect(centralFileDescriptor, (struct sockaddr*) &sun, sizeof sun);
+        HAPAssert(!e);
+    }
+    RunLoopIteration();
+    HAPAssert(accessory.isConnected);
+
+    uint8_t pdu[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+
+    // MTU exchange.
+    {
+        pdu[0] = kATTOpcode_ExchangeMTURequest;
+        HAPWriteLittleUInt16(&pdu[1], kCentralMTU);
+        size_t numPDUBytes = Exchange(pdu, 3, sizeof pdu);
+        HAPAssert(numPDUBytes == 3 && pdu[0] == kATTOpcode_ExchangeMTUResponse);
+        HAPAssert(HAPReadLittleUInt16(&pdu[1]) >= kCentralMTU);
+    }
+
+    // Primary service discovery.
+    struct {
+        HAPPlatformBLEPeripheralManagerAttributeHandle startHandle;
+        HAPPlatformBLEPeripheralManagerAttributeHandle endHandle;
+    } services[HAPArrayCount(serviceTypes)];
+    size_t numServices = 0;
+    for (uint32_t handle = 1; handle <= UINT16_MAX;) {
+        pdu[0] = kATTOpcode_ReadByGroupTypeRequest;
+        HAPWriteLittleUInt16(&pdu[1], handle);
+        HAPWriteLittleUInt16(&pdu[3], UINT16_MAX);
+        HAPWriteLittleUInt16(&pdu[5], kGATTType_PrimaryService);
+        size_t numPDUBytes = Exchange(pdu, 7, sizeof pdu);
+        if (pdu[0] == kATTOpcode_ErrorResponse) {
+            HAPAssert(numPDUBytes == 5 && pdu[4] == kATTError_AttributeNotFound);
+            break;
+        }
+        HAPAssert(pdu[0] == kATTOpcode_ReadByGroupTypeResponse);
+        size_t length = pdu[1];
+        HAPAssert(length == 2 + 2 + 16 && (numPDUBytes - 2) % length == 0);
+        for (size_t i = 2; i < numPDUBytes; i += length) {
+            HAPAssert(numServices < HAPArrayCount(services));
+            HAPAssert(HAPRawBufferAreEqual(&pdu[i + 4], serviceTypes[numServices].bytes, 16));
+            services[numServices].startHandle = HAPReadLittleUInt16(&pdu[i]);
+            services[numServices].endHandle = HAPReadLittleUInt16(&pdu[i + 2]);
+            handle = (uint32_t) services[numServices].endHandle + 1;
+            numServices++;
+        }
+    }
+    HAPAssert(numServices == HAPArrayCount(serviceTypes));
+
+    // Characteristic discovery.
+    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandles[HAPArrayCount(characteristicTypes)];
+    for (size_t i = 0; i < numServices; i++) {
+        pdu[0] = kATTOpcode_ReadByTypeRequest;
+        HAPWriteLittleUInt16(&pdu[1], services[i].startHandle);
+        HAPWriteLittleUInt16(&pdu[3], services[i].endHandle);
+        HAPWriteLittleUInt16(&pdu[5], kGATTType_CharacteristicDeclaration);
+        size_t numPDUBytes = Exchange(pdu, 7, sizeof pdu);
+        HAPAssert(pdu[0] == kATTOpcode_ReadByTypeResponse);
+        HAPAssert(pdu[1] == 2 + 1 + 2 + 16 && numPDUBytes == 2 + (size_t) pdu[1]);
+        HAPAssert(HAPRawBufferAreEqual(&pdu[7], characteristicTypes[i].bytes, 16));
+        valueHandles[i] = HAPReadLittleUInt16(&pdu[5]);
+        HAPAssert(valueHandles[i] == accessory.valueHandles[i]);
+    }
+
+    // Read.
+    for (size_t i = 0; i < HAPArrayCount(valueHandles); i++) {
+        pdu[0] = kATTOpcode_ReadRequest;
+        HAPWriteLittleUInt16(&pdu[1], valueHandles[i]);
+        size_t numPDUBytes = Exchange(pdu, 3, sizeof pdu);
+        HAPAssert(pdu[0] == kATTOpcode_ReadResponse);
+        HAPAssert(numPDUBytes == 1 + HAPStringGetNumBytes(characteristicValues[i]));
+        HAPAssert(HAPRawBufferAreEqual(&pdu[1], characteristicValues[i], numPDUBytes - 1));
+    }
+    HAPAssert(accessory.numReads == HAPArrayCount(valueHandles));
+
+    // Disconnect.
+    (void) close(centralFileDescriptor);
+    RunLoopIteration();
+    HAPAssert(!accessory.isConnected);
+
+    HAPPlatformBLEPeripheralManagerStopAdvertising(&blePeripheralManager);
+    HAPPlatformBLEPeripheralManagerRemoveAllServices(&blePeripheralManager);
+    HAPAssert(access(socketPath, F_OK) == -1);
+    HAPAssert(rmdir(directory) == 0);
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformGPIOInput.h"
+
+/**
+ * Edge that has been reported by the GPIO input.
+ */
+typedef struct {
+    bool value;
+    uint64_t timestamp;
+} Edge;
+
+static Edge edges[16];
+static size_t numEdges;
+
+static void HandleEdge(HAPPlatformGPIOInput* input, bool value, uint64_t timestamp, void* _Nullable context) {
+    HAPPrecondition(input);
+    HAPPrecondition(context);
+    HAPAssert(context == &numEdges);
+    HAPAssert(numEdges < HAPArrayCount(edges));
+
+    edges[numEdges].value = value;
+    edges[numEdges].timestamp = timestamp;
+    numEdges++;
+}
+
+/**
+ * Fake line event source: the write end of a socket pair, fed like the kernel feeds a line event file descriptor.
+ */
+static int fakeFileDescriptors[2];
+
+/**
+ * Writes a line event to the fake line event source, optionally split into two writes.
+ */
+static void WriteEvent(uint64_t timestamp, uint32_t eventID, size_t splitOffset) {
+    HAPPrecondition(splitOffset <= kHAPPlatformGPIOInputEvent_NumBytes);
+
+    uint8_t bytes[kHAPPlatformGPIOInputEvent_NumBytes];
+    HAPRawBufferZero(bytes, sizeof bytes);
+    HAPRawBufferCopyBytes(&bytes[0], &timestamp, sizeof timestamp);
+    HAPRawBufferCopyBytes(&bytes[8], &eventID, sizeof eventID);
+
+    if (splitOffset) {
+        ssize_t n = write(fakeFileDescriptors[1], bytes, splitOffset);
+        HAPAssert(n == (ssize_t) splitOffset);
+    }
+    if (splitOffset < sizeof bytes) {
+        ssize_t n = write(fakeFileDescriptors[1], &bytes[splitOffset], sizeof bytes - splitOffset);
+        HAPAssert(n == (ssize_t) (sizeof bytes - splitOffset));
+    }
+}
+
+/**
+ * Reads pending bytes from the fake line event source in chunks of a given size and passes them to the GPIO input.
+ */
+static void ReadEvents(HAPPlatformGPIOInput* input, size_t maxBytesPerRead) {
+    HAPPrecondition(input);
+
+    for (;;) {
+        uint8_t bytes[256];
+        HAPAssert(maxBytesPerRead <= sizeof bytes);
+        ssize_t n = recv(fakeFileDescriptors[0], bytes, maxBytesPerRead, MSG_DONTWAIT);
+        if (n <= 0) {
+            return;
+        }
+        HAPPlatformGPIOInputHandleBytes(input, bytes, (size_t) n);
+    }
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    int e = socketpair(AF_UNIX, SOCK_STREAM, 0, fakeFileDescriptors);
+    HAPAssert(!e);
+
+    static HAPPlatformGPIOInput input;
+    HAPPlatformGPIOInputCreate(
+            &input,
+            &(const HAPPlatformGPIOInputOptions) { .initialValue = true,
+                                                   .debounceDuration = 20 * HAPMillisecond,
+                                                   .callback = HandleEdge,
+                                                   .context = &numEdges });
+    HAPAssert(HAPPlatformGPIOInputGetValue(&input));
+
+    const uint64_t ms = 1000000;
+
+    // Edges are reported with their timestamps. Events split across reads are reassembled.
+    WriteEvent(1000 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 5);
+    WriteEvent(1500 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+    ReadEvents(&input, 7);
+    HAPAssert(numEdges == 2);
+    HAPAssert(!edges[0].value && edges[0].timestamp == 1000 * ms);
+    HAPAssert(edges[1].value && edges[1].timestamp == 1500 * ms);
+    HAPAssert(HAPPlatformGPIOInputGetValue(&input));
+
+    // Bounces within the debounce duration are ignored.
+    numEdges = 0;
+    WriteEvent(2000 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+    WriteEvent(2001 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+    WriteEvent(2002 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+    WriteEvent(2019 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+    WriteEvent(2020 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+    ReadEvents(&input, 256);
+    HAPAssert(numEdges == 2);
+    HAPAssert(!edges[0].value && edges[0].timestamp == 2000 * ms);
+    HAPAssert(edges[1].value && edges[1].timestamp == 2020 * ms);
+
+    // Edges that do not change the value and unknown events are ignored.
+    numEdges = 0;
+    WriteEvent(3000 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+    WriteEvent(3100 * ms, 0x42, 0);
+    WriteEvent(3200 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 15);
+    ReadEvents(&input, 1);
+    HAPAssert(numEdges == 1);
+    HAPAssert(!edges[0].value && edges[0].timestamp == 3200 * ms);
+    HAPAssert(!HAPPlatformGPIOInputGetValue(&input));
+
+    // Short press: the line is released within the debounce duration and stays quiet afterwards.
+    // The release is pending until the debounce duration has elapsed, so that the value does not stick.
+    {
+        numEdges = 0;
+        HAPTime delay;
+        WriteEvent(4000 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+        WriteEvent(4005 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+        ReadEvents(&input, 256);
+        HAPAssert(numEdges == 1);
+        HAPAssert(edges[0].value && edges[0].timestamp == 4000 * ms);
+        HAPAssert(HAPPlatformGPIOInputGetValue(&input));
+        HAPAssert(HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay));
+        HAPAssert(delay == 15 * HAPMillisecond);
+
+        HAPPlatformGPIOInputHandleDebounceTimeout(&input);
+        HAPAssert(numEdges == 2);
+        HAPAssert(!edges[1].value && edges[1].timestamp == 4020 * ms);
+        HAPAssert(!HAPPlatformGPIOInputGetValue(&input));
+        HAPAssert(!HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay));
+
+        // Without a pending edge, the timeout has no effect.
+        HAPPlatformGPIOInputHandleDebounceTimeout(&input);
+        HAPAssert(numEdges == 2);
+    }
+
+    // A pending edge is reported before a line event that arrives after the debounce duration.
+    {
+        numEdges = 0;
+        HAPTime delay;
+        WriteEvent(5000 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+        WriteEvent(5001 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+        WriteEvent(5100 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+        ReadEvents(&input, 256);
+        HAPAssert(numEdges == 3);
+        HAPAssert(edges[0].value && edges[0].timestamp == 5000 * ms);
+        HAPAssert(!edges[1].value && edges[1].timestamp == 5020 * ms);
+        HAPAssert(edges[2].value && edges[2].timestamp == 5100 * ms);
+        HAPAssert(!HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay));
+    }
+
+    // A bounce that returns to the reported value within the debounce duration is not reported.
+    {
+        numEdges = 0;
+        HAPTime delay;
+        WriteEvent(6000 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+        WriteEvent(6003 * ms, kHAPPlatformGPIOInputEvent_RisingEdge, 0);
+        ReadEvents(&input, 256);
+        HAPAssert(HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay));
+        HAPAssert(delay == 17 * HAPMillisecond);
+        WriteEvent(6004 * ms, kHAPPlatformGPIOInputEvent_FallingEdge, 0);
+        ReadEvents(&input, 256);
+        HAPAssert(!HAPPlatformGPIOInputGetPendingEdgeDelay(&input, &delay));
+        HAPPlatformGPIOInputHandleDebounceTimeout(&input);
+        HAPAssert(numEdges == 1);
+        HAPAssert(!edges[0].value && edges[0].timestamp == 6000 * ms);
+        HAPAssert(!HAPPlatformGPIOInputGetValue(&input));
+    }
+
+    (void) close(fakeFileDescriptors[0]);
+    (void) close(fakeFileDescriptors[1]);
+
+    return 0;
+}
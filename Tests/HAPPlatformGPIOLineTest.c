@@ -0,0 +1,254 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformClock+Test.h"
+
+// The POSIX GPIO line is driven by the Mock clock and timers. Line events are fed through a socket pair.
+#include "../PAL/POSIX/HAPPlatformGPIOLine.c"
+
+/**
+ * File handle of the GPIO line.
+ *
+ * - The Mock PAL has no run loop. DispatchEvents invokes the callback when line events have been written.
+ */
+static struct {
+    bool isRegistered;
+    int fileDescriptor;
+    HAPPlatformFileHandleCallback callback;
+    void* _Nullable context;
+} fileHandle;
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformFileHandleRegister(
+        HAPPlatformFileHandleRef* fileHandleRef,
+        int fileDescriptor,
+        HAPPlatformFileHandleEvent interests,
+        HAPPlatformFileHandleCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(fileHandleRef);
+    HAPPrecondition(interests.isReadyForReading);
+    HAPPrecondition(callback);
+    HAPPrecondition(!fileHandle.isRegistered);
+
+    fileHandle.isRegistered = true;
+    fileHandle.fileDescriptor = fileDescriptor;
+    fileHandle.callback = callback;
+    fileHandle.context = context;
+    *fileHandleRef = (HAPPlatformFileHandleRef) &fileHandle;
+    return kHAPError_None;
+}
+
+void HAPPlatformFileHandleDeregister(HAPPlatformFileHandleRef fileHandleRef) {
+    HAPPrecondition(fileHandleRef == (HAPPlatformFileHandleRef) &fileHandle);
+    HAPPrecondition(fileHandle.isRegistered);
+
+    HAPRawBufferZero(&fileHandle, sizeof fileHandle);
+}
+
+void HAPPlatformLogPOSIXError(
+        HAPLogType type,
+        const char* message,
+        int errorNumber,
+        const char* function,
+        const char* file,
+        int line) {
+    HAPLogWithType(&kHAPLog_Default, type, "%s:%d - %s @ %s: %d.", file, line, message, function, errorNumber);
+}
+
+/**
+ * Edge that has been reported by the GPIO line.
+ */
+typedef struct {
+    bool value;
+    uint64_t timestamp;
+} Edge;
+
+static Edge edges[16];
+static size_t numEdges;
+
+static void HandleLineEdge(HAPPlatformGPIOLine* line, bool value, uint64_t timestamp, void* _Nullable context) {
+    HAPPrecondition(line);
+    HAPPrecondition(context);
+    HAPAssert(context == &numEdges);
+    HAPAssert(numEdges < HAPArrayCount(edges));
+
+    edges[numEdges].value = value;
+    edges[numEdges].timestamp = timestamp;
+    numEdges++;
+}
+
+/**
+ * Converts a time of the Mock clock to a line event timestamp in nanoseconds.
+ */
+static uint64_t GetTimestamp(HAPTime time) {
+    return time / HAPMillisecond * 1000000;
+}
+
+/**
+ * Write end of the fake line event source.
+ */
+static int fakeFileDescriptor;
+
+/**
+ * Writes a line event with the current time of the Mock clock as its timestamp.
+ */
+static void WriteEvent(uint32_t eventID) {
+    uint64_t timestamp = GetTimestamp(HAPPlatformClockGetCurrent());
+    uint8_t bytes[kHAPPlatformGPIOInputEvent_NumBytes];
+    HAPRawBufferZero(bytes, sizeof bytes);
+    HAPRawBufferCopyBytes(&bytes[0], &timestamp, sizeof timestamp);
+    HAPRawBufferCopyBytes(&bytes[8], &eventID, sizeof eventID);
+
+    ssize_t n = write(fakeFileDescriptor, bytes, sizeof bytes);
+    HAPAssert(n == (ssize_t) sizeof bytes);
+}
+
+/**
+ * Reports the line event file descriptor as ready for reading, like the run loop does.
+ */
+static void DispatchEvents(void) {
+    HAPAssert(fileHandle.isRegistered);
+    fileHandle.callback(
+            (HAPPlatformFileHandleRef) &fileHandle,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = true, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            fileHandle.context);
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    int fileDescriptors[2];
+    int e = socketpair(AF_UNIX, SOCK_STREAM, 0, fileDescriptors);
+    HAPAssert(!e);
+    fakeFileDescriptor = fileDescriptors[1];
+
+    static HAPPlatformGPIOLine line;
+    HAPPlatformGPIOLineCreateWithFileDescriptor(
+            &line,
+            fileDescriptors[0],
+            /* initialValue: */ false,
+            &(const HAPPlatformGPIOLineOptions) {
+                    .debounceDuration = 20 * HAPMillisecond, .callback = HandleLineEdge, .context = &numEdges });
+    HAPAssert(fileHandle.isRegistered && fileHandle.fileDescriptor == fileDescriptors[0]);
+    HAPAssert(!HAPPlatformGPIOLineGetValue(&line));
+
+    HAPPlatformClockAdvance(1 * HAPSecond);
+
+    // Short press: the line settles within the debounce duration and stays quiet afterwards.
+    // The release is reported by the debounce timer once the debounce duration has elapsed.
+    {
+        numEdges = 0;
+        HAPTime pressTime = HAPPlatformClockGetCurrent();
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 1);
+        HAPAssert(edges[0].value && edges[0].timestamp == GetTimestamp(pressTime));
+        HAPAssert(!line.debounceTimer);
+
+        HAPPlatformClockAdvance(5 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_FallingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 1);
+        HAPAssert(HAPPlatformGPIOLineGetValue(&line));
+        HAPAssert(line.debounceTimer);
+
+        HAPPlatformClockAdvance(14 * HAPMillisecond);
+        HAPAssert(numEdges == 1);
+        HAPAssert(HAPPlatformGPIOLineGetValue(&line));
+
+        HAPPlatformClockAdvance(1 * HAPMillisecond);
+        HAPAssert(numEdges == 2);
+        HAPAssert(!edges[1].value && edges[1].timestamp == GetTimestamp(pressTime + 20 * HAPMillisecond));
+        HAPAssert(!HAPPlatformGPIOLineGetValue(&line));
+        HAPAssert(!line.debounceTimer);
+
+        // The timer fires only once.
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        HAPAssert(numEdges == 2);
+    }
+
+    // Bouncing press: the line keeps bouncing past the debounce duration.
+    // The timer is disarmed whenever the line returns to the reported value, and re-armed for the next edge.
+    {
+        numEdges = 0;
+        HAPTime pressTime = HAPPlatformClockGetCurrent();
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 1);
+        HAPAssert(edges[0].value && edges[0].timestamp == GetTimestamp(pressTime));
+
+        HAPPlatformClockAdvance(5 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_FallingEdge);
+        DispatchEvents();
+        HAPAssert(line.debounceTimer);
+
+        HAPPlatformClockAdvance(13 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        DispatchEvents();
+        HAPAssert(!line.debounceTimer);
+
+        // Passing the deadline of the discarded edge has no effect.
+        HAPPlatformClockAdvance(1 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_FallingEdge);
+        DispatchEvents();
+        HAPAssert(line.debounceTimer);
+        HAPAssert(numEdges == 1);
+        HAPAssert(HAPPlatformGPIOLineGetValue(&line));
+
+        // The pending falling edge is reported by the timer when the debounce duration elapses.
+        HAPPlatformClockAdvance(3 * HAPMillisecond);
+        HAPAssert(numEdges == 2);
+        HAPAssert(!edges[1].value && edges[1].timestamp == GetTimestamp(pressTime + 20 * HAPMillisecond));
+        HAPAssert(!line.debounceTimer);
+
+        // The bounce continues past the debounce duration. A bounce within one read is discarded.
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        WriteEvent(kHAPPlatformGPIOInputEvent_FallingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 2);
+        HAPAssert(!line.debounceTimer);
+
+        // The line settles high at 25 ms. The edge is reported once 20 ms have elapsed since the last report.
+        HAPPlatformClockAdvance(3 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 2);
+        HAPAssert(line.debounceTimer);
+
+        HAPPlatformClockAdvance(15 * HAPMillisecond);
+        HAPAssert(numEdges == 3);
+        HAPAssert(edges[2].value && edges[2].timestamp == GetTimestamp(pressTime + 40 * HAPMillisecond));
+        HAPAssert(HAPPlatformGPIOLineGetValue(&line));
+        HAPAssert(!line.debounceTimer);
+    }
+
+    // Releasing the line with a pending edge disarms the timer.
+    {
+        numEdges = 0;
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_FallingEdge);
+        DispatchEvents();
+        HAPAssert(numEdges == 1);
+        HAPPlatformClockAdvance(1 * HAPMillisecond);
+        WriteEvent(kHAPPlatformGPIOInputEvent_RisingEdge);
+        DispatchEvents();
+        HAPAssert(line.debounceTimer);
+
+        HAPPlatformGPIOLineRelease(&line);
+        HAPAssert(!fileHandle.isRegistered);
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        HAPAssert(numEdges == 1);
+    }
+
+    (void) close(fakeFileDescriptor);
+
+    return 0;
+}
@@ -0,0 +1,260 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformMDNSResponder.h"
+
+/**
+ * Packet that has been sent by the responder.
+ */
+typedef struct {
+    uint8_t bytes[kHAPPlatformMDNSResponder_MaxPacketBytes];
+    size_t numBytes;
+    HAPTime time;
+} Packet;
+
+static Packet packets[32];
+static size_t numPackets;
+
+static void SendPacket(
+        HAPPlatformMDNSResponder* responder,
+        const void* bytes,
+        size_t numBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(responder);
+    HAPPrecondition(bytes);
+    HAPAssert(numPackets < HAPArrayCount(packets));
+    HAPAssert(numBytes <= sizeof packets[numPackets].bytes);
+
+    HAPRawBufferCopyBytes(packets[numPackets].bytes, bytes, numBytes);
+    packets[numPackets].numBytes = numBytes;
+    packets[numPackets].time = HAPPlatformClockGetCurrent();
+    numPackets++;
+}
+
+static uint16_t GetFlags(const Packet* packet) {
+    return HAPReadBigUInt16(&packet->bytes[2]);
+}
+
+static uint16_t GetCount(const Packet* packet, size_t section) {
+    return HAPReadBigUInt16(&packet->bytes[4 + 2 * section]);
+}
+
+/**
+ * Determines whether a packet contains a byte sequence.
+ */
+static bool PacketContains(const Packet* packet, const void* bytes, size_t numBytes) {
+    for (size_t i = 0; i + numBytes <= packet->numBytes; i++) {
+        if (HAPRawBufferAreEqual(&packet->bytes[i], bytes, numBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Appends an uncompressed name, e.g. "Acme Test|_hap|_tcp|local". Labels are separated by '|'.
+ */
+static void AppendName(uint8_t* bytes, size_t* numBytes, const char* name) {
+    const char* label = name;
+    for (const char* c = name;; c++) {
+        if (*c == '|' || !*c) {
+            bytes[(*numBytes)++] = (uint8_t)(c - label);
+            HAPRawBufferCopyBytes(&bytes[*numBytes], label, (size_t)(c - label));
+            *numBytes += (size_t)(c - label);
+            if (!*c) {
+                break;
+            }
+            label = c + 1;
+        }
+    }
+    bytes[(*numBytes)++] = 0;
+}
+
+/**
+ * Sends a query with a single question to the responder.
+ */
+static void Query(HAPPlatformMDNSResponder* responder, const char* name, uint16_t type) {
+    uint8_t bytes[256] = { 0 };
+    size_t numBytes = 12;
+    HAPWriteBigUInt16(&bytes[4], 1);
+    AppendName(bytes, &numBytes, name);
+    HAPWriteBigUInt16(&bytes[numBytes], type);
+    HAPWriteBigUInt16(&bytes[numBytes + 2], 1);
+    numBytes += 4;
+    HAPPlatformMDNSResponderHandlePacket(responder, bytes, numBytes);
+}
+
+/**
+ * Advances time until the responder announces the service.
+ *
+ * @return Time from the start until the service has been announced first.
+ */
+static HAPTime WaitForAnnouncement(HAPPlatformMDNSResponder* responder) {
+    HAPTime startTime = HAPPlatformClockGetCurrent();
+    size_t firstPacket = numPackets;
+    while (HAPPlatformMDNSResponderGetState(responder) == kHAPPlatformMDNSResponderState_Probing) {
+        HAPAssert(HAPPlatformClockGetCurrent() - startTime < 2 * HAPSecond);
+        HAPPlatformClockAdvance(HAPMillisecond);
+    }
+
+    // Three probes at least 250 ms apart, followed by an announcement.
+    HAPAssert(numPackets == firstPacket + 4);
+    for (size_t i = firstPacket; i < firstPacket + 3; i++) {
+        HAPAssert(GetFlags(&packets[i]) == 0);
+        HAPAssert(GetCount(&packets[i], 0) == 2);
+        HAPAssert(GetCount(&packets[i], 2) == 4);
+        HAPAssert(packets[i + 1].time - packets[i].time >= 250 * HAPMillisecond);
+    }
+    HAPAssert(GetFlags(&packets[firstPacket + 3]) == 0x8400);
+    return packets[firstPacket + 3].time - startTime;
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    static const HAPPlatformMDNSResponderAddress addresses[] = {
+        { .version = kHAPIPAddressVersion_IPv4, .bytes = { 192, 168, 1, 10 } },
+        { .version = kHAPIPAddressVersion_IPv6, .bytes = { 0xFE, 0x80, [15] = 0x01 } }
+    };
+    static HAPPlatformMDNSResponder responder;
+    HAPPlatformMDNSResponderCreate(
+            &responder,
+            &(const HAPPlatformMDNSResponderOptions) { .hostName = "acme",
+                                                       .addresses = addresses,
+                                                       .numAddresses = HAPArrayCount(addresses),
+                                                       .sendPacket = SendPacket });
+
+    // Register service. Nothing is sent before probing.
+    HAPPlatformServiceDiscoveryTXTRecord txtRecords[] = {
+        { .key = "c#", .value = { .bytes = "1", .numBytes = 1 } },
+        { .key = "sf", .value = { .bytes = "1", .numBytes = 1 } },
+    };
+    HAPPlatformMDNSResponderRegister(
+            &responder, "Acme Test", "_hap._tcp", 1234, txtRecords, HAPArrayCount(txtRecords));
+    HAPAssert(!numPackets);
+    HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Probing);
+
+    // Service becomes discoverable within one second.
+    HAPTime latency = WaitForAnnouncement(&responder);
+    HAPLog(&kHAPLog_Default, "Startup to discoverable: %llu ms.", (unsigned long long) latency);
+    HAPAssert(latency <= 1 * HAPSecond);
+    {
+        const Packet* packet = &packets[numPackets - 1];
+        HAPAssert(GetCount(packet, 1) == 6);
+        HAPAssert(PacketContains(packet, "\x04_hap\x04_tcp\x05local", 17));
+        HAPAssert(PacketContains(packet, "\x09" "Acme Test\xC0", 11));
+        HAPAssert(PacketContains(packet, "\x04" "acme\xC0", 6));
+        HAPAssert(PacketContains(packet, (const uint8_t[]) { 0, 0, 0, 0, HAPExpandBigUInt16(1234) }, 6));
+        HAPAssert(PacketContains(packet, (const uint8_t[]) { 192, 168, 1, 10 }, 4));
+        static const char txt[] = "\x00\x0A\x04" "c#=1\x04" "sf=1";
+        HAPAssert(HAPRawBufferAreEqual(&packet->bytes[packet->numBytes - 12], txt, 12));
+    }
+
+    // Second announcement one second later.
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    HAPAssert(numPackets == 5);
+    HAPAssert(HAPRawBufferAreEqual(packets[4].bytes, packets[3].bytes, packets[3].numBytes));
+    HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Announced);
+
+    // Own announcements that are looped back are not a conflict.
+    HAPPlatformMDNSResponderHandlePacket(&responder, packets[4].bytes, packets[4].numBytes);
+    HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Announced);
+
+    // Queries are answered. Names are case insensitive.
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Query(&responder, "_hap|_tcp|local", /* PTR: */ 12);
+    HAPAssert(numPackets == 6);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Query(&responder, "ACME TEST|_HAP|_TCP|LOCAL", /* SRV: */ 33);
+    HAPAssert(numPackets == 7);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Query(&responder, "acme|local", /* A: */ 1);
+    HAPAssert(numPackets == 8);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Query(&responder, "_airplay|_tcp|local", /* PTR: */ 12);
+    Query(&responder, "Acme Test|_hap|_tcp|local", /* A: */ 1);
+    HAPAssert(numPackets == 8);
+
+    // Responses are rate limited to one per second.
+    Query(&responder, "_hap|_tcp|local", /* PTR: */ 12);
+    HAPAssert(numPackets == 9);
+    Query(&responder, "_hap|_tcp|local", /* PTR: */ 12);
+    Query(&responder, "_hap|_tcp|local", /* PTR: */ 12);
+    HAPAssert(numPackets == 9);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    HAPAssert(numPackets == 10);
+    HAPAssert(packets[9].time == packets[8].time + 1 * HAPSecond);
+
+    // TXT record updates patch the response in place and are announced immediately.
+    {
+        txtRecords[0].value.bytes = "12";
+        txtRecords[0].value.numBytes = 2;
+        HAPPlatformMDNSResponderUpdateTXTRecords(&responder, txtRecords, HAPArrayCount(txtRecords));
+        HAPAssert(numPackets == 11);
+        const Packet* oldPacket = &packets[9];
+        const Packet* packet = &packets[10];
+        HAPAssert(packet->numBytes == oldPacket->numBytes + 1);
+        HAPAssert(HAPRawBufferAreEqual(packet->bytes, oldPacket->bytes, oldPacket->numBytes - 12));
+        static const char txt[] = "\x00\x0B\x05" "c#=12\x04" "sf=1";
+        HAPAssert(HAPRawBufferAreEqual(&packet->bytes[packet->numBytes - 13], txt, 13));
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        HAPAssert(numPackets == 12);
+        HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Announced);
+    }
+
+    // Another host claims the service name. A new name is probed and announced.
+    {
+        uint8_t bytes[256] = { 0 };
+        size_t numBytes = 12;
+        HAPWriteBigUInt16(&bytes[2], 0x8400);
+        HAPWriteBigUInt16(&bytes[6], 1);
+        AppendName(bytes, &numBytes, "Acme Test|_hap|_tcp|local");
+        uint8_t record[] = { 0, 33, 0x80, 1, 0, 0, 0, 120, 0, 6 + 13, 0, 0, 0, 0, HAPExpandBigUInt16(4321) };
+        HAPRawBufferCopyBytes(&bytes[numBytes], record, sizeof record);
+        numBytes += sizeof record;
+        AppendName(bytes, &numBytes, "other|local");
+        HAPPlatformMDNSResponderHandlePacket(&responder, bytes, numBytes);
+        HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Probing);
+
+        (void) WaitForAnnouncement(&responder);
+        const Packet* packet = &packets[numPackets - 1];
+        HAPAssert(PacketContains(packet, "\x0D" "Acme Test (2)\xC0", 15));
+        HAPAssert(PacketContains(packet, "\x06" "acme-2\xC0", 8));
+        static const char txt[] = "\x00\x0B\x05" "c#=12\x04" "sf=1";
+        HAPAssert(HAPRawBufferAreEqual(&packet->bytes[packet->numBytes - 13], txt, 13));
+
+        // The new name is answered, the old one is not.
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Announced);
+        HAPPlatformClockAdvance(1 * HAPSecond);
+        size_t numPacketsBefore = numPackets;
+        Query(&responder, "Acme Test|_hap|_tcp|local", /* TXT: */ 16);
+        HAPAssert(numPackets == numPacketsBefore);
+        Query(&responder, "Acme Test (2)|_hap|_tcp|local", /* TXT: */ 16);
+        HAPAssert(numPackets == numPacketsBefore + 1);
+    }
+
+    // Stopping withdraws all records with a TTL of 0.
+    {
+        const Packet* oldPacket = &packets[numPackets - 1];
+        static const uint8_t ttl[] = { HAPExpandBigUInt32(4500) };
+        HAPAssert(PacketContains(oldPacket, ttl, sizeof ttl));
+
+        HAPPlatformMDNSResponderStop(&responder);
+        const Packet* packet = &packets[numPackets - 1];
+        HAPAssert(packet->numBytes == oldPacket->numBytes);
+        HAPAssert(!PacketContains(packet, ttl, sizeof ttl));
+        HAPAssert(HAPPlatformMDNSResponderGetState(&responder) == kHAPPlatformMDNSResponderState_Idle);
+
+        size_t numPacketsBefore = numPackets;
+        HAPPlatformClockAdvance(2 * HAPSecond);
+        Query(&responder, "_hap|_tcp|local", /* PTR: */ 12);
+        HAPAssert(numPackets == numPacketsBefore);
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatform.h"
+#include "HAPPlatformRandomNumberDRBG.h"
+
+#include "Harness/HAPBenchmark.c"
+
+#if HAP_BENCHMARKS_ENABLED && defined(__linux__)
+#include <linux/random.h>
+#include <syscall.h>
+#include <unistd.h>
+#endif
+
+static void FillInChunks(HAPPlatformRandomNumberDRBG* drbg, uint8_t* bytes, size_t numBytes, size_t chunkSize) {
+    for (size_t o = 0; o < numBytes; o += chunkSize) {
+        size_t c = numBytes - o < chunkSize ? numBytes - o : chunkSize;
+        HAPPlatformRandomNumberDRBGFill(drbg, &bytes[o], c);
+    }
+}
+
+static void TestKnownAnswer(void) {
+    // With an all-zero seed the key is all-zero. The first 32 bytes of block 0 become the next key,
+    // so output starts in the middle of block 0 and continues with block 1.
+    // See RFC 8439, Appendix A.1, Test Vectors #1 and #2.
+    static const uint8_t expectedBytes[] = {
+        0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37,
+        0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+        0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d,
+        0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3, 0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed,
+        0x29, 0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0, 0x74, 0xd8, 0x39, 0xd5,
+        0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb, 0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f,
+    };
+    static const uint8_t seed[kHAPPlatformRandomNumberDRBG_SeedBytes];
+
+    HAPPlatformRandomNumberDRBG drbg;
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+    HAPAssert(HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    HAPAssert(!HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+
+    uint8_t bytes[sizeof expectedBytes];
+    HAPPlatformRandomNumberDRBGFill(&drbg, bytes, sizeof bytes);
+    HAPAssert(HAPRawBufferAreEqual(bytes, expectedBytes, sizeof expectedBytes));
+}
+
+static void TestChunking(void) {
+    // Output does not depend on how requests are split, including across keystream buffers.
+    static const uint8_t seed[kHAPPlatformRandomNumberDRBG_SeedBytes] = { 0x01, 0x02, 0x03 };
+    static uint8_t expectedBytes[4 * kHAPPlatformRandomNumberDRBG_BufferBytes];
+    static uint8_t bytes[sizeof expectedBytes];
+
+    HAPPlatformRandomNumberDRBG drbg;
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    HAPPlatformRandomNumberDRBGFill(&drbg, expectedBytes, sizeof expectedBytes);
+    HAPAssert(!HAPRawBufferIsZero(expectedBytes, sizeof expectedBytes));
+
+    static const size_t chunkSizes[] = { 1, 16, 33, 384, 479, 480, 481 };
+    for (size_t i = 0; i < HAPArrayCount(chunkSizes); i++) {
+        HAPPlatformRandomNumberDRBGCreate(&drbg);
+        HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+        HAPRawBufferZero(bytes, sizeof bytes);
+        FillInChunks(&drbg, bytes, sizeof bytes, chunkSizes[i]);
+        HAPAssert(HAPRawBufferAreEqual(bytes, expectedBytes, sizeof expectedBytes));
+    }
+}
+
+static void TestReseed(void) {
+    static const uint8_t seed[kHAPPlatformRandomNumberDRBG_SeedBytes] = { 0x01 };
+    uint8_t bytes[2][64];
+
+    // Reseeding with the same seed does not repeat earlier output.
+    HAPPlatformRandomNumberDRBG drbg;
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    HAPPlatformRandomNumberDRBGFill(&drbg, bytes[0], sizeof bytes[0]);
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    HAPPlatformRandomNumberDRBGFill(&drbg, bytes[1], sizeof bytes[1]);
+    HAPAssert(!HAPRawBufferAreEqual(bytes[0], bytes[1], sizeof bytes[0]));
+
+    // A reseed is required once the reseed interval has been reached.
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    static uint8_t largeBytes[64 * 1024];
+    for (size_t n = 0; n < kHAPPlatformRandomNumberDRBG_ReseedIntervalBytes; n += sizeof largeBytes) {
+        HAPAssert(!HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+        HAPPlatformRandomNumberDRBGFill(&drbg, largeBytes, sizeof largeBytes);
+    }
+    HAPAssert(HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+    HAPAssert(!HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+
+    // After invalidation (e.g., in a forked child) the state is wiped and a reseed is required.
+    HAPPlatformRandomNumberDRBGInvalidate(&drbg);
+    HAPAssert(HAPPlatformRandomNumberDRBGNeedsReseed(&drbg));
+    HAPAssert(HAPRawBufferIsZero(&drbg, sizeof drbg));
+}
+
+#if HAP_BENCHMARKS_ENABLED
+
+static volatile uint8_t benchmarkSink;
+
+static void RunBenchmarks(void) {
+    static const uint8_t seed[kHAPPlatformRandomNumberDRBG_SeedBytes] = { 0x01 };
+    static const size_t sizes[] = { 16, 32, 64, 128, 256, 384 };
+    uint8_t bytes[384];
+
+    HAPPlatformRandomNumberDRBG drbg;
+    HAPPlatformRandomNumberDRBGCreate(&drbg);
+    HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+
+    for (size_t i = 0; i < HAPArrayCount(sizes); i++) {
+        size_t numBytes = sizes[i];
+        HAPLog(&benchmarkLogObject, "Request size: %zu bytes.", numBytes);
+
+#if defined(__linux__)
+        HAP_BENCHMARK("getrandom", 100000, {
+            for (size_t o = 0; o < numBytes;) {
+                size_t c = numBytes - o > 256 ? 256 : numBytes - o;
+                ssize_t n = syscall(SYS_getrandom, &bytes[o], c, GRND_NONBLOCK);
+                HAPAssert(n > 0);
+                o += (size_t) n;
+            }
+            benchmarkSink = bytes[0];
+        });
+#endif
+        HAP_BENCHMARK("HAPPlatformRandomNumberDRBGFill", 1000000, {
+            if (HAPPlatformRandomNumberDRBGNeedsReseed(&drbg)) {
+                HAPPlatformRandomNumberDRBGReseed(&drbg, seed);
+            }
+            HAPPlatformRandomNumberDRBGFill(&drbg, bytes, numBytes);
+            benchmarkSink = bytes[0];
+        });
+    }
+}
+
+#endif
+
+int main() {
+    TestKnownAnswer();
+    TestChunking();
+    TestReseed();
+
+#if HAP_BENCHMARKS_ENABLED
+    RunBenchmarks();
+#endif
+
+    return 0;
+}
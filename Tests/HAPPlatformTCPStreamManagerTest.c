@@ -0,0 +1,320 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// accept4 is a GNU extension.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HAP.h"
+
+// Reconnect storms are driven through the POSIX TCP stream manager over loopback.
+#include "../PAL/POSIX/HAPPlatformTCPStreamManager.c"
+
+#include "Harness/HAPBenchmark.c"
+
+/** Maximum number of concurrent TCP streams. */
+#define kMaxTCPStreams ((size_t) 16)
+
+/** Number of reconnect storms. */
+#define kNumStorms ((size_t) 32)
+
+/**
+ * Registered file handles.
+ *
+ * - The Mock PAL has no run loop. RunLoopIteration polls the registered file descriptors and invokes the callbacks.
+ */
+static struct {
+    bool isRegistered;
+    int fileDescriptor;
+    HAPPlatformFileHandleEvent interests;
+    HAPPlatformFileHandleCallback callback;
+    void* _Nullable context;
+} fileHandles[2 * kMaxTCPStreams];
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformFileHandleRegister(
+        HAPPlatformFileHandleRef* fileHandle,
+        int fileDescriptor,
+        HAPPlatformFileHandleEvent interests,
+        HAPPlatformFileHandleCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(fileHandle);
+    HAPPrecondition(fileDescriptor >= 0);
+    HAPPrecondition(callback);
+
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        if (!fileHandles[i].isRegistered) {
+            fileHandles[i].isRegistered = true;
+            fileHandles[i].fileDescriptor = fileDescriptor;
+            fileHandles[i].interests = interests;
+            fileHandles[i].callback = callback;
+            fileHandles[i].context = context;
+            *fileHandle = (HAPPlatformFileHandleRef) i + 1;
+            return kHAPError_None;
+        }
+    }
+    return kHAPError_OutOfResources;
+}
+
+void HAPPlatformFileHandleUpdateInterests(
+        HAPPlatformFileHandleRef fileHandle,
+        HAPPlatformFileHandleEvent interests,
+        HAPPlatformFileHandleCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(fileHandle && fileHandle <= HAPArrayCount(fileHandles));
+    HAPPrecondition(fileHandles[fileHandle - 1].isRegistered);
+    HAPPrecondition(callback);
+
+    fileHandles[fileHandle - 1].interests = interests;
+    fileHandles[fileHandle - 1].callback = callback;
+    fileHandles[fileHandle - 1].context = context;
+}
+
+void HAPPlatformFileHandleDeregister(HAPPlatformFileHandleRef fileHandle) {
+    HAPPrecondition(fileHandle && fileHandle <= HAPArrayCount(fileHandles));
+    HAPPrecondition(fileHandles[fileHandle - 1].isRegistered);
+
+    HAPRawBufferZero(&fileHandles[fileHandle - 1], sizeof fileHandles[fileHandle - 1]);
+}
+
+void HAPPlatformLogPOSIXError(
+        HAPLogType type,
+        const char* message,
+        int errorNumber,
+        const char* function,
+        const char* file,
+        int line) {
+    HAPLogWithType(&kHAPLog_Default, type, "%s:%d - %s @ %s: %d.", file, line, message, function, errorNumber);
+}
+
+/**
+ * Waits until a registered file descriptor is ready and invokes the callbacks of all ready file handles.
+ */
+static void RunLoopIteration(void) {
+    struct pollfd fds[HAPArrayCount(fileHandles)];
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        fds[i].fd = -1;
+        fds[i].events = 0;
+        fds[i].revents = 0;
+        if (fileHandles[i].isRegistered) {
+            fds[i].fd = fileHandles[i].fileDescriptor;
+            fds[i].events = (short) ((fileHandles[i].interests.isReadyForReading ? POLLIN : 0) |
+                                     (fileHandles[i].interests.isReadyForWriting ? POLLOUT : 0));
+        }
+    }
+    int n = poll(fds, HAPArrayCount(fds), /* timeout: */ 1000);
+    HAPAssert(n > 0);
+
+    for (size_t i = 0; i < HAPArrayCount(fileHandles); i++) {
+        // Callbacks may deregister file handles.
+        if (!fds[i].revents || !fileHandles[i].isRegistered || fileHandles[i].fileDescriptor != fds[i].fd) {
+            continue;
+        }
+        fileHandles[i].callback(
+                (HAPPlatformFileHandleRef) i + 1,
+                (HAPPlatformFileHandleEvent) { .isReadyForReading = (fds[i].revents & POLLIN) != 0,
+                                               .isReadyForWriting = (fds[i].revents & POLLOUT) != 0,
+                                               .hasErrorConditionPending = false },
+                fileHandles[i].context);
+    }
+}
+
+/**
+ * Accepted TCP streams.
+ */
+static struct {
+    HAPPlatformTCPStreamRef tcpStreams[kMaxTCPStreams];
+    size_t numTCPStreams;
+
+    /** Number of times that the listener callback has been invoked. */
+    size_t numCallbacks;
+
+    /** Number of times that no TCP stream could be accepted because the accept queue was empty. */
+    size_t numBusy;
+} server;
+
+static void HandleAcceptedTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManager, void* _Nullable context) {
+    HAPPrecondition(tcpStreamManager);
+    HAPPrecondition(context == &server);
+
+    server.numCallbacks++;
+
+    HAPPlatformTCPStreamRef tcpStream;
+    HAPError err = HAPPlatformTCPStreamManagerAcceptTCPStream(tcpStreamManager, &tcpStream);
+    if (err) {
+        HAPAssert(err == kHAPError_Busy);
+        server.numBusy++;
+        return;
+    }
+    HAPAssert(server.numTCPStreams < HAPArrayCount(server.tcpStreams));
+    server.tcpStreams[server.numTCPStreams++] = tcpStream;
+}
+
+/**
+ * Connected client sockets.
+ */
+static struct {
+    int fileDescriptors[2 * kMaxTCPStreams];
+    size_t numFileDescriptors;
+} clients;
+
+/**
+ * Connects clients to the listener over loopback.
+ *
+ * - Once connect returns, the connection is queued on the listener socket.
+ */
+static void ConnectClients(HAPNetworkPort port, size_t numClients) {
+    HAPPrecondition(clients.numFileDescriptors + numClients <= HAPArrayCount(clients.fileDescriptors));
+
+    struct sockaddr_in6 sin6;
+    HAPRawBufferZero(&sin6, sizeof sin6);
+    sin6.sin6_family = AF_INET6;
+    sin6.sin6_port = htons(port);
+    sin6.sin6_addr = in6addr_loopback;
+
+    for (size_t i = 0; i < numClients; i++) {
+        int fileDescriptor = socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+        HAPAssert(fileDescriptor != -1);
+        int e = connect(fileDescriptor, (struct sockaddr*) &sin6, sizeof sin6);
+        HAPAssert(!e);
+        clients.fileDescriptors[clients.numFileDescriptors++] = fileDescriptor;
+    }
+}
+
+/**
+ * Closes all accepted TCP streams and all clients.
+ */
+static void DisconnectClients(HAPPlatformTCPStreamManagerRef tcpStreamManager) {
+    for (size_t i = 0; i < server.numTCPStreams; i++) {
+        HAPPlatformTCPStreamClose(tcpStreamManager, server.tcpStreams[i]);
+    }
+    server.numTCPStreams = 0;
+    for (size_t i = 0; i < clients.numFileDescriptors; i++) {
+        (void) close(clients.fileDescriptors[i]);
+    }
+    clients.numFileDescriptors = 0;
+}
+
+/**
+ * Returns whether the listener is waiting for connections.
+ */
+static bool IsListenerReadyForReading(HAPPlatformTCPStreamManagerRef tcpStreamManager) {
+    HAPPlatformFileHandleRef fileHandle = tcpStreamManager->tcpStreamListener.fileHandle;
+    HAPAssert(fileHandle && fileHandles[fileHandle - 1].isRegistered);
+    return fileHandles[fileHandle - 1].interests.isReadyForReading;
+}
+
+int main() {
+    HAPError err;
+
+    static HAPPlatformTCPStreamManager tcpStreamManager;
+    HAPPlatformTCPStreamManagerCreate(
+            &tcpStreamManager,
+            &(const HAPPlatformTCPStreamManagerOptions) { .interfaceName = NULL,
+                                                          .port = kHAPNetworkPort_Any,
+                                                          .maxConcurrentTCPStreams = kMaxTCPStreams });
+    HAPPlatformTCPStreamManagerOpenListener(&tcpStreamManager, HandleAcceptedTCPStream, &server);
+    HAPNetworkPort port = HAPPlatformTCPStreamManagerGetListenerPort(&tcpStreamManager);
+    HAPAssert(port);
+
+    // Without pending connections, accept fails with EAGAIN.
+    {
+        HAPPlatformTCPStreamRef tcpStream;
+        err = HAPPlatformTCPStreamManagerAcceptTCPStream(&tcpStreamManager, &tcpStream);
+        HAPAssert(err == kHAPError_Busy);
+        HAPAssert(!tcpStream);
+    }
+
+    // A burst of connections is accepted in a single wakeup. The drain stops when accept fails with EAGAIN.
+    {
+        ConnectClients(port, kMaxTCPStreams / 2);
+        RunLoopIteration();
+        HAPAssert(server.numTCPStreams == kMaxTCPStreams / 2);
+        HAPAssert(server.numCallbacks == kMaxTCPStreams / 2 + 1);
+        HAPAssert(server.numBusy == 1);
+
+        // Accepted TCP streams are connected to the clients.
+        for (size_t i = 0; i < clients.numFileDescriptors; i++) {
+            ssize_t n = send(clients.fileDescriptors[i], "x", 1, 0);
+            HAPAssert(n == 1);
+        }
+        for (size_t i = 0; i < server.numTCPStreams; i++) {
+            char byte;
+            size_t numBytes;
+            err = HAPPlatformTCPStreamRead(&tcpStreamManager, server.tcpStreams[i], &byte, sizeof byte, &numBytes);
+            HAPAssert(!err);
+            HAPAssert(numBytes == 1 && byte == 'x');
+        }
+    }
+
+    // A burst that exceeds the capacity is accepted until the capacity is reached. The remaining connections stay
+    // queued on the listener socket until TCP streams are closed.
+    {
+        server.numCallbacks = 0;
+        server.numBusy = 0;
+        ConnectClients(port, kMaxTCPStreams);
+        RunLoopIteration();
+        HAPAssert(server.numTCPStreams == kMaxTCPStreams);
+        HAPAssert(server.numCallbacks == kMaxTCPStreams / 2);
+        HAPAssert(server.numBusy == 0);
+        HAPAssert(!IsListenerReadyForReading(&tcpStreamManager));
+
+        server.numTCPStreams--;
+        HAPPlatformTCPStreamClose(&tcpStreamManager, server.tcpStreams[server.numTCPStreams]);
+        HAPAssert(IsListenerReadyForReading(&tcpStreamManager));
+        RunLoopIteration();
+        HAPAssert(server.numTCPStreams == kMaxTCPStreams);
+        HAPAssert(!IsListenerReadyForReading(&tcpStreamManager));
+
+        DisconnectClients(&tcpStreamManager);
+        HAPAssert(IsListenerReadyForReading(&tcpStreamManager));
+
+        // Connections that are still queued are accepted even though their clients have closed.
+        RunLoopIteration();
+        DisconnectClients(&tcpStreamManager);
+    }
+
+    // Reconnect storms: all clients disconnect and reconnect at once.
+    for (size_t i = 0; i < kNumStorms; i++) {
+        server.numCallbacks = 0;
+        server.numBusy = 0;
+        ConnectClients(port, kMaxTCPStreams - 1);
+        RunLoopIteration();
+        HAPAssert(server.numTCPStreams == kMaxTCPStreams - 1);
+        HAPAssert(server.numCallbacks == kMaxTCPStreams);
+        HAPAssert(server.numBusy == 1);
+        DisconnectClients(&tcpStreamManager);
+    }
+    HAPAssert(tcpStreamManager.numTCPStreams == 0);
+
+#if HAP_BENCHMARKS_ENABLED
+    {
+        uint64_t numIterations = 1000;
+        uint64_t numNanoseconds = 0;
+        for (uint64_t i = 0; i < numIterations; i++) {
+            ConnectClients(port, kMaxTCPStreams - 1);
+            uint64_t start = HAPBenchmarkGetNanoseconds();
+            RunLoopIteration();
+            numNanoseconds += HAPBenchmarkGetNanoseconds() - start;
+            HAPAssert(server.numTCPStreams == kMaxTCPStreams - 1);
+            DisconnectClients(&tcpStreamManager);
+        }
+        HAPBenchmarkLogResult("Loopback reconnect storm of 15 clients", numIterations, numNanoseconds);
+    }
+#endif
+
+    HAPPlatformTCPStreamManagerCloseListener(&tcpStreamManager);
+    HAPPlatformTCPStreamManagerRelease(&tcpStreamManager);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatform.h"
+
+#include "Harness/HAPBenchmark.c"
+
+#define kTestBufferBytes ((size_t) 4096)
+
+static uint8_t testBytes[kTestBufferBytes];
+static uint8_t otherTestBytes[kTestBufferBytes];
+
+static void FillPattern(uint8_t* bytes, size_t numBytes, uint8_t seed) {
+    for (size_t i = 0; i < numBytes; i++) {
+        bytes[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+static void TestCopy(size_t destinationOffset, size_t sourceOffset, size_t numBytes) {
+    uint8_t expectedBytes[kTestBufferBytes];
+    FillPattern(testBytes, sizeof testBytes, 1);
+    FillPattern(expectedBytes, sizeof expectedBytes, 1);
+
+    // Reference: byte-wise copy through a temporary buffer.
+    uint8_t temporaryBytes[kTestBufferBytes];
+    for (size_t i = 0; i < numBytes; i++) {
+        temporaryBytes[i] = expectedBytes[sourceOffset + i];
+    }
+    for (size_t i = 0; i < numBytes; i++) {
+        expectedBytes[destinationOffset + i] = temporaryBytes[i];
+    }
+
+    HAPRawBufferCopyBytes(&testBytes[destinationOffset], &testBytes[sourceOffset], numBytes);
+    for (size_t i = 0; i < sizeof testBytes; i++) {
+        HAPAssert(testBytes[i] == expectedBytes[i]);
+    }
+}
+
+#if HAP_BENCHMARKS_ENABLED
+
+static volatile uint8_t benchmarkSink;
+
+// Previous byte-by-byte implementations, used as baseline.
+static void CopyBytesBytewise(void* destinationBytes, const void* sourceBytes, size_t numBytes) {
+    volatile uint8_t* destination = destinationBytes;
+    const uint8_t* source = sourceBytes;
+    for (size_t i = 0; i < numBytes; i++) {
+        destination[i] = source[i];
+    }
+}
+
+static void ZeroBytewise(void* bytes, size_t numBytes) {
+    volatile uint8_t* b = bytes;
+    for (size_t i = 0; i < numBytes; i++) {
+        b[i] = 0;
+    }
+}
+
+static void RunBenchmarks(void) {
+    static const size_t sizes[] = { 16, 256, 4096 };
+    for (size_t i = 0; i < HAPArrayCount(sizes); i++) {
+        size_t numBytes = sizes[i];
+        uint64_t numIterations = 100000000 / numBytes;
+        HAPLog(&benchmarkLogObject, "Buffer size: %zu bytes.", numBytes);
+
+        FillPattern(testBytes, numBytes, 3);
+        FillPattern(otherTestBytes, numBytes, 3);
+
+        HAP_BENCHMARK("CopyBytes (bytewise)", numIterations, {
+            CopyBytesBytewise(otherTestBytes, testBytes, numBytes);
+            benchmarkSink = otherTestBytes[numBytes - 1];
+        });
+        HAP_BENCHMARK("HAPRawBufferCopyBytes", numIterations, {
+            HAPRawBufferCopyBytes(otherTestBytes, testBytes, numBytes);
+            benchmarkSink = otherTestBytes[numBytes - 1];
+        });
+        HAP_BENCHMARK("HAPRawBufferCopyBytes (overlapping)", numIterations, {
+            HAPRawBufferCopyBytes(&testBytes[1], &testBytes[0], numBytes - 1);
+            benchmarkSink = testBytes[numBytes - 1];
+        });
+        HAP_BENCHMARK("Zero (bytewise)", numIterations, {
+            ZeroBytewise(otherTestBytes, numBytes);
+            benchmarkSink = otherTestBytes[numBytes - 1];
+        });
+        HAP_BENCHMARK("HAPRawBufferZero", numIterations, {
+            HAPRawBufferZero(otherTestBytes, numBytes);
+            benchmarkSink = otherTestBytes[numBytes - 1];
+        });
+
+        FillPattern(testBytes, numBytes, 3);
+        FillPattern(otherTestBytes, numBytes, 3);
+        HAP_BENCHMARK("HAPRawBufferAreEqualConstantTime", numIterations, {
+            benchmarkSink = HAPRawBufferAreEqualConstantTime(testBytes, otherTestBytes, numBytes);
+        });
+        HAP_BENCHMARK("HAPRawBufferAreEqual", numIterations, {
+            benchmarkSink = HAPRawBufferAreEqual(testBytes, otherTestBytes, numBytes);
+        });
+    }
+}
+
+#endif
+
+int main() {
+    // Non-overlapping and overlapping copies in both directions.
+    TestCopy(0, 0, 0);
+    TestCopy(0, 2048, 2048);
+    TestCopy(2048, 0, 2048);
+    TestCopy(0, 1, 4095);
+    TestCopy(1, 0, 4095);
+    TestCopy(3, 100, 1000);
+    TestCopy(100, 3, 1000);
+    TestCopy(5, 5, 100);
+
+    // Zero.
+    FillPattern(testBytes, sizeof testBytes, 1);
+    HAPRawBufferZero(&testBytes[1], sizeof testBytes - 2);
+    HAPAssert(testBytes[0] == 1);
+    HAPAssert(HAPRawBufferIsZero(&testBytes[1], sizeof testBytes - 2));
+    HAPAssert(testBytes[sizeof testBytes - 1] != 0);
+    HAPAssert(!HAPRawBufferIsZero(testBytes, sizeof testBytes));
+    HAPRawBufferZero(testBytes, 0);
+    HAPAssert(testBytes[0] == 1);
+
+    // Equality.
+    FillPattern(testBytes, sizeof testBytes, 9);
+    FillPattern(otherTestBytes, sizeof otherTestBytes, 9);
+    HAPAssert(HAPRawBufferAreEqual(testBytes, otherTestBytes, sizeof testBytes));
+    HAPAssert(HAPRawBufferAreEqualConstantTime(testBytes, otherTestBytes, sizeof testBytes));
+    HAPAssert(HAPRawBufferAreEqual(testBytes, &otherTestBytes[1], 0));
+    HAPAssert(HAPRawBufferAreEqualConstantTime(testBytes, &otherTestBytes[1], 0));
+    for (size_t i = 0; i < sizeof testBytes; i += 511) {
+        otherTestBytes[i] ^= 0x80;
+        HAPAssert(!HAPRawBufferAreEqual(testBytes, otherTestBytes, sizeof testBytes));
+        HAPAssert(!HAPRawBufferAreEqualConstantTime(testBytes, otherTestBytes, sizeof testBytes));
+        HAPAssert(HAPRawBufferAreEqual(testBytes, otherTestBytes, i));
+        HAPAssert(HAPRawBufferAreEqualConstantTime(testBytes, otherTestBytes, i));
+        otherTestBytes[i] ^= 0x80;
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    RunBenchmarks();
+#endif
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+#include "Harness/HAPBenchmark.c"
+
+#define kTestBufferBytes ((size_t) 8192)
+
+static uint8_t tlvBytes[kTestBufferBytes];
+static uint8_t readerBytes[kTestBufferBytes];
+static uint8_t scratchBytes[kTestBufferBytes];
+
+static void FillPattern(uint8_t* bytes, size_t numBytes, uint8_t seed) {
+    for (size_t i = 0; i < numBytes; i++) {
+        bytes[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+/**
+ * Serializes TLV items with the given value lengths. Consecutive items have alternating types.
+ *
+ * @return Length of serialized TLV data.
+ */
+static size_t Serialize(const size_t* numValueBytes, size_t numItems) {
+    uint8_t valueBytes[kTestBufferBytes];
+
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, tlvBytes, sizeof tlvBytes);
+    for (size_t i = 0; i < numItems; i++) {
+        FillPattern(valueBytes, numValueBytes[i], (uint8_t) i);
+        HAPError err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = (HAPTLVType)(1 + i % 2),
+                                  .value = { .bytes = valueBytes, .numBytes = numValueBytes[i] } });
+        HAPAssert(!err);
+    }
+    void* bytes;
+    size_t numBytes;
+    HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+    return numBytes;
+}
+
+/**
+ * Checks that the read-only reader produces the same TLV items as the in-place reader.
+ */
+static void CheckEquivalence(size_t numBytes) {
+    HAPError err;
+
+    HAPRawBufferCopyBytes(readerBytes, tlvBytes, numBytes);
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, readerBytes, numBytes);
+
+    HAPTLVFragmentReader fragmentReader;
+    HAPTLVFragmentReaderCreate(&fragmentReader, tlvBytes, numBytes);
+
+    for (;;) {
+        bool found;
+        HAPTLV tlv;
+        HAPError expectedErr = HAPTLVReaderGetNext(&reader, &found, &tlv);
+        if (expectedErr) {
+            HAPAssert(expectedErr == kHAPError_InvalidData);
+        }
+        bool foundItem;
+        HAPTLVFragmentedItem item;
+        err = HAPTLVFragmentReaderGetNext(&fragmentReader, &foundItem, &item);
+        HAPAssert(err == expectedErr);
+        if (err) {
+            break;
+        }
+        HAPAssert(foundItem == found);
+        if (!found) {
+            break;
+        }
+        HAPAssert(item.type == tlv.type);
+        HAPAssert(item.numValueBytes == tlv.value.numBytes);
+        HAPAssert(item.numFragments == (tlv.value.numBytes ? (tlv.value.numBytes + UINT8_MAX - 1) / UINT8_MAX : 1));
+
+        // Fragments.
+        size_t o = 0;
+        for (size_t i = 0; i < item.numFragments; i++) {
+            const void* fragmentBytes;
+            size_t numFragmentBytes;
+            HAPTLVFragmentedItemGetFragment(&item, i, &fragmentBytes, &numFragmentBytes);
+            HAPAssert(HAPRawBufferAreEqual(fragmentBytes, &((const uint8_t*) tlv.value.bytes)[o], numFragmentBytes));
+            o += numFragmentBytes;
+        }
+        HAPAssert(o == tlv.value.numBytes);
+
+        // Contiguous value.
+        const void* valueBytes;
+        err = HAPTLVFragmentedItemGetBytes(&item, scratchBytes, sizeof scratchBytes, &valueBytes);
+        HAPAssert(!err);
+        HAPAssert(HAPRawBufferAreEqual(valueBytes, HAPNonnull(tlv.value.bytes), tlv.value.numBytes));
+        if (item.numFragments == 1) {
+            HAPAssert(valueBytes == &((const uint8_t*) item.bytes)[2]);
+        } else {
+            HAPAssert(valueBytes == scratchBytes);
+            err = HAPTLVFragmentedItemGetBytes(&item, scratchBytes, item.numValueBytes - 1, &valueBytes);
+            HAPAssert(err == kHAPError_OutOfResources);
+        }
+    }
+}
+
+#if HAP_BENCHMARKS_ENABLED
+
+static volatile uint8_t benchmarkSink;
+
+static void RunBenchmarks(void) {
+    static const size_t sizes[] = { 384, 1024, 4096 };
+    for (size_t i = 0; i < HAPArrayCount(sizes); i++) {
+        // Pair Setup M3 like layout: State, large value, small value.
+        size_t numValueBytes[] = { 1, sizes[i], 64 };
+        size_t numBytes = Serialize(numValueBytes, HAPArrayCount(numValueBytes));
+        uint64_t numIterations = 100000000 / numBytes;
+        HAPLog(&benchmarkLogObject, "Value size: %zu bytes.", sizes[i]);
+
+        HAP_BENCHMARK("HAPTLVReaderGetNext", numIterations, {
+            HAPRawBufferCopyBytes(readerBytes, tlvBytes, numBytes);
+            HAPTLVReaderRef reader;
+            HAPTLVReaderCreate(&reader, readerBytes, numBytes);
+            for (;;) {
+                bool found;
+                HAPTLV tlv;
+                HAPError err = HAPTLVReaderGetNext(&reader, &found, &tlv);
+                HAPAssert(!err);
+                if (!found) {
+                    break;
+                }
+                benchmarkSink = ((const uint8_t*) tlv.value.bytes)[0];
+            }
+        });
+        HAP_BENCHMARK("HAPTLVFragmentReaderGetNext (buffer copy)", numIterations, {
+            HAPRawBufferCopyBytes(readerBytes, tlvBytes, numBytes);
+            HAPTLVFragmentReader reader;
+            HAPTLVFragmentReaderCreate(&reader, readerBytes, numBytes);
+            for (;;) {
+                bool found;
+                HAPTLVFragmentedItem item;
+                HAPError err = HAPTLVFragmentReaderGetNext(&reader, &found, &item);
+                HAPAssert(!err);
+                if (!found) {
+                    break;
+                }
+                const void* fragmentBytes;
+                size_t numFragmentBytes;
+                HAPTLVFragmentedItemGetFragment(&item, 0, &fragmentBytes, &numFragmentBytes);
+                benchmarkSink = ((const uint8_t*) fragmentBytes)[0];
+            }
+        });
+        HAP_BENCHMARK("HAPTLVFragmentReaderGetNext", numIterations, {
+            HAPTLVFragmentReader reader;
+            HAPTLVFragmentReaderCreate(&reader, tlvBytes, numBytes);
+            for (;;) {
+                bool found;
+                HAPTLVFragmentedItem item;
+                HAPError err = HAPTLVFragmentReaderGetNext(&reader, &found, &item);
+                HAPAssert(!err);
+                if (!found) {
+                    break;
+                }
+                const void* fragmentBytes;
+                size_t numFragmentBytes;
+                HAPTLVFragmentedItemGetFragment(&item, 0, &fragmentBytes, &numFragmentBytes);
+                benchmarkSink = ((const uint8_t*) fragmentBytes)[0];
+            }
+        });
+        HAP_BENCHMARK("HAPTLVFragmentReaderGetNext (contiguous)", numIterations, {
+            HAPTLVFragmentReader reader;
+            HAPTLVFragmentReaderCreate(&reader, tlvBytes, numBytes);
+            for (;;) {
+                bool found;
+                HAPTLVFragmentedItem item;
+                HAPError err = HAPTLVFragmentReaderGetNext(&reader, &found, &item);
+                HAPAssert(!err);
+                if (!found) {
+                    break;
+                }
+                const void* valueBytes;
+                err = HAPTLVFragmentedItemGetBytes(&item, scratchBytes, sizeof scratchBytes, &valueBytes);
+                HAPAssert(!err);
+                benchmarkSink = ((const uint8_t*) valueBytes)[0];
+            }
+        });
+    }
+}
+
+#endif
+
+int main() {
+    // Empty buffer.
+    CheckEquivalence(0);
+
+    // Single and multi-fragment items.
+    {
+        static const size_t numValueBytes[] = { 0, 1, 254, 255, 256, 509, 510, 511, 1000, 3 };
+        CheckEquivalence(Serialize(numValueBytes, HAPArrayCount(numValueBytes)));
+    }
+    {
+        static const size_t numValueBytes[] = { 384, 64, 4096 };
+        CheckEquivalence(Serialize(numValueBytes, HAPArrayCount(numValueBytes)));
+    }
+
+    // Malformed data.
+    {
+        static const size_t numValueBytes[] = { 300, 1 };
+        size_t numBytes = Serialize(numValueBytes, HAPArrayCount(numValueBytes));
+
+        // Incomplete header and body.
+        CheckEquivalence(1);
+        CheckEquivalence(100);
+        CheckEquivalence(2 + UINT8_MAX + 1);
+        CheckEquivalence(2 + UINT8_MAX + 10);
+        CheckEquivalence(numBytes - 1);
+
+        // Fragment following a fragment with non-255 byte length.
+        tlvBytes[1] = UINT8_MAX - 1;
+        tlvBytes[2 + UINT8_MAX - 1] = tlvBytes[0];
+        tlvBytes[2 + UINT8_MAX] = 1;
+        CheckEquivalence(2 + UINT8_MAX - 1 + 3);
+
+        // Fragment with 0 length.
+        Serialize(numValueBytes, HAPArrayCount(numValueBytes));
+        tlvBytes[2 + UINT8_MAX + 1] = 0;
+        CheckEquivalence(2 + UINT8_MAX + 2);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    RunBenchmarks();
+#endif
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+#include "Harness/HAPBenchmark.c"
+
+#define kTestBufferBytes ((size_t) 70000)
+
+static uint8_t testBytes[kTestBufferBytes];
+static uint8_t valueBytes[kTestBufferBytes];
+
+static void FillPattern(uint8_t* bytes, size_t numBytes, uint8_t seed) {
+    for (size_t i = 0; i < numBytes; i++) {
+        bytes[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+/**
+ * Checks that a buffer contains a fragmented TLV with the given value.
+ */
+static void CheckFragments(
+        const uint8_t* bytes,
+        size_t numBytes,
+        uint8_t type,
+        const uint8_t* value,
+        size_t numValueBytes) {
+    size_t o = 0;
+    size_t v = 0;
+    do {
+        size_t numFragmentBytes = HAPMin(numValueBytes - v, UINT8_MAX);
+        HAPAssert(o + 2 + numFragmentBytes <= numBytes);
+        HAPAssert(bytes[o] == type);
+        HAPAssert(bytes[o + 1] == numFragmentBytes);
+        HAPAssert(HAPRawBufferAreEqual(&bytes[o + 2], &value[v], numFragmentBytes));
+        o += 2 + numFragmentBytes;
+        v += numFragmentBytes;
+    } while (v < numValueBytes);
+    HAPAssert(o == numBytes);
+}
+
+/**
+ * Appends a TLV whose value is located at the given offset relative to the writer's scratch bytes.
+ */
+static void TestAppendInPlace(size_t numPrefixBytes, size_t valueOffset, size_t numValueBytes) {
+    HAPError err;
+
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+    if (numPrefixBytes) {
+        FillPattern(valueBytes, numPrefixBytes, 5);
+        err = HAPTLVWriterAppend(
+                &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = numPrefixBytes } });
+        HAPAssert(!err);
+    }
+
+    void* scratchBytes;
+    size_t numScratchBytes;
+    HAPTLVWriterGetScratchBytes(&writer, &scratchBytes, &numScratchBytes);
+    HAPAssert(valueOffset + numValueBytes <= numScratchBytes);
+    FillPattern(valueBytes, numValueBytes, 11);
+    HAPRawBufferCopyBytes(&((uint8_t*) scratchBytes)[valueOffset], valueBytes, numValueBytes);
+
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = 2,
+                              .value = { .bytes = &((uint8_t*) scratchBytes)[valueOffset],
+                                         .numBytes = numValueBytes } });
+    HAPAssert(!err);
+
+    void* bytes;
+    size_t numBytes;
+    HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+    HAPAssert(bytes == testBytes);
+    size_t numPrefixTLVBytes = numPrefixBytes ? numPrefixBytes + 2 * ((numPrefixBytes + UINT8_MAX - 1) / UINT8_MAX) : 0;
+    HAPAssert(numBytes >= numPrefixTLVBytes);
+    FillPattern(valueBytes, numPrefixBytes, 5);
+    if (numPrefixBytes) {
+        CheckFragments(testBytes, numPrefixTLVBytes, 1, valueBytes, numPrefixBytes);
+    }
+    FillPattern(valueBytes, numValueBytes, 11);
+    CheckFragments(&testBytes[numPrefixTLVBytes], numBytes - numPrefixTLVBytes, 2, valueBytes, numValueBytes);
+}
+
+#if HAP_BENCHMARKS_ENABLED
+
+static volatile uint8_t benchmarkSink;
+
+// Previous implementation that moves the entire remaining value for every fragment, used as baseline.
+HAP_RESULT_USE_CHECK
+static HAPError AppendQuadratic(HAPTLVWriterRef* writer_, const HAPTLV* tlv) {
+    HAPTLVWriter* writer = (HAPTLVWriter*) writer_;
+    uint8_t* destinationBytes = HAPNonnullVoid(writer->bytes);
+    size_t maxDestinationBytes = writer->maxBytes - writer->numBytes;
+    const uint8_t* _Nullable value = tlv->value.bytes;
+    size_t numValueBytes = tlv->value.numBytes;
+    do {
+        size_t numFragmentBytes = numValueBytes > UINT8_MAX ? UINT8_MAX : numValueBytes;
+        if (maxDestinationBytes < 2) {
+            return kHAPError_OutOfResources;
+        }
+        maxDestinationBytes -= 2;
+        if (value) {
+            if (maxDestinationBytes < numValueBytes) {
+                return kHAPError_OutOfResources;
+            }
+            HAPRawBufferCopyBytes(&destinationBytes[writer->numBytes + 2], HAPNonnull(value), numValueBytes);
+            value = &destinationBytes[writer->numBytes + 2];
+            maxDestinationBytes -= numFragmentBytes;
+            numValueBytes -= numFragmentBytes;
+            value += numFragmentBytes;
+        }
+        destinationBytes[writer->numBytes++] = (uint8_t) tlv->type;
+        destinationBytes[writer->numBytes++] = (uint8_t) numFragmentBytes;
+        writer->numBytes += numFragmentBytes;
+    } while (numValueBytes);
+    writer->lastType = tlv->type;
+    return kHAPError_None;
+}
+
+static void RunBenchmarks(void) {
+    static const size_t sizes[] = { 1024, 4096, 16384, 65536 };
+    for (size_t i = 0; i < HAPArrayCount(sizes); i++) {
+        size_t numValueBytes = sizes[i];
+        uint64_t numIterations = 100000000 / numValueBytes;
+        HAPLog(&benchmarkLogObject, "Value size: %zu bytes.", numValueBytes);
+
+        FillPattern(valueBytes, numValueBytes, 3);
+
+        HAP_BENCHMARK("Append (quadratic)", numIterations, {
+            HAPTLVWriterRef writer;
+            HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+            HAPError err = AppendQuadratic(
+                    &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = testBytes, .numBytes = numValueBytes } });
+            HAPAssert(!err);
+            benchmarkSink = testBytes[numValueBytes - 1];
+        });
+        HAP_BENCHMARK("HAPTLVWriterAppend (in place)", numIterations, {
+            HAPTLVWriterRef writer;
+            HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+            HAPError err = HAPTLVWriterAppend(
+                    &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = testBytes, .numBytes = numValueBytes } });
+            HAPAssert(!err);
+            benchmarkSink = testBytes[numValueBytes - 1];
+        });
+        HAP_BENCHMARK("Append (quadratic, external value)", numIterations, {
+            HAPTLVWriterRef writer;
+            HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+            HAPError err = AppendQuadratic(
+                    &writer,
+                    &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = numValueBytes } });
+            HAPAssert(!err);
+            benchmarkSink = testBytes[numValueBytes - 1];
+        });
+        HAP_BENCHMARK("HAPTLVWriterAppend (external value)", numIterations, {
+            HAPTLVWriterRef writer;
+            HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+            HAPError err = HAPTLVWriterAppend(
+                    &writer,
+                    &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = numValueBytes } });
+            HAPAssert(!err);
+            benchmarkSink = testBytes[numValueBytes - 1];
+        });
+    }
+}
+
+#endif
+
+int main() {
+    HAPError err;
+
+    // Values in the scratch bytes at various offsets relative to the final position.
+    static const size_t numValueBytes[] = { 0, 1, 254, 255, 256, 510, 511, 1000, 4096, 65536 };
+    static const size_t valueOffsets[] = { 0, 1, 2, 3, 5, 64, 300, 2000 };
+    for (size_t i = 0; i < HAPArrayCount(numValueBytes); i++) {
+        for (size_t j = 0; j < HAPArrayCount(valueOffsets); j++) {
+            TestAppendInPlace(/* numPrefixBytes: */ 0, valueOffsets[j], numValueBytes[i]);
+            TestAppendInPlace(/* numPrefixBytes: */ 300, valueOffsets[j], numValueBytes[i]);
+        }
+    }
+
+    // Value located before the scratch bytes.
+    {
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, testBytes, sizeof testBytes);
+        FillPattern(valueBytes, 1000, 9);
+        err = HAPTLVWriterAppend(
+                &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = 1000 } });
+        HAPAssert(!err);
+        void* bytes;
+        size_t numBytes;
+        HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+        HAPAssert(numBytes == 1000 + 2 * 4);
+
+        // Copy of the second fragment of the first TLV.
+        uint8_t* fragmentBytes = &testBytes[2 + UINT8_MAX + 2];
+        err = HAPTLVWriterAppend(
+                &writer, &(const HAPTLV) { .type = 2, .value = { .bytes = fragmentBytes, .numBytes = UINT8_MAX } });
+        HAPAssert(!err);
+        HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+        CheckFragments(testBytes, 1000 + 2 * 4, 1, valueBytes, 1000);
+        CheckFragments(&testBytes[1000 + 2 * 4], 2 + UINT8_MAX, 2, &valueBytes[UINT8_MAX], UINT8_MAX);
+    }
+
+    // Buffer too small.
+    {
+        HAPTLVWriterRef writer;
+        FillPattern(valueBytes, 1000, 9);
+        HAPTLVWriterCreate(&writer, testBytes, 1000 + 2 * 4 - 1);
+        err = HAPTLVWriterAppend(
+                &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = 1000 } });
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPTLVWriterCreate(&writer, testBytes, 1000 + 2 * 4);
+        err = HAPTLVWriterAppend(
+                &writer, &(const HAPTLV) { .type = 1, .value = { .bytes = valueBytes, .numBytes = 1000 } });
+        HAPAssert(!err);
+        HAPTLVWriterCreate(&writer, testBytes, 1);
+        err = HAPTLVWriterAppend(&writer, &(const HAPTLV) { .type = 1, .value = { .bytes = NULL, .numBytes = 0 } });
+        HAPAssert(err == kHAPError_OutOfResources);
+    }
+
+#if HAP_BENCHMARKS_ENABLED
+    RunBenchmarks();
+#endif
+
+    return 0;
+}
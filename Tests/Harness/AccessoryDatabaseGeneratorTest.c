@@ -0,0 +1,744 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#include "AccessoryDatabaseGeneratorTest.h"
+
+#include "../../Tools/AccessoryDatabaseGenerator/AccessoryDatabaseGenerator.c"
+
+/** Connection handle of the simulated central. */
+#define kConnectionHandle ((HAPPlatformBLEPeripheralManagerConnectionHandle) 0x0042)
+
+/** Maximum length of a response that is received over IP. */
+#define kMaxResponseBytes ((size_t) 32 * 1024)
+
+/** Maximum number of run loop iterations to wait for a complete response. */
+#define kMaxResponseIterations ((size_t) 64)
+
+/** Maximum total length of the characteristic values that are read over Bluetooth LE. */
+#define kMaxBLEValueBytes ((size_t) 8192)
+
+/** Controller pairing that is used for Pair Verify. */
+static const char kControllerPairingID[] = "0E5C37F2-5C5B-4A33-8B0D-2D7A4C1E9F10";
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t controllerLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Output of the accessory server that must not change when the precomputed attribute database is used.
+ */
+typedef struct {
+    /** Dechunked body of the GET /accessories response. */
+    uint8_t accessoriesBytes[kMaxResponseBytes];
+    size_t numAccessoriesBytes; /**< Length of the GET /accessories response body. */
+
+    /** Characteristics that have been discovered over Bluetooth LE. */
+    HAPBLECentralCharacteristic characteristics[kHAPBLECentral_MaxCharacteristics];
+    size_t numCharacteristics; /**< Number of discovered characteristics. */
+
+    /** Concatenated values of the characteristics that have been read over Bluetooth LE. */
+    uint8_t valueBytes[kMaxBLEValueBytes];
+    size_t numValueBytes; /**< Length of the concatenated values. */
+} Transcript;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+/**
+ * Returns whether two optional strings are equal.
+ */
+HAP_RESULT_USE_CHECK
+static bool AreOptionalStringsEqual(const char* _Nullable string, const char* _Nullable otherString) {
+    if (!string || !otherString) {
+        return string == otherString;
+    }
+    return HAPStringAreEqual(HAPNonnull(string), HAPNonnull(otherString));
+}
+
+/**
+ * Asserts that precomputed bytes match the items that have been serialized into a TLV writer.
+ */
+static void AssertTLVWriterBytesEqual(const HAPTLVWriterRef* writer, const uint8_t* bytes, size_t numBytes) {
+    HAPPrecondition(writer);
+    HAPPrecondition(bytes);
+
+    void* writerBytes;
+    size_t numWriterBytes;
+    HAPTLVWriterGetBuffer(writer, &writerBytes, &numWriterBytes);
+    HAPAssert(numWriterBytes == numBytes);
+    HAPAssert(HAPRawBufferAreEqual(writerBytes, bytes, numBytes));
+}
+
+/**
+ * Asserts that a precomputed JSON type matches the one that is serialized at runtime.
+ */
+static void AssertJSONTypeEqual(const char* jsonType, const HAPUUID* type) {
+    HAPPrecondition(jsonType);
+    HAPPrecondition(type);
+
+    HAPError err;
+
+    char description[sizeof "00000000-0000-0000-0000-000000000000"];
+    err = HAPUUIDGetDescription(type, description, sizeof description);
+    HAPAssert(!err);
+    HAPAssert(HAPStringAreEqual(jsonType, description));
+}
+
+static void AssertCharacteristicPropertiesEqual(
+        const HAPCharacteristicProperties* properties,
+        const HAPCharacteristicProperties* expectedProperties) {
+    HAPPrecondition(properties);
+    HAPPrecondition(expectedProperties);
+
+    HAPAssert(properties->readable == expectedProperties->readable);
+    HAPAssert(properties->writable == expectedProperties->writable);
+    HAPAssert(properties->supportsEventNotification == expectedProperties->supportsEventNotification);
+    HAPAssert(properties->hidden == expectedProperties->hidden);
+    HAPAssert(properties->readRequiresAdminPermissions == expectedProperties->readRequiresAdminPermissions);
+    HAPAssert(properties->writeRequiresAdminPermissions == expectedProperties->writeRequiresAdminPermissions);
+    HAPAssert(properties->requiresTimedWrite == expectedProperties->requiresTimedWrite);
+    HAPAssert(properties->supportsAuthorizationData == expectedProperties->supportsAuthorizationData);
+    HAPAssert(properties->ip.controlPoint == expectedProperties->ip.controlPoint);
+    HAPAssert(properties->ip.supportsWriteResponse == expectedProperties->ip.supportsWriteResponse);
+    HAPAssert(
+            properties->ble.supportsBroadcastNotification ==
+            expectedProperties->ble.supportsBroadcastNotification);
+    HAPAssert(
+            properties->ble.supportsDisconnectedNotification ==
+            expectedProperties->ble.supportsDisconnectedNotification);
+    HAPAssert(properties->ble.readableWithoutSecurity == expectedProperties->ble.readableWithoutSecurity);
+    HAPAssert(properties->ble.writableWithoutSecurity == expectedProperties->ble.writableWithoutSecurity);
+}
+
+// Callbacks are compared by presence only. The compiled database uses placeholders.
+#define ASSERT_CALLBACKS_EQUAL(chr, expectedChr) \
+    do { \
+        HAPAssert(!(chr)->callbacks.handleRead == !(expectedChr)->callbacks.handleRead); \
+        HAPAssert(!(chr)->callbacks.handleWrite == !(expectedChr)->callbacks.handleWrite); \
+        HAPAssert(!(chr)->callbacks.handleSubscribe == !(expectedChr)->callbacks.handleSubscribe); \
+        HAPAssert(!(chr)->callbacks.handleUnsubscribe == !(expectedChr)->callbacks.handleUnsubscribe); \
+    } while (0)
+
+#define ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr) \
+    do { \
+        HAPAssert((chr)->units == (expectedChr)->units); \
+        HAPAssert((chr)->constraints.minimumValue == (expectedChr)->constraints.minimumValue); \
+        HAPAssert((chr)->constraints.maximumValue == (expectedChr)->constraints.maximumValue); \
+        HAPAssert((chr)->constraints.stepValue == (expectedChr)->constraints.stepValue); \
+    } while (0)
+
+/**
+ * Asserts that the format-specific members of two characteristics are equal.
+ */
+static void AssertCharacteristicConstraintsEqual(
+        const HAPCharacteristic* characteristic_,
+        const HAPCharacteristic* expectedCharacteristic_) {
+    HAPPrecondition(characteristic_);
+    HAPPrecondition(expectedCharacteristic_);
+
+    switch (((const HAPBaseCharacteristic*) characteristic_)->format) {
+        case kHAPCharacteristicFormat_Data: {
+            const HAPDataCharacteristic* chr = characteristic_;
+            const HAPDataCharacteristic* expectedChr = expectedCharacteristic_;
+            HAPAssert(chr->constraints.maxLength == expectedChr->constraints.maxLength);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_Bool: {
+            const HAPBoolCharacteristic* chr = characteristic_;
+            const HAPBoolCharacteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            const HAPUInt8Characteristic* chr = characteristic_;
+            const HAPUInt8Characteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            HAPAssert(!chr->constraints.validValues == !expectedChr->constraints.validValues);
+            if (chr->constraints.validValues) {
+                const uint8_t* _Nullable const* validValues = HAPNonnull(chr->constraints.validValues);
+                const uint8_t* _Nullable const* expectedValidValues =
+                        HAPNonnull(expectedChr->constraints.validValues);
+                size_t i;
+                for (i = 0; validValues[i]; i++) {
+                    HAPAssert(expectedValidValues[i]);
+                    HAPAssert(*HAPNonnull(validValues[i]) == *HAPNonnull(expectedValidValues[i]));
+                }
+                HAPAssert(!expectedValidValues[i]);
+            }
+            HAPAssert(!chr->constraints.validValuesRanges == !expectedChr->constraints.validValuesRanges);
+            if (chr->constraints.validValuesRanges) {
+                const HAPUInt8CharacteristicValidValuesRange* _Nullable const* ranges =
+                        HAPNonnull(chr->constraints.validValuesRanges);
+                const HAPUInt8CharacteristicValidValuesRange* _Nullable const* expectedRanges =
+                        HAPNonnull(expectedChr->constraints.validValuesRanges);
+                size_t i;
+                for (i = 0; ranges[i]; i++) {
+                    HAPAssert(expectedRanges[i]);
+                    HAPAssert(HAPNonnull(ranges[i])->start == HAPNonnull(expectedRanges[i])->start);
+                    HAPAssert(HAPNonnull(ranges[i])->end == HAPNonnull(expectedRanges[i])->end);
+                }
+                HAPAssert(!expectedRanges[i]);
+            }
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            const HAPUInt16Characteristic* chr = characteristic_;
+            const HAPUInt16Characteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            const HAPUInt32Characteristic* chr = characteristic_;
+            const HAPUInt32Characteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            const HAPUInt64Characteristic* chr = characteristic_;
+            const HAPUInt64Characteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            const HAPIntCharacteristic* chr = characteristic_;
+            const HAPIntCharacteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            const HAPFloatCharacteristic* chr = characteristic_;
+            const HAPFloatCharacteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_NUMERIC_CONSTRAINTS_EQUAL(chr, expectedChr);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            const HAPStringCharacteristic* chr = characteristic_;
+            const HAPStringCharacteristic* expectedChr = expectedCharacteristic_;
+            HAPAssert(chr->constraints.maxLength == expectedChr->constraints.maxLength);
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            const HAPTLV8Characteristic* chr = characteristic_;
+            const HAPTLV8Characteristic* expectedChr = expectedCharacteristic_;
+            ASSERT_CALLBACKS_EQUAL(chr, expectedChr);
+        } break;
+    }
+}
+
+#undef ASSERT_NUMERIC_CONSTRAINTS_EQUAL
+#undef ASSERT_CALLBACKS_EQUAL
+
+/**
+ * Checks a compiled characteristic and its precomputed serializations against a hand-written characteristic.
+ */
+static void CheckCharacteristic(
+        const HAPCharacteristic* characteristic_,
+        const HAPPrecomputedCharacteristic* precomputedCharacteristic,
+        const HAPCharacteristic* expectedCharacteristic_,
+        const HAPService* expectedService) {
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+    HAPPrecondition(precomputedCharacteristic);
+    HAPPrecondition(expectedCharacteristic_);
+    const HAPBaseCharacteristic* expectedCharacteristic = expectedCharacteristic_;
+    HAPPrecondition(expectedService);
+
+    HAPError err;
+
+    HAPLogInfo(&kHAPLog_Default, "Checking characteristic 0x%04llX.", (unsigned long long) expectedCharacteristic->iid);
+    HAPAssert(characteristic->format == expectedCharacteristic->format);
+    HAPAssert(characteristic->iid == expectedCharacteristic->iid);
+    HAPAssert(HAPUUIDAreEqual(characteristic->characteristicType, expectedCharacteristic->characteristicType));
+    HAPAssert(AreOptionalStringsEqual(characteristic->debugDescription, expectedCharacteristic->debugDescription));
+    HAPAssert(AreOptionalStringsEqual(
+            characteristic->manufacturerDescription, expectedCharacteristic->manufacturerDescription));
+    AssertCharacteristicPropertiesEqual(&characteristic->properties, &expectedCharacteristic->properties);
+    AssertCharacteristicConstraintsEqual(characteristic, expectedCharacteristic);
+
+    HAPAssert(precomputedCharacteristic->characteristic == characteristic);
+    AssertJSONTypeEqual(precomputedCharacteristic->ip.type, expectedCharacteristic->characteristicType);
+    char metadata[kMaxPrecomputedBytes];
+    size_t numMetadataBytes;
+    err = HAPIPAccessorySerializeCharacteristicMetadata(
+            expectedCharacteristic, metadata, sizeof metadata, &numMetadataBytes);
+    HAPAssert(!err);
+    HAPAssert(HAPStringGetNumBytes(precomputedCharacteristic->ip.metadata) == numMetadataBytes);
+    HAPAssert(HAPRawBufferAreEqual(precomputedCharacteristic->ip.metadata, metadata, numMetadataBytes));
+
+    uint8_t bytes[kMaxPrecomputedBytes];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+    err = HAPBLECharacteristicGetSignatureReadResponse(expectedCharacteristic, expectedService, &writer);
+    HAPAssert(!err);
+    AssertTLVWriterBytesEqual(
+            &writer, precomputedCharacteristic->ble.signatureBytes, precomputedCharacteristic->ble.numSignatureBytes);
+}
+
+/**
+ * Checks a compiled service and its precomputed serializations against a hand-written service.
+ */
+static void CheckService(
+        const HAPService* service,
+        const HAPPrecomputedService* precomputedService,
+        const HAPService* expectedService) {
+    HAPPrecondition(service);
+    HAPPrecondition(precomputedService);
+    HAPPrecondition(expectedService);
+
+    HAPError err;
+
+    HAPLogInfo(&kHAPLog_Default, "Checking service 0x%04llX.", (unsigned long long) expectedService->iid);
+    HAPAssert(service->iid == expectedService->iid);
+    HAPAssert(HAPUUIDAreEqual(service->serviceType, expectedService->serviceType));
+    HAPAssert(AreOptionalStringsEqual(service->debugDescription, expectedService->debugDescription));
+    HAPAssert(AreOptionalStringsEqual(service->name, expectedService->name));
+    HAPAssert(service->properties.primaryService == expectedService->properties.primaryService);
+    HAPAssert(service->properties.hidden == expectedService->properties.hidden);
+    HAPAssert(service->properties.ble.supportsConfiguration == expectedService->properties.ble.supportsConfiguration);
+    HAPAssert(!service->linkedServices == !expectedService->linkedServices);
+    if (service->linkedServices) {
+        const uint16_t* linkedServices = HAPNonnull(service->linkedServices);
+        const uint16_t* expectedLinkedServices = HAPNonnull(expectedService->linkedServices);
+        size_t i;
+        for (i = 0; linkedServices[i]; i++) {
+            HAPAssert(linkedServices[i] == expectedLinkedServices[i]);
+        }
+        HAPAssert(!expectedLinkedServices[i]);
+    }
+
+    HAPAssert(precomputedService->service == service);
+    AssertJSONTypeEqual(precomputedService->ip.type, expectedService->serviceType);
+    uint8_t bytes[kMaxPrecomputedBytes];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+    err = HAPBLEServiceGetSignatureReadResponse(expectedService, &writer);
+    HAPAssert(!err);
+    AssertTLVWriterBytesEqual(
+            &writer, precomputedService->ble.signatureBytes, precomputedService->ble.numSignatureBytes);
+
+    size_t numCharacteristics = 0;
+    if (expectedService->characteristics) {
+        for (; expectedService->characteristics[numCharacteristics]; numCharacteristics++) {
+            HAPAssert(service->characteristics && service->characteristics[numCharacteristics]);
+            HAPAssert(numCharacteristics < precomputedService->numCharacteristics);
+            CheckCharacteristic(
+                    HAPNonnull(service->characteristics)[numCharacteristics],
+                    &HAPNonnull(precomputedService->characteristics)[numCharacteristics],
+                    expectedService->characteristics[numCharacteristics],
+                    expectedService);
+        }
+    }
+    HAPAssert(!service->characteristics || !service->characteristics[numCharacteristics]);
+    HAPAssert(precomputedService->numCharacteristics == numCharacteristics);
+}
+
+/**
+ * Copies the compiled precomputed attribute database and points it at the services and characteristics of the
+ * hand-written database, as if it had been generated alongside them.
+ */
+static void RebindPrecomputedAttributeDatabase(
+        const HAPAccessory* accessory,
+        HAPPrecomputedAttributeDatabase* precomputedAttributeDatabase) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(precomputedAttributeDatabase);
+
+    static HAPPrecomputedService precomputedServices[kMaxServices];
+    static HAPPrecomputedCharacteristic precomputedCharacteristics[kMaxCharacteristics];
+    HAPRawBufferCopyBytes(
+            precomputedServices,
+            database.precomputedServices,
+            database.numServices * sizeof precomputedServices[0]);
+    HAPRawBufferCopyBytes(
+            precomputedCharacteristics,
+            database.precomputedCharacteristics,
+            database.numCharacteristics * sizeof precomputedCharacteristics[0]);
+    for (size_t i = 0; i < database.numServices; i++) {
+        const Service* service = &database.services[i];
+        const HAPService* expectedService = HAPNonnull(accessory->services[i]);
+        precomputedServices[i].service = expectedService;
+        precomputedServices[i].characteristics =
+                service->numCharacteristics ? &precomputedCharacteristics[service->firstCharacteristic] : NULL;
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            precomputedCharacteristics[service->firstCharacteristic + j].characteristic =
+                    HAPNonnull(expectedService->characteristics)[j];
+        }
+    }
+    *precomputedAttributeDatabase = database.precomputedAttributeDatabase;
+    precomputedAttributeDatabase->services = precomputedServices;
+}
+
+/**
+ * Returns the length of the header of a HTTP response including the empty line. 0 if the header is incomplete.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetNumHeaderBytes(const uint8_t* bytes, size_t numBytes) {
+    for (size_t i = 0; i + 4 <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&bytes[i], "\r\n\r\n", 4)) {
+            return i + 4;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Receives a GET /accessories response over IP and removes the chunked transfer encoding.
+ */
+static void ReceiveAccessories(HAPIPController* controller, Transcript* transcript) {
+    HAPPrecondition(controller);
+    HAPPrecondition(transcript);
+
+    static const char okStatusLine[] = "HTTP/1.1 200 OK\r\n";
+    static const char lastChunk[] = "\r\n0\r\n\r\n";
+
+    static uint8_t response[kMaxResponseBytes];
+    size_t numResponseBytes = 0;
+    size_t numHeaderBytes = 0;
+    for (size_t i = 0;; i++) {
+        HAPAssert(i < kMaxResponseIterations);
+        HAPPlatformClockAdvance(0);
+        size_t numReceivedBytes;
+        if (HAPIPControllerReceive(
+                    controller,
+                    &response[numResponseBytes],
+                    sizeof response - numResponseBytes,
+                    &numReceivedBytes)) {
+            numResponseBytes += numReceivedBytes;
+        }
+        numHeaderBytes = GetNumHeaderBytes(response, numResponseBytes);
+        if (numHeaderBytes && numResponseBytes >= numHeaderBytes + sizeof lastChunk - 1 &&
+            HAPRawBufferAreEqual(
+                    &response[numResponseBytes - (sizeof lastChunk - 1)], lastChunk, sizeof lastChunk - 1)) {
+            break;
+        }
+    }
+    HAPAssert(HAPRawBufferAreEqual(response, okStatusLine, sizeof okStatusLine - 1));
+
+    transcript->numAccessoriesBytes = 0;
+    for (size_t position = numHeaderBytes;;) {
+        size_t numChunkBytes = 0;
+        for (; response[position] != '\r'; position++) {
+            char c = (char) response[position];
+            numChunkBytes = numChunkBytes * 16 + (size_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        position += 2;
+        if (!numChunkBytes) {
+            break;
+        }
+        HAPAssert(position + numChunkBytes + 2 <= numResponseBytes);
+        HAPAssert(numChunkBytes <= sizeof transcript->accessoriesBytes - transcript->numAccessoriesBytes);
+        HAPRawBufferCopyBytes(
+                &transcript->accessoriesBytes[transcript->numAccessoriesBytes], &response[position], numChunkBytes);
+        transcript->numAccessoriesBytes += numChunkBytes;
+        position += numChunkBytes + 2;
+    }
+}
+
+/**
+ * Finds a characteristic of an accessory by instance ID.
+ */
+HAP_RESULT_USE_CHECK
+static const HAPBaseCharacteristic* _Nullable FindCharacteristic(
+        const HAPAccessory* accessory,
+        uint64_t iid,
+        const HAPService* _Nullable* _Nonnull service) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(service);
+
+    for (size_t i = 0; accessory->services[i]; i++) {
+        const HAPService* candidate = accessory->services[i];
+        for (size_t j = 0; candidate->characteristics && candidate->characteristics[j]; j++) {
+            const HAPBaseCharacteristic* characteristic = candidate->characteristics[j];
+            if (characteristic->iid == iid) {
+                *service = candidate;
+                return characteristic;
+            }
+        }
+    }
+    *service = NULL;
+    return NULL;
+}
+
+/**
+ * Discovers the GATT database of the accessory and reads the values of the readable characteristics over
+ * Bluetooth LE.
+ *
+ * - Pairing characteristics, signatures and TLV8 characteristics are not read as their values depend on state.
+ */
+static void DiscoverAndReadOverBLE(
+        const HAPAccessory* accessory,
+        const uint8_t* accessoryLTPK,
+        Transcript* transcript) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(accessoryLTPK);
+    HAPPrecondition(transcript);
+
+    HAPError err;
+
+    static HAPBLECentral central;
+    HAPBLECentralCreate(&central, HAPNonnull(platform.ble.blePeripheralManager), kConnectionHandle);
+    HAPBLECentralExchangeMTU(&central, 185);
+    HAPBLECentralDiscover(&central);
+    err = HAPBLECentralPairVerify(
+            &central,
+            kControllerPairingID,
+            sizeof kControllerPairingID - 1,
+            controllerLTSK,
+            controllerLTPK,
+            accessoryLTPK);
+    HAPAssert(!err);
+
+    HAPRawBufferCopyBytes(
+            transcript->characteristics,
+            central.characteristics,
+            central.numCharacteristics * sizeof central.characteristics[0]);
+    transcript->numCharacteristics = central.numCharacteristics;
+    transcript->numValueBytes = 0;
+    for (size_t i = 0; i < central.numCharacteristics; i++) {
+        const HAPBLECentralCharacteristic* bleCharacteristic = &central.characteristics[i];
+        if (!bleCharacteristic->iid) {
+            // Service Instance ID characteristic.
+            continue;
+        }
+        const HAPService* _Nullable service;
+        const HAPBaseCharacteristic* _Nullable characteristic =
+                FindCharacteristic(accessory, bleCharacteristic->iid, &service);
+        HAPAssert(characteristic && service);
+        HAPAssert(HAPUUIDAreEqual(&bleCharacteristic->type, HAPNonnull(characteristic)->characteristicType));
+        if (!HAPNonnull(characteristic)->properties.readable ||
+            HAPNonnull(characteristic)->format == kHAPCharacteristicFormat_Data ||
+            HAPNonnull(characteristic)->format == kHAPCharacteristicFormat_TLV8 ||
+            HAPUUIDAreEqual(HAPNonnull(service)->serviceType, &kHAPServiceType_Pairing)) {
+            continue;
+        }
+        uint8_t bytes[kHAPBLECentral_MaxBodyBytes];
+        size_t numBytes;
+        err = HAPBLECentralReadCharacteristic(&central, bleCharacteristic, bytes, sizeof bytes, &numBytes);
+        HAPAssert(!err);
+        HAPAssert(numBytes <= sizeof transcript->valueBytes - transcript->numValueBytes);
+        HAPRawBufferCopyBytes(&transcript->valueBytes[transcript->numValueBytes], bytes, numBytes);
+        transcript->numValueBytes += numBytes;
+    }
+    HAPBLECentralDisconnect(&central);
+}
+
+/**
+ * Starts the accessory server with an accessory and records its output over IP and Bluetooth LE.
+ */
+static void RecordTranscript(
+        HAPAccessoryServerRef* accessoryServer,
+        const HAPAccessory* accessory,
+        Transcript* transcript) {
+    HAPPrecondition(accessoryServer);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) accessoryServer;
+    HAPPrecondition(accessory);
+    HAPPrecondition(transcript);
+
+    HAPError err;
+
+    HAPAccessoryServerStart(accessoryServer, accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(accessoryServer) == kHAPAccessoryServerState_Running);
+    const uint8_t* accessoryLTPK = server->identity.ed_LTPK;
+
+    // The precomputed GATT layout is used if and only if it has been assigned.
+    if (accessory->precomputedAttributeDatabase) {
+        HAPAssert(
+                server->ble.gattTable.elementIndices ==
+                HAPNonnull(accessory->precomputedAttributeDatabase)->ble.gattElementIndices);
+    } else {
+        HAPAssert(!server->ble.gattTable.elementIndices);
+    }
+
+    static HAPIPController controller;
+    HAPIPControllerConnect(&controller, HAPNonnull(platform.ip.tcpStreamManager), /* workerPool: */ NULL);
+    HAPPlatformClockAdvance(0);
+    err = HAPIPControllerPairVerify(
+            &controller,
+            kControllerPairingID,
+            sizeof kControllerPairingID - 1,
+            controllerLTSK,
+            controllerLTPK,
+            accessoryLTPK);
+    HAPAssert(!err);
+    HAPIPControllerSendRequest(&controller, "GET", "/accessories", NULL, NULL, 0);
+    ReceiveAccessories(&controller, transcript);
+    HAPIPControllerClose(&controller);
+    HAPPlatformClockAdvance(0);
+
+    DiscoverAndReadOverBLE(accessory, accessoryLTPK, transcript);
+
+    HAPAccessoryServerStop(accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(accessoryServer) == kHAPAccessoryServerState_Idle);
+}
+
+void AccessoryDatabaseGeneratorTestRun(const char* path, const HAPAccessory* accessory, size_t attributeCount) {
+    HAPPrecondition(path);
+    HAPPrecondition(accessory);
+    HAPPrecondition(!accessory->precomputedAttributeDatabase);
+
+    HAPError err;
+
+    // Compiled database matches the hand-written database.
+    AccessoryDatabaseGeneratorCompile(path);
+    HAPAssert(!database.isBridged);
+    HAPAssert(database.numServices + database.numCharacteristics == attributeCount);
+    for (size_t i = 0; i < database.numServices; i++) {
+        HAPAssert(accessory->services[i]);
+        CheckService(
+                &database.services[i].service,
+                &database.precomputedServices[i],
+                HAPNonnull(accessory->services[i]));
+    }
+    HAPAssert(!accessory->services[database.numServices]);
+
+    // Every attribute handle of the GATT layout belongs to a service or characteristic.
+    HAPAssert(database.precomputedAttributeDatabase.ble.gattElementIndices);
+    for (size_t i = 0; i < database.precomputedAttributeDatabase.ble.numGATTHandles; i++) {
+        HAPAssert(database.gattElementIndices[i] < attributeCount);
+    }
+
+    // Same accessory, with the precomputed attribute database.
+    static HAPPrecomputedAttributeDatabase precomputedAttributeDatabase;
+    RebindPrecomputedAttributeDatabase(accessory, &precomputedAttributeDatabase);
+    static HAPAccessory precomputedAccessory;
+    precomputedAccessory = *accessory;
+    precomputedAccessory.precomputedAttributeDatabase = &precomputedAttributeDatabase;
+    for (size_t i = 0; accessory->services[i]; i++) {
+        HAPAssert(HAPAccessoryGetPrecomputedService(&precomputedAccessory, HAPNonnull(accessory->services[i]), i));
+    }
+
+    // Prepare accessory server storage.
+    HAPPlatformCreate();
+    HAPAccessoryServerStorageRequirements requirements;
+    HAPAccessoryServerGetStorageRequirements(
+            accessory,
+            /* bridgedAccessories: */ NULL,
+            kHAPPairingStorage_MinElements,
+            /* maxTLV8Bytes: */ 0,
+            &requirements);
+
+    static HAPIPSession ipSessions[1];
+    static uint8_t ipInboundBuffer[16 * 1024];
+    static uint8_t ipOutboundBuffer[16 * 1024];
+    static HAPIPEventNotificationRef ipEventNotifications[64];
+    static HAPIPReadContextRef ipReadContexts[64];
+    static HAPIPWriteContextRef ipWriteContexts[64];
+    static uint8_t ipScratchBuffer[8192];
+    HAPAssert(requirements.ip.numInboundBufferBytes <= sizeof ipInboundBuffer);
+    HAPAssert(requirements.ip.numOutboundBufferBytes <= sizeof ipOutboundBuffer);
+    HAPAssert(requirements.ip.numEventNotifications <= HAPArrayCount(ipEventNotifications));
+    HAPAssert(requirements.ip.numReadContexts <= HAPArrayCount(ipReadContexts));
+    HAPAssert(requirements.ip.numWriteContexts <= HAPArrayCount(ipWriteContexts));
+    HAPAssert(requirements.ip.numScratchBufferBytes <= sizeof ipScratchBuffer);
+    ipSessions[0].inboundBuffer.bytes = ipInboundBuffer;
+    ipSessions[0].inboundBuffer.numBytes = requirements.ip.numInboundBufferBytes;
+    ipSessions[0].outboundBuffer.bytes = ipOutboundBuffer;
+    ipSessions[0].outboundBuffer.numBytes = requirements.ip.numOutboundBufferBytes;
+    ipSessions[0].eventNotifications = ipEventNotifications;
+    ipSessions[0].numEventNotifications = requirements.ip.numEventNotifications;
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    ipAccessoryServerStorage = (HAPIPAccessoryServerStorage) {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = requirements.ip.numReadContexts,
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = requirements.ip.numWriteContexts,
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = requirements.ip.numScratchBufferBytes }
+    };
+
+    static HAPBLEGATTTableElementRef gattTableElements[kHAPBLECentral_MaxCharacteristics];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[4096];
+    static HAPBLEProcedureRef procedures[1];
+    HAPAssert(requirements.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+    HAPAssert(requirements.ble.numProcedureBufferBytes <= sizeof procedureBytes);
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage;
+    bleAccessoryServerStorage = (HAPBLEAccessoryServerStorage) {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = requirements.ble.numGATTTableElements,
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = requirements.ble.numProcedureBufferBytes },
+    };
+
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage },
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // The accessory identity is created on the first start. Pair a controller afterwards.
+    HAPAccessoryServerStart(&accessoryServer, accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+    {
+        HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+        HAP_ed25519_public_key(controllerLTPK, controllerLTSK);
+        HAPControllerPairingIdentifier pairingIdentifier;
+        HAPRawBufferZero(&pairingIdentifier, sizeof pairingIdentifier);
+        HAPRawBufferCopyBytes(pairingIdentifier.bytes, kControllerPairingID, sizeof kControllerPairingID - 1);
+        pairingIdentifier.numBytes = sizeof kControllerPairingID - 1;
+        HAPControllerPublicKey publicKey;
+        HAPRawBufferCopyBytes(publicKey.bytes, controllerLTPK, sizeof publicKey.bytes);
+        err = HAPLegacyImportControllerPairing(
+                platform.keyValueStore, /* pairingIndex: */ 0, &pairingIdentifier, &publicKey, /* isAdmin: */ true);
+        HAPAssert(!err);
+    }
+
+    // Output does not change when the precomputed attribute database is used.
+    static Transcript transcript;
+    static Transcript precomputedTranscript;
+    RecordTranscript(&accessoryServer, accessory, &transcript);
+    RecordTranscript(&accessoryServer, &precomputedAccessory, &precomputedTranscript);
+    HAPAssert(transcript.numAccessoriesBytes);
+    HAPAssert(precomputedTranscript.numAccessoriesBytes == transcript.numAccessoriesBytes);
+    HAPAssert(HAPRawBufferAreEqual(
+            precomputedTranscript.accessoriesBytes, transcript.accessoriesBytes, transcript.numAccessoriesBytes));
+
+    // Every service and characteristic is discovered over Bluetooth LE, and every instance ID resolves.
+    HAPAssert(transcript.numCharacteristics == attributeCount);
+    size_t numIIDs = 0;
+    for (size_t i = 0; i < transcript.numCharacteristics; i++) {
+        if (transcript.characteristics[i].iid) {
+            numIIDs++;
+        }
+    }
+    HAPAssert(numIIDs == database.numCharacteristics);
+    HAPAssert(precomputedTranscript.numCharacteristics == transcript.numCharacteristics);
+    HAPAssert(HAPRawBufferAreEqual(
+            precomputedTranscript.characteristics,
+            transcript.characteristics,
+            transcript.numCharacteristics * sizeof transcript.characteristics[0]));
+    HAPAssert(transcript.numValueBytes);
+    HAPAssert(precomputedTranscript.numValueBytes == transcript.numValueBytes);
+    HAPAssert(HAPRawBufferAreEqual(
+            precomputedTranscript.valueBytes, transcript.valueBytes, transcript.numValueBytes));
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef ACCESSORY_DATABASE_GENERATOR_TEST_H
+#define ACCESSORY_DATABASE_GENERATOR_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#include "HAPBLECentral.h"
+#include "HAPIPController.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Checks the output of Tools/AccessoryDatabaseGenerator against a hand-written accessory attribute database.
+ *
+ * - The generator is compiled into the test so that the compiled database can be inspected without parsing the
+ *   generated source files.
+ *
+ * - Requires Harness/HAPBLECentral.c and Harness/HAPIPController.c to be included before this harness.
+ */
+
+/**
+ * Compiles an accessory attribute database description and checks the result against a hand-written database.
+ *
+ * - Services and characteristics must match the hand-written ones, apart from the names of their callbacks.
+ *
+ * - Precomputed serializations must match the ones that the accessory server computes at runtime.
+ *
+ * - GET /accessories responses and Bluetooth LE discovery and reads must not change when the precomputed
+ *   attribute database is assigned to the accessory, and the precomputed GATT layout must be used.
+ *
+ * - Creates the platform. May only be called once per process.
+ *
+ * @param      path                 Path of the description, relative to the repository root.
+ * @param      accessory            Accessory with the hand-written database. Services must be listed in the same
+ *                                  order as in the description. Must not have a precomputed attribute database.
+ * @param      attributeCount       Number of services and characteristics of the hand-written database.
+ */
+void AccessoryDatabaseGeneratorTestRun(const char* path, const HAPAccessory* accessory, size_t attributeCount);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
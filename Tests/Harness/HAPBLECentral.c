@@ -0,0 +1,983 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatformBLEPeripheralManager+Test.h"
+
+#include "HAPBLECentral.h"
+
+static const HAPLogObject logObject = { .subsystem = "com.apple.mfi.HomeKit.Core.Test", .category = "BLECentral" };
+
+/** ATT opcodes that are used by the simulated central. */
+#define kATTOpcode_ErrorResponse            ((uint8_t) 0x01)
+#define kATTOpcode_ExchangeMTURequest       ((uint8_t) 0x02)
+#define kATTOpcode_ExchangeMTUResponse      ((uint8_t) 0x03)
+#define kATTOpcode_FindInformationRequest   ((uint8_t) 0x04)
+#define kATTOpcode_FindInformationResponse  ((uint8_t) 0x05)
+#define kATTOpcode_ReadByTypeRequest        ((uint8_t) 0x08)
+#define kATTOpcode_ReadByTypeResponse       ((uint8_t) 0x09)
+#define kATTOpcode_ReadRequest              ((uint8_t) 0x0A)
+#define kATTOpcode_ReadResponse             ((uint8_t) 0x0B)
+#define kATTOpcode_ReadBlobRequest          ((uint8_t) 0x0C)
+#define kATTOpcode_ReadBlobResponse         ((uint8_t) 0x0D)
+#define kATTOpcode_ReadByGroupTypeRequest   ((uint8_t) 0x10)
+#define kATTOpcode_ReadByGroupTypeResponse  ((uint8_t) 0x11)
+#define kATTOpcode_WriteRequest             ((uint8_t) 0x12)
+#define kATTOpcode_WriteResponse            ((uint8_t) 0x13)
+#define kATTOpcode_PrepareWriteRequest      ((uint8_t) 0x16)
+#define kATTOpcode_PrepareWriteResponse     ((uint8_t) 0x17)
+#define kATTOpcode_ExecuteWriteRequest      ((uint8_t) 0x18)
+#define kATTOpcode_ExecuteWriteResponse     ((uint8_t) 0x19)
+#define kATTOpcode_HandleValueIndication    ((uint8_t) 0x1D)
+#define kATTOpcode_HandleValueConfirmation  ((uint8_t) 0x1E)
+#define kATTError_AttributeNotFound         ((uint8_t) 0x0A)
+
+/** GATT attribute types that are used during discovery. */
+#define kGATTType_PrimaryService           ((uint16_t) 0x2800)
+#define kGATTType_CharacteristicDeclaration ((uint16_t) 0x2803)
+#define kGATTType_CCCDescriptor             ((uint16_t) 0x2902)
+
+/** Bluetooth Base UUID (little-endian). Bytes 12 and 13 hold a 16-bit UUID. */
+static const uint8_t kBluetoothBaseUUIDBytes[] = { 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                                                   0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+/** Characteristic Instance ID descriptor type (little-endian). */
+static const uint8_t kCharacteristicInstanceIDDescriptorBytes[] = { 0x9A, 0x93, 0x96, 0xD7, 0xBD, 0x6A, 0xD9, 0xB5,
+                                                                    0x16, 0x46, 0xD2, 0x81, 0xFE, 0xF0, 0x46, 0xDC };
+
+/** Control field of a HAP-BLE request and response fragment. */
+#define kHAPBLECentralControlField_Request      ((uint8_t) 0x00)
+#define kHAPBLECentralControlField_Response     ((uint8_t) 0x02)
+#define kHAPBLECentralControlField_Continuation ((uint8_t) 0x80)
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void SendPDU(HAPBLECentral* central, size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(numBytes && numBytes <= central->mtu);
+
+    HAPError err =
+            HAPPlatformBLEPeripheralManagerCentralWrite(central->blePeripheralManager, central->pduBytes, numBytes);
+    HAPAssert(!err);
+    central->statistics.numPDUsSent++;
+    central->statistics.numPDUBytesSent += numBytes;
+}
+
+/**
+ * Receives the next ATT PDU from the accessory into the PDU buffer.
+ *
+ * @param      central              Simulated central.
+ * @param[out] numBytes             Length of ATT PDU.
+ *
+ * @return true                     If an ATT PDU was received.
+ * @return false                    If no ATT PDU is pending.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReceivePDU(HAPBLECentral* central, size_t* numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(numBytes);
+
+    HAPError err = HAPPlatformBLEPeripheralManagerCentralRead(
+            central->blePeripheralManager, central->pduBytes, sizeof central->pduBytes, numBytes);
+    if (err == kHAPError_Busy) {
+        return false;
+    }
+    HAPAssert(!err);
+    HAPAssert(*numBytes);
+    central->statistics.numPDUsReceived++;
+    central->statistics.numPDUBytesReceived += *numBytes;
+    return true;
+}
+
+/**
+ * Confirms a Handle Value Indication that has been received into the PDU buffer.
+ */
+static void ConfirmIndication(HAPBLECentral* central) {
+    HAPPrecondition(central);
+    HAPPrecondition(central->pduBytes[0] == kATTOpcode_HandleValueIndication);
+
+    central->statistics.numIndications++;
+    central->pduBytes[0] = kATTOpcode_HandleValueConfirmation;
+    SendPDU(central, 1);
+}
+
+/**
+ * Sends the ATT request in the PDU buffer and waits for the response.
+ * Handle Value Indications that are received in the meantime are confirmed.
+ *
+ * @param      central              Simulated central.
+ * @param      numBytes             Length of ATT request.
+ *
+ * @return Length of ATT response in the PDU buffer.
+ */
+HAP_RESULT_USE_CHECK
+static size_t Exchange(HAPBLECentral* central, size_t numBytes) {
+    HAPPrecondition(central);
+
+    SendPDU(central, numBytes);
+    for (;;) {
+        size_t numResponseBytes;
+        if (!ReceivePDU(central, &numResponseBytes)) {
+            HAPLogError(&logObject, "Accessory did not respond to ATT request.");
+            HAPFatalError();
+        }
+        if (central->pduBytes[0] == kATTOpcode_HandleValueIndication) {
+            ConfirmIndication(central);
+            continue;
+        }
+        return numResponseBytes;
+    }
+}
+
+/**
+ * Asserts that the PDU buffer contains an ATT response with the given opcode.
+ */
+static void ExpectResponse(const HAPBLECentral* central, size_t numBytes, uint8_t opcode) {
+    HAPPrecondition(central);
+
+    if (central->pduBytes[0] == kATTOpcode_ErrorResponse && numBytes == 5) {
+        HAPLogError(
+                &logObject,
+                "ATT request 0x%02x for handle 0x%04x failed: 0x%02x.",
+                central->pduBytes[1],
+                HAPReadLittleUInt16(&central->pduBytes[2]),
+                central->pduBytes[4]);
+        HAPFatalError();
+    }
+    HAPAssert(central->pduBytes[0] == opcode);
+}
+
+/**
+ * Reads the complete value of an attribute with ATT Read and Read Blob Requests.
+ *
+ * @return Length of the attribute value.
+ */
+HAP_RESULT_USE_CHECK
+static size_t ReadAttribute(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        uint8_t* bytes,
+        size_t maxBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(handle);
+    HAPPrecondition(bytes);
+
+    uint8_t* pdu = central->pduBytes;
+    pdu[0] = kATTOpcode_ReadRequest;
+    HAPWriteLittleUInt16(&pdu[1], handle);
+    size_t numPDUBytes = Exchange(central, 3);
+    ExpectResponse(central, numPDUBytes, kATTOpcode_ReadResponse);
+
+    // A response that fills the ATT_MTU may be continued with Read Blob Requests.
+    size_t numBytes = 0;
+    for (;;) {
+        size_t numValueBytes = numPDUBytes - 1;
+        HAPAssert(numValueBytes <= maxBytes - numBytes);
+        HAPRawBufferCopyBytes(&bytes[numBytes], &pdu[1], numValueBytes);
+        numBytes += numValueBytes;
+        if (numValueBytes < (size_t)(central->mtu - 1)) {
+            return numBytes;
+        }
+
+        pdu[0] = kATTOpcode_ReadBlobRequest;
+        HAPWriteLittleUInt16(&pdu[1], handle);
+        HAPWriteLittleUInt16(&pdu[3], numBytes);
+        numPDUBytes = Exchange(central, 5);
+        ExpectResponse(central, numPDUBytes, kATTOpcode_ReadBlobResponse);
+    }
+}
+
+/**
+ * Writes the complete value of an attribute.
+ * Values that do not fit into a single ATT Write Request are written with ATT Prepare Write Requests.
+ */
+static void WriteAttribute(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle handle,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(handle);
+    HAPPrecondition(bytes);
+
+    uint8_t* pdu = central->pduBytes;
+    if (numBytes <= (size_t)(central->mtu - 3)) {
+        pdu[0] = kATTOpcode_WriteRequest;
+        HAPWriteLittleUInt16(&pdu[1], handle);
+        HAPRawBufferCopyBytes(&pdu[3], bytes, numBytes);
+        size_t numPDUBytes = Exchange(central, 3 + numBytes);
+        ExpectResponse(central, numPDUBytes, kATTOpcode_WriteResponse);
+        return;
+    }
+
+    for (size_t offset = 0; offset < numBytes;) {
+        size_t numValueBytes = HAPMin(numBytes - offset, (size_t)(central->mtu - 5));
+        pdu[0] = kATTOpcode_PrepareWriteRequest;
+        HAPWriteLittleUInt16(&pdu[1], handle);
+        HAPWriteLittleUInt16(&pdu[3], offset);
+        HAPRawBufferCopyBytes(&pdu[5], &bytes[offset], numValueBytes);
+        size_t numPDUBytes = Exchange(central, 5 + numValueBytes);
+        ExpectResponse(central, numPDUBytes, kATTOpcode_PrepareWriteResponse);
+        HAPAssert(numPDUBytes == 5 + numValueBytes);
+        offset += numValueBytes;
+    }
+    pdu[0] = kATTOpcode_ExecuteWriteRequest;
+    pdu[1] = 0x01;
+    size_t numPDUBytes = Exchange(central, 2);
+    ExpectResponse(central, numPDUBytes, kATTOpcode_ExecuteWriteResponse);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void HAPBLECentralCreate(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
+    HAPPrecondition(central);
+    HAPPrecondition(blePeripheralManager);
+
+    HAPRawBufferZero(central, sizeof *central);
+    central->blePeripheralManager = blePeripheralManager;
+    central->mtu = kHAPPlatformBLEPeripheralManagerATT_DefaultMTU;
+    HAPPlatformBLEPeripheralManagerConnectCentral(blePeripheralManager, connectionHandle);
+}
+
+void HAPBLECentralDisconnect(HAPBLECentral* central) {
+    HAPPrecondition(central);
+
+    HAPPlatformBLEPeripheralManagerCentralDisconnect(central->blePeripheralManager);
+    HAPRawBufferZero(&central->session, sizeof central->session);
+}
+
+void HAPBLECentralExchangeMTU(HAPBLECentral* central, uint16_t mtu) {
+    HAPPrecondition(central);
+    HAPPrecondition(mtu >= kHAPPlatformBLEPeripheralManagerATT_DefaultMTU);
+    HAPPrecondition(mtu <= kHAPPlatformBLEPeripheralManagerATT_MaxMTU);
+
+    uint8_t* pdu = central->pduBytes;
+    pdu[0] = kATTOpcode_ExchangeMTURequest;
+    HAPWriteLittleUInt16(&pdu[1], mtu);
+    size_t numPDUBytes = Exchange(central, 3);
+    ExpectResponse(central, numPDUBytes, kATTOpcode_ExchangeMTUResponse);
+    HAPAssert(numPDUBytes == 3);
+    uint16_t serverMTU = HAPReadLittleUInt16(&pdu[1]);
+    central->mtu = HAPMax(kHAPPlatformBLEPeripheralManagerATT_DefaultMTU, HAPMin(mtu, serverMTU));
+}
+
+/**
+ * Converts an attribute type from a discovery response to a HAP UUID.
+ */
+static void ParseUUID(const uint8_t* bytes, size_t numBytes, HAPUUID* uuid) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(uuid);
+
+    if (numBytes == 2) {
+        HAPRawBufferCopyBytes(uuid->bytes, kBluetoothBaseUUIDBytes, sizeof uuid->bytes);
+        uuid->bytes[12] = bytes[0];
+        uuid->bytes[13] = bytes[1];
+    } else {
+        HAPAssert(numBytes == sizeof uuid->bytes);
+        HAPRawBufferCopyBytes(uuid->bytes, bytes, sizeof uuid->bytes);
+    }
+}
+
+void HAPBLECentralDiscover(HAPBLECentral* central) {
+    HAPPrecondition(central);
+
+    uint8_t* pdu = central->pduBytes;
+    central->numCharacteristics = 0;
+
+    // Discover primary services.
+    struct {
+        HAPPlatformBLEPeripheralManagerAttributeHandle startHandle;
+        HAPPlatformBLEPeripheralManagerAttributeHandle endHandle;
+    } services[kHAPBLECentral_MaxCharacteristics];
+    size_t numServices = 0;
+    for (uint32_t handle = 1; handle <= UINT16_MAX;) {
+        pdu[0] = kATTOpcode_ReadByGroupTypeRequest;
+        HAPWriteLittleUInt16(&pdu[1], handle);
+        HAPWriteLittleUInt16(&pdu[3], UINT16_MAX);
+        HAPWriteLittleUInt16(&pdu[5], kGATTType_PrimaryService);
+        size_t numPDUBytes = Exchange(central, 7);
+        if (pdu[0] == kATTOpcode_ErrorResponse) {
+            HAPAssert(numPDUBytes == 5 && pdu[4] == kATTError_AttributeNotFound);
+            break;
+        }
+        ExpectResponse(central, numPDUBytes, kATTOpcode_ReadByGroupTypeResponse);
+        size_t length = pdu[1];
+        HAPAssert(length >= 4 && numPDUBytes > 2 && (numPDUBytes - 2) % length == 0);
+        for (size_t i = 2; i < numPDUBytes; i += length) {
+            HAPAssert(numServices < HAPArrayCount(services));
+            services[numServices].startHandle = HAPReadLittleUInt16(&pdu[i]);
+            services[numServices].endHandle = HAPReadLittleUInt16(&pdu[i + 2]);
+            handle = (uint32_t) services[numServices].endHandle + 1;
+            numServices++;
+        }
+    }
+
+    // Discover characteristics and their descriptors.
+    for (size_t i = 0; i < numServices; i++) {
+        size_t firstCharacteristicIndex = central->numCharacteristics;
+        for (uint32_t handle = services[i].startHandle; handle <= services[i].endHandle;) {
+            pdu[0] = kATTOpcode_ReadByTypeRequest;
+            HAPWriteLittleUInt16(&pdu[1], handle);
+            HAPWriteLittleUInt16(&pdu[3], services[i].endHandle);
+            HAPWriteLittleUInt16(&pdu[5], kGATTType_CharacteristicDeclaration);
+            size_t numPDUBytes = Exchange(central, 7);
+            if (pdu[0] == kATTOpcode_ErrorResponse) {
+                HAPAssert(numPDUBytes == 5 && pdu[4] == kATTError_AttributeNotFound);
+                break;
+            }
+            ExpectResponse(central, numPDUBytes, kATTOpcode_ReadByTypeResponse);
+            size_t length = pdu[1];
+            HAPAssert(length == 7 || length == 21);
+            HAPAssert(numPDUBytes > 2 && (numPDUBytes - 2) % length == 0);
+            for (size_t j = 2; j < numPDUBytes; j += length) {
+                HAPAssert(central->numCharacteristics < HAPArrayCount(central->characteristics));
+                HAPBLECentralCharacteristic* characteristic = &central->characteristics[central->numCharacteristics];
+                HAPRawBufferZero(characteristic, sizeof *characteristic);
+                characteristic->valueHandle = HAPReadLittleUInt16(&pdu[j + 3]);
+                ParseUUID(&pdu[j + 5], length - 5, &characteristic->type);
+                handle = (uint32_t) characteristic->valueHandle + 1;
+                central->numCharacteristics++;
+            }
+        }
+
+        for (size_t j = firstCharacteristicIndex; j < central->numCharacteristics; j++) {
+            HAPBLECentralCharacteristic* characteristic = &central->characteristics[j];
+
+            // Descriptors follow the characteristic value up to the next characteristic declaration.
+            uint32_t endHandle = j + 1 < central->numCharacteristics ?
+                                         (uint32_t) central->characteristics[j + 1].valueHandle - 2 :
+                                         services[i].endHandle;
+            HAPPlatformBLEPeripheralManagerAttributeHandle iidDescriptorHandle = 0;
+            for (uint32_t handle = (uint32_t) characteristic->valueHandle + 1; handle <= endHandle;) {
+                pdu[0] = kATTOpcode_FindInformationRequest;
+                HAPWriteLittleUInt16(&pdu[1], handle);
+                HAPWriteLittleUInt16(&pdu[3], endHandle);
+                size_t numPDUBytes = Exchange(central, 5);
+                if (pdu[0] == kATTOpcode_ErrorResponse) {
+                    HAPAssert(numPDUBytes == 5 && pdu[4] == kATTError_AttributeNotFound);
+                    break;
+                }
+                ExpectResponse(central, numPDUBytes, kATTOpcode_FindInformationResponse);
+                HAPAssert(pdu[1] == 0x01 || pdu[1] == 0x02);
+                size_t length = pdu[1] == 0x01 ? 2 + 2 : 2 + 16;
+                HAPAssert(numPDUBytes > 2 && (numPDUBytes - 2) % length == 0);
+                for (size_t k = 2; k < numPDUBytes; k += length) {
+                    HAPPlatformBLEPeripheralManagerAttributeHandle descriptorHandle = HAPReadLittleUInt16(&pdu[k]);
+                    if (length == 2 + 2 && HAPReadLittleUInt16(&pdu[k + 2]) == kGATTType_CCCDescriptor) {
+                        characteristic->cccDescriptorHandle = descriptorHandle;
+                    } else if (
+                            length == 2 + 16 &&
+                            HAPRawBufferAreEqual(
+                                    &pdu[k + 2],
+                                    kCharacteristicInstanceIDDescriptorBytes,
+                                    sizeof kCharacteristicInstanceIDDescriptorBytes)) {
+                        iidDescriptorHandle = descriptorHandle;
+                    }
+                    handle = (uint32_t) descriptorHandle + 1;
+                }
+            }
+
+            if (iidDescriptorHandle) {
+                uint8_t iidBytes[sizeof(uint16_t)];
+                size_t numIIDBytes = ReadAttribute(central, iidDescriptorHandle, iidBytes, sizeof iidBytes);
+                HAPAssert(numIIDBytes == sizeof iidBytes);
+                characteristic->iid = HAPReadLittleUInt16(iidBytes);
+            }
+        }
+    }
+    HAPLogInfo(&logObject, "Discovered %zu characteristics.", central->numCharacteristics);
+}
+
+HAP_RESULT_USE_CHECK
+const HAPBLECentralCharacteristic* _Nullable HAPBLECentralFindCharacteristic(
+        const HAPBLECentral* central,
+        const HAPUUID* type) {
+    HAPPrecondition(central);
+    HAPPrecondition(type);
+
+    for (size_t i = 0; i < central->numCharacteristics; i++) {
+        if (HAPUUIDAreEqual(&central->characteristics[i].type, type)) {
+            return &central->characteristics[i];
+        }
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writes a HAP-BLE request in fragments.
+ *
+ * - Each fragment is written as a separate attribute value and encrypted separately once the session is secured.
+ */
+static void WriteRequest(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const uint8_t* bytes,
+        size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 5);
+
+    size_t maxFragmentBytes = central->maxFragmentBytes ? central->maxFragmentBytes : kHAPBLECentral_MaxFragmentBytes;
+    HAPAssert(maxFragmentBytes <= sizeof central->fragmentBytes);
+    size_t maxPlaintextBytes = maxFragmentBytes - (central->session.isActive ? CHACHA20_POLY1305_TAG_BYTES : 0);
+    HAPAssert(maxPlaintextBytes >= 5);
+
+    uint8_t* fragment = central->fragmentBytes;
+    for (size_t offset = 0; offset < numBytes;) {
+        size_t numFragmentBytes;
+        if (!offset) {
+            numFragmentBytes = HAPMin(numBytes, maxPlaintextBytes);
+            HAPRawBufferCopyBytes(fragment, bytes, numFragmentBytes);
+            offset = numFragmentBytes;
+        } else {
+            size_t numDataBytes = HAPMin(numBytes - offset, maxPlaintextBytes - 2);
+            fragment[0] = kHAPBLECentralControlField_Continuation | kHAPBLECentralControlField_Request;
+            fragment[1] = bytes[2];
+            HAPRawBufferCopyBytes(&fragment[2], &bytes[offset], numDataBytes);
+            numFragmentBytes = 2 + numDataBytes;
+            offset += numDataBytes;
+        }
+        if (central->session.isActive) {
+            uint8_t nonce[] = { HAPExpandLittleUInt64(central->session.controllerToAccessory.nonce) };
+            HAP_chacha20_poly1305_encrypt(
+                    /* tag: */ &fragment[numFragmentBytes],
+                    fragment,
+                    fragment,
+                    numFragmentBytes,
+                    nonce,
+                    sizeof nonce,
+                    central->session.controllerToAccessory.key);
+            central->session.controllerToAccessory.nonce++;
+            numFragmentBytes += CHACHA20_POLY1305_TAG_BYTES;
+        }
+        WriteAttribute(central, characteristic->valueHandle, fragment, numFragmentBytes);
+        central->statistics.numFragmentsSent++;
+    }
+}
+
+/**
+ * Reads a HAP-BLE response in fragments.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic to which the request was written.
+ * @param      tid                  Transaction ID of the request.
+ * @param[out] bytes                Buffer that receives the response body.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of response body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory reported an error status or sent an invalid response.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadResponse(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        uint8_t tid,
+        uint8_t* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    uint8_t* fragment = central->fragmentBytes;
+    size_t numBodyBytes = 0;
+    *numBytes = 0;
+    bool isFirstFragment = true;
+    do {
+        size_t numFragmentBytes =
+                ReadAttribute(central, characteristic->valueHandle, fragment, sizeof central->fragmentBytes);
+        central->statistics.numFragmentsReceived++;
+        if (central->session.isActive) {
+            if (numFragmentBytes < CHACHA20_POLY1305_TAG_BYTES) {
+                HAPLog(&logObject, "Encrypted fragment too short (%zu bytes).", numFragmentBytes);
+                return kHAPError_InvalidData;
+            }
+            numFragmentBytes -= CHACHA20_POLY1305_TAG_BYTES;
+            uint8_t nonce[] = { HAPExpandLittleUInt64(central->session.accessoryToController.nonce) };
+            int e = HAP_chacha20_poly1305_decrypt(
+                    /* tag: */ &fragment[numFragmentBytes],
+                    fragment,
+                    fragment,
+                    numFragmentBytes,
+                    nonce,
+                    sizeof nonce,
+                    central->session.accessoryToController.key);
+            if (e) {
+                HAPLog(&logObject, "Decryption of fragment failed.");
+                return kHAPError_InvalidData;
+            }
+            central->session.accessoryToController.nonce++;
+        }
+
+        const uint8_t* dataBytes;
+        size_t numDataBytes;
+        if (isFirstFragment) {
+            isFirstFragment = false;
+            if (numFragmentBytes < 3 || fragment[0] != kHAPBLECentralControlField_Response || fragment[1] != tid) {
+                HAPLogBuffer(&logObject, fragment, numFragmentBytes, "Unexpected response header.");
+                return kHAPError_InvalidData;
+            }
+            if (fragment[2] != kHAPBLEPDUStatus_Success) {
+                HAPLog(&logObject, "Accessory reported status 0x%02x.", fragment[2]);
+                return kHAPError_InvalidData;
+            }
+            if (numFragmentBytes == 3) {
+                return kHAPError_None;
+            }
+            if (numFragmentBytes < 5) {
+                return kHAPError_InvalidData;
+            }
+            numBodyBytes = HAPReadLittleUInt16(&fragment[3]);
+            if (numBodyBytes > maxBytes) {
+                HAPLog(&logObject, "Response body too long (%zu bytes).", numBodyBytes);
+                return kHAPError_InvalidData;
+            }
+            dataBytes = &fragment[5];
+            numDataBytes = numFragmentBytes - 5;
+        } else {
+            if (numFragmentBytes < 2 ||
+                fragment[0] != (kHAPBLECentralControlField_Continuation | kHAPBLECentralControlField_Response) ||
+                fragment[1] != tid) {
+                HAPLogBuffer(&logObject, fragment, numFragmentBytes, "Unexpected continuation header.");
+                return kHAPError_InvalidData;
+            }
+            dataBytes = &fragment[2];
+            numDataBytes = numFragmentBytes - 2;
+        }
+        if (numDataBytes > numBodyBytes - *numBytes) {
+            HAPLog(&logObject, "Response body exceeds announced length.");
+            return kHAPError_InvalidData;
+        }
+        HAPRawBufferCopyBytes(&bytes[*numBytes], dataBytes, numDataBytes);
+        *numBytes += numDataBytes;
+    } while (*numBytes < numBodyBytes);
+    return kHAPError_None;
+}
+
+/**
+ * Performs a HAP-BLE procedure.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic.
+ * @param      opcode               HAP opcode.
+ * @param      requestTLVs          NULL-terminated list of TLVs in the request body. NULL if there is no body.
+ * @param[out] valueTLV             Value TLV of the response body. Value is NULL if not present.
+ *                                  Valid until the next procedure.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory reported an error status or sent an invalid response.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PerformProcedure(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        HAPPDUOpcode opcode,
+        const HAPTLV* _Nullable const* _Nullable requestTLVs,
+        HAPTLV* valueTLV) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->iid);
+    HAPPrecondition(valueTLV);
+    HAPError err;
+
+    // Serialize request. The body is written in place behind the header.
+    uint8_t* bytes = central->transactionBytes;
+    uint8_t tid = central->tid++;
+    bytes[0] = kHAPBLECentralControlField_Request;
+    bytes[1] = opcode;
+    bytes[2] = tid;
+    HAPWriteLittleUInt16(&bytes[3], characteristic->iid);
+    size_t numBytes = 5;
+    if (requestTLVs) {
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, &bytes[7], sizeof central->transactionBytes - 7);
+        for (const HAPTLV* const* tlv = requestTLVs; *tlv; tlv++) {
+            err = HAPTLVWriterAppend(&writer, HAPNonnull(*tlv));
+            HAPAssert(!err);
+        }
+        void* bodyBytes;
+        size_t numBodyBytes;
+        HAPTLVWriterGetBuffer(&writer, &bodyBytes, &numBodyBytes);
+        HAPAssert(numBodyBytes <= UINT16_MAX);
+        HAPWriteLittleUInt16(&bytes[5], numBodyBytes);
+        numBytes += 2 + numBodyBytes;
+    }
+    WriteRequest(central, characteristic, bytes, numBytes);
+
+    // Read response. The body reuses the request buffer.
+    size_t numBodyBytes;
+    err = ReadResponse(central, characteristic, tid, bytes, sizeof central->transactionBytes, &numBodyBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        return err;
+    }
+    valueTLV->type = kHAPBLEPDUTLVType_Value;
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, bytes, numBodyBytes);
+    err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { valueTLV, NULL });
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        return err;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReadCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+    HAPError err;
+
+    HAPTLV valueTLV;
+    err = PerformProcedure(central, characteristic, kHAPPDUOpcode_CharacteristicRead, NULL, &valueTLV);
+    if (err) {
+        return err;
+    }
+    if (!valueTLV.value.bytes) {
+        HAPLog(&logObject, "Read response does not contain a value.");
+        return kHAPError_InvalidData;
+    }
+    if (valueTLV.value.numBytes > maxBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(bytes, HAPNonnull(valueTLV.value.bytes), valueTLV.value.numBytes);
+    *numBytes = valueTLV.value.numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralWriteCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+
+    HAPTLV valueTLV;
+    return PerformProcedure(
+            central,
+            characteristic,
+            kHAPPDUOpcode_CharacteristicWrite,
+            (const HAPTLV* const[]) {
+                    &(const HAPTLV) { .type = kHAPBLEPDUTLVType_Value,
+                                      .value = { .bytes = bytes, .numBytes = numBytes } },
+                    NULL },
+            &valueTLV);
+}
+
+void HAPBLECentralEnableEvents(HAPBLECentral* central, const HAPBLECentralCharacteristic* characteristic) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->cccDescriptorHandle);
+
+    uint8_t bytes[2];
+    HAPWriteLittleUInt16(bytes, 0x0002u);
+    WriteAttribute(central, characteristic->cccDescriptorHandle, bytes, sizeof bytes);
+}
+
+void HAPBLECentralProcessIndications(HAPBLECentral* central) {
+    HAPPrecondition(central);
+
+    size_t numBytes;
+    while (ReceivePDU(central, &numBytes)) {
+        HAPAssert(central->pduBytes[0] == kATTOpcode_HandleValueIndication);
+        ConfirmIndication(central);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writes pairing TLVs to a pairing characteristic and returns the pairing TLVs of the response.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PerformPairingProcedure(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes,
+        HAPTLV* const* responseTLVs) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(responseTLVs);
+    HAPError err;
+
+    HAPTLV valueTLV;
+    err = PerformProcedure(
+            central,
+            characteristic,
+            kHAPPDUOpcode_CharacteristicWrite,
+            (const HAPTLV* const[]) {
+                    &(const HAPTLV) { .type = kHAPBLEPDUTLVType_Value,
+                                      .value = { .bytes = bytes, .numBytes = numBytes } },
+                    &(const HAPTLV) { .type = kHAPBLEPDUTLVType_ReturnResponse,
+                                      .value = { .bytes = (const uint8_t[]) { 0x01 }, .numBytes = 1 } },
+                    NULL },
+            &valueTLV);
+    if (err) {
+        return err;
+    }
+    if (!valueTLV.value.bytes) {
+        HAPLog(&logObject, "Pairing response does not contain a value.");
+        return kHAPError_InvalidData;
+    }
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, (void*) (uintptr_t) valueTLV.value.bytes, valueTLV.value.numBytes);
+    err = HAPTLVReaderGetAll(&reader, responseTLVs);
+    if (err) {
+        return err;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPairVerify(
+        HAPBLECentral* central,
+        const void* pairingID,
+        size_t numPairingIDBytes,
+        const uint8_t ltsk[_Nonnull ED25519_SECRET_KEY_BYTES],
+        const uint8_t ltpk[_Nonnull ED25519_PUBLIC_KEY_BYTES],
+        const uint8_t accessoryLTPK[_Nonnull ED25519_PUBLIC_KEY_BYTES]) {
+    HAPPrecondition(central);
+    HAPPrecondition(pairingID);
+    HAPPrecondition(numPairingIDBytes <= sizeof(HAPPairingID));
+    HAPPrecondition(ltsk);
+    HAPPrecondition(ltpk);
+    HAPPrecondition(accessoryLTPK);
+    HAPError err;
+
+    const HAPBLECentralCharacteristic* characteristic =
+            HAPBLECentralFindCharacteristic(central, &kHAPCharacteristicType_PairVerify);
+    HAPAssert(characteristic);
+    HAPRawBufferZero(&central->session, sizeof central->session);
+
+    // Generate ephemeral key pair.
+    uint8_t secretKey[X25519_SCALAR_BYTES];
+    uint8_t publicKey[X25519_BYTES];
+    HAPPlatformRandomNumberFill(secretKey, sizeof secretKey);
+    HAP_X25519_scalarmult_base(publicKey, secretKey);
+
+    // M1.
+    uint8_t requestBytes[256];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                              .value = { .bytes = (const uint8_t[]) { 1 }, .numBytes = 1 } });
+    HAPAssert(!err);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                              .value = { .bytes = publicKey, .numBytes = sizeof publicKey } });
+    HAPAssert(!err);
+    void* bytes;
+    size_t numBytes;
+    HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+
+    // M2.
+    HAPTLV stateTLV, publicKeyTLV, encryptedDataTLV, errorTLV;
+    stateTLV.type = kHAPPairingTLVType_State;
+    publicKeyTLV.type = kHAPPairingTLVType_PublicKey;
+    encryptedDataTLV.type = kHAPPairingTLVType_EncryptedData;
+    errorTLV.type = kHAPPairingTLVType_Error;
+    err = PerformPairingProcedure(
+            central,
+            characteristic,
+            bytes,
+            numBytes,
+            (HAPTLV* const[]) { &stateTLV, &publicKeyTLV, &encryptedDataTLV, &errorTLV, NULL });
+    if (err) {
+        return err;
+    }
+    if (errorTLV.value.bytes || !stateTLV.value.bytes || stateTLV.value.numBytes != 1 ||
+        ((const uint8_t*) stateTLV.value.bytes)[0] != 2 || !publicKeyTLV.value.bytes ||
+        publicKeyTLV.value.numBytes != X25519_BYTES || !encryptedDataTLV.value.bytes ||
+        encryptedDataTLV.value.numBytes < CHACHA20_POLY1305_TAG_BYTES) {
+        HAPLog(&logObject, "Pair Verify M2 invalid.");
+        return kHAPError_InvalidData;
+    }
+    uint8_t accessoryPublicKey[X25519_BYTES];
+    HAPRawBufferCopyBytes(accessoryPublicKey, HAPNonnull(publicKeyTLV.value.bytes), sizeof accessoryPublicKey);
+
+    // Derive shared secret and session key.
+    uint8_t sharedSecret[X25519_BYTES];
+    HAP_X25519_scalarmult(sharedSecret, secretKey, accessoryPublicKey);
+    uint8_t sessionKey[CHACHA20_POLY1305_KEY_BYTES];
+    {
+        static const uint8_t salt[] = "Pair-Verify-Encrypt-Salt";
+        static const uint8_t info[] = "Pair-Verify-Encrypt-Info";
+        HAP_hkdf_sha512(
+                sessionKey,
+                sizeof sessionKey,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                info,
+                sizeof info - 1);
+    }
+
+    // Verify accessory.
+    {
+        uint8_t* encryptedBytes = (uint8_t*) (uintptr_t) encryptedDataTLV.value.bytes;
+        size_t numEncryptedBytes = encryptedDataTLV.value.numBytes - CHACHA20_POLY1305_TAG_BYTES;
+        static const uint8_t nonce[] = "PV-Msg02";
+        int e = HAP_chacha20_poly1305_decrypt(
+                &encryptedBytes[numEncryptedBytes],
+                encryptedBytes,
+                encryptedBytes,
+                numEncryptedBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        if (e) {
+            HAPLog(&logObject, "Pair Verify M2: Failed to decrypt kTLVType_EncryptedData.");
+            return kHAPError_InvalidData;
+        }
+
+        HAPTLV identifierTLV, signatureTLV;
+        identifierTLV.type = kHAPPairingTLVType_Identifier;
+        signatureTLV.type = kHAPPairingTLVType_Signature;
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, encryptedBytes, numEncryptedBytes);
+        err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &identifierTLV, &signatureTLV, NULL });
+        if (err || !identifierTLV.value.bytes || identifierTLV.value.numBytes > sizeof(HAPDeviceIDString) ||
+            !signatureTLV.value.bytes || signatureTLV.value.numBytes != ED25519_BYTES) {
+            HAPLog(&logObject, "Pair Verify M2: Invalid sub-TLV.");
+            return kHAPError_InvalidData;
+        }
+
+        uint8_t infoBytes[X25519_BYTES + sizeof(HAPDeviceIDString) + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryPublicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        HAPRawBufferCopyBytes(
+                &infoBytes[numInfoBytes], HAPNonnull(identifierTLV.value.bytes), identifierTLV.value.numBytes);
+        numInfoBytes += identifierTLV.value.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], publicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        if (HAP_ed25519_verify(HAPNonnull(signatureTLV.value.bytes), infoBytes, numInfoBytes, accessoryLTPK)) {
+            HAPLog(&logObject, "Pair Verify M2: Accessory signature invalid.");
+            return kHAPError_InvalidData;
+        }
+    }
+
+    // M3.
+    {
+        uint8_t infoBytes[X25519_BYTES + sizeof(HAPPairingID) + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], publicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], pairingID, numPairingIDBytes);
+        numInfoBytes += numPairingIDBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryPublicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        uint8_t signature[ED25519_BYTES];
+        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, ltsk, ltpk);
+
+        uint8_t subBytes[2 + sizeof(HAPPairingID) + 2 + ED25519_BYTES + CHACHA20_POLY1305_TAG_BYTES];
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, subBytes, sizeof subBytes);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Identifier,
+                                  .value = { .bytes = pairingID, .numBytes = numPairingIDBytes } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Signature,
+                                  .value = { .bytes = signature, .numBytes = sizeof signature } });
+        HAPAssert(!err);
+        void* subTLVBytes;
+        size_t numSubTLVBytes;
+        HAPTLVWriterGetBuffer(&subWriter, &subTLVBytes, &numSubTLVBytes);
+        HAPAssert(numSubTLVBytes + CHACHA20_POLY1305_TAG_BYTES <= sizeof subBytes);
+        static const uint8_t nonce[] = "PV-Msg03";
+        HAP_chacha20_poly1305_encrypt(
+                &subBytes[numSubTLVBytes],
+                subBytes,
+                subBytes,
+                numSubTLVBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = (const uint8_t[]) { 3 }, .numBytes = 1 } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) {
+                        .type = kHAPPairingTLVType_EncryptedData,
+                        .value = { .bytes = subBytes, .numBytes = numSubTLVBytes + CHACHA20_POLY1305_TAG_BYTES } });
+        HAPAssert(!err);
+        HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+    }
+
+    // M4.
+    stateTLV.type = kHAPPairingTLVType_State;
+    errorTLV.type = kHAPPairingTLVType_Error;
+    err = PerformPairingProcedure(
+            central, characteristic, bytes, numBytes, (HAPTLV* const[]) { &stateTLV, &errorTLV, NULL });
+    if (err) {
+        return err;
+    }
+    if (errorTLV.value.bytes || !stateTLV.value.bytes || stateTLV.value.numBytes != 1 ||
+        ((const uint8_t*) stateTLV.value.bytes)[0] != 4) {
+        HAPLog(&logObject, "Pair Verify M4 invalid.");
+        return kHAPError_InvalidData;
+    }
+
+    // Derive session keys.
+    {
+        static const uint8_t salt[] = "Control-Salt";
+        static const uint8_t readInfo[] = "Control-Read-Encryption-Key";
+        static const uint8_t writeInfo[] = "Control-Write-Encryption-Key";
+        HAP_hkdf_sha512(
+                central->session.accessoryToController.key,
+                sizeof central->session.accessoryToController.key,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                readInfo,
+                sizeof readInfo - 1);
+        HAP_hkdf_sha512(
+                central->session.controllerToAccessory.key,
+                sizeof central->session.controllerToAccessory.key,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                writeInfo,
+                sizeof writeInfo - 1);
+    }
+    central->session.isActive = true;
+    return kHAPError_None;
+}
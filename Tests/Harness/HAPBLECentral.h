@@ -0,0 +1,246 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_BLE_CENTRAL_H
+#define HAP_BLE_CENTRAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+#include "HAPCrypto.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Scripted BLE central that talks to the accessory server through the ATT server of the Mock BLE peripheral manager.
+ *
+ * - All traffic passes through the same ATT PDUs, HAP-BLE fragments and session encryption as on a real link.
+ *   The central is synchronous: each call returns once the accessory server has produced the expected response.
+ *
+ * - Handle Value Indications that arrive while waiting for a response are confirmed and counted.
+ */
+
+/** Maximum number of characteristics that are tracked after discovery. */
+#define kHAPBLECentral_MaxCharacteristics ((size_t) 64)
+
+/** Maximum length of a HAP-BLE fragment. This is the maximum length of an attribute value. */
+#define kHAPBLECentral_MaxFragmentBytes ((size_t) 512)
+
+/** Maximum length of the body of a HAP-BLE request or response. */
+#define kHAPBLECentral_MaxBodyBytes ((size_t) 2048)
+
+/**
+ * Discovered characteristic.
+ */
+typedef struct {
+    /** Characteristic type. */
+    HAPUUID type;
+
+    /** Instance ID. 0 for the Service Instance ID characteristic. */
+    uint16_t iid;
+
+    /** Handle of the characteristic value. */
+    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;
+
+    /** Handle of the Client Characteristic Configuration descriptor. 0 if indications are not supported. */
+    HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandle;
+} HAPBLECentralCharacteristic;
+
+/**
+ * Traffic statistics of a simulated central.
+ */
+typedef struct {
+    size_t numPDUsSent;          /**< Number of ATT PDUs sent to the accessory. */
+    size_t numPDUBytesSent;      /**< Number of ATT bytes sent to the accessory. */
+    size_t numPDUsReceived;      /**< Number of ATT PDUs received from the accessory. */
+    size_t numPDUBytesReceived;  /**< Number of ATT bytes received from the accessory. */
+    size_t numFragmentsSent;     /**< Number of HAP-BLE fragments written. */
+    size_t numFragmentsReceived; /**< Number of HAP-BLE fragments read. */
+    size_t numIndications;       /**< Number of Handle Value Indications that were confirmed. */
+} HAPBLECentralStatistics;
+
+/**
+ * Simulated central.
+ */
+typedef struct {
+    /** BLE peripheral manager to which the central is connected. */
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager;
+
+    /** Negotiated ATT_MTU. */
+    uint16_t mtu;
+
+    /**
+     * Maximum length of a HAP-BLE fragment that is written, including the authentication tag.
+     * 0 to use kHAPBLECentral_MaxFragmentBytes.
+     * Fragments that do not fit into a single ATT Write Request are written with ATT Prepare Write Requests.
+     */
+    size_t maxFragmentBytes;
+
+    /** Discovered characteristics. */
+    HAPBLECentralCharacteristic characteristics[kHAPBLECentral_MaxCharacteristics];
+
+    /** Number of discovered characteristics. */
+    size_t numCharacteristics;
+
+    /** Session security. */
+    struct {
+        struct {
+            uint8_t key[CHACHA20_POLY1305_KEY_BYTES]; /**< Encryption key. */
+            uint64_t nonce;                           /**< Message counter. */
+        } controllerToAccessory, accessoryToController;
+        bool isActive; /**< Whether the session is secured. */
+    } session;
+
+    /** Next transaction ID. */
+    uint8_t tid;
+
+    /** Traffic statistics. */
+    HAPBLECentralStatistics statistics;
+
+    /**@cond */
+    uint8_t pduBytes[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+    uint8_t fragmentBytes[kHAPPlatformBLEPeripheralManagerATT_MaxMTU];
+    uint8_t transactionBytes[5 + 2 + kHAPBLECentral_MaxBodyBytes];
+    /**@endcond */
+} HAPBLECentral;
+
+/**
+ * Connects a simulated central to a BLE peripheral manager.
+ *
+ * @param[out] central              Simulated central.
+ * @param      blePeripheralManager BLE peripheral manager. Services must have been published.
+ * @param      connectionHandle     Connection handle of the central.
+ */
+void HAPBLECentralCreate(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle);
+
+/**
+ * Disconnects a simulated central.
+ *
+ * @param      central              Simulated central.
+ */
+void HAPBLECentralDisconnect(HAPBLECentral* central);
+
+/**
+ * Performs the ATT MTU exchange.
+ *
+ * @param      central              Simulated central.
+ * @param      mtu                  ATT_MTU that the central supports.
+ */
+void HAPBLECentralExchangeMTU(HAPBLECentral* central, uint16_t mtu);
+
+/**
+ * Discovers all characteristics and reads their Instance IDs.
+ *
+ * @param      central              Simulated central.
+ */
+void HAPBLECentralDiscover(HAPBLECentral* central);
+
+/**
+ * Looks up a discovered characteristic by type.
+ *
+ * @param      central              Simulated central.
+ * @param      type                 Characteristic type.
+ *
+ * @return Characteristic with the given type if found. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+const HAPBLECentralCharacteristic* _Nullable HAPBLECentralFindCharacteristic(
+        const HAPBLECentral* central,
+        const HAPUUID* type);
+
+/**
+ * Performs Pair Verify with a controller pairing that is known to the accessory.
+ *
+ * @param      central              Simulated central. Characteristics must have been discovered.
+ * @param      pairingID            Controller pairing identifier.
+ * @param      numPairingIDBytes    Length of controller pairing identifier.
+ * @param      ltsk                 Controller long-term secret key.
+ * @param      ltpk                 Controller long-term public key.
+ * @param      accessoryLTPK        Accessory long-term public key.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory rejected the request or sent an invalid response.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPairVerify(
+        HAPBLECentral* central,
+        const void* pairingID,
+        size_t numPairingIDBytes,
+        const uint8_t ltsk[_Nonnull ED25519_SECRET_KEY_BYTES],
+        const uint8_t ltpk[_Nonnull ED25519_PUBLIC_KEY_BYTES],
+        const uint8_t accessoryLTPK[_Nonnull ED25519_PUBLIC_KEY_BYTES]);
+
+/**
+ * Reads the value of a characteristic with a HAP-Characteristic-Read procedure.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic.
+ * @param[out] bytes                Buffer that receives the value.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory reported an error status or sent an invalid response.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReadCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
+/**
+ * Writes the value of a characteristic with a HAP-Characteristic-Write procedure.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic.
+ * @param      bytes                Value.
+ * @param      numBytes             Length of value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory reported an error status or sent an invalid response.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralWriteCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes);
+
+/**
+ * Enables Handle Value Indications for a characteristic.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic. Must support indications.
+ */
+void HAPBLECentralEnableEvents(HAPBLECentral* central, const HAPBLECentralCharacteristic* characteristic);
+
+/**
+ * Confirms all Handle Value Indications that the accessory has sent so far.
+ *
+ * @param      central              Simulated central.
+ */
+void HAPBLECentralProcessIndications(HAPBLECentral* central);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
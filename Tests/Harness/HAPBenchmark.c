@@ -0,0 +1,33 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <time.h>
+
+#include "HAPBenchmark.h"
+
+static const HAPLogObject benchmarkLogObject = { .subsystem = "com.apple.mfi.HomeKit.Core.Test",
+                                                 .category = "Benchmark" };
+
+HAP_RESULT_USE_CHECK
+uint64_t HAPBenchmarkGetNanoseconds(void) {
+    struct timespec t;
+    int e = clock_gettime(CLOCK_MONOTONIC, &t);
+    HAPAssert(!e);
+    return (uint64_t) t.tv_sec * 1000000000 + (uint64_t) t.tv_nsec;
+}
+
+void HAPBenchmarkLogResult(const char* name, uint64_t numIterations, uint64_t numNanoseconds) {
+    HAPPrecondition(name);
+    HAPPrecondition(numIterations);
+
+    HAPLog(&benchmarkLogObject,
+           "%s: %llu iterations in %llu.%03llu ms (%llu ns/iteration).",
+           name,
+           (unsigned long long) numIterations,
+           (unsigned long long) (numNanoseconds / 1000000),
+           (unsigned long long) (numNanoseconds / 1000 % 1000),
+           (unsigned long long) (numNanoseconds / numIterations));
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_BENCHMARK_H
+#define HAP_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Benchmarks are compiled into unit tests but only run when building with BENCHMARKS=1.
+ *
+ * - Mock PAL timers and clocks are simulated, so benchmarks measure elapsed time with the host's monotonic clock.
+ */
+#if defined(HAP_BENCHMARKS) && HAP_BENCHMARKS != 0
+#define HAP_BENCHMARKS_ENABLED (1)
+#else
+#define HAP_BENCHMARKS_ENABLED (0)
+#endif
+
+/**
+ * Returns the current time of the host's monotonic clock.
+ *
+ * @return Current time in nanoseconds.
+ */
+HAP_RESULT_USE_CHECK
+uint64_t HAPBenchmarkGetNanoseconds(void);
+
+/**
+ * Logs the result of a benchmark.
+ *
+ * @param      name                 Name of the benchmark.
+ * @param      numIterations        Number of iterations that were measured.
+ * @param      numNanoseconds       Total elapsed time in nanoseconds.
+ */
+void HAPBenchmarkLogResult(const char* name, uint64_t numIterations, uint64_t numNanoseconds);
+
+/**
+ * Runs a statement for a number of iterations and logs the elapsed time per iteration.
+ *
+ * @param      name                 Name of the benchmark.
+ * @param      numIterations        Number of iterations.
+ * @param      statement            Statement to benchmark.
+ */
+#define HAP_BENCHMARK(name, numIterations, statement) \
+    do { \
+        uint64_t benchmarkStart_ = HAPBenchmarkGetNanoseconds(); \
+        for (uint64_t benchmarkIteration_ = 0; benchmarkIteration_ < (numIterations); benchmarkIteration_++) { \
+            statement; \
+        } \
+        HAPBenchmarkLogResult((name), (numIterations), HAPBenchmarkGetNanoseconds() - benchmarkStart_); \
+    } while (0)
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,509 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+#include "HAPPlatformWorkerPool+Test.h"
+
+#include "HAPIPController.h"
+
+static const HAPLogObject ipControllerLogObject = { .subsystem = "com.apple.mfi.HomeKit.Core.Test",
+                                                    .category = "IPController" };
+
+/** Length of the AAD of an encrypted frame. */
+#define kHAPIPController_NumAADBytes ((size_t) 2)
+
+/** Maximum number of run loop iterations to wait for a Pair Verify response. */
+#define kHAPIPController_MaxPairingIterations ((size_t) 16)
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void HAPIPControllerConnect(
+        HAPIPController* controller,
+        HAPPlatformTCPStreamManagerRef tcpStreamManager,
+        HAPPlatformWorkerPoolRef _Nullable workerPool) {
+    HAPPrecondition(controller);
+    HAPPrecondition(tcpStreamManager);
+
+    HAPError err;
+
+    HAPRawBufferZero(controller, sizeof *controller);
+    controller->tcpStreamManager = tcpStreamManager;
+    controller->workerPool = workerPool;
+    err = HAPPlatformTCPStreamManagerConnectToListener(tcpStreamManager, &controller->tcpStream);
+    HAPAssert(!err);
+}
+
+void HAPIPControllerClose(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPPlatformTCPStreamManagerClientClose(controller->tcpStreamManager, controller->tcpStream);
+    HAPRawBufferZero(&controller->session, sizeof controller->session);
+    controller->numFrameBytes = 0;
+}
+
+static void Write(HAPIPController* controller, const void* bytes, size_t numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    size_t numBytesWritten;
+    err = HAPPlatformTCPStreamClientWrite(
+            controller->tcpStreamManager, controller->tcpStream, bytes, numBytes, &numBytesWritten);
+    HAPAssert(!err);
+    HAPAssert(numBytesWritten == numBytes);
+}
+
+void HAPIPControllerSend(HAPIPController* controller, const void* bytes_, size_t numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(bytes_);
+    const uint8_t* bytes = bytes_;
+
+    if (!controller->session.isActive) {
+        Write(controller, bytes, numBytes);
+        return;
+    }
+
+    while (numBytes) {
+        size_t numFrameBytes = HAPMin(numBytes, kHAPIPSecurityProtocol_MaxFrameBytes);
+        uint8_t frame
+                [kHAPIPController_NumAADBytes + kHAPIPSecurityProtocol_MaxFrameBytes + CHACHA20_POLY1305_TAG_BYTES];
+        HAPWriteLittleUInt16(&frame[0], numFrameBytes);
+        uint8_t nonce[] = { HAPExpandLittleUInt64(controller->session.controllerToAccessory.nonce) };
+        HAP_chacha20_poly1305_encrypt_aad(
+                &frame[kHAPIPController_NumAADBytes + numFrameBytes],
+                &frame[kHAPIPController_NumAADBytes],
+                bytes,
+                numFrameBytes,
+                &frame[0],
+                kHAPIPController_NumAADBytes,
+                nonce,
+                sizeof nonce,
+                controller->session.controllerToAccessory.key);
+        controller->session.controllerToAccessory.nonce++;
+        Write(controller, frame, kHAPIPController_NumAADBytes + numFrameBytes + CHACHA20_POLY1305_TAG_BYTES);
+
+        bytes += numFrameBytes;
+        numBytes -= numFrameBytes;
+    }
+}
+
+void HAPIPControllerSendRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable body,
+        size_t numBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(method);
+    HAPPrecondition(uri);
+    HAPPrecondition(!numBodyBytes || (contentType && body));
+
+    HAPError err;
+
+    static char request[kHAPIPController_MaxMessageBytes];
+    if (contentType) {
+        err = HAPStringWithFormat(
+                request,
+                sizeof request,
+                "%s %s HTTP/1.1\r\nHost: test\r\nContent-Type: %s\r\nContent-Length: %zu\r\n\r\n",
+                method,
+                uri,
+                contentType,
+                numBodyBytes);
+    } else {
+        err = HAPStringWithFormat(request, sizeof request, "%s %s HTTP/1.1\r\nHost: test\r\n\r\n", method, uri);
+    }
+    HAPAssert(!err);
+    size_t numRequestBytes = HAPStringGetNumBytes(request);
+    HAPAssert(numBodyBytes <= sizeof request - numRequestBytes);
+    if (numBodyBytes) {
+        HAPRawBufferCopyBytes(&request[numRequestBytes], HAPNonnullVoid(body), numBodyBytes);
+        numRequestBytes += numBodyBytes;
+    }
+    HAPIPControllerSend(controller, request, numRequestBytes);
+}
+
+/**
+ * Reads all pending bytes from the TCP stream.
+ *
+ * @return true                     If the accessory has closed the connection.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool Read(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    for (;;) {
+        if (controller->numFrameBytes == sizeof controller->frameBytes) {
+            // Remaining bytes are read once the received frames have been processed.
+            return false;
+        }
+        size_t numBytes;
+        err = HAPPlatformTCPStreamClientRead(
+                controller->tcpStreamManager,
+                controller->tcpStream,
+                &controller->frameBytes[controller->numFrameBytes],
+                sizeof controller->frameBytes - controller->numFrameBytes,
+                &numBytes);
+        if (err == kHAPError_Busy) {
+            return false;
+        }
+        HAPAssert(!err);
+        if (!numBytes) {
+            return true;
+        }
+        controller->numFrameBytes += numBytes;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPIPControllerReceive(HAPIPController* controller, void* bytes_, size_t maxBytes, size_t* numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(bytes_);
+    uint8_t* bytes = bytes_;
+    HAPPrecondition(numBytes);
+
+    bool isClosed = Read(controller);
+    HAPAssert(!isClosed);
+
+    *numBytes = 0;
+    if (!controller->session.isActive) {
+        HAPAssert(controller->numFrameBytes <= maxBytes);
+        HAPRawBufferCopyBytes(bytes, controller->frameBytes, controller->numFrameBytes);
+        *numBytes = controller->numFrameBytes;
+        controller->numFrameBytes = 0;
+        return *numBytes != 0;
+    }
+
+    size_t position = 0;
+    while (controller->numFrameBytes - position >= kHAPIPController_NumAADBytes) {
+        const uint8_t* frame = &controller->frameBytes[position];
+        size_t numFrameBytes = HAPReadLittleUInt16(frame);
+        HAPAssert(numFrameBytes <= kHAPIPSecurityProtocol_MaxFrameBytes);
+        if (controller->numFrameBytes - position <
+            kHAPIPController_NumAADBytes + numFrameBytes + CHACHA20_POLY1305_TAG_BYTES) {
+            break;
+        }
+        HAPAssert(numFrameBytes <= maxBytes - *numBytes);
+        uint8_t nonce[] = { HAPExpandLittleUInt64(controller->session.accessoryToController.nonce) };
+        int e = HAP_chacha20_poly1305_decrypt_aad(
+                &frame[kHAPIPController_NumAADBytes + numFrameBytes],
+                &bytes[*numBytes],
+                &frame[kHAPIPController_NumAADBytes],
+                numFrameBytes,
+                &frame[0],
+                kHAPIPController_NumAADBytes,
+                nonce,
+                sizeof nonce,
+                controller->session.accessoryToController.key);
+        HAPAssert(!e);
+        controller->session.accessoryToController.nonce++;
+        *numBytes += numFrameBytes;
+        position += kHAPIPController_NumAADBytes + numFrameBytes + CHACHA20_POLY1305_TAG_BYTES;
+    }
+    HAPRawBufferCopyBytes(
+            controller->frameBytes, &controller->frameBytes[position], controller->numFrameBytes - position);
+    controller->numFrameBytes -= position;
+    return *numBytes != 0;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPIPControllerIsClosedByAccessory(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    return Read(controller);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Sends pairing TLVs to a pairing endpoint and returns the pairing TLVs of the response.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PerformIPPairingProcedure(
+        HAPIPController* controller,
+        const char* uri,
+        const void* bytes,
+        size_t numBytes,
+        HAPTLV* const* responseTLVs) {
+    HAPPrecondition(controller);
+    HAPPrecondition(uri);
+    HAPPrecondition(bytes);
+    HAPPrecondition(responseTLVs);
+
+    HAPError err;
+
+    HAPIPControllerSendRequest(controller, "POST", uri, "application/pairing+tlv8", bytes, numBytes);
+
+    static uint8_t response[kHAPIPController_MaxMessageBytes];
+    size_t numResponseBytes = 0;
+    for (size_t i = 0; !numResponseBytes; i++) {
+        if (i == kHAPIPController_MaxPairingIterations) {
+            HAPLog(&ipControllerLogObject, "%s: No response.", uri);
+            return kHAPError_InvalidData;
+        }
+        HAPPlatformClockAdvance(0);
+        if (controller->workerPool) {
+            HAPPlatformWorkerPoolRunPendingJobs(HAPNonnull(controller->workerPool));
+            HAPPlatformClockAdvance(0);
+        }
+        if (!HAPIPControllerReceive(controller, response, sizeof response, &numResponseBytes)) {
+            numResponseBytes = 0;
+        }
+    }
+
+    static const char statusLine[] = "HTTP/1.1 200 OK\r\n";
+    if (numResponseBytes < sizeof statusLine - 1 ||
+        !HAPRawBufferAreEqual(response, statusLine, sizeof statusLine - 1)) {
+        HAPLog(&ipControllerLogObject, "%s: Unexpected status.", uri);
+        return kHAPError_InvalidData;
+    }
+    for (size_t i = 0; i + 4 <= numResponseBytes; i++) {
+        if (HAPRawBufferAreEqual(&response[i], "\r\n\r\n", 4)) {
+            HAPTLVReaderRef reader;
+            HAPTLVReaderCreate(&reader, &response[i + 4], numResponseBytes - (i + 4));
+            err = HAPTLVReaderGetAll(&reader, responseTLVs);
+            if (err) {
+                return err;
+            }
+            return kHAPError_None;
+        }
+    }
+    HAPLog(&ipControllerLogObject, "%s: Incomplete response.", uri);
+    return kHAPError_InvalidData;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPairVerify(
+        HAPIPController* controller,
+        const void* pairingID,
+        size_t numPairingIDBytes,
+        const uint8_t ltsk[_Nonnull ED25519_SECRET_KEY_BYTES],
+        const uint8_t ltpk[_Nonnull ED25519_PUBLIC_KEY_BYTES],
+        const uint8_t accessoryLTPK[_Nonnull ED25519_PUBLIC_KEY_BYTES]) {
+    HAPPrecondition(controller);
+    HAPPrecondition(!controller->session.isActive);
+    HAPPrecondition(pairingID);
+    HAPPrecondition(numPairingIDBytes <= sizeof(HAPPairingID));
+    HAPPrecondition(ltsk);
+    HAPPrecondition(ltpk);
+    HAPPrecondition(accessoryLTPK);
+
+    HAPError err;
+
+    // Generate ephemeral key pair.
+    uint8_t secretKey[X25519_SCALAR_BYTES];
+    uint8_t publicKey[X25519_BYTES];
+    HAPPlatformRandomNumberFill(secretKey, sizeof secretKey);
+    HAP_X25519_scalarmult_base(publicKey, secretKey);
+
+    // M1.
+    uint8_t requestBytes[256];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                              .value = { .bytes = (const uint8_t[]) { 1 }, .numBytes = 1 } });
+    HAPAssert(!err);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                              .value = { .bytes = publicKey, .numBytes = sizeof publicKey } });
+    HAPAssert(!err);
+    void* bytes;
+    size_t numBytes;
+    HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+
+    // M2.
+    HAPTLV stateTLV, publicKeyTLV, encryptedDataTLV, errorTLV;
+    stateTLV.type = kHAPPairingTLVType_State;
+    publicKeyTLV.type = kHAPPairingTLVType_PublicKey;
+    encryptedDataTLV.type = kHAPPairingTLVType_EncryptedData;
+    errorTLV.type = kHAPPairingTLVType_Error;
+    err = PerformIPPairingProcedure(
+            controller,
+            "/pair-verify",
+            bytes,
+            numBytes,
+            (HAPTLV* const[]) { &stateTLV, &publicKeyTLV, &encryptedDataTLV, &errorTLV, NULL });
+    if (err) {
+        return err;
+    }
+    if (errorTLV.value.bytes || !stateTLV.value.bytes || stateTLV.value.numBytes != 1 ||
+        ((const uint8_t*) stateTLV.value.bytes)[0] != 2 || !publicKeyTLV.value.bytes ||
+        publicKeyTLV.value.numBytes != X25519_BYTES || !encryptedDataTLV.value.bytes ||
+        encryptedDataTLV.value.numBytes < CHACHA20_POLY1305_TAG_BYTES) {
+        HAPLog(&ipControllerLogObject, "Pair Verify M2 invalid.");
+        return kHAPError_InvalidData;
+    }
+    uint8_t accessoryPublicKey[X25519_BYTES];
+    HAPRawBufferCopyBytes(accessoryPublicKey, HAPNonnull(publicKeyTLV.value.bytes), sizeof accessoryPublicKey);
+
+    // Derive shared secret and session key.
+    uint8_t sharedSecret[X25519_BYTES];
+    HAP_X25519_scalarmult(sharedSecret, secretKey, accessoryPublicKey);
+    uint8_t sessionKey[CHACHA20_POLY1305_KEY_BYTES];
+    {
+        static const uint8_t salt[] = "Pair-Verify-Encrypt-Salt";
+        static const uint8_t info[] = "Pair-Verify-Encrypt-Info";
+        HAP_hkdf_sha512(
+                sessionKey,
+                sizeof sessionKey,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                info,
+                sizeof info - 1);
+    }
+
+    // Verify accessory.
+    {
+        uint8_t* encryptedBytes = (uint8_t*) (uintptr_t) encryptedDataTLV.value.bytes;
+        size_t numEncryptedBytes = encryptedDataTLV.value.numBytes - CHACHA20_POLY1305_TAG_BYTES;
+        static const uint8_t nonce[] = "PV-Msg02";
+        int e = HAP_chacha20_poly1305_decrypt(
+                &encryptedBytes[numEncryptedBytes],
+                encryptedBytes,
+                encryptedBytes,
+                numEncryptedBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        if (e) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Failed to decrypt kTLVType_EncryptedData.");
+            return kHAPError_InvalidData;
+        }
+
+        HAPTLV identifierTLV, signatureTLV;
+        identifierTLV.type = kHAPPairingTLVType_Identifier;
+        signatureTLV.type = kHAPPairingTLVType_Signature;
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, encryptedBytes, numEncryptedBytes);
+        err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &identifierTLV, &signatureTLV, NULL });
+        if (err || !identifierTLV.value.bytes || identifierTLV.value.numBytes > sizeof(HAPDeviceIDString) ||
+            !signatureTLV.value.bytes || signatureTLV.value.numBytes != ED25519_BYTES) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Invalid sub-TLV.");
+            return kHAPError_InvalidData;
+        }
+
+        uint8_t infoBytes[X25519_BYTES + sizeof(HAPDeviceIDString) + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryPublicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        HAPRawBufferCopyBytes(
+                &infoBytes[numInfoBytes], HAPNonnull(identifierTLV.value.bytes), identifierTLV.value.numBytes);
+        numInfoBytes += identifierTLV.value.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], publicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        if (HAP_ed25519_verify(HAPNonnull(signatureTLV.value.bytes), infoBytes, numInfoBytes, accessoryLTPK)) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Accessory signature invalid.");
+            return kHAPError_InvalidData;
+        }
+    }
+
+    // M3.
+    {
+        uint8_t infoBytes[X25519_BYTES + sizeof(HAPPairingID) + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], publicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], pairingID, numPairingIDBytes);
+        numInfoBytes += numPairingIDBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryPublicKey, X25519_BYTES);
+        numInfoBytes += X25519_BYTES;
+        uint8_t signature[ED25519_BYTES];
+        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, ltsk, ltpk);
+
+        uint8_t subBytes[2 + sizeof(HAPPairingID) + 2 + ED25519_BYTES + CHACHA20_POLY1305_TAG_BYTES];
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, subBytes, sizeof subBytes);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Identifier,
+                                  .value = { .bytes = pairingID, .numBytes = numPairingIDBytes } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Signature,
+                                  .value = { .bytes = signature, .numBytes = sizeof signature } });
+        HAPAssert(!err);
+        void* subTLVBytes;
+        size_t numSubTLVBytes;
+        HAPTLVWriterGetBuffer(&subWriter, &subTLVBytes, &numSubTLVBytes);
+        HAPAssert(numSubTLVBytes + CHACHA20_POLY1305_TAG_BYTES <= sizeof subBytes);
+        static const uint8_t nonce[] = "PV-Msg03";
+        HAP_chacha20_poly1305_encrypt(
+                &subBytes[numSubTLVBytes],
+                subBytes,
+                subBytes,
+                numSubTLVBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = (const uint8_t[]) { 3 }, .numBytes = 1 } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) {
+                        .type = kHAPPairingTLVType_EncryptedData,
+                        .value = { .bytes = subBytes, .numBytes = numSubTLVBytes + CHACHA20_POLY1305_TAG_BYTES } });
+        HAPAssert(!err);
+        HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+    }
+
+    // M4.
+    stateTLV.type = kHAPPairingTLVType_State;
+    errorTLV.type = kHAPPairingTLVType_Error;
+    err = PerformIPPairingProcedure(
+            controller, "/pair-verify", bytes, numBytes, (HAPTLV* const[]) { &stateTLV, &errorTLV, NULL });
+    if (err) {
+        return err;
+    }
+    if (errorTLV.value.bytes || !stateTLV.value.bytes || stateTLV.value.numBytes != 1 ||
+        ((const uint8_t*) stateTLV.value.bytes)[0] != 4) {
+        HAPLog(&ipControllerLogObject, "Pair Verify M4 invalid.");
+        return kHAPError_InvalidData;
+    }
+
+    // Derive session keys.
+    {
+        static const uint8_t salt[] = "Control-Salt";
+        static const uint8_t readInfo[] = "Control-Read-Encryption-Key";
+        static const uint8_t writeInfo[] = "Control-Write-Encryption-Key";
+        HAP_hkdf_sha512(
+                controller->session.accessoryToController.key,
+                sizeof controller->session.accessoryToController.key,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                readInfo,
+                sizeof readInfo - 1);
+        HAP_hkdf_sha512(
+                controller->session.controllerToAccessory.key,
+                sizeof controller->session.controllerToAccessory.key,
+                sharedSecret,
+                sizeof sharedSecret,
+                salt,
+                sizeof salt - 1,
+                writeInfo,
+                sizeof writeInfo - 1);
+    }
+    controller->session.isActive = true;
+    return kHAPError_None;
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_IP_CONTROLLER_H
+#define HAP_IP_CONTROLLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+#include "HAPCrypto.h"
+#include "HAPPlatformTCPStreamManager+Init.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Scripted IP controller that talks to the accessory server through a TCP stream of the Mock TCP stream manager.
+ *
+ * - After Pair Verify, all traffic is framed and encrypted with the HAP session keys as on a real connection.
+ *
+ * - The controller does not run the accessory server. Callers advance the clock to let the accessory server process
+ *   requests. Only Pair Verify drives the run loop and an optional Mock worker pool until responses are available.
+ */
+
+/** Maximum length of a plaintext message that can be received at once. */
+#define kHAPIPController_MaxMessageBytes ((size_t) 4096)
+
+/**
+ * Simulated IP controller.
+ */
+typedef struct {
+    /** TCP stream manager to which the controller is connected. */
+    HAPPlatformTCPStreamManagerRef tcpStreamManager;
+
+    /** TCP stream of the connection. */
+    HAPPlatformTCPStreamRef tcpStream;
+
+    /** Mock worker pool whose jobs are run while waiting for Pair Verify responses. NULL if not used. */
+    HAPPlatformWorkerPoolRef _Nullable workerPool;
+
+    /** Session security. */
+    struct {
+        struct {
+            uint8_t key[CHACHA20_POLY1305_KEY_BYTES]; /**< Encryption key. */
+            uint64_t nonce;                           /**< Message counter. */
+        } controllerToAccessory, accessoryToController;
+        bool isActive; /**< Whether the session is secured. */
+    } session;
+
+    /**@cond */
+    uint8_t frameBytes[kHAPIPController_MaxMessageBytes];
+    size_t numFrameBytes;
+    /**@endcond */
+} HAPIPController;
+
+/**
+ * Connects a simulated controller to the listener of a TCP stream manager.
+ *
+ * - The clock must be advanced afterwards so that the accessory server accepts the connection.
+ *
+ * @param[out] controller           Simulated controller.
+ * @param      tcpStreamManager     TCP stream manager.
+ * @param      workerPool           Mock worker pool of the accessory server, if any.
+ */
+void HAPIPControllerConnect(
+        HAPIPController* controller,
+        HAPPlatformTCPStreamManagerRef tcpStreamManager,
+        HAPPlatformWorkerPoolRef _Nullable workerPool);
+
+/**
+ * Closes the connection of a simulated controller.
+ *
+ * @param      controller           Simulated controller.
+ */
+void HAPIPControllerClose(HAPIPController* controller);
+
+/**
+ * Sends bytes to the accessory. The bytes are encrypted if the session is secured.
+ *
+ * @param      controller           Simulated controller.
+ * @param      bytes                Plaintext bytes.
+ * @param      numBytes             Length of plaintext bytes.
+ */
+void HAPIPControllerSend(HAPIPController* controller, const void* bytes, size_t numBytes);
+
+/**
+ * Sends a HTTP request to the accessory.
+ *
+ * @param      controller           Simulated controller.
+ * @param      method               HTTP method.
+ * @param      uri                  Request URI.
+ * @param      contentType          Content type of the body. NULL if the request has no body.
+ * @param      body                 Body.
+ * @param      numBodyBytes         Length of body.
+ */
+void HAPIPControllerSendRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable body,
+        size_t numBodyBytes);
+
+/**
+ * Receives all bytes that the accessory has sent so far. The bytes are decrypted if the session is secured.
+ *
+ * - At most kHAPIPController_MaxMessageBytes are buffered at once. Longer messages are received with multiple calls.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] bytes                Buffer that receives the plaintext bytes.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Number of plaintext bytes.
+ *
+ * @return true                     If at least one complete message has been received.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPIPControllerReceive(HAPIPController* controller, void* bytes, size_t maxBytes, size_t* numBytes);
+
+/**
+ * Returns whether the accessory has closed the connection of a simulated controller.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return true                     If the accessory has closed the connection.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPIPControllerIsClosedByAccessory(HAPIPController* controller);
+
+/**
+ * Performs Pair Verify with a controller pairing that is known to the accessory.
+ *
+ * @param      controller           Simulated controller.
+ * @param      pairingID            Controller pairing identifier.
+ * @param      numPairingIDBytes    Length of controller pairing identifier.
+ * @param      ltsk                 Controller long-term secret key.
+ * @param      ltpk                 Controller long-term public key.
+ * @param      accessoryLTPK        Accessory long-term public key.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory rejected the request or sent an invalid response.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPairVerify(
+        HAPIPController* controller,
+        const void* pairingID,
+        size_t numPairingIDBytes,
+        const uint8_t ltsk[_Nonnull ED25519_SECRET_KEY_BYTES],
+        const uint8_t ltpk[_Nonnull ED25519_PUBLIC_KEY_BYTES],
+        const uint8_t accessoryLTPK[_Nonnull ED25519_PUBLIC_KEY_BYTES]);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,2046 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HAP+Internal.h"
+
+#include "AccessoryDatabaseGenerator.h"
+
+/**
+ * Maximum number of services that may be described.
+ */
+#define kMaxServices ((size_t) 100)
+
+/**
+ * Maximum number of characteristics that may be contained in a service.
+ */
+#define kMaxCharacteristicsPerService ((size_t) 100)
+
+/**
+ * Maximum number of characteristics that may be described.
+ */
+#define kMaxCharacteristics ((size_t) 1000)
+
+/**
+ * Maximum number of services that may be linked to a service.
+ */
+#define kMaxLinkedServices ((size_t) 16)
+
+/**
+ * Maximum number of valid values or valid values ranges of a characteristic.
+ */
+#define kMaxValidValues ((size_t) 256)
+
+/**
+ * Maximum number of include directives.
+ */
+#define kMaxIncludes ((size_t) 16)
+
+/**
+ * Maximum length of a line in the description, including continuation lines.
+ */
+#define kMaxLineBytes ((size_t) 4096)
+
+/**
+ * Maximum number of tokens in a line of the description.
+ */
+#define kMaxTokens ((size_t) 64)
+
+/**
+ * Maximum number of attribute handles in the Bluetooth LE GATT layout.
+ *
+ * - Services use 3 attribute handles. Characteristics use up to 4 attribute handles.
+ */
+#define kMaxGATTHandles (3 * kMaxServices + 4 * kMaxCharacteristics)
+
+/**
+ * Maximum length of a precomputed serialization.
+ */
+#define kMaxPrecomputedBytes ((size_t) 4096)
+
+/**
+ * Service or characteristic type.
+ */
+typedef struct {
+    const char* name;             /**< Name, without the kHAPServiceType_ or kHAPCharacteristicType_ prefix. */
+    const HAPUUID* type;          /**< Type. */
+    const char* debugDescription; /**< Debug description. */
+    bool isCustom;                /**< Whether the type is a custom type that is described by its UUID. */
+} TypeDescription;
+
+#define SERVICE_TYPE(name) \
+    { #name, &kHAPServiceType_##name, kHAPServiceDebugDescription_##name, false }
+#define CHARACTERISTIC_TYPE(name) \
+    { #name, &kHAPCharacteristicType_##name, kHAPCharacteristicDebugDescription_##name, false }
+
+static const TypeDescription kServiceTypes[] = {
+    SERVICE_TYPE(AccessoryInformation),
+    SERVICE_TYPE(GarageDoorOpener),
+    SERVICE_TYPE(LightBulb),
+    SERVICE_TYPE(LockManagement),
+    SERVICE_TYPE(LockMechanism),
+    SERVICE_TYPE(Outlet),
+    SERVICE_TYPE(Switch),
+    SERVICE_TYPE(Thermostat),
+    SERVICE_TYPE(Pairing),
+    SERVICE_TYPE(SecuritySystem),
+    SERVICE_TYPE(CarbonMonoxideSensor),
+    SERVICE_TYPE(ContactSensor),
+    SERVICE_TYPE(Door),
+    SERVICE_TYPE(HumiditySensor),
+    SERVICE_TYPE(LeakSensor),
+    SERVICE_TYPE(LightSensor),
+    SERVICE_TYPE(MotionSensor),
+    SERVICE_TYPE(OccupancySensor),
+    SERVICE_TYPE(SmokeSensor),
+    SERVICE_TYPE(StatelessProgrammableSwitch),
+    SERVICE_TYPE(TemperatureSensor),
+    SERVICE_TYPE(Window),
+    SERVICE_TYPE(WindowCovering),
+    SERVICE_TYPE(AirQualitySensor),
+    SERVICE_TYPE(BatteryService),
+    SERVICE_TYPE(CarbonDioxideSensor),
+    SERVICE_TYPE(HAPProtocolInformation),
+    SERVICE_TYPE(Fan),
+    SERVICE_TYPE(Slat),
+    SERVICE_TYPE(FilterMaintenance),
+    SERVICE_TYPE(AirPurifier),
+    SERVICE_TYPE(HeaterCooler),
+    SERVICE_TYPE(HumidifierDehumidifier),
+    SERVICE_TYPE(ServiceLabel),
+    SERVICE_TYPE(IrrigationSystem),
+    SERVICE_TYPE(Valve),
+    SERVICE_TYPE(Faucet),
+    SERVICE_TYPE(CameraRTPStreamManagement),
+    SERVICE_TYPE(Microphone),
+    SERVICE_TYPE(Speaker),
+    SERVICE_TYPE(Doorbell),
+};
+
+static const TypeDescription kCharacteristicTypes[] = {
+    CHARACTERISTIC_TYPE(AdministratorOnlyAccess),
+    CHARACTERISTIC_TYPE(AudioFeedback),
+    CHARACTERISTIC_TYPE(Brightness),
+    CHARACTERISTIC_TYPE(CoolingThresholdTemperature),
+    CHARACTERISTIC_TYPE(CurrentDoorState),
+    CHARACTERISTIC_TYPE(CurrentHeatingCoolingState),
+    CHARACTERISTIC_TYPE(CurrentRelativeHumidity),
+    CHARACTERISTIC_TYPE(CurrentTemperature),
+    CHARACTERISTIC_TYPE(HeatingThresholdTemperature),
+    CHARACTERISTIC_TYPE(Hue),
+    CHARACTERISTIC_TYPE(Identify),
+    CHARACTERISTIC_TYPE(LockControlPoint),
+    CHARACTERISTIC_TYPE(LockManagementAutoSecurityTimeout),
+    CHARACTERISTIC_TYPE(LockLastKnownAction),
+    CHARACTERISTIC_TYPE(LockCurrentState),
+    CHARACTERISTIC_TYPE(LockTargetState),
+    CHARACTERISTIC_TYPE(Logs),
+    CHARACTERISTIC_TYPE(Manufacturer),
+    CHARACTERISTIC_TYPE(Model),
+    CHARACTERISTIC_TYPE(MotionDetected),
+    CHARACTERISTIC_TYPE(Name),
+    CHARACTERISTIC_TYPE(ObstructionDetected),
+    CHARACTERISTIC_TYPE(On),
+    CHARACTERISTIC_TYPE(OutletInUse),
+    CHARACTERISTIC_TYPE(RotationDirection),
+    CHARACTERISTIC_TYPE(RotationSpeed),
+    CHARACTERISTIC_TYPE(Saturation),
+    CHARACTERISTIC_TYPE(SerialNumber),
+    CHARACTERISTIC_TYPE(TargetDoorState),
+    CHARACTERISTIC_TYPE(TargetHeatingCoolingState),
+    CHARACTERISTIC_TYPE(TargetRelativeHumidity),
+    CHARACTERISTIC_TYPE(TargetTemperature),
+    CHARACTERISTIC_TYPE(TemperatureDisplayUnits),
+    CHARACTERISTIC_TYPE(Version),
+    CHARACTERISTIC_TYPE(PairSetup),
+    CHARACTERISTIC_TYPE(PairVerify),
+    CHARACTERISTIC_TYPE(PairingFeatures),
+    CHARACTERISTIC_TYPE(PairingPairings),
+    CHARACTERISTIC_TYPE(FirmwareRevision),
+    CHARACTERISTIC_TYPE(HardwareRevision),
+    CHARACTERISTIC_TYPE(AirParticulateDensity),
+    CHARACTERISTIC_TYPE(AirParticulateSize),
+    CHARACTERISTIC_TYPE(SecuritySystemCurrentState),
+    CHARACTERISTIC_TYPE(SecuritySystemTargetState),
+    CHARACTERISTIC_TYPE(BatteryLevel),
+    CHARACTERISTIC_TYPE(CarbonMonoxideDetected),
+    CHARACTERISTIC_TYPE(ContactSensorState),
+    CHARACTERISTIC_TYPE(CurrentAmbientLightLevel),
+    CHARACTERISTIC_TYPE(CurrentHorizontalTiltAngle),
+    CHARACTERISTIC_TYPE(CurrentPosition),
+    CHARACTERISTIC_TYPE(CurrentVerticalTiltAngle),
+    CHARACTERISTIC_TYPE(HoldPosition),
+    CHARACTERISTIC_TYPE(LeakDetected),
+    CHARACTERISTIC_TYPE(OccupancyDetected),
+    CHARACTERISTIC_TYPE(PositionState),
+    CHARACTERISTIC_TYPE(ProgrammableSwitchEvent),
+    CHARACTERISTIC_TYPE(StatusActive),
+    CHARACTERISTIC_TYPE(SmokeDetected),
+    CHARACTERISTIC_TYPE(StatusFault),
+    CHARACTERISTIC_TYPE(StatusJammed),
+    CHARACTERISTIC_TYPE(StatusLowBattery),
+    CHARACTERISTIC_TYPE(StatusTampered),
+    CHARACTERISTIC_TYPE(TargetHorizontalTiltAngle),
+    CHARACTERISTIC_TYPE(TargetPosition),
+    CHARACTERISTIC_TYPE(TargetVerticalTiltAngle),
+    CHARACTERISTIC_TYPE(SecuritySystemAlarmType),
+    CHARACTERISTIC_TYPE(ChargingState),
+    CHARACTERISTIC_TYPE(CarbonMonoxideLevel),
+    CHARACTERISTIC_TYPE(CarbonMonoxidePeakLevel),
+    CHARACTERISTIC_TYPE(CarbonDioxideDetected),
+    CHARACTERISTIC_TYPE(CarbonDioxideLevel),
+    CHARACTERISTIC_TYPE(CarbonDioxidePeakLevel),
+    CHARACTERISTIC_TYPE(AirQuality),
+    CHARACTERISTIC_TYPE(ServiceSignature),
+    CHARACTERISTIC_TYPE(AccessoryFlags),
+    CHARACTERISTIC_TYPE(LockPhysicalControls),
+    CHARACTERISTIC_TYPE(TargetAirPurifierState),
+    CHARACTERISTIC_TYPE(CurrentAirPurifierState),
+    CHARACTERISTIC_TYPE(CurrentSlatState),
+    CHARACTERISTIC_TYPE(FilterLifeLevel),
+    CHARACTERISTIC_TYPE(FilterChangeIndication),
+    CHARACTERISTIC_TYPE(ResetFilterIndication),
+    CHARACTERISTIC_TYPE(CurrentFanState),
+    CHARACTERISTIC_TYPE(Active),
+    CHARACTERISTIC_TYPE(CurrentHeaterCoolerState),
+    CHARACTERISTIC_TYPE(TargetHeaterCoolerState),
+    CHARACTERISTIC_TYPE(CurrentHumidifierDehumidifierState),
+    CHARACTERISTIC_TYPE(TargetHumidifierDehumidifierState),
+    CHARACTERISTIC_TYPE(WaterLevel),
+    CHARACTERISTIC_TYPE(SwingMode),
+    CHARACTERISTIC_TYPE(TargetFanState),
+    CHARACTERISTIC_TYPE(SlatType),
+    CHARACTERISTIC_TYPE(CurrentTiltAngle),
+    CHARACTERISTIC_TYPE(TargetTiltAngle),
+    CHARACTERISTIC_TYPE(OzoneDensity),
+    CHARACTERISTIC_TYPE(NitrogenDioxideDensity),
+    CHARACTERISTIC_TYPE(SulphurDioxideDensity),
+    CHARACTERISTIC_TYPE(PM2_5Density),
+    CHARACTERISTIC_TYPE(PM10Density),
+    CHARACTERISTIC_TYPE(VOCDensity),
+    CHARACTERISTIC_TYPE(RelativeHumidityDehumidifierThreshold),
+    CHARACTERISTIC_TYPE(RelativeHumidityHumidifierThreshold),
+    CHARACTERISTIC_TYPE(ServiceLabelIndex),
+    CHARACTERISTIC_TYPE(ServiceLabelNamespace),
+    CHARACTERISTIC_TYPE(ColorTemperature),
+    CHARACTERISTIC_TYPE(ProgramMode),
+    CHARACTERISTIC_TYPE(InUse),
+    CHARACTERISTIC_TYPE(SetDuration),
+    CHARACTERISTIC_TYPE(RemainingDuration),
+    CHARACTERISTIC_TYPE(ValveType),
+    CHARACTERISTIC_TYPE(IsConfigured),
+    CHARACTERISTIC_TYPE(ActiveIdentifier),
+    CHARACTERISTIC_TYPE(ADKVersion),
+    CHARACTERISTIC_TYPE(Volume),
+};
+
+#undef CHARACTERISTIC_TYPE
+#undef SERVICE_TYPE
+
+/**
+ * Characteristic format.
+ */
+typedef struct {
+    const char* name;               /**< Name, without the kHAPCharacteristicFormat_ prefix. */
+    HAPCharacteristicFormat format; /**< Format. */
+    const char* structName;         /**< Name of the characteristic structure. */
+} FormatDescription;
+
+static const FormatDescription kFormats[] = {
+    { "Data", kHAPCharacteristicFormat_Data, "HAPDataCharacteristic" },
+    { "Bool", kHAPCharacteristicFormat_Bool, "HAPBoolCharacteristic" },
+    { "UInt8", kHAPCharacteristicFormat_UInt8, "HAPUInt8Characteristic" },
+    { "UInt16", kHAPCharacteristicFormat_UInt16, "HAPUInt16Characteristic" },
+    { "UInt32", kHAPCharacteristicFormat_UInt32, "HAPUInt32Characteristic" },
+    { "UInt64", kHAPCharacteristicFormat_UInt64, "HAPUInt64Characteristic" },
+    { "Int", kHAPCharacteristicFormat_Int, "HAPIntCharacteristic" },
+    { "Float", kHAPCharacteristicFormat_Float, "HAPFloatCharacteristic" },
+    { "String", kHAPCharacteristicFormat_String, "HAPStringCharacteristic" },
+    { "TLV8", kHAPCharacteristicFormat_TLV8, "HAPTLV8Characteristic" },
+};
+
+/**
+ * Characteristic units.
+ */
+static const char* const kUnits[] = {
+    [kHAPCharacteristicUnits_None] = "None",
+    [kHAPCharacteristicUnits_Celsius] = "Celsius",
+    [kHAPCharacteristicUnits_ArcDegrees] = "ArcDegrees",
+    [kHAPCharacteristicUnits_Percentage] = "Percentage",
+    [kHAPCharacteristicUnits_Lux] = "Lux",
+    [kHAPCharacteristicUnits_Seconds] = "Seconds",
+};
+
+/**
+ * Numeric constraint value.
+ */
+typedef struct {
+    bool isSet; /**< Whether the value has been specified. */
+    union {
+        uint64_t unsignedIntValue; /**< Value of UInt8, UInt16, UInt32 and UInt64 characteristics. */
+        int64_t intValue;          /**< Value of Int characteristics. */
+        float floatValue;          /**< Value of Float characteristics. */
+    } _;
+} NumericConstraint;
+
+/**
+ * Characteristic description.
+ */
+typedef struct {
+    size_t lineNumber;                             /**< Line number in the description. */
+    const TypeDescription* type;                   /**< Characteristic type. */
+    const char* debugDescription;                  /**< Debug description. */
+    const FormatDescription* format;               /**< Format. */
+    const char* symbol;                            /**< Symbol name. */
+    bool isStatic;                                 /**< Whether the symbol has internal linkage. */
+    uint64_t iid;                                  /**< Instance ID. */
+    const char* _Nullable manufacturerDescription; /**< Manufacturer description. */
+    HAPCharacteristicProperties properties;        /**< Properties. */
+    HAPCharacteristicUnits units;                  /**< Units. */
+    NumericConstraint minimumValue;                /**< Minimum value. */
+    NumericConstraint maximumValue;                /**< Maximum value. */
+    NumericConstraint stepValue;                   /**< Step value. */
+    bool hasMaxLength;                             /**< Whether a maximum length has been specified. */
+    uint32_t maxLength;                            /**< Maximum length. */
+    uint8_t validValues[kMaxValidValues];          /**< Valid values. */
+    size_t numValidValues;                         /**< Number of valid values. */
+
+    /** Valid values ranges. */
+    HAPUInt8CharacteristicValidValuesRange validValuesRanges[kMaxValidValues];
+    size_t numValidValuesRanges; /**< Number of valid values ranges. */
+
+    const char* _Nullable handleRead;        /**< Name of the read handler. */
+    const char* _Nullable handleWrite;       /**< Name of the write handler. */
+    const char* _Nullable handleSubscribe;   /**< Name of the subscribe handler. */
+    const char* _Nullable handleUnsubscribe; /**< Name of the unsubscribe handler. */
+
+    /** In-memory representation, used to validate the description. */
+    union {
+        HAPBaseCharacteristic base;
+        HAPDataCharacteristic data;
+        HAPBoolCharacteristic bool_;
+        HAPUInt8Characteristic uint8;
+        HAPUInt16Characteristic uint16;
+        HAPUInt32Characteristic uint32;
+        HAPUInt64Characteristic uint64;
+        HAPIntCharacteristic int_;
+        HAPFloatCharacteristic float_;
+        HAPStringCharacteristic string;
+        HAPTLV8Characteristic tlv8;
+    } characteristic;
+    const uint8_t* validValuePointers[kMaxValidValues + 1];
+    const HAPUInt8CharacteristicValidValuesRange* validValuesRangePointers[kMaxValidValues + 1];
+} Characteristic;
+
+/**
+ * Service description.
+ */
+typedef struct {
+    size_t lineNumber;                                    /**< Line number in the description. */
+    const TypeDescription* type;                          /**< Service type. */
+    const char* debugDescription;                         /**< Debug description. */
+    const char* symbol;                                   /**< Symbol name. */
+    bool isStatic;                                        /**< Whether the symbol has internal linkage. */
+    uint64_t iid;                                         /**< Instance ID. */
+    const char* _Nullable name;                           /**< Name. */
+    HAPServiceProperties properties;                      /**< Properties. */
+    bool hasLinkedServices;                               /**< Whether linked services have been specified. */
+    const char* linkedServiceSymbols[kMaxLinkedServices]; /**< Symbol names of linked services. */
+    size_t numLinkedServices;                             /**< Number of linked services. */
+    size_t firstCharacteristic;                           /**< Index of the first characteristic. */
+    size_t numCharacteristics;                            /**< Number of characteristics. */
+
+    /** In-memory representation, used to validate the description. */
+    HAPService service;
+    uint16_t linkedServices[kMaxLinkedServices + 1];
+    const HAPCharacteristic* characteristics[kMaxCharacteristicsPerService + 1];
+} Service;
+
+/**
+ * Accessory attribute database description.
+ */
+typedef struct {
+    const char* path;                                    /**< Path of the description. */
+    size_t lineNumber;                                   /**< Line number that is being parsed. */
+    bool isBridged;                                      /**< Whether the database describes a bridged accessory. */
+    const char* includes[kMaxIncludes];                  /**< Header files to include. */
+    size_t numIncludes;                                  /**< Number of header files to include. */
+    Service services[kMaxServices];                      /**< Services. */
+    size_t numServices;                                  /**< Number of services. */
+    Characteristic characteristics[kMaxCharacteristics]; /**< Characteristics. */
+    size_t numCharacteristics;                           /**< Number of characteristics. */
+    uint64_t nextIID;                                    /**< Instance ID to assign if none is specified. */
+
+    /** Precomputed serializations of the characteristics, in the same order as the characteristics. */
+    HAPPrecomputedCharacteristic precomputedCharacteristics[kMaxCharacteristics];
+
+    /** Precomputed serializations of the services, in the same order as the services. */
+    HAPPrecomputedService precomputedServices[kMaxServices];
+
+    /** Index of the service or characteristic that covers each attribute handle of the GATT layout. */
+    uint16_t gattElementIndices[kMaxGATTHandles];
+    size_t numGATTHandles; /**< Number of attribute handles in the GATT layout. 0 for bridged accessories. */
+
+    /** Precomputed attribute database. */
+    HAPPrecomputedAttributeDatabase precomputedAttributeDatabase;
+} Database;
+
+static Database database;
+
+HAP_PRINTFLIKE(1, 2)
+HAP_NORETURN
+static void Fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (database.lineNumber) {
+        fprintf(stderr, "%s:%zu: ", database.path, database.lineNumber);
+    } else {
+        fprintf(stderr, "%s: ", database.path);
+    }
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    exit(EXIT_FAILURE);
+}
+
+HAP_RESULT_USE_CHECK
+static char* CopyString(const char* string) {
+    size_t numBytes = HAPStringGetNumBytes(string);
+    char* copy = malloc(numBytes + 1);
+    if (!copy) {
+        Fail("Out of memory.");
+    }
+    HAPRawBufferCopyBytes(copy, string, numBytes + 1);
+    return copy;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Parsing.
+
+/**
+ * Token of a line in the description. Tokens have the form `word` or `key=value`.
+ */
+typedef struct {
+    const char* key;             /**< Key, or the whole word if the token does not contain a value. */
+    const char* _Nullable value; /**< Value. Quoted values are unescaped. */
+} Token;
+
+static void TokenizeLine(const char* line, Token* tokens, size_t* numTokens) {
+    HAPPrecondition(line);
+    HAPPrecondition(tokens);
+    HAPPrecondition(numTokens);
+
+    *numTokens = 0;
+    const char* c = line;
+    for (;;) {
+        while (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n') {
+            c++;
+        }
+        if (!*c || *c == '#') {
+            break;
+        }
+        if (*numTokens == kMaxTokens) {
+            Fail("Too many tokens.");
+        }
+
+        char key[kMaxLineBytes];
+        char value[kMaxLineBytes];
+        size_t numKeyBytes = 0;
+        size_t numValueBytes = 0;
+        bool hasValue = false;
+        while (*c && *c != ' ' && *c != '\t' && *c != '\r' && *c != '\n') {
+            if (!hasValue && *c == '=') {
+                hasValue = true;
+                c++;
+                continue;
+            }
+            char* bytes = hasValue ? value : key;
+            size_t* numBytes = hasValue ? &numValueBytes : &numKeyBytes;
+            if (*c == '"') {
+                c++;
+                while (*c != '"') {
+                    if (!*c || *c == '\n') {
+                        Fail("Unterminated string.");
+                    }
+                    if (*c == '\\') {
+                        c++;
+                        if (*c != '"' && *c != '\\') {
+                            Fail("Invalid escape sequence (only \\\" and \\\\ are supported).");
+                        }
+                    }
+                    HAPAssert(*numBytes < kMaxLineBytes - 1);
+                    bytes[(*numBytes)++] = *c++;
+                }
+                c++;
+            } else {
+                HAPAssert(*numBytes < kMaxLineBytes - 1);
+                bytes[(*numBytes)++] = *c++;
+            }
+        }
+        key[numKeyBytes] = '\0';
+        value[numValueBytes] = '\0';
+        tokens[*numTokens].key = CopyString(key);
+        tokens[*numTokens].value = hasValue ? CopyString(value) : NULL;
+        (*numTokens)++;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsIdentifier(const char* string) {
+    HAPPrecondition(string);
+
+    if (!*string || (*string >= '0' && *string <= '9')) {
+        return false;
+    }
+    for (const char* c = string; *c; c++) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetIdentifier(const Token* token) {
+    HAPPrecondition(token);
+
+    if (!token->value || !IsIdentifier(HAPNonnull(token->value))) {
+        Fail("%s requires a C identifier.", token->key);
+    }
+    return HAPNonnull(token->value);
+}
+
+HAP_RESULT_USE_CHECK
+static uint64_t GetUInt64(const char* key, const char* _Nullable value, uint64_t maximumValue) {
+    HAPPrecondition(key);
+
+    if (!value || !(*value >= '0' && *value <= '9')) {
+        Fail("%s requires a non-negative integer.", key);
+    }
+    char* end;
+    unsigned long long result = strtoull(HAPNonnull(value), &end, 0);
+    if (*end || result > maximumValue) {
+        Fail("%s has invalid value %s (maximum %llu).", key, value, (unsigned long long) maximumValue);
+    }
+    return (uint64_t) result;
+}
+
+HAP_RESULT_USE_CHECK
+static int64_t GetInt64(const char* key, const char* _Nullable value, int64_t minimumValue, int64_t maximumValue) {
+    HAPPrecondition(key);
+
+    if (!value || !*value) {
+        Fail("%s requires an integer.", key);
+    }
+    char* end;
+    long long result = strtoll(HAPNonnull(value), &end, 0);
+    if (*end || result < minimumValue || result > maximumValue) {
+        Fail("%s has invalid value %s.", key, value);
+    }
+    return (int64_t) result;
+}
+
+HAP_RESULT_USE_CHECK
+static float GetFloat(const char* key, const char* _Nullable value) {
+    HAPPrecondition(key);
+
+    HAPError err;
+
+    if (!value) {
+        Fail("%s requires a number.", key);
+    }
+    if (HAPStringAreEqual(HAPNonnull(value), "inf")) {
+        return HAPFloatFromBitPattern(0x7F800000);
+    }
+    if (HAPStringAreEqual(HAPNonnull(value), "-inf")) {
+        return HAPFloatFromBitPattern(0xFF800000);
+    }
+    float result;
+    err = HAPFloatFromString(HAPNonnull(value), &result);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        Fail("%s has invalid value %s.", key, value);
+    }
+    return result;
+}
+
+static void ParseNumericConstraint(Characteristic* characteristic, const Token* token, NumericConstraint* constraint) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(token);
+    HAPPrecondition(constraint);
+
+    constraint->isSet = true;
+    switch (characteristic->format->format) {
+        case kHAPCharacteristicFormat_UInt8: {
+            constraint->_.unsignedIntValue = GetUInt64(token->key, token->value, UINT8_MAX);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            constraint->_.unsignedIntValue = GetUInt64(token->key, token->value, UINT16_MAX);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            constraint->_.unsignedIntValue = GetUInt64(token->key, token->value, UINT32_MAX);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            constraint->_.unsignedIntValue = GetUInt64(token->key, token->value, UINT64_MAX);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            constraint->_.intValue = GetInt64(token->key, token->value, INT32_MIN, INT32_MAX);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            constraint->_.floatValue = GetFloat(token->key, token->value);
+        } break;
+        default: {
+            Fail("%s is not supported by characteristics with format %s.", token->key, characteristic->format->name);
+        }
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static uint64_t AssignIID(const char* _Nullable value) {
+    uint64_t iid = value ? GetUInt64("iid", value, UINT16_MAX) : database.nextIID;
+    if (!iid) {
+        Fail("iid must not be 0.");
+    }
+    for (size_t i = 0; i < database.numServices; i++) {
+        if (database.services[i].iid == iid) {
+            Fail("iid 0x%04llX is already used by %s.", (unsigned long long) iid, database.services[i].symbol);
+        }
+    }
+    for (size_t i = 0; i < database.numCharacteristics; i++) {
+        if (database.characteristics[i].iid == iid) {
+            Fail("iid 0x%04llX is already used by %s.", (unsigned long long) iid, database.characteristics[i].symbol);
+        }
+    }
+    if (iid >= database.nextIID) {
+        database.nextIID = iid + 1;
+    }
+    return iid;
+}
+
+static void CheckSymbol(const char* symbol) {
+    HAPPrecondition(symbol);
+
+    if (!IsIdentifier(symbol)) {
+        Fail("%s is not a valid C identifier.", symbol);
+    }
+    for (size_t i = 0; i < database.numServices; i++) {
+        if (HAPStringAreEqual(database.services[i].symbol, symbol)) {
+            Fail("%s is already defined.", symbol);
+        }
+    }
+    for (size_t i = 0; i < database.numCharacteristics; i++) {
+        if (HAPStringAreEqual(database.characteristics[i].symbol, symbol)) {
+            Fail("%s is already defined.", symbol);
+        }
+    }
+}
+
+/**
+ * Parses a UUID of the form XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX.
+ *
+ * @param      string               String to parse.
+ * @param[out] uuid                 UUID, in reversed network byte order.
+ *
+ * @return true                     If the string is a UUID.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ParseTypeUUID(const char* string, HAPUUID* uuid) {
+    HAPPrecondition(string);
+    HAPPrecondition(uuid);
+
+    static const char kFormat[] = "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX";
+    if (HAPStringGetNumBytes(string) != sizeof kFormat - 1) {
+        return false;
+    }
+    size_t numNibbles = 0;
+    for (size_t i = 0; i < sizeof kFormat - 1; i++) {
+        char c = string[i];
+        if (kFormat[i] == '-') {
+            if (c != '-') {
+                return false;
+            }
+            continue;
+        }
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = (uint8_t)(c - '0');
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = (uint8_t)(c - 'A' + 10);
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = (uint8_t)(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        uint8_t* byte = &uuid->bytes[sizeof uuid->bytes - 1 - numNibbles / 2];
+        *byte = (uint8_t)(numNibbles % 2 ? *byte | nibble : nibble << 4);
+        numNibbles++;
+    }
+    return true;
+}
+
+HAP_RESULT_USE_CHECK
+static const TypeDescription*
+        GetType(const char* name, const TypeDescription* types, size_t numTypes, const char* kind) {
+    HAPPrecondition(name);
+    HAPPrecondition(types);
+    HAPPrecondition(kind);
+
+    HAPUUID uuid;
+    bool isUUID = ParseTypeUUID(name, &uuid);
+    for (size_t i = 0; i < numTypes; i++) {
+        if (isUUID ? HAPUUIDAreEqual(types[i].type, &uuid) : HAPStringAreEqual(types[i].name, name)) {
+            return &types[i];
+        }
+    }
+    if (!isUUID) {
+        Fail("Unknown %s type %s.", kind, name);
+    }
+    if (HAPUUIDIsAppleDefined(&uuid)) {
+        Fail("%s is based on the HAP Base UUID but is not a known %s type.", name, kind);
+    }
+
+    // Custom type.
+    TypeDescription* type = malloc(sizeof *type);
+    HAPUUID* customUUID = malloc(sizeof *customUUID);
+    if (!type || !customUUID) {
+        Fail("Out of memory.");
+    }
+    *customUUID = uuid;
+    type->name = name;
+    type->type = customUUID;
+    type->debugDescription = name;
+    type->isCustom = true;
+    return type;
+}
+
+static void ParseService(const Token* tokens, size_t numTokens) {
+    HAPPrecondition(tokens);
+
+    if (numTokens < 3 || tokens[1].value || tokens[2].value) {
+        Fail("Expected: service <Type> <symbol> [options].");
+    }
+    if (database.numServices == kMaxServices) {
+        Fail("Too many services (maximum %zu).", kMaxServices);
+    }
+    Service* service = &database.services[database.numServices];
+    service->lineNumber = database.lineNumber;
+    service->type = GetType(tokens[1].key, kServiceTypes, HAPArrayCount(kServiceTypes), "service");
+    service->debugDescription = service->type->debugDescription;
+    CheckSymbol(tokens[2].key);
+    service->symbol = tokens[2].key;
+    service->firstCharacteristic = database.numCharacteristics;
+
+    const char* _Nullable iid = NULL;
+    for (size_t i = 3; i < numTokens; i++) {
+        const Token* token = &tokens[i];
+        if (!token->value) {
+            if (HAPStringAreEqual(token->key, "static")) {
+                service->isStatic = true;
+            } else if (HAPStringAreEqual(token->key, "primaryService")) {
+                service->properties.primaryService = true;
+            } else if (HAPStringAreEqual(token->key, "hidden")) {
+                service->properties.hidden = true;
+            } else if (HAPStringAreEqual(token->key, "ble.supportsConfiguration")) {
+                service->properties.ble.supportsConfiguration = true;
+            } else {
+                Fail("Unknown service option %s.", token->key);
+            }
+        } else if (HAPStringAreEqual(token->key, "iid")) {
+            iid = token->value;
+        } else if (HAPStringAreEqual(token->key, "name")) {
+            service->name = token->value;
+        } else if (HAPStringAreEqual(token->key, "debugDescription") && service->type->isCustom) {
+            service->debugDescription = HAPNonnull(token->value);
+        } else if (HAPStringAreEqual(token->key, "linkedServices")) {
+            service->hasLinkedServices = true;
+            char* symbols = CopyString(HAPNonnull(token->value));
+            for (char* symbol = strtok(symbols, ","); symbol; symbol = strtok(NULL, ",")) {
+                if (service->numLinkedServices == kMaxLinkedServices) {
+                    Fail("Too many linked services (maximum %zu).", kMaxLinkedServices);
+                }
+                service->linkedServiceSymbols[service->numLinkedServices++] = symbol;
+            }
+        } else {
+            Fail("Unknown service option %s.", token->key);
+        }
+    }
+    service->iid = AssignIID(iid);
+    database.numServices++;
+}
+
+static void ParseCharacteristicProperty(Characteristic* characteristic, const char* property) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(property);
+
+    HAPCharacteristicProperties* properties = &characteristic->properties;
+    if (HAPStringAreEqual(property, "static")) {
+        characteristic->isStatic = true;
+    } else if (HAPStringAreEqual(property, "readable")) {
+        properties->readable = true;
+    } else if (HAPStringAreEqual(property, "writable")) {
+        properties->writable = true;
+    } else if (HAPStringAreEqual(property, "supportsEventNotification")) {
+        properties->supportsEventNotification = true;
+    } else if (HAPStringAreEqual(property, "hidden")) {
+        properties->hidden = true;
+    } else if (HAPStringAreEqual(property, "readRequiresAdminPermissions")) {
+        properties->readRequiresAdminPermissions = true;
+    } else if (HAPStringAreEqual(property, "writeRequiresAdminPermissions")) {
+        properties->writeRequiresAdminPermissions = true;
+    } else if (HAPStringAreEqual(property, "requiresTimedWrite")) {
+        properties->requiresTimedWrite = true;
+    } else if (HAPStringAreEqual(property, "supportsAuthorizationData")) {
+        properties->supportsAuthorizationData = true;
+    } else if (HAPStringAreEqual(property, "ip.controlPoint")) {
+        properties->ip.controlPoint = true;
+    } else if (HAPStringAreEqual(property, "ip.supportsWriteResponse")) {
+        properties->ip.supportsWriteResponse = true;
+    } else if (HAPStringAreEqual(property, "ble.supportsBroadcastNotification")) {
+        properties->ble.supportsBroadcastNotification = true;
+    } else if (HAPStringAreEqual(property, "ble.supportsDisconnectedNotification")) {
+        properties->ble.supportsDisconnectedNotification = true;
+    } else if (HAPStringAreEqual(property, "ble.readableWithoutSecurity")) {
+        properties->ble.readableWithoutSecurity = true;
+    } else if (HAPStringAreEqual(property, "ble.writableWithoutSecurity")) {
+        properties->ble.writableWithoutSecurity = true;
+    } else {
+        Fail("Unknown characteristic option %s.", property);
+    }
+}
+
+static void ParseValidValues(Characteristic* characteristic, const Token* token) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(token);
+
+    if (characteristic->format->format != kHAPCharacteristicFormat_UInt8) {
+        Fail("%s is only supported by characteristics with format UInt8.", token->key);
+    }
+    bool isRange = HAPStringAreEqual(token->key, "validValuesRanges");
+    char* values = CopyString(token->value ? HAPNonnull(token->value) : "");
+    for (char* value = strtok(values, ","); value; value = strtok(NULL, ",")) {
+        if (isRange) {
+            if (characteristic->numValidValuesRanges == kMaxValidValues) {
+                Fail("Too many valid values ranges.");
+            }
+            char* separator = strchr(value, '-');
+            if (!separator) {
+                Fail("%s entries must have the form <start>-<end>.", token->key);
+            }
+            *separator = '\0';
+            HAPUInt8CharacteristicValidValuesRange* range =
+                    &characteristic->validValuesRanges[characteristic->numValidValuesRanges++];
+            range->start = (uint8_t) GetUInt64(token->key, value, UINT8_MAX);
+            range->end = (uint8_t) GetUInt64(token->key, &separator[1], UINT8_MAX);
+        } else {
+            if (characteristic->numValidValues == kMaxValidValues) {
+                Fail("Too many valid values.");
+            }
+            characteristic->validValues[characteristic->numValidValues++] =
+                    (uint8_t) GetUInt64(token->key, value, UINT8_MAX);
+        }
+    }
+    if (isRange ? !characteristic->numValidValuesRanges : !characteristic->numValidValues) {
+        Fail("%s requires at least one entry.", token->key);
+    }
+}
+
+static void ParseCharacteristic(const Token* tokens, size_t numTokens) {
+    HAPPrecondition(tokens);
+
+    if (numTokens < 4 || tokens[1].value || tokens[2].value || tokens[3].value) {
+        Fail("Expected: characteristic <Type> <symbol> <Format> [options].");
+    }
+    if (!database.numServices) {
+        Fail("Characteristics must be preceded by a service.");
+    }
+    Service* service = &database.services[database.numServices - 1];
+    if (service->numCharacteristics == kMaxCharacteristicsPerService) {
+        Fail("Too many characteristics in service (maximum %zu).", kMaxCharacteristicsPerService);
+    }
+    if (database.numCharacteristics == kMaxCharacteristics) {
+        Fail("Too many characteristics (maximum %zu).", kMaxCharacteristics);
+    }
+    Characteristic* characteristic = &database.characteristics[database.numCharacteristics];
+    characteristic->lineNumber = database.lineNumber;
+    characteristic->type =
+            GetType(tokens[1].key, kCharacteristicTypes, HAPArrayCount(kCharacteristicTypes), "characteristic");
+    characteristic->debugDescription = characteristic->type->debugDescription;
+    CheckSymbol(tokens[2].key);
+    characteristic->symbol = tokens[2].key;
+    for (size_t i = 0; i < HAPArrayCount(kFormats); i++) {
+        if (HAPStringAreEqual(kFormats[i].name, tokens[3].key)) {
+            characteristic->format = &kFormats[i];
+        }
+    }
+    if (!characteristic->format) {
+        Fail("Unknown characteristic format %s.", tokens[3].key);
+    }
+    bool hasUnits = characteristic->format->format >= kHAPCharacteristicFormat_UInt8 &&
+                    characteristic->format->format <= kHAPCharacteristicFormat_Float;
+    bool hasMaxLength = characteristic->format->format == kHAPCharacteristicFormat_Data ||
+                        characteristic->format->format == kHAPCharacteristicFormat_String;
+
+    const char* _Nullable iid = NULL;
+    for (size_t i = 4; i < numTokens; i++) {
+        const Token* token = &tokens[i];
+        if (!token->value) {
+            ParseCharacteristicProperty(characteristic, token->key);
+        } else if (HAPStringAreEqual(token->key, "iid")) {
+            iid = token->value;
+        } else if (HAPStringAreEqual(token->key, "manufacturerDescription")) {
+            characteristic->manufacturerDescription = token->value;
+        } else if (HAPStringAreEqual(token->key, "debugDescription") && characteristic->type->isCustom) {
+            characteristic->debugDescription = HAPNonnull(token->value);
+        } else if (HAPStringAreEqual(token->key, "units") && hasUnits) {
+            bool found = false;
+            for (size_t j = 0; j < HAPArrayCount(kUnits); j++) {
+                if (HAPStringAreEqual(kUnits[j], HAPNonnull(token->value))) {
+                    characteristic->units = (HAPCharacteristicUnits) j;
+                    found = true;
+                }
+            }
+            if (!found) {
+                Fail("Unknown units %s.", token->value);
+            }
+        } else if (HAPStringAreEqual(token->key, "minimumValue")) {
+            ParseNumericConstraint(characteristic, token, &characteristic->minimumValue);
+        } else if (HAPStringAreEqual(token->key, "maximumValue")) {
+            ParseNumericConstraint(characteristic, token, &characteristic->maximumValue);
+        } else if (HAPStringAreEqual(token->key, "stepValue")) {
+            ParseNumericConstraint(characteristic, token, &characteristic->stepValue);
+        } else if (HAPStringAreEqual(token->key, "maxLength") && hasMaxLength) {
+            characteristic->hasMaxLength = true;
+            characteristic->maxLength = (uint32_t) GetUInt64(
+                    token->key,
+                    token->value,
+                    characteristic->format->format == kHAPCharacteristicFormat_String ? UINT16_MAX : UINT32_MAX);
+        } else if (
+                HAPStringAreEqual(token->key, "validValues") || HAPStringAreEqual(token->key, "validValuesRanges")) {
+            ParseValidValues(characteristic, token);
+        } else if (HAPStringAreEqual(token->key, "handleRead")) {
+            characteristic->handleRead = GetIdentifier(token);
+        } else if (HAPStringAreEqual(token->key, "handleWrite")) {
+            characteristic->handleWrite = GetIdentifier(token);
+        } else if (HAPStringAreEqual(token->key, "handleSubscribe")) {
+            characteristic->handleSubscribe = GetIdentifier(token);
+        } else if (HAPStringAreEqual(token->key, "handleUnsubscribe")) {
+            characteristic->handleUnsubscribe = GetIdentifier(token);
+        } else {
+            Fail("Unknown option %s for characteristics with format %s.", token->key, characteristic->format->name);
+        }
+    }
+    characteristic->iid = AssignIID(iid);
+    service->numCharacteristics++;
+    database.numCharacteristics++;
+}
+
+static void ParseDescription(FILE* file) {
+    HAPPrecondition(file);
+
+    database.nextIID = 1;
+
+    char line[kMaxLineBytes];
+    Token tokens[kMaxTokens];
+    size_t numTokens;
+    size_t nextLineNumber = 1;
+    for (;;) {
+        // Read a logical line. Lines ending with a backslash are continued on the next line.
+        database.lineNumber = nextLineNumber;
+        size_t numLineBytes = 0;
+        for (;;) {
+            if (!fgets(&line[numLineBytes], (int) (sizeof line - numLineBytes), file)) {
+                break;
+            }
+            nextLineNumber++;
+            numLineBytes += HAPStringGetNumBytes(&line[numLineBytes]);
+            if ((!numLineBytes || line[numLineBytes - 1] != '\n') && !feof(file)) {
+                Fail("Line too long (maximum %zu bytes).", kMaxLineBytes - 2);
+            }
+            while (numLineBytes && (line[numLineBytes - 1] == '\n' || line[numLineBytes - 1] == '\r')) {
+                numLineBytes--;
+            }
+            if (!numLineBytes || line[numLineBytes - 1] != '\\') {
+                break;
+            }
+            line[numLineBytes - 1] = ' ';
+        }
+        line[numLineBytes] = '\0';
+        if (nextLineNumber == database.lineNumber) {
+            break;
+        }
+        TokenizeLine(line, tokens, &numTokens);
+        if (!numTokens) {
+            continue;
+        }
+        if (tokens[0].value) {
+            Fail("Expected: accessory, include, service or characteristic.");
+        } else if (HAPStringAreEqual(tokens[0].key, "accessory")) {
+            if (numTokens != 2 || tokens[1].value ||
+                !(HAPStringAreEqual(tokens[1].key, "regular") || HAPStringAreEqual(tokens[1].key, "bridged"))) {
+                Fail("Expected: accessory regular | bridged.");
+            }
+            if (database.numServices) {
+                Fail("accessory must precede all services.");
+            }
+            database.isBridged = HAPStringAreEqual(tokens[1].key, "bridged");
+        } else if (HAPStringAreEqual(tokens[0].key, "include")) {
+            if (numTokens != 2 || tokens[1].value) {
+                Fail("Expected: include \"<header>\".");
+            }
+            if (database.numIncludes == kMaxIncludes) {
+                Fail("Too many includes (maximum %zu).", kMaxIncludes);
+            }
+            database.includes[database.numIncludes++] = tokens[1].key;
+        } else if (HAPStringAreEqual(tokens[0].key, "service")) {
+            ParseService(tokens, numTokens);
+        } else if (HAPStringAreEqual(tokens[0].key, "characteristic")) {
+            ParseCharacteristic(tokens, numTokens);
+        } else {
+            Fail("Expected: accessory, include, service or characteristic.");
+        }
+    }
+    if (ferror(file)) {
+        Fail("Reading failed.");
+    }
+    database.lineNumber = 0;
+    if (!database.numServices) {
+        Fail("No services described.");
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Validation.
+
+/**
+ * Placeholder that is assigned to the callbacks of the in-memory representation. Never called.
+ */
+static void PlaceholderCallback(void) {
+    HAPFatalError();
+}
+
+#define SET_CALLBACKS(chr, characteristic) \
+    do { \
+        (chr)->callbacks.handleRead = (characteristic)->handleRead ? \
+                                              (__typeof__((chr)->callbacks.handleRead)) PlaceholderCallback : \
+                                              NULL; \
+        (chr)->callbacks.handleWrite = (characteristic)->handleWrite ? \
+                                               (__typeof__((chr)->callbacks.handleWrite)) PlaceholderCallback : \
+                                               NULL; \
+        (chr)->callbacks.handleSubscribe = \
+                (characteristic)->handleSubscribe ? \
+                        (__typeof__((chr)->callbacks.handleSubscribe)) PlaceholderCallback : \
+                        NULL; \
+        (chr)->callbacks.handleUnsubscribe = \
+                (characteristic)->handleUnsubscribe ? \
+                        (__typeof__((chr)->callbacks.handleUnsubscribe)) PlaceholderCallback : \
+                        NULL; \
+    } while (0)
+
+#define SET_NUMERIC_CONSTRAINTS(chr, characteristic, field, defaultMinimumValue, defaultMaximumValue) \
+    do { \
+        (chr)->units = (characteristic)->units; \
+        (chr)->constraints.minimumValue = (characteristic)->minimumValue.isSet ? \
+                                                  (characteristic)->minimumValue._.field : \
+                                                  (defaultMinimumValue); \
+        (chr)->constraints.maximumValue = (characteristic)->maximumValue.isSet ? \
+                                                  (characteristic)->maximumValue._.field : \
+                                                  (defaultMaximumValue); \
+        (chr)->constraints.stepValue = (characteristic)->stepValue.isSet ? (characteristic)->stepValue._.field : 0; \
+    } while (0)
+
+/**
+ * Builds the in-memory representation of a characteristic.
+ */
+static void BuildCharacteristic(Characteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    HAPBaseCharacteristic* base = &characteristic->characteristic.base;
+    base->format = characteristic->format->format;
+    base->iid = characteristic->iid;
+    base->characteristicType = characteristic->type->type;
+    base->debugDescription = characteristic->debugDescription;
+    base->manufacturerDescription = characteristic->manufacturerDescription;
+    base->properties = characteristic->properties;
+    switch (characteristic->format->format) {
+        case kHAPCharacteristicFormat_Data: {
+            HAPDataCharacteristic* chr = &characteristic->characteristic.data;
+            chr->constraints.maxLength = characteristic->hasMaxLength ? characteristic->maxLength : 2097152;
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_Bool: {
+            HAPBoolCharacteristic* chr = &characteristic->characteristic.bool_;
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            HAPUInt8Characteristic* chr = &characteristic->characteristic.uint8;
+            SET_NUMERIC_CONSTRAINTS(chr, characteristic, unsignedIntValue, 0, UINT8_MAX);
+            if (characteristic->numValidValues) {
+                for (size_t i = 0; i < characteristic->numValidValues; i++) {
+                    characteristic->validValuePointers[i] = &characteristic->validValues[i];
+                }
+                chr->constraints.validValues = characteristic->validValuePointers;
+            }
+            if (characteristic->numValidValuesRanges) {
+                for (size_t i = 0; i < characteristic->numValidValuesRanges; i++) {
+                    characteristic->validValuesRangePointers[i] = &characteristic->validValuesRanges[i];
+                }
+                chr->constraints.validValuesRanges = characteristic->validValuesRangePointers;
+            }
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            HAPUInt16Characteristic* chr = &characteristic->characteristic.uint16;
+            SET_NUMERIC_CONSTRAINTS(chr, characteristic, unsignedIntValue, 0, UINT16_MAX);
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            HAPUInt32Characteristic* chr = &characteristic->characteristic.uint32;
+            SET_NUMERIC_CONSTRAINTS(chr, characteristic, unsignedIntValue, 0, UINT32_MAX);
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            HAPUInt64Characteristic* chr = &characteristic->characteristic.uint64;
+            SET_NUMERIC_CONSTRAINTS(chr, characteristic, unsignedIntValue, 0, UINT64_MAX);
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            HAPIntCharacteristic* chr = &characteristic->characteristic.int_;
+            SET_NUMERIC_CONSTRAINTS(chr, characteristic, intValue, INT32_MIN, INT32_MAX);
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            HAPFloatCharacteristic* chr = &characteristic->characteristic.float_;
+            SET_NUMERIC_CONSTRAINTS(
+                    chr,
+                    characteristic,
+                    floatValue,
+                    HAPFloatFromBitPattern(0xFF800000),
+                    HAPFloatFromBitPattern(0x7F800000));
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            HAPStringCharacteristic* chr = &characteristic->characteristic.string;
+            chr->constraints.maxLength = (uint16_t)(characteristic->hasMaxLength ? characteristic->maxLength : 64);
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            HAPTLV8Characteristic* chr = &characteristic->characteristic.tlv8;
+            SET_CALLBACKS(chr, characteristic);
+        } break;
+    }
+}
+
+#undef SET_NUMERIC_CONSTRAINTS
+#undef SET_CALLBACKS
+
+/**
+ * Builds the in-memory representation of the database and validates it using the accessory server's own rules.
+ */
+static void ValidateDatabase(void) {
+    static const HAPService* services[kMaxServices + 1];
+    for (size_t i = 0; i < database.numServices; i++) {
+        Service* service = &database.services[i];
+        database.lineNumber = service->lineNumber;
+
+        for (size_t j = 0; j < service->numLinkedServices; j++) {
+            bool found = false;
+            for (size_t k = 0; k < database.numServices; k++) {
+                if (HAPStringAreEqual(database.services[k].symbol, service->linkedServiceSymbols[j])) {
+                    service->linkedServices[j] = (uint16_t) database.services[k].iid;
+                    found = true;
+                }
+            }
+            if (!found) {
+                Fail("Linked service %s is not described.", service->linkedServiceSymbols[j]);
+            }
+        }
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + j];
+            BuildCharacteristic(characteristic);
+            service->characteristics[j] = &characteristic->characteristic.base;
+        }
+
+        service->service.iid = service->iid;
+        service->service.serviceType = service->type->type;
+        service->service.debugDescription = service->debugDescription;
+        service->service.name = service->name;
+        service->service.properties = service->properties;
+        service->service.linkedServices = service->hasLinkedServices ? service->linkedServices : NULL;
+        service->service.characteristics = service->numCharacteristics ? service->characteristics : NULL;
+        services[i] = &service->service;
+    }
+    database.lineNumber = 0;
+
+    // Accessory information is provided at runtime. Placeholders are used for validation.
+    HAPAccessory accessory;
+    HAPRawBufferZero(&accessory, sizeof accessory);
+    accessory.aid = database.isBridged ? 2 : 1;
+    accessory.category =
+            database.isBridged ? kHAPAccessoryCategory_BridgedAccessory : kHAPAccessoryCategory_Other;
+    accessory.name = "Accessory";
+    accessory.manufacturer = "Manufacturer";
+    accessory.model = "Model";
+    accessory.serialNumber = "SerialNumber";
+    accessory.firmwareVersion = "1";
+    accessory.services = services;
+
+    bool isValid;
+    if (database.isBridged) {
+        isValid = HAPBridgedAccessoryIsValid(&accessory);
+    } else {
+        HAPAccessoryServerRef server;
+        HAPRawBufferZero(&server, sizeof server);
+        isValid = HAPRegularAccessoryIsValid(&server, &accessory);
+    }
+    if (!isValid) {
+        Fail("Accessory attribute database is invalid. See log output for details.");
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Precomputation.
+
+/**
+ * Gets the short form of a type that is used in JSON.
+ */
+HAP_RESULT_USE_CHECK
+static const char* GetJSONType(const HAPUUID* type) {
+    HAPPrecondition(type);
+
+    HAPError err;
+
+    char description[sizeof "00000000-0000-0000-0000-000000000000"];
+    err = HAPUUIDGetDescription(type, description, sizeof description);
+    HAPAssert(!err);
+    return CopyString(description);
+}
+
+/**
+ * Copies the items that have been serialized into a TLV writer.
+ */
+static void CopyTLVWriterBytes(const HAPTLVWriterRef* writer, const uint8_t** bytes, size_t* numBytes) {
+    HAPPrecondition(writer);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    void* writerBytes;
+    HAPTLVWriterGetBuffer(writer, &writerBytes, numBytes);
+    HAPAssert(*numBytes);
+    uint8_t* copy = malloc(*numBytes);
+    if (!copy) {
+        Fail("Out of memory.");
+    }
+    HAPRawBufferCopyBytes(copy, writerBytes, *numBytes);
+    *bytes = copy;
+}
+
+/**
+ * Appends the attribute handles of a service or characteristic to the GATT layout.
+ */
+static void AppendGATTHandles(size_t elementIndex, size_t numHandles) {
+    HAPAssert(elementIndex <= UINT16_MAX);
+    HAPAssert(numHandles <= kMaxGATTHandles - database.numGATTHandles);
+    for (size_t i = 0; i < numHandles; i++) {
+        database.gattElementIndices[database.numGATTHandles++] = (uint16_t) elementIndex;
+    }
+}
+
+/**
+ * Precomputes the serializations that the accessory server would otherwise compute at runtime.
+ *
+ * - The GATT layout mirrors the registration order of HAPBLEPeripheralManagerRegister: Services use a declaration,
+ *   and the declaration and value of the Service Instance ID characteristic. Characteristics use a declaration,
+ *   a value, a Client Characteristic Configuration descriptor if they support indications, and the Characteristic
+ *   Instance ID descriptor. The layout starts at the Service Instance ID value of the first service.
+ */
+static void PrecomputeDatabase(void) {
+    HAPError err;
+
+    static uint8_t bytes[kMaxPrecomputedBytes];
+    for (size_t i = 0; i < database.numServices; i++) {
+        Service* service = &database.services[i];
+        database.lineNumber = service->lineNumber;
+        size_t elementIndex = i + service->firstCharacteristic;
+
+        HAPPrecomputedService* precomputedService = &database.precomputedServices[i];
+        precomputedService->service = &service->service;
+        precomputedService->ip.type = GetJSONType(service->type->type);
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+        err = HAPBLEServiceGetSignatureReadResponse(&service->service, &writer);
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            Fail("Service signature is too long.");
+        }
+        CopyTLVWriterBytes(
+                &writer, &precomputedService->ble.signatureBytes, &precomputedService->ble.numSignatureBytes);
+        precomputedService->characteristics =
+                service->numCharacteristics ? &database.precomputedCharacteristics[service->firstCharacteristic] : NULL;
+        precomputedService->numCharacteristics = service->numCharacteristics;
+        AppendGATTHandles(elementIndex, i ? 3 : 1);
+
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + j];
+            database.lineNumber = characteristic->lineNumber;
+            const HAPBaseCharacteristic* base = &characteristic->characteristic.base;
+
+            HAPPrecomputedCharacteristic* precomputedCharacteristic =
+                    &database.precomputedCharacteristics[service->firstCharacteristic + j];
+            precomputedCharacteristic->characteristic = base;
+            precomputedCharacteristic->ip.type = GetJSONType(characteristic->type->type);
+            size_t numBytes;
+            err = HAPIPAccessorySerializeCharacteristicMetadata(base, (char*) bytes, sizeof bytes - 1, &numBytes);
+            if (err) {
+                HAPAssert(err == kHAPError_OutOfResources);
+                Fail("Characteristic metadata is too long.");
+            }
+            bytes[numBytes] = '\0';
+            precomputedCharacteristic->ip.metadata = CopyString((const char*) bytes);
+            HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+            err = HAPBLECharacteristicGetSignatureReadResponse(base, &service->service, &writer);
+            if (err) {
+                HAPAssert(err == kHAPError_OutOfResources);
+                Fail("Characteristic signature is too long.");
+            }
+            CopyTLVWriterBytes(
+                    &writer,
+                    &precomputedCharacteristic->ble.signatureBytes,
+                    &precomputedCharacteristic->ble.numSignatureBytes);
+            AppendGATTHandles(elementIndex + 1 + j, base->properties.supportsEventNotification ? 4 : 3);
+        }
+    }
+    database.lineNumber = 0;
+
+    // Bridged accessories are not accessible over Bluetooth LE.
+    if (database.isBridged) {
+        database.numGATTHandles = 0;
+    }
+    database.precomputedAttributeDatabase.services = database.precomputedServices;
+    database.precomputedAttributeDatabase.numServices = database.numServices;
+    database.precomputedAttributeDatabase.ble.gattElementIndices =
+            database.numGATTHandles ? database.gattElementIndices : NULL;
+    database.precomputedAttributeDatabase.ble.numGATTHandles = database.numGATTHandles;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Code generation.
+
+static void WriteStringLiteral(FILE* file, const char* _Nullable string) {
+    HAPPrecondition(file);
+
+    if (!string) {
+        fprintf(file, "NULL");
+        return;
+    }
+    fputc('"', file);
+    for (const char* c = string; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteIIDName(FILE* file, const char* symbol) {
+    HAPPrecondition(file);
+    HAPPrecondition(symbol);
+
+    fprintf(file, "kIID_%c%s", symbol[0] >= 'a' && symbol[0] <= 'z' ? symbol[0] - 'a' + 'A' : symbol[0], &symbol[1]);
+}
+
+static void WriteBool(FILE* file, const char* name, bool value) {
+    fprintf(file, ".%s = %s", name, value ? "true" : "false");
+}
+
+static void WriteUnsignedIntConstraint(FILE* file, uint64_t value, uint64_t maximumValue, const char* maximumName) {
+    if (value == maximumValue) {
+        fprintf(file, "%s", maximumName);
+    } else {
+        fprintf(file, "%llu", (unsigned long long) value);
+    }
+}
+
+static void WriteFloatConstraint(FILE* file, float value) {
+    HAPError err;
+
+    if (HAPFloatIsInfinite(value)) {
+        fprintf(file, "%sINFINITY", value < 0 ? "-" : "");
+        return;
+    }
+    char description[kHAPFloat_MaxDescriptionBytes + 1];
+    err = HAPFloatGetDescription(description, sizeof description, value);
+    HAPAssert(!err);
+    fprintf(file, "%s%s", description, strpbrk(description, ".e") ? "F" : ".0F");
+}
+
+static void WriteIntConstraint(FILE* file, int32_t value) {
+    if (value == INT32_MIN) {
+        fprintf(file, "INT32_MIN");
+    } else if (value == INT32_MAX) {
+        fprintf(file, "INT32_MAX");
+    } else {
+        fprintf(file, "%ld", (long) value);
+    }
+}
+
+#define WRITE_NUMERIC_CONSTRAINTS(file, chr, writeConstraint, ...) \
+    do { \
+        fprintf(file, "    .units = kHAPCharacteristicUnits_%s,\n", kUnits[(chr)->units]); \
+        fprintf(file, "    .constraints = { .minimumValue = "); \
+        writeConstraint(file, (chr)->constraints.minimumValue, ##__VA_ARGS__); \
+        fprintf(file, ",\n                     .maximumValue = "); \
+        writeConstraint(file, (chr)->constraints.maximumValue, ##__VA_ARGS__); \
+        fprintf(file, ",\n                     .stepValue = "); \
+        writeConstraint(file, (chr)->constraints.stepValue, ##__VA_ARGS__); \
+    } while (0)
+
+static void WriteValidValues(FILE* file, const Characteristic* characteristic) {
+    HAPPrecondition(file);
+    HAPPrecondition(characteristic);
+
+    fprintf(file, ",\n                     .validValues = ");
+    if (characteristic->numValidValues) {
+        fprintf(file, "(const uint8_t* const[]) {");
+        for (size_t i = 0; i < characteristic->numValidValues; i++) {
+            fprintf(file, "\n                             &(const uint8_t) { %u },", characteristic->validValues[i]);
+        }
+        fprintf(file, "\n                             NULL }");
+    } else {
+        fprintf(file, "NULL");
+    }
+    fprintf(file, ",\n                     .validValuesRanges = ");
+    if (characteristic->numValidValuesRanges) {
+        fprintf(file, "(const HAPUInt8CharacteristicValidValuesRange* const[]) {");
+        for (size_t i = 0; i < characteristic->numValidValuesRanges; i++) {
+            fprintf(file,
+                    "\n                             &(const HAPUInt8CharacteristicValidValuesRange) { .start = %u, "
+                    ".end = %u },",
+                    characteristic->validValuesRanges[i].start,
+                    characteristic->validValuesRanges[i].end);
+        }
+        fprintf(file, "\n                             NULL }");
+    } else {
+        fprintf(file, "NULL");
+    }
+}
+
+/**
+ * Gets the name of a type that is used in comments.
+ */
+HAP_RESULT_USE_CHECK
+static const char* GetTypeName(const TypeDescription* type, const char* debugDescription) {
+    HAPPrecondition(type);
+    HAPPrecondition(debugDescription);
+
+    return type->isCustom ? debugDescription : type->name;
+}
+
+/**
+ * Writes the UUID constant of a custom type.
+ */
+static void WriteCustomType(FILE* file, const char* symbol, const TypeDescription* type) {
+    HAPPrecondition(file);
+    HAPPrecondition(symbol);
+    HAPPrecondition(type);
+    HAPPrecondition(type->isCustom);
+
+    fprintf(file,
+            "/**\n"
+            " * Custom type %s of %s.\n"
+            " */\n"
+            "static const HAPUUID %sType = {\n"
+            "    {",
+            type->name,
+            symbol,
+            symbol);
+    for (size_t i = 0; i < sizeof type->type->bytes; i++) {
+        fprintf(file, "%s0x%02X", i ? ", " : " ", type->type->bytes[i]);
+    }
+    fprintf(file, " }\n};\n\n");
+}
+
+/**
+ * Writes the type and debug description members of a service or characteristic.
+ */
+static void WriteTypeMembers(
+        FILE* file,
+        const char* symbol,
+        const TypeDescription* type,
+        const char* debugDescription,
+        const char* typeMember,
+        const char* prefix) {
+    HAPPrecondition(file);
+    HAPPrecondition(symbol);
+    HAPPrecondition(type);
+    HAPPrecondition(debugDescription);
+    HAPPrecondition(typeMember);
+    HAPPrecondition(prefix);
+
+    if (type->isCustom) {
+        fprintf(file, "    .%s = &%sType,\n", typeMember, symbol);
+        fprintf(file, "    .debugDescription = ");
+        WriteStringLiteral(file, debugDescription);
+        fprintf(file, ",\n");
+    } else {
+        fprintf(file, "    .%s = &kHAP%sType_%s,\n", typeMember, prefix, type->name);
+        fprintf(file, "    .debugDescription = kHAP%sDebugDescription_%s,\n", prefix, type->name);
+    }
+}
+
+static void WriteCharacteristic(FILE* file, const Characteristic* characteristic, const Service* service) {
+    HAPPrecondition(file);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+
+    HAPError err;
+
+    char uuid[sizeof "00000000-0000-0000-0000-000000000000"];
+    err = HAPUUIDGetDescription(characteristic->type->type, uuid, sizeof uuid);
+    HAPAssert(!err);
+    if (characteristic->type->isCustom) {
+        WriteCustomType(file, characteristic->symbol, characteristic->type);
+    }
+    fprintf(file,
+            "/**\n"
+            " * The '%s' characteristic (%s) of the %s service.\n"
+            " */\n",
+            GetTypeName(characteristic->type, characteristic->debugDescription),
+            uuid,
+            GetTypeName(service->type, service->debugDescription));
+    fprintf(file,
+            "%sconst %s %s = {\n",
+            characteristic->isStatic ? "static " : "",
+            characteristic->format->structName,
+            characteristic->symbol);
+    fprintf(file, "    .format = kHAPCharacteristicFormat_%s,\n", characteristic->format->name);
+    fprintf(file, "    .iid = ");
+    WriteIIDName(file, characteristic->symbol);
+    fprintf(file, ",\n");
+    WriteTypeMembers(
+            file,
+            characteristic->symbol,
+            characteristic->type,
+            characteristic->debugDescription,
+            "characteristicType",
+            "Characteristic");
+    fprintf(file, "    .manufacturerDescription = ");
+    WriteStringLiteral(file, characteristic->manufacturerDescription);
+    fprintf(file, ",\n");
+
+    const HAPCharacteristicProperties* properties = &characteristic->properties;
+    fprintf(file, "    .properties = { ");
+    WriteBool(file, "readable", properties->readable);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "writable", properties->writable);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "supportsEventNotification", properties->supportsEventNotification);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "hidden", properties->hidden);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "readRequiresAdminPermissions", properties->readRequiresAdminPermissions);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "writeRequiresAdminPermissions", properties->writeRequiresAdminPermissions);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "requiresTimedWrite", properties->requiresTimedWrite);
+    fprintf(file, ",\n                    ");
+    WriteBool(file, "supportsAuthorizationData", properties->supportsAuthorizationData);
+    fprintf(file, ",\n                    .ip = { ");
+    WriteBool(file, "controlPoint", properties->ip.controlPoint);
+    fprintf(file, ", ");
+    WriteBool(file, "supportsWriteResponse", properties->ip.supportsWriteResponse);
+    fprintf(file, " },\n                    .ble = { ");
+    WriteBool(file, "supportsBroadcastNotification", properties->ble.supportsBroadcastNotification);
+    fprintf(file, ",\n                             ");
+    WriteBool(file, "supportsDisconnectedNotification", properties->ble.supportsDisconnectedNotification);
+    fprintf(file, ",\n                             ");
+    WriteBool(file, "readableWithoutSecurity", properties->ble.readableWithoutSecurity);
+    fprintf(file, ",\n                             ");
+    WriteBool(file, "writableWithoutSecurity", properties->ble.writableWithoutSecurity);
+    fprintf(file, " } },\n");
+
+    switch (characteristic->format->format) {
+        case kHAPCharacteristicFormat_Data: {
+            fprintf(file,
+                    "    .constraints = { .maxLength = %lu },\n",
+                    (unsigned long) characteristic->characteristic.data.constraints.maxLength);
+        } break;
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_TLV8: {
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            WRITE_NUMERIC_CONSTRAINTS(
+                    file, &characteristic->characteristic.uint8, WriteUnsignedIntConstraint, UINT8_MAX, "UINT8_MAX");
+            WriteValidValues(file, characteristic);
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            WRITE_NUMERIC_CONSTRAINTS(
+                    file,
+                    &characteristic->characteristic.uint16,
+                    WriteUnsignedIntConstraint,
+                    UINT16_MAX,
+                    "UINT16_MAX");
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            WRITE_NUMERIC_CONSTRAINTS(
+                    file,
+                    &characteristic->characteristic.uint32,
+                    WriteUnsignedIntConstraint,
+                    UINT32_MAX,
+                    "UINT32_MAX");
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            WRITE_NUMERIC_CONSTRAINTS(
+                    file,
+                    &characteristic->characteristic.uint64,
+                    WriteUnsignedIntConstraint,
+                    UINT64_MAX,
+                    "UINT64_MAX");
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            WRITE_NUMERIC_CONSTRAINTS(file, &characteristic->characteristic.int_, WriteIntConstraint);
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            WRITE_NUMERIC_CONSTRAINTS(file, &characteristic->characteristic.float_, WriteFloatConstraint);
+            fprintf(file, " },\n");
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            fprintf(file,
+                    "    .constraints = { .maxLength = %u },\n",
+                    characteristic->characteristic.string.constraints.maxLength);
+        } break;
+    }
+
+    fprintf(file,
+            "    .callbacks = { .handleRead = %s,\n"
+            "                   .handleWrite = %s,\n"
+            "                   .handleSubscribe = %s,\n"
+            "                   .handleUnsubscribe = %s }\n"
+            "};\n\n",
+            characteristic->handleRead ? characteristic->handleRead : "NULL",
+            characteristic->handleWrite ? characteristic->handleWrite : "NULL",
+            characteristic->handleSubscribe ? characteristic->handleSubscribe : "NULL",
+            characteristic->handleUnsubscribe ? characteristic->handleUnsubscribe : "NULL");
+}
+
+#undef WRITE_NUMERIC_CONSTRAINTS
+
+static void WriteService(FILE* file, const Service* service) {
+    HAPPrecondition(file);
+    HAPPrecondition(service);
+
+    HAPError err;
+
+    char uuid[sizeof "00000000-0000-0000-0000-000000000000"];
+    err = HAPUUIDGetDescription(service->type->type, uuid, sizeof uuid);
+    HAPAssert(!err);
+    if (service->type->isCustom) {
+        WriteCustomType(file, service->symbol, service->type);
+    }
+    fprintf(file,
+            "/**\n"
+            " * The %s service (%s).\n"
+            " */\n",
+            GetTypeName(service->type, service->debugDescription),
+            uuid);
+    fprintf(file, "%sconst HAPService %s = {\n", service->isStatic ? "static " : "", service->symbol);
+    fprintf(file, "    .iid = ");
+    WriteIIDName(file, service->symbol);
+    fprintf(file, ",\n");
+    WriteTypeMembers(file, service->symbol, service->type, service->debugDescription, "serviceType", "Service");
+    fprintf(file, "    .name = ");
+    WriteStringLiteral(file, service->name);
+    fprintf(file, ",\n    .properties = { ");
+    WriteBool(file, "primaryService", service->properties.primaryService);
+    fprintf(file, ", ");
+    WriteBool(file, "hidden", service->properties.hidden);
+    fprintf(file, ", .ble = { ");
+    WriteBool(file, "supportsConfiguration", service->properties.ble.supportsConfiguration);
+    fprintf(file, " } },\n");
+    fprintf(file, "    .linkedServices = ");
+    if (service->hasLinkedServices) {
+        fprintf(file, "(uint16_t const[]) { ");
+        for (size_t i = 0; i < service->numLinkedServices; i++) {
+            WriteIIDName(file, service->linkedServiceSymbols[i]);
+            fprintf(file, ", ");
+        }
+        fprintf(file, "0 }");
+    } else {
+        fprintf(file, "NULL");
+    }
+    fprintf(file, ",\n    .characteristics = ");
+    if (service->numCharacteristics) {
+        fprintf(file, "(const HAPCharacteristic* const[]) {");
+        for (size_t i = 0; i < service->numCharacteristics; i++) {
+            fprintf(file,
+                    "\n            &%s,",
+                    database.characteristics[service->firstCharacteristic + i].symbol);
+        }
+        fprintf(file, "\n            NULL }\n");
+    } else {
+        fprintf(file, "NULL\n");
+    }
+    fprintf(file, "};\n");
+}
+
+/**
+ * Writes a byte array, 16 bytes per line.
+ */
+static void WriteByteArray(FILE* file, const char* symbol, const char* suffix, const uint8_t* bytes, size_t numBytes) {
+    HAPPrecondition(file);
+    HAPPrecondition(symbol);
+    HAPPrecondition(suffix);
+    HAPPrecondition(bytes);
+
+    fprintf(file, "static const uint8_t %s%s[] = {", symbol, suffix);
+    for (size_t i = 0; i < numBytes; i++) {
+        fprintf(file, "%s0x%02X%s", i % 16 ? " " : "\n    ", bytes[i], i + 1 < numBytes ? "," : "");
+    }
+    fprintf(file, "\n};\n");
+}
+
+static void WritePrecomputedService(FILE* file, const Service* service, size_t serviceIndex) {
+    HAPPrecondition(file);
+    HAPPrecondition(service);
+
+    const HAPPrecomputedService* precomputedService = &database.precomputedServices[serviceIndex];
+    fprintf(file,
+            "\n//--------------------------------------------------------------------------------"
+            "--------------------------------------\n\n"
+            "/**\n"
+            " * Bluetooth LE signatures of the %s service and its characteristics.\n"
+            " */\n",
+            GetTypeName(service->type, service->debugDescription));
+    WriteByteArray(
+            file,
+            service->symbol,
+            "SignatureBytes",
+            precomputedService->ble.signatureBytes,
+            precomputedService->ble.numSignatureBytes);
+    for (size_t i = 0; i < service->numCharacteristics; i++) {
+        const Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + i];
+        const HAPPrecomputedCharacteristic* precomputedCharacteristic =
+                &database.precomputedCharacteristics[service->firstCharacteristic + i];
+        WriteByteArray(
+                file,
+                characteristic->symbol,
+                "SignatureBytes",
+                precomputedCharacteristic->ble.signatureBytes,
+                precomputedCharacteristic->ble.numSignatureBytes);
+    }
+    if (!service->numCharacteristics) {
+        return;
+    }
+
+    fprintf(file,
+            "\n"
+            "/**\n"
+            " * Precomputed serializations of the characteristics of the %s service.\n"
+            " */\n"
+            "static const HAPPrecomputedCharacteristic %sPrecomputedCharacteristics[] = {",
+            GetTypeName(service->type, service->debugDescription),
+            service->symbol);
+    for (size_t i = 0; i < service->numCharacteristics; i++) {
+        const Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + i];
+        const HAPPrecomputedCharacteristic* precomputedCharacteristic =
+                &database.precomputedCharacteristics[service->firstCharacteristic + i];
+        fprintf(file, "%s\n    { .characteristic = &%s,\n", i ? "," : "", characteristic->symbol);
+        fprintf(file, "      .ip = { .type = ");
+        WriteStringLiteral(file, precomputedCharacteristic->ip.type);
+        fprintf(file, ",\n              .metadata = ");
+        WriteStringLiteral(file, precomputedCharacteristic->ip.metadata);
+        fprintf(file,
+                " },\n"
+                "      .ble = { .signatureBytes = %sSignatureBytes,\n"
+                "               .numSignatureBytes = sizeof %sSignatureBytes } }",
+                characteristic->symbol,
+                characteristic->symbol);
+    }
+    fprintf(file, "\n};\n");
+}
+
+static void WritePrecomputedAttributeDatabase(FILE* file) {
+    HAPPrecondition(file);
+
+    for (size_t i = 0; i < database.numServices; i++) {
+        WritePrecomputedService(file, &database.services[i], i);
+    }
+
+    fprintf(file,
+            "\n//--------------------------------------------------------------------------------"
+            "--------------------------------------\n");
+    if (database.numGATTHandles) {
+        fprintf(file,
+                "\n"
+                "/**\n"
+                " * Index of the service or characteristic that covers each attribute handle of the GATT layout.\n"
+                " */\n"
+                "static const uint16_t gattElementIndices[] = {");
+        for (size_t i = 0; i < database.numGATTHandles; i++) {
+            fprintf(file,
+                    "%s%u%s",
+                    i % 16 ? " " : "\n    ",
+                    database.gattElementIndices[i],
+                    i + 1 < database.numGATTHandles ? "," : "");
+        }
+        fprintf(file, "\n};\n");
+    }
+
+    fprintf(file,
+            "\n"
+            "const HAPPrecomputedAttributeDatabase precomputedAttributeDatabase = {\n"
+            "    .services = (const HAPPrecomputedService[]) {");
+    for (size_t i = 0; i < database.numServices; i++) {
+        const Service* service = &database.services[i];
+        const HAPPrecomputedService* precomputedService = &database.precomputedServices[i];
+        fprintf(file, "%s\n            { .service = &%s,\n", i ? "," : "", service->symbol);
+        fprintf(file, "              .ip = { .type = ");
+        WriteStringLiteral(file, precomputedService->ip.type);
+        fprintf(file,
+                " },\n"
+                "              .ble = { .signatureBytes = %sSignatureBytes,\n"
+                "                       .numSignatureBytes = sizeof %sSignatureBytes },\n",
+                service->symbol,
+                service->symbol);
+        if (service->numCharacteristics) {
+            fprintf(file,
+                    "              .characteristics = %sPrecomputedCharacteristics,\n"
+                    "              .numCharacteristics = HAPArrayCount(%sPrecomputedCharacteristics) }",
+                    service->symbol,
+                    service->symbol);
+        } else {
+            fprintf(file,
+                    "              .characteristics = NULL,\n"
+                    "              .numCharacteristics = 0 }");
+        }
+    }
+    fprintf(file, " },\n    .numServices = %zu,\n", database.numServices);
+    if (database.numGATTHandles) {
+        fprintf(file,
+                "    .ble = { .gattElementIndices = gattElementIndices,\n"
+                "             .numGATTHandles = HAPArrayCount(gattElementIndices) }\n");
+    } else {
+        fprintf(file, "    .ble = { .gattElementIndices = NULL, .numGATTHandles = 0 }\n");
+    }
+    fprintf(file, "};\n");
+}
+
+static void WriteGeneratedNotice(FILE* file, const char* descriptionName) {
+    fprintf(file,
+            "// This file has been generated by AccessoryDatabaseGenerator from %s.\n"
+            "// Do not edit. Update the description and regenerate instead.\n\n",
+            descriptionName);
+}
+
+static void WriteHeader(FILE* file, const char* descriptionName, const char* headerName) {
+    HAPPrecondition(file);
+    HAPPrecondition(descriptionName);
+    HAPPrecondition(headerName);
+
+    char guard[256];
+    size_t numGuardBytes = 0;
+    for (const char* c = headerName; *c && numGuardBytes < sizeof guard - 1; c++) {
+        if (*c >= 'a' && *c <= 'z') {
+            guard[numGuardBytes++] = (char) (*c - 'a' + 'A');
+        } else if ((*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9')) {
+            guard[numGuardBytes++] = *c;
+        } else {
+            guard[numGuardBytes++] = '_';
+        }
+    }
+    guard[numGuardBytes] = '\0';
+
+    WriteGeneratedNotice(file, descriptionName);
+    fprintf(file,
+            "#ifndef %s\n"
+            "#define %s\n"
+            "\n"
+            "#ifdef __cplusplus\n"
+            "extern \"C\" {\n"
+            "#endif\n"
+            "\n"
+            "#include \"HAP.h\"\n"
+            "\n"
+            "#if __has_feature(nullability)\n"
+            "#pragma clang assume_nonnull begin\n"
+            "#endif\n"
+            "\n"
+            "/**\n"
+            " * Total number of services and characteristics contained in the accessory.\n"
+            " */\n"
+            "#define kAttributeCount ((size_t) %zu)\n",
+            guard,
+            guard,
+            database.numServices + database.numCharacteristics);
+    for (size_t i = 0; i < database.numServices; i++) {
+        const Service* service = &database.services[i];
+        if (!service->isStatic) {
+            fprintf(file, "\nextern const HAPService %s;\n", service->symbol);
+        }
+        bool isFirst = true;
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            const Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + j];
+            if (!characteristic->isStatic) {
+                fprintf(file,
+                        "%sextern const %s %s;\n",
+                        isFirst && service->isStatic ? "\n" : "",
+                        characteristic->format->structName,
+                        characteristic->symbol);
+                isFirst = false;
+            }
+        }
+    }
+    fprintf(file,
+            "\n"
+            "/**\n"
+            " * Precomputed serializations of the accessory attribute database.\n"
+            " *\n"
+            " * - Assign to HAPAccessory.precomputedAttributeDatabase. The precomputed GATT layout is only used if\n"
+            " *   the services of the accessory are listed in the same order as in %s.\n"
+            " */\n"
+            "extern const HAPPrecomputedAttributeDatabase precomputedAttributeDatabase;\n",
+            descriptionName);
+    fprintf(file,
+            "\n"
+            "#if __has_feature(nullability)\n"
+            "#pragma clang assume_nonnull end\n"
+            "#endif\n"
+            "\n"
+            "#ifdef __cplusplus\n"
+            "}\n"
+            "#endif\n"
+            "\n"
+            "#endif\n");
+}
+
+static void WriteSource(FILE* file, const char* descriptionName, const char* headerName) {
+    HAPPrecondition(file);
+    HAPPrecondition(descriptionName);
+    HAPPrecondition(headerName);
+
+    WriteGeneratedNotice(file, descriptionName);
+
+    bool needsMath = false;
+    for (size_t i = 0; i < database.numCharacteristics; i++) {
+        const Characteristic* characteristic = &database.characteristics[i];
+        if (characteristic->format->format == kHAPCharacteristicFormat_Float) {
+            const HAPFloatCharacteristic* chr = &characteristic->characteristic.float_;
+            needsMath |= HAPFloatIsInfinite(chr->constraints.minimumValue) ||
+                         HAPFloatIsInfinite(chr->constraints.maximumValue);
+        }
+    }
+    if (needsMath) {
+        fprintf(file, "#include <math.h>\n\n");
+    }
+    for (size_t i = 0; i < database.numIncludes; i++) {
+        fprintf(file, "#include \"%s\"\n", database.includes[i]);
+    }
+    fprintf(file, "#include \"%s\"\n\n", headerName);
+
+    fprintf(file,
+            "////////////////////////////////////////////////////////////////////////////////"
+            "////////////////////////////////////////\n\n"
+            "/**\n"
+            " * IID constants.\n"
+            " */\n");
+    for (size_t i = 0; i < database.numServices; i++) {
+        const Service* service = &database.services[i];
+        fprintf(file, "%s#define ", i ? "\n" : "");
+        WriteIIDName(file, service->symbol);
+        fprintf(file, " ((uint64_t) 0x%04llX)\n", (unsigned long long) service->iid);
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            const Characteristic* characteristic = &database.characteristics[service->firstCharacteristic + j];
+            fprintf(file, "#define ");
+            WriteIIDName(file, characteristic->symbol);
+            fprintf(file, " ((uint64_t) 0x%04llX)\n", (unsigned long long) characteristic->iid);
+        }
+    }
+
+    for (size_t i = 0; i < database.numServices; i++) {
+        const Service* service = &database.services[i];
+        fprintf(file,
+                "\n//--------------------------------------------------------------------------------"
+                "--------------------------------------\n\n");
+        for (size_t j = 0; j < service->numCharacteristics; j++) {
+            WriteCharacteristic(file, &database.characteristics[service->firstCharacteristic + j], service);
+        }
+        WriteService(file, service);
+    }
+
+    WritePrecomputedAttributeDatabase(file);
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetFileName(const char* path) {
+    HAPPrecondition(path);
+
+    const char* separator = strrchr(path, '/');
+    return separator ? &separator[1] : path;
+}
+
+static void WriteFile(const char* path, const char* descriptionName, const char* headerName, bool isHeader) {
+    HAPPrecondition(path);
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "%s: Cannot open for writing.\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (isHeader) {
+        WriteHeader(file, descriptionName, headerName);
+    } else {
+        WriteSource(file, descriptionName, headerName);
+    }
+    if (fclose(file)) {
+        fprintf(stderr, "%s: Writing failed.\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void AccessoryDatabaseGeneratorCompile(const char* path) {
+    HAPPrecondition(path);
+    HAPPrecondition(!database.path);
+
+    database.path = path;
+    FILE* file = fopen(database.path, "r");
+    if (!file) {
+        Fail("Cannot open for reading.");
+    }
+    ParseDescription(file);
+    fclose(file);
+    ValidateDatabase();
+    PrecomputeDatabase();
+}
+
+void AccessoryDatabaseGeneratorWrite(const char* output) {
+    HAPPrecondition(output);
+    HAPPrecondition(database.path);
+
+    size_t numOutputBytes = HAPStringGetNumBytes(output);
+    char* headerPath = malloc(numOutputBytes + sizeof ".h");
+    char* sourcePath = malloc(numOutputBytes + sizeof ".c");
+    if (!headerPath || !sourcePath) {
+        Fail("Out of memory.");
+    }
+    snprintf(headerPath, numOutputBytes + sizeof ".h", "%s.h", output);
+    snprintf(sourcePath, numOutputBytes + sizeof ".c", "%s.c", output);
+    const char* descriptionName = GetFileName(database.path);
+    const char* headerName = GetFileName(headerPath);
+    WriteFile(headerPath, descriptionName, headerName, /* isHeader: */ true);
+    WriteFile(sourcePath, descriptionName, headerName, /* isHeader: */ false);
+    free(headerPath);
+    free(sourcePath);
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef ACCESSORY_DATABASE_GENERATOR_H
+#define ACCESSORY_DATABASE_GENERATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**@file
+ * Compiler for declarative accessory attribute database descriptions.
+ *
+ * - Errors in the description are reported on stderr and terminate the process.
+ *
+ * - See Documentation/accessory_database_generator.md for the description format.
+ */
+
+/**
+ * Parses and validates an accessory attribute database description, and precomputes the serializations that
+ * the accessory server would otherwise compute at runtime.
+ *
+ * - May only be called once per process.
+ *
+ * @param      path                 Path of the description.
+ */
+void AccessoryDatabaseGeneratorCompile(const char* path);
+
+/**
+ * Writes the compiled accessory attribute database to <output>.h and <output>.c.
+ *
+ * - AccessoryDatabaseGeneratorCompile must have been called before.
+ *
+ * @param      output               Path of the output files, without extension.
+ */
+void AccessoryDatabaseGeneratorWrite(const char* output);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HAP.h"
+
+#include "AccessoryDatabaseGenerator.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        printf("HomeKit Accessory Database Generator - Version %s (%s)\n"
+               "\n"
+               "USAGE\n"
+               "     AccessoryDatabaseGenerator <description> <output>\n"
+               "\n"
+               "DESCRIPTION\n"
+               "     This tool compiles a declarative accessory attribute database description into\n"
+               "     the C structures that are passed to the accessory server. The database is\n"
+               "     validated against the same rules that the accessory server enforces on start,\n"
+               "     so that mistakes are reported at build time instead of when the accessory starts.\n"
+               "     \n"
+               "     Serializations that the accessory server would otherwise compute at runtime are\n"
+               "     precomputed as well: JSON type strings and metadata of GET /accessories responses,\n"
+               "     Bluetooth LE signature read responses, and the Bluetooth LE GATT layout.\n"
+               "     \n"
+               "     <output>.h and <output>.c are written. See\n"
+               "     Documentation/accessory_database_generator.md for the description format.\n",
+               HAPGetVersion(),
+               HAPGetBuild());
+        exit(argc == 1 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    AccessoryDatabaseGeneratorCompile(argv[1]);
+    AccessoryDatabaseGeneratorWrite(argv[2]);
+
+    return 0;
+}